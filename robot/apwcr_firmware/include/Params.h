@@ -51,6 +51,22 @@ constexpr float COUNTS_PER_WHEEL_REV =
 constexpr float FEET_PER_COUNT =
     WHEEL_CIRCUMFERENCE_FT / COUNTS_PER_WHEEL_REV;
 
+// Fixed-point scale factors (Q0.32 raw: value = raw / 2^32, see utils/Fixed.h)
+constexpr uint32_t WHEEL_REV_PER_COUNT_Q32 =
+    (uint32_t)(4294967296.0f / COUNTS_PER_WHEEL_REV + 0.5f);
+constexpr uint32_t FEET_PER_COUNT_Q32 =
+    (uint32_t)(FEET_PER_COUNT * 4294967296.0f + 0.5f);
+// Heading turns per count of (right - left) difference (sensors/Odometry)
+constexpr uint32_t ODOM_TURN_PER_COUNT_Q32 =
+    (uint32_t)(FEET_PER_COUNT / (TRACK_WIDTH_FT * 2.0f * PI) * 4294967296.0f + 0.5f);
+
+// Velocity estimate (EncoderSensor: edge-timed M/T hybrid)
+constexpr uint32_t ENCODER_ZERO_SPEED_US = 200000;   // no edge this long reads as stopped
+constexpr float ENCODER_VEL_FILTER_ALPHA = 0.4f;     // rps_filtered IIR weight, 1 = unfiltered
+
+// EncoderBank: encoders snapshotted together each drive tick (2 drive + 2 arm)
+constexpr uint8_t ENCODER_BANK_MAX = 4;
+
 /* ============================================================================
    MOTOR LIMITS
 ============================================================================ */
@@ -59,6 +75,12 @@ constexpr float FEET_PER_COUNT =
 constexpr int PWM_MIN = 0;
 constexpr int PWM_MAX = 255;
 
+// PWM backend (DcMotorActuator): true = program the PWM pins' timers
+// directly (Timer3/4 at MOTOR_PWM_HZ with F_CPU / MOTOR_PWM_HZ steps,
+// Timer2 at 31.4 kHz); false = analogWrite (490/980 Hz, 8-bit)
+constexpr bool MOTOR_PWM_DIRECT = true;
+constexpr uint32_t MOTOR_PWM_HZ = 20000;      // above hearing, 800 duty steps
+
 // Soft limits (customary)
 constexpr float MAX_LINEAR_SPEED_FTPS = 3.0f;    // ft/s
 constexpr float MAX_ANGULAR_SPEED_DPS = 180.0f;  // deg/s
@@ -73,6 +95,47 @@ constexpr float DRIVE_KD = 0.06f;
 
 constexpr float DRIVE_INTEGRAL_LIMIT = 50.0f;
 
+// Below this measured speed a zero target coasts the motor (ft/s)
+constexpr float DRIVE_STOPPED_FTPS = 0.05f;
+
+// Feed-forward per wheel on the slewed target v (the PID trims the rest):
+//   duty = sign(v) * DRIVE_FF_KS + DRIVE_FF_KV * v + PID
+// KS is the duty that just breaks the wheel free: the motor's deadzone,
+// which DcMotorActuator's pwm_min would otherwise cover for every command
+// (PWM_MIN stays 0 while KS is in use, or it is compensated twice). KV is
+// duty per ft/s at steady speed. Identify both with the step test
+// ({"type": "test", "op": "drive_step"}); 0 = pure feedback.
+constexpr float DRIVE_FF_KS = 0.0f;    // duty
+constexpr float DRIVE_FF_KV = 0.0f;    // duty per ft/s
+
+// Wheel target slew (ft/s^2): speeding up / slowing down (or reversing).
+// stop() and the watchdog still cut the motors at once.
+constexpr float DRIVE_ACCEL_FTPS2 = 6.0f;
+constexpr float DRIVE_DECEL_FTPS2 = 12.0f;
+
+// Step test (DriveController::startStepTest), both wheels open loop, on
+// blocks: duty ramps up at DRIVE_STEP_KS_RAMP per second until each wheel
+// turns (-> KS), both coast for DRIVE_STEP_REST_MS once stopped, then a
+// duty step for DRIVE_STEP_MS. The last quarter of the step is the steady
+// speed (-> KV = (duty - KS) / v_ss), the area above the response the time
+// constant. The host must keep commanding (zero is fine) or the drive
+// watchdog aborts it.
+constexpr float DRIVE_STEP_DUTY = 0.5f;       // default step ("value" overrides)
+constexpr float DRIVE_STEP_MAX_DUTY = 0.8f;   // cap on the step and the ramp
+constexpr float DRIVE_STEP_KS_RAMP = 0.25f;   // duty per second
+constexpr uint16_t DRIVE_STEP_REST_MS = 500;
+constexpr uint16_t DRIVE_STEP_MS = 1500;
+
+static_assert(PWM_MIN == 0 || DRIVE_FF_KS == 0.0f, "DRIVE_FF_KS and PWM_MIN both compensate the deadzone");
+
+// Polarity: the drive motors are mirrored side to side, so one side needs
+// both its motor and encoder flipped for "forward" to be positive.
+// Verify on blocks: +duty must give +count on each wheel.
+constexpr bool LHS_DRIVE_MOTOR_INVERT = false;
+constexpr bool LHS_DRIVE_ENCODER_INVERT = false;
+constexpr bool RHS_DRIVE_MOTOR_INVERT = true;
+constexpr bool RHS_DRIVE_ENCODER_INVERT = true;
+
 /* ============================================================================
    ARM / MECHANISM CONTROL
 ============================================================================ */
@@ -83,6 +146,44 @@ constexpr float ARM_KD = 0.1f;
 
 constexpr int ARM_MAX_PWM = 200;
 
+// PID error is in joint degrees and the output in PWM counts (+/-ARM_MAX_PWM,
+// scaled to duty by PWM_MAX), so ARM_KP = 1.2 is 1.2 counts per degree
+constexpr float ARM_INTEGRAL_LIMIT = 100.0f;   // deg*s
+
+// Arm encoders: only channel A is on an external interrupt (B is a plain
+// GPIO), so QuadratureEncoder only steps on A edges: x2, not x4
+constexpr int ARM_QUADRATURE_FACTOR = 2;
+constexpr float ARM_GEAR_RATIO = 1.0f;         // gearbox output revs per joint rev
+constexpr float COUNTS_PER_ARM_REV =
+    ENCODER_CPR * ARM_QUADRATURE_FACTOR * MOTOR_GEAR_RATIO * ARM_GEAR_RATIO;
+
+// Joint angles are relative to the power-up pose (arms stowed); targets are
+// clamped to this range
+constexpr float ARM_MIN_DEG = 0.0f;
+constexpr float ARM_MAX_DEG = 135.0f;
+
+// Position moves are accel-limited (control/MotionProfile), both joints
+// planned together so a shared target is reached at the same time
+constexpr float ARM_MAX_DPS = 90.0f;
+constexpr float ARM_ACCEL_DPS2 = 180.0f;
+
+// Synchronized pair: when both joints hold position, the difference of
+// their tracking errors (LHS - RHS, deg) is fed into both outputs: the
+// lagging side pushes harder and the leading side eases off, so one arm
+// stalling under load holds the other back instead of twisting the pair
+constexpr bool ARM_SYNC_ENABLE = true;
+constexpr float ARM_SYNC_KP = 2.0f;            // PWM counts per degree of mismatch
+
+// Within this of the target (and not moving) reads as at_target
+constexpr float ARM_POS_TOLERANCE_DEG = 2.0f;
+
+// Polarity: the arm motors face each other like the drive motors.
+// Verify on blocks: +duty must give +count (arm raising) on each side.
+constexpr bool LHS_ARM_MOTOR_INVERT = false;
+constexpr bool LHS_ARM_ENCODER_INVERT = false;
+constexpr bool RHS_ARM_MOTOR_INVERT = true;
+constexpr bool RHS_ARM_ENCODER_INVERT = true;
+
 /* ============================================================================
    SERVO PARAMETERS
 ============================================================================ */
@@ -106,11 +207,11 @@ constexpr float INCHES_PER_FOOT = 12.0f;
 constexpr float CM_PER_INCH = 2.54f;
 
 // What range do we actually care about for the robot?
-// Keeping this smaller makes ultrasonic reads faster and reduces blocking.
+// Keeping this smaller shortens the echo timeout (reads are non-blocking).
 constexpr float ULTRASONIC_MIN_IN = 3.0f;          // 
 constexpr float ULTRASONIC_MAX_RANGE_IN = 70.0f;   // 
 
-// Martinsos library uses max distance in centimeters
+// Driver takes max distance in centimeters
 constexpr uint16_t ULTRASONIC_MAX_DISTANCE_CM =
     (uint16_t)(ULTRASONIC_MAX_RANGE_IN * CM_PER_INCH);
 
@@ -122,11 +223,11 @@ constexpr float SPEED_OF_SOUND_CMPS = 34300.0f;    // ~20 C
 constexpr uint32_t ULTRASONIC_TIMEOUT_US_FROM_RANGE =
     (uint32_t)(1.25f * (2.0f * ULTRASONIC_MAX_DISTANCE_CM / SPEED_OF_SOUND_CMPS) * 1000000.0f);
 
-// Hard cap on how long we're willing to block in pulseIn() worst case.
-// Keep this at or below your control period if you want tight timing.
+// Hard cap on how long a ping waits for its echo before timing out.
+// Keep this below the ultrasonic period so pings never overlap.
 constexpr uint32_t ULTRASONIC_TIMEOUT_US_HARD = 20000UL;  // 20 ms
 
-// Final timeout to pass to the Martinsos library
+// Final timeout to pass to DistanceSensor
 constexpr uint32_t ULTRASONIC_TIMEOUT_US =
     (ULTRASONIC_TIMEOUT_US_FROM_RANGE < ULTRASONIC_TIMEOUT_US_HARD)
       ? ULTRASONIC_TIMEOUT_US_FROM_RANGE
@@ -135,34 +236,307 @@ constexpr uint32_t ULTRASONIC_TIMEOUT_US =
 // Valid measurement max for your wrapper sanity checks (keep aligned with range)
 constexpr float ULTRASONIC_MAX_VALID_IN = ULTRASONIC_MAX_RANGE_IN;
 
+// Air temperature for the speed of sound (no temperature sensor on board;
+// each 10 C off is ~1.8% range error)
+constexpr float ULTRASONIC_AIR_TEMP_C = 20.0f;
+
+// On-board range filter (sensors/RangeFilter): median of the last N echoes,
+// then a constant-velocity Kalman filter with innovation gating
+constexpr uint8_t ULTRASONIC_MEDIAN_N = 5;             // odd, <= 9
+constexpr bool ULTRASONIC_KALMAN_ENABLE = true;        // false = median only
+constexpr float ULTRASONIC_MEAS_SIGMA_IN = 0.4f;       // echo noise (1 sigma)
+constexpr float ULTRASONIC_ACCEL_SIGMA_INPS2 = 40.0f;  // target accel (white noise)
+constexpr float ULTRASONIC_GATE_SIGMA = 4.0f;          // reject |innovation| beyond this
+constexpr float ULTRASONIC_GATE_MIN_IN = 3.0f;         // ...but never tighter than this
+constexpr uint8_t ULTRASONIC_OUTLIER_RESET = 3;        // consecutive rejects -> restart at median
+constexpr uint16_t ULTRASONIC_TRACK_TIMEOUT_MS = 500;  // no accepted echo this long -> invalid
+
+// Sensor array (sensors/DistanceSensorArray; pins and firing slots in
+// main.cpp). Sensors sharing a slot fire together, so only pair ones that
+// cannot hear each other (front + rear). Slots fire round-robin, each
+// sensor once per ULTRASONIC_UPDATE_HZ period; a slot has to outlast the
+// echo timeout plus ring-down or the next ping hears the last one.
+constexpr uint8_t ULTRASONIC_SENSOR_COUNT = 1;     // front only; 4 with FL/FR/rear fitted
+constexpr uint8_t ULTRASONIC_SLOTS = 1;            // 3 with FL/FR/rear fitted
+constexpr uint16_t ULTRASONIC_RINGDOWN_MS = 4;
+
+/* ============================================================================
+   OBSTACLE GUARD (control/ObstacleGuard)
+============================================================================ */
+
+// Forward speed is capped every drive tick from the front sensors' filtered
+// range, so the stop distance doesn't depend on the host's round trip.
+// Reverse and turning in place are never limited.
+constexpr bool OBSTACLE_GUARD_ENABLE = true;
+constexpr float OBSTACLE_MARGIN_IN = 6.0f;          // stop this far from the obstacle
+constexpr float OBSTACLE_RELEASE_IN = 3.0f;         // ...and let go this much further out
+constexpr float OBSTACLE_DECEL_FTPS2 = 2.0f;        // forward cap follows this braking curve
+constexpr float OBSTACLE_STOP_DECEL_FTPS2 = 4.0f;   // closing faster than this curve allows: stop now
+constexpr float OBSTACLE_LATENCY_S = 0.1f;          // range age (one ping) + drive tick
+constexpr float OBSTACLE_MIN_CONFIDENCE = 0.25f;    // 2 of the last 8 pings
+
+/* ============================================================================
+   ODOMETRY (sensors/Odometry)
+============================================================================ */
+
+// Pose uncertainty growth, 1 sigma after 1 ft travelled / 1 rad turned
+// (grows with the square root; tune from a few measured runs)
+constexpr float ODOM_POS_SIGMA_PER_FT = 0.02f;        // ft: wheel size / slip along the path
+constexpr float ODOM_HEADING_SIGMA_PER_FT = 0.01f;    // rad: wheel mismatch while driving
+constexpr float ODOM_HEADING_SIGMA_PER_RAD = 0.05f;   // rad: scrub while turning
+
 /* ============================================================================
    TASK RATES / TIMING
 ============================================================================ */
 
 constexpr uint16_t DRIVE_UPDATE_HZ      = 100;
 constexpr uint16_t RxCOMM_UPDATE_HZ  = 400;
-constexpr uint16_t TELEMETRY_UPDATE_HZ  = 20;
-constexpr uint16_t ULTRASONIC_UPDATE_HZ = 15;
+constexpr uint16_t TELEMETRY_UPDATE_HZ  = 20;    // JSON wire mode
+constexpr uint16_t TELEMETRY_BINARY_UPDATE_HZ = 200;  // binary wire mode
+constexpr uint16_t ULTRASONIC_UPDATE_HZ = 15;      // per sensor (the task runs at x ULTRASONIC_SLOTS)
+constexpr uint16_t SEQUENCER_UPDATE_HZ  = 50;
+
+// Drive encoder sampler (Timer1 compare ISR, sensors/EncoderSampler). Every
+// sample is timestamped and queued, then shipped in binary telemetry as an
+// EncoderBatch. 32 samples is 160 ms of slack at 200 Hz.
+constexpr bool ENABLE_ENCODER_SAMPLER = true;
+constexpr uint16_t ENCODER_SAMPLE_HZ = 200;
+constexpr uint8_t ENCODER_RING_SAMPLES = 32;   // power of two, <= 128
+
+// Drive inner loop (control/DriveInnerLoop): the wheel velocity PIDs and
+// the PWM writes run in the sampler's Timer1 ISR at DRIVE_ISR_HZ (the
+// sampler then queues every DRIVE_ISR_HZ / ENCODER_SAMPLE_HZ-th tick);
+// DriveController keeps the kinematics, slew and feed-forward at
+// DRIVE_UPDATE_HZ and hands the loop a setpoint. Speed = counts over the
+// last DRIVE_ISR_VEL_WINDOW ticks (20 ms: 0.036 ft/s per count). No new
+// setpoint for DRIVE_ISR_STALE_MS (the drive task stuck) coasts the wheels
+// from the ISR. false = the PIDs run in the drive task, as before.
+constexpr bool ENABLE_DRIVE_ISR_LOOP = true;
+constexpr uint16_t DRIVE_ISR_HZ = 800;
+constexpr uint8_t DRIVE_ISR_VEL_WINDOW = 16;   // ticks, power of two
+constexpr uint16_t DRIVE_ISR_STALE_MS = 50;
+
+// Scheduler phase offsets (us): stagger the periodic ticks so they don't
+// land on the same loop iteration (RX runs every 2.5 ms, so offsets of a
+// few ms separate everything else)
+constexpr uint32_t DRIVE_PHASE_US      = 600;
+constexpr uint32_t ULTRASONIC_PHASE_US = 0;
+constexpr uint32_t SERVO_PHASE_US      = 1700;
+constexpr uint32_t TELEMETRY_PHASE_US  = 3300;
+constexpr uint32_t AUX_TELEMETRY_PHASE_US = 1200;
+constexpr uint32_t SEQUENCER_PHASE_US  = 2500;
+
+// Scheduler priorities (higher runs first when several tasks are due)
+constexpr uint8_t TASK_PRIO_DRIVE      = 5;
+constexpr uint8_t TASK_PRIO_RX         = 4;
+constexpr uint8_t TASK_PRIO_SAFETY     = 3;
+constexpr uint8_t TASK_PRIO_SERVO      = 2;
+constexpr uint8_t TASK_PRIO_SEQUENCER  = 2;
+constexpr uint8_t TASK_PRIO_ULTRASONIC = 1;
+constexpr uint8_t TASK_PRIO_TELEMETRY  = 0;
+
+// Task/loop timing report ("perf" frame). Each report covers one window.
+constexpr bool ENABLE_PERF_REPORT = true;
+constexpr uint16_t PERF_REPORT_HZ = 1;
+constexpr uint32_t PERF_PHASE_US = 4100;
+
+// Idle sleep between scheduler ticks (utils/PowerSaver): SLEEP_MODE_IDLE
+// until the next release or interrupt. Tunable (ParamStore) so the current
+// draw can be compared on the bench without a reflash. Gaps shorter than
+// IDLE_MIN_US are spun (the wake-up costs more than it saves).
+constexpr bool ENABLE_IDLE_SLEEP = true;
+constexpr uint32_t IDLE_MIN_US = 40;
+
+// SRAM report in the perf frame (utils/StackMonitor). The painted gap
+// between .noinit and the stack is rescanned this many bytes per loop.
+constexpr uint8_t STACK_SCAN_CHUNK_BYTES = 64;
+
+// Safety (utils/Watchdog): one liveness channel per subsystem, each with
+// its own timeout and stop action. The command channels are fed by every
+// command the host sends (20 Hz or more while driving).
+constexpr unsigned long COMMAND_TIMEOUT_MS = 6000;   // link lost: stow the servos
+constexpr uint16_t WATCHDOG_DRIVE_TIMEOUT_MS = 250;   // no command: stop the drive
+constexpr uint16_t WATCHDOG_ARM_TIMEOUT_MS = 500;     // no command: coast the arms
+constexpr uint16_t WATCHDOG_CONTROL_TIMEOUT_MS = 100; // drive task stalled: stop motors, then WDT reset
+constexpr uint8_t WATCHDOG_MAX_CHANNELS = 4;
 
-// Safety
-constexpr unsigned long COMMAND_TIMEOUT_MS = 6000;
+/* ============================================================================
+   SYSTEM IDENTIFICATION (control/SysId)
+============================================================================ */
+
+// Open-loop characterization of a motor pair, both motors at the same duty
+// ({"type": "test", "op": "sysid_drive" | "sysid_arm", "value": <duty>}):
+// a duty step for SYSID_*_STEP_MS, then a linear chirp (SYSID_CHIRP_F0_HZ
+// to F1) around SYSID_*_CHIRP_MEAN * duty, SYSID_*_CHIRP_AMP * duty deep,
+// for SYSID_CHIRP_MS. The mean speed over each fit period (one drive tick,
+// SYSID_ARM_FIT_TICKS for the arms' coarse encoders) feeds an
+// instrumental-variable fit for the time constant, gain, KV and KS
+// (control/SysId.h).
+// The drive pair runs on blocks like the step test; the arm pair aborts
+// above ARM_MAX_DEG - SYSID_ARM_MARGIN_DEG. The host keeps commanding
+// (zero is fine) or the watchdogs abort it.
+constexpr float SYSID_DRIVE_DUTY = 0.5f;        // default "value"
+constexpr uint16_t SYSID_DRIVE_STEP_MS = 1200;
+constexpr float SYSID_DRIVE_CHIRP_MEAN = 1.0f;  // stays one way round: KS is the offset
+constexpr float SYSID_DRIVE_CHIRP_AMP = 0.5f;
+
+constexpr float SYSID_ARM_DUTY = 0.3f;
+constexpr uint16_t SYSID_ARM_STEP_MS = 300;
+constexpr float SYSID_ARM_CHIRP_MEAN = 0.0f;    // swings both ways about the step's end
+constexpr float SYSID_ARM_CHIRP_AMP = 1.0f;
+constexpr float SYSID_ARM_MARGIN_DEG = 20.0f;
+constexpr float SYSID_ARM_STOPPED_DPS = 3.0f;   // slower samples stay out of the fit
+constexpr uint8_t SYSID_ARM_FIT_TICKS = 5;      // ~0.85 deg per count: a few counts per period
+
+constexpr uint16_t SYSID_CHIRP_MS = 2000;
+constexpr float SYSID_CHIRP_F0_HZ = 0.5f;
+constexpr float SYSID_CHIRP_F1_HZ = 5.0f;
+constexpr uint16_t SYSID_MIN_FIT_SAMPLES = 30;  // fewer moving fit periods: no estimate
+
+// Seeding (staged in the ParamStore; "save" keeps them): lambda tuning for
+// closed-loop time constant SYSID_*_LAMBDA_S. Drive: PI on the wheel speed,
+// KP = tau / (K lambda), KI = 1 / (K lambda), plus KS / KV. Arms: PD on the
+// joint angle (integrator plus lag), KP = PWM_MAX / (K lambda), KD = KP tau.
+constexpr float SYSID_DRIVE_LAMBDA_S = 0.15f;
+constexpr float SYSID_ARM_LAMBDA_S = 0.25f;
+
+// Capture for the host: one sample (mean duty, count change per motor,
+// 5 bytes) per SYSID_DECIMATE drive ticks, streamed while the run goes as
+// binary PKT_SYSID frames at up to SYSID_STREAM_HZ (JSON mode: not sent).
+// Only the newest SYSID_RING_SAMPLES are held: 32 = 0.64 s of samples for
+// the stream to fall behind by, against 16 x 50 Hz of link capacity. A
+// drive run is SYSID_CAPTURE_SAMPLES long.
+constexpr uint8_t SYSID_DECIMATE = 2;
+constexpr uint16_t SYSID_CAPTURE_SAMPLES =
+    ((uint32_t)(SYSID_DRIVE_STEP_MS + SYSID_CHIRP_MS) * DRIVE_UPDATE_HZ / 1000UL + SYSID_DECIMATE - 1) / SYSID_DECIMATE;
+constexpr uint8_t SYSID_CHUNK_SAMPLES = 16;
+constexpr uint16_t SYSID_RING_SAMPLES = 32;
+constexpr uint16_t SYSID_STREAM_HZ = 50;
+
+static_assert(SYSID_ARM_STEP_MS <= SYSID_DRIVE_STEP_MS, "SYSID_CAPTURE_SAMPLES is the longest run");
+static_assert(SYSID_RING_SAMPLES % SYSID_CHUNK_SAMPLES == 0 && SYSID_RING_SAMPLES >= 2 * SYSID_CHUNK_SAMPLES,
+              "a whole chunk streams while the next one fills");
 
 /* ============================================================================
    TELEMETRY / COMMS
 ============================================================================ */
 
 constexpr uint32_t SERIAL_BAUD = 230400;
-constexpr uint16_t SERIAL_LINE_BUFFER_BYTES = 2048;
-constexpr size_t SERIAL_JSON_DOC_BYTES = 1536;  // start here; bump to 1536 if needed
+constexpr uint16_t SERIAL_LINE_MAX_BYTES = 2048;  // longer JSON lines are dropped (no buffer)
+
+// USART0 ring buffers (comms/Uart), powers of two. 512 B of RX is ~22 ms
+// of back-to-back input at SERIAL_BAUD, so a long loop stall drops nothing.
+constexpr uint16_t SERIAL_RX_RING_BYTES = 512;
+constexpr uint16_t SERIAL_TX_RING_BYTES = 128;
+
+// SerialLink TX stage: largest frame that isn't streamed, a JSON telemetry
+// line (~740 B with a full note and four sonar readings; link stats ~500 B,
+// binary frames <= 294 B). A perf line (~1.3 KB in JSON with every task
+// slot used) goes out in stage-sized pieces.
+constexpr uint16_t SERIAL_TX_FRAME_BYTES = 768;
+
+// Second link (SERIAL_AUX, Pins.h) to the Pi's GPIO UART: telemetry only.
+// Once the Pi has sent it one valid frame, encoder batches and perf frames
+// go there instead of USB; commands, notes and param replies stay on USB.
+// Meant for binary mode: its TX stage fits any binary frame, not a full
+// JSON telemetry line (counted in txOversize). 1 Mbaud is exact with U2X
+// at 16 MHz (UBRR = 1). Off by default: the second link, its stage and
+// the USART2 rings are ~2.7 KB of the 8 KB SRAM.
+constexpr bool ENABLE_AUX_LINK = false;
+constexpr uint32_t AUX_SERIAL_BAUD = 1000000;
+constexpr uint16_t AUX_RX_RING_BYTES = 64;     // pings / link / subscribe only
+constexpr uint16_t AUX_TX_RING_BYTES = 256;
+constexpr uint16_t AUX_TX_FRAME_BYTES = 384;
+constexpr uint16_t AUX_LINK_TIMEOUT_MS = 2000;  // no valid frame: back to USB (host pings at 2 Hz)
+
+// RX capture (comms/RxRecorder): every byte the USB SerialLink takes from
+// its port is copied, with the micros() it was taken at, to SERIAL_AUX as
+// PKT_RX_CAPTURE records, for offline replay in env:native (--replay).
+// Needs the aux UART, so ENABLE_AUX_LINK must be off. A tick's worth of
+// RX at SERIAL_BAUD (~60 B) fits the aux TX ring without waiting.
+constexpr bool ENABLE_RX_CAPTURE = false;
+constexpr uint8_t RX_CAPTURE_CHUNK_BYTES = 64;   // bytes per record (larger runs split)
+
+// Delta telemetry (JSON wire mode; the host turns it on with
+// {"type":"tlm","delta":1}). Between keyframes only fields that moved more
+// than their epsilon since they were last sent go out ("tdelta" frames).
+constexpr bool TELEMETRY_DELTA_AT_BOOT = false;
+constexpr uint16_t TELEMETRY_KEYFRAME_EVERY = 20;   // frames (1 s at TELEMETRY_UPDATE_HZ)
+constexpr float TELEMETRY_EPS_RPM = 0.5f;
+constexpr float TELEMETRY_EPS_DEG = 0.5f;
+constexpr float TELEMETRY_EPS_IN  = 0.2f;
+constexpr float TELEMETRY_EPS_FT  = 0.01f;   // odometry pose / sigma
+constexpr float TELEMETRY_EPS_INPS = 0.5f;   // ultrasonic closing rate
+constexpr float TELEMETRY_EPS_CONF = 0.1f;   // ultrasonic confidence (1/8 steps)
+
+// Per-group telemetry ({"type":"subscribe",...}, see TelemetrySubscription).
+// Until the host subscribes, full frames go out at the wire mode's rate.
+// Typical host subscription: wheel 100 Hz (odometry), ultrasonic 15 Hz
+// (sensor rate), mech 5 Hz, notes on change.
+constexpr uint16_t TELEMETRY_GROUP_MAX_HZ = 200;   // requested rates are capped here
+constexpr uint16_t TELEMETRY_NOTE_POLL_HZ = 10;    // note-only subscription check rate
+
+// Telemetry credit (host backpressure, comms/SerialLink): a host that
+// echoes the newest tel_seq it has read as "tel_ack" in its commands gets
+// at most TELEMETRY_CREDIT_FRAMES publications unread; past that the link
+// holds telemetry and sends one full frame per TELEMETRY_CREDIT_PROBE_MS.
+// At 200 Hz binary and 20 Hz commands ~10 publications go out between two
+// acks, so the limit is about two command periods of telemetry.
+constexpr uint16_t TELEMETRY_CREDIT_FRAMES = 24;
+constexpr uint16_t TELEMETRY_CREDIT_PROBE_MS = 100;
+constexpr uint32_t TELEMETRY_CREDIT_TIMEOUT_MS = COMMAND_TIMEOUT_MS;   // no tel_ack: credit off
+
+// Clock sync with the host (comms/TimeSync, "ping"/"pong" frames). The
+// host pings at a few Hz; TIMESYNC_SYNC_EXCHANGES good exchanges are needed
+// before telemetry carries host_time_us.
+constexpr uint32_t TIMESYNC_MAX_DELAY_US = 20000;    // slower round trips are ignored
+constexpr uint32_t TIMESYNC_DELAY_SLACK_US = 2000;   // allowed over the fastest recent trip
+constexpr uint32_t TIMESYNC_RESYNC_US = 50000;       // larger error restarts the estimate
+constexpr float TIMESYNC_OFFSET_GAIN = 0.25f;        // share of the offset error applied
+constexpr float TIMESYNC_DRIFT_GAIN = 0.005f;        // share of the error rate applied
+constexpr float TIMESYNC_MAX_DRIFT_PPM = 5000.0f;    // ceramic resonator is +/-0.5%
+constexpr uint16_t TIMESYNC_SYNC_EXCHANGES = 4;
+
+// Timed setpoints ("cmd" frames with at_ms, comms/CommandQueue): the host
+// can queue a short trajectory and watch queue_free in telemetry
+constexpr uint8_t COMMAND_QUEUE_DEPTH = 8;              // CommandFrames (~45 B each)
+constexpr uint32_t COMMAND_QUEUE_MAX_AHEAD_MS = 2000;   // later at_ms is rejected
+
+// Wire format at boot. JSON stays available as the debug fallback; the host
+// can switch at runtime with a "link" frame (see comms/BinaryProtocol.h).
+constexpr bool SERIAL_BINARY_AT_BOOT = false;
+
+// Staged boot (main.cpp setup()): the links come up first and send a
+// "hello" (comms/Messages.h HelloFrame), then the actuators and sensors.
+// The host waits for it instead of sleeping over the bootloader, and may
+// configure the link while the rest of setup() runs (RX rings buffer it).
+constexpr uint16_t FIRMWARE_VERSION = 104;   // major * 100 + minor, reported in the hello
 
 
 /* ============================================================================
    DEBUG / SAFETY FLAGS
 ============================================================================ */
 
+// Hardware WDT (utils/Watchdog), kicked every loop while the control loop
+// is alive. Needs a Mega bootloader that survives a WDT reset (stock since
+// 2012); an old stk500v2 one loops in the bootloader instead.
 constexpr bool ENABLE_WATCHDOG = true;
+constexpr uint16_t WATCHDOG_HW_TIMEOUT_MS = 500;   // rounded down to a WDTO_* step
 constexpr bool ENABLE_SERIAL_DEBUG = false;
 
+// Event log (utils/EventLog): the last EVENT_LOG_RECORDS events (10 B
+// each) in RAM, repeats of the newest one folded into it. The host reads
+// it with {"type":"log","op":"dump"}: binary PKT_EVENT_LOG frames of up
+// to EVENT_LOG_CHUNK_RECORDS at EVENT_LOG_DUMP_HZ (JSON mode: not sent).
+constexpr uint8_t EVENT_LOG_RECORDS = 32;        // power of two
+constexpr uint8_t EVENT_LOG_CHUNK_RECORDS = 16;
+constexpr uint16_t EVENT_LOG_DUMP_HZ = 50;
+
+// GPIO scope markers (utils/ScopeMarker.h, pin map in Pins.h): a pulse per
+// task run and per ISR for a logic analyzer, two register writes each.
+// Off in normal builds (the pins stay inputs).
+constexpr bool ENABLE_SCOPE_MARKERS = false;
+
 /* ============================================================================
    SERVO RAMP / DETACH BEHAVIOR
 ============================================================================ */
@@ -177,11 +551,103 @@ constexpr float SWEEP_SERVO_RAMP_DPS = 10.0f;
 // How close is "at target"
 constexpr float SERVO_DEADBAND_DEG = 2.0f;
 
+// Coordinated moves (control/MotionProfile): servo targets from one
+// command become one accel-limited, time-synchronized move (all axes
+// arrive together). Cruise speed is capped at the ramp rates above.
+constexpr bool ENABLE_MOTION_PROFILES = true;
+constexpr uint8_t MOTION_MAX_AXES = 4;             // lid, sweep, arm LHS/RHS
+constexpr float LID_SERVO_ACCEL_DPS2   = 50.0f;
+constexpr float SWEEP_SERVO_ACCEL_DPS2 = 20.0f;
+
+// Hold policy, per servo: what happens once it has sat at its target for
+// *_SETTLE_MS. A detached servo draws no holding current and, with both
+// detached, the Servo library stops its timer (Timer5 on the Mega) and
+// its compare interrupts altogether.
+//   SERVO_HOLD_ALWAYS   keep pulsing (holds torque)
+//   SERVO_HOLD_CLOSED   detach only at the closed / stow setpoint
+//   SERVO_HOLD_SETTLED  detach at any target
+// A detached servo re-attaches on its next target, and on a disturbance
+// (ServoPair::disturb: the drive running) unless it rests at the closed
+// setpoint. Timer5 is free only while both are detached, so it can't be
+// handed to other work permanently.
+constexpr uint8_t SERVO_HOLD_ALWAYS  = 0;
+constexpr uint8_t SERVO_HOLD_CLOSED  = 1;
+constexpr uint8_t SERVO_HOLD_SETTLED = 2;
+
 // How long to sit at target before detaching (ms)
 constexpr uint32_t LID_SERVO_SETTLE_MS = 1000;
 
-// Lid: gravity holds closed, so detach after closing
-constexpr bool LID_SERVO_AUTO_DETACH_ON_CLOSED = true;
+// Lid: gravity holds closed, so detach after closing; open needs torque
+constexpr uint8_t LID_SERVO_HOLD = SERVO_HOLD_CLOSED;
 
+// Sweep: friction holds it between moves; the drive running re-asserts it
 constexpr uint32_t SWEEP_SERVO_SETTLE_MS = 1000;
-constexpr bool SWEEP_SERVO_AUTO_DETACH_ON_CLOSED = true; // usually false
+constexpr uint8_t SWEEP_SERVO_HOLD = SERVO_HOLD_SETTLED;
+
+// Cost of one Servo library compare interrupt (us, estimate for 16 MHz:
+// vector + handle_interrupts). With any servo attached the timer fires once
+// per allocated channel plus once for the rest of each 20 ms frame (with
+// none, ServoPair turns the interrupt off); the perf "servo" block reports
+// the resulting ISR share from this figure.
+constexpr uint8_t SERVO_ISR_US = 6;
+constexpr uint16_t SERVO_FRAME_US = 20000;     // the library's REFRESH_INTERVAL
+
+// Pulse width (us) at 0 and 180 deg, per servo. Angles are output with
+// writeMicroseconds along this line (~0.1 deg per us). The defaults are
+// the Servo library's own mapping; calibrate by commanding the mechanical
+// stops and reading the pulse that reaches them.
+constexpr uint16_t LID_SERVO_US_AT_0     = 544;
+constexpr uint16_t LID_SERVO_US_AT_180   = 2400;
+constexpr uint16_t SWEEP_SERVO_US_AT_0   = 544;
+constexpr uint16_t SWEEP_SERVO_US_AT_180 = 2400;
+
+/* ============================================================================
+   ON-BOARD SEQUENCES (control/Sequencer)
+============================================================================ */
+
+// A WAIT_* step with timeout_ms = 0 gives up after this long and moves on
+constexpr uint16_t SEQ_DEFAULT_TIMEOUT_MS = 10000;
+
+// Built-in "pickup": open the lid and deploy the sweep, creep forward over
+// the object, sweep it in, close up. Sweep travel (50 deg at 10 deg/s) is
+// the slowest move, ~5.5 s.
+constexpr float PICKUP_CREEP_FTPS = 0.5f;
+constexpr float PICKUP_CREEP_FT = 0.75f;
+constexpr uint16_t PICKUP_SERVO_TIMEOUT_MS = 8000;
+constexpr uint16_t PICKUP_CREEP_TIMEOUT_MS = 4000;
+
+/* ============================================================================
+   PATH FOLLOWING (control/PathFollower)
+============================================================================ */
+
+// Pure pursuit on the odometry pose, every drive tick. The lookahead sets
+// how tightly corners are cut: shorter tracks closer but weaves more.
+constexpr float PATH_DEFAULT_SPEED_FTPS = 1.0f;
+constexpr float PATH_LOOKAHEAD_FT = 0.75f;
+constexpr float PATH_MIN_LOOKAHEAD_FT = 0.25f;
+
+// Done once this close to the last point (or past it)
+constexpr float PATH_GOAL_TOLERANCE_FT = 0.1f;
+
+// Speed along the path: brakes into the goal on this curve, never below
+// the crawl speed (so the last few inches still get covered), and slows
+// down so the turn rate a tight curve asks for stays under the cap
+constexpr float PATH_DECEL_FTPS2 = 1.0f;
+constexpr float PATH_MIN_SPEED_FTPS = 0.2f;
+constexpr float PATH_MAX_ANGULAR_DPS = 90.0f;
+
+/* ============================================================================
+   PARAMETER STORE (utils/ParamStore)
+============================================================================ */
+
+// The gains, limits, ramps and rates above marked tunable in
+// utils/ParamStore.cpp can be changed at runtime ("param" frames) and
+// saved to EEPROM; the values here stay the defaults. Bump the version
+// whenever the stored set changes (a mismatched image boots the defaults).
+constexpr uint8_t PARAM_STORE_VERSION = 3;
+constexpr uint16_t PARAM_EEPROM_ADDR = 0;
+
+// Fastest per-sensor ping rate whose slot still outlasts the echo timeout
+// plus ring-down (the live ULTRASONIC_UPDATE_HZ is capped here)
+constexpr uint16_t ULTRASONIC_MAX_UPDATE_HZ =
+    (uint16_t)(1000UL / ((uint32_t)ULTRASONIC_SLOTS * (ULTRASONIC_TIMEOUT_US / 1000UL + ULTRASONIC_RINGDOWN_MS)));
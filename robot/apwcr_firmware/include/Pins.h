@@ -43,33 +43,46 @@ constexpr uint8_t PIN_RHS_DRIVE_PWM = 6;  // IN2 (PWM)
 /* ============================================================================
    QUADRATURE ENCODER PINS
    Channel A = External Interrupt
-   Channel B = External or Pin-Change Interrupt
+   Channel B = External Interrupt (drive) or plain GPIO (arm)
+   sensors/QuadratureEncoder picks each INTn vector from these pins; the
+   comments give the AVR vector (not the attachInterrupt() number)
 ============================================================================ */
 
 // LHS Arm Encoder
-constexpr uint8_t PIN_ENC_LHS_ARM_A = 18; // INT5 (TX1)
-constexpr uint8_t PIN_ENC_LHS_ARM_B = 22; // GPIO / PCINT
+constexpr uint8_t PIN_ENC_LHS_ARM_A = 18; // INT3 (TX1)
+constexpr uint8_t PIN_ENC_LHS_ARM_B = 22; // GPIO, read on A edges
 
 // RHS Arm Encoder
-constexpr uint8_t PIN_ENC_RHS_ARM_A = 19; // INT4 (RX1)
-constexpr uint8_t PIN_ENC_RHS_ARM_B = 23; // GPIO / PCINT
+constexpr uint8_t PIN_ENC_RHS_ARM_A = 19; // INT2 (RX1)
+constexpr uint8_t PIN_ENC_RHS_ARM_B = 23; // GPIO, read on A edges
 
 // LHS Drive Encoder
-constexpr uint8_t PIN_ENC_LHS_DRIVE_A = 2;  // INT0
+constexpr uint8_t PIN_ENC_LHS_DRIVE_A = 2;  // INT4
 constexpr uint8_t PIN_ENC_LHS_DRIVE_B = 20; // INT1
 
 // RHS Drive Encoder
-constexpr uint8_t PIN_ENC_RHS_DRIVE_A = 3;  // INT1
-constexpr uint8_t PIN_ENC_RHS_DRIVE_B = 21; // INT2
+constexpr uint8_t PIN_ENC_RHS_DRIVE_A = 3;  // INT5
+constexpr uint8_t PIN_ENC_RHS_DRIVE_B = 21; // INT0
 
 /* ============================================================================
    ULTRASONIC DISTANCE SENSOR (HC-SR04)
 ============================================================================ */
 // NOTE: Screw-terminal shield mapping for D24/D25 was unreliable.
 // Ultrasonic validated working on D7/D8.
+// Echo moved D7 -> A8: the driver timestamps echo edges in an interrupt and
+// D7 has neither INTn nor PCINTn. A8 = PK0 / PCINT16 (trigger stays on D8).
 
 constexpr uint8_t PIN_ULTRASONIC_TRIG = 8;
-constexpr uint8_t PIN_ULTRASONIC_ECHO = 7;
+constexpr uint8_t PIN_ULTRASONIC_ECHO = A8;   // PCINT16 (must be interrupt-capable)
+
+// Extra sensors for DistanceSensorArray (ULTRASONIC_SENSOR_COUNT in
+// Params.h). Echoes share PCINT2 with the front sensor.
+constexpr uint8_t PIN_ULTRASONIC_FL_TRIG   = 34;
+constexpr uint8_t PIN_ULTRASONIC_FL_ECHO   = A9;    // PCINT17
+constexpr uint8_t PIN_ULTRASONIC_FR_TRIG   = 35;
+constexpr uint8_t PIN_ULTRASONIC_FR_ECHO   = A10;   // PCINT18
+constexpr uint8_t PIN_ULTRASONIC_REAR_TRIG = 36;
+constexpr uint8_t PIN_ULTRASONIC_REAR_ECHO = A11;   // PCINT19
 
 /* ============================================================================
    SERVO SIGNAL PINS
@@ -83,10 +96,38 @@ constexpr uint8_t PIN_SERVO_SWEEP = A0;
    SERIAL INTERFACES
 ============================================================================ */
 
-// USB Serial (Laptop ↔ Arduino)
-#define SERIAL_USB Serial
+// USB Serial (Laptop ↔ Arduino). comms/Uart driver on USART0; the core's
+// `Serial` must not be used (both would claim the USART0 interrupts).
+#define SERIAL_USB Uart0
+
+// Pi 5 GPIO UART (telemetry offload, ENABLE_AUX_LINK). comms/Uart driver
+// on USART2: D16 (TX2) -> Pi GPIO15 (RXD), D17 (RX2) <- Pi GPIO14 (TXD).
+// The Pi is 3.3 V: its TXD drives RX2 directly (3.0 V reads high), TX2
+// needs a divider or level shifter before it reaches the Pi.
+#define SERIAL_AUX Uart2
+
+// USART1's pins are the arm encoders' A channels (INT2/INT3 above)
+// Serial1 -> D19 (RX1), D18 (TX1)   taken
+// Serial3 -> D15 (RX3), D14 (TX3)   reserved (not currently used)
+
+/* ============================================================================
+   SCOPE MARKERS (ENABLE_SCOPE_MARKERS, utils/ScopeMarker.h)
+   Logic analyzer outputs: each goes high for the length of one task run or
+   ISR. Toggled with a single write to the port's PINx register (one STS /
+   OUT, atomic, so ISRs and tasks can share a port). Tasks and ISRs on
+   PORTL (D42..D49, one analyzer byte), the UART ISRs on PORTG.
+============================================================================ */
 
-// Reserved hardware serials (not currently used)
-// Serial1 -> D19 (RX1), D18 (TX1)
-// Serial2 -> D17 (RX2), D16 (TX2)
-// Serial3 -> D15 (RX3), D14 (TX3)
+// PORTL: bit = Pxn, pin = Mega header
+constexpr uint8_t PIN_SCOPE_RX          = 49;   // PL0  taskRx
+constexpr uint8_t PIN_SCOPE_DRIVE       = 48;   // PL1  taskDrive
+constexpr uint8_t PIN_SCOPE_ULTRASONIC  = 47;   // PL2  taskUltrasonic
+constexpr uint8_t PIN_SCOPE_SERVO       = 46;   // PL3  taskServo
+constexpr uint8_t PIN_SCOPE_TELEMETRY   = 45;   // PL4  taskTelemetry / taskAuxTelemetry
+constexpr uint8_t PIN_SCOPE_SAMPLER_ISR = 44;   // PL5  TIMER1_COMPA (EncoderSampler)
+constexpr uint8_t PIN_SCOPE_ENCODER_ISR = 43;   // PL6  INT0..INT5 (QuadratureEncoder)
+constexpr uint8_t PIN_SCOPE_ECHO_ISR    = 42;   // PL7  PCINT0..2 (DistanceSensor echo)
+
+// PORTG
+constexpr uint8_t PIN_SCOPE_UART0_ISR   = 41;   // PG0  USART0 RX / UDRE (USB link)
+constexpr uint8_t PIN_SCOPE_UART2_ISR   = 40;   // PG1  USART2 RX / UDRE (aux link)
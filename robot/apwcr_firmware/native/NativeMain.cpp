@@ -0,0 +1,2118 @@
+/*
+  APWCR Host Throughput Harness (env:native)
+
+  Purpose:
+  Replays captured host->Arduino serial traffic through the firmware's
+  comms code on the PC and reports frames/s and bytes/s, so throughput
+  regressions in SerialLink / Protocol / BinaryProtocol / ServoActuator
+  show up before anything is flashed. Arduino calls resolve to the mock HAL
+  in native/hal.
+
+  Usage:
+    pio run -e native && .pio/build/native/program [capture.cap] [reps]
+    .pio/build/native/program --replay field.rxcap [timeline.csv]
+
+  The default capture is native/captures/cmd_stream.cap (JSON commands, a
+  link switch, then binary commands; see make_captures.py). Host figures
+  are only useful relative to each other: AVR cycle counts come from
+  env:mega_bench.
+
+  Exit status is non-zero if the replay decodes a different number of
+  commands than the capture holds, so this also works as a smoke check.
+
+  --replay runs a field RX capture (comms/RxRecorder) through the receive
+  and apply path on the capture's own clock instead (native/RxReplay.h),
+  printing a summary and optionally a CSV timeline.
+*/
+
+#include <Arduino.h>
+
+#include <chrono>
+#include <string>
+#include <stdio.h>
+#include <vector>
+
+#include "Pins.h"
+#include "Params.h"
+
+#include "comms/Messages.h"
+#include "comms/Protocol.h"
+#include "comms/BinaryProtocol.h"
+#include "comms/CommandParser.h"
+#include "comms/CommandQueue.h"
+#include "comms/RxRecorder.h"
+#include "comms/SerialLink.h"
+#include "comms/TelemetryDelta.h"
+#include "comms/TimeSync.h"
+#include "actuators/ServoActuator.h"
+#include "actuators/ServoActuatorT.h"
+#include "actuators/ServoPair.h"
+#include "actuators/DcMotorActuator.h"
+#include "control/DriveInnerLoop.h"
+#include "control/MotionProfile.h"
+#include "control/ObstacleGuard.h"
+#include "control/PathFollower.h"
+#include "control/PIDFx.h"
+#include "control/Sequencer.h"
+#include "control/SysId.h"
+#include "sensors/Odometry.h"
+#include "sensors/RangeFilter.h"
+#include "utils/EventLog.h"
+#include "utils/ParamStore.h"
+#include "utils/Profiler.h"
+#include "utils/Rate.h"
+#include "utils/Scheduler.h"
+#include "utils/Watchdog.h"
+
+#include "Replay.h"
+#include "RxReplay.h"
+
+
+/*=============================================================================
+  HARNESS
+=============================================================================*/
+
+namespace {
+
+const char* const DEFAULT_CAPTURE = "native/captures/cmd_stream.cap";
+
+// Bytes made readable per SerialLink::tick (a 64 B UART RX buffer)
+constexpr size_t RX_CHUNK_BYTES = 64;
+
+struct Capture {
+  std::vector<uint8_t> bytes;
+  std::vector<std::string> json_lines;              // command lines only
+  std::vector<std::vector<uint8_t>> binary_frames;  // COBS, without 0x00
+  size_t commands = 0;
+};
+
+struct Timer {
+  std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+  double seconds() const {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+  }
+};
+
+int g_failures = 0;
+
+void printHeader() {
+  printf("%-32s %12s %14s %10s\n", "case", "frames/s", "bytes/s", "ns/frame");
+}
+
+void printRow(const char* name, uint64_t frames, uint64_t bytes, double s) {
+  if (s <= 0.0) s = 1e-9;
+  printf("%-32s %12.0f %14.0f %10.1f\n",
+         name, (double)frames / s, (double)bytes / s, frames ? (s * 1e9) / (double)frames : 0.0);
+}
+
+void check(bool ok, const char* what) {
+  if (ok) return;
+  printf("FAIL: %s\n", what);
+  g_failures++;
+}
+
+bool loadCapture(const char* path, Capture& cap) {
+  FILE* f = fopen(path, "rb");
+  if (!f) return false;
+
+  uint8_t buf[4096];
+  size_t n;
+  while ((n = fread(buf, 1, sizeof(buf), f)) > 0) {
+    cap.bytes.insert(cap.bytes.end(), buf, buf + n);
+  }
+  fclose(f);
+
+  // Split the same way the firmware does: '\n' lines until the link
+  // request, 0x00-delimited COBS frames after it
+  bool binary = false;
+  std::vector<uint8_t> cur;
+  for (uint8_t c : cap.bytes) {
+    if (!binary) {
+      if (c == '\0') continue;
+      if (c != '\n') { cur.push_back(c); continue; }
+
+      std::string line(cur.begin(), cur.end());
+      cur.clear();
+      WireMode mode;
+      if (protocol::decodeLinkLine(line.c_str(), mode)) {
+        binary = (mode == WireMode::BINARY);
+      } else {
+        cap.json_lines.push_back(line);
+      }
+    } else {
+      if (c != '\0') { cur.push_back(c); continue; }
+      if (!cur.empty()) cap.binary_frames.push_back(cur);
+      cur.clear();
+    }
+  }
+
+  cap.commands = cap.json_lines.size() + cap.binary_frames.size();
+  return true;
+}
+
+TelemetryFrame sampleTelemetry(uint32_t i) {
+  TelemetryFrame t;
+  t.arduino_time_ms = 1000 + i * 50;
+  t.ack_seq = i;
+  t.wheel.left_rpm = 42.5f + (float)(i & 7);
+  t.wheel.right_rpm = -41.25f;
+  t.mech.servo_LID_deg = 90.0f;
+  t.mech.servo_SWEEP_deg = (float)(i % 100);
+  t.ultrasonic.distance_in = 17.3f;
+  t.ultrasonic.valid = true;
+  return t;
+}
+
+
+/*=============================================================================
+  CASES
+=============================================================================*/
+
+// Whole capture through SerialLink::tick, both wire modes
+void caseSerialLink(const Capture& cap, int reps) {
+  ReplayStream rx(cap.bytes.data(), cap.bytes.size());
+  uint8_t stage[SERIAL_TX_FRAME_BYTES];
+  SerialLink link(rx, stage, sizeof(stage));
+
+  uint64_t frames = 0;
+  uint64_t bytes = 0;
+  uint32_t last_ack = 0;
+  uint32_t ok = 0;
+
+  Timer t;
+  for (int r = 0; r < reps; r++) {
+    rx.rewind();
+    link.begin();
+    link.setWireMode(WireMode::JSON);
+
+    uint32_t now_ms = 0;
+    while (rx.refill(RX_CHUNK_BYTES)) {
+      link.tick(now_ms);
+      now_ms++;
+    }
+    frames += link.rxOk();
+    bytes += cap.bytes.size();
+    last_ack = link.ackSeq();
+    ok = link.rxOk();
+  }
+  printRow("SerialLink::tick (replay)", frames, bytes, t.seconds());
+
+  // Every command plus the link request
+  check(ok == cap.commands + 1, "SerialLink accepted every frame in the capture");
+  check(last_ack == cap.commands, "SerialLink ack_seq reached the last command");
+
+  LinkStatsFrame ls;
+  link.linkStats(ls, 0);
+  check(ls.seq_gaps == 0 && ls.seq_stale == 0, "no seq gaps in a lossless capture");
+  check(ls.parse_count == ok, "parse time recorded once per frame");
+}
+
+void caseDecodeCommandLine(const Capture& cap, int reps) {
+  uint64_t frames = 0;
+  uint64_t bytes = 0;
+  size_t decoded = 0;
+
+  Timer t;
+  for (int r = 0; r < reps; r++) {
+    decoded = 0;
+    for (const std::string& line : cap.json_lines) {
+      CommandFrame cmd;
+      if (protocol::decodeCommandLine(line.c_str(), cmd)) decoded++;
+      bytes += line.size() + 1;
+    }
+    frames += cap.json_lines.size();
+  }
+  printRow("protocol::decodeCommandLine", frames, bytes, t.seconds());
+  check(decoded == cap.json_lines.size(), "decodeCommandLine accepted every JSON line");
+}
+
+void caseDecodeBinary(const Capture& cap, int reps) {
+  uint64_t frames = 0;
+  uint64_t bytes = 0;
+  size_t decoded = 0;
+  uint8_t buf[protocol::bin::MAX_FRAME_BYTES];
+
+  Timer t;
+  for (int r = 0; r < reps; r++) {
+    decoded = 0;
+    for (const std::vector<uint8_t>& f : cap.binary_frames) {
+      if (f.size() > sizeof(buf)) continue;
+      memcpy(buf, f.data(), f.size());
+
+      const uint8_t* payload = nullptr;
+      size_t payload_len = 0;
+      CommandFrame cmd;
+      if (protocol::bin::decodeFrame(buf, f.size(), payload, payload_len) == protocol::bin::PKT_CMD &&
+          protocol::bin::decodeCommandPayload(payload, payload_len, cmd)) {
+        decoded++;
+      }
+      bytes += f.size() + 1;
+    }
+    frames += cap.binary_frames.size();
+  }
+  printRow("bin::decodeFrame+CommandPayload", frames, bytes, t.seconds());
+  check(decoded == cap.binary_frames.size(), "binary decode accepted every COBS frame");
+}
+
+void caseEncodeTelemetry(int reps) {
+  const uint32_t n = 1000;
+  CountingPrint out('\n');
+
+  Timer t;
+  for (int r = 0; r < reps; r++) {
+    for (uint32_t i = 0; i < n; i++) protocol::encodeTelemetryLine(sampleTelemetry(i), out);
+  }
+  printRow("protocol::encodeTelemetryLine", out.frames(), out.bytes(), t.seconds());
+  check(out.frames() == (uint64_t)n * reps, "one JSON line per telemetry frame");
+
+  CountingPrint out_bin('\0');
+  Timer tb;
+  for (int r = 0; r < reps; r++) {
+    for (uint32_t i = 0; i < n; i++) protocol::bin::encodeTelemetryFrame(sampleTelemetry(i), out_bin);
+  }
+  printRow("bin::encodeTelemetryFrame", out_bin.frames(), out_bin.bytes(), tb.seconds());
+  check(out_bin.frames() == (uint64_t)n * reps, "one COBS frame per telemetry frame");
+
+}
+
+// Parked robot: only the clock and the sensor noise move
+void caseTelemetryDelta(int reps) {
+  const uint32_t n = 1000;
+  CountingPrint full('\n');
+  CountingPrint delta('\n');
+  TelemetryDelta enc;
+
+  TelemetryFrame t = sampleTelemetry(0);
+  t.wheel.left_rpm = 0.0f;
+  t.wheel.right_rpm = 0.0f;
+
+  Timer td;
+  for (int r = 0; r < reps; r++) {
+    for (uint32_t i = 0; i < n; i++) {
+      t.arduino_time_ms += 50;
+      t.ultrasonic.distance_in = 17.3f + 0.05f * (float)(i % 3);
+      enc.encodeLine(t, delta);
+    }
+  }
+  printRow("TelemetryDelta (parked)", delta.frames(), delta.bytes(), td.seconds());
+
+  for (uint32_t i = 0; i < n; i++) protocol::encodeTelemetryLine(t, full);
+  const double ratio = (double)full.bytes() * reps / (double)(delta.bytes() ? delta.bytes() : 1);
+  printf("%-32s %12.1fx\n", "  bytes saved vs full lines", ratio);
+  check(ratio >= 3.0, "delta telemetry is >= 3x smaller on a parked robot");
+}
+
+// Ramping servo, one tick per SERVO_UPDATE_HZ period of mock time
+void caseServoTick(int reps) {
+  ServoActuator servo(PIN_SERVO_SWEEP, SERVO_MIN_DEG, SERVO_MAX_DEG, SWEEP_SERVO_RAMP_DPS,
+                      SERVO_DEADBAND_DEG, SWEEP_SERVO_SETTLE_MS, false, (float)SWEEP_STOW_DEG);
+  const uint32_t period_ms = 1000 / SERVO_UPDATE_HZ;
+  const uint32_t n = 10000;
+
+  hal::reset();
+  servo.begin((float)SWEEP_STOW_DEG);
+
+  uint64_t ticks = 0;
+  Timer t;
+  for (int r = 0; r < reps; r++) {
+    for (uint32_t i = 0; i < n; i++) {
+      if ((i % 600) == 0) servo.setTargetDeg((i % 1200) ? (float)SERVO_MIN_DEG : (float)SERVO_MAX_DEG, millis());
+      hal::advanceMicros(period_ms * 1000UL);
+      servo.tick(millis());
+      ticks++;
+    }
+  }
+  printRow("ServoActuator::tick", ticks, 0, t.seconds());
+  check(servo.getState().current_deg >= SERVO_MIN_DEG && servo.getState().current_deg <= SERVO_MAX_DEG,
+        "servo stayed within limits");
+}
+
+// Compile-time servo, same config and target pattern as caseServoTick
+void caseServoTickT(int reps) {
+  using Sweep = ServoActuatorT<PIN_SERVO_SWEEP,
+                               servo_t::ddeg(SERVO_MIN_DEG), servo_t::ddeg(SERVO_MAX_DEG),
+                               servo_t::ddeg(SWEEP_SERVO_RAMP_DPS), servo_t::ddeg(SERVO_DEADBAND_DEG),
+                               SWEEP_SERVO_SETTLE_MS, SERVO_HOLD_ALWAYS, servo_t::ddeg(SWEEP_STOW_DEG),
+                               SERVO_UPDATE_HZ, SWEEP_SERVO_US_AT_0, SWEEP_SERVO_US_AT_180>;
+  Sweep servo;
+  const uint32_t period_ms = 1000 / SERVO_UPDATE_HZ;
+  const uint32_t n = 10000;
+
+  hal::reset();
+  servo.begin((float)SWEEP_STOW_DEG);
+
+  // Full travel should take (travel / ramp) seconds of ticks at SERVO_UPDATE_HZ
+  const uint32_t travel_ticks =
+      (uint32_t)((SERVO_MAX_DEG - SERVO_MIN_DEG) / SWEEP_SERVO_RAMP_DPS * SERVO_UPDATE_HZ + 0.5f);
+  uint32_t reached_at = 0;
+
+  // Pulse changes during the first full-travel ramp (one per tick if the
+  // sub-degree steps reach the output)
+  uint32_t pulse_changes = 0;
+  uint16_t last_pulse = 0;
+
+  uint64_t ticks = 0;
+  Timer t;
+  for (int r = 0; r < reps; r++) {
+    for (uint32_t i = 0; i < n; i++) {
+      if ((i % 1200) == 0) servo.setTargetDeg((float)SERVO_MIN_DEG, millis());
+      if ((i % 1200) == 600) servo.setTargetDeg((float)SERVO_MAX_DEG, millis());
+      hal::advanceMicros(period_ms * 1000UL);
+      servo.tick(millis());
+      if (r == 0 && i >= 600 && !reached_at &&
+          servo.getState().current_ddeg == servo_t::ddeg(SERVO_MAX_DEG)) {
+        reached_at = i + 1 - 600;
+      }
+      if (r == 0 && i >= 600 && !reached_at) {
+        if (servo.getState().pulse_us != last_pulse) pulse_changes++;
+      }
+      last_pulse = servo.getState().pulse_us;
+      ticks++;
+    }
+  }
+  printRow("ServoActuatorT::tick", ticks, 0, t.seconds());
+  check(servo.getState().current_ddeg >= servo_t::ddeg(SERVO_MIN_DEG) &&
+        servo.getState().current_ddeg <= servo_t::ddeg(SERVO_MAX_DEG),
+        "template servo stayed within limits");
+  check(reached_at + 1 >= travel_ticks && reached_at <= travel_ticks + 1,
+        "template servo ramps at the configured rate");
+  check(pulse_changes + 2 >= reached_at && reached_at > (uint32_t)(SERVO_MAX_DEG - SERVO_MIN_DEG),
+        "sub-degree ramp steps reach the pulse output");
+}
+
+// Hold policy: the sweep (SERVO_HOLD_SETTLED) lets go at any target after
+// its settle time, the lid (SERVO_HOLD_CLOSED) only at closed; disturb()
+// brings the sweep back but leaves the closed lid alone
+void caseServoHold() {
+  hal::reset();
+  LidServo lid;
+  SweepServo sweep;
+  lid.begin((float)LID_CLOSED_DEG);
+  sweep.begin((float)SWEEP_STOW_DEG);
+  ServoPair<LidServo, SweepServo> servos(lid, sweep);
+
+  const uint32_t period_us = 1000000UL / SERVO_UPDATE_HZ;
+  auto run = [&](uint32_t ms) {
+    for (uint32_t t = 0; t < ms * 1000UL; t += period_us) {
+      hal::advanceMicros(period_us);
+      servos.tick(millis());
+    }
+  };
+
+  const float lid_open = (float)LID_CLOSED_DEG + 30.0f;
+  const float sweep_mid = (float)SWEEP_STOW_DEG + 20.0f;
+  servos.command(true, lid_open, true, sweep_mid, LID_SERVO_RAMP_DPS, SWEEP_SERVO_RAMP_DPS, millis());
+  run(4000 + SWEEP_SERVO_SETTLE_MS + 200);
+  check(servos.settled() && lid.isAttached() && !sweep.isAttached(),
+        "SETTLED servo detaches away from closed, CLOSED servo holds");
+  check(servos.stats().attached == 1 && servos.stats().detaches == 1, "servo stats count the detach");
+
+  servos.disturb(millis());
+  check(sweep.isAttached() && sweep.getState().pulse_us != 0, "disturb re-attaches a released servo");
+  run(SWEEP_SERVO_SETTLE_MS / 2);
+  servos.disturb(millis());
+  run(SWEEP_SERVO_SETTLE_MS / 2 + 100);
+  check(sweep.isAttached(), "disturb restarts the settle time");
+  run(SWEEP_SERVO_SETTLE_MS);
+  check(!sweep.isAttached(), "released again once the disturbance stops");
+
+  servos.command(true, (float)LID_CLOSED_DEG, true, (float)SWEEP_STOW_DEG,
+                 LID_SERVO_RAMP_DPS, SWEEP_SERVO_RAMP_DPS, millis());
+  run(50);
+  check(sweep.isAttached(), "a new target re-attaches");
+  run(4000 + LID_SERVO_SETTLE_MS + 200);
+  servos.resetWindow();
+  run(1000);
+  servos.disturb(millis());
+  check(servos.attached() == 0 && servos.stats().isrPpm() == 0,
+        "both released at closed: the Servo timer is idle, disturb keeps it so");
+
+  printf("%-32s %12u detaches, isr %u ppm while held\n", "  servo hold policy",
+         (unsigned)servos.stats().detaches,
+         (unsigned)(ServoPair<LidServo, SweepServo>::ISR_PER_FRAME * SERVO_ISR_US * 1000000UL / SERVO_FRAME_US));
+}
+
+// Lid + sweep pickup move: both axes must arrive together, inside their
+// own speed/accel limits
+void caseMotionProfile(int reps) {
+  MotionProfile::AxisMove m[2];
+  m[0].from = (float)LID_CLOSED_DEG;  m[0].to = (float)LID_OPEN_DEG;
+  m[0].vmax = LID_SERVO_RAMP_DPS;     m[0].amax = LID_SERVO_ACCEL_DPS2;
+  m[1].from = (float)SWEEP_STOW_DEG;  m[1].to = (float)SWEEP_DEPLOY_DEG;
+  m[1].vmax = SWEEP_SERVO_RAMP_DPS;   m[1].amax = SWEEP_SERVO_ACCEL_DPS2;
+
+  MotionProfile profile;
+  const uint32_t period_ms = 1000 / SERVO_UPDATE_HZ;
+
+  bool within = true;
+  uint32_t end_ms = 0;
+  float last[2] = {m[0].from, m[1].from};
+  float last_v[2] = {0.0f, 0.0f};
+  float pos[2];
+  uint64_t samples = 0;
+
+  Timer t;
+  for (int r = 0; r < reps; r++) {
+    profile.plan(m, 2, 0);
+    uint32_t now = 0;
+    while (profile.sample(now, pos)) {
+      if (r == 0) {
+        for (int i = 0; i < 2; i++) {
+          const float v = (pos[i] - last[i]) * 1000.0f / period_ms;
+          const float a = (v - last_v[i]) * 1000.0f / period_ms;
+          if (fabsf(v) > m[i].vmax * 1.01f || (now > period_ms && fabsf(a) > m[i].amax * 1.05f)) within = false;
+          last[i] = pos[i];
+          last_v[i] = v;
+        }
+      }
+      now += period_ms;
+      samples++;
+    }
+    end_ms = now;
+  }
+  printRow("MotionProfile::sample (2 axes)", samples, 0, t.seconds());
+
+  check(pos[0] == m[0].to && pos[1] == m[1].to, "profile ends exactly on both targets");
+  check(within, "profile respects each axis' vmax / amax");
+  const float expect_s = profile.durationS();
+  check(end_ms >= expect_s * 1000.0f && end_ms <= expect_s * 1000.0f + period_ms,
+        "both axes finish at the synchronized duration");
+  // Slowest axis alone: sweep 50 deg at 10 deg/s, 20 deg/s^2 -> 5.5 s
+  check(fabsf(expect_s - 5.5f) < 0.01f, "duration set by the slowest axis");
+}
+
+// Servos that settle a fixed time after each target, wheels that move at
+// the commanded speed
+class FakeSeqIo : public Sequencer::Io {
+public:
+  void seqServo(SeqOp, int16_t, uint32_t now_ms) override { settle_at_ms = now_ms + 1500; servo_moves++; }
+  bool seqServosSettled() override { return now_ms >= settle_at_ms; }
+  void seqDrive(float linear_ftps, float) override { ftps = linear_ftps; drives++; }
+  float seqTravelFt() override { return travel_ft; }
+
+  void advance(uint32_t dt_ms) {
+    now_ms += dt_ms;
+    travel_ft += ftps * (float)dt_ms * 0.001f;
+  }
+
+  uint32_t now_ms = 0;
+  uint32_t settle_at_ms = 0;
+  float ftps = 0.0f;
+  float travel_ft = 0.0f;
+  int servo_moves = 0;
+  int drives = 0;
+};
+
+// Built-in pickup to completion, an uploaded list parsed from JSON, and
+// the same list through the binary decoder
+void caseSequencer() {
+  FakeSeqIo io;
+  Sequencer seq(io);
+  const uint32_t period_ms = 1000 / SEQUENCER_UPDATE_HZ;
+
+  SequenceRequest run;
+  run.action = SeqAction::RUN;
+  run.id = SeqId::PICKUP;
+  check(seq.start(run, io.now_ms), "pickup starts");
+  check(seq.status().step == 3 && io.servo_moves == 2, "pickup runs its first steps on start");
+
+  uint8_t gens = 0;
+  uint8_t last_gen = seq.statusGen();
+  while (seq.running() && io.now_ms < 60000) {
+    io.advance(period_ms);
+    seq.tick(io.now_ms);
+    if (seq.statusGen() != last_gen) { gens++; last_gen = seq.statusGen(); }
+  }
+  printf("%-32s %u ms, %u status changes\n", "Sequencer pickup", (unsigned)io.now_ms, (unsigned)gens);
+  check(seq.status().state == SeqState::DONE && seq.status().step == seq.status().steps,
+        "pickup runs to the end");
+  check(seq.status().timeouts == 0, "pickup waits finish before their timeouts");
+  check(io.ftps == 0.0f && io.travel_ft >= PICKUP_CREEP_FT && io.travel_ft < PICKUP_CREEP_FT + 0.05f,
+        "pickup creeps its distance, then stops");
+
+  // Upload: the second wait never settles, so it times out and moves on
+  static const char UPLOAD[] =
+    "{\"type\":\"seq\",\"steps\":[\"lid\",80,0,\"wait_ms\",200,null,"
+    "\"drive\",0.25,0,\"wait_travel\",-1.5,500,\"drive\",0,0]}";
+  CommandParser parser(SERIAL_LINE_MAX_BYTES);
+  for (const char* c = UPLOAD; *c; c++) parser.feed(*c);
+  check(parser.feed('\n') == CommandParser::Result::SEQUENCE, "seq upload line parses");
+  const SequenceRequest& up = parser.sequence();
+  check(up.action == SeqAction::UPLOAD && up.step_count == 5 &&
+        up.steps[0].arg == 800 && up.steps[2].arg == 25 && up.steps[3].arg == -150 &&
+        up.steps[3].timeout_ms == 500, "seq upload args are scaled to step units");
+
+  static const char BAD[] = "{\"type\":\"seq\",\"steps\":[\"lid\",80,0,\"hop\",1,2]}";
+  CommandParser bad_parser(SERIAL_LINE_MAX_BYTES);
+  for (const char* c = BAD; *c; c++) bad_parser.feed(*c);
+  check(bad_parser.feed('\n') == CommandParser::Result::ERROR, "seq upload with an unknown op is rejected");
+
+  // Binary twin of the same upload
+  uint8_t pkt[1 + sizeof(protocol::bin::SequencePacket) + SEQ_MAX_STEPS * sizeof(protocol::bin::SeqStepPacket)];
+  size_t n = 0;
+  pkt[n++] = protocol::bin::PKT_SEQUENCE;
+  protocol::bin::SequencePacket h = {(uint8_t)SeqAction::UPLOAD, 0, up.step_count};
+  memcpy(pkt + n, &h, sizeof(h));
+  n += sizeof(h);
+  for (uint8_t i = 0; i < up.step_count; i++) {
+    protocol::bin::SeqStepPacket sp = {up.steps[i].op, up.steps[i].arg, up.steps[i].timeout_ms};
+    memcpy(pkt + n, &sp, sizeof(sp));
+    n += sizeof(sp);
+  }
+  SequenceRequest bin;
+  check(protocol::bin::decodeSequencePayload(pkt + 1, n - 1, bin) &&
+        bin.step_count == up.step_count && bin.steps[3].arg == up.steps[3].arg,
+        "binary seq upload decodes");
+
+  io.settle_at_ms = io.now_ms + 100000;   // the lid never gets there
+  check(seq.start(bin, io.now_ms), "upload starts");
+  while (seq.running() && io.now_ms < 120000) {
+    io.advance(period_ms);
+    seq.tick(io.now_ms);
+  }
+  check(seq.status().state == SeqState::DONE && io.ftps == 0.0f, "upload runs to the end");
+  check(seq.status().timeouts == 1, "wait_travel backwards past its timeout counts once");
+
+  seq.start(run, io.now_ms);
+  seq.abort(io.now_ms);
+  check(seq.status().state == SeqState::ABORTED && !seq.running(), "abort stops the sequence");
+}
+
+// Captures TX into a string so frame types can be counted
+class StringPrint : public Print {
+public:
+  size_t write(uint8_t c) override { text.push_back((char)c); return 1; }
+  size_t write(const uint8_t* buffer, size_t size) override {
+    text.append((const char*)buffer, size);
+    return size;
+  }
+  using Print::write;
+
+  size_t count(const char* needle) const {
+    size_t n = 0;
+    for (size_t at = text.find(needle); at != std::string::npos; at = text.find(needle, at + 1)) n++;
+    return n;
+  }
+
+  // Payloads of the binary frames of one packet type, in wire order
+  std::vector<std::string> payloads(uint8_t type) const {
+    std::vector<std::string> out;
+    for (size_t at = 0, end; (end = text.find('\0', at)) != std::string::npos; at = end + 1) {
+      std::vector<uint8_t> f(text.begin() + at, text.begin() + end);
+      const uint8_t* payload = nullptr;
+      size_t len = 0;
+      if (!f.empty() && protocol::bin::decodeFrame(f.data(), f.size(), payload, len) == type) {
+        out.emplace_back((const char*)payload, len);
+      }
+    }
+    return out;
+  }
+
+  std::string text;
+};
+
+void caseSubscribe() {
+  static const char SUB[] =
+    "{\"type\":\"subscribe\",\"wheel\":100,\"ultrasonic\":15,\"mech\":5,\"note\":1}\n";
+
+  ReplayStream rx((const uint8_t*)SUB, sizeof(SUB) - 1);
+  StringPrint tx;
+  rx.tee(&tx);
+
+  uint8_t stage[SERIAL_TX_FRAME_BYTES];
+  SerialLink link(rx, stage, sizeof(stage));
+  link.begin();
+  rx.refill(sizeof(SUB));
+  link.tick(0);
+  check(link.subscribed() && link.publishHz() == 100, "subscribe frame sets the publish rate");
+
+  // 10 s of publish() at the scheduler rate, with up to 1.5 ms of release
+  // jitter so millis() steps unevenly like it does on the board
+  const uint32_t seconds = 10;
+  uint32_t jitter = 12345;
+  for (uint32_t i = 0; i < seconds * link.publishHz(); i++) {
+    jitter = jitter * 1103515245u + 12345u;
+    const uint32_t now_ms = (i * 10000u + (jitter >> 16) % 1500u) / 1000u;
+
+    TelemetryFrame t = sampleTelemetry(i);
+    t.note = link.debugNote(now_ms);
+    link.publish(t, now_ms);
+    link.tick(now_ms);
+  }
+
+  const size_t wheel = tx.count("\"type\":\"wheel\"");
+  const size_t sonar = tx.count("\"type\":\"ultrasonic\"");
+  const size_t mech = tx.count("\"type\":\"mech\"");
+  const size_t notes = tx.count("\"type\":\"note\"");
+  const size_t full = tx.count("\"type\":\"telemetry\"");
+  printf("%-32s %zu wheel, %zu ultrasonic, %zu mech, %zu note, %zu full (%zu B)\n",
+         "subscribe 100/15/5 Hz, 10 s", wheel, sonar, mech, notes, full, tx.text.size());
+
+  check(wheel >= 990 && wheel <= 1001, "wheel group runs at 100 Hz");
+  check(sonar >= 149 && sonar <= 151, "ultrasonic group runs at 15 Hz");
+  check(mech >= 49 && mech <= 51, "mech group runs at 5 Hz");
+  check(notes == 1 && full == 0, "notes only on change, no full frames");
+  check(link.txDropped() == 0, "groups due together share one TX commit");
+}
+
+// Host tel_ack in commands: a host that stops acking sees the credit's
+// worth of telemetry then one probe per TELEMETRY_CREDIT_PROBE_MS; one
+// that keeps acking is never held
+void caseCredit() {
+  static char rx_buf[4096];
+  size_t rx_len = 0;
+  uint32_t cmd_seq = 0;
+  auto command = [&](uint16_t tel_ack) {
+    rx_len += (size_t)snprintf(rx_buf + rx_len, sizeof(rx_buf) - rx_len,
+        "{\"type\":\"cmd\",\"seq\":%u,\"host_time_ms\":0,\"drive\":{},\"mech\":{},\"tel_ack\":%u}\n",
+        (unsigned)++cmd_seq, (unsigned)tel_ack);
+  };
+
+  ReplayStream rx((const uint8_t*)rx_buf, sizeof(rx_buf));
+  StringPrint tx;
+  rx.tee(&tx);
+
+  uint8_t stage[SERIAL_TX_FRAME_BYTES];
+  SerialLink link(rx, stage, sizeof(stage));
+  link.begin();
+
+  // 1 s at 200 Hz, the host acks once at the start and then stalls
+  command(0);
+  rx.expose(rx_len);
+  link.tick(0);
+  check(link.telemetryCredit(), "tel_ack turns the credit on");
+  for (uint32_t i = 0; i < 200; i++) {
+    TelemetryFrame t = sampleTelemetry(i);
+    link.publish(t, i * 5);
+    link.tick(i * 5);
+  }
+  const size_t stalled = tx.count("\"type\":\"telemetry\"");
+  const size_t probes = 1000 / TELEMETRY_CREDIT_PROBE_MS;
+  check(stalled >= TELEMETRY_CREDIT_FRAMES + probes - 2 && stalled <= TELEMETRY_CREDIT_FRAMES + probes,
+        "stalled host: credit, then one probe per period");
+  check(link.telHeld() + stalled == 200, "held publications are counted");
+
+  // 1 s more, acked every 10 publications (20 Hz commands)
+  tx.text.clear();
+  for (uint32_t i = 200; i < 400; i++) {
+    if (i % 10 == 0) {
+      command(link.telSeq());
+      rx.expose(rx_len);
+    }
+    TelemetryFrame t = sampleTelemetry(i);
+    link.tick(i * 5);
+    link.publish(t, i * 5);
+  }
+  const size_t live = tx.count("\"type\":\"telemetry\"");
+  printf("%-32s %zu stalled (%u held), %zu acked of 200\n", "telemetry credit, 2 x 1 s",
+         stalled, (unsigned)link.telHeld(), live);
+  check(live == 200 && link.telUnread() <= 10, "acking host is never held");
+
+  LinkStatsFrame ls;
+  link.linkStats(ls, 2000);
+  check(ls.tel_unread_max >= TELEMETRY_CREDIT_FRAMES, "link stats report the unread high-water");
+
+  // Host from before a reboot: ack ahead of tel_seq is no backlog
+  command((uint16_t)(link.telSeq() + 500));
+  rx.expose(rx_len);
+  link.tick(2000);
+  check(link.telUnread() == 0, "ack ahead of tel_seq reads as nothing unread");
+}
+
+// UART ring full: a staged one-shot frame (a param reply) is never
+// displaced by telemetry, the telemetry is dropped instead; an unstarted
+// telemetry frame is still replaced by the next one
+void caseTxPriority() {
+  uint8_t none = 0;
+  ReplayStream rx(&none, 0);
+  StringPrint tx;
+  rx.tee(&tx);
+
+  uint8_t stage[SERIAL_TX_FRAME_BYTES];
+  SerialLink link(rx, stage, sizeof(stage));
+  link.begin();
+
+  rx.txRoom(0);
+  TelemetryFrame t0 = sampleTelemetry(0);
+  TelemetryFrame t1 = sampleTelemetry(1);
+  link.publish(t0, 0);
+  link.publish(t1, 5);
+  check(link.txDropped() == 1 && link.txPending(), "unstarted telemetry is replaced by the next");
+
+  ParamReply r;
+  r.count = 7;
+  check(link.sendParam(r), "a reply takes the stage from telemetry");
+  for (uint32_t i = 2; i < 12; i++) {
+    TelemetryFrame t = sampleTelemetry(i);
+    link.publish(t, i * 5);
+    link.tick(i * 5);
+  }
+  check(link.txDropped() == 12, "telemetry behind a staged reply is dropped");
+
+  HelloFrame h;
+  h.build = "test";
+  check(!link.sendHello(h) && link.txDropped() == 12, "a second one-shot waits, nothing counted lost");
+
+  rx.txRoom(0x7FFF);
+  link.tick(60);
+  check(tx.count("\"type\":\"param\"") == 1 && tx.count("\"type\":\"telemetry\"") == 0,
+        "the staged reply goes out whole");
+  check(link.sendHello(h) && tx.count("\"type\":\"hello\"") == 1, "the waiting one-shot follows");
+}
+
+// Sequence progress over a congested link, reported the way taskSequence
+// does: a status is marked sent only on a true sendSequence(), and every
+// one of those reaches the host, the final "done" last
+void caseSequenceReport() {
+  uint8_t none = 0;
+  ReplayStream rx(&none, 0);
+  StringPrint tx;
+  rx.tee(&tx);
+
+  uint8_t stage[SERIAL_TX_FRAME_BYTES];
+  SerialLink link(rx, stage, sizeof(stage));
+  link.begin();
+
+  FakeSeqIo io;
+  Sequencer seq(io);
+  SequenceRequest run;
+  run.action = SeqAction::RUN;
+  run.id = SeqId::PICKUP;
+  seq.start(run, io.now_ms);
+
+  uint8_t sent_gen = 0;
+  uint32_t reports = 0;
+  for (uint32_t i = 0; i < 6000 && (seq.running() || sent_gen != seq.statusGen()); i++) {
+    rx.txRoom((i % 5 == 0) ? 0x7FFF : 0);   // the ring drains one tick in five
+    io.advance(10);
+    seq.tick(io.now_ms);
+    const uint8_t gen = seq.statusGen();
+    if (gen != sent_gen && link.sendSequence(seq.status())) {
+      sent_gen = gen;
+      reports++;
+    }
+    TelemetryFrame t = sampleTelemetry(i);
+    link.publish(t, io.now_ms);
+    link.tick(io.now_ms);
+  }
+  rx.txRoom(0x7FFF);
+  link.tick(io.now_ms);
+
+  const size_t last = tx.text.rfind("\"type\":\"seq\"");
+  const bool done_last = last != std::string::npos &&
+                         tx.text.find("\"state\":\"done\"", last) < tx.text.find('\n', last);
+  check(!seq.running() && reports > 0 && tx.count("\"type\":\"seq\"") == reports && done_last,
+        "sequence status marked sent reaches the host, past telemetry drops");
+}
+
+int g_wd_drive_stops = 0;
+int g_wd_control_stops = 0;
+void wdStopDrive(uint32_t) { g_wd_drive_stops++; }
+void wdStopControl(uint32_t) { g_wd_control_stops++; }
+
+// Command channel trips once and re-arms on feed; a stale hardware channel
+// stops the WDT kicks; check() fast path cost
+void caseWatchdog(int reps) {
+  static const Watchdog::Channel TABLE[] PROGMEM = {
+    {WATCHDOG_DRIVE_TIMEOUT_MS, wdStopDrive, false},
+    {WATCHDOG_CONTROL_TIMEOUT_MS, wdStopControl, true},
+  };
+  enum : uint8_t { CH_DRIVE = 0, CH_CONTROL = 1 };
+
+  hal::reset();
+  Watchdog wd;
+  g_wd_drive_stops = g_wd_control_stops = 0;
+  wd.begin(TABLE, 2, _BV(WDRF) | _BV(EXTRF), 0);
+  check(wd.resetCause() == Watchdog::ResetCause::WATCHDOG, "WDRF reads as a watchdog reset");
+  check(!ENABLE_WATCHDOG || hal::wdtPeriod() == WDTO_500MS, "hardware WDT armed at WATCHDOG_HW_TIMEOUT_MS");
+
+  // 1 s of loop at 1 kHz: control fed every 10 ms, commands stop at 300 ms
+  for (uint32_t now = 0; now < 1000; now++) {
+    if (now % 10 == 0) wd.feed(CH_CONTROL, now);
+    if (now < 300 && now % 50 == 0) wd.feed(CH_DRIVE, now);
+    wd.check(now);
+  }
+  check(g_wd_drive_stops == 1, "stale command channel stops the drive exactly once");
+  check(wd.stale(CH_DRIVE) && !wd.stale(CH_CONTROL), "only the command channel is stale");
+  check(g_wd_control_stops == 0 && hal::wdtKicks() == 1000, "live control loop kicks the WDT every check");
+
+  wd.feed(CH_DRIVE, 1000);
+  check(!wd.stale(CH_DRIVE), "feed re-arms a tripped channel");
+
+  // Control loop stalls: its stop runs once, then the kicks stop
+  const uint32_t kicks = hal::wdtKicks();
+  for (uint32_t now = 1000; now < 1200; now++) {
+    wd.feed(CH_DRIVE, now);
+    wd.check(now);
+  }
+  check(g_wd_control_stops == 1, "stalled control loop runs its stop action once");
+  check(hal::wdtKicks() - kicks < 120, "stale hardware channel stops the WDT kicks");
+
+  // Fast path: nothing due
+  Watchdog fast;
+  fast.begin(TABLE, 2, 0, 0);
+  fast.feed(CH_DRIVE, 0);
+  const uint64_t n = (uint64_t)reps * 200000ULL;
+  Timer t;
+  for (uint64_t i = 0; i < n; i++) fast.check((uint32_t)(i & 63));
+  printRow("Watchdog::check (nothing due)", n, 0, t.seconds());
+}
+
+// Commands 1, 2, 5 at 50 ms (3 and 4 lost), then a perf report: the link
+// stats frame follows it once the TX stage drains
+void caseLinkStats() {
+  static const char* const SEQS[] = { "1", "2", "5" };
+  std::string stream;
+  for (const char* seq : SEQS) {
+    stream += "{\"type\":\"cmd\",\"seq\":";
+    stream += seq;
+    stream += ",\"host_time_ms\":0,\"drive\":{\"linear\":0,\"angular\":0},\"mech\":{}}\n";
+  }
+
+  hal::reset();
+  ReplayStream rx((const uint8_t*)stream.data(), stream.size());
+  StringPrint tx;
+  rx.tee(&tx);
+
+  uint8_t stage[SERIAL_TX_FRAME_BYTES];
+  SerialLink link(rx, stage, sizeof(stage));
+  link.begin();
+  const size_t line = stream.size() / 3;
+  for (int i = 0; i < 3; i++) {
+    rx.refill(line);
+    link.tick(i * 50);
+    hal::advanceMicros(50000);
+  }
+
+  LinkStatsFrame ls;
+  link.linkStats(ls, 150);
+  check(ls.ok == 3 && ls.seq_gaps == 2, "seq jump counts the lost commands");
+  check(ls.cmd_count == 2 && ls.gap_min_us == 50000 && ls.gap_max_us == 50000, "command gaps measured");
+  check(ls.jitter_hist[0] == 2, "steady 50 ms commands land in the lowest jitter bin");
+  check(ls.rx_high_water == line, "RX high-water is the largest backlog at a tick");
+  check(tx.count("RX OK") == 0, "no per-frame debug note");
+
+  PerfFrame perf;
+  link.sendPerf(perf);
+  link.tick(200);
+  check(tx.count("\"type\":\"perf\"") == 1 && tx.count("\"type\":\"linkstats\"") == 1,
+        "link stats follow the perf frame");
+  link.linkStats(ls, 200);
+  check(ls.cmd_count == 0 && ls.seq_gaps == 2, "window restarts, counters carry on");
+
+  // Every task slot used and every counter at 5 digits, plus the mem block:
+  // longer than the TX stage, streamed through it
+  perf.arduino_time_ms = 99999999;
+  perf.window_ms = 1000;
+  perf.loop = { 99999, 999, 99999, 999, 99000 };
+  perf.mem = { 4321, 1234, 2637, 2900 };
+  perf.servo = { 2, 1000, 900, 65535 };
+  perf.task_count = PERF_MAX_TASKS;
+  for (uint8_t i = 0; i < PERF_MAX_TASKS; i++) {
+    perf.tasks[i] = { F("sonar"), 99999, 99999, 9999, 99999, 9999, 99999 };
+  }
+  link.sendPerf(perf);
+  link.tick(300);
+  check(tx.count("\"type\":\"perf\"") == 2 && tx.count("\"stack_peak\":1234") == 1,
+        "worst-case perf line goes out");
+
+  StringPrint want;
+  protocol::encodePerfLine(perf, want);
+  check(want.text.size() > sizeof(stage) && tx.text.find(want.text) != std::string::npos,
+        "a perf line longer than the stage arrives whole");
+
+  // Congested link, telemetry and a reply competing for the stage while it
+  // streams: nothing gets spliced into the line, the reply goes out after it
+  tx.text.clear();
+  rx.txRoom(0);
+  link.sendPerf(perf);
+  bool replied = false;
+  for (uint32_t i = 0; i < 400 && (link.perfPending() || link.txPending() || !replied); i++) {
+    rx.txRoom((i % 5 == 0) ? 64 : 0);
+    const uint32_t now_ms = 400 + i * 5;
+    if (link.perfPending()) {
+      TelemetryFrame t = sampleTelemetry(i);
+      link.publish(t, now_ms);
+    }
+    ParamReply r;
+    r.count = 7;
+    if (!replied) replied = link.sendParam(r);
+    link.tick(now_ms);
+  }
+  const size_t at = tx.text.find(want.text);
+  check(!link.perfPending() && at != std::string::npos, "streamed perf line intact over a congested link");
+  check(replied && tx.text.find("\"type\":\"param\"") > at, "the reply waits for the end of the line");
+  check(tx.count("\"type\":\"linkstats\"") == 1, "link stats follow the streamed line");
+}
+
+// Pings at 2 Hz (the host default), host clock 200 ppm fast plus a large
+// offset, 1-3 ms each way with an occasional 15 ms queued trip: the
+// estimate must lock on offset and drift
+void caseTimeSync() {
+  const double rate = 1.0 + 200e-6;
+  const uint64_t host0 = 1700000000ULL * 1000000ULL;
+  auto host = [&](uint64_t a_us) { return (uint32_t)(host0 + (uint64_t)((double)a_us * rate)); };
+
+  TimeSync sync;
+  uint32_t jitter = 777;
+  auto leg = [&]() {
+    jitter = jitter * 1103515245u + 12345u;
+    const uint32_t r = (jitter >> 16) % 2000u;
+    return ((jitter >> 8) % 20u == 0) ? 15000u : 1000u + r;
+  };
+
+  double worst_us = 0.0;
+  uint64_t a = 5000000ULL;
+  for (int i = 0; i < 240; i++, a += 500000ULL) {
+    const uint32_t t1 = host(a - leg());
+    const uint32_t t2 = (uint32_t)a;
+    const uint32_t t3 = (uint32_t)(a + 400);
+    const uint32_t t4 = host(a + 400 + leg());
+    sync.addExchange(t1, t2, t3, t4);
+
+    if (i >= 120) {
+      const double err = fabs((double)(int32_t)(sync.toHostUs((uint32_t)a) - host(a)));
+      if (err > worst_us) worst_us = err;
+    }
+  }
+  printf("%-32s %u accepted, %u rejected, drift %.1f ppm, worst %.0f us\n",
+         "TimeSync 200 ppm, 2 Hz, 120 s", (unsigned)sync.accepted(), (unsigned)sync.rejected(),
+         (double)sync.driftPpm(), worst_us);
+
+  check(sync.synced(), "time sync converges");
+  check(sync.rejected() > 0, "queued exchanges are filtered out");
+  check(fabs(sync.driftPpm() - 200.0) < 30.0, "drift estimate tracks the host clock rate");
+  check(worst_us < 1000.0, "host time within 1 ms once locked");
+
+  // 10 ms clock step on the host: resync instead of slewing for minutes
+  const uint32_t t1 = host(a - 1500) + 100000u;
+  sync.addExchange(t1, (uint32_t)a, (uint32_t)(a + 400), host(a + 1900) + 100000u);
+  check(!sync.synced(), "host clock step restarts the estimate");
+
+  // Through SerialLink: each ping gets a pong, the next ping completes it
+  static const char PINGS[] =
+    "{\"type\":\"ping\",\"id\":1,\"t1_us\":1000}\n"
+    "{\"type\":\"ping\",\"id\":2,\"t1_us\":2000,\"prev_id\":1,\"prev_t4_us\":1500}\n";
+  hal::reset();
+  ReplayStream rx((const uint8_t*)PINGS, sizeof(PINGS) - 1);
+  StringPrint tx;
+  rx.tee(&tx);
+
+  uint8_t stage[SERIAL_TX_FRAME_BYTES];
+  SerialLink link(rx, stage, sizeof(stage));
+  link.begin();
+  rx.refill(sizeof(PINGS));
+  link.tick(0);
+  check(tx.count("\"type\":\"pong\"") == 2, "every ping is answered with a pong");
+  check(link.timeSync().accepted() == 1, "prev_t4 completes the previous exchange");
+}
+
+// Timed commands: ordered, bounded, played back on the Arduino clock; an
+// untimed command drops whatever is still queued
+void caseCommandQueue() {
+  CommandQueue q;
+  CommandFrame c;
+  c.at_present = true;
+
+  for (uint32_t i = 0; i < CommandQueue::DEPTH; i++) {
+    c.seq = i + 1;
+    c.at_ms = 1000 + i * 100;
+    q.push(c, 1000);
+  }
+  check(q.depth() == CommandQueue::DEPTH && q.free() == 0, "queue fills to DEPTH");
+  c.at_ms = 5000;
+  check(q.push(c, 1000) == CommandQueue::Push::FULL, "push past DEPTH is rejected");
+
+  CommandFrame out;
+  check(!q.popDue(999, out), "nothing due before the first at_ms");
+  check(q.popDue(1250, out) && out.seq == 3 && q.superseded() == 2, "late entries collapse to the newest due");
+  check(q.push(c, 1000) == CommandQueue::Push::TOO_FAR, "more than MAX_AHEAD out is rejected");
+  c.at_ms = 1100;
+  check(q.push(c, 1000) == CommandQueue::Push::OUT_OF_ORDER, "at_ms before the tail is rejected");
+
+  static const char STREAM[] =
+    "{\"type\":\"cmd\",\"seq\":1,\"host_time_ms\":0,\"at_ms\":100,\"drive\":{\"linear\":1,\"angular\":0},\"mech\":{}}\n"
+    "{\"type\":\"cmd\",\"seq\":2,\"host_time_ms\":0,\"at_ms\":200,\"drive\":{\"linear\":2,\"angular\":0},\"mech\":{}}\n"
+    "{\"type\":\"cmd\",\"seq\":2,\"host_time_ms\":0,\"at_ms\":200,\"drive\":{\"linear\":2,\"angular\":0},\"mech\":{}}\n"
+    "{\"type\":\"cmd\",\"seq\":3,\"host_time_ms\":0,\"drive\":{\"linear\":0,\"angular\":0},\"mech\":{}}\n";
+  const size_t first = 3 * ((sizeof(STREAM) - 1) / 4);
+
+  hal::reset();
+  ReplayStream rx((const uint8_t*)STREAM, sizeof(STREAM) - 1);
+  uint8_t stage[SERIAL_TX_FRAME_BYTES];
+  SerialLink link(rx, stage, sizeof(stage));
+  link.begin();
+  rx.refill(first);
+  link.tick(0);
+  check(link.commandQueue().depth() == 2, "timed commands are queued (a resent seq once)");
+  check(!link.takeCommand(50, out), "queued command waits for its at_ms");
+  check(link.takeCommand(150, out) && out.drive.linear_ftps == 1.0f, "first setpoint plays at its time");
+
+  rx.refill(sizeof(STREAM));
+  link.tick(160);
+  check(link.commandQueue().depth() == 0, "untimed command drops the queue");
+  check(link.takeCommand(160, out) && out.seq == 3 && !link.takeCommand(300, out),
+        "untimed command applies once");
+}
+
+// Telemetry-only port (the Pi's aux link, AUX_TX_FRAME_BYTES stage): sync
+// and subscribe go through, commands are refused
+void caseAuxLink() {
+  static const char STREAM[] =
+    "{\"type\":\"ping\",\"id\":1,\"t1_us\":1000}\n"
+    "{\"type\":\"cmd\",\"seq\":1,\"host_time_ms\":0,\"drive\":{\"linear\":1,\"angular\":0},\"mech\":{}}\n"
+    "{\"type\":\"subscribe\",\"wheel\":100}\n"
+    "{\"type\":\"pose\",\"x_ft\":1,\"y_ft\":0,\"heading_deg\":0}\n";
+
+  hal::reset();
+  ReplayStream rx((const uint8_t*)STREAM, sizeof(STREAM) - 1);
+  StringPrint tx;
+  rx.tee(&tx);
+
+  uint8_t stage[AUX_TX_FRAME_BYTES];
+  SerialLink link(rx, stage, sizeof(stage));
+  link.setCommandInput(false);
+  link.begin();
+  rx.refill(sizeof(STREAM));
+  link.tick(0);
+
+  CommandFrame out;
+  check(!link.hasCommand() && !link.takeCommand(0, out), "telemetry-only link refuses commands");
+  check(!link.pendingPose(), "telemetry-only link refuses pose resets");
+  check(link.rxOk() == 2 && link.rxFail() == 2, "refused frames count as RX failures");
+  check(link.subscribed() && link.publishHz() == 100, "telemetry-only link takes subscriptions");
+  check(tx.count("\"type\":\"pong\"") == 1, "telemetry-only link answers pings");
+}
+
+
+// Record a session through RxRecorder in uneven bursts, then replay the
+// capture: same bytes, same arrival ticks, and two runs give identical
+// timelines (host timing off)
+void caseRxReplay() {
+  static const char STREAM[] =
+    "{\"type\":\"param\",\"op\":\"set\",\"name\":\"LID_SERVO_RAMP_DPS\",\"value\":90}\n"
+    "{\"type\":\"cmd\",\"seq\":1,\"host_time_ms\":0,\"drive\":{\"linear\":0.5,\"angular\":0},\"mech\":{\"servo_LID_deg\":60}}\n"
+    "{\"type\":\"cmd\",\"seq\":2,\"host_time_ms\":0,\"at_ms\":400,\"drive\":{\"linear\":1,\"angular\":0},\"mech\":{\"servo_SWEEP_deg\":45}}\n"
+    "{\"type\":\"cmd\",\"bad\n"
+    "{\"type\":\"cmd\",\"seq\":3,\"host_time_ms\":0,\"at_ms\":600,\"drive\":{\"linear\":0,\"angular\":0},\"mech\":{\"servo_LID_deg\":0}}\n";
+  const size_t len = sizeof(STREAM) - 1;
+
+  hal::reset();
+  ReplayStream port((const uint8_t*)STREAM, len);
+  StringPrint sink;
+  RxRecorder rec(port, sink);
+  uint8_t stage[SERIAL_TX_FRAME_BYTES];
+  SerialLink link(rec, stage, sizeof(stage));
+  link.begin();
+
+  uint32_t live_cmds = 0;
+  for (size_t burst = 37; !port.done(); burst = burst * 7 % 101 + 13) {
+    hal::advanceMicros(1000000 / RxCOMM_UPDATE_HZ);
+    port.refill(burst);
+    link.tick(millis());
+    CommandFrame out;
+    while (link.takeCommand(millis(), out)) live_cmds++;
+  }
+  for (int i = 0; i < 400; i++) {
+    hal::advanceMicros(1000000 / RxCOMM_UPDATE_HZ);
+    CommandFrame out;
+    while (link.takeCommand(millis(), out)) live_cmds++;
+  }
+
+  RxCapture cap;
+  parseRxCapture((const uint8_t*)sink.text.data(), sink.text.size(), cap);
+  check(cap.bytes.size() == len && memcmp(cap.bytes.data(), STREAM, len) == 0, "capture holds every byte taken, in order");
+  check(cap.records.size() == rec.records() && cap.seq_gaps == 0 && cap.bad_frames == 0, "one record per run, none lost");
+
+  std::string runs[2];
+  RxReplay replay;
+  for (std::string& text : runs) {
+    FILE* f = tmpfile();
+    replay.setTimeline(f, false);
+    replay.run(cap);
+    const long n = ftell(f);
+    text.resize((size_t)n);
+    rewind(f);
+    check(fread(&text[0], 1, (size_t)n, f) == (size_t)n, "timeline read back");
+    fclose(f);
+  }
+  const RxReplay::Summary& s = replay.summary();
+  check(!runs[0].empty() && runs[0] == runs[1], "replay is deterministic");
+  check(s.commands == live_cmds && s.commands == 3 && s.timed == 2, "replay applies what the live link applied");
+  check(s.ok == link.rxOk() && s.fail == link.rxFail() && s.fail == 1, "replay sees the same frames and failures");
+  check(runs[0].find(",param,") != std::string::npos && s.servo_moves == 3 &&
+        runs[0].find(",settled,") != std::string::npos, "param, servo moves and settling on the timeline");
+}
+
+
+// Obstacle closing at 10 in/s, echoes at 15 Hz with +-0.4 in noise, a
+// ghost every 7th ping and a timeout every 11th: the filter tracks through
+// both, then re-locks after the scene jumps and drops out when echoes stop
+void caseRangeFilter() {
+  RangeFilter f;
+  uint32_t r = 12345;
+  auto noise = [&]() {
+    r = r * 1103515245u + 12345u;
+    return ((float)((r >> 16) % 801u) - 400.0f) * 0.001f;
+  };
+
+  const uint32_t period_ms = 1000 / ULTRASONIC_UPDATE_HZ;
+  float worst_in = 0.0f;
+  uint32_t t = 0;
+  for (int i = 0; i < 45; i++, t += period_ms) {
+    const float truth = 40.0f - 10.0f * (float)t * 0.001f;
+    if (i % 11 == 10)     f.update(t, false, 0.0f);
+    else if (i % 7 == 6)  f.update(t, true, truth + 25.0f);
+    else                  f.update(t, true, truth + noise());
+
+    const float err = fabsf(f.output().distance_in - truth);
+    if (i >= 15 && err > worst_in) worst_in = err;
+  }
+  const RangeFilter::Output o = f.output();
+  check(o.valid && worst_in < 1.0f, "filtered distance tracks a closing target");
+  check(fabsf(o.closing_inps - 10.0f) < 2.5f, "closing rate estimated");
+  check(f.rejected() >= 5 && f.restarts() == 0, "ghost echoes gated out");
+  check(o.confidence > 0.5f && o.confidence < 1.0f, "confidence reflects the rejects");
+
+  for (int i = 0; i < ULTRASONIC_OUTLIER_RESET; i++, t += period_ms) f.update(t, true, 60.0f);
+  check(f.restarts() == 1 && fabsf(f.output().distance_in - 60.0f) < 0.5f, "scene change re-locks");
+
+  for (uint32_t end = t + ULTRASONIC_TRACK_TIMEOUT_MS + period_ms; t <= end; t += period_ms) f.update(t, false, 0.0f);
+  check(!f.output().valid, "no echoes for the track timeout: invalid");
+
+  printf("%-32s worst %.2f in, closing %.1f in/s, %u rejected\n",
+         "RangeFilter 10 in/s, 15 Hz", worst_in, o.closing_inps, (unsigned)f.rejected());
+}
+
+// Obstacle guard: drive at a wall flat out, then get run at while parked
+void caseObstacleGuard() {
+  RangeFilter f;
+  ObstacleGuard g;
+  const RangeFilter::Output* ranges[] = { &f.output() };
+
+  const uint32_t tick_ms = 1000 / DRIVE_UPDATE_HZ;
+  const uint32_t ping_ms = 1000 / ULTRASONIC_UPDATE_HZ;
+  const float wall_in = 48.0f;
+  float x_in = 0.0f, v_ftps = 0.0f, min_gap_in = wall_in;
+  uint32_t t = 0, next_ping = 0;
+
+  // Plant: speed slews toward the capped command at the stop decel
+  auto step = [&](float cmd_ftps, float obstacle_in) {
+    if (t >= next_ping) {
+      f.update(t, true, obstacle_in - x_in);
+      next_ping += ping_ms;
+    }
+    g.update(ranges, 1);
+    float target = cmd_ftps;
+    if (target > g.forwardLimitFtps()) target = g.forwardLimitFtps();
+    const float dv = OBSTACLE_STOP_DECEL_FTPS2 * (float)tick_ms * 0.001f;
+    v_ftps += fmaxf(-dv, fminf(dv, target - v_ftps));
+    x_in += v_ftps * 12.0f * (float)tick_ms * 0.001f;
+    if (obstacle_in - x_in < min_gap_in) min_gap_in = obstacle_in - x_in;
+    t += tick_ms;
+  };
+
+  for (int i = 0; i < 600; i++) step(MAX_LINEAR_SPEED_FTPS, wall_in);
+  check(v_ftps == 0.0f && g.stopActive(), "full-speed approach ends stopped");
+  check(min_gap_in > OBSTACLE_MARGIN_IN - 2.0f && wall_in - x_in < OBSTACLE_MARGIN_IN + 2.0f,
+        "stops at the margin");
+  check(g.getState().stops == 1, "one stop, no chatter");
+  const float parked_gap = wall_in - x_in;
+
+  // Back off: reverse is never capped, the stop lets go past the band
+  for (int i = 0; i < 100; i++) step(-1.0f, wall_in);
+  check(!g.stopActive(), "backing off releases the stop");
+
+  // Parked, something comes at the robot faster than the curve allows
+  float obstacle_in = wall_in;
+  bool tripped = false;
+  float trip_gap_in = 0.0f;
+  for (int i = 0; i < 60 && !tripped; i++) {
+    obstacle_in -= 40.0f * (float)tick_ms * 0.001f;
+    step(0.0f, obstacle_in);
+    tripped = g.stopActive();
+    trip_gap_in = obstacle_in - x_in;
+  }
+  check(tripped && trip_gap_in > OBSTACLE_MARGIN_IN + OBSTACLE_RELEASE_IN, "fast closing trips the stop early");
+
+  printf("%-32s parked %.1f in, min %.1f in, closing trip at %.1f in\n",
+         "ObstacleGuard 3 ft/s at a wall", parked_gap, min_gap_in, trip_gap_in);
+}
+
+// Odometry: a full circle at the sample rate, then a reset and the frames
+void caseOdometry() {
+  Odometry odom;
+  const float radius_ft = 2.0f;
+  const float v_ftps = 1.5f;
+  const float dt_s = 1.0f / (float)ENCODER_SAMPLE_HZ;
+  const float w_rps = v_ftps / radius_ft;            // CCW
+  const float vl = w_rps * (radius_ft - 0.5f * TRACK_WIDTH_FT);
+  const float vr = w_rps * (radius_ft + 0.5f * TRACK_WIDTH_FT);
+
+  const int steps = (int)(2.0f * PI / w_rps / dt_s + 0.5f);
+  float worst_ft = 0.0f;
+  for (int i = 0; i <= steps; i++) {
+    const float t = (float)i * dt_s;
+    odom.integrate((int32_t)lroundf(vl * t / FEET_PER_COUNT), (int32_t)lroundf(vr * t / FEET_PER_COUNT));
+    if (i % 50 == 0) {
+      const PoseState p = odom.pose();
+      const float x = radius_ft * sinf(w_rps * t);
+      const float y = radius_ft * (1.0f - cosf(w_rps * t));
+      const float err = hypotf(p.x_ft - x, p.y_ft - y);
+      if (err > worst_ft) worst_ft = err;
+    }
+  }
+  const PoseState lap = odom.pose();
+  check(worst_ft < 0.01f, "circle tracked to 1/8 in");
+  check(fabsf(lap.heading_deg) < 0.5f, "full lap comes back to heading 0");
+  check(lap.sigma_xy_ft > 0.0f && lap.sigma_heading_deg > 0.0f, "sigmas grow with travel");
+
+  CommandParser parser(SERIAL_LINE_MAX_BYTES);
+  static const char POSE[] = "{\"type\":\"pose\",\"x_ft\":1.5,\"heading_deg\":-90}";
+  for (const char* c = POSE; *c; c++) parser.feed(*c);
+  check(parser.feed('\n') == CommandParser::Result::POSE, "pose line parses");
+  odom.reset(parser.pose());
+
+  // Straight ahead 1 ft on the new heading (south)
+  const int32_t l0 = (int32_t)lroundf(vl * (float)steps * dt_s / FEET_PER_COUNT);
+  const int32_t r0 = (int32_t)lroundf(vr * (float)steps * dt_s / FEET_PER_COUNT);
+  const int32_t ft = (int32_t)lroundf(1.0f / FEET_PER_COUNT);
+  for (int32_t k = 1; k <= 10; k++) odom.integrate(l0 + ft * k / 10, r0 + ft * k / 10);
+  const PoseState moved = odom.pose();
+  check(fabsf(moved.x_ft - 1.5f) < 0.005f && fabsf(moved.y_ft + 1.0f) < 0.005f &&
+        fabsf(moved.heading_deg + 90.0f) < 0.01f, "reset pose, then dead reckoning from it");
+  check(moved.sigma_xy_ft < lap.sigma_xy_ft, "reset clears the sigmas");
+
+  TelemetryFrame t = sampleTelemetry(0);
+  t.pose = moved;
+  StringPrint json;
+  protocol::encodeTelemetryLine(t, json);
+  check(json.count("\"pose\":{\"x_ft\":1.5,\"y_ft\":-1") == 1, "pose in the JSON frame");
+
+  printf("%-32s worst %.4f ft, lap heading %.3f deg, sigma %.3f ft\n",
+         "Odometry 2 ft circle, 200 Hz", worst_ft, lap.heading_deg, lap.sigma_xy_ft);
+}
+
+// Sensor array block: JSON columns, binary 2 + 5 bytes per sensor
+void caseSonarArray() {
+  SonarArray sonar;
+  sonar.count = 3;
+  sonar.valid_mask = 0x05;
+  sonar.distance_in[0] = 12.5f;  sonar.closing_inps[0] = 3.2f;  sonar.confidence[0] = 191;
+  sonar.distance_in[2] = 40.1f;  sonar.closing_inps[2] = -1.0f; sonar.confidence[2] = 255;
+  TelemetryFrame with = sampleTelemetry(0);
+  with.sonar = &sonar;
+
+  StringPrint json;
+  protocol::encodeTelemetryLine(with, json);
+  check(json.count("\"sonar\":{\"valid\":5,\"d\":[12.5,null,40.1],\"c\":[3.2,null,-1],\"q\":[0.75,0,1]}") == 1, "sonar block in the JSON frame");
+
+  CountingPrint plain('\0'), sized('\0');
+  protocol::bin::encodeTelemetryFrame(sampleTelemetry(0), plain);
+  protocol::bin::encodeTelemetryFrame(with, sized);
+  check(sized.bytes() - plain.bytes() >= 2 + 5 * 3, "sonar block in the binary frame");
+}
+
+// Parameter frames on both wires, staged -> live on applyPending, saved
+// to EEPROM without blocking, booted back; a torn image boots the defaults
+void caseParamStore() {
+  hal::reset();
+  ParamStore store;
+  store.begin();
+  check(store.source() == ParamStore::Source::DEFAULTS && store.active().drive_kp == DRIVE_KP,
+        "blank EEPROM boots the Params.h defaults");
+
+  auto parse = [](const char* line, ParamRequest& out) {
+    CommandParser parser(SERIAL_LINE_MAX_BYTES);
+    CommandParser::Result r = CommandParser::Result::NONE;
+    for (const char* c = line; *c; c++) r = parser.feed(*c);
+    if (r == CommandParser::Result::PARAM) out = parser.param();
+    return r == CommandParser::Result::PARAM;
+  };
+
+  ParamRequest req;
+  ParamReply reply;
+  check(parse("{\"type\":\"param\",\"op\":\"set\",\"name\":\"ULTRASONIC_MAX_VALID_IN\",\"value\":48}\n", req) &&
+        req.op == ParamOp::SET && strcmp(req.name, "ULTRASONIC_MAX_VALID_IN") == 0 && req.value == 48.0f,
+        "param set line parses (longest name)");
+  store.handle(req, reply);
+  check(reply.status == ParamStatus::OK && reply.value == 48.0f &&
+        store.active().ultrasonic_max_valid_in == ULTRASONIC_MAX_VALID_IN, "set is staged, not live");
+  check(store.applyPending() && store.active().ultrasonic_max_valid_in == 48.0f && !store.applyPending(),
+        "applyPending makes it live once");
+
+  check(parse("{\"type\":\"param\",\"op\":\"set\",\"name\":\"MAX_LINEAR_SPEED_FTPS\",\"value\":9}\n", req), "over-limit set parses");
+  store.handle(req, reply);
+  check(reply.status == ParamStatus::RANGE && reply.value == MAX_LINEAR_SPEED_FTPS && !store.applyPending(),
+        "out-of-range set is refused with the current value");
+
+  check(parse("{\"type\":\"param\",\"op\":\"get\",\"index\":99}\n", req), "get by index parses");
+  store.handle(req, reply);
+  check(reply.status == ParamStatus::UNKNOWN && reply.count == ParamStore::count(), "unknown index");
+  check(!parse("{\"type\":\"param\",\"op\":\"frob\"}\n", req), "unknown op is rejected");
+
+  // Test mode frames share the op / value keys, in either key order
+  {
+    CommandParser parser(SERIAL_LINE_MAX_BYTES);
+    CommandParser::Result r = CommandParser::Result::NONE;
+    for (const char* c = "{\"op\":\"drive_step\",\"value\":0.4,\"type\":\"test\"}\n"; *c; c++) r = parser.feed(*c);
+    check(r == CommandParser::Result::TEST && parser.test().op == TestOp::DRIVE_STEP && parser.test().value == 0.4f,
+          "test line parses (op before type)");
+    for (const char* c = "{\"type\":\"test\",\"op\":\"get\"}\n"; *c; c++) r = parser.feed(*c);
+    check(r != CommandParser::Result::TEST && r != CommandParser::Result::PARAM, "test with a param op is rejected");
+  }
+  protocol::bin::TestPacket tp = { (uint8_t)TestOp::ABORT, NAN };
+  TestRequest test;
+  check(protocol::bin::decodeTestPayload((const uint8_t*)&tp, sizeof(tp), test) && test.op == TestOp::ABORT,
+        "binary test payload decodes");
+  tp.op = (uint8_t)TestOp::NONE;
+  check(!protocol::bin::decodeTestPayload((const uint8_t*)&tp, sizeof(tp), test), "binary test op NONE is rejected");
+
+  // Binary set by name, JSON reply
+  protocol::bin::ParamPacket pk;
+  memset(&pk, 0, sizeof(pk));
+  pk.op = (uint8_t)ParamOp::SET;
+  pk.index = PARAM_BY_NAME;
+  pk.value = 1.5f;
+  strcpy(pk.name, "DRIVE_KP");
+  check(protocol::bin::decodeParamPayload((const uint8_t*)&pk, sizeof(pk), req) &&
+        strcmp(req.name, "DRIVE_KP") == 0, "binary param payload decodes");
+  store.handle(req, reply);
+  store.applyPending();
+  StringPrint json;
+  protocol::encodeParamLine(reply, json);
+  check(json.count("\"status\":\"ok\",\"count\":") == 1 && json.count("\"name\":\"DRIVE_KP\",\"value\":1.5") == 1,
+        "param reply JSON");
+
+  // Save: one byte per service() call, then the image boots
+  req = ParamRequest();
+  req.op = ParamOp::SAVE;
+  store.handle(req, reply);
+  check(reply.status == ParamStatus::OK && store.saving(), "save starts");
+  store.handle(req, reply);
+  check(reply.status == ParamStatus::BUSY, "second save while writing is busy");
+  uint32_t calls = 0, done = 0;
+  while (store.saving() && calls < 1000) {
+    const uint32_t before = hal::eepromWrites();
+    if (store.service()) done++;
+    check(hal::eepromWrites() - before <= 1, "at most one EEPROM byte per service()");
+    calls++;
+  }
+  check(done == 1 && !store.service(), "save completion reported once");
+
+  ParamStore booted;
+  booted.begin();
+  check(booted.source() == ParamStore::Source::EEPROM && booted.active().drive_kp == 1.5f &&
+        booted.active().ultrasonic_max_valid_in == 48.0f, "saved image boots");
+
+  // Resave of the same values writes nothing; a flipped byte fails the CRC
+  store.handle(req, reply);
+  const uint32_t before = hal::eepromWrites();
+  while (store.saving()) store.service();
+  check(hal::eepromWrites() == before, "unchanged bytes are not rewritten");
+
+  hal::eepromData()[PARAM_EEPROM_ADDR + 12] ^= 0x01;
+  ParamStore torn;
+  torn.begin();
+  check(torn.source() == ParamStore::Source::DEFAULTS && torn.active().drive_kp == DRIVE_KP,
+        "corrupt image boots the defaults");
+  req.op = ParamOp::LOAD;
+  torn.handle(req, reply);
+  check(reply.status == ParamStatus::NO_IMAGE, "load without a valid image");
+}
+
+// Idle hook: called with the earliest timed release once nothing is due,
+// never for the period-0 task alone; the time "asleep" lands in the profiler
+uint32_t g_idle_calls = 0;
+uint32_t g_idle_wake_us = 0;
+
+void idleToRelease(uint32_t wake_us) {
+  g_idle_calls++;
+  g_idle_wake_us = wake_us;
+  hal::setMicros(wake_us);
+}
+
+void caseSchedulerIdle() {
+  hal::reset();
+  static uint32_t fast_runs, slow_runs, bg_runs;
+  fast_runs = slow_runs = bg_runs = 0;
+
+  Scheduler sched;
+  Profiler prof;
+  sched.add([](uint32_t) { fast_runs++; }, Scheduler::hzToUs(400), 0, 2);
+  sched.add([](uint32_t) { slow_runs++; }, Scheduler::hzToUs(100), 600, 1);
+  sched.add([](uint32_t) { bg_runs++; }, 0, 0, 0);
+  sched.setProfiler(&prof);
+  sched.start(micros());
+  prof.reset();
+
+  sched.tick();
+  check(fast_runs == 1 && slow_runs == 0 && bg_runs == 1, "first tick runs the due tasks");
+  check(g_idle_calls == 0, "no idle hook until one is set");
+
+  sched.setIdle(idleToRelease);
+  g_idle_calls = 0;
+  sched.tick();
+  check(g_idle_calls == 1 && g_idle_wake_us == 600, "idle until the earliest timed release");
+
+  uint32_t ticks = 0;
+  while (micros() < 1000000) {
+    sched.tick();
+    ticks++;
+  }
+  check(g_idle_calls == ticks + 1 && ticks == 499, "one sleep per release, straight to the next one");
+  check(fast_runs == 400 && slow_runs == 100, "releases kept while idling");
+  check(bg_runs == ticks + 2, "period-0 task runs once per wake-up");
+  check(prof.loop().idle_us == 1000000, "idle time recorded in the window");
+
+  sched.setIdle(nullptr);
+  g_idle_calls = 0;
+  sched.tick();
+  check(g_idle_calls == 0, "idle hook cleared: tick returns at once");
+}
+
+// Rate: exact average rates from fractional periods, on either clock, and
+// what each policy does with a stall of four periods
+void caseRate() {
+  Rate r60(60);
+  uint32_t runs = 0;
+  for (uint32_t t = 0; t < 10000000; t += 100) runs += r60.readyUs(t) ? 1 : 0;
+  check(runs == 600 && r60.stats().overruns == 0, "60 Hz on micros(): 600 releases in 10 s");
+
+  Rate ms60(60);
+  runs = 0;
+  for (uint32_t t = 0; t < 10000; t++) runs += ms60.ready(t) ? 1 : 0;
+  check(runs == 600 && ms60.stats().max_late_us < 1000, "60 Hz on millis(): still 600, not 625");
+
+  Rate wrap(400);
+  runs = 0;
+  for (uint32_t t = 0xFFFFFFFFUL - 49999; t != 50000; t += 100) runs += wrap.readyUs(t) ? 1 : 0;
+  check(runs == 40, "micros() rollover keeps the schedule");
+
+  // Release at 0, then nothing until 12600 us: four 2500 us releases missed
+  auto stall = [](Rate::Policy policy, uint32_t& at_stall) {
+    Rate r(400, policy);
+    r.readyUs(0);
+    at_stall = 0;
+    while (r.readyUs(12600) && at_stall < 10) at_stall++;
+    return r;
+  };
+  uint32_t n = 0;
+  Rate skip = stall(Rate::Policy::SKIP, n);
+  check(n == 1 && skip.stats().overruns == 1 && skip.stats().skipped == 4, "SKIP: one run, four dropped");
+  check(!skip.readyUs(14999) && skip.readyUs(15000), "SKIP keeps the phase");
+
+  Rate catch_up = stall(Rate::Policy::CATCH_UP, n);
+  check(n == 5 && catch_up.stats().overruns == 1 && catch_up.stats().skipped == 0, "CATCH_UP: runs the four back to back");
+  check(catch_up.readyUs(15000), "CATCH_UP keeps the phase");
+
+  Rate rephase = stall(Rate::Policy::REPHASE, n);
+  check(n == 1 && rephase.stats().skipped == 4, "REPHASE: one run, four dropped");
+  check(!rephase.readyUs(15000) && rephase.readyUs(15100), "REPHASE restarts the phase from the late run");
+
+  Rate deep(400, Rate::Policy::CATCH_UP);
+  deep.readyUs(0);
+  n = 0;
+  while (deep.readyUs(27600) && n < 20) n++;   // ten missed
+  check(n == 1 + Rate::MAX_CATCH_UP && deep.stats().skipped == 10 - Rate::MAX_CATCH_UP,
+        "CATCH_UP backlog capped at MAX_CATCH_UP");
+}
+
+}  // namespace
+
+
+/*=============================================================================
+  MAIN
+=============================================================================*/
+
+// --replay <capture.rxcap> [timeline.csv]: field capture, not the benchmark
+// Step + chirp against a simulated first-order motor pair with Coulomb
+// friction: the fit finds the plant, the capture ring streams the run out
+// as PKT_SYSID frames while it goes
+void caseSysId() {
+  struct Motor { float gain, tau_s, ks, v, pos; };
+
+  // each(k) after every drive tick k (the maintenance task's slot)
+  auto run = [](SysId& id, SysId::Target target, Motor* m, uint32_t& t_ms, auto&& each) {
+    const float upc = SysId::unitsPerCount(target);
+    id.start(target, NAN, t_ms);
+    float duty = 0.0f;
+    for (uint32_t k = 0; k < 1000 && (k == 0 || id.running()); k++) {
+      duty = id.tick(t_ms, (int32_t)floorf(m[0].pos / upc), (int32_t)floorf(m[1].pos / upc));
+      each(k);
+      for (uint32_t sub = 0; sub < 10; sub++) {     // 1 ms plant steps
+        for (uint8_t i = 0; i < 2; i++) {
+          Motor& p = m[i];
+          const float drive = (p.v == 0.0f && fabsf(duty) <= p.ks) ? 0.0f
+                             : duty - copysignf(p.ks, (p.v != 0.0f) ? p.v : duty);
+          const float v = p.v + (p.gain * drive - p.v) * 0.001f / p.tau_s;
+          p.v = (p.v != 0.0f && v * p.v < 0.0f && fabsf(duty) <= p.ks) ? 0.0f : v;   // friction holds it
+          p.pos += p.v * 0.001f;
+        }
+      }
+      t_ms += 1000UL / DRIVE_UPDATE_HZ;
+    }
+  };
+  auto near = [](float v, float want, float tol) { return isfinite(v) && fabsf(v - want) <= tol * want; };
+
+  static SysIdSample buf[SYSID_RING_SAMPLES];
+  SysId id(buf, SYSID_RING_SAMPLES);
+  uint32_t t_ms = 1000;
+  auto idle = [](uint32_t) {};
+
+  Motor wheels[2] = { { 4.0f, 0.12f, 0.08f, 0.0f, 0.0f }, { 3.6f, 0.15f, 0.10f, 0.0f, 0.0f } };
+  run(id, SysId::Target::DRIVE, wheels, t_ms, idle);
+  const SysId::Result& r = id.result();
+  check(r.phase == SysId::Phase::DONE && r.gen == 1 && r.duty == SYSID_DRIVE_DUTY, "drive run completes");
+  check(near(r.fit[0].gain, 4.0f, 0.15f) && near(r.fit[1].gain, 3.6f, 0.15f), "drive gain per wheel");
+  check(near(r.fit[0].tau_s, 0.12f, 0.25f) && near(r.fit[1].tau_s, 0.15f, 0.25f), "drive time constant per wheel");
+  check(near(r.fit[0].ks, 0.08f, 0.3f) && near(r.fit[1].ks, 0.10f, 0.3f), "drive friction duty per wheel");
+  check(id.captured() == SYSID_CAPTURE_SAMPLES, "capture counts the whole drive run");
+
+  // Nobody streamed it: only the newest ring's worth is left, and a chunk
+  // from the start moves up to the oldest of those
+  SysIdChunk c;
+  check(id.chunk(0, c) && c.first == SYSID_CAPTURE_SAMPLES - SYSID_RING_SAMPLES && c.total == SYSID_CAPTURE_SAMPLES,
+        "stale cursor skips to the oldest sample held");
+
+  // Arms swing both ways: friction comes out of the sign term. Streamed the
+  // way the maintenance task does it: whole chunks while running, the rest
+  // after; each chunk is a valid frame, in order, all of one run
+  Motor arms[2] = { { 300.0f, 0.08f, 0.05f, 0.0f, 0.0f }, { 300.0f, 0.08f, 0.05f, 0.0f, 0.0f } };
+  uint16_t first = 0, frames = 0;
+  bool ok = true;
+  const uint8_t run_gen = (uint8_t)(c.gen + 1);
+  auto drain = [&](uint32_t) {
+    while (id.captured() - first >= (id.running() ? SYSID_CHUNK_SAMPLES : 1) && id.chunk(first, c)) {
+      StringPrint out;
+      protocol::bin::encodeSysIdFrame(c, out);
+      std::vector<uint8_t> f(out.text.begin(), out.text.end() - 1);   // drop the delimiter
+      const uint8_t* payload = nullptr;
+      size_t len = 0;
+      ok = ok && c.first == first && c.gen == run_gen &&
+           protocol::bin::decodeFrame(f.data(), f.size(), payload, len) == protocol::bin::PKT_SYSID &&
+           len == sizeof(protocol::bin::SysIdHeaderPacket) + c.count * sizeof(SysIdSample);
+      first += c.count;
+      frames++;
+    }
+  };
+  run(id, SysId::Target::ARM, arms, t_ms, drain);
+  check(r.phase == SysId::Phase::DONE && near(r.fit[0].gain, 300.0f, 0.15f) && near(r.fit[0].ks, 0.05f, 0.3f),
+        "arm gain and friction from the two-way chirp");
+  drain(0);
+  check(ok && first == id.captured() && id.captured() > SYSID_RING_SAMPLES &&
+        frames == (id.captured() + SYSID_CHUNK_SAMPLES - 1) / SYSID_CHUNK_SAMPLES,
+        "capture streams as PKT_SYSID chunks during the run");
+
+  // A drive run over a link whose UART ring drains one tick in five, sent
+  // like the maintenance task sends it: the cursor moves on a true
+  // sendSysId(), and telemetry published behind a chunk can't displace it
+  {
+    uint8_t none = 0;
+    ReplayStream rx(&none, 0);
+    StringPrint tx;
+    rx.tee(&tx);
+    uint8_t stage[SERIAL_TX_FRAME_BYTES];
+    SerialLink link(rx, stage, sizeof(stage));
+    link.begin();
+    link.setWireMode(WireMode::BINARY);
+
+    uint16_t sent = 0;
+    uint32_t i = 0;
+    auto step = [&](uint32_t) {
+      for (uint8_t half = 0; half < 2; half++, i++) {   // 5 ms link ticks, 10 ms drive ticks
+        rx.txRoom((i % 5 == 0) ? 0x7FFF : 0);
+        link.tick(i * 5);
+        rx.txRoom(0);
+        const uint16_t waiting = id.captured() - sent;
+        if (waiting >= (id.running() ? SYSID_CHUNK_SAMPLES : 1) && !link.txPending() &&
+            id.chunk(sent, c) && link.sendSysId(c)) {
+          sent = c.first + c.count;
+        }
+        TelemetryFrame t = sampleTelemetry(i);
+        link.publish(t, i * 5);
+      }
+    };
+    Motor slow[2] = { { 4.0f, 0.12f, 0.08f, 0.0f, 0.0f }, { 3.6f, 0.15f, 0.10f, 0.0f, 0.0f } };
+    run(id, SysId::Target::DRIVE, slow, t_ms, step);
+    while (i < 4000 && (sent < id.captured() || link.txPending())) step(0);
+
+    uint16_t next = 0;
+    bool contiguous = true;
+    for (const std::string& p : tx.payloads(protocol::bin::PKT_SYSID)) {
+      protocol::bin::SysIdHeaderPacket sh;
+      memcpy(&sh, p.data(), sizeof(sh));
+      contiguous = contiguous && sh.first == next;
+      next = (uint16_t)(next + (p.size() - sizeof(sh)) / sizeof(SysIdSample));
+    }
+    check(sent == id.captured() && contiguous && next == id.captured() && link.txDropped() > 0,
+          "congested link: every chunk sent arrives, in order, telemetry dropped instead");
+  }
+
+  check(id.start(SysId::Target::DRIVE, 5.0f, t_ms) && id.result().duty * (SYSID_DRIVE_CHIRP_MEAN + SYSID_DRIVE_CHIRP_AMP) <= DRIVE_STEP_MAX_DUTY + 1e-6f &&
+        !id.start(SysId::Target::ARM, NAN, t_ms), "duty capped at the chirp peak, one run at a time");
+  id.abort();
+  check(id.result().phase == SysId::Phase::ABORTED && !id.running() && id.tick(t_ms + 10, 0, 0) == 0.0f, "abort ends the run");
+}
+
+void caseHello() {
+  HelloFrame h;
+  h.fw_version = FIRMWARE_VERSION;
+  h.features = FEATURE_WATCHDOG | FEATURE_AUX_LINK;
+  h.reset_flags = 0x08;
+  h.build = "Oct 14 2026 09:12:55";
+  h.link_us = 1500;
+
+  StringPrint line;
+  protocol::encodeHelloLine(h, line);
+  check(line.text.find("\"type\":\"hello\"") != std::string::npos &&
+        line.text.find("\"stage\":\"link\"") != std::string::npos &&
+        line.text.find("\"build\":\"Oct 14 2026 09:12:55\"") != std::string::npos &&
+        line.text.find("\"setup_us\":0") != std::string::npos, "link hello line, no timing yet");
+  check(line.text.size() <= SERIAL_TX_FRAME_BYTES, "hello line fits the TX stage");
+
+  h.stage = BootStage::READY;
+  h.setup_us = 23000;
+  h.first_tel_us = 77000;
+  StringPrint frame;
+  protocol::bin::encodeHelloFrame(h, frame);
+  std::vector<uint8_t> f(frame.text.begin(), frame.text.end() - 1);   // drop the delimiter
+  const uint8_t* payload = nullptr;
+  size_t len = 0;
+  protocol::bin::HelloPacket p;
+  const bool framed = protocol::bin::decodeFrame(f.data(), f.size(), payload, len) == protocol::bin::PKT_HELLO &&
+                      len == sizeof(p);
+  if (framed) memcpy(&p, payload, sizeof(p));
+  check(framed && p.stage == (uint8_t)BootStage::READY && p.proto == protocol::bin::PROTOCOL_VERSION &&
+        p.setup_us == 23000 && p.first_tel_us == 77000 && memcmp(p.build, h.build, BUILD_ID_BYTES) == 0,
+        "ready hello frame carries the boot timing");
+}
+
+void caseEventLog() {
+  EventLog log;
+  EventLogChunk c;
+  check(!log.chunk(log.oldest(), log.written(), c), "empty log has no chunk");
+
+  // Repeats fold into the newest record, first time kept, latest args
+  log.log(100, EventId::BOOT, 0x08, FIRMWARE_VERSION);
+  for (uint16_t i = 0; i < 300; i++) log.log(200 + i, EventId::CMD_APPLIED, (int16_t)i, 0);
+  check(log.written() == 3 && log.held() == 3, "300 commands take two records (count saturates at 255)");
+  check(log.chunk(0, 3, c) && c.first == 0 && c.count == 3 && c.records[1].t_ms == 200 &&
+        c.records[1].count == 255 && c.records[1].a == 254 && c.records[2].count == 45 && c.records[2].a == 299,
+        "folded records keep the first time and the latest args");
+
+  // Past capacity: the oldest are gone, a stale start moves up, chunks stop
+  // at the end of the storage
+  for (uint16_t i = 0; i < EVENT_LOG_RECORDS + 5; i++) {
+    log.log(1000 + i, (i & 1) ? EventId::SERVO_ATTACH : EventId::SERVO_DETACH, (int16_t)i, 0);
+  }
+  const uint16_t end = log.written();
+  check(log.held() == EVENT_LOG_RECORDS && log.oldest() == (uint16_t)(end - EVENT_LOG_RECORDS),
+        "full ring holds the newest EVENT_LOG_RECORDS");
+  uint16_t n = 0, got = 0, chunks = 0;
+  bool in_order = true;
+  uint32_t last_t = 0;
+  while (log.chunk(n, end, c)) {
+    check(c.count <= EVENT_LOG_CHUNK_RECORDS && (c.first & (EVENT_LOG_RECORDS - 1)) + c.count <= EVENT_LOG_RECORDS,
+          "chunk is contiguous in the ring");
+    for (uint8_t i = 0; i < c.count; i++) {
+      if (c.records[i].t_ms <= last_t) in_order = false;
+      last_t = c.records[i].t_ms;
+    }
+    if (chunks == 0) check(c.first == log.oldest(), "overwritten start moves up to the oldest record");
+    got += c.count;
+    chunks++;
+    n = (uint16_t)(c.first + c.count);
+  }
+  check(got == EVENT_LOG_RECORDS && in_order && n == end, "dump reads every held record oldest first");
+
+  StringPrint frame;
+  log.chunk(log.oldest(), end, c);
+  protocol::bin::encodeEventLogFrame(c, frame);
+  std::vector<uint8_t> f(frame.text.begin(), frame.text.end() - 1);
+  const uint8_t* payload = nullptr;
+  size_t len = 0;
+  protocol::bin::EventLogHeaderPacket h;
+  protocol::bin::EventRecordPacket r;
+  const bool framed = protocol::bin::decodeFrame(f.data(), f.size(), payload, len) == protocol::bin::PKT_EVENT_LOG &&
+                      len == sizeof(h) + c.count * sizeof(r);
+  if (framed) {
+    memcpy(&h, payload, sizeof(h));
+    memcpy(&r, payload + sizeof(h) + sizeof(r), sizeof(r));
+  }
+  check(framed && h.first == c.first && h.end == end && r.t_ms == c.records[1].t_ms &&
+        r.id == c.records[1].id && r.a == c.records[1].a, "event log frame round trip");
+
+  // Dump over a link whose UART ring drains one tick in five, the way the
+  // maintenance task runs it: the cursor moves on a true sendEventLog(),
+  // and telemetry published behind a chunk can't displace it
+  {
+    uint8_t none = 0;
+    ReplayStream rx(&none, 0);
+    StringPrint tx;
+    rx.tee(&tx);
+    uint8_t stage[SERIAL_TX_FRAME_BYTES];
+    SerialLink link(rx, stage, sizeof(stage));
+    link.begin();
+    link.setWireMode(WireMode::BINARY);
+
+    uint16_t cursor = log.oldest();
+    bool dumping = true;
+    for (uint32_t i = 0; i < 2000 && (dumping || link.txPending()); i++) {
+      rx.txRoom((i % 5 == 0) ? 0x7FFF : 0);
+      link.tick(i * 5);
+      rx.txRoom(0);
+      if (dumping && !link.txPending()) {
+        if (!log.chunk(cursor, end, c)) {
+          c = EventLogChunk();
+          c.first = c.end = end;
+        }
+        if (link.sendEventLog(c)) {
+          cursor = (uint16_t)(c.first + c.count);
+          dumping = (cursor != end);
+        }
+      }
+      TelemetryFrame t = sampleTelemetry(i);
+      link.publish(t, i * 5);
+    }
+
+    uint16_t next = log.oldest();
+    bool contiguous = true;
+    for (const std::string& p : tx.payloads(protocol::bin::PKT_EVENT_LOG)) {
+      memcpy(&h, p.data(), sizeof(h));
+      contiguous = contiguous && h.first == next;
+      next = (uint16_t)(next + (p.size() - sizeof(h)) / sizeof(r));
+    }
+    check(!dumping && contiguous && next == end && link.txDropped() > 0,
+          "congested link: the dump arrives whole, telemetry dropped instead");
+  }
+
+  log.clear();
+  check(log.held() == 0 && log.oldest() == end && !log.chunk(n, end, c), "clear empties the ring, numbers go on");
+
+  CommandParser parser(SERIAL_LINE_MAX_BYTES);
+  CommandParser::Result res = CommandParser::Result::NONE;
+  for (const char* p = "{\"op\":\"dump\",\"type\":\"log\"}\n"; *p; p++) res = parser.feed(*p);
+  check(res == CommandParser::Result::LOG && parser.log().op == LogOp::DUMP, "log dump line parses");
+  protocol::bin::LogPacket lp = { (uint8_t)LogOp::CLEAR };
+  LogRequest lr;
+  check(protocol::bin::decodeLogPayload((const uint8_t*)&lp, sizeof(lp), lr) && lr.op == LogOp::CLEAR,
+        "binary log payload decodes");
+}
+
+// Distance from (x, y) to the polyline pts[0..n-1]
+static float polylineDistance(const PathPoint* pts, uint8_t n, float x, float y) {
+  float best = INFINITY;
+  for (uint8_t i = 0; i + 1 < n; i++) {
+    const float ex = pts[i + 1].x_ft - pts[i].x_ft, ey = pts[i + 1].y_ft - pts[i].y_ft;
+    float t = ((x - pts[i].x_ft) * ex + (y - pts[i].y_ft) * ey) / (ex * ex + ey * ey);
+    t = (t < 0.0f) ? 0.0f : (t > 1.0f) ? 1.0f : t;
+    const float d = hypotf(x - pts[i].x_ft - t * ex, y - pts[i].y_ft - t * ey);
+    if (d < best) best = d;
+  }
+  return best;
+}
+
+// Follows `req` from `pose` on ideal unicycle kinematics at DRIVE_UPDATE_HZ;
+// returns the ticks taken (0 = never finished) and the worst distance off
+// the path once the robot is on it
+static uint32_t simulatePath(PathFollower& f, const PathRequest& req, PoseState pose, float& max_off, PoseState& end) {
+  PathPoint pts[PATH_MAX_POINTS + 1];
+  pts[0].x_ft = pose.x_ft;
+  pts[0].y_ft = pose.y_ft;
+  for (uint8_t i = 0; i < req.count; i++) pts[i + 1] = req.points[i];
+
+  max_off = 0.0f;
+  const float dt = 1.0f / (float)DRIVE_UPDATE_HZ;
+  if (!f.start(req, pose, 0)) return 0;
+  for (uint32_t tick = 1; tick < 60UL * DRIVE_UPDATE_HZ; tick++) {
+    const DriveCommand cmd = f.tick(pose, tick * 1000UL / DRIVE_UPDATE_HZ);
+    if (!f.running()) {
+      end = pose;
+      return tick;
+    }
+    const float h = pose.heading_deg * (float)PI / 180.0f;
+    pose.x_ft += cmd.linear_ftps * cosf(h) * dt;
+    pose.y_ft += cmd.linear_ftps * sinf(h) * dt;
+    pose.heading_deg += cmd.angular_dps * dt;
+    if (cmd.linear_ftps > 0.0f) {
+      const float off = polylineDistance(pts, req.count + 1, pose.x_ft, pose.y_ft);
+      if (off > max_off) max_off = off;
+    }
+  }
+  return 0;
+}
+
+void casePathFollower() {
+  // L-shaped path: 4 ft out, 3 ft to the left
+  PathRequest req;
+  req.action = PathAction::RUN;
+  req.count = 2;
+  req.speed_ftps = 1.5f;
+  req.points[0] = PathPoint{4.0f, 0.0f};
+  req.points[1] = PathPoint{4.0f, 3.0f};
+
+  PathFollower f;
+  PoseState pose, end;
+  float max_off = 0.0f;
+  uint32_t ticks = simulatePath(f, req, pose, max_off, end);
+  check(ticks > 0 && f.state() == PathFollower::State::DONE, "L path finishes");
+  check(hypotf(end.x_ft - 4.0f, end.y_ft - 3.0f) <= PATH_GOAL_TOLERANCE_FT + 0.05f, "L path ends at the last point");
+  check(max_off < 0.5f * PATH_LOOKAHEAD_FT, "corner cut stays within half the lookahead");
+  check(f.segment() == 1 && f.segments() == 2, "L path reached its second segment");
+  printf("path L: %.2f s, max off %.3f ft, end (%.3f, %.3f)\n",
+         (double)ticks / DRIVE_UPDATE_HZ, (double)max_off, (double)end.x_ft, (double)end.y_ft);
+
+  // Starting backwards: turns on the spot first, then follows
+  pose.heading_deg = 180.0f;
+  ticks = simulatePath(f, req, pose, max_off, end);
+  check(ticks > 0 && hypotf(end.x_ft - 4.0f, end.y_ft - 3.0f) <= PATH_GOAL_TOLERANCE_FT + 0.05f,
+        "path started facing away still finishes");
+
+  // Refused: no points away from the robot, non-positive speed; the
+  // running path is left alone
+  PoseState at;
+  f.start(req, at, 0);
+  PathRequest bad;
+  bad.action = PathAction::RUN;
+  bad.count = 1;
+  check(!f.start(bad, at, 0) && f.running(), "a point on the robot is refused");
+  bad.points[0] = PathPoint{1.0f, 0.0f};
+  bad.speed_ftps = -1.0f;
+  check(!f.start(bad, at, 0) && f.running() && f.segments() == 2, "negative speed is refused");
+  const uint8_t gen = f.stateGen();
+  f.abort(0);
+  const DriveCommand stopped = f.tick(at, 10);
+  check(f.state() == PathFollower::State::ABORTED && f.stateGen() != gen &&
+        stopped.linear_ftps == 0.0f && stopped.angular_dps == 0.0f, "abort ends the path, tick returns zero");
+
+  CommandParser parser(SERIAL_LINE_MAX_BYTES);
+  CommandParser::Result res = CommandParser::Result::NONE;
+  for (const char* p = "{\"type\":\"path\",\"points\":[4,0,4.5,-3],\"speed\":1.2}\n"; *p; p++) res = parser.feed(*p);
+  check(res == CommandParser::Result::PATH && parser.path().action == PathAction::RUN && parser.path().count == 2 &&
+        parser.path().points[1].y_ft == -3.0f && fabsf(parser.path().speed_ftps - 1.2f) < 1e-6f &&
+        isnan(parser.path().lookahead_ft), "path line parses");
+  for (const char* p = "{\"type\":\"path\",\"points\":[4,0,4.5]}\n"; *p; p++) res = parser.feed(*p);
+  check(res == CommandParser::Result::ERROR, "path with half a point is rejected");
+  for (const char* p = "{\"type\":\"path\",\"abort\":1}\n"; *p; p++) res = parser.feed(*p);
+  check(res == CommandParser::Result::PATH && parser.path().action == PathAction::ABORT, "path abort parses");
+
+  uint8_t buf[sizeof(protocol::bin::PathPacket) + 2 * sizeof(protocol::bin::PathPointPacket)];
+  protocol::bin::PathPacket h = { (uint8_t)PathAction::RUN, 2, 1.0f, NAN };
+  protocol::bin::PathPointPacket pts[2] = { {4.0f, 0.0f}, {4.0f, 3.0f} };
+  memcpy(buf, &h, sizeof(h));
+  memcpy(buf + sizeof(h), pts, sizeof(pts));
+  PathRequest pr;
+  check(protocol::bin::decodePathPayload(buf, sizeof(buf), pr) && pr.count == 2 && pr.points[1].y_ft == 3.0f &&
+        isnan(pr.lookahead_ft), "binary path payload decodes");
+  check(!protocol::bin::decodePathPayload(buf, sizeof(buf) - 1, pr), "binary path with a short point is rejected");
+}
+
+static int replayMain(int argc, char** argv) {
+  RxCapture cap;
+  if (argc < 3 || !loadRxCapture(argv[2], cap)) {
+    printf("cannot read RX capture %s\n", (argc < 3) ? "(none given)" : argv[2]);
+    return 2;
+  }
+  printf("rx capture=%s records=%zu bytes=%zu seq_gaps=%u bad_frames=%u\n",
+         argv[2], cap.records.size(), cap.bytes.size(), (unsigned)cap.seq_gaps, (unsigned)cap.bad_frames);
+
+  FILE* timeline = nullptr;
+  if (argc > 3 && !(timeline = fopen(argv[3], "w"))) {
+    printf("cannot write %s\n", argv[3]);
+    return 2;
+  }
+
+  RxReplay replay;
+  replay.setTimeline(timeline, true);
+  replay.run(cap);
+  replay.printSummary(stdout);
+  if (timeline) fclose(timeline);
+  return 0;
+}
+
+// PIDFx, as the drive ISR runs it: Fixed gains match float ones, the
+// rate overload's derivative is -kd * rate, and it agrees with the
+// one-step difference when the rate is that difference
+void casePIDFx() {
+  const float dt = 1.0f / DRIVE_ISR_HZ;
+  PIDFx a(0.9f, 2.0f, 0.06f, dt, 50.0f);
+  PIDFx b(0.9f, 2.0f, 0.06f, dt, 50.0f);
+  b.setGains(Fixed::fromFloat(0.9f), Fixed::fromFloat(2.0f), Fixed::fromFloat(0.06f));
+
+  float worst = 0.0f;
+  for (int k = 0; k < 400; k++) {
+    const Fixed m = Fixed::fromFloat(0.002f * (float)k);
+    const Fixed rate = Fixed::fromFloat(0.002f * DRIVE_ISR_HZ);
+    const float ua = a.update(fx::ONE, m).toFloat();
+    const float ub = b.update(fx::ONE, m, rate).toFloat();
+    if (k > 0 && fabsf(ua - ub) > worst) worst = fabsf(ua - ub);
+  }
+  check(worst < 2e-3f, "Fixed gains, rate overload: same output as the one-step difference");
+
+  PIDFx d(0.0f, 0.0f, 0.0f, dt, 50.0f);
+  d.setGains(fx::ZERO, fx::ZERO, Fixed::fromFloat(0.05f));
+  const float u = d.update(fx::ZERO, fx::ZERO, Fixed::fromFloat(4.0f)).toFloat();
+  check(fabsf(u + 0.2f) < 1e-3f && fabsf(d.getState().d_term.toFloat() + 0.2f) < 1e-3f,
+        "rate overload: derivative term is -kd * rate");
+
+  // Limits from the ISR (what the feed-forward leaves), swapped order
+  // taken as given; a saturated output holds the integrator
+  PIDFx s(1.0f, 10.0f, 0.0f, dt, 50.0f);
+  s.setOutputLimits(Fixed::fromFloat(0.3f), Fixed::fromFloat(-0.5f));
+  for (int k = 0; k < 100; k++) s.update(Fixed::fromFloat(2.0f), fx::ZERO, fx::ZERO);
+  check(s.getState().saturated && fabsf(s.getState().output.toFloat() - 0.3f) < 1e-4f &&
+        s.getState().integral == fx::ZERO, "clamped to the ISR limits, integrator held while saturated");
+  s.setIntegralLimit(Fixed::fromFloat(-0.01f));
+  s.setOutputLimits(-fx::ONE * 4, fx::ONE * 4);
+  for (int k = 0; k < 100; k++) s.update(Fixed::fromFloat(2.0f), fx::ZERO, fx::ZERO);
+  check(fabsf(s.getState().integral.toFloat() - 0.01f) < 1e-4f, "integral limit is a magnitude");
+}
+
+// DriveInnerLoop ticked like the sampler's ISR against a first-order wheel
+// model (4 ft/s per unit duty, 0.15 s), with the drive task's setTargets()
+// every 10 ms: tracking, the double-buffered handoff, gains with the next
+// block, the stale-setpoint coast and release()
+void caseDriveInnerLoop() {
+  DcMotorActuator left(PIN_LHS_DRIVE_DIR, PIN_LHS_DRIVE_PWM);
+  DcMotorActuator right(PIN_RHS_DRIVE_DIR, PIN_RHS_DRIVE_PWM, true);
+  left.begin();
+  right.begin();
+  DriveInnerLoop loop(left, right);
+  DcMotorActuator* const motor[2] = {&left, &right};
+
+  float v[2] = {0.0f, 0.0f};
+  float x[2] = {0.0f, 0.0f};
+  const float dt = 1.0f / DRIVE_ISR_HZ;
+  auto isr = [&](uint32_t ticks) {
+    for (uint32_t n = 0; n < ticks; n++) {
+      int32_t c[2];
+      for (uint8_t i = 0; i < 2; i++) c[i] = (int32_t)floorf(x[i] / FEET_PER_COUNT);
+      loop.tickIsr_(c);
+      for (uint8_t i = 0; i < 2; i++) {
+        const float duty = (i ? -1.0f : 1.0f) * motor[i]->dutyCmd();   // right is inverted
+        v[i] += (4.0f * duty - v[i]) * dt / 0.15f;
+        x[i] += v[i] * dt;
+      }
+    }
+  };
+  const uint32_t per_task = DRIVE_ISR_HZ / DRIVE_UPDATE_HZ;
+
+  // Feed-forward 10% short: P makes up most of it
+  DriveInnerLoop::Wheel l, r;
+  l.run = r.run = true;
+  l.ref_ftps = 1.0f;   l.ff_duty = 0.225f;
+  r.ref_ftps = -0.5f;  r.ff_duty = -0.1125f;
+  for (uint32_t t = 0; t < DRIVE_UPDATE_HZ * 2; t++) {
+    loop.setTargets(l, r);
+    isr(per_task);
+  }
+  printf("%-32s %.3f / %.3f ft/s, duty %.3f / %.3f\n", "drive inner loop, 2 s",
+         v[0], v[1], loop.duty(0), loop.duty(1));
+  check(fabsf(v[0] - 1.0f) < 0.05f && fabsf(v[1] + 0.5f) < 0.05f, "ISR PIDs track both wheel refs");
+  check(fabsf(loop.duty(0) - left.dutyCmd()) < 1e-4f && fabsf(loop.duty(1) + right.dutyCmd()) < 1e-4f,
+        "duty() reports what the ISR wrote");
+
+  // Handoff: two publishes between ticks, the ISR takes the latest whole
+  DriveInnerLoop::Wheel l2 = l;
+  l2.ref_ftps = 0.0f;
+  l2.ff_duty = 0.4f;
+  loop.setTargets(l2, r);
+  loop.setTargets(l, r);
+  isr(1);
+  const float kept = loop.duty(0);
+  check(kept > 0.2f && kept < 0.3f, "back-to-back publishes: the ISR reads the newest block");
+
+  // Gains are taken with the next block, not before
+  loop.setGains(0.0f, 0.0f, 0.0f, DRIVE_INTEGRAL_LIMIT);
+  isr(1);
+  const bool held = fabsf(loop.duty(0) - l.ff_duty) > 1e-3f;
+  loop.setTargets(l, r);
+  isr(1);
+  check(held && fabsf(loop.duty(0) - l.ff_duty) < 1e-4f, "setGains() lands with the next setTargets()");
+  loop.setGains(DRIVE_KP, DRIVE_KI, DRIVE_KD, DRIVE_INTEGRAL_LIMIT);
+
+  // A wheel set to !run goes back to the task, coasted at once
+  DriveInnerLoop::Wheel off;
+  loop.setTargets(l, off);
+  const bool coasted_now = right.dutyCmd() == 0.0f;
+  isr(per_task);
+  check(coasted_now && right.dutyCmd() == 0.0f && loop.duty(1) == 0.0f && left.dutyCmd() != 0.0f,
+        "!run wheel: coasted by the task, left alone by the ISR");
+
+  // Stale: the task stops publishing; the ISR coasts both wheels itself
+  // DRIVE_ISR_STALE_MS after the last block, and counts it once
+  loop.setTargets(l, r);
+  isr(1);
+  isr((DRIVE_ISR_STALE_MS - 5) * DRIVE_ISR_HZ / 1000);
+  const bool driving = left.dutyCmd() != 0.0f && right.dutyCmd() != 0.0f && loop.staleTrips() == 0;
+  isr(10 * DRIVE_ISR_HZ / 1000);
+  check(driving && left.dutyCmd() == 0.0f && right.dutyCmd() == 0.0f && loop.duty(0) == 0.0f,
+        "stale setpoint: ISR coasts the wheels after DRIVE_ISR_STALE_MS");
+  isr(DRIVE_ISR_HZ / 10);
+  check(loop.staleTrips() == 1, "a stale spell counts one trip");
+  loop.setTargets(l, r);
+  isr(1);
+  check(left.dutyCmd() != 0.0f && right.dutyCmd() != 0.0f, "next setTargets() picks the wheels up again");
+
+  loop.release();
+  const bool released = left.dutyCmd() == 0.0f && right.dutyCmd() == 0.0f;
+  isr(DRIVE_ISR_HZ / 10);
+  check(released && left.dutyCmd() == 0.0f && right.dutyCmd() == 0.0f && loop.staleTrips() == 1,
+        "release(): both coasted, the ISR writes nothing after");
+}
+
+int main(int argc, char** argv) {
+  if (argc > 1 && strcmp(argv[1], "--replay") == 0) return replayMain(argc, argv);
+
+  const char* path = (argc > 1) ? argv[1] : DEFAULT_CAPTURE;
+  const int reps = (argc > 2) ? atoi(argv[2]) : 50;
+
+  Capture cap;
+  if (!loadCapture(path, cap)) {
+    printf("cannot read capture %s\n", path);
+    return 2;
+  }
+
+  printf("APWCR native throughput\n");
+  printf("capture=%s bytes=%zu json=%zu binary=%zu reps=%d\n\n",
+         path, cap.bytes.size(), cap.json_lines.size(), cap.binary_frames.size(), reps);
+
+  printHeader();
+  caseSerialLink(cap, reps);
+  caseDecodeCommandLine(cap, reps);
+  caseDecodeBinary(cap, reps);
+  caseEncodeTelemetry(reps);
+  caseTelemetryDelta(reps);
+  caseServoTick(reps);
+  caseServoTickT(reps);
+  caseServoHold();
+  caseMotionProfile(reps);
+  caseSequencer();
+  caseSubscribe();
+  caseCredit();
+  caseTxPriority();
+  caseSequenceReport();
+  caseWatchdog(reps);
+  caseLinkStats();
+  caseTimeSync();
+  caseCommandQueue();
+  caseAuxLink();
+  caseRxReplay();
+  caseRangeFilter();
+  caseSonarArray();
+  caseObstacleGuard();
+  caseOdometry();
+  caseParamStore();
+  caseSchedulerIdle();
+  caseRate();
+  caseSysId();
+  caseHello();
+  caseEventLog();
+  casePathFollower();
+  casePIDFx();
+  caseDriveInnerLoop();
+
+  printf("\n%s (%d failure%s)\n", g_failures ? "FAILED" : "ok", g_failures, (g_failures == 1) ? "" : "s");
+  return g_failures ? 1 : 0;
+}
@@ -0,0 +1,108 @@
+#pragma once
+#include <Arduino.h>
+
+#include "comms/BulkStream.h"
+
+/*
+===============================================================================
+  Replay.h   (env:native only)
+===============================================================================
+
+  PURPOSE
+  -------
+  Host-side Stream / Print endpoints for replaying captured serial traffic
+  through the firmware's comms code:
+
+    ReplayStream   serves a byte buffer as RX, at most `chunk` bytes per
+                   refill() so SerialLink::tick sees the traffic in the
+                   same small bursts the UART would deliver; replies
+                   are discarded unless a tee() sink is set; expose()
+                   releases bytes by arrival time instead (RxReplay.h)
+    CountingPrint  TX sink: counts bytes and frame delimiters ('\n' for
+                   JSON, 0x00 for COBS), stores nothing
+===============================================================================
+*/
+
+class ReplayStream : public BulkStream {
+public:
+  ReplayStream(const uint8_t* data, size_t len) : _data(data), _len(len) {}
+
+  // Make up to `chunk` more bytes readable. Returns false once drained.
+  bool refill(size_t chunk) {
+    if (_pos >= _len) return false;
+    _limit = _pos + chunk;
+    if (_limit > _len) _limit = _len;
+    return true;
+  }
+
+  // Make everything before offset `end` readable (timed replay: the bytes
+  // that have arrived by now, however much was consumed so far)
+  void expose(size_t end) {
+    if (end > _len) end = _len;
+    if (end > _limit) _limit = end;
+  }
+
+  void rewind() { _pos = 0; _limit = 0; }
+  bool done() const { return _pos >= _len; }
+
+  int available() override { return (int)(_limit - _pos); }
+  int read() override { return (_pos < _limit) ? _data[_pos++] : -1; }
+  int peek() override { return (_pos < _limit) ? _data[_pos] : -1; }
+
+  size_t peekBuffer(const uint8_t*& data) override {
+    data = _data + _pos;
+    return _limit - _pos;
+  }
+  void consume(size_t n) override { _pos += n; }
+
+  // Firmware replies go to the tee sink, if any (and never back up)
+  void tee(Print* sink) { _tee = sink; }
+  size_t write(uint8_t c) override { if (_tee) _tee->write(c); return 1; }
+  size_t write(const uint8_t* buffer, size_t size) override {
+    if (_tee) _tee->write(buffer, size);
+    return size;
+  }
+  using Print::write;
+  int availableForWrite() override { return _tx_room; }
+
+  // Room the UART TX ring reports (0 = full, a host that fell behind)
+  void txRoom(int bytes) { _tx_room = bytes; }
+
+private:
+  const uint8_t* _data;
+  size_t _len;
+  size_t _pos = 0;
+  size_t _limit = 0;
+  Print* _tee = nullptr;
+  int _tx_room = 0x7FFF;
+};
+
+class CountingPrint : public Print {
+public:
+  explicit CountingPrint(uint8_t delimiter) : _delimiter(delimiter) {}
+
+  size_t write(uint8_t c) override {
+    _bytes++;
+    if (c == _delimiter) _frames++;
+    return 1;
+  }
+
+  size_t write(const uint8_t* buffer, size_t size) override {
+    for (size_t i = 0; i < size; i++) {
+      if (buffer[i] == _delimiter) _frames++;
+    }
+    _bytes += size;
+    return size;
+  }
+
+  using Print::write;
+
+  uint64_t bytes() const { return _bytes; }
+  uint64_t frames() const { return _frames; }
+  void reset() { _bytes = 0; _frames = 0; }
+
+private:
+  uint8_t _delimiter;
+  uint64_t _bytes = 0;
+  uint64_t _frames = 0;
+};
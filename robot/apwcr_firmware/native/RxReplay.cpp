@@ -0,0 +1,284 @@
+#include "RxReplay.h"
+
+#include <algorithm>
+#include <chrono>
+#include <stdarg.h>
+#include <string>
+
+#include "Params.h"
+#include "comms/BinaryProtocol.h"
+#include "comms/SerialLink.h"
+#include "actuators/ServoPair.h"
+#include "utils/ParamStore.h"
+
+#include "Replay.h"
+
+/*
+===============================================================================
+  RxReplay.cpp   (env:native only)
+===============================================================================
+
+  The servos, ParamStore and SerialLink are fresh per run() (EEPROM mock
+  reset first), so a replay starts from the same state a boot does and two
+  runs of one capture produce the same timeline.
+===============================================================================
+*/
+
+namespace {
+
+constexpr uint64_t RX_PERIOD_US = 1000000ULL / RxCOMM_UPDATE_HZ;
+constexpr uint64_t SERVO_PERIOD_US = 1000000ULL / SERVO_UPDATE_HZ;
+
+// Run on past the last record while the queue drains and the servos settle
+// (a full-range ramp plus settle time fits easily)
+constexpr uint64_t TAIL_US = (COMMAND_QUEUE_MAX_AHEAD_MS + 10000ULL) * 1000ULL;
+
+void row(FILE* out, uint64_t t_us, const char* fmt, ...) __attribute__((format(printf, 3, 4)));
+void row(FILE* out, uint64_t t_us, const char* fmt, ...) {
+  if (!out) return;
+  fprintf(out, "%llu.%03u,", (unsigned long long)(t_us / 1000ULL), (unsigned)(t_us % 1000ULL));
+  va_list ap;
+  va_start(ap, fmt);
+  vfprintf(out, fmt, ap);
+  va_end(ap);
+  fputc('\n', out);
+}
+
+}  // namespace
+
+
+/*=============================================================================
+  CAPTURE FILE
+=============================================================================*/
+
+void parseRxCapture(const uint8_t* data, size_t len, RxCapture& out) {
+  std::vector<uint8_t> frame;
+  bool have_seq = false;
+  uint8_t next_seq = 0;
+  uint32_t last_t = 0;
+  uint64_t t = 0;
+
+  for (size_t i = 0; i < len; i++) {
+    if (data[i] != 0x00) { frame.push_back(data[i]); continue; }
+    if (frame.empty()) continue;
+
+    const uint8_t* payload = nullptr;
+    size_t payload_len = 0;
+    uint32_t t_us = 0;
+    uint8_t seq = 0;
+    const uint8_t* bytes = nullptr;
+    size_t n = 0;
+
+    const uint8_t type = protocol::bin::decodeFrame(frame.data(), frame.size(), payload, payload_len);
+    frame.clear();
+    if (type != protocol::bin::PKT_RX_CAPTURE ||
+        !protocol::bin::decodeRxCapturePayload(payload, payload_len, t_us, seq, bytes, n)) {
+      out.bad_frames++;
+      continue;
+    }
+
+    if (have_seq && seq != next_seq) out.seq_gaps += (uint8_t)(seq - next_seq);
+    next_seq = (uint8_t)(seq + 1);
+
+    // micros() wraps every 71 minutes; the deltas don't
+    t = have_seq ? t + (uint32_t)(t_us - last_t) : t_us;
+    last_t = t_us;
+    have_seq = true;
+
+    out.bytes.insert(out.bytes.end(), bytes, bytes + n);
+    RxCapture::Record r;
+    r.t_us = t;
+    r.end = out.bytes.size();
+    out.records.push_back(r);
+  }
+}
+
+bool loadRxCapture(const char* path, RxCapture& out) {
+  FILE* f = fopen(path, "rb");
+  if (!f) return false;
+
+  std::vector<uint8_t> raw;
+  uint8_t buf[4096];
+  size_t n;
+  while ((n = fread(buf, 1, sizeof(buf), f)) > 0) raw.insert(raw.end(), buf, buf + n);
+  fclose(f);
+
+  parseRxCapture(raw.data(), raw.size(), out);
+  return true;
+}
+
+
+/*=============================================================================
+  REPLAY
+=============================================================================*/
+
+void RxReplay::run(const RxCapture& cap) {
+  _sum = Summary();
+  if (cap.records.empty()) return;
+
+  hal::reset();
+  const uint64_t t0 = cap.records.front().t_us;
+  hal::setMicros(t0);
+
+  ParamStore params;
+  params.begin();
+
+  LidServo lid;
+  SweepServo sweep;
+  lid.begin((float)LID_CLOSED_DEG);
+  sweep.begin((float)SWEEP_STOW_DEG);
+  ServoPair<LidServo, SweepServo> servos(lid, sweep);
+  int16_t lid_target = lid.getState().target_ddeg;
+  int16_t sweep_target = sweep.getState().target_ddeg;
+  bool settled = true;
+
+  ReplayStream rx(cap.bytes.data(), cap.bytes.size());
+  uint8_t stage[SERIAL_TX_FRAME_BYTES];
+  SerialLink link(rx, stage, sizeof(stage));
+  link.begin();
+
+  ParamReply reply;
+  bool reply_due = false;
+  std::string note;
+  std::vector<double> tick_us;
+  double frame_us_sum = 0.0;
+
+  size_t next_rec = 0;
+  uint64_t next_rx = t0;
+  uint64_t next_servo = t0;
+  const uint64_t t_end = cap.records.back().t_us + TAIL_US;
+
+  while (true) {
+    const bool records_left = next_rec < cap.records.size();
+    if (!records_left && link.commandQueue().depth() == 0 && servos.settled()) break;
+
+    // Next instant: a recorded tick, the RX grid, or the servo grid
+    uint64_t now = std::min(next_rx, next_servo);
+    if (records_left) now = std::min(now, cap.records[next_rec].t_us);
+    if (now > t_end) break;
+    hal::setMicros(now);
+    const uint32_t now_ms = millis();
+
+    // RX tick: the recorded one, or a grid tick in between
+    const bool recorded = records_left && cap.records[next_rec].t_us == now;
+    if (recorded || now == next_rx) {
+      bool took = false;
+      while (next_rec < cap.records.size() && cap.records[next_rec].t_us <= now) {
+        rx.expose(cap.records[next_rec].end);
+        next_rec++;
+        took = true;
+      }
+
+      const uint32_t frames_before = link.rxOk() + link.rxFail() + link.rxOverflow();
+      const size_t avail = (size_t)rx.available();
+      const auto h0 = std::chrono::steady_clock::now();
+      link.tick(now_ms);
+      const double host_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - h0).count();
+      const uint32_t frames = link.rxOk() + link.rxFail() + link.rxOverflow() - frames_before;
+
+      if (took) {
+        _sum.rx_ticks++;
+        tick_us.push_back(host_us);
+        if (frames) frame_us_sum += host_us;
+        if (_timing) row(_timeline, now - t0, "rx,%zu,%u,%.2f", avail, (unsigned)frames, host_us);
+        else         row(_timeline, now - t0, "rx,%zu,%u", avail, (unsigned)frames);
+      }
+
+      const char* n = link.debugNote(now_ms);
+      if (n && note != n) {
+        note = n;
+        _sum.notes++;
+        row(_timeline, now - t0, "note,%s", n);
+      }
+
+      if (const SequenceRequest* req = link.pendingSequence()) {
+        row(_timeline, now - t0, "seq,%u,%u,%u", (unsigned)req->action, (unsigned)req->id, (unsigned)req->step_count);
+        link.clearPendingSequence();
+      }
+      if (const PoseReset* pose = link.pendingPose()) {
+        row(_timeline, now - t0, "pose,%.2f,%.2f,%.1f", pose->x_ft, pose->y_ft, pose->heading_deg);
+        link.clearPendingPose();
+      }
+      if (const ParamRequest* req = link.pendingParam()) {
+        params.handle(*req, reply);
+        params.applyPending();
+        reply_due = true;
+        row(_timeline, now - t0, "param,%u,%s,%u", (unsigned)reply.op, reply.name, (unsigned)reply.status);
+        link.clearPendingParam();
+      }
+      if (reply_due && link.sendParam(reply)) reply_due = false;
+
+      // taskRx's apply loop (no sequencer here, so nothing preempts it)
+      CommandFrame cmd;
+      while (link.takeCommand(now_ms, cmd)) {
+        const int32_t late = cmd.at_present ? (int32_t)(now_ms - cmd.at_ms) : 0;
+        _sum.commands++;
+        if (cmd.at_present) _sum.timed++;
+        if (late > _sum.late_max_ms) _sum.late_max_ms = late;
+
+        char lid_s[12] = "", sweep_s[12] = "";
+        if (cmd.mech.servo_LID_present) snprintf(lid_s, sizeof(lid_s), "%.1f", cmd.mech.servo_LID_deg);
+        if (cmd.mech.servo_SWEEP_present) snprintf(sweep_s, sizeof(sweep_s), "%.1f", cmd.mech.servo_SWEEP_deg);
+        row(_timeline, now - t0, "cmd,%lu,%.3f,%.2f,%s,%s,%ld",
+            (unsigned long)cmd.seq, cmd.drive.linear_ftps, cmd.drive.angular_dps, lid_s, sweep_s, (long)late);
+
+        const TuningParams& p = params.active();
+        servos.command(cmd.mech.servo_LID_present, cmd.mech.servo_LID_deg,
+                       cmd.mech.servo_SWEEP_present, cmd.mech.servo_SWEEP_deg,
+                       p.lid_ramp_dps, p.sweep_ramp_dps, now_ms);
+      }
+
+      if (now == next_rx) next_rx += RX_PERIOD_US;
+    }
+
+    // Servo tick
+    if (now == next_servo) {
+      servos.tick(now_ms);
+      next_servo += SERVO_PERIOD_US;
+
+      const int16_t lt = lid.getState().target_ddeg;
+      const int16_t st = sweep.getState().target_ddeg;
+      if (lt != lid_target || st != sweep_target) {
+        lid_target = lt;
+        sweep_target = st;
+        _sum.servo_moves++;
+        row(_timeline, now - t0, "servo,%.1f,%.1f", lt * 0.1f, st * 0.1f);
+      }
+
+      const bool s = servos.settled();
+      if (s && !settled) {
+        row(_timeline, now - t0, "settled,%.1f,%.1f",
+            lid.getState().currentDeg(), sweep.getState().currentDeg());
+      }
+      settled = s;
+    }
+  }
+
+  _sum.duration_us = hal::nowMicros() - t0;
+  _sum.ok = link.rxOk();
+  _sum.fail = link.rxFail();
+  _sum.overflow = link.rxOverflow();
+  _sum.frames = _sum.ok + _sum.fail + _sum.overflow;
+
+  if (!tick_us.empty()) {
+    double total = 0.0;
+    for (double v : tick_us) total += v;
+    _sum.tick_mean_us = total / (double)tick_us.size();
+    std::sort(tick_us.begin(), tick_us.end());
+    _sum.tick_p99_us = tick_us[(tick_us.size() * 99) / 100];
+    _sum.tick_max_us = tick_us.back();
+  }
+  if (_sum.frames) _sum.frame_mean_us = frame_us_sum / (double)_sum.frames;
+}
+
+void RxReplay::printSummary(FILE* out) const {
+  const Summary& s = _sum;
+  fprintf(out, "replay: %.3f s, %u rx ticks, %u frames (ok=%u fail=%u ovf=%u)\n",
+          (double)s.duration_us / 1e6, (unsigned)s.rx_ticks, (unsigned)s.frames,
+          (unsigned)s.ok, (unsigned)s.fail, (unsigned)s.overflow);
+  fprintf(out, "applied: %u commands (%u timed, latest %ld ms late), %u servo moves, %u notes\n",
+          (unsigned)s.commands, (unsigned)s.timed, (long)s.late_max_ms,
+          (unsigned)s.servo_moves, (unsigned)s.notes);
+  fprintf(out, "host us per tick: mean %.2f p99 %.2f max %.2f; per frame %.2f\n",
+          s.tick_mean_us, s.tick_p99_us, s.tick_max_us, s.frame_mean_us);
+}
@@ -0,0 +1,98 @@
+#pragma once
+#include <Arduino.h>
+
+#include <stdio.h>
+#include <vector>
+
+/*
+===============================================================================
+  RxReplay.h   (env:native only)
+===============================================================================
+
+  PURPOSE
+  -------
+  Deterministic replay of a field RX capture (comms/RxRecorder: the bytes
+  the USB SerialLink took, each run stamped with the micros() of the tick
+  that took it) through the firmware's receive and apply path on a virtual
+  clock (hal::setMicros):
+
+    - SerialLink::tick at every recorded instant, with exactly the bytes
+      that had arrived by then, plus RxCOMM_UPDATE_HZ ticks in between
+      (timed commands come due on those)
+    - taskRx's apply logic: param requests (ParamStore, made live at once),
+      then takeCommand() into ServoPair::command at the ParamStore ramps;
+      drive / arm setpoints, seq and pose requests are logged, not run
+      (they need the motor hardware / the Sequencer's I/O)
+    - ServoPair::tick at SERVO_UPDATE_HZ
+
+  Output:
+    - timeline (CSV, optional): one row per event, same input -> same rows
+        t_ms,rx,<bytes>,<frames>[,<host_us>]    tick that took bytes
+        t_ms,cmd,<seq>,<linear>,<angular>,<lid|>,<sweep|>,<late_ms>
+        t_ms,servo,<lid_target>,<sweep_target>  targets changed
+        t_ms,settled,<lid>,<sweep>              move finished
+        t_ms,note,<text>                        RX FAIL / mode change / ...
+        t_ms,seq|pose|param,...
+      late_ms: apply time minus at_ms for timed commands, 0 otherwise
+    - summary: link counters, commands applied, host time per tick and per
+      frame (mean / p99 / max; relative figures, see NativeMain)
+
+  USAGE
+  -----
+    RxCapture cap;   loadRxCapture("field.rxcap", cap);
+    RxReplay replay; replay.setTimeline(stdout, true);
+    replay.run(cap); replay.printSummary(stdout);
+===============================================================================
+*/
+
+struct RxCapture {
+  struct Record {
+    uint64_t t_us = 0;     // unwrapped micros() of the consuming tick
+    size_t end = 0;        // bytes[previous end, end) were taken then
+  };
+
+  std::vector<uint8_t> bytes;
+  std::vector<Record> records;
+  uint32_t seq_gaps = 0;     // records lost between recorder and file
+  uint32_t bad_frames = 0;   // COBS / CRC / type / length rejects
+};
+
+// Splits a raw PKT_RX_CAPTURE stream (e.g. a dump of SERIAL_AUX) into records
+void parseRxCapture(const uint8_t* data, size_t len, RxCapture& out);
+bool loadRxCapture(const char* path, RxCapture& out);
+
+class RxReplay {
+public:
+  struct Summary {
+    uint64_t duration_us = 0;
+    uint32_t rx_ticks = 0;        // ticks that took bytes
+    uint32_t frames = 0;          // rxOk + rxFail + rxOverflow
+    uint32_t ok = 0;
+    uint32_t fail = 0;
+    uint32_t overflow = 0;
+    uint32_t commands = 0;        // applied
+    uint32_t timed = 0;           // of which from the queue
+    int32_t late_max_ms = 0;
+    uint32_t notes = 0;
+    uint32_t servo_moves = 0;
+
+    double tick_mean_us = 0.0;    // host time per tick that took bytes
+    double tick_p99_us = 0.0;
+    double tick_max_us = 0.0;
+    double frame_mean_us = 0.0;   // host time per frame
+  };
+
+  // Timeline rows to `out` (nullptr = none); timing adds host_us to rx rows
+  // (off for regression comparisons: it is the only nondeterministic column)
+  void setTimeline(FILE* out, bool timing) { _timeline = out; _timing = timing; }
+
+  void run(const RxCapture& cap);
+
+  const Summary& summary() const { return _sum; }
+  void printSummary(FILE* out) const;
+
+private:
+  FILE* _timeline = nullptr;
+  bool _timing = true;
+  Summary _sum;
+};
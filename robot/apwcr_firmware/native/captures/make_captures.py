@@ -0,0 +1,97 @@
+"""
+Regenerates the host->Arduino capture replayed by env:native.
+
+    python native/captures/make_captures.py
+
+cmd_stream.cap is what the laptop sends in a typical session: JSON command
+lines at 20 Hz, a link request switching to binary, then binary command
+frames. It is built with the real pwc_robot encoders so it tracks the
+Python side of the protocol.
+
+cmd_stream.rxcap is the same session as a field RX capture (the firmware's
+RxRecorder format): each command's bytes taken by the tick after it was
+sent, RxCOMM ticks 2.5 ms apart, for `program --replay`.
+"""
+
+import math
+import os
+import sys
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+sys.path.insert(0, os.path.join(HERE, "..", "..", "..", "python"))
+
+from pwc_robot.comms import binary_protocol, protocol  # noqa: E402
+from pwc_robot.controller.commands import (  # noqa: E402
+    DriveCommand,
+    MechanismCommand,
+    MechMotorCommand,
+    MechMotorMode,
+)
+
+JSON_FRAMES = 400
+BINARY_FRAMES = 400
+PERIOD_MS = 50
+RX_TICK_US = 2500
+
+
+def command(i: int):
+    t = i * PERIOD_MS
+    drive = DriveCommand(
+        linear=round(1.5 * math.sin(t / 1000.0), 3),
+        angular=round(45.0 * math.cos(t / 700.0), 2),
+    )
+    mech = MechanismCommand(
+        motor_LHS=MechMotorCommand(MechMotorMode.POS_DEG, 0.0),
+        motor_RHS=MechMotorCommand(MechMotorMode.DUTY, round(0.2 * ((i // 40) % 2), 2))
+        if i % 3 == 0 else None,
+        servo_LID_deg=90.0 if (i // 100) % 2 else 0.0,
+        servo_SWEEP_deg=round(90.0 + 60.0 * math.sin(t / 400.0), 1) if i % 2 else None,
+    )
+    return t, drive, mech
+
+
+def rx_capture(sends) -> bytearray:
+    """(t_ms, bytes) sends -> RX capture records, one run per tick that took them."""
+    out = bytearray()
+    rec = 0
+    for t_ms, data in sends:
+        # the first RX tick after the bytes arrived, plus a little jitter
+        t_us = (t_ms * 1000 // RX_TICK_US + 1) * RX_TICK_US + (t_ms * 37) % 400
+        for at in range(0, len(data), binary_protocol.RX_CAPTURE_CHUNK_BYTES):
+            chunk = data[at:at + binary_protocol.RX_CAPTURE_CHUNK_BYTES]
+            out += binary_protocol.encode_rx_capture_frame(t_us=t_us, seq=rec, data=chunk)
+            rec += 1
+    return out
+
+
+def main() -> None:
+    sends = []
+    seq = 1
+
+    for i in range(JSON_FRAMES):
+        t, drive, mech = command(i)
+        sends.append((t, protocol.encode_command_frame(seq=seq, host_time_ms=t, drive=drive, mech=mech)))
+        seq += 1
+
+    sends.append((JSON_FRAMES * PERIOD_MS - PERIOD_MS // 2, binary_protocol.encode_link_request_line(True)))
+
+    for i in range(JSON_FRAMES, JSON_FRAMES + BINARY_FRAMES):
+        t, drive, mech = command(i)
+        sends.append((t, binary_protocol.encode_command_frame(seq=seq, host_time_ms=t, drive=drive, mech=mech)))
+        seq += 1
+
+    out = b"".join(data for _, data in sends)
+    path = os.path.join(HERE, "cmd_stream.cap")
+    with open(path, "wb") as f:
+        f.write(out)
+    print(f"wrote {path}: {seq - 1} commands, {len(out)} bytes")
+
+    rx = rx_capture(sends)
+    path = os.path.join(HERE, "cmd_stream.rxcap")
+    with open(path, "wb") as f:
+        f.write(rx)
+    print(f"wrote {path}: {len(rx)} bytes")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,151 @@
+#pragma once
+
+/*
+===============================================================================
+  Arduino.h   (env:native mock HAL)
+===============================================================================
+
+  PURPOSE
+  -------
+  Just enough of the Arduino core for the hardware-independent modules
+  (comms/, utils/, actuators/) to build and run on the host:
+
+    - Print / Stream with the AVR core's write/print/println overloads
+    - F() / PROGMEM / pgm_read_* as plain memory access
+    - millis() / micros() driven by a virtual clock (hal::setMicros, ...)
+    - pinMode / digitalWrite / analogWrite recorded per pin
+
+  Only what the firmware actually uses is implemented. Anything that needs
+  real registers (sensors/, bench/) is not built in env:native.
+===============================================================================
+*/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>   // the AVR core pulls this in via Print.h
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "avr/io.h"        // the AVR core pulls this in too (_BV)
+#include "avr/pgmspace.h"
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#ifndef PI
+#define PI 3.1415926535897932384626433832795
+#endif
+
+#define HIGH 0x1
+#define LOW  0x0
+
+#define INPUT        0x0
+#define OUTPUT       0x1
+#define INPUT_PULLUP 0x2
+
+#define DEC 10
+#define HEX 16
+
+// Mega analog pin numbers (Pins.h uses them as digital pins)
+#define A0  54
+#define A1  55
+#define A2  56
+#define A3  57
+#define A8  62
+#define A9  63
+#define A10 64
+#define A11 65
+
+#define NUM_DIGITAL_PINS 70
+
+// Same macro as the AVR core (arguments evaluated more than once)
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+class __FlashStringHelper;
+#define F(string_literal) (reinterpret_cast<const __FlashStringHelper*>(string_literal))
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+void analogWrite(uint8_t pin, int val);
+
+inline void noInterrupts() {}
+inline void interrupts() {}
+
+
+/*=============================================================================
+  Print / Stream
+=============================================================================*/
+
+class Print {
+public:
+  virtual ~Print() {}
+
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t* buffer, size_t size);
+
+  virtual int availableForWrite() { return 0; }
+  virtual void flush() {}
+
+  size_t write(const char* str) {
+    return str ? write((const uint8_t*)str, strlen(str)) : 0;
+  }
+  size_t write(const char* buffer, size_t size) { return write((const uint8_t*)buffer, size); }
+
+  size_t print(const __FlashStringHelper* s);
+  size_t print(const char* s) { return write(s); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(unsigned char v, int base = DEC) { return print((unsigned long)v, base); }
+  size_t print(int v, int base = DEC) { return print((long)v, base); }
+  size_t print(unsigned int v, int base = DEC) { return print((unsigned long)v, base); }
+  size_t print(long v, int base = DEC);
+  size_t print(unsigned long v, int base = DEC);
+  size_t print(double v, int digits = 2);
+
+  size_t println() { return write("\r\n"); }
+  template <typename T> size_t println(T v) { size_t n = print(v); return n + println(); }
+  template <typename T> size_t println(T v, int fmt) { size_t n = print(v, fmt); return n + println(); }
+};
+
+class Stream : public Print {
+public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+
+  void setTimeout(unsigned long) {}
+};
+
+
+/*=============================================================================
+  Mock control (host only)
+=============================================================================*/
+
+namespace hal {
+
+void setMicros(uint64_t us);
+void advanceMicros(uint64_t us);
+uint64_t nowMicros();
+
+// Last value written to a pin (digitalWrite or analogWrite)
+int pinValue(uint8_t pin);
+uint8_t pinModeOf(uint8_t pin);
+uint32_t pinWrites(uint8_t pin);
+
+// Hardware WDT: WDTO_* passed to wdt_enable (-1 = off), wdt_reset count
+int wdtPeriod();
+uint32_t wdtKicks();
+
+// EEPROM (avr/eeprom.h): bytes written since reset(), raw contents
+uint32_t eepromWrites();
+uint8_t* eepromData();
+
+void reset();
+
+}  // namespace hal
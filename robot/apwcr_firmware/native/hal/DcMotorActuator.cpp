@@ -0,0 +1,91 @@
+#include "actuators/DcMotorActuator.h"
+
+/*
+===============================================================================
+  DcMotorActuator.cpp   (env:native mock HAL)
+===============================================================================
+
+  The motor driver on its analogWrite backend only (the host has no timer
+  registers): same clamp, inversion and pwm_min / pwm_max scaling as
+  src/actuators/DcMotorActuator.cpp, written to the mock pins. Tests read
+  a motor back through dutyCmd() / pwmCmd() or hal::pinValue().
+===============================================================================
+*/
+
+DcMotorActuator::DcMotorActuator(uint8_t pin_dir,
+                                 uint8_t pin_pwm,
+                                 bool invert,
+                                 uint8_t pwm_min,
+                                 uint8_t pwm_max)
+: _pin_dir(pin_dir),
+  _pin_pwm(pin_pwm),
+  _invert(invert),
+  _pwm_min(pwm_min < pwm_max ? pwm_min : pwm_max),
+  _pwm_max(pwm_min < pwm_max ? pwm_max : pwm_min)
+{
+}
+
+void DcMotorActuator::begin() {
+  pinMode(_pin_dir, OUTPUT);
+  pinMode(_pin_pwm, OUTPUT);
+  _dir_level = -1;
+  _top = 255;
+  _out_min = _pwm_min;
+  _out_max = _pwm_max;
+  coast();
+}
+
+uint16_t DcMotorActuator::dutyToPwm_(Fixed abs_duty) const {
+  if (abs_duty <= fx::ZERO) return 0;
+  if (abs_duty >= fx::ONE) return _out_max;
+  const uint32_t span = (uint32_t)(_out_max - _out_min);
+  return (uint16_t)(_out_min + (((uint32_t)abs_duty.raw() * span + 0x8000UL) >> 16));
+}
+
+void DcMotorActuator::writeDir_(bool high) {
+  const int8_t level = high ? 1 : 0;
+  if (level == _dir_level) return;
+  _dir_level = level;
+  digitalWrite(_pin_dir, high ? HIGH : LOW);
+}
+
+void DcMotorActuator::writePwm_(uint16_t pwm) { analogWrite(_pin_pwm, (int)pwm); }
+
+void DcMotorActuator::output_(bool forward, uint16_t pwm) {
+  writeDir_(forward);
+  writePwm_(pwm);
+  _pwm_cmd = (int)pwm;
+}
+
+void DcMotorActuator::setDuty(Fixed duty) {
+  duty = fx::clamp(duty, -fx::ONE, fx::ONE);
+  if (_invert) duty = -duty;
+
+  _duty_cmd_fx = duty;
+  _duty_is_fx = true;
+  if (duty == fx::ZERO) {
+    coast();
+    return;
+  }
+  output_(duty > fx::ZERO, dutyToPwm_(fx::abs(duty)));
+}
+
+void DcMotorActuator::setDuty(float duty) { setDuty(Fixed::fromFloat(duty)); }
+
+void DcMotorActuator::coast() {
+  writeDir_(false);
+  writePwm_(0);
+
+  _duty_cmd = 0.0f;
+  _duty_is_fx = false;
+  _pwm_cmd = 0;
+}
+
+void DcMotorActuator::brake() {
+  writeDir_(true);
+  writePwm_(_top);
+
+  _duty_cmd = 0.0f;
+  _duty_is_fx = false;
+  _pwm_cmd = _top;
+}
@@ -0,0 +1,169 @@
+#include "Arduino.h"
+#include "avr/io.h"
+#include "avr/wdt.h"
+#include "avr/eeprom.h"
+
+#include <stdio.h>
+
+/*
+===============================================================================
+  Hal.cpp   (env:native mock HAL)
+===============================================================================
+*/
+
+namespace {
+
+uint64_t g_now_us = 0;
+
+int g_pin_value[NUM_DIGITAL_PINS];
+uint8_t g_pin_mode[NUM_DIGITAL_PINS];
+uint32_t g_pin_writes[NUM_DIGITAL_PINS];
+
+int g_wdt_period = -1;
+uint32_t g_wdt_kicks = 0;
+
+uint8_t g_eeprom[E2END + 1];
+uint32_t g_eeprom_writes = 0;
+
+void setPin(uint8_t pin, int v) {
+  if (pin >= NUM_DIGITAL_PINS) return;
+  g_pin_value[pin] = v;
+  g_pin_writes[pin]++;
+}
+
+}  // namespace
+
+
+/*=============================================================================
+  Time / GPIO
+=============================================================================*/
+
+unsigned long millis() { return (unsigned long)(uint32_t)(g_now_us / 1000ULL); }
+unsigned long micros() { return (unsigned long)(uint32_t)g_now_us; }
+
+void delay(unsigned long ms) { g_now_us += (uint64_t)ms * 1000ULL; }
+void delayMicroseconds(unsigned int us) { g_now_us += us; }
+
+void pinMode(uint8_t pin, uint8_t mode) {
+  if (pin < NUM_DIGITAL_PINS) g_pin_mode[pin] = mode;
+}
+
+void digitalWrite(uint8_t pin, uint8_t val) { setPin(pin, val ? HIGH : LOW); }
+
+int digitalRead(uint8_t pin) {
+  return (pin < NUM_DIGITAL_PINS) ? (g_pin_value[pin] ? HIGH : LOW) : LOW;
+}
+
+void analogWrite(uint8_t pin, int val) { setPin(pin, val); }
+
+volatile uint8_t MCUSR = 0;
+
+void wdt_enable(uint8_t period) { g_wdt_period = period; }
+void wdt_disable() { g_wdt_period = -1; }
+void wdt_reset() { g_wdt_kicks++; }
+
+// EEPROM addresses are byte offsets, as on the AVR
+int eeprom_is_ready() { return 1; }
+
+uint8_t eeprom_read_byte(const uint8_t* addr) {
+  const uintptr_t a = (uintptr_t)addr;
+  return (a <= E2END) ? g_eeprom[a] : 0xFF;
+}
+
+void eeprom_write_byte(uint8_t* addr, uint8_t value) {
+  const uintptr_t a = (uintptr_t)addr;
+  if (a > E2END) return;
+  g_eeprom[a] = value;
+  g_eeprom_writes++;
+}
+
+void eeprom_update_byte(uint8_t* addr, uint8_t value) {
+  if (eeprom_read_byte(addr) != value) eeprom_write_byte(addr, value);
+}
+
+void eeprom_read_block(void* dst, const void* src, size_t n) {
+  for (size_t i = 0; i < n; i++) {
+    ((uint8_t*)dst)[i] = eeprom_read_byte((const uint8_t*)src + i);
+  }
+}
+
+void eeprom_update_block(const void* src, void* dst, size_t n) {
+  for (size_t i = 0; i < n; i++) {
+    eeprom_update_byte((uint8_t*)dst + i, ((const uint8_t*)src)[i]);
+  }
+}
+
+namespace hal {
+
+void setMicros(uint64_t us) { g_now_us = us; }
+void advanceMicros(uint64_t us) { g_now_us += us; }
+uint64_t nowMicros() { return g_now_us; }
+
+int pinValue(uint8_t pin) { return (pin < NUM_DIGITAL_PINS) ? g_pin_value[pin] : 0; }
+uint8_t pinModeOf(uint8_t pin) { return (pin < NUM_DIGITAL_PINS) ? g_pin_mode[pin] : 0; }
+uint32_t pinWrites(uint8_t pin) { return (pin < NUM_DIGITAL_PINS) ? g_pin_writes[pin] : 0; }
+
+int wdtPeriod() { return g_wdt_period; }
+uint32_t wdtKicks() { return g_wdt_kicks; }
+
+uint32_t eepromWrites() { return g_eeprom_writes; }
+uint8_t* eepromData() { return g_eeprom; }
+
+void reset() {
+  g_now_us = 0;
+  memset(g_pin_value, 0, sizeof(g_pin_value));
+  memset(g_pin_mode, 0, sizeof(g_pin_mode));
+  memset(g_pin_writes, 0, sizeof(g_pin_writes));
+  g_wdt_period = -1;
+  g_wdt_kicks = 0;
+  memset(g_eeprom, 0xFF, sizeof(g_eeprom));
+  g_eeprom_writes = 0;
+  MCUSR = 0;
+}
+
+}  // namespace hal
+
+
+/*=============================================================================
+  Print
+=============================================================================*/
+
+size_t Print::write(const uint8_t* buffer, size_t size) {
+  size_t n = 0;
+  while (size--) {
+    if (write(*buffer++)) n++;
+    else break;
+  }
+  return n;
+}
+
+size_t Print::print(const __FlashStringHelper* s) {
+  return write(reinterpret_cast<const char*>(s));
+}
+
+size_t Print::print(long v, int base) {
+  if (base == DEC && v < 0) {
+    size_t n = write((uint8_t)'-');
+    return n + print((unsigned long)(-(v + 1)) + 1UL, base);
+  }
+  return print((unsigned long)v, base);
+}
+
+size_t Print::print(unsigned long v, int base) {
+  char buf[8 * sizeof(long) + 1];
+  char* p = &buf[sizeof(buf) - 1];
+  *p = '\0';
+  if (base < 2) base = 10;
+  do {
+    const unsigned long d = v % (unsigned long)base;
+    *--p = (char)(d < 10 ? '0' + d : 'A' + d - 10);
+    v /= (unsigned long)base;
+  } while (v);
+  return write(p);
+}
+
+size_t Print::print(double v, int digits) {
+  char buf[48];
+  snprintf(buf, sizeof(buf), "%.*f", digits, v);
+  return write(buf);
+}
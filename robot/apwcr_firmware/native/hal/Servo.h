@@ -0,0 +1,37 @@
+#pragma once
+
+/*
+  Servo.h   (env:native mock HAL)
+
+  Records attach state and the last written angle / pulse width.
+*/
+
+#include "Arduino.h"
+
+class Servo {
+public:
+  uint8_t attach(int pin) { _pin = pin; _attached = true; return 0; }
+  uint8_t attach(int pin, int, int) { return attach(pin); }
+  void detach() { _attached = false; }
+
+  void write(int value) {
+    _value = value;
+    _us = (value < 200) ? (544 + (value * (2400 - 544)) / 180) : value;
+    _writes++;
+  }
+  void writeMicroseconds(int us) { _us = us; _writes++; }
+
+  int read() const { return _value; }
+  int readMicroseconds() const { return _us; }
+  bool attached() const { return _attached; }
+
+  // Host-side introspection
+  uint32_t writes() const { return _writes; }
+
+private:
+  int _pin = -1;
+  bool _attached = false;
+  int _value = 90;
+  int _us = 1500;
+  uint32_t _writes = 0;
+};
@@ -0,0 +1,23 @@
+#pragma once
+
+/*
+  avr/eeprom.h   (env:native mock HAL)
+
+  A 4 KB array (Mega 2560 size), erased to 0xFF by hal::reset(). Writes
+  complete at once, so eeprom_is_ready() is always true; they are counted
+  (hal::eepromWrites).
+*/
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifndef E2END
+#define E2END 0xFFF
+#endif
+
+int eeprom_is_ready();
+uint8_t eeprom_read_byte(const uint8_t* addr);
+void eeprom_write_byte(uint8_t* addr, uint8_t value);
+void eeprom_update_byte(uint8_t* addr, uint8_t value);
+void eeprom_read_block(void* dst, const void* src, size_t n);
+void eeprom_update_block(const void* src, void* dst, size_t n);
@@ -0,0 +1,22 @@
+#pragma once
+
+/*
+  avr/io.h   (env:native mock HAL)
+
+  Only the MCU status register (reset flags); nothing else is a register
+  on the host.
+*/
+
+#include <stdint.h>
+
+#ifndef _BV
+#define _BV(bit) (1 << (bit))
+#endif
+
+extern volatile uint8_t MCUSR;
+
+#define PORF  0
+#define EXTRF 1
+#define BORF  2
+#define WDRF  3
+#define JTRF  4
@@ -0,0 +1,25 @@
+#pragma once
+
+/*
+  avr/pgmspace.h   (env:native mock HAL)
+
+  Flash and RAM are the same address space on the host.
+*/
+
+#include <stdint.h>
+#include <string.h>
+
+#define PROGMEM
+#define PGM_P const char*
+#define PSTR(s) (s)
+
+#define pgm_read_byte(addr)  (*(const uint8_t*)(addr))
+#define pgm_read_word(addr)  (*(const uint16_t*)(addr))
+#define pgm_read_dword(addr) (*(const uint32_t*)(addr))
+#define pgm_read_float(addr) (*(const float*)(addr))
+#define pgm_read_ptr(addr)   (*(void* const*)(addr))
+
+#define strlen_P  strlen
+#define strcmp_P  strcmp
+#define strncpy_P strncpy
+#define memcpy_P  memcpy
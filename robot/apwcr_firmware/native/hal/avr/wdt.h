@@ -0,0 +1,23 @@
+#pragma once
+
+/*
+  avr/wdt.h   (env:native mock HAL)
+
+  wdt_enable / wdt_reset are recorded (hal::wdtPeriod, hal::wdtKicks);
+  nothing ever resets.
+*/
+
+#include <stdint.h>
+
+#define WDTO_15MS  0
+#define WDTO_30MS  1
+#define WDTO_60MS  2
+#define WDTO_120MS 3
+#define WDTO_250MS 4
+#define WDTO_500MS 5
+#define WDTO_1S    6
+#define WDTO_2S    7
+
+void wdt_enable(uint8_t period);
+void wdt_disable();
+void wdt_reset();
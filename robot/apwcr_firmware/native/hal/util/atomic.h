@@ -0,0 +1,11 @@
+#pragma once
+
+/*
+  util/atomic.h   (env:native mock HAL)
+
+  The host build has no interrupts; the blocks just run once.
+*/
+
+#define ATOMIC_RESTORESTATE
+#define ATOMIC_FORCEON
+#define ATOMIC_BLOCK(type) for (int hal_atomic_once_ = 1; hal_atomic_once_; hal_atomic_once_ = 0)
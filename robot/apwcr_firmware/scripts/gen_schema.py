@@ -0,0 +1,219 @@
+"""
+scripts/gen_schema.py
+
+Python mirror of the binary wire schema: reads src/comms/Schema.h (the
+PWC_PKT_* layouts and PWC_VAL_* group values, see its header) and writes
+pwc_robot/comms/schema.py with each layout's struct format, size and
+field offsets (nested layouts flattened to dotted names) and each group's
+value names. binary_protocol.py / protocol.py take their formats and keys
+from there, so a schema change reaches the host without hand edits.
+
+Array lengths resolve from the constexpr integer constants in Params.h,
+Messages.h and Schema.h.
+
+PlatformIO (platformio.ini, every env): regenerates before the build
+    extra_scripts = pre:scripts/gen_schema.py
+
+Standalone (from apwcr_firmware/):
+    python scripts/gen_schema.py            write schema.py
+    python scripts/gen_schema.py --check    exit 1 if schema.py is stale
+"""
+
+from __future__ import annotations
+
+import os
+import re
+import sys
+from typing import Dict, List, Tuple
+
+FIRMWARE_DIR = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+SCHEMA_H = os.path.join("src", "comms", "Schema.h")
+CONSTANT_SOURCES = (os.path.join("include", "Params.h"), os.path.join("src", "comms", "Messages.h"), SCHEMA_H)
+OUTPUT = os.path.join("..", "python", "pwc_robot", "comms", "schema.py")
+
+_CODES = {
+    "uint8_t": "B", "int8_t": "b", "char": "s",
+    "uint16_t": "H", "int16_t": "h",
+    "uint32_t": "I", "int32_t": "i",
+    "float": "f",
+}
+_SIZES = {"B": 1, "b": 1, "s": 1, "H": 2, "h": 2, "I": 4, "i": 4, "f": 4}
+
+_CONST_RE = re.compile(r"^\s*constexpr\s+\w+\s+(\w+)\s*=\s*(\d+)[uUlL]*\s*;", re.M)
+_DEFINE_RE = re.compile(r"^#define\s+PWC_(PKT|VAL)_(\w+)\((?:F, A|V)\)\s*\\$")
+_FIELD_RE = re.compile(r"^\s*F\((\w+),\s*(\w+)\)")
+_ARRAY_RE = re.compile(r"^\s*A\((\w+),\s*(\w+),\s*(\w+)\)")
+_VALUE_RE = re.compile(r"^\s*V\((\w+),\s*(\w+),")
+
+# (name, offset, struct code(s)) per flattened field
+Field = Tuple[str, int, str]
+
+
+def _read(rel: str, root: str) -> str:
+    with open(os.path.join(root, rel), "r") as f:
+        return f.read()
+
+
+def parse(root: str = FIRMWARE_DIR):
+    """-> (layouts {name: [entry]}, values {group: [(type, name)]}, constants), in file order."""
+    consts: Dict[str, int] = {}
+    for rel in CONSTANT_SOURCES:
+        for name, value in _CONST_RE.findall(_read(rel, root)):
+            consts[name] = int(value)
+
+    layouts: Dict[str, List[tuple]] = {}
+    values: Dict[str, List[Tuple[str, str]]] = {}
+    current = None
+    for line in _read(SCHEMA_H, root).splitlines():
+        m = _DEFINE_RE.match(line)
+        if m:
+            kind, name = m.groups()
+            current = layouts.setdefault(name, []) if kind == "PKT" else values.setdefault(name, [])
+            continue
+        if current is None:
+            continue
+        m = _FIELD_RE.match(line)
+        if m:
+            current.append((m.group(1), m.group(2), 1))
+        m = _ARRAY_RE.match(line)
+        if m:
+            n = m.group(3)
+            if n not in consts and not n.isdigit():
+                raise SystemExit("gen_schema: unknown array length %s" % n)
+            current.append((m.group(1), m.group(2), consts[n] if n in consts else int(n)))
+        m = _VALUE_RE.match(line)
+        if m:
+            current.append((m.group(1), m.group(2)))
+        if not line.rstrip().endswith("\\"):
+            current = None
+    return layouts, values, consts
+
+
+def flatten(layouts, values) -> Dict[str, List[Field]]:
+    """Each layout (and <Group>Values) as flat fields with byte offsets."""
+    flat: Dict[str, List[Field]] = {}
+    for group, entries in values.items():
+        fields, off = [], 0
+        for ctype, name in entries:
+            code = _CODES[ctype]
+            fields.append((name, off, code))
+            off += _SIZES[code]
+        flat[group + "Values"] = fields
+
+    for layout, entries in layouts.items():
+        fields, off = [], 0
+        for ctype, name, n in entries:
+            if ctype in flat:
+                for sub, sub_off, code in flat[ctype]:
+                    fields.append(("%s.%s" % (name, sub), off + sub_off, code))
+                off += size(flat[ctype])
+                continue
+            if ctype not in _CODES:
+                raise SystemExit("gen_schema: %s.%s: unknown type %s" % (layout, name, ctype))
+            code = _CODES[ctype]
+            fields.append((name, off, code if n == 1 else "%d%s" % (n, code)))
+            off += _SIZES[code] * n
+        flat[layout] = fields
+    return flat
+
+
+def size(fields: List[Field]) -> int:
+    if not fields:
+        return 0
+    name, off, code = fields[-1]
+    n = int(code[:-1]) if len(code) > 1 else 1
+    return off + n * _SIZES[code[-1]]
+
+
+def _const_name(camel: str) -> str:
+    return re.sub(r"(?<=[a-z0-9])(?=[A-Z])", "_", camel).upper()
+
+
+def render(root: str = FIRMWARE_DIR) -> str:
+    layouts, values, consts = parse(root)
+    flat = flatten(layouts, values)
+
+    out = [
+        '"""',
+        "Binary wire layouts, generated from the firmware's src/comms/Schema.h by",
+        "apwcr_firmware/scripts/gen_schema.py (runs before every firmware build).",
+        "Do not edit: change Schema.h and regenerate.",
+        "",
+        "Layout.fmt is a struct format for the whole payload (arrays unpack as",
+        "one value per element, char arrays as bytes); fields are flattened,",
+        'nested layouts as dotted names ("pose.x_ft").',
+        '"""',
+        "",
+        "from typing import NamedTuple, Tuple",
+        "",
+        "",
+        "class Field(NamedTuple):",
+        "    name: str",
+        "    offset: int",
+        "    fmt: str",
+        "",
+        "",
+        "class Layout(NamedTuple):",
+        "    name: str",
+        "    fmt: str",
+        "    size: int",
+        "    fields: Tuple[Field, ...]",
+        "",
+        "",
+        "# Schema.h PROTOCOL_VERSION: the firmware sends its own in the hello",
+        "PROTOCOL_VERSION = %d" % consts["PROTOCOL_VERSION"],
+        "",
+        "# Group value names, in wire order (also their JSON keys)",
+    ]
+    for group, entries in values.items():
+        names = ", ".join('"%s"' % name for _, name in entries)
+        out.append("%s_KEYS = (%s%s)" % (_const_name(group), names, "," if len(entries) == 1 else ""))
+    out.append("")
+
+    names = [group + "Values" for group in values] + list(layouts)
+    for name in names:
+        fields = flat[name]
+        out.append("")
+        out.append("%s = Layout(" % _const_name(name))
+        out.append('    "%s", "<%s", %d, (' % (name, "".join(code for _, _, code in fields), size(fields)))
+        for fname, off, code in fields:
+            out.append('        Field("%s", %d, "%s"),' % (fname, off, code))
+        out.append("    ),")
+        out.append(")")
+    out.append("")
+    out.append("LAYOUTS = {l.name: l for l in (")
+    for name in names:
+        out.append("    %s," % _const_name(name))
+    out.append(")}")
+    out.append("")
+    return "\n".join(out)
+
+
+def generate(root: str = FIRMWARE_DIR, check: bool = False) -> bool:
+    """Writes schema.py if it changed. check: only compare. True = up to date."""
+    text = render(root)
+    path = os.path.normpath(os.path.join(root, OUTPUT))
+    try:
+        with open(path, "r") as f:
+            current = f.read()
+    except OSError:
+        current = None
+    if current == text:
+        return True
+    if check:
+        return False
+    with open(path, "w") as f:
+        f.write(text)
+    print("gen_schema: wrote %s" % path)
+    return True
+
+
+try:
+    Import("env")  # noqa: F821 (SCons)
+except NameError:
+    if __name__ == "__main__":
+        check = "--check" in sys.argv[1:]
+        if not generate(check=check):
+            sys.exit("gen_schema: %s is stale, run scripts/gen_schema.py" % OUTPUT)
+else:
+    generate(env.subst("$PROJECT_DIR"))  # noqa: F821
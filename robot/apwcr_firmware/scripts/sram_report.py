@@ -0,0 +1,198 @@
+"""
+scripts/sram_report.py
+
+Static SRAM map for the AVR build: after every link, prints each object
+file's .data / .bss / .noinit bytes (from the linker map), the largest
+static symbols (avr-nm), and what is left for the stack out of the
+board's RAM. The runtime side (how deep the stack really gets) is the
+"mem" block of the perf frame, see src/utils/StackMonitor.h.
+
+The link fails (the .elf is deleted) when the static total leaves less
+than the stack reserve: RAM_BYTES - STACK_RESERVE is the static budget.
+
+PlatformIO (platformio.ini, env:megaatmega2560):
+    extra_scripts = post:scripts/sram_report.py
+    custom_stack_reserve = 1536        ; optional, bytes
+
+Standalone, on an existing build (exit status 1 over budget):
+    python scripts/sram_report.py .pio/build/megaatmega2560/firmware.map [firmware.elf]
+"""
+
+from __future__ import annotations
+
+import os
+import re
+import subprocess
+import sys
+from collections import defaultdict
+from typing import Dict, List, Optional, Tuple
+
+RAM_BYTES_DEFAULT = 8192      # ATmega2560
+STACK_RESERVE_DEFAULT = 1536  # deepest call chain + ISR frames, with margin
+TOP_OBJECTS = 20
+TOP_SYMBOLS = 15
+
+_SECTIONS = (".data", ".bss", ".noinit")
+
+# " .bss.g_link   0x00800a1c   0x5d4 .pio/build/.../main.cpp.o"
+_INPUT_RE = re.compile(r"^ (\S+)\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+(\S.*)$")
+# long input section names wrap: " .bss._ZL6g_linkE" then the numbers alone
+_NAME_RE = re.compile(r"^ (\S+)$")
+_WRAPPED_RE = re.compile(r"^\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+(\S.*)$")
+
+
+def _object_name(path: str) -> str:
+    """'.../libFrameworkArduino.a(HardwareSerial0.cpp.o)' -> 'libFrameworkArduino.a(HardwareSerial0.cpp.o)'"""
+    path = path.strip()
+    m = re.match(r"^(.*\.a)\((.*)\)$", path)
+    if m:
+        return f"{os.path.basename(m.group(1))}({m.group(2)})"
+    return os.path.basename(path)
+
+
+def parse_map(path: str) -> Dict[str, Dict[str, int]]:
+    """Per object: {".data": bytes, ".bss": bytes, ".noinit": bytes}."""
+    usage: Dict[str, Dict[str, int]] = defaultdict(lambda: dict.fromkeys(_SECTIONS, 0))
+    in_map = False
+    section: Optional[str] = None
+    pending = False
+
+    with open(path, "r", errors="replace") as f:
+        for line in f:
+            line = line.rstrip("\n")
+            if not in_map:
+                in_map = line.startswith("Linker script and memory map")
+                continue
+
+            if line and not line[0].isspace():
+                name = line.split()[0]
+                section = name if name in _SECTIONS else None
+                pending = False
+                continue
+            if section is None:
+                continue
+
+            m = _INPUT_RE.match(line)
+            if m and not m.group(1).startswith("*"):
+                size = int(m.group(3), 16)
+                if size:
+                    usage[_object_name(m.group(4))][section] += size
+                pending = False
+                continue
+
+            if _NAME_RE.match(line) and not line.strip().startswith("*"):
+                pending = True
+                continue
+
+            m = _WRAPPED_RE.match(line)
+            if m and pending:
+                size = int(m.group(2), 16)
+                if size:
+                    usage[_object_name(m.group(3))][section] += size
+            pending = False
+
+    return usage
+
+
+def largest_symbols(elf: str, nm: str = "avr-nm") -> List[Tuple[int, str]]:
+    """(bytes, demangled name) of the largest .data / .bss symbols."""
+    try:
+        out = subprocess.run(
+            [nm, "--size-sort", "-S", "-C", elf],
+            check=True, capture_output=True, text=True,
+        ).stdout
+    except (OSError, subprocess.CalledProcessError):
+        return []
+
+    syms = []
+    for line in out.splitlines():
+        parts = line.split(None, 3)
+        if len(parts) == 4 and parts[2] in "bBdD":
+            syms.append((int(parts[1], 16), parts[3]))
+    syms.sort(reverse=True)
+    return syms[:TOP_SYMBOLS]
+
+
+def static_bytes(map_path: str) -> int:
+    """.data + .bss + .noinit over every object."""
+    return sum(sum(u.values()) for u in parse_map(map_path).values())
+
+
+def over_budget(static: int, ram_bytes: int = RAM_BYTES_DEFAULT,
+                stack_reserve: int = STACK_RESERVE_DEFAULT) -> Optional[str]:
+    """Error message if the statics leave less than stack_reserve, else None."""
+    budget = ram_bytes - stack_reserve
+    if static <= budget:
+        return None
+    return ("SRAM: %d bytes static, budget %d (%d RAM - %d stack reserve): %d over"
+            % (static, budget, ram_bytes, stack_reserve, static - budget))
+
+
+def report(map_path: str, elf: Optional[str] = None, nm: str = "avr-nm",
+           ram_bytes: int = RAM_BYTES_DEFAULT,
+           stack_reserve: int = STACK_RESERVE_DEFAULT) -> str:
+    usage = parse_map(map_path)
+    rows = sorted(usage.items(), key=lambda kv: -sum(kv[1].values()))
+    totals = {s: sum(u[s] for u in usage.values()) for s in _SECTIONS}
+    static = sum(totals.values())
+
+    lines = ["", "SRAM (static, from %s)" % os.path.basename(map_path)]
+    lines.append("  %7s %7s %7s %7s  %s" % ("data", "bss", "noinit", "total", "object"))
+    for obj, u in rows[:TOP_OBJECTS]:
+        lines.append("  %7d %7d %7d %7d  %s" % (u[".data"], u[".bss"], u[".noinit"], sum(u.values()), obj))
+    if len(rows) > TOP_OBJECTS:
+        rest = rows[TOP_OBJECTS:]
+        lines.append("  %7s %7s %7s %7d  (%d more objects)" % ("", "", "", sum(sum(u.values()) for _, u in rest), len(rest)))
+    lines.append("  %7d %7d %7d %7d  TOTAL" % (totals[".data"], totals[".bss"], totals[".noinit"], static))
+
+    if elf:
+        syms = largest_symbols(elf, nm)
+        if syms:
+            lines.append("")
+            lines.append("  largest symbols:")
+            for size, name in syms:
+                lines.append("  %7d  %s" % (size, name))
+
+    lines.append("")
+    lines.append("  stack + free: %d of %d bytes (%.0f%% static), reserve %d, %d to spare"
+                 % (ram_bytes - static, ram_bytes, 100.0 * static / ram_bytes,
+                    stack_reserve, ram_bytes - stack_reserve - static))
+    lines.append("")
+    return "\n".join(lines)
+
+
+def _platformio(env) -> None:
+    map_path = os.path.join(env.subst("$BUILD_DIR"), env.subst("${PROGNAME}.map"))
+    env.Append(LINKFLAGS=["-Wl,-Map,%s" % map_path])
+
+    ram_bytes = int(env.BoardConfig().get("upload.maximum_ram_size", RAM_BYTES_DEFAULT))
+    stack_reserve = int(env.GetProjectOption("custom_stack_reserve", STACK_RESERVE_DEFAULT))
+    nm = env.subst("$NM") or "avr-nm"
+
+    def post_link(target, source, env):
+        elf = str(target[0])
+        print(report(map_path, elf, nm, ram_bytes, stack_reserve))
+
+        error = over_budget(static_bytes(map_path), ram_bytes, stack_reserve)
+        if error:
+            sys.stderr.write("error: %s\n" % error)
+            if os.path.exists(elf):
+                os.remove(elf)      # never upload it, relink next build
+            return 1
+        return 0
+
+    env.AddPostAction("$BUILD_DIR/${PROGNAME}.elf", post_link)
+
+
+try:
+    Import("env")  # noqa: F821 (SCons)
+except NameError:
+    if __name__ == "__main__":
+        if len(sys.argv) < 2:
+            sys.exit(__doc__)
+        print(report(sys.argv[1], sys.argv[2] if len(sys.argv) > 2 else None))
+        error = over_budget(static_bytes(sys.argv[1]))
+        if error:
+            sys.exit("error: " + error)
+else:
+    _platformio(env)  # noqa: F821
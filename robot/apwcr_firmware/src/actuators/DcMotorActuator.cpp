@@ -1,5 +1,8 @@
 #include "actuators/DcMotorActuator.h"
 #include <math.h>  // fabsf
+#include <util/atomic.h>
+
+#include "Params.h"
 
 /*
 ===============================================================================
@@ -16,9 +19,43 @@
     duty > 0  -> IN1 HIGH, IN2 PWM
     duty < 0  -> IN1 LOW,  IN2 PWM
     duty = 0  -> coast()
+
+  Direct backend: a 0 or "full" output disconnects the compare unit and
+  drives the pin from its PORT bit, like analogWrite does (fast PWM with
+  OCR = 0 would still leave a one-cycle spike every period). 16-bit OCR
+  writes go through the timers' shared TEMP byte, so they are atomic
+  against the Servo library's Timer5 ISR.
 ===============================================================================
 */
 
+static_assert(MOTOR_PWM_HZ >= 250 && MOTOR_PWM_HZ <= F_CPU / 256,
+              "MOTOR_PWM_HZ: 16-bit TOP at clk/1 must be in 255..65535");
+
+namespace {
+
+constexpr uint16_t PWM_TOP_16 = (uint16_t)(F_CPU / MOTOR_PWM_HZ - 1);
+constexpr uint8_t COM_BITS = 0xFC;     // COMnA/B/C in TCCRnA (all timers)
+
+// Timer3/4 mode 14: fast PWM, TOP = ICRn, clk/1
+void fastPwm16(volatile uint8_t& tccra, volatile uint8_t& tccrb, volatile uint16_t& icr) {
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    tccrb = 0;
+    tccra = (uint8_t)((tccra & COM_BITS) | _BV(WGM31));
+    icr = PWM_TOP_16;
+    tccrb = _BV(WGM33) | _BV(WGM32) | _BV(CS30);
+  }
+}
+
+// Timer2 mode 1: phase-correct 8-bit, clk/1 (F_CPU / 510)
+void phaseCorrect8() {
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    TCCR2A = (uint8_t)((TCCR2A & COM_BITS) | _BV(WGM20));
+    TCCR2B = _BV(CS20);
+  }
+}
+
+}  // namespace
+
 DcMotorActuator::DcMotorActuator(uint8_t pin_dir,
                                  uint8_t pin_pwm,
                                  bool invert,
@@ -42,26 +79,140 @@ void DcMotorActuator::begin() {
   pinMode(_pin_dir, OUTPUT);
   pinMode(_pin_pwm, OUTPUT);
 
+  _dir_port = portOutputRegister(digitalPinToPort(_pin_dir));
+  _dir_mask = digitalPinToBitMask(_pin_dir);
+  _pwm_port = portOutputRegister(digitalPinToPort(_pin_pwm));
+  _pwm_mask = digitalPinToBitMask(_pin_pwm);
+  _dir_level = -1;
+
+  if (!(MOTOR_PWM_DIRECT && attachTimer_())) {
+    _tccra = nullptr;
+    _ocr8 = nullptr;
+    _ocr16 = nullptr;
+    _top = 255;
+  }
+
+  // Same duty limits whatever the resolution
+  _out_min = (uint16_t)(((uint32_t)_pwm_min * _top + 127) / 255);
+  _out_max = (uint16_t)(((uint32_t)_pwm_max * _top + 127) / 255);
+
   // Safe default state at startup
   coast();
 }
 
+bool DcMotorActuator::attachTimer_() {
+  switch (digitalPinToTimer(_pin_pwm)) {
+    case TIMER2A: _ocr8 = &OCR2A; _com_bit = _BV(COM2A1); break;
+    case TIMER2B: _ocr8 = &OCR2B; _com_bit = _BV(COM2B1); break;
+    case TIMER3A: _ocr16 = &OCR3A; _com_bit = _BV(COM3A1); break;
+    case TIMER3B: _ocr16 = &OCR3B; _com_bit = _BV(COM3B1); break;
+    case TIMER3C: _ocr16 = &OCR3C; _com_bit = _BV(COM3C1); break;
+    case TIMER4A: _ocr16 = &OCR4A; _com_bit = _BV(COM4A1); break;
+    case TIMER4B: _ocr16 = &OCR4B; _com_bit = _BV(COM4B1); break;
+    case TIMER4C: _ocr16 = &OCR4C; _com_bit = _BV(COM4C1); break;
+    default: return false;    // Timer0 (millis), 1 (sampler), 5 (Servo)
+  }
+
+  if (_ocr8) {
+    _tccra = &TCCR2A;
+    _top = 255;
+    phaseCorrect8();
+  } else if (_ocr16 == &OCR3A || _ocr16 == &OCR3B || _ocr16 == &OCR3C) {
+    _tccra = &TCCR3A;
+    _top = PWM_TOP_16;
+    fastPwm16(TCCR3A, TCCR3B, ICR3);
+  } else {
+    _tccra = &TCCR4A;
+    _top = PWM_TOP_16;
+    fastPwm16(TCCR4A, TCCR4B, ICR4);
+  }
+  return true;
+}
+
 float DcMotorActuator::clampDuty_(float d) const {
   if (d > 1.0f) return 1.0f;
   if (d < -1.0f) return -1.0f;
   return d;
 }
 
-uint8_t DcMotorActuator::dutyToPwm_(float abs_duty) const {
+uint16_t DcMotorActuator::dutyToPwm_(float abs_duty) const {
   // abs_duty expected in [0, 1]
   if (abs_duty <= 0.0f) return 0;
 
-  const float span = (float)(_pwm_max - _pwm_min);
-  int pwm = (int)(_pwm_min + abs_duty * span + 0.5f);
+  const float span = (float)(_out_max - _out_min);
+  int32_t pwm = (int32_t)(_out_min + abs_duty * span + 0.5f);
 
   if (pwm < 0) pwm = 0;
-  if (pwm > 255) pwm = 255;
-  return (uint8_t)pwm;
+  if (pwm > (int32_t)_top) pwm = _top;
+  return (uint16_t)pwm;
+}
+
+uint16_t DcMotorActuator::dutyToPwm_(Fixed abs_duty) const {
+  // abs_duty expected in [0, 1]
+  if (abs_duty <= fx::ZERO) return 0;
+  if (abs_duty >= fx::ONE) return _out_max;
+
+  // out_min + duty * span, rounded (duty < 1, span < 2^16: fits 32 bits)
+  const uint32_t span = (uint32_t)(_out_max - _out_min);
+  const uint32_t scaled = ((uint32_t)abs_duty.raw() * span + 0x8000UL) >> 16;
+  return (uint16_t)(_out_min + scaled);
+}
+
+void DcMotorActuator::writeDir_(bool high) {
+  const int8_t level = high ? 1 : 0;
+  if (level == _dir_level) return;
+  _dir_level = level;
+
+  // Other pins on this port may be written from ISRs
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    if (high) *_dir_port |= _dir_mask;
+    else *_dir_port &= (uint8_t)~_dir_mask;
+  }
+}
+
+void DcMotorActuator::writePwm_(uint16_t pwm) {
+  if (!_tccra) {
+    analogWrite(_pin_pwm, (int)pwm);
+    return;
+  }
+
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    if (pwm == 0 || pwm >= _top) {
+      *_tccra &= (uint8_t)~_com_bit;
+      if (pwm) *_pwm_port |= _pwm_mask;
+      else *_pwm_port &= (uint8_t)~_pwm_mask;
+    } else {
+      if (_ocr16) *_ocr16 = pwm;
+      else *_ocr8 = (uint8_t)pwm;
+      *_tccra |= _com_bit;
+    }
+  }
+}
+
+void DcMotorActuator::output_(bool forward, uint16_t pwm) {
+  writeDir_(forward);
+  writePwm_(pwm);
+
+  _pwm_cmd = (int)pwm;
+}
+
+void DcMotorActuator::setDuty(Fixed duty) {
+  duty = fx::clamp(duty, -fx::ONE, fx::ONE);
+
+  // Optional polarity inversion for mirrored drivetrain/mechanism sides
+  if (_invert) duty = -duty;
+
+  _duty_cmd_fx = duty;
+  _duty_is_fx = true;
+
+  // Stop command uses coast by default
+  if (duty == fx::ZERO) {
+    coast();
+    return;
+  }
+
+  const bool forward = (duty > fx::ZERO);
+  output_(forward, dutyToPwm_(fx::abs(duty)));
 }
 
 void DcMotorActuator::setDuty(float duty) {
@@ -71,6 +222,7 @@ void DcMotorActuator::setDuty(float duty) {
   if (_invert) duty = -duty;
 
   _duty_cmd = duty;
+  _duty_is_fx = false;
 
   // Stop command uses coast by default
   if (duty == 0.0f) {
@@ -79,27 +231,24 @@ void DcMotorActuator::setDuty(float duty) {
   }
 
   const bool forward = (duty > 0.0f);
-  digitalWrite(_pin_dir, forward ? HIGH : LOW);
-
-  const uint8_t pwm = dutyToPwm_(fabsf(duty));
-  analogWrite(_pin_pwm, pwm);
-
-  _pwm_cmd = (int)pwm;
+  output_(forward, dutyToPwm_(fabsf(duty)));
 }
 
 void DcMotorActuator::coast() {
-  digitalWrite(_pin_dir, LOW);
-  analogWrite(_pin_pwm, 0);
+  writeDir_(false);
+  writePwm_(0);
 
   _duty_cmd = 0.0f;
+  _duty_is_fx = false;
   _pwm_cmd = 0;
 }
 
 void DcMotorActuator::brake() {
-  digitalWrite(_pin_dir, HIGH);
-  analogWrite(_pin_pwm, 255);
+  writeDir_(true);
+  writePwm_(_top);
 
   // Treat as explicit stop mode for debug view
   _duty_cmd = 0.0f;
-  _pwm_cmd = 255;
+  _duty_is_fx = false;
+  _pwm_cmd = _top;
 }
@@ -1,6 +1,8 @@
 #pragma once
 #include <Arduino.h>
 
+#include "utils/Fixed.h"
+
 /*
 ===============================================================================
   DcMotorActuator.h
@@ -20,7 +22,22 @@
     - Convert duty to direction + PWM output
     - Provide explicit coast() and brake() helpers
 
+  PWM backends (picked in begin()):
+    - MOTOR_PWM_DIRECT and a known pin: the pin's timer is reconfigured and
+      setDuty() writes OCRnx directly
+        pin 5 (OC3A), 6 (OC4A): 16-bit fast PWM, TOP = ICRn, MOTOR_PWM_HZ
+                                (20 kHz -> 800 duty steps)
+        pin 9 (OC2B), 10 (OC2A): 8-bit phase-correct, clk/1 (31.4 kHz)
+    - otherwise analogWrite (490/980 Hz, 256 steps)
+    pwm_min / pwm_max stay in 0..255 units and are rescaled to the timer's
+    TOP, so both backends give the same duty for the same command.
+
+  The direction pin is written through its port register, and only when
+  the sign changes.
+
   Notes:
+    - Reconfiguring a timer also changes analogWrite() on its other pins
+      (Timer3: 2, 3; Timer4: 7, 8), which are not used as PWM here.
     - This class does NOT do closed-loop control.
     - PID / speed control should live in DriveController (or other controller).
 ===============================================================================
@@ -62,6 +79,9 @@ public:
   */
   void setDuty(float duty);
 
+  // Same as setDuty(float) with a Q16.16 duty (no float math)
+  void setDuty(Fixed duty);
+
   // Explicit stop modes (DRV8871 behavior)
   void coast();   // IN1=LOW, IN2=LOW
   void brake();   // IN1=HIGH, IN2=HIGH
@@ -70,12 +90,19 @@ public:
   void setInverted(bool invert) { _invert = invert; }
 
   // Debug/introspection
-  float dutyCmd() const { return _duty_cmd; }
-  int pwmCmd() const { return _pwm_cmd; }
+  float dutyCmd() const { return _duty_is_fx ? _duty_cmd_fx.toFloat() : _duty_cmd; }
+  int pwmCmd() const { return _pwm_cmd; }     // 0..pwmTop()
+  uint16_t pwmTop() const { return _top; }
+  bool directPwm() const { return _ocr8 || _ocr16; }
 
 private:
   float clampDuty_(float d) const;
-  uint8_t dutyToPwm_(float abs_duty) const;
+  uint16_t dutyToPwm_(float abs_duty) const;
+  uint16_t dutyToPwm_(Fixed abs_duty) const;
+  void output_(bool forward, uint16_t pwm);
+  void writeDir_(bool high);
+  void writePwm_(uint16_t pwm);
+  bool attachTimer_();
 
   uint8_t _pin_dir;
   uint8_t _pin_pwm;
@@ -85,7 +112,31 @@ private:
   uint8_t _pwm_min;
   uint8_t _pwm_max;
 
+  // Output range in timer counts (pwm_min/max rescaled to _top)
+  uint16_t _top = 255;
+  uint16_t _out_min = 0;
+  uint16_t _out_max = 255;
+
+  // Direct-register backend (null = analogWrite)
+  volatile uint8_t* _tccra = nullptr;
+  uint8_t _com_bit = 0;                  // COMnx1 in TCCRnA
+  volatile uint8_t* _ocr8 = nullptr;     // Timer2
+  volatile uint16_t* _ocr16 = nullptr;   // Timer3/4
+
+  // PWM pin port (forcing it low/high with the timer disconnected)
+  volatile uint8_t* _pwm_port = nullptr;
+  uint8_t _pwm_mask = 0;
+
+  // Direction pin port, and its last written level (-1 = unknown)
+  volatile uint8_t* _dir_port = nullptr;
+  uint8_t _dir_mask = 0;
+  int8_t _dir_level = -1;
+
   // Last command values (for telemetry/debug)
   float _duty_cmd = 0.0f;
   int _pwm_cmd = 0;
+
+  // setDuty(Fixed) keeps its command in fixed point (converted on read)
+  Fixed _duty_cmd_fx;
+  bool _duty_is_fx = false;
 };
@@ -10,7 +10,7 @@ ServoActuator::ServoActuator(uint8_t pin, float min_deg, float max_deg, float ra
   _ramp_dps(ramp_dps < 0.0f ? 0.0f : ramp_dps),
   _deadband_deg(deadband_deg < 0.0f ? 0.0f : deadband_deg),
   _settle_ms(settle_ms),
-  _auto_detach_on_closed(auto_detach_on_closed),
+  _hold(auto_detach_on_closed ? SERVO_HOLD_CLOSED : SERVO_HOLD_ALWAYS),
   _closed_deg(closed_deg) 
   {
     _closed_deg = clampDeg_(_closed_deg);
@@ -19,15 +19,16 @@ ServoActuator::ServoActuator(uint8_t pin, float min_deg, float max_deg, float ra
 void ServoActuator::begin(float initial_deg) {
   const uint32_t now_ms = millis();
 
-  _servo.attach(_pin);
+  _servo.attach(_pin, usLo_(), usHi_());
   _state.is_attached = true;
+  _state.pulse_us = 0;
 
   const float init = clampDeg_(initial_deg);
   _state.current_deg = init;
   _state.target_deg = init;
   _state.last_update_ms = now_ms;
 
-  _servo.write((int)roundDeg_(init));
+  writeDeg_(init);
 
   // Initialize at-target bookkeeping
   _state.at_target_since_ms = now_ms;
@@ -37,11 +38,12 @@ void ServoActuator::begin(float initial_deg) {
 void ServoActuator::attach(uint32_t now_ms) {
   if (_state.is_attached) return;
 
-  _servo.attach(_pin);
+  _servo.attach(_pin, usLo_(), usHi_());
   _state.is_attached = true;
+  _state.pulse_us = 0;   // a fresh attach needs its first pulse
 
   // Immediately output current position to avoid jumps
-  _servo.write((int)roundDeg_(clampDeg_(_state.current_deg)));
+  writeDeg_(_state.current_deg);
 
   // Reset timing so next tick has a sane dt
   _state.last_update_ms = now_ms;
@@ -57,11 +59,29 @@ void ServoActuator::setRampDps(float ramp_dps) {
   _ramp_dps = (ramp_dps < 0.0f) ? 0.0f : ramp_dps;
 }
 
-void ServoActuator::setAutoDetachOnClosed(bool enable, float closed_deg) {
-  _auto_detach_on_closed = enable;
+void ServoActuator::setPulseRange(uint16_t us_at_0, uint16_t us_at_180) {
+  _us_at_0 = us_at_0;
+  _us_per_deg = ((float)us_at_180 - (float)us_at_0) / 180.0f;
+  _us_at_180 = us_at_180;
+}
+
+void ServoActuator::setHoldPolicy(uint8_t hold, float closed_deg) {
+  _hold = (hold <= SERVO_HOLD_SETTLED) ? hold : SERVO_HOLD_ALWAYS;
   _closed_deg = clampDeg_(closed_deg);
 }
 
+void ServoActuator::setAutoDetachOnClosed(bool enable, float closed_deg) {
+  setHoldPolicy(enable ? SERVO_HOLD_CLOSED : SERVO_HOLD_ALWAYS, closed_deg);
+}
+
+void ServoActuator::disturb(uint32_t now_ms) {
+  if (!_state.is_attached) {
+    if (atClosed_()) return;   // resting where it needs no torque
+    attach(now_ms);
+  }
+  if (_state.at_target) _state.at_target_since_ms = now_ms;
+}
+
 void ServoActuator::setSettleParams(float deadband_deg, uint32_t settle_ms) {
   _deadband_deg = (deadband_deg < 0.0f) ? 0.0f : deadband_deg;
   _settle_ms = settle_ms;
@@ -89,7 +109,7 @@ void ServoActuator::setTargetDeg(float deg, uint32_t now_ms) {
   if (_ramp_dps <= 0.0f) {
     _state.current_deg = _state.target_deg;
     if (_state.is_attached) {
-      _servo.write((int)roundDeg_(_state.current_deg));
+      writeDeg_(_state.current_deg);
     }
     _state.last_update_ms = now_ms;
 
@@ -109,49 +129,48 @@ void ServoActuator::tick(uint32_t now_ms) {
   if (dt_ms == 0) return;
 
   // If ramp disabled, we should already have snapped in setTargetDeg()
-  if (_ramp_dps <= 0.0f) {
-    updateAtTargetFlags_(now_ms);
-    return;
-  }
-
-  // Move current toward target by at most (ramp_dps * dt)
-  const float tgt = _state.target_deg;
-  float cur = _state.current_deg;
+  if (_ramp_dps > 0.0f) {
+    // Move current toward target by at most (ramp_dps * dt)
+    const float tgt = _state.target_deg;
+    float cur = _state.current_deg;
+
+    const float err = tgt - cur;
+    const float dt_s = (float)dt_ms / 1000.0f;
+    const float max_step = _ramp_dps * dt_s;
+
+    if (fabsf(err) <= 0.0001f) {
+      // already there
+      cur = tgt;
+    } else if (err > 0.0f) {
+      cur = (cur + max_step >= tgt) ? tgt : (cur + max_step);
+    } else {
+      cur = (cur - max_step <= tgt) ? tgt : (cur - max_step);
+    }
 
-  const float err = tgt - cur;
-  const float dt_s = (float)dt_ms / 1000.0f;
-  const float max_step = _ramp_dps * dt_s;
+    cur = clampDeg_(cur);
+    _state.current_deg = cur;
 
-  if (fabsf(err) <= 0.0001f) {
-    // already there
-    cur = tgt;
-  } else if (err > 0.0f) {
-    cur = (cur + max_step >= tgt) ? tgt : (cur + max_step);
-  } else {
-    cur = (cur - max_step <= tgt) ? tgt : (cur - max_step);
+    writeDeg_(cur);
   }
 
-  cur = clampDeg_(cur);
-  _state.current_deg = cur;
-
-  _servo.write((int)roundDeg_(cur));
-
   // Update at-target bookkeeping and potentially detach
   updateAtTargetFlags_(now_ms);
 
-  if (_auto_detach_on_closed) {
-    // Consider "closed" reached if target is basically the closed setpoint,
-    // and we're at target (within deadband) for settle_ms.
-    const bool target_is_closed = (fabsf(_state.target_deg - _closed_deg) <= _deadband_deg);
+  // Detach once at target (within deadband) for settle_ms, at the closed
+  // setpoint or anywhere, per the hold policy
+  if (_hold == SERVO_HOLD_ALWAYS) return;
+  if (_hold == SERVO_HOLD_CLOSED && !atClosed_()) return;
 
-    if (target_is_closed && _state.at_target) {
-      if (_state.at_target_since_ms != 0 && (now_ms - _state.at_target_since_ms) >= _settle_ms) {
-        detach();
-      }
-    }
+  if (_state.at_target && _state.at_target_since_ms != 0 &&
+      (now_ms - _state.at_target_since_ms) >= _settle_ms) {
+    detach();
   }
 }
 
+bool ServoActuator::atClosed_() const {
+  return fabsf(_state.target_deg - _closed_deg) <= _deadband_deg;
+}
+
 void ServoActuator::updateAtTargetFlags_(uint32_t now_ms) {
   const float err = _state.target_deg - _state.current_deg;
   const bool now_at_target = (fabsf(err) <= _deadband_deg);
@@ -174,8 +193,10 @@ float ServoActuator::clampDeg_(float deg) const {
   return deg;
 }
 
-int ServoActuator::roundDeg_(float deg) const {
-  deg = clampDeg_(deg);
-  return (int)(deg + 0.5f);  // deg is non-negative
+void ServoActuator::writeDeg_(float deg) {
+  // deg is clamped to [min, max] >= 0, so the pulse is too
+  const uint16_t us = (uint16_t)((float)_us_at_0 + clampDeg_(deg) * _us_per_deg + 0.5f);
+  if (us == _state.pulse_us) return;   // the Servo ISR already has it
+  _state.pulse_us = us;
+  _servo.writeMicroseconds(us);
 }
-
@@ -4,14 +4,20 @@
 #include <Arduino.h>
 #include <Servo.h>
 
+#include "Params.h"
+
 /*
   ServoActuator
 
   Purpose:
   - Accept a degree setpoint
   - Smoothly ramp the servo toward the target (non-blocking)
-  - Optionally auto-detach after reaching the CLOSED setpoint and settling
-    (useful when gravity keeps the lid shut)
+  - Hold policy (Params.h, SERVO_HOLD_*): keep pulsing, or detach once
+    settled at the CLOSED setpoint (useful when gravity keeps the lid
+    shut), or once settled anywhere; a new target or disturb() re-attaches
+  - Output with writeMicroseconds on a calibrated pulse line (setPulseRange),
+    so the ramp's fractional degrees reach the servo; a pulse width equal to
+    the last one written is skipped
 
   Usage pattern:
   - Call setTargetDeg(...) only when a new target is desired (new command/state)
@@ -30,6 +36,8 @@ public:
 
     // For settle timing
     uint32_t at_target_since_ms = 0;
+
+    uint16_t pulse_us = 0;   // last pulse written (0 = none yet)
   };
 
   /*
@@ -58,10 +66,23 @@ public:
   // Optional helpers
   void setRampDps(float ramp_dps);
 
-  // Auto-detach logic (commonly enable for lid when gravity holds closed)
+  // Pulse widths (us) at 0 and 180 deg; default 544 / 2400 (Servo library).
+  // Used from the next write; the Servo library's own clamp range follows
+  // on the next attach.
+  void setPulseRange(uint16_t us_at_0, uint16_t us_at_180);
+
+  // hold      : SERVO_HOLD_ALWAYS / _CLOSED / _SETTLED
   // closed_deg: the "closed" setpoint in degrees
+  void setHoldPolicy(uint8_t hold, float closed_deg);
+
+  // Auto-detach at closed_deg only (commonly enable for lid when gravity
+  // holds closed); same as setHoldPolicy(SERVO_HOLD_CLOSED or _ALWAYS)
   void setAutoDetachOnClosed(bool enable, float closed_deg);
 
+  // See ServoActuatorT::disturb: re-attach unless resting at closed_deg,
+  // restart the settle time
+  void disturb(uint32_t now_ms);
+
   // deadband_deg: how close is "at target"
   // settle_ms   : how long it must remain at target before detaching
   void setSettleParams(float deadband_deg, uint32_t settle_ms);
@@ -73,9 +94,12 @@ public:
 
 private:
   float clampDeg_(float deg) const;
-  int roundDeg_(float deg) const;
+  void writeDeg_(float deg);
+  uint16_t usLo_() const { return (_us_at_0 < _us_at_180) ? _us_at_0 : _us_at_180; }
+  uint16_t usHi_() const { return (_us_at_0 < _us_at_180) ? _us_at_180 : _us_at_0; }
 
   void updateAtTargetFlags_(uint32_t now_ms);
+  bool atClosed_() const;
 
   Servo _servo;
   uint8_t _pin;
@@ -87,9 +111,12 @@ private:
 
   float _deadband_deg;
   uint32_t _settle_ms;
-  bool _auto_detach_on_closed;
+  uint8_t _hold;
   float _closed_deg;
 
+  uint16_t _us_at_0 = 544;
+  uint16_t _us_at_180 = 2400;
+  float _us_per_deg = (2400.0f - 544.0f) / 180.0f;
 
   State _state;
 };
@@ -0,0 +1,286 @@
+// src/actuators/ServoActuatorT.h
+#pragma once
+
+#include <Arduino.h>
+#include <Servo.h>
+
+#include "Params.h"
+#include "utils/EventLog.h"
+
+/*
+  ServoActuatorT
+
+  Purpose:
+  - Same behavior as ServoActuator (ramp toward a target, deadband, hold
+    policy), with every parameter a template argument instead of runtime
+    config
+  - Angles are integer tenths of a degree ("ddeg"); the ramp step per tick,
+    clamps and deadband are all folded at compile time
+  - tick() is integer only: no float math, no divide, and the only
+    per-instance storage is the Servo, the State and the ramp position
+  - Output is writeMicroseconds along the calibrated UsAt0..UsAt180 line,
+    so tenth-degree steps reach the servo; an unchanged pulse width is
+    not rewritten
+
+  Ramp timing:
+  - One fixed step per tick, sized for TickHz, instead of scaling by the
+    measured dt. Run tick() from a fixed-rate task at TickHz; an overrun
+    slows the ramp slightly instead of making the servo jump.
+  - The position keeps 8 fractional bits below a tenth of a degree, so slow
+    ramps (e.g. 10 deg/s at 60 Hz = 1.67 ddeg per tick) keep their rate.
+
+  Hold policy (Params.h, SERVO_HOLD_*):
+  - Hold = SERVO_HOLD_CLOSED detaches once settled at ClosedDdeg,
+    SERVO_HOLD_SETTLED once settled anywhere; SettleMs at target first
+  - A new target (or trackDdeg) re-attaches; disturb() re-attaches a servo
+    detached away from ClosedDdeg and holds it for another SettleMs
+
+  Use ServoActuator when the limits/ramp need to change at runtime.
+
+  Usage:
+    using SweepServo = ServoActuatorT<PIN_SERVO_SWEEP,
+                                      servo_t::ddeg(SERVO_MIN_DEG), ...>;
+    SweepServo g_sweep;
+    g_sweep.begin(SWEEP_STOW_DEG);  ...  g_sweep.tick(now_ms);
+*/
+
+namespace servo_t {
+
+// Degrees -> tenths of a degree, rounded (usable in template arguments)
+constexpr int16_t ddeg(float deg) {
+  return (int16_t)(deg * 10.0f + (deg >= 0.0f ? 0.5f : -0.5f));
+}
+
+}  // namespace servo_t
+
+template <uint8_t Pin,
+          int16_t MinDdeg,
+          int16_t MaxDdeg,
+          uint16_t RampDdps,          // 0 = no ramp, jump to target
+          uint16_t DeadbandDdeg,
+          uint32_t SettleMs,
+          uint8_t Hold,               // SERVO_HOLD_*
+          int16_t ClosedDdeg,
+          uint16_t TickHz,
+          uint16_t UsAt0 = 544,       // pulse width at 0 deg
+          uint16_t UsAt180 = 2400>    // pulse width at 180 deg
+class ServoActuatorT {
+public:
+  static_assert(MinDdeg >= 0 && MinDdeg <= MaxDdeg && MaxDdeg <= 1800,
+                "servo limits must be within 0..180 deg");
+  static_assert(TickHz > 0, "TickHz must be > 0");
+  static_assert(Hold <= SERVO_HOLD_SETTLED, "Hold must be a SERVO_HOLD_* policy");
+
+  static constexpr int16_t MIN_DDEG = MinDdeg;
+  static constexpr int16_t MAX_DDEG = MaxDdeg;
+  static constexpr int16_t CLOSED_DDEG =
+      (ClosedDdeg < MinDdeg) ? MinDdeg : (ClosedDdeg > MaxDdeg) ? MaxDdeg : ClosedDdeg;
+
+  // Ramp step per tick in Q8 tenths of a degree, rounded
+  static constexpr int32_t STEP_Q8 =
+      (int32_t)(((uint32_t)RampDdps * 256UL + TickHz / 2) / TickHz);
+  static_assert(RampDdps == 0 || STEP_Q8 > 0, "ramp too slow for TickHz");
+
+  // Pulse width: UsAt0 + ddeg * US_PER_DDEG (Q16), either direction
+  static constexpr int32_t US_PER_DDEG_Q16 =
+      (int32_t)((((int32_t)UsAt180 - (int32_t)UsAt0) * 65536L) / 1800L);
+  static constexpr uint16_t US_LO = (UsAt0 < UsAt180) ? UsAt0 : UsAt180;
+  static constexpr uint16_t US_HI = (UsAt0 < UsAt180) ? UsAt180 : UsAt0;
+
+  struct State {
+    int16_t target_ddeg = 900;
+    int16_t current_ddeg = 900;
+    bool  is_attached = false;
+
+    bool  at_target = true;
+    uint32_t last_update_ms = 0;
+
+    // For settle timing
+    uint32_t at_target_since_ms = 0;
+
+    uint16_t pulse_us = 0;           // last pulse written (0 = none yet)
+
+    float targetDeg() const { return (float)target_ddeg * 0.1f; }
+    float currentDeg() const { return (float)current_ddeg * 0.1f; }
+  };
+
+  // Attach and initialize to initial_deg (clamped). Records timestamps.
+  void begin(float initial_deg) { beginDdeg(servo_t::ddeg(initial_deg)); }
+
+  void beginDdeg(int16_t initial_ddeg) {
+    const uint32_t now_ms = millis();
+
+    _servo.attach(Pin, US_LO, US_HI);
+    _state.is_attached = true;
+    _state.pulse_us = 0;
+    _tracking = false;
+
+    const int16_t init = clamp_(initial_ddeg);
+    _state.current_ddeg = init;
+    _state.target_ddeg = init;
+    _pos_q8 = (int32_t)init << 8;
+    _state.last_update_ms = now_ms;
+
+    write_();
+
+    _state.at_target_since_ms = now_ms;
+    updateAtTargetFlags_(now_ms);
+  }
+
+  // Attach (if detached) and immediately output current position.
+  void attach(uint32_t now_ms) {
+    if (_state.is_attached) return;
+
+    _servo.attach(Pin, US_LO, US_HI);
+    _state.is_attached = true;
+    _state.pulse_us = 0;             // a fresh attach needs its first pulse
+    write_();
+    _state.last_update_ms = now_ms;
+    logEvent(now_ms, EventId::SERVO_ATTACH, Pin, _state.current_ddeg);
+  }
+
+  // Detach (stop PWM pulses). Servo will not hold torque.
+  void detach() {
+    if (!_state.is_attached) return;
+    _servo.detach();
+    _state.is_attached = false;
+  }
+
+  bool isAttached() const { return _state.is_attached; }
+
+  /*
+    Something may have pushed the servo (the chassis moving): re-attach if
+    the policy let it go away from ClosedDdeg, output the last position and
+    restart the settle time. Call it as often as the disturbance lasts.
+  */
+  void disturb(uint32_t now_ms) {
+    if (!_state.is_attached) {
+      if (atClosed_()) return;
+      attach(now_ms);
+    }
+    if (_state.at_target) _state.at_target_since_ms = now_ms;
+  }
+
+  // Set a new desired target (clamped). Does not block.
+  void setTargetDeg(float deg, uint32_t now_ms) { setTargetDdeg(servo_t::ddeg(deg), now_ms); }
+
+  void setTargetDdeg(int16_t target_ddeg, uint32_t now_ms) {
+    const int16_t new_target = clamp_(target_ddeg);
+    _tracking = false;
+    if (new_target == _state.target_ddeg) return;
+
+    _state.target_ddeg = new_target;
+
+    // If we previously auto-detached, motion needs the servo back
+    attach(now_ms);
+
+    _state.at_target_since_ms = 0;
+    _state.at_target = false;
+
+    if (RampDdps == 0) {
+      _state.current_ddeg = new_target;
+      _pos_q8 = (int32_t)new_target << 8;
+      write_();
+      _state.last_update_ms = now_ms;
+
+      _state.at_target_since_ms = now_ms;
+      updateAtTargetFlags_(now_ms);
+    }
+  }
+
+  /*
+    External trajectory (e.g. MotionProfile): output ddeg now, no ramp.
+    final_ddeg is where the trajectory ends; it becomes the target, so
+    at_target / auto-detach keep their meaning. tick() stops ramping until
+    the next setTargetDdeg().
+  */
+  void trackDdeg(int16_t ddeg, int16_t final_ddeg, uint32_t now_ms) {
+    attach(now_ms);
+    _tracking = true;
+
+    const int16_t tgt = clamp_(final_ddeg);
+    if (tgt != _state.target_ddeg) {
+      _state.target_ddeg = tgt;
+      _state.at_target_since_ms = 0;
+      _state.at_target = false;
+    }
+
+    _state.current_ddeg = clamp_(ddeg);
+    _pos_q8 = (int32_t)_state.current_ddeg << 8;
+    write_();
+  }
+
+  // Call at TickHz (fixed-rate task)
+  void tick(uint32_t now_ms) {
+    if (!_state.is_attached) return;
+
+    if (now_ms == _state.last_update_ms) return;
+    _state.last_update_ms = now_ms;
+
+    if (RampDdps != 0 && !_tracking) {
+      const int32_t tgt_q8 = (int32_t)_state.target_ddeg << 8;
+      const int32_t err = tgt_q8 - _pos_q8;
+
+      if (err > STEP_Q8) _pos_q8 += STEP_Q8;
+      else if (err < -STEP_Q8) _pos_q8 -= STEP_Q8;
+      else _pos_q8 = tgt_q8;
+
+      // Round to the nearest tenth (the position is never negative)
+      const int16_t cur = (int16_t)((_pos_q8 + 128) >> 8);
+      if (cur != _state.current_ddeg) {
+        _state.current_ddeg = cur;
+        write_();
+      }
+    }
+
+    updateAtTargetFlags_(now_ms);
+
+    if (Hold != SERVO_HOLD_ALWAYS && (Hold == SERVO_HOLD_SETTLED || atClosed_()) &&
+        _state.at_target && _state.at_target_since_ms != 0 &&
+        (now_ms - _state.at_target_since_ms) >= SettleMs) {
+      detach();
+      logEvent(now_ms, EventId::SERVO_DETACH, Pin, _state.current_ddeg);
+    }
+  }
+
+  const State& getState() const { return _state; }
+
+private:
+  static int16_t clamp_(int16_t v) {
+    if (v < MIN_DDEG) return MIN_DDEG;
+    if (v > MAX_DDEG) return MAX_DDEG;
+    return v;
+  }
+
+  bool atClosed_() const { return absDiff_(_state.target_ddeg, CLOSED_DDEG) <= DeadbandDdeg; }
+
+  static uint16_t absDiff_(int16_t a, int16_t b) {
+    return (uint16_t)((a > b) ? (a - b) : (b - a));
+  }
+
+  static uint16_t pulseUs_(int16_t ddeg) {
+    return (uint16_t)((int32_t)UsAt0 + (((int32_t)ddeg * US_PER_DDEG_Q16 + 0x8000L) >> 16));
+  }
+
+  void write_() {
+    const uint16_t us = pulseUs_(_state.current_ddeg);
+    if (us == _state.pulse_us) return;
+    _state.pulse_us = us;
+    _servo.writeMicroseconds(us);
+  }
+
+  void updateAtTargetFlags_(uint32_t now_ms) {
+    if (absDiff_(_state.target_ddeg, _state.current_ddeg) <= DeadbandDdeg) {
+      if (!_state.at_target) _state.at_target_since_ms = now_ms;
+      _state.at_target = true;
+    } else {
+      _state.at_target = false;
+      _state.at_target_since_ms = 0;
+    }
+  }
+
+  Servo _servo;
+  State _state;
+  int32_t _pos_q8 = (int32_t)900 << 8;
+  bool _tracking = false;
+};
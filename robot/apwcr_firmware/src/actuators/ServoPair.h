@@ -0,0 +1,215 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "Pins.h"
+#include "Params.h"
+#include "actuators/ServoActuatorT.h"
+#include "control/MotionProfile.h"
+
+/*
+===============================================================================
+  ServoPair.h
+===============================================================================
+
+  PURPOSE
+  -------
+  The lid and sweep servos as one unit: how a command's servo targets
+  become motion (formerly main.cpp's commandServos / taskServo), kept out
+  of main.cpp so the native replay harness runs the same code.
+
+    - command(): new targets, either may be absent. With
+      ENABLE_MOTION_PROFILES the servos that change get one synchronized,
+      accel-limited move (both arrive together); an axis already in the
+      move keeps going to its current target. Otherwise each servo ramps
+      on its own.
+    - tick(): samples the profile into both servos (trackDdeg), then ticks
+      them. Run it at SERVO_UPDATE_HZ.
+    - disturb(): the chassis is moving; a servo the hold policy released
+      away from its closed setpoint re-attaches and holds (Params.h,
+      SERVO_HOLD_*)
+    - stats(): attached servos and how much of the window the Servo
+      library's timer ran, for the perf report: its ISR share is the run
+      share times the per-frame cost (an estimate: SERVO_ISR_US)
+
+  Timer5 with no servo attached: the AVR Servo library never stops it
+  (its finISR() is empty outside Wiring), so a detached pair would still
+  take ISR_PER_FRAME interrupts a frame. tick() clears the compare
+  interrupt (OCIE5A) once the last servo detaches; the next attach()
+  finds no channel active and re-inits the timer, interrupt included.
+
+  Targets are clamped first, so a target that clamps to the current one is
+  no change and doesn't restart a move.
+
+  LidServo / SweepServo (below) are the robot's two servo types, shared by
+  main.cpp and the replay harness.
+
+  USAGE
+  -----
+    ServoPair<LidServo, SweepServo> g_servos(g_lid_servo, g_sweep_servo);
+    g_servos.command(true, 90.0f, false, 0.0f, lid_dps, sweep_dps, now_ms);
+    servo task:  if (moving) g_servos.disturb(now_ms);  g_servos.tick(now_ms);
+    perf report: g_servos.stats(), then g_servos.resetWindow()
+===============================================================================
+*/
+
+template <class Lid, class Sweep>
+class ServoPair {
+public:
+  enum : uint8_t { AXIS_LID = 0, AXIS_SWEEP = 1, AXES = 2 };
+
+  // Servo library compare interrupts per 20 ms frame while its timer runs:
+  // one per allocated channel (attached or not) plus the frame's tail
+  static constexpr uint8_t ISR_PER_FRAME = AXES + 1;
+
+  struct Stats {
+    uint8_t attached = 0;          // now
+    uint16_t ticks = 0;            // this window
+    uint16_t active_ticks = 0;     // of which with a servo attached
+    uint16_t detaches = 0;         // by the hold policy, since boot
+
+    // Share of the window the timer ran / spent in its ISR (estimate)
+    uint16_t activePermille() const {
+      return ticks ? (uint16_t)(((uint32_t)active_ticks * 1000UL) / ticks) : 0;
+    }
+    uint16_t isrPpm() const {
+      return (uint16_t)(((uint32_t)activePermille() * ISR_PER_FRAME * SERVO_ISR_US * 1000UL) / SERVO_FRAME_US);
+    }
+  };
+
+  ServoPair(Lid& lid, Sweep& sweep) : _lid(lid), _sweep(sweep) {}
+
+  // lid_dps / sweep_dps: profile cruise speeds (the tunable servo ramps)
+  void command(bool lid, float lid_deg, bool sweep, float sweep_deg,
+               float lid_dps, float sweep_dps, uint32_t now_ms) {
+    if (!ENABLE_MOTION_PROFILES) {
+      if (lid) _lid.setTargetDeg(lid_deg, now_ms);
+      if (sweep) _sweep.setTargetDeg(sweep_deg, now_ms);
+      return;
+    }
+
+    const typename Lid::State& ls = _lid.getState();
+    const typename Sweep::State& ss = _sweep.getState();
+
+    // Clamp first so "unchanged" compares what the servo would actually do
+    const int16_t lid_ddeg = constrain(servo_t::ddeg(lid_deg), Lid::MIN_DDEG, Lid::MAX_DDEG);
+    const int16_t sweep_ddeg = constrain(servo_t::ddeg(sweep_deg), Sweep::MIN_DDEG, Sweep::MAX_DDEG);
+
+    uint8_t mask = 0;
+    if (lid && lid_ddeg != ls.target_ddeg) mask |= _BV(AXIS_LID);
+    if (sweep && sweep_ddeg != ss.target_ddeg) mask |= _BV(AXIS_SWEEP);
+    if (!mask) return;
+
+    // Axes already in the move keep going to their current target
+    mask |= _profile.active() ? _mask : 0;
+
+    MotionProfile::AxisMove m[AXES];
+    m[AXIS_LID].from = ls.currentDeg();
+    m[AXIS_LID].to = (mask & _BV(AXIS_LID)) ? (lid ? lid_ddeg : ls.target_ddeg) * 0.1f : m[AXIS_LID].from;
+    m[AXIS_LID].vmax = lid_dps;
+    m[AXIS_LID].amax = LID_SERVO_ACCEL_DPS2;
+
+    m[AXIS_SWEEP].from = ss.currentDeg();
+    m[AXIS_SWEEP].to = (mask & _BV(AXIS_SWEEP)) ? (sweep ? sweep_ddeg : ss.target_ddeg) * 0.1f : m[AXIS_SWEEP].from;
+    m[AXIS_SWEEP].vmax = sweep_dps;
+    m[AXIS_SWEEP].amax = SWEEP_SERVO_ACCEL_DPS2;
+
+    _profile.plan(m, AXES, now_ms);
+    _mask = mask;
+  }
+
+  void tick(uint32_t now_ms) {
+    if (_profile.active()) {
+      float pos[AXES];
+      _profile.sample(now_ms, pos);   // last call lands on the targets
+
+      if (_mask & _BV(AXIS_LID)) {
+        _lid.trackDdeg(servo_t::ddeg(pos[AXIS_LID]), servo_t::ddeg(_profile.target(AXIS_LID)), now_ms);
+      }
+      if (_mask & _BV(AXIS_SWEEP)) {
+        _sweep.trackDdeg(servo_t::ddeg(pos[AXIS_SWEEP]), servo_t::ddeg(_profile.target(AXIS_SWEEP)), now_ms);
+      }
+    }
+
+    const uint8_t before = attached();
+    _lid.tick(now_ms);
+    _sweep.tick(now_ms);
+    const uint8_t after = attached();
+
+    if (before > after) _stats.detaches += before - after;
+    if (before && !after) timerIsrOff_();
+    _stats.attached = after;
+    if (_stats.ticks < 0xFFFF) {
+      _stats.ticks++;
+      if (after) _stats.active_ticks++;
+    }
+  }
+
+  // Chassis moving: re-assert the servos the hold policy released (not at
+  // their closed setpoint) and keep them held while it lasts
+  void disturb(uint32_t now_ms) {
+    _lid.disturb(now_ms);
+    _sweep.disturb(now_ms);
+  }
+
+  uint8_t attached() const { return (uint8_t)(_lid.isAttached() + _sweep.isAttached()); }
+
+  const Stats& stats() const { return _stats; }
+
+  // New perf window (detaches keep counting)
+  void resetWindow() {
+    _stats.ticks = 0;
+    _stats.active_ticks = 0;
+  }
+
+  // No move running and both servos within their deadband
+  bool settled() const {
+    return !_profile.active() && _lid.getState().at_target && _sweep.getState().at_target;
+  }
+
+private:
+  // Servo library's compare interrupt off (what finISR() would do)
+  static void timerIsrOff_() {
+#if defined(TIMSK5)
+    TIMSK5 &= (uint8_t)~_BV(OCIE5A);
+#endif
+  }
+
+  Lid& _lid;
+  Sweep& _sweep;
+
+  MotionProfile _profile;
+  uint8_t _mask = 0;   // bit per AXIS_* that is moving
+
+  Stats _stats;
+};
+
+// The robot's lid and sweep servos (compile-time config: integer ramp, no
+// per-instance settings)
+using LidServo = ServoActuatorT<
+  PIN_SERVO_LID,
+  servo_t::ddeg(SERVO_MIN_DEG),
+  servo_t::ddeg(SERVO_MAX_DEG),
+  servo_t::ddeg(LID_SERVO_RAMP_DPS),
+  servo_t::ddeg(SERVO_DEADBAND_DEG),
+  LID_SERVO_SETTLE_MS,
+  LID_SERVO_HOLD,
+  servo_t::ddeg(LID_CLOSED_DEG),
+  SERVO_UPDATE_HZ,
+  LID_SERVO_US_AT_0,
+  LID_SERVO_US_AT_180
+>;
+
+using SweepServo = ServoActuatorT<
+  PIN_SERVO_SWEEP,
+  servo_t::ddeg(SERVO_MIN_DEG),
+  servo_t::ddeg(SERVO_MAX_DEG),
+  servo_t::ddeg(SWEEP_SERVO_RAMP_DPS),
+  servo_t::ddeg(SERVO_DEADBAND_DEG),
+  SWEEP_SERVO_SETTLE_MS,
+  SWEEP_SERVO_HOLD,
+  servo_t::ddeg(SWEEP_STOW_DEG),
+  SERVO_UPDATE_HZ,
+  SWEEP_SERVO_US_AT_0,
+  SWEEP_SERVO_US_AT_180
+>;
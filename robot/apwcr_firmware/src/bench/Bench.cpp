@@ -0,0 +1,43 @@
+#include "bench/Bench.h"
+
+/*
+===============================================================================
+  Bench.cpp
+===============================================================================
+*/
+
+namespace bench {
+
+namespace {
+
+void pad(Print& out, size_t printed, size_t width) {
+  while (printed < width) {
+    out.write(' ');
+    printed++;
+  }
+}
+
+}  // namespace
+
+void printHeader(Print& out) {
+  out.println(F("kernel                          iters   best_cyc   mean_cyc    best_us"));
+  out.println(F("------------------------------  -----  ---------  ---------  ---------"));
+}
+
+void printRow(Print& out, const __FlashStringHelper* name, const Result& r) {
+  size_t n = out.print(name);
+  pad(out, n, 32);
+
+  n = out.print(r.iters);
+  pad(out, n, 7);
+
+  n = out.print(r.best_cycles);
+  pad(out, n, 11);
+
+  n = out.print(r.mean_cycles);
+  pad(out, n, 11);
+
+  out.println(CycleTimer::cyclesToUs(r.best_cycles), 2);
+}
+
+}  // namespace bench
@@ -0,0 +1,73 @@
+#pragma once
+#include <Arduino.h>
+
+#include "bench/CycleTimer.h"
+
+/*
+===============================================================================
+  Bench.h   (mega_bench env only)
+===============================================================================
+
+  PURPOSE
+  -------
+  Tiny microbenchmark harness: runs a kernel N times, keeps the best and
+  the mean cycles per call, and prints one table row over Serial.
+
+  The best-of-N figure is the one to compare between builds (interrupts
+  such as millis() only ever add time); the mean shows the typical cost.
+===============================================================================
+*/
+
+namespace bench {
+
+struct Result {
+  uint32_t best_cycles = 0;
+  uint32_t mean_cycles = 0;
+  uint16_t iters = 0;
+};
+
+// Prevents the compiler from discarding a computed value.
+template <typename T>
+inline void keep(const T& v) {
+  asm volatile("" : : "g"(&v) : "memory");
+}
+
+template <typename Fn>
+Result run(uint16_t iters, Fn&& fn) {
+  Result r;
+  r.iters = iters;
+  r.best_cycles = 0xFFFFFFFFUL;
+
+  const uint32_t overhead = CycleTimer::overhead();
+  uint32_t total = 0;
+
+  for (uint16_t i = 0; i < iters; i++) {
+    const uint32_t t0 = CycleTimer::now();
+    fn(i);
+    const uint32_t dt = CycleTimer::now() - t0;
+    const uint32_t c = (dt > overhead) ? (dt - overhead) : 0;
+    total += c;
+    if (c < r.best_cycles) r.best_cycles = c;
+  }
+
+  r.mean_cycles = iters ? (total / iters) : 0;
+  return r;
+}
+
+// Print sink that discards output, so encoders are timed without the UART.
+class NullPrint : public Print {
+public:
+  size_t write(uint8_t) override { _bytes++; return 1; }
+  size_t write(const uint8_t*, size_t size) override { _bytes += size; return size; }
+  using Print::write;
+
+  uint32_t bytes() const { return _bytes; }
+
+private:
+  uint32_t _bytes = 0;
+};
+
+void printHeader(Print& out);
+void printRow(Print& out, const __FlashStringHelper* name, const Result& r);
+
+}  // namespace bench
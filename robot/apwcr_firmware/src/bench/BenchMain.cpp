@@ -0,0 +1,242 @@
+/*
+  APWCR Microbenchmark Firmware (env:mega_bench)
+
+  Purpose:
+  Runs a fixed suite of kernels on the Mega, timed in CPU cycles with
+  Timer1 (bench/CycleTimer), and prints a results table over SERIAL_USB.
+  Replaces main.cpp in this env; nothing here is linked into the robot.
+
+  Suites:
+  - Kernels: the per-tick work of the robot loop (telemetry encode,
+    command decode, encoder/servo/motor updates), as a baseline for
+    optimization work
+  - Fixed-point vs float: EncoderSensor::sample, PID::update,
+    DcMotorActuator::setDuty
+*/
+
+#include <Arduino.h>
+
+#include "Pins.h"
+#include "Params.h"
+
+#include "bench/Bench.h"
+#include "bench/CycleTimer.h"
+
+#include "utils/Fixed.h"
+#include "comms/Uart.h"
+#include "comms/Messages.h"
+#include "comms/Protocol.h"
+#include "comms/BinaryProtocol.h"
+#include "sensors/EncoderSensor.h"
+#include "sensors/EncoderSensorFx.h"
+#include "control/PID.h"
+#include "control/PIDFx.h"
+#include "actuators/DcMotorActuator.h"
+#include "actuators/ServoActuator.h"
+#include "actuators/ServoActuatorT.h"
+
+
+/*=============================================================================
+  GLOBALS
+=============================================================================*/
+
+// Float and fixed encoders on different channels
+EncoderSensor g_enc_float(LhsDriveEncoder::channel(), COUNTS_PER_WHEEL_REV);
+EncoderSensorFx g_enc_fixed(RhsDriveEncoder::channel(), WHEEL_REV_PER_COUNT_Q32);
+
+// Motor driver pins are driven, but with the drive unpowered nothing moves
+DcMotorActuator g_motor(PIN_LHS_DRIVE_DIR, PIN_LHS_DRIVE_PWM, false, (uint8_t)PWM_MIN, (uint8_t)PWM_MAX);
+
+constexpr float BENCH_DT_S = 1.0f / DRIVE_UPDATE_HZ;
+
+// Bare counter on the arm pins, to separate ISR/read cost from EncoderSensor math
+QuadratureCounter& g_enc_raw = LhsArmEncoder::counter();
+
+// Ramping servo, same config as the robot's sweep servo
+ServoActuator g_servo(
+  PIN_SERVO_SWEEP,
+  SERVO_MIN_DEG,
+  SERVO_MAX_DEG,
+  SWEEP_SERVO_RAMP_DPS,
+  SERVO_DEADBAND_DEG,
+  SWEEP_SERVO_SETTLE_MS,
+  false,
+  (float)SWEEP_STOW_DEG
+);
+
+// Same servo with compile-time config (integer ramp)
+ServoActuatorT<PIN_SERVO_SWEEP,
+               servo_t::ddeg(SERVO_MIN_DEG), servo_t::ddeg(SERVO_MAX_DEG),
+               servo_t::ddeg(SWEEP_SERVO_RAMP_DPS), servo_t::ddeg(SERVO_DEADBAND_DEG),
+               SWEEP_SERVO_SETTLE_MS, false, servo_t::ddeg(SWEEP_STOW_DEG),
+               SERVO_UPDATE_HZ> g_servo_t;
+
+// Canonical host command (what pwc_robot sends at 20 Hz while driving)
+const char CANONICAL_CMD[] =
+  "{\"type\":\"cmd\",\"seq\":1234,\"host_time_ms\":567890,"
+  "\"drive\":{\"linear\":0.75,\"angular\":-12.5},"
+  "\"mech\":{\"motor_RHS\":null,\"motor_LHS\":{\"mode\":\"POS_DEG\",\"value\":0.0},"
+  "\"servo_LID_deg\":90.0,\"servo_SWEEP_deg\":null}}";
+
+PID g_pid_float(DRIVE_KP, DRIVE_KI, DRIVE_KD, DRIVE_INTEGRAL_LIMIT);
+PIDFx g_pid_fixed(DRIVE_KP, DRIVE_KI, DRIVE_KD, BENCH_DT_S, DRIVE_INTEGRAL_LIMIT);
+
+constexpr uint16_t ITERS = 200;
+
+// Inputs come from volatile storage so nothing is constant-folded
+volatile float g_in_f[4] = { 0.0f, 0.37f, -0.81f, 1.42f };
+volatile int32_t g_in_q[4] = {
+  0, Fixed::fromFloat(0.37f).raw(), Fixed::fromFloat(-0.81f).raw(), Fixed::fromFloat(1.42f).raw()
+};
+
+
+/*=============================================================================
+  SUITES
+=============================================================================*/
+
+static TelemetryFrame benchTelemetry() {
+  TelemetryFrame t;
+  t.arduino_time_ms = 123456;
+  t.ack_seq = 1234;
+  t.wheel.left_rpm = 42.5f;
+  t.wheel.right_rpm = -41.25f;
+  t.mech.servo_LID_deg = 90.0f;
+  t.mech.servo_SWEEP_deg = 15.0f;
+  t.ultrasonic.distance_in = 17.3f;
+  t.ultrasonic.valid = true;
+  return t;
+}
+
+static void suiteKernels(Print& out) {
+  out.println(F("\n# kernels"));
+  bench::printHeader(out);
+
+  const TelemetryFrame tel = benchTelemetry();
+  bench::NullPrint sink;
+
+  bench::printRow(out, F("protocol::encodeTelemetryLine"), bench::run(ITERS, [&](uint16_t) {
+    protocol::encodeTelemetryLine(tel, sink);
+  }));
+
+  bench::printRow(out, F("bin::encodeTelemetryFrame"), bench::run(ITERS, [&](uint16_t) {
+    protocol::bin::encodeTelemetryFrame(tel, sink);
+  }));
+  bench::keep(sink.bytes());
+
+  bool decoded = true;
+  bench::printRow(out, F("protocol::decodeCommandLine"), bench::run(ITERS, [&](uint16_t) {
+    CommandFrame cmd;
+    decoded &= protocol::decodeCommandLine(CANONICAL_CMD, cmd);
+    bench::keep(cmd);
+  }));
+  if (!decoded) out.println(F("  !! canonical command did not decode"));
+
+  g_enc_float.begin();
+  uint32_t t_ms = 1000;
+  bench::printRow(out, F("EncoderSensor::sample"), bench::run(ITERS, [&](uint16_t i) {
+    t_ms += 10 + (i & 1);
+    g_enc_float.sample(t_ms);
+  }));
+  bench::keep(g_enc_float.getState());
+
+  LhsArmEncoder::begin();
+  bench::printRow(out, F("QuadratureCounter::read"), bench::run(ITERS, [](uint16_t) {
+    const int32_t c = g_enc_raw.read();
+    bench::keep(c);
+  }));
+
+  // Edge handler body with the pins still (no step, no micros())
+  bench::printRow(out, F("QuadratureEncoder::edge"), bench::run(ITERS, [](uint16_t) {
+    LhsArmEncoder::edge();
+  }));
+
+  // Retarget every 50 ticks so most ticks are mid-ramp
+  g_servo.begin((float)SWEEP_STOW_DEG);
+  t_ms = 1000;
+  bench::printRow(out, F("ServoActuator::tick"), bench::run(ITERS, [&](uint16_t i) {
+    t_ms += 1000 / SERVO_UPDATE_HZ;
+    if ((i % 50) == 0) g_servo.setTargetDeg((i % 100) ? (float)SERVO_MIN_DEG : (float)SERVO_MAX_DEG, t_ms);
+    g_servo.tick(t_ms);
+  }));
+  g_servo.detach();
+
+  g_servo_t.begin((float)SWEEP_STOW_DEG);
+  t_ms = 1000;
+  bench::printRow(out, F("ServoActuatorT::tick"), bench::run(ITERS, [&](uint16_t i) {
+    t_ms += 1000 / SERVO_UPDATE_HZ;
+    if ((i % 50) == 0) g_servo_t.setTargetDeg((i % 100) ? (float)SERVO_MIN_DEG : (float)SERVO_MAX_DEG, t_ms);
+    g_servo_t.tick(t_ms);
+  }));
+  g_servo_t.detach();
+
+  g_motor.begin();
+  bench::printRow(out, F("DcMotorActuator::setDuty"), bench::run(ITERS, [](uint16_t i) {
+    g_motor.setDuty(g_in_f[1 + (i % 3)]);
+  }));
+  g_motor.coast();
+}
+
+static void suiteFixedVsFloat(Print& out) {
+  out.println(F("\n# fixed-point vs float"));
+  bench::printHeader(out);
+
+  g_enc_float.begin();
+  g_enc_fixed.begin();
+
+  // 10/11 ms steps: what the 100 Hz task sees with millis() granularity
+  uint32_t t_ms = 1000;
+  bench::printRow(out, F("EncoderSensor::sample"), bench::run(ITERS, [&](uint16_t i) {
+    t_ms += 10 + (i & 1);
+    g_enc_float.sample(t_ms);
+  }));
+  bench::keep(g_enc_float.getState());
+
+  t_ms = 1000;
+  bench::printRow(out, F("EncoderSensorFx::sample"), bench::run(ITERS, [&](uint16_t i) {
+    t_ms += 10 + (i & 1);
+    g_enc_fixed.sample(t_ms);
+  }));
+  bench::keep(g_enc_fixed.getState());
+
+  bench::printRow(out, F("PID::update"), bench::run(ITERS, [](uint16_t i) {
+    const float u = g_pid_float.update(g_in_f[1], g_in_f[i & 3], BENCH_DT_S);
+    bench::keep(u);
+  }));
+
+  bench::printRow(out, F("PIDFx::update"), bench::run(ITERS, [](uint16_t i) {
+    const Fixed u = g_pid_fixed.update(Fixed::fromRaw(g_in_q[1]), Fixed::fromRaw(g_in_q[i & 3]));
+    bench::keep(u);
+  }));
+
+  g_motor.begin();
+  bench::printRow(out, F("DcMotorActuator::setDuty(f)"), bench::run(ITERS, [](uint16_t i) {
+    g_motor.setDuty(g_in_f[1 + (i % 3)]);
+  }));
+
+  bench::printRow(out, F("DcMotorActuator::setDuty(fx)"), bench::run(ITERS, [](uint16_t i) {
+    g_motor.setDuty(Fixed::fromRaw(g_in_q[1 + (i % 3)]));
+  }));
+  g_motor.coast();
+}
+
+
+/*=============================================================================
+  SETUP / LOOP
+=============================================================================*/
+
+void setup() {
+  SERIAL_USB.begin(SERIAL_BAUD);
+  CycleTimer::begin();
+
+  SERIAL_USB.println(F("APWCR bench"));
+  SERIAL_USB.print(F("F_CPU=")); SERIAL_USB.print((uint32_t)F_CPU);
+  SERIAL_USB.print(F(" timer_overhead_cyc=")); SERIAL_USB.println(CycleTimer::overhead());
+
+  suiteKernels(SERIAL_USB);
+  suiteFixedVsFloat(SERIAL_USB);
+
+  SERIAL_USB.println(F("\n# done"));
+}
+
+void loop() {
+}
@@ -0,0 +1,64 @@
+#include "bench/CycleTimer.h"
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+/*
+===============================================================================
+  CycleTimer.cpp
+===============================================================================
+*/
+
+namespace {
+
+volatile uint16_t g_overflows = 0;
+uint32_t g_overhead = 0;
+
+}  // namespace
+
+ISR(TIMER1_OVF_vect) {
+  g_overflows++;
+}
+
+namespace CycleTimer {
+
+void begin() {
+  const uint8_t sreg = SREG;
+  cli();
+  TCCR1A = 0;
+  TCCR1B = 0;
+  TCNT1 = 0;
+  TIFR1 = _BV(TOV1);        // clear a stale overflow flag
+  TIMSK1 = _BV(TOIE1);
+  TCCR1B = _BV(CS10);       // clk/1
+  g_overflows = 0;
+  SREG = sreg;
+
+  // Best of several back-to-back reads
+  uint32_t best = 0xFFFFFFFFUL;
+  for (uint8_t i = 0; i < 16; i++) {
+    const uint32_t a = now();
+    const uint32_t b = now();
+    if (b - a < best) best = b - a;
+  }
+  g_overhead = best;
+}
+
+uint32_t now() {
+  const uint8_t sreg = SREG;
+  cli();
+  uint16_t lo = TCNT1;
+  uint16_t hi = g_overflows;
+
+  // Overflow happened but its ISR hasn't run yet
+  if ((TIFR1 & _BV(TOV1)) && lo < 0x8000) hi++;
+  SREG = sreg;
+
+  return ((uint32_t)hi << 16) | lo;
+}
+
+uint32_t overhead() {
+  return g_overhead;
+}
+
+}  // namespace CycleTimer
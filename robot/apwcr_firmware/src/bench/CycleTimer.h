@@ -0,0 +1,40 @@
+#pragma once
+#include <Arduino.h>
+
+/*
+===============================================================================
+  CycleTimer.h   (mega_bench env only)
+===============================================================================
+
+  PURPOSE
+  -------
+  CPU cycle counter for microbenchmarks: Timer1 free-running at clk/1
+  (16 MHz, 62.5 ns per count) with an overflow interrupt extending it to
+  32 bits, so a measurement can span ~268 s.
+
+  Timer1 is otherwise unused by the bench build; the robot firmware does
+  not include this file.
+
+  USAGE
+  -----
+    CycleTimer::begin();
+    const uint32_t t0 = CycleTimer::now();
+    kernel();
+    const uint32_t cycles = CycleTimer::now() - t0 - CycleTimer::overhead();
+===============================================================================
+*/
+
+namespace CycleTimer {
+
+// Starts Timer1 (normal mode, no prescaler) and measures the read overhead.
+void begin();
+
+// Current 32-bit cycle count (safe with interrupts on or off).
+uint32_t now();
+
+// Cycles spent by one back-to-back now() pair; subtract from measurements.
+uint32_t overhead();
+
+constexpr float cyclesToUs(uint32_t cycles) { return (float)cycles / (F_CPU / 1000000.0f); }
+
+}  // namespace CycleTimer
@@ -0,0 +1,858 @@
+#include "comms/BinaryProtocol.h"
+#include <math.h>
+#include <string.h>
+
+#include "Params.h"
+
+/*
+===============================================================================
+  BinaryProtocol.cpp
+===============================================================================
+
+  PURPOSE
+  -------
+  Implements the COBS + CRC16 framed binary protocol.
+
+  Notes:
+  - Encoding builds the packet in a small stack buffer, then COBS-encodes it
+    block by block into the Print (no second frame buffer).
+  - Decoding happens in place inside SerialLink's RX buffer.
+===============================================================================
+*/
+
+static_assert(sizeof(float) == 4, "binary protocol assumes 32-bit floats");
+static_assert(sizeof(protocol::bin::CommandPacket) == 38, "CommandPacket layout changed");
+static_assert(sizeof(protocol::bin::CommandCreditPacket) == 2, "CommandCreditPacket layout changed");
+static_assert(sizeof(protocol::bin::TelemetryPacket) == 66, "TelemetryPacket layout changed");
+static_assert(sizeof(protocol::bin::PerfHeaderPacket) == 32, "PerfHeaderPacket layout changed");
+static_assert(sizeof(protocol::bin::TaskPerfPacket) == 18, "TaskPerfPacket layout changed");
+static_assert(sizeof(protocol::bin::SubscribePacket) == 9, "SubscribePacket layout changed");
+static_assert(sizeof(protocol::bin::WheelPacket) == 40, "WheelPacket layout changed");
+static_assert(sizeof(protocol::bin::UltrasonicPacket) == 26, "UltrasonicPacket layout changed");
+static_assert(sizeof(protocol::bin::MechPacket) == 32, "MechPacket layout changed");
+static_assert(sizeof(protocol::bin::EncoderBatchHeaderPacket) == 15, "EncoderBatchHeaderPacket layout changed");
+static_assert(sizeof(protocol::bin::EncoderStepPacket) == 6, "EncoderStepPacket layout changed");
+static_assert(sizeof(protocol::bin::SonarHeaderPacket) == 2, "SonarHeaderPacket layout changed");
+static_assert(sizeof(protocol::bin::SequencePacket) == 3, "SequencePacket layout changed");
+static_assert(sizeof(protocol::bin::SeqStepPacket) == 5, "SeqStepPacket layout changed");
+static_assert(sizeof(protocol::bin::SeqStatusPacket) == 9, "SeqStatusPacket layout changed");
+static_assert(sizeof(protocol::bin::PingPacket) == 12, "PingPacket layout changed");
+static_assert(sizeof(protocol::bin::PosePacket) == 16, "PosePacket layout changed");
+static_assert(sizeof(protocol::bin::PoseResetPacket) == 12, "PoseResetPacket layout changed");
+static_assert(sizeof(protocol::bin::PongPacket) == 31, "PongPacket layout changed");
+static_assert(sizeof(protocol::bin::LinkStatsPacket) == 72, "LinkStatsPacket layout changed");
+static_assert(sizeof(protocol::bin::ParamPacket) == 30, "ParamPacket layout changed");
+static_assert(sizeof(protocol::bin::ParamReplyPacket) == 40, "ParamReplyPacket layout changed");
+static_assert(sizeof(protocol::bin::TestPacket) == 5, "TestPacket layout changed");
+static_assert(sizeof(protocol::bin::RxCapturePacket) == 5, "RxCapturePacket layout changed");
+static_assert(sizeof(protocol::bin::SysIdHeaderPacket) == 11, "SysIdHeaderPacket layout changed");
+static_assert(sizeof(protocol::bin::HelloPacket) == 43, "HelloPacket layout changed");
+static_assert(sizeof(protocol::bin::LogPacket) == 1, "LogPacket layout changed");
+static_assert(sizeof(protocol::bin::PathPacket) == 10, "PathPacket layout changed");
+static_assert(sizeof(protocol::bin::PathPointPacket) == 8, "PathPointPacket layout changed");
+static_assert(sizeof(protocol::bin::EventLogHeaderPacket) == 4, "EventLogHeaderPacket layout changed");
+static_assert(sizeof(protocol::bin::EventRecordPacket) == sizeof(EventRecord), "EventRecordPacket must mirror EventRecord");
+static_assert(sizeof(protocol::bin::WheelValues) == 8, "WheelValues layout changed");
+static_assert(sizeof(protocol::bin::MechValues) == 16, "MechValues layout changed");
+static_assert(sizeof(protocol::bin::RangeValues) == 8, "RangeValues layout changed");
+static_assert(sizeof(SysIdSample) == 5, "SysIdSample layout changed");
+static_assert(1 + sizeof(protocol::bin::SysIdHeaderPacket) + SYSID_CHUNK_SAMPLES * sizeof(SysIdSample) + 2
+                  <= protocol::bin::MAX_PACKET_BYTES,
+              "SYSID_CHUNK_SAMPLES too large for a frame");
+static_assert(1 + sizeof(protocol::bin::EventLogHeaderPacket) + EVENT_LOG_CHUNK_RECORDS * sizeof(EventRecord) + 2
+                  <= protocol::bin::MAX_PACKET_BYTES,
+              "EVENT_LOG_CHUNK_RECORDS too large for a frame");
+static_assert(1 + sizeof(protocol::bin::SequencePacket) + SEQ_MAX_STEPS * sizeof(protocol::bin::SeqStepPacket) + 2
+                  <= protocol::bin::MAX_PACKET_BYTES,
+              "a full sequence upload must fit the RX frame buffer");
+static_assert(1 + sizeof(protocol::bin::PathPacket) + PATH_MAX_POINTS * sizeof(protocol::bin::PathPointPacket) + 2
+                  <= protocol::bin::MAX_PACKET_BYTES,
+              "a full path upload must fit the RX frame buffer");
+
+
+/*=============================================================================
+  SMALL HELPERS
+=============================================================================*/
+
+static MechMotorMode modeFromWire(uint8_t m) {
+  if (m == (uint8_t)MechMotorMode::POS_DEG) return MechMotorMode::POS_DEG;
+  if (m == (uint8_t)MechMotorMode::DUTY)    return MechMotorMode::DUTY;
+  return MechMotorMode::UNKNOWN;
+}
+
+static uint16_t sat16(uint32_t v) {
+  return (v > 0xFFFFUL) ? (uint16_t)0xFFFF : (uint16_t)v;
+}
+
+static uint8_t confidenceByte(float c) {
+  if (!(c > 0.0f)) return 0;     // also NAN
+  if (c >= 1.0f) return 255;
+  return (uint8_t)(c * 255.0f + 0.5f);
+}
+
+// Non-negative float * scale -> u16, saturating (NAN -> 0xFFFF)
+static uint16_t scaledU16(float v, float scale) {
+  if (!(v >= 0.0f)) return (v < 0.0f) ? 0 : (uint16_t)0xFFFF;
+  const float x = v * scale + 0.5f;
+  return (x >= 65535.0f) ? (uint16_t)0xFFFF : (uint16_t)x;
+}
+
+static protocol::bin::PosePacket posePacket(const PoseState& pose) {
+  protocol::bin::PosePacket p;
+  p.x_ft = pose.x_ft;
+  p.y_ft = pose.y_ft;
+  p.heading_deg = pose.heading_deg;
+  p.sigma_xy_mft = scaledU16(pose.sigma_xy_ft, 1000.0f);
+  p.sigma_heading_cdeg = scaledU16(pose.sigma_heading_deg, 100.0f);
+  return p;
+}
+
+// Packs a SonarArray block at pkt + n. Returns the new length.
+static size_t appendSonarArray(uint8_t* pkt, size_t n, const SonarArray& a) {
+  using namespace protocol::bin;
+
+  const uint8_t count = (a.count < SONAR_MAX_SENSORS) ? a.count : SONAR_MAX_SENSORS;
+  SonarHeaderPacket h;
+  h.count = count;
+  h.valid_mask = a.valid_mask;
+  memcpy(pkt + n, &h, sizeof(h));
+  n += sizeof(h);
+
+  for (uint8_t i = 0; i < count; i++) {
+    uint16_t d = SONAR_NO_TRACK;
+    if (a.valid_mask & (1u << i)) {
+      const float cin = a.distance_in[i] * 100.0f + 0.5f;
+      d = (cin <= 0.0f) ? 0 : (cin >= (float)(SONAR_NO_TRACK - 1)) ? (uint16_t)(SONAR_NO_TRACK - 1) : (uint16_t)cin;
+    }
+    memcpy(pkt + n, &d, sizeof(d));
+    n += sizeof(d);
+  }
+  for (uint8_t i = 0; i < count; i++) {
+    int16_t c = 0;
+    if (a.valid_mask & (1u << i)) {
+      const float dinps = a.closing_inps[i] * 10.0f;
+      c = (dinps >= 32767.0f) ? 32767 : (dinps <= -32767.0f) ? -32767 : (int16_t)lroundf(dinps);
+    }
+    memcpy(pkt + n, &c, sizeof(c));
+    n += sizeof(c);
+  }
+  memcpy(pkt + n, a.confidence, count);
+  return n + count;
+}
+
+// Packs an EncoderBatch at pkt + n (EncoderSampler::peek keeps every step
+// inside the int16/uint16 ranges). Returns the new length.
+static size_t appendEncoderBatch(uint8_t* pkt, size_t n, const EncoderBatch& b) {
+  using namespace protocol::bin;
+
+  const uint8_t count = (b.count < ENCODER_BATCH_MAX) ? b.count : ENCODER_BATCH_MAX;
+  if (count == 0) return n;
+
+  EncoderBatchHeaderPacket h;
+  h.count = count;
+  h.overflows = sat16(b.overflows);
+  h.t0_us = b.samples[0].t_us;
+  for (uint8_t c = 0; c < ENCODER_BATCH_CHANNELS; c++) h.count0[c] = b.samples[0].count[c];
+  memcpy(pkt + n, &h, sizeof(h));
+  n += sizeof(h);
+
+  for (uint8_t i = 1; i < count; i++) {
+    const EncoderSample& prev = b.samples[i - 1];
+    const EncoderSample& cur = b.samples[i];
+
+    EncoderStepPacket st;
+    st.dt_us = (uint16_t)(cur.t_us - prev.t_us);
+    for (uint8_t c = 0; c < ENCODER_BATCH_CHANNELS; c++) {
+      st.dcount[c] = (int16_t)(cur.count[c] - prev.count[c]);
+    }
+    memcpy(pkt + n, &st, sizeof(st));
+    n += sizeof(st);
+  }
+
+  return n;
+}
+
+static uint16_t capHz(uint16_t hz) {
+  return (hz > TELEMETRY_GROUP_MAX_HZ) ? TELEMETRY_GROUP_MAX_HZ : hz;
+}
+
+static void decodeMotor(uint8_t mode, float value, MechMotorCommand& out) {
+  const MechMotorMode m = modeFromWire(mode);
+  if (m == MechMotorMode::UNKNOWN) return;
+  out.mode = m;
+  out.value = isfinite(value) ? value : 0.0f;
+  out.present = true;
+}
+
+
+namespace protocol {
+namespace bin {
+
+/*=============================================================================
+  PRIMITIVES
+=============================================================================*/
+
+uint16_t crc16(const uint8_t* data, size_t len, uint16_t crc) {
+  while (len--) {
+    crc ^= (uint16_t)(*data++) << 8;
+    for (uint8_t i = 0; i < 8; i++) {
+      crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+    }
+  }
+  return crc;
+}
+
+size_t cobsEncode(const uint8_t* in, size_t len, uint8_t* out) {
+  size_t code_idx = 0;
+  size_t w = 1;
+  uint8_t code = 1;
+
+  for (size_t r = 0; r < len; r++) {
+    if (in[r] == 0) {
+      out[code_idx] = code;
+      code_idx = w++;
+      code = 1;
+      continue;
+    }
+
+    out[w++] = in[r];
+    code++;
+
+    if (code == 0xFF) {
+      out[code_idx] = code;
+      code_idx = w++;
+      code = 1;
+    }
+  }
+
+  out[code_idx] = code;
+  return w;
+}
+
+size_t cobsDecode(uint8_t* buf, size_t len) {
+  size_t r = 0;
+  size_t w = 0;
+
+  while (r < len) {
+    const uint8_t code = buf[r++];
+    if (code == 0) return 0;
+
+    for (uint8_t i = 1; i < code; i++) {
+      if (r >= len) return 0;
+      buf[w++] = buf[r++];
+    }
+
+    // A code < 0xFF implies a zero, except at the very end of the frame
+    if (code != 0xFF && r < len) buf[w++] = 0;
+  }
+
+  return w;
+}
+
+/*=============================================================================
+  ENCODE (Arduino -> Laptop)
+=============================================================================*/
+
+// Appends the CRC (pkt must have 2 spare bytes), then COBS-encodes straight
+// into the Print one block (code byte + run) at a time, plus the delimiter.
+// Same bytes as cobsEncode(), without a second frame-sized stack buffer
+// (SerialLink's Print is the RAM TX stage, so small writes are cheap).
+static void writeFrame(uint8_t* pkt, size_t n, Print& out) {
+  const uint16_t crc = crc16(pkt, n);
+  pkt[n++] = (uint8_t)(crc & 0xFF);
+  pkt[n++] = (uint8_t)(crc >> 8);
+
+  size_t start = 0;
+  for (;;) {
+    size_t end = start;
+    while (end < n && pkt[end] != 0 && end - start < 254) end++;
+
+    const size_t run = end - start;
+    out.write((uint8_t)(run + 1));
+    if (run) out.write(pkt + start, run);
+
+    if (run == 254) { start = end; continue; }   // full block, no implied zero
+    if (end >= n) break;
+    start = end + 1;                             // skip the zero
+  }
+
+  out.write((uint8_t)0x00);
+}
+
+void encodeTelemetryFrame(const TelemetryFrame& t, Print& out) {
+  uint8_t pkt[MAX_PACKET_BYTES];
+
+  TelemetryPacket p;
+  p.arduino_time_ms = t.arduino_time_ms;
+  p.tel_seq = t.tel_seq;
+  p.ack_seq = t.ack_seq;
+  p.queue_depth = t.queue_depth;
+  p.queue_free = t.queue_free;
+  p.host_time_us = t.host_time_valid ? t.host_time_us : 0;
+  fill(p.wheel, t);
+  p.pose = posePacket(t.pose);
+  fill(p.mech, t);
+  fill(p.ultrasonic, t);
+  p.ultrasonic_confidence = confidenceByte(t.ultrasonic.confidence);
+  p.flags = t.ultrasonic.valid ? TEL_FLAG_ULTRASONIC_VALID : 0;
+  if (t.ultrasonic.obstacle_stop) p.flags |= TEL_FLAG_OBSTACLE_STOP;
+  if (t.host_time_valid) p.flags |= TEL_FLAG_HOST_TIME;
+
+  const bool batch = t.encoders && t.encoders->count > 0;
+  if (batch) p.flags |= TEL_FLAG_ENCODER_BATCH;
+  if (t.sonar) p.flags |= TEL_FLAG_SONAR_ARRAY;
+
+  size_t n = 0;
+  pkt[n++] = PKT_TELEMETRY;
+  memcpy(pkt + n, &p, sizeof(p));
+  n += sizeof(p);
+
+  if (batch) n = appendEncoderBatch(pkt, n, *t.encoders);
+  if (t.sonar) n = appendSonarArray(pkt, n, *t.sonar);
+
+  if (t.note) {
+    size_t note_len = strlen(t.note);
+    if (note_len > MAX_NOTE_BYTES) note_len = MAX_NOTE_BYTES;
+    memcpy(pkt + n, t.note, note_len);
+    n += note_len;
+  }
+
+  writeFrame(pkt, n, out);
+}
+
+void encodeGroupFrame(TelemetryGroup g, const TelemetryFrame& t, Print& out) {
+  uint8_t pkt[MAX_PACKET_BYTES];
+
+  GroupHeaderPacket h;
+  h.arduino_time_ms = t.arduino_time_ms;
+  h.tel_seq = t.tel_seq;
+  h.ack_seq = t.ack_seq;
+  h.queue_depth = t.queue_depth;
+  h.queue_free = t.queue_free;
+  h.host_time_us = t.host_time_valid ? t.host_time_us : 0;
+
+  size_t n = 1;
+  switch (g) {
+    case TelemetryGroup::WHEEL: {
+      WheelPacket p;
+      p.h = h;
+      fill(p.wheel, t);
+      p.pose = posePacket(t.pose);
+      pkt[0] = PKT_WHEEL;
+      memcpy(pkt + n, &p, sizeof(p));
+      n += sizeof(p);
+      if (t.encoders) n = appendEncoderBatch(pkt, n, *t.encoders);
+      break;
+    }
+
+    case TelemetryGroup::ULTRASONIC: {
+      UltrasonicPacket p;
+      p.h = h;
+      fill(p.range, t);
+      p.confidence = confidenceByte(t.ultrasonic.confidence);
+      p.flags = t.ultrasonic.valid ? TEL_FLAG_ULTRASONIC_VALID : 0;
+      if (t.ultrasonic.obstacle_stop) p.flags |= TEL_FLAG_OBSTACLE_STOP;
+      pkt[0] = PKT_ULTRASONIC;
+      memcpy(pkt + n, &p, sizeof(p));
+      n += sizeof(p);
+      if (t.sonar) n = appendSonarArray(pkt, n, *t.sonar);
+      break;
+    }
+
+    case TelemetryGroup::MECH: {
+      MechPacket p;
+      p.h = h;
+      fill(p.mech, t);
+      pkt[0] = PKT_MECH;
+      memcpy(pkt + n, &p, sizeof(p));
+      n += sizeof(p);
+      break;
+    }
+
+    case TelemetryGroup::NOTE: {
+      pkt[0] = PKT_NOTE;
+      memcpy(pkt + n, &h, sizeof(h));
+      n += sizeof(h);
+      if (t.note) {
+        size_t note_len = strlen(t.note);
+        if (note_len > MAX_NOTE_BYTES) note_len = MAX_NOTE_BYTES;
+        memcpy(pkt + n, t.note, note_len);
+        n += note_len;
+      }
+      break;
+    }
+  }
+
+  writeFrame(pkt, n, out);
+}
+
+void encodePerfFrame(const PerfFrame& p, Print& out) {
+  uint8_t pkt[MAX_PACKET_BYTES];
+
+  const uint8_t count = (p.task_count < PERF_MAX_TASKS) ? p.task_count : PERF_MAX_TASKS;
+
+  PerfHeaderPacket h;
+  h.arduino_time_ms = p.arduino_time_ms;
+  h.window_ms = sat16(p.window_ms);
+  h.loop_count = sat16(p.loop.count);
+  h.loop_min_us = sat16(p.loop.min_us);
+  h.loop_max_us = sat16(p.loop.max_us);
+  h.loop_mean_us = sat16(p.loop.mean_us);
+  h.loop_idle_permille = p.loop.idle_permille;
+  h.mem_static = p.mem.static_bytes;
+  h.mem_stack_peak = p.mem.stack_peak;
+  h.mem_free_min = p.mem.free_min;
+  h.mem_free_now = p.mem.free_now;
+  h.servo_attached = p.servo.attached;
+  h.servo_active_permille = p.servo.active_permille;
+  h.servo_isr_ppm = p.servo.isr_ppm;
+  h.servo_detaches = p.servo.detaches;
+  h.task_count = count;
+
+  size_t n = 0;
+  pkt[n++] = PKT_PERF;
+  memcpy(pkt + n, &h, sizeof(h));
+  n += sizeof(h);
+
+  for (uint8_t i = 0; i < count; i++) {
+    const TaskPerf& tp = p.tasks[i];
+
+    TaskPerfPacket tpk;
+    memset(tpk.name, 0, sizeof(tpk.name));
+    if (tp.name) strncpy_P(tpk.name, (const char*)tp.name, sizeof(tpk.name));
+    tpk.runs = sat16(tp.runs);
+    tpk.overruns = sat16(tp.overruns);
+    tpk.min_us = sat16(tp.min_us);
+    tpk.max_us = sat16(tp.max_us);
+    tpk.mean_us = sat16(tp.mean_us);
+    tpk.p99_us = sat16(tp.p99_us);
+
+    memcpy(pkt + n, &tpk, sizeof(tpk));
+    n += sizeof(tpk);
+  }
+
+  writeFrame(pkt, n, out);
+}
+
+void encodeLinkStatsFrame(const LinkStatsFrame& s, Print& out) {
+  uint8_t pkt[1 + sizeof(LinkStatsPacket) + 2];
+
+  LinkStatsPacket p;
+  p.arduino_time_ms = s.arduino_time_ms;
+  p.window_ms = sat16(s.window_ms);
+  p.frames = s.frames;
+  p.ok = s.ok;
+  p.fail = s.fail;
+  p.overflow = s.overflow;
+  p.max_frame_bytes = s.max_frame_bytes;
+  p.seq_gaps = s.seq_gaps;
+  p.seq_stale = s.seq_stale;
+  p.rx_high_water = s.rx_high_water;
+  p.tel_held = s.tel_held;
+  p.tel_unread_max = s.tel_unread_max;
+  p.parse_count = sat16(s.parse_count);
+  p.parse_min_us = sat16(s.parse_min_us);
+  p.parse_max_us = sat16(s.parse_max_us);
+  p.parse_mean_us = sat16(s.parse_mean_us);
+  p.cmd_count = sat16(s.cmd_count);
+  p.gap_min_ms = sat16(s.gap_min_us / 1000UL);
+  p.gap_max_ms = sat16(s.gap_max_us / 1000UL);
+  p.gap_mean_ms = sat16(s.gap_mean_us / 1000UL);
+  for (uint8_t b = 0; b < LINK_JITTER_BINS; b++) p.jitter_hist[b] = s.jitter_hist[b];
+
+  size_t n = 0;
+  pkt[n++] = PKT_LINK_STATS;
+  memcpy(pkt + n, &p, sizeof(p));
+  n += sizeof(p);
+
+  writeFrame(pkt, n, out);
+}
+
+void encodeSequenceFrame(const SequenceStatus& s, Print& out) {
+  uint8_t pkt[1 + sizeof(SeqStatusPacket) + 2];
+
+  SeqStatusPacket p;
+  p.arduino_time_ms = s.arduino_time_ms;
+  p.id = (uint8_t)s.id;
+  p.state = (uint8_t)s.state;
+  p.step = s.step;
+  p.steps = s.steps;
+  p.timeouts = s.timeouts;
+
+  size_t n = 0;
+  pkt[n++] = PKT_SEQ_STATUS;
+  memcpy(pkt + n, &p, sizeof(p));
+  n += sizeof(p);
+
+  writeFrame(pkt, n, out);
+}
+
+void encodePongFrame(const PongFrame& p, Print& out) {
+  uint8_t pkt[1 + sizeof(PongPacket) + 2];
+
+  PongPacket pk;
+  pk.id = p.id;
+  pk.t1_us = p.t1_us;
+  pk.t2_us = p.t2_us;
+  pk.t3_us = p.t3_us;
+  pk.flags = (p.synced ? PONG_FLAG_SYNCED : 0) | (p.cmd_latency_valid ? PONG_FLAG_CMD_LATENCY : 0);
+  pk.offset_us = p.offset_us;
+  pk.drift_ppm = p.drift_ppm;
+  pk.delay_us = p.delay_us;
+  pk.cmd_latency_us = p.cmd_latency_valid ? p.cmd_latency_us : 0;
+
+  size_t n = 0;
+  pkt[n++] = PKT_PONG;
+  memcpy(pkt + n, &pk, sizeof(pk));
+  n += sizeof(pk);
+
+  writeFrame(pkt, n, out);
+}
+
+void encodeParamFrame(const ParamReply& r, Print& out) {
+  uint8_t pkt[1 + sizeof(ParamReplyPacket) + 2];
+
+  ParamReplyPacket p;
+  p.op = (uint8_t)r.op;
+  p.status = (uint8_t)r.status;
+  p.index = r.index;
+  p.count = r.count;
+  p.value = r.value;
+  p.min = r.min;
+  p.max = r.max;
+  memset(p.name, 0, sizeof(p.name));
+  strncpy(p.name, r.name, sizeof(p.name) - 1);
+
+  size_t n = 0;
+  pkt[n++] = PKT_PARAM_REPLY;
+  memcpy(pkt + n, &p, sizeof(p));
+  n += sizeof(p);
+
+  writeFrame(pkt, n, out);
+}
+
+void encodeHelloFrame(const HelloFrame& h, Print& out) {
+  uint8_t pkt[1 + sizeof(HelloPacket) + 2];
+
+  HelloPacket p;
+  p.arduino_time_ms = h.arduino_time_ms;
+  p.stage = (uint8_t)h.stage;
+  p.fw_version = h.fw_version;
+  p.proto = PROTOCOL_VERSION;
+  p.features = h.features;
+  p.reset_flags = h.reset_flags;
+  p.link_us = h.link_us;
+  p.setup_us = h.setup_us;
+  p.first_tel_us = h.first_tel_us;
+  memset(p.build, 0, sizeof(p.build));
+  strncpy(p.build, h.build, sizeof(p.build));
+
+  size_t n = 0;
+  pkt[n++] = PKT_HELLO;
+  memcpy(pkt + n, &p, sizeof(p));
+  n += sizeof(p);
+
+  writeFrame(pkt, n, out);
+}
+
+void encodeRxCaptureFrame(uint32_t t_us, uint8_t seq, const uint8_t* data, size_t len, Print& out) {
+  uint8_t pkt[1 + sizeof(RxCapturePacket) + RX_CAPTURE_CHUNK_BYTES + 2];
+  if (len > RX_CAPTURE_CHUNK_BYTES) len = RX_CAPTURE_CHUNK_BYTES;
+
+  RxCapturePacket p;
+  p.t_us = t_us;
+  p.seq = seq;
+
+  size_t n = 0;
+  pkt[n++] = PKT_RX_CAPTURE;
+  memcpy(pkt + n, &p, sizeof(p));
+  n += sizeof(p);
+  memcpy(pkt + n, data, len);
+  n += len;
+
+  writeFrame(pkt, n, out);
+}
+
+void encodeSysIdFrame(const SysIdChunk& c, Print& out) {
+  uint8_t pkt[1 + sizeof(SysIdHeaderPacket) + SYSID_CHUNK_SAMPLES * sizeof(SysIdSample) + 2];
+  const uint8_t count = (c.count > SYSID_CHUNK_SAMPLES) ? SYSID_CHUNK_SAMPLES : c.count;
+
+  SysIdHeaderPacket h;
+  h.target = c.target;
+  h.gen = c.gen;
+  h.period_ms = c.period_ms;
+  h.units_per_count = c.units_per_count;
+  h.first = c.first;
+  h.total = c.total;
+
+  size_t n = 0;
+  pkt[n++] = PKT_SYSID;
+  memcpy(pkt + n, &h, sizeof(h));
+  n += sizeof(h);
+  memcpy(pkt + n, c.samples, count * sizeof(SysIdSample));
+  n += count * sizeof(SysIdSample);
+
+  writeFrame(pkt, n, out);
+}
+
+// The records go out as they sit in the ring (EventRecordPacket mirrors it)
+void encodeEventLogFrame(const EventLogChunk& c, Print& out) {
+  uint8_t pkt[1 + sizeof(EventLogHeaderPacket) + EVENT_LOG_CHUNK_RECORDS * sizeof(EventRecord) + 2];
+  const uint8_t count = (c.count > EVENT_LOG_CHUNK_RECORDS) ? EVENT_LOG_CHUNK_RECORDS : c.count;
+
+  EventLogHeaderPacket h;
+  h.first = c.first;
+  h.end = c.end;
+
+  size_t n = 0;
+  pkt[n++] = PKT_EVENT_LOG;
+  memcpy(pkt + n, &h, sizeof(h));
+  n += sizeof(h);
+  memcpy(pkt + n, c.records, count * sizeof(EventRecord));
+  n += count * sizeof(EventRecord);
+
+  writeFrame(pkt, n, out);
+}
+
+/*=============================================================================
+  DECODE (Laptop -> Arduino)
+=============================================================================*/
+
+uint8_t decodeFrame(uint8_t* buf, size_t len, const uint8_t*& payload, size_t& payload_len) {
+  const size_t n = cobsDecode(buf, len);
+  if (n < 3) return 0;   // type + crc at minimum
+
+  const uint16_t rx_crc = (uint16_t)buf[n - 2] | ((uint16_t)buf[n - 1] << 8);
+  if (crc16(buf, n - 2) != rx_crc) return 0;
+
+  payload = buf + 1;
+  payload_len = n - 3;
+  return buf[0];
+}
+
+bool decodeCommandPayload(const uint8_t* payload, size_t len, CommandFrame& out_cmd) {
+  out_cmd = CommandFrame();
+  const bool credit = (len == sizeof(CommandPacket) + sizeof(CommandCreditPacket));
+  if (len != sizeof(CommandPacket) && !credit) return false;
+
+  CommandPacket p;
+  memcpy(&p, payload, sizeof(p));
+
+  if (credit) {
+    CommandCreditPacket c;
+    memcpy(&c, payload + sizeof(p), sizeof(c));
+    out_cmd.tel_ack = c.tel_ack;
+    out_cmd.tel_ack_present = true;
+  }
+
+  out_cmd.seq = p.seq;
+  out_cmd.host_time_ms = p.host_time_ms;
+  out_cmd.at_ms = p.at_ms;
+  out_cmd.at_present = (p.at_ms != COMMAND_AT_NOW);
+
+  out_cmd.drive.linear_ftps = isfinite(p.drive_linear_ftps) ? p.drive_linear_ftps : 0.0f;
+  out_cmd.drive.angular_dps = isfinite(p.drive_angular_dps) ? p.drive_angular_dps : 0.0f;
+
+  decodeMotor(p.motor_RHS_mode, p.motor_RHS_value, out_cmd.mech.motor_RHS);
+  decodeMotor(p.motor_LHS_mode, p.motor_LHS_value, out_cmd.mech.motor_LHS);
+
+  if (isfinite(p.servo_LID_deg)) {
+    out_cmd.mech.servo_LID_deg = p.servo_LID_deg;
+    out_cmd.mech.servo_LID_present = true;
+  }
+
+  if (isfinite(p.servo_SWEEP_deg)) {
+    out_cmd.mech.servo_SWEEP_deg = p.servo_SWEEP_deg;
+    out_cmd.mech.servo_SWEEP_present = true;
+  }
+
+  out_cmd.valid = true;
+  return true;
+}
+
+bool decodeLinkPayload(const uint8_t* payload, size_t len, WireMode& out_mode) {
+  if (len != sizeof(WireModePacket)) return false;
+  if (payload[0] == (uint8_t)WireMode::JSON)   { out_mode = WireMode::JSON;   return true; }
+  if (payload[0] == (uint8_t)WireMode::BINARY) { out_mode = WireMode::BINARY; return true; }
+  return false;
+}
+
+bool decodeSubscribePayload(const uint8_t* payload, size_t len, TelemetrySubscription& out_sub) {
+  if (len != sizeof(SubscribePacket)) return false;
+
+  SubscribePacket p;
+  memcpy(&p, payload, sizeof(p));
+
+  out_sub.telemetry_hz = capHz(p.telemetry_hz);
+  out_sub.wheel_hz = capHz(p.wheel_hz);
+  out_sub.ultrasonic_hz = capHz(p.ultrasonic_hz);
+  out_sub.mech_hz = capHz(p.mech_hz);
+  out_sub.note = (p.note != 0);
+  return true;
+}
+
+bool decodeSequencePayload(const uint8_t* payload, size_t len, SequenceRequest& out_seq) {
+  out_seq = SequenceRequest();
+  if (len < sizeof(SequencePacket)) return false;
+
+  SequencePacket h;
+  memcpy(&h, payload, sizeof(h));
+  const size_t steps_len = len - sizeof(h);
+
+  switch (h.action) {
+    case (uint8_t)SeqAction::ABORT:
+      if (steps_len != 0) return false;
+      out_seq.action = SeqAction::ABORT;
+      return true;
+
+    case (uint8_t)SeqAction::RUN:
+      if (steps_len != 0) return false;
+      if (h.id != (uint8_t)SeqId::PICKUP && h.id != (uint8_t)SeqId::STOW) return false;
+      out_seq.action = SeqAction::RUN;
+      out_seq.id = (SeqId)h.id;
+      return true;
+
+    case (uint8_t)SeqAction::UPLOAD:
+      break;
+
+    default:
+      return false;
+  }
+
+  if (h.step_count == 0 || h.step_count > SEQ_MAX_STEPS) return false;
+  if (steps_len != (size_t)h.step_count * sizeof(SeqStepPacket)) return false;
+
+  const uint8_t* at = payload + sizeof(h);
+  for (uint8_t i = 0; i < h.step_count; i++, at += sizeof(SeqStepPacket)) {
+    SeqStepPacket sp;
+    memcpy(&sp, at, sizeof(sp));
+    if (sp.op == (uint8_t)SeqOp::END || sp.op > (uint8_t)SeqOp::WAIT_TRAVEL) return false;
+
+    out_seq.steps[i].op = sp.op;
+    out_seq.steps[i].arg = sp.arg;
+    out_seq.steps[i].timeout_ms = sp.timeout_ms;
+  }
+
+  out_seq.action = SeqAction::UPLOAD;
+  out_seq.id = SeqId::UPLOAD;
+  out_seq.step_count = h.step_count;
+  return true;
+}
+
+bool decodePathPayload(const uint8_t* payload, size_t len, PathRequest& out_req) {
+  out_req = PathRequest();
+  if (len < sizeof(PathPacket)) return false;
+
+  PathPacket h;
+  memcpy(&h, payload, sizeof(h));
+  const size_t points_len = len - sizeof(h);
+
+  if (h.action == (uint8_t)PathAction::ABORT) {
+    if (points_len != 0) return false;
+    out_req.action = PathAction::ABORT;
+    return true;
+  }
+  if (h.action != (uint8_t)PathAction::RUN) return false;
+
+  if (h.count == 0 || h.count > PATH_MAX_POINTS) return false;
+  if (points_len != (size_t)h.count * sizeof(PathPointPacket)) return false;
+
+  const uint8_t* at = payload + sizeof(h);
+  for (uint8_t i = 0; i < h.count; i++, at += sizeof(PathPointPacket)) {
+    PathPointPacket pp;
+    memcpy(&pp, at, sizeof(pp));
+    if (!isfinite(pp.x_ft) || !isfinite(pp.y_ft)) return false;
+    out_req.points[i].x_ft = pp.x_ft;
+    out_req.points[i].y_ft = pp.y_ft;
+  }
+
+  out_req.action = PathAction::RUN;
+  out_req.count = h.count;
+  out_req.speed_ftps = h.speed_ftps;
+  out_req.lookahead_ft = h.lookahead_ft;
+  return true;
+}
+
+bool decodePosePayload(const uint8_t* payload, size_t len, PoseReset& out_pose) {
+  if (len != sizeof(PoseResetPacket)) return false;
+
+  PoseResetPacket p;
+  memcpy(&p, payload, sizeof(p));
+  if (!isfinite(p.x_ft) || !isfinite(p.y_ft) || !isfinite(p.heading_deg)) return false;
+
+  out_pose.x_ft = p.x_ft;
+  out_pose.y_ft = p.y_ft;
+  out_pose.heading_deg = p.heading_deg;
+  return true;
+}
+
+bool decodeParamPayload(const uint8_t* payload, size_t len, ParamRequest& out_req) {
+  out_req = ParamRequest();
+  if (len != sizeof(ParamPacket)) return false;
+
+  ParamPacket p;
+  memcpy(&p, payload, sizeof(p));
+  if (p.op > (uint8_t)ParamOp::DEFAULTS) return false;
+
+  out_req.op = (ParamOp)p.op;
+  out_req.index = p.index;
+  out_req.value = p.value;
+  memcpy(out_req.name, p.name, sizeof(out_req.name));
+  out_req.name[sizeof(out_req.name) - 1] = '\0';
+  return true;
+}
+
+bool decodeTestPayload(const uint8_t* payload, size_t len, TestRequest& out_req) {
+  out_req = TestRequest();
+  if (len != sizeof(TestPacket)) return false;
+
+  TestPacket p;
+  memcpy(&p, payload, sizeof(p));
+  if (p.op == (uint8_t)TestOp::NONE || p.op > (uint8_t)TestOp::SYSID_ARM) return false;
+
+  out_req.op = (TestOp)p.op;
+  out_req.value = p.value;
+  return true;
+}
+
+bool decodeLogPayload(const uint8_t* payload, size_t len, LogRequest& out_req) {
+  out_req = LogRequest();
+  if (len != sizeof(LogPacket)) return false;
+
+  LogPacket p;
+  memcpy(&p, payload, sizeof(p));
+  if (p.op == (uint8_t)LogOp::NONE || p.op > (uint8_t)LogOp::CLEAR) return false;
+
+  out_req.op = (LogOp)p.op;
+  return true;
+}
+
+bool decodePingPayload(const uint8_t* payload, size_t len, PingRequest& out_ping) {
+  if (len != sizeof(PingPacket)) return false;
+
+  PingPacket p;
+  memcpy(&p, payload, sizeof(p));
+  if (p.id == 0) return false;
+
+  out_ping.id = p.id;
+  out_ping.t1_us = p.t1_us;
+  out_ping.prev_id = p.prev_id;
+  out_ping.prev_t4_us = p.prev_t4_us;
+  return true;
+}
+
+bool decodeRxCapturePayload(const uint8_t* payload, size_t len,
+                            uint32_t& t_us, uint8_t& seq, const uint8_t*& data, size_t& data_len) {
+  if (len < sizeof(RxCapturePacket) || len > sizeof(RxCapturePacket) + RX_CAPTURE_CHUNK_BYTES) return false;
+
+  RxCapturePacket p;
+  memcpy(&p, payload, sizeof(p));
+  t_us = p.t_us;
+  seq = p.seq;
+  data = payload + sizeof(p);
+  data_len = len - sizeof(p);
+  return true;
+}
+
+}  // namespace bin
+}  // namespace protocol
@@ -0,0 +1,228 @@
+#pragma once
+#include <Arduino.h>
+
+#include "comms/Messages.h"
+#include "comms/Schema.h"
+
+/*
+===============================================================================
+  BinaryProtocol.h
+===============================================================================
+
+  PURPOSE
+  -------
+  Compact binary alternative to the newline JSON protocol.
+
+  Wire format:
+    - Packet  = [type u8][payload ...][crc16 u16, little-endian]
+    - CRC16   = CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF) over type+payload
+    - Framing = COBS-encoded packet followed by a single 0x00 delimiter
+
+  Payloads are fixed-layout, little-endian, packed structs (AVR and the Pi are
+  both little-endian, so the structs are copied straight to/from the wire),
+  defined once in comms/Schema.h. Optional floats use NAN exactly like the
+  JSON path uses null.
+
+  Matches Python:
+    pwc_robot/comms/binary_protocol.py (layouts from the generated schema.py)
+===============================================================================
+*/
+
+namespace protocol {
+namespace bin {
+
+/*=============================================================================
+  PACKET TYPES
+=============================================================================*/
+
+// Laptop -> Arduino
+constexpr uint8_t PKT_CMD  = 0x01;
+constexpr uint8_t PKT_LINK = 0x02;   // payload: WireModePacket
+constexpr uint8_t PKT_SUBSCRIBE = 0x03;   // payload: SubscribePacket
+constexpr uint8_t PKT_SEQUENCE = 0x04;    // SequencePacket + step_count * SeqStepPacket
+constexpr uint8_t PKT_PING = 0x05;        // payload: PingPacket
+constexpr uint8_t PKT_POSE = 0x06;        // payload: PoseResetPacket
+constexpr uint8_t PKT_PARAM = 0x07;       // payload: ParamPacket
+constexpr uint8_t PKT_TEST  = 0x08;       // payload: TestPacket
+constexpr uint8_t PKT_LOG   = 0x09;       // payload: LogPacket
+constexpr uint8_t PKT_PATH  = 0x0A;       // PathPacket + count * PathPointPacket
+
+// Arduino -> Laptop
+constexpr uint8_t PKT_TELEMETRY = 0x81;
+constexpr uint8_t PKT_PERF      = 0x82;   // PerfHeaderPacket + task_count * TaskPerfPacket
+
+// Per-group telemetry (after a subscribe), see TelemetryGroup
+constexpr uint8_t PKT_WHEEL      = 0x83;   // WheelPacket
+constexpr uint8_t PKT_ULTRASONIC = 0x84;   // UltrasonicPacket
+constexpr uint8_t PKT_MECH       = 0x85;   // MechPacket
+constexpr uint8_t PKT_NOTE       = 0x86;   // GroupHeaderPacket + raw note bytes
+
+constexpr uint8_t PKT_SEQ_STATUS = 0x87;   // SeqStatusPacket, sent on change
+constexpr uint8_t PKT_PONG       = 0x88;   // PongPacket, one per PKT_PING
+constexpr uint8_t PKT_LINK_STATS = 0x89;   // LinkStatsPacket, after each PKT_PERF
+constexpr uint8_t PKT_PARAM_REPLY = 0x8A;  // ParamReplyPacket, one per PKT_PARAM
+
+// RX capture records (ENABLE_RX_CAPTURE, on SERIAL_AUX; see comms/RxRecorder.h)
+constexpr uint8_t PKT_RX_CAPTURE = 0x8B;   // RxCapturePacket + the raw bytes taken
+
+// System identification capture (control/SysId), streamed during a run
+constexpr uint8_t PKT_SYSID = 0x8C;        // SysIdHeaderPacket + count * SysIdSample
+
+// Boot hello, sent by setup() as soon as the link is up (and once more
+// with the boot timing, see HelloFrame)
+constexpr uint8_t PKT_HELLO = 0x8D;        // HelloPacket
+
+// Event log dump (utils/EventLog), streamed after a PKT_LOG dump request
+constexpr uint8_t PKT_EVENT_LOG = 0x8E;    // EventLogHeaderPacket + count * EventRecordPacket
+
+/*=============================================================================
+  PAYLOAD LAYOUTS
+=============================================================================*/
+
+// The packed structs (CommandPacket, TelemetryPacket, ...) and the group
+// value structs (WheelValues, MechValues, RangeValues) are expanded from
+// comms/Schema.h; the constants that go with them are here.
+
+constexpr uint32_t COMMAND_AT_NOW = 0;   // CommandPacket.at_ms: apply on arrival, else queue
+
+// Telemetry flag bits
+constexpr uint8_t TEL_FLAG_ULTRASONIC_VALID = 0x01;
+constexpr uint8_t TEL_FLAG_ENCODER_BATCH    = 0x02;   // EncoderBatch follows the fixed payload
+constexpr uint8_t TEL_FLAG_HOST_TIME        = 0x04;   // host_time_us is valid
+constexpr uint8_t TEL_FLAG_SONAR_ARRAY      = 0x08;   // SonarArray block follows
+constexpr uint8_t TEL_FLAG_OBSTACLE_STOP    = 0x10;   // ObstacleGuard holding forward speed at 0
+
+// Pong flag bits
+constexpr uint8_t PONG_FLAG_SYNCED      = 0x01;
+constexpr uint8_t PONG_FLAG_CMD_LATENCY = 0x02;   // cmd_latency_us is valid
+
+constexpr size_t ENCODER_BATCH_MAX_BYTES =
+    sizeof(EncoderBatchHeaderPacket) + (ENCODER_BATCH_MAX - 1) * sizeof(EncoderStepPacket);
+
+constexpr uint16_t SONAR_NO_TRACK = 0xFFFF;
+constexpr size_t SONAR_BLOCK_MAX_BYTES = sizeof(SonarHeaderPacket) + SONAR_MAX_SENSORS * 5;
+
+// Longest note carried in a binary telemetry packet
+constexpr size_t MAX_NOTE_BYTES = 96;
+
+constexpr size_t TELEMETRY_PAYLOAD_MAX =
+    sizeof(TelemetryPacket) + ENCODER_BATCH_MAX_BYTES + SONAR_BLOCK_MAX_BYTES + MAX_NOTE_BYTES;
+constexpr size_t PERF_PAYLOAD_MAX = sizeof(PerfHeaderPacket) + PERF_MAX_TASKS * sizeof(TaskPerfPacket);
+
+// Largest packet (type + payload + crc) either direction
+constexpr size_t MAX_PACKET_BYTES =
+    1 + ((TELEMETRY_PAYLOAD_MAX > PERF_PAYLOAD_MAX) ? TELEMETRY_PAYLOAD_MAX : PERF_PAYLOAD_MAX) + 2;
+
+// Worst-case COBS size for MAX_PACKET_BYTES (one overhead byte per 254)
+constexpr size_t MAX_FRAME_BYTES = MAX_PACKET_BYTES + (MAX_PACKET_BYTES / 254) + 1;
+
+/*=============================================================================
+  PRIMITIVES
+=============================================================================*/
+
+uint16_t crc16(const uint8_t* data, size_t len, uint16_t crc = 0xFFFF);
+
+/*
+  COBS-encodes len bytes from in into out (out must hold len + len/254 + 1).
+  Returns the encoded length (without the 0x00 delimiter).
+*/
+size_t cobsEncode(const uint8_t* in, size_t len, uint8_t* out);
+
+/*
+  COBS-decodes in place. Returns the decoded length, or 0 on malformed input.
+*/
+size_t cobsDecode(uint8_t* buf, size_t len);
+
+/*=============================================================================
+  ENCODE (Arduino -> Laptop)
+=============================================================================*/
+
+// Writes one framed telemetry packet (includes trailing 0x00)
+void encodeTelemetryFrame(const TelemetryFrame& t, Print& out);
+
+// Writes one framed per-group packet (PKT_WHEEL..PKT_NOTE, includes trailing 0x00)
+void encodeGroupFrame(TelemetryGroup g, const TelemetryFrame& t, Print& out);
+
+// Writes one framed perf diagnostics packet (includes trailing 0x00)
+void encodePerfFrame(const PerfFrame& p, Print& out);
+
+// Writes one framed link quality packet (includes trailing 0x00)
+void encodeLinkStatsFrame(const LinkStatsFrame& s, Print& out);
+
+// Writes one framed sequencer status packet (includes trailing 0x00)
+void encodeSequenceFrame(const SequenceStatus& s, Print& out);
+
+// Writes one framed clock sync reply packet (includes trailing 0x00)
+void encodePongFrame(const PongFrame& p, Print& out);
+
+// Writes one framed parameter reply packet (includes trailing 0x00)
+void encodeParamFrame(const ParamReply& r, Print& out);
+
+// Writes one framed RX capture record, len <= RX_CAPTURE_CHUNK_BYTES
+// (includes trailing 0x00)
+void encodeRxCaptureFrame(uint32_t t_us, uint8_t seq, const uint8_t* data, size_t len, Print& out);
+
+// Writes one framed sysid capture chunk, count <= SYSID_CHUNK_SAMPLES
+// (includes trailing 0x00)
+void encodeSysIdFrame(const SysIdChunk& c, Print& out);
+
+// Writes one framed boot hello packet (includes trailing 0x00)
+void encodeHelloFrame(const HelloFrame& h, Print& out);
+
+// Writes one framed event log chunk, count <= EVENT_LOG_CHUNK_RECORDS
+// (includes trailing 0x00)
+void encodeEventLogFrame(const EventLogChunk& c, Print& out);
+
+/*=============================================================================
+  DECODE (Laptop -> Arduino)
+=============================================================================*/
+
+/*
+  Validates one COBS frame (delimiter already stripped), decoding in place.
+
+  Returns:
+    - packet type on success, with payload/payload_len pointing into buf
+    - 0 if the frame is malformed or the CRC does not match
+*/
+uint8_t decodeFrame(uint8_t* buf, size_t len, const uint8_t*& payload, size_t& payload_len);
+
+// Converts a validated PKT_CMD payload into a CommandFrame.
+bool decodeCommandPayload(const uint8_t* payload, size_t len, CommandFrame& out_cmd);
+
+// Converts a validated PKT_LINK payload into a WireMode.
+bool decodeLinkPayload(const uint8_t* payload, size_t len, WireMode& out_mode);
+
+// Converts a validated PKT_SUBSCRIBE payload (rates capped like the JSON path).
+bool decodeSubscribePayload(const uint8_t* payload, size_t len, TelemetrySubscription& out_sub);
+
+// Converts a validated PKT_SEQUENCE payload. Rejects unknown actions, ids
+// and ops, and step counts that don't match the payload length.
+bool decodeSequencePayload(const uint8_t* payload, size_t len, SequenceRequest& out_seq);
+
+// Converts a validated PKT_PATH payload. Rejects unknown actions, non-finite
+// points and counts that don't match the payload length.
+bool decodePathPayload(const uint8_t* payload, size_t len, PathRequest& out_req);
+
+// Converts a validated PKT_PING payload. Rejects id 0.
+bool decodePingPayload(const uint8_t* payload, size_t len, PingRequest& out_ping);
+
+// Converts a validated PKT_POSE payload. Rejects non-finite values.
+bool decodePosePayload(const uint8_t* payload, size_t len, PoseReset& out_pose);
+
+// Converts a validated PKT_PARAM payload. Rejects unknown ops; the name is
+// always NUL-terminated.
+bool decodeParamPayload(const uint8_t* payload, size_t len, ParamRequest& out_req);
+
+// Converts a validated PKT_TEST payload. Rejects NONE and unknown ops.
+bool decodeTestPayload(const uint8_t* payload, size_t len, TestRequest& out_req);
+
+// Converts a validated PKT_LOG payload. Rejects NONE and unknown ops.
+bool decodeLogPayload(const uint8_t* payload, size_t len, LogRequest& out_req);
+
+// Splits a validated PKT_RX_CAPTURE payload (replay side); data points into
+// the payload.
+bool decodeRxCapturePayload(const uint8_t* payload, size_t len,
+                            uint32_t& t_us, uint8_t& seq, const uint8_t*& data, size_t& data_len);
+
+}  // namespace bin
+}  // namespace protocol
@@ -0,0 +1,65 @@
+#pragma once
+#include <Arduino.h>
+#include <string.h>
+
+/*
+===============================================================================
+  BufferPrint.h
+===============================================================================
+
+  PURPOSE
+  -------
+  Print that writes into a caller-owned fixed buffer, so an encoder that
+  takes a Print& (Protocol, BinaryProtocol) can build a whole frame in RAM
+  before any of it goes to the wire. Writing past the end sets overflowed()
+  and keeps the bytes that fit.
+
+  With a skip count the buffer is a window into a longer frame: the first
+  `skip` bytes are dropped, the next `cap` kept, and overflowed() means
+  the frame goes on past the window (SerialLink streams a frame longer
+  than its TX stage this way, re-encoding it once per window).
+===============================================================================
+*/
+
+class BufferPrint : public Print {
+public:
+  BufferPrint(uint8_t* buf, size_t cap, size_t skip = 0) : _buf(buf), _cap(cap), _skip(skip) {}
+
+  size_t write(uint8_t c) override {
+    if (_skip > 0) { _skip--; return 1; }
+    if (_len >= _cap) { _overflowed = true; return 0; }
+    _buf[_len++] = c;
+    return 1;
+  }
+
+  size_t write(const uint8_t* data, size_t n) override {
+    const size_t k = (n < _skip) ? n : _skip;   // still before the window
+    _skip -= k;
+    data += k;
+    n -= k;
+
+    const size_t room = _cap - _len;
+    if (n > room) { _overflowed = true; n = room; }
+    memcpy(_buf + _len, data, n);
+    _len += n;
+    return k + n;
+  }
+
+  using Print::write;
+
+  size_t length() const { return _len; }
+  bool overflowed() const { return _overflowed; }
+
+  // Back to `len` bytes: drops a frame that didn't fit after the ones that did
+  void truncate(size_t len) {
+    if (len < _len) _len = len;
+    _overflowed = false;
+  }
+
+private:
+  uint8_t* _buf;
+  size_t _cap;
+  size_t _skip;
+  size_t _len = 0;
+  bool _overflowed = false;
+};
@@ -0,0 +1,32 @@
+#pragma once
+#include <Arduino.h>
+
+/*
+===============================================================================
+  BulkStream.h
+===============================================================================
+
+  PURPOSE
+  -------
+  Stream whose receive side is a buffer the reader can scan in place.
+  SerialLink drains one of these a run at a time (memchr for the frame
+  delimiter, then one bulk copy or parse) instead of paying a virtual
+  available()/read() pair per byte.
+
+    size_t n = s.peekBuffer(p);   // p[0..n) are received, contiguous bytes
+    ...use up to n bytes...
+    s.consume(used);
+
+  Implementations: Uart (USART ring buffer), ReplayStream (env:native).
+===============================================================================
+*/
+
+class BulkStream : public Stream {
+public:
+  // Longest run of received bytes readable in place; 0 if none. The run
+  // stays valid until consume().
+  virtual size_t peekBuffer(const uint8_t*& data) = 0;
+
+  // Drop the first n bytes of the run returned by peekBuffer().
+  virtual void consume(size_t n) = 0;
+};
@@ -0,0 +1,766 @@
+#include "comms/CommandParser.h"
+#include <string.h>
+
+#include "Params.h"
+
+/*
+===============================================================================
+  CommandParser.cpp
+===============================================================================
+
+  Byte-at-a-time JSON state machine specialised for the command schema.
+
+  How it works:
+  - A small context stack tracks which object we are in (root/drive/mech/motor,
+    or the "steps" / "points" array of a sequence / path upload).
+  - Keys and short string values are collected into a 24-byte token buffer
+    (the longest parameter name fits); anything longer is treated as an
+    unknown key / unknown value.
+  - Numbers are accumulated digit by digit (no strtod, no buffer).
+  - A value is applied to the CommandFrame as soon as it completes.
+  - '\n' validates the frame and reports the result.
+
+  Any syntax error puts the parser in S_ERROR until the next '\n', which keeps
+  the "drop until newline" resync behavior of the old line buffer.
+===============================================================================
+*/
+
+namespace {
+
+constexpr uint8_t SEEN_SEQ        = 0x01;
+constexpr uint8_t SEEN_HOST_TIME  = 0x02;
+constexpr uint8_t SEEN_DRIVE      = 0x04;
+constexpr uint8_t SEEN_MECH       = 0x08;
+constexpr uint8_t SEEN_ALL_CMD    = SEEN_SEQ | SEEN_HOST_TIME | SEEN_DRIVE | SEEN_MECH;
+constexpr uint8_t SEEN_PING_ID    = 0x10;
+constexpr uint8_t SEEN_PING_T1    = 0x20;
+constexpr uint8_t SEEN_ALL_PING   = SEEN_PING_ID | SEEN_PING_T1;
+
+inline bool isWs(char c) {
+  return c == ' ' || c == '\t' || c == '\r';
+}
+
+inline bool isDigit(char c) {
+  return c >= '0' && c <= '9';
+}
+
+// Subscription rate: negative -> 0, capped at TELEMETRY_GROUP_MAX_HZ
+inline uint16_t rateHz(bool neg, uint32_t v) {
+  if (neg) return 0;
+  return (v > TELEMETRY_GROUP_MAX_HZ) ? TELEMETRY_GROUP_MAX_HZ : (uint16_t)v;
+}
+
+// "steps" op name -> SeqOp (END = unknown)
+SeqOp stepOp(const char* s) {
+  if (strcmp(s, "lid") == 0)         return SeqOp::LID;
+  if (strcmp(s, "sweep") == 0)       return SeqOp::SWEEP;
+  if (strcmp(s, "wait_servos") == 0) return SeqOp::WAIT_SERVOS;
+  if (strcmp(s, "wait_ms") == 0)     return SeqOp::WAIT_MS;
+  if (strcmp(s, "drive") == 0)       return SeqOp::DRIVE;
+  if (strcmp(s, "turn") == 0)        return SeqOp::TURN;
+  if (strcmp(s, "wait_travel") == 0) return SeqOp::WAIT_TRAVEL;
+  return SeqOp::END;
+}
+
+// Host units (deg, ft/s, ft, ...) -> SeqStep::arg units, rounded, saturating
+int16_t stepArg(uint8_t op, float v) {
+  if (op == (uint8_t)SeqOp::LID || op == (uint8_t)SeqOp::SWEEP) v *= 10.0f;
+  else if (op == (uint8_t)SeqOp::DRIVE || op == (uint8_t)SeqOp::WAIT_TRAVEL) v *= 100.0f;
+
+  v += (v >= 0.0f) ? 0.5f : -0.5f;
+  if (v >= 32767.0f) return 32767;
+  if (v <= -32768.0f) return -32768;
+  return (int16_t)v;
+}
+
+}  // namespace
+
+
+CommandParser::CommandParser(uint16_t max_line_bytes)
+: _max_line(max_line_bytes)
+{
+  reset();
+}
+
+void CommandParser::reset() {
+  _line_done = false;
+  _len = 0;
+  _state = S_START;
+  _depth = 0;
+  _key = K_UNKNOWN;
+  _tok_len = 0;
+  _tok_trunc = false;
+
+  _type = T_NONE;
+  _seen = 0;
+  _cmd = CommandFrame();
+  _motor_mode = MechMotorMode::UNKNOWN;
+  _motor_value = 0.0f;
+  _link_mode_ok = false;
+  _tlm = TelemetryControl();
+  _sub = TelemetrySubscription();
+  _seq = SequenceRequest();
+  _step_field = 0;
+  _steps_seen = false;
+  _steps_bad = false;
+  _abort = false;
+  _ping = PingRequest();
+  _pose = PoseReset();
+  _param = ParamRequest();
+  _param_op_ok = false;
+  _test = TestRequest();
+  _log = LogRequest();
+  _path = PathRequest();
+  _point_values = 0;
+  _points_seen = false;
+  _points_bad = false;
+}
+
+CommandParser::Result CommandParser::feed(char c) {
+  // The previous line's results stay readable until the next byte arrives
+  if (_line_done) {
+    reset();
+    _line_done = false;
+  }
+
+  if (c == '\n') {
+    _line_done = true;
+    return finishLine_();
+  }
+
+  if (_len < 0xFFFF) _len++;
+
+  if (_len > _max_line) {
+    _state = S_ERROR;
+    return Result::NONE;
+  }
+
+  if (_state != S_ERROR) step_(c);
+  return Result::NONE;
+}
+
+CommandParser::Result CommandParser::feed(const char* data, size_t len, size_t& used) {
+  if (_line_done) {
+    reset();
+    _line_done = false;
+  }
+
+  const char* nl = (const char*)memchr(data, '\n', len);
+  const size_t body = nl ? (size_t)(nl - data) : len;
+
+  for (size_t i = 0; i < body; i++) {
+    if (_state == S_ERROR) {
+      // Nothing left to parse on this line: just count it
+      const size_t rest = body - i;
+      _len = (rest >= (size_t)(0xFFFF - _len)) ? (uint16_t)0xFFFF : (uint16_t)(_len + rest);
+      break;
+    }
+
+    const char c = data[i];
+    if (c == '\0') continue;
+
+    if (_len < 0xFFFF) _len++;
+    if (_len > _max_line) {
+      _state = S_ERROR;
+      continue;
+    }
+    step_(c);
+  }
+
+  if (!nl) {
+    used = len;
+    return Result::NONE;
+  }
+
+  used = body + 1;
+  _line_done = true;
+  return finishLine_();
+}
+
+void CommandParser::fail_() {
+  if (_state != S_ERROR) _err_at = _len;
+  _state = S_ERROR;
+}
+
+/*=============================================================================
+  TOKENIZER
+=============================================================================*/
+
+void CommandParser::step_(char c) {
+  switch (_state) {
+    case S_START:
+      if (isWs(c)) return;
+      if (c != '{') { fail_(); return; }
+      _stack[_depth++] = CTX_ROOT;
+      _state = S_KEY_OR_END;
+      return;
+
+    case S_KEY_OR_END:
+      if (isWs(c)) return;
+      if (c == '}') { closeContainer_(false); return; }
+      [[fallthrough]];
+    case S_KEY:
+      if (isWs(c)) return;
+      if (c != '"') { fail_(); return; }
+      _tok_len = 0;
+      _tok_trunc = false;
+      _str_is_key = true;
+      _state = S_STRING;
+      return;
+
+    case S_COLON:
+      if (isWs(c)) return;
+      if (c != ':') { fail_(); return; }
+      _state = S_VALUE;
+      return;
+
+    case S_VALUE_OR_END:
+      if (isWs(c)) return;
+      if (c == ']') { closeContainer_(true); return; }
+      [[fallthrough]];
+    case S_VALUE:
+      if (isWs(c)) return;
+      beginValue_(c);
+      return;
+
+    case S_AFTER_VALUE:
+      if (isWs(c)) return;
+      if (c == ',') {
+        _state = inArray_() ? S_VALUE : S_KEY;
+        return;
+      }
+      if (c == '}' && !inArray_()) { closeContainer_(false); return; }
+      if (c == ']' && inArray_())  { closeContainer_(true);  return; }
+      fail_();
+      return;
+
+    case S_STRING:
+      if (c == '\\') { _state = S_STRING_ESC; return; }
+      if (c == '"') {
+        _tok[_tok_len] = '\0';
+        if (_str_is_key) {
+          onKey_();
+          _state = S_COLON;
+        } else {
+          onString_();
+          endValue_();
+        }
+        return;
+      }
+      if (_tok_len + 1 < TOK_BYTES) _tok[_tok_len++] = c;
+      else _tok_trunc = true;
+      return;
+
+    case S_STRING_ESC:
+      // Escapes never appear in the keys/values we match; keep the string
+      // length honest and mark it so it cannot match anything.
+      _tok_trunc = true;
+      _state = S_STRING;
+      return;
+
+    case S_NUMBER:
+      if (isDigit(c)) {
+        const uint8_t d = (uint8_t)(c - '0');
+        if (_num_part == 0) {
+          _num_int = _num_int * 10UL + d;
+        } else if (_num_part == 1) {
+          _num_scale *= 0.1f;
+          _num_frac += (float)d * _num_scale;
+        } else if (_num_exp < 60) {
+          _num_exp = (int8_t)(_num_exp * 10 + d);
+        }
+        return;
+      }
+      if (c == '.' && _num_part == 0) { _num_part = 1; return; }
+      if ((c == 'e' || c == 'E') && _num_part < 2) { _num_part = 2; return; }
+      if ((c == '-' || c == '+') && _num_part == 2 && _num_exp == 0) { _num_exp_neg = (c == '-'); return; }
+
+      onNumber_();
+      endValue_();
+      step_(c);   // reprocess the terminator
+      return;
+
+    case S_LITERAL:
+      if (c >= 'a' && c <= 'z') {
+        if (_tok_len + 1 < TOK_BYTES) _tok[_tok_len++] = c;
+        else _tok_trunc = true;
+        return;
+      }
+      _tok[_tok_len] = '\0';
+      if (_tok_trunc) { fail_(); return; }
+      if (strcmp(_tok, "null") == 0) {
+        onNull_();
+      } else if (strcmp(_tok, "true") == 0 || strcmp(_tok, "false") == 0) {
+        // Booleans are not meaningful anywhere in the schema; treat like a
+        // non-numeric value (present but 0 for servo angles).
+        _tok_len = 0;
+        _tok_trunc = true;
+        onString_();
+      } else {
+        fail_();
+        return;
+      }
+      endValue_();
+      step_(c);
+      return;
+
+    case S_DONE:
+      if (isWs(c)) return;
+      fail_();
+      return;
+
+    case S_ERROR:
+      return;
+  }
+}
+
+void CommandParser::beginValue_(char c) {
+  if (c == '{' || c == '[') {
+    if (_depth >= MAX_DEPTH) { fail_(); return; }
+
+    // Steps and points are flat scalars only
+    if (ctx_() == CTX_STEPS) _steps_bad = true;
+    if (ctx_() == CTX_POINTS) _points_bad = true;
+
+    if (c == '{') {
+      onObjectOpen_();
+      _state = S_KEY_OR_END;
+    } else if (ctx_() == CTX_ROOT && _key == K_STEPS) {
+      _steps_seen = true;
+      _seq.step_count = 0;
+      _step_field = 0;
+      _stack[_depth++] = CTX_STEPS | ARRAY_BIT;
+      _state = S_VALUE_OR_END;
+    } else if (ctx_() == CTX_ROOT && _key == K_POINTS) {
+      _points_seen = true;
+      _point_values = 0;
+      _stack[_depth++] = CTX_POINTS | ARRAY_BIT;
+      _state = S_VALUE_OR_END;
+    } else {
+      _stack[_depth++] = CTX_SKIP | ARRAY_BIT;
+      _state = S_VALUE_OR_END;
+    }
+    return;
+  }
+
+  if (c == '"') {
+    _tok_len = 0;
+    _tok_trunc = false;
+    _str_is_key = false;
+    _state = S_STRING;
+    return;
+  }
+
+  if (c == '-' || isDigit(c)) {
+    _num_neg = (c == '-');
+    _num_int = _num_neg ? 0 : (uint32_t)(c - '0');
+    _num_frac = 0.0f;
+    _num_scale = 1.0f;
+    _num_exp = 0;
+    _num_exp_neg = false;
+    _num_part = 0;
+    _state = S_NUMBER;
+    return;
+  }
+
+  if (c >= 'a' && c <= 'z') {
+    _tok[0] = c;
+    _tok_len = 1;
+    _tok_trunc = false;
+    _state = S_LITERAL;
+    return;
+  }
+
+  fail_();
+}
+
+void CommandParser::endValue_() {
+  if (_depth && ctx_() == CTX_STEPS) nextStepField_();
+  _state = (_depth == 0) ? S_DONE : S_AFTER_VALUE;
+}
+
+void CommandParser::closeContainer_(bool is_array) {
+  const uint8_t top = _stack[_depth - 1];
+  _depth--;
+  if (!is_array) onObjectClose_((uint8_t)(top & ~ARRAY_BIT));
+  endValue_();
+}
+
+/*=============================================================================
+  SCHEMA
+=============================================================================*/
+
+void CommandParser::onKey_() {
+  _key = K_UNKNOWN;
+  if (_tok_trunc) return;
+
+  switch (ctx_()) {
+    case CTX_ROOT:
+      if      (strcmp(_tok, "type") == 0)         _key = K_TYPE;
+      else if (strcmp(_tok, "seq") == 0)          _key = K_SEQ;
+      else if (strcmp(_tok, "host_time_ms") == 0) _key = K_HOST_TIME_MS;
+      else if (strcmp(_tok, "drive") == 0)        _key = K_DRIVE;
+      else if (strcmp(_tok, "mech") == 0)         _key = K_MECH;
+      else if (strcmp(_tok, "mode") == 0)         _key = K_MODE;
+      else if (strcmp(_tok, "delta") == 0)        _key = K_DELTA;
+      else if (strcmp(_tok, "keyframe") == 0)     _key = K_KEYFRAME;
+      else if (strcmp(_tok, "telemetry") == 0)    _key = K_TELEMETRY;
+      else if (strcmp(_tok, "wheel") == 0)        _key = K_WHEEL;
+      else if (strcmp(_tok, "ultrasonic") == 0)   _key = K_ULTRASONIC;
+      else if (strcmp(_tok, "note") == 0)         _key = K_NOTE;
+      else if (strcmp(_tok, "run") == 0)          _key = K_RUN;
+      else if (strcmp(_tok, "abort") == 0)        _key = K_ABORT;
+      else if (strcmp(_tok, "steps") == 0)        _key = K_STEPS;
+      else if (strcmp(_tok, "id") == 0)           _key = K_ID;
+      else if (strcmp(_tok, "t1_us") == 0)        _key = K_T1_US;
+      else if (strcmp(_tok, "prev_id") == 0)      _key = K_PREV_ID;
+      else if (strcmp(_tok, "prev_t4_us") == 0)   _key = K_PREV_T4_US;
+      else if (strcmp(_tok, "at_ms") == 0)        _key = K_AT_MS;
+      else if (strcmp(_tok, "tel_ack") == 0)      _key = K_TEL_ACK;
+      else if (strcmp(_tok, "x_ft") == 0)         _key = K_X_FT;
+      else if (strcmp(_tok, "y_ft") == 0)         _key = K_Y_FT;
+      else if (strcmp(_tok, "heading_deg") == 0)  _key = K_HEADING_DEG;
+      else if (strcmp(_tok, "op") == 0)           _key = K_OP;
+      else if (strcmp(_tok, "name") == 0)         _key = K_NAME;
+      else if (strcmp(_tok, "index") == 0)        _key = K_INDEX;
+      else if (strcmp(_tok, "value") == 0)        _key = K_VALUE;
+      else if (strcmp(_tok, "points") == 0)       _key = K_POINTS;
+      else if (strcmp(_tok, "speed") == 0)        _key = K_SPEED;
+      else if (strcmp(_tok, "lookahead") == 0)    _key = K_LOOKAHEAD;
+      break;
+
+    case CTX_DRIVE:
+      if      (strcmp(_tok, "linear") == 0)  _key = K_LINEAR;
+      else if (strcmp(_tok, "angular") == 0) _key = K_ANGULAR;
+      break;
+
+    case CTX_MECH:
+      if      (strcmp(_tok, "servo_LID_deg") == 0)   _key = K_SERVO_LID;
+      else if (strcmp(_tok, "servo_SWEEP_deg") == 0) _key = K_SERVO_SWEEP;
+      else if (strcmp(_tok, "motor_RHS") == 0)       _key = K_MOTOR_RHS;
+      else if (strcmp(_tok, "motor_LHS") == 0)       _key = K_MOTOR_LHS;
+      break;
+
+    case CTX_MOTOR_RHS:
+    case CTX_MOTOR_LHS:
+      if      (strcmp(_tok, "mode") == 0)  _key = K_MODE;
+      else if (strcmp(_tok, "value") == 0) _key = K_VALUE;
+      break;
+
+    default:
+      break;
+  }
+
+  // seq/host_time_ms only need to exist (null decodes as 0)
+  if (ctx_() == CTX_ROOT) {
+    if (_key == K_SEQ) _seen |= SEEN_SEQ;
+    if (_key == K_HOST_TIME_MS) _seen |= SEEN_HOST_TIME;
+    if (_key == K_ID) _seen |= SEEN_PING_ID;
+    if (_key == K_T1_US) _seen |= SEEN_PING_T1;
+  }
+}
+
+void CommandParser::onString_() {
+  const uint8_t ctx = ctx_();
+  const bool known = !_tok_trunc;
+
+  if (ctx == CTX_ROOT) {
+    if (_key == K_TYPE) {
+      if (known && strcmp(_tok, "cmd") == 0)       _type = T_CMD;
+      else if (known && strcmp(_tok, "link") == 0) _type = T_LINK;
+      else if (known && strcmp(_tok, "tlm") == 0)  _type = T_TLM;
+      else if (known && strcmp(_tok, "subscribe") == 0) _type = T_SUBSCRIBE;
+      else if (known && strcmp(_tok, "seq") == 0)  _type = T_SEQ;
+      else if (known && strcmp(_tok, "ping") == 0) _type = T_PING;
+      else if (known && strcmp(_tok, "pose") == 0) _type = T_POSE;
+      else if (known && strcmp(_tok, "param") == 0) _type = T_PARAM;
+      else if (known && strcmp(_tok, "test") == 0)  _type = T_TEST;
+      else if (known && strcmp(_tok, "log") == 0)   _type = T_LOG;
+      else if (known && strcmp(_tok, "path") == 0)  _type = T_PATH;
+      else                                          _type = T_OTHER;
+    } else if (_key == K_MODE && known) {
+      if (strcmp(_tok, "json") == 0)   { _link_mode = WireMode::JSON;   _link_mode_ok = true; }
+      if (strcmp(_tok, "binary") == 0) { _link_mode = WireMode::BINARY; _link_mode_ok = true; }
+    } else if (_key == K_RUN && known) {
+      if (strcmp(_tok, "pickup") == 0) { _seq.id = SeqId::PICKUP; _seq.action = SeqAction::RUN; }
+      if (strcmp(_tok, "stow") == 0)   { _seq.id = SeqId::STOW;   _seq.action = SeqAction::RUN; }
+    } else if (_key == K_OP && known) {
+      _param_op_ok = true;
+      if      (strcmp(_tok, "get") == 0)      _param.op = ParamOp::GET;
+      else if (strcmp(_tok, "set") == 0)      _param.op = ParamOp::SET;
+      else if (strcmp(_tok, "save") == 0)     _param.op = ParamOp::SAVE;
+      else if (strcmp(_tok, "load") == 0)     _param.op = ParamOp::LOAD;
+      else if (strcmp(_tok, "defaults") == 0) _param.op = ParamOp::DEFAULTS;
+      else                                    _param_op_ok = false;
+      // "op" may come before "type": fill in each request
+      if      (strcmp(_tok, "drive_step") == 0) _test.op = TestOp::DRIVE_STEP;
+      else if (strcmp(_tok, "abort") == 0)      _test.op = TestOp::ABORT;
+      else if (strcmp(_tok, "sysid_drive") == 0) _test.op = TestOp::SYSID_DRIVE;
+      else if (strcmp(_tok, "sysid_arm") == 0)  _test.op = TestOp::SYSID_ARM;
+      if      (strcmp(_tok, "dump") == 0)       _log.op = LogOp::DUMP;
+      else if (strcmp(_tok, "clear") == 0)      _log.op = LogOp::CLEAR;
+    } else if (_key == K_NAME) {
+      // Too long to be a parameter: an empty name matches nothing
+      if (known) memcpy(_param.name, _tok, (size_t)_tok_len + 1);
+      else       _param.name[0] = '\0';
+    }
+    return;
+  }
+
+  if (ctx == CTX_STEPS) {
+    // Only the op slot of a triple is a string
+    const SeqOp op = known ? stepOp(_tok) : SeqOp::END;
+    if (_step_field != 0 || op == SeqOp::END || _seq.step_count >= SEQ_MAX_STEPS) {
+      _steps_bad = true;
+      return;
+    }
+    _seq.steps[_seq.step_count].op = (uint8_t)op;
+    return;
+  }
+
+  if (ctx == CTX_POINTS) {
+    _points_bad = true;
+    return;
+  }
+
+  if (ctx == CTX_MECH) {
+    // Non-null, non-numeric servo value: present, defaults to 0
+    if (_key == K_SERVO_LID) {
+      _cmd.mech.servo_LID_deg = 0.0f;
+      _cmd.mech.servo_LID_present = true;
+    } else if (_key == K_SERVO_SWEEP) {
+      _cmd.mech.servo_SWEEP_deg = 0.0f;
+      _cmd.mech.servo_SWEEP_present = true;
+    }
+    return;
+  }
+
+  if ((ctx == CTX_MOTOR_RHS || ctx == CTX_MOTOR_LHS) && _key == K_MODE && known) {
+    if      (strcmp(_tok, "POS_DEG") == 0) _motor_mode = MechMotorMode::POS_DEG;
+    else if (strcmp(_tok, "DUTY") == 0)    _motor_mode = MechMotorMode::DUTY;
+  }
+}
+
+void CommandParser::onNumber_() {
+  float v = (float)_num_int + _num_frac;
+  if (_num_exp) {
+    for (int8_t i = 0; i < _num_exp; i++) v = _num_exp_neg ? v * 0.1f : v * 10.0f;
+  }
+  if (_num_neg) v = -v;
+
+  const uint32_t u = _num_neg ? (uint32_t)(0UL - _num_int) : _num_int;
+
+  switch (ctx_()) {
+    case CTX_ROOT:
+      if (_key == K_SEQ) _cmd.seq = u;
+      else if (_key == K_HOST_TIME_MS) _cmd.host_time_ms = u;
+      else if (_key == K_AT_MS) { _cmd.at_ms = u; _cmd.at_present = true; }
+      else if (_key == K_TEL_ACK) { _cmd.tel_ack = (uint16_t)u; _cmd.tel_ack_present = true; }
+      else if (_key == K_DELTA) { _tlm.delta = (u != 0); _tlm.delta_present = true; }
+      else if (_key == K_KEYFRAME) _tlm.keyframe = (u != 0);
+      else if (_key == K_TELEMETRY) _sub.telemetry_hz = rateHz(_num_neg, _num_int);
+      else if (_key == K_WHEEL) _sub.wheel_hz = rateHz(_num_neg, _num_int);
+      else if (_key == K_ULTRASONIC) _sub.ultrasonic_hz = rateHz(_num_neg, _num_int);
+      else if (_key == K_MECH) _sub.mech_hz = rateHz(_num_neg, _num_int);
+      else if (_key == K_NOTE) _sub.note = (u != 0);
+      else if (_key == K_ABORT) _abort = (u != 0);
+      else if (_key == K_ID) _ping.id = (uint16_t)u;
+      else if (_key == K_T1_US) _ping.t1_us = u;
+      else if (_key == K_PREV_ID) _ping.prev_id = (uint16_t)u;
+      else if (_key == K_PREV_T4_US) _ping.prev_t4_us = u;
+      else if (_key == K_X_FT) _pose.x_ft = v;
+      else if (_key == K_Y_FT) _pose.y_ft = v;
+      else if (_key == K_HEADING_DEG) _pose.heading_deg = v;
+      else if (_key == K_VALUE) { _param.value = v; _test.value = v; }
+      else if (_key == K_INDEX) _param.index = (_num_neg || _num_int >= PARAM_NO_INDEX) ? PARAM_NO_INDEX : (uint8_t)_num_int;
+      else if (_key == K_SPEED) _path.speed_ftps = v;
+      else if (_key == K_LOOKAHEAD) _path.lookahead_ft = v;
+      break;
+
+    case CTX_POINTS:
+      if (_point_values >= 2 * PATH_MAX_POINTS) {
+        _points_bad = true;
+      } else {
+        PathPoint& pt = _path.points[_point_values / 2];
+        if (_point_values & 1) pt.y_ft = v;
+        else                   pt.x_ft = v;
+        _point_values++;
+      }
+      break;
+
+    case CTX_STEPS:
+      if (_step_field == 0 || _seq.step_count >= SEQ_MAX_STEPS) {
+        _steps_bad = true;
+      } else if (_step_field == 1) {
+        SeqStep& st = _seq.steps[_seq.step_count];
+        st.arg = stepArg(st.op, v);
+      } else {
+        _seq.steps[_seq.step_count].timeout_ms =
+            _num_neg ? 0 : (_num_int > 0xFFFFUL) ? (uint16_t)0xFFFF : (uint16_t)_num_int;
+      }
+      break;
+
+    case CTX_DRIVE:
+      if (_key == K_LINEAR) _cmd.drive.linear_ftps = v;
+      else if (_key == K_ANGULAR) _cmd.drive.angular_dps = v;
+      break;
+
+    case CTX_MECH:
+      if (_key == K_SERVO_LID) {
+        _cmd.mech.servo_LID_deg = v;
+        _cmd.mech.servo_LID_present = true;
+      } else if (_key == K_SERVO_SWEEP) {
+        _cmd.mech.servo_SWEEP_deg = v;
+        _cmd.mech.servo_SWEEP_present = true;
+      }
+      break;
+
+    case CTX_MOTOR_RHS:
+    case CTX_MOTOR_LHS:
+      if (_key == K_VALUE) _motor_value = v;
+      break;
+
+    default:
+      break;
+  }
+}
+
+void CommandParser::onNull_() {
+  // null leaves every field at its default / not-present state (a step's
+  // arg or timeout reads as 0; an op or a path coordinate can't be null)
+  if (ctx_() == CTX_STEPS && _step_field == 0) _steps_bad = true;
+  if (ctx_() == CTX_POINTS) _points_bad = true;
+}
+
+void CommandParser::nextStepField_() {
+  if (++_step_field < 3) return;
+  _step_field = 0;
+  if (_seq.step_count < SEQ_MAX_STEPS) _seq.step_count++;
+}
+
+void CommandParser::onObjectOpen_() {
+  uint8_t next = CTX_SKIP;
+
+  if (_depth == 0) {
+    next = CTX_ROOT;
+  } else {
+    switch (ctx_()) {
+      case CTX_ROOT:
+        if (_key == K_DRIVE) { next = CTX_DRIVE; _seen |= SEEN_DRIVE; }
+        else if (_key == K_MECH) { next = CTX_MECH; _seen |= SEEN_MECH; }
+        break;
+
+      case CTX_MECH:
+        if (_key == K_MOTOR_RHS) next = CTX_MOTOR_RHS;
+        else if (_key == K_MOTOR_LHS) next = CTX_MOTOR_LHS;
+        break;
+
+      default:
+        break;
+    }
+  }
+
+  if (next == CTX_MOTOR_RHS || next == CTX_MOTOR_LHS) {
+    _motor_mode = MechMotorMode::UNKNOWN;
+    _motor_value = 0.0f;
+  }
+
+  _stack[_depth++] = next;
+}
+
+void CommandParser::onObjectClose_(uint8_t ctx) {
+  if (ctx != CTX_MOTOR_RHS && ctx != CTX_MOTOR_LHS) return;
+  if (_motor_mode == MechMotorMode::UNKNOWN) return;
+
+  MechMotorCommand& m = (ctx == CTX_MOTOR_RHS) ? _cmd.mech.motor_RHS : _cmd.mech.motor_LHS;
+  m.mode = _motor_mode;
+  m.value = _motor_value;
+  m.present = true;
+}
+
+/*=============================================================================
+  LINE END
+=============================================================================*/
+
+CommandParser::Result CommandParser::finishLine_() {
+  if (_len > _max_line) return Result::OVERFLOW;
+
+  if (_state == S_START) return Result::EMPTY;
+  if (_state == S_ERROR) return Result::ERROR;
+
+  // Frames must end with the root object closed
+  if (_state != S_DONE) {
+    fail_();
+    return Result::ERROR;
+  }
+
+  if (_type == T_CMD && (_seen & SEEN_ALL_CMD) == SEEN_ALL_CMD) {
+    _cmd.valid = true;
+    return Result::COMMAND;
+  }
+
+  if (_type == T_LINK && _link_mode_ok) {
+    return Result::LINK;
+  }
+
+  if (_type == T_TLM) {
+    return Result::TLM;
+  }
+
+  if (_type == T_SUBSCRIBE) {
+    return Result::SUBSCRIBE;
+  }
+
+  if (_type == T_PING && (_seen & SEEN_ALL_PING) == SEEN_ALL_PING && _ping.id != 0) {
+    return Result::PING;
+  }
+
+  if (_type == T_POSE) {
+    return Result::POSE;
+  }
+
+  if (_type == T_PARAM && _param_op_ok) {
+    return Result::PARAM;
+  }
+
+  if (_type == T_TEST && _test.op != TestOp::NONE) {
+    return Result::TEST;
+  }
+
+  if (_type == T_LOG && _log.op != LogOp::NONE) {
+    return Result::LOG;
+  }
+
+  // abort wins; else whole (x, y) pairs
+  if (_type == T_PATH) {
+    if (_abort) {
+      _path.action = PathAction::ABORT;
+      return Result::PATH;
+    }
+    if (_points_seen && !_points_bad && _point_values > 0 && (_point_values & 1) == 0) {
+      _path.action = PathAction::RUN;
+      _path.count = (uint8_t)(_point_values / 2);
+      return Result::PATH;
+    }
+  }
+
+  // abort wins; an upload must be whole triples; else a known "run" name
+  if (_type == T_SEQ) {
+    if (_abort) {
+      _seq.action = SeqAction::ABORT;
+      return Result::SEQUENCE;
+    }
+    if (_steps_seen) {
+      if (!_steps_bad && _step_field == 0 && _seq.step_count > 0) {
+        _seq.action = SeqAction::UPLOAD;
+        _seq.id = SeqId::UPLOAD;
+        return Result::SEQUENCE;
+      }
+    } else if (_seq.action == SeqAction::RUN) {
+      return Result::SEQUENCE;
+    }
+  }
+
+  _err_at = _len;
+  return Result::ERROR;
+}
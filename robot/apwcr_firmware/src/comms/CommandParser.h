@@ -0,0 +1,278 @@
+#pragma once
+#include <Arduino.h>
+
+#include "comms/Messages.h"
+
+/*
+===============================================================================
+  CommandParser.h
+===============================================================================
+
+  PURPOSE
+  -------
+  Zero-allocation, incremental parser for the newline-delimited JSON frames
+  the laptop sends. Bytes are fed one at a time as they arrive; the parser
+  fills a CommandFrame directly, so no line buffer or JSON document pool is
+  needed.
+
+  Recognized frames:
+    {"type": "cmd", "seq": ..., "host_time_ms": ..., "drive": {...}, "mech": {...}}
+      (optional "at_ms": ... queues it, see comms/CommandQueue.h; optional
+      "tel_ack": ... is the telemetry credit, see comms/SerialLink.h)
+    {"type": "link", "mode": "json" | "binary"}
+    {"type": "tlm", "delta": 0 | 1, "keyframe": 1}
+    {"type": "subscribe", "telemetry": Hz, "wheel": Hz, "ultrasonic": Hz, "mech": Hz, "note": 0 | 1}
+    {"type": "seq", "run": "pickup"} | {"type": "seq", "abort": 1}
+    {"type": "seq", "steps": ["lid", 80, 0, "wait_servos", 0, 6000, ...]}
+    {"type": "ping", "id": n, "t1_us": ..., "prev_id": n, "prev_t4_us": ...}
+    {"type": "pose", "x_ft": ..., "y_ft": ..., "heading_deg": ...}
+    {"type": "param", "op": "get" | "set" | ..., "name": "DRIVE_KP" | "index": n, "value": ...}
+    {"type": "test", "op": "drive_step" | "sysid_drive" | "sysid_arm" | "abort", "value": ...}
+    {"type": "log", "op": "dump" | "clear"}
+    {"type": "path", "points": [x0, y0, x1, y1, ...], "speed": ..., "lookahead": ...}
+    {"type": "path", "abort": 1}
+
+  Semantics match the former ArduinoJson decoder:
+    - seq, host_time_ms, drive and mech must be present; drive/mech must be objects
+    - missing or non-numeric drive values default to 0
+    - servo angles are "present" when not null
+    - motor commands are "present" only with a known mode string
+    - unknown keys (including nested objects/arrays) are skipped
+    - "steps" must be whole (op, arg, timeout) triples with known op names,
+      at most SEQ_MAX_STEPS of them; anything else rejects the frame
+    - a ping needs id (non-zero) and t1_us; prev_id / prev_t4_us default to 0
+    - pose fields are optional (0)
+    - a param frame needs a known op; a name too long to be a parameter,
+      an index past 253 or a missing set value is left for the store to
+      reject (it replies UNKNOWN / RANGE)
+    - a test frame needs a known op; value is optional
+    - a log frame needs a known op
+    - "points" must be whole (x, y) pairs of numbers, 1..PATH_MAX_POINTS
+      of them; speed / lookahead are optional (NAN)
+
+  Integer fields wrap modulo 2^32 (host_time_ms is epoch ms on the laptop).
+===============================================================================
+*/
+
+class CommandParser {
+public:
+  enum class Result : uint8_t {
+    NONE = 0,     // line still in progress
+    EMPTY,        // blank line
+    COMMAND,      // valid "cmd" frame, see command()
+    LINK,         // valid "link" frame, see linkMode()
+    TLM,          // "tlm" telemetry control frame, see tlmControl()
+    SUBSCRIBE,    // "subscribe" frame, see subscription()
+    SEQUENCE,     // "seq" frame, see sequence()
+    PING,         // "ping" clock sync frame, see ping()
+    POSE,         // "pose" odometry reset, see pose()
+    PARAM,        // "param" tuning request, see param()
+    TEST,         // "test" mode request, see test()
+    LOG,          // "log" event log request, see log()
+    PATH,         // "path" run / abort, see path()
+    ERROR,        // malformed JSON or schema mismatch
+    OVERFLOW,     // line longer than max_line_bytes
+  };
+
+  explicit CommandParser(uint16_t max_line_bytes);
+
+  // Forget any partial line.
+  void reset();
+
+  // Feed one byte. Returns non-NONE when a '\n' completes a line.
+  Result feed(char c);
+
+  // Feed a run of bytes, stopping after the first '\n'. `used` is how many
+  // bytes were taken; feed the rest in the next call. 0x00 bytes are
+  // ignored. Once a line has failed or overflowed, the rest of it is
+  // skipped with one memchr instead of being stepped byte by byte.
+  Result feed(const char* data, size_t len, size_t& used);
+
+  // Valid after Result::COMMAND (until the next feed()).
+  const CommandFrame& command() const { return _cmd; }
+
+  // Valid after Result::LINK.
+  WireMode linkMode() const { return _link_mode; }
+
+  // Valid after Result::TLM.
+  const TelemetryControl& tlmControl() const { return _tlm; }
+
+  // Valid after Result::SUBSCRIBE. Rates are capped at TELEMETRY_GROUP_MAX_HZ.
+  const TelemetrySubscription& subscription() const { return _sub; }
+
+  // Valid after Result::SEQUENCE. Uploaded step args are already in
+  // SeqStep units (tenths of a degree, 0.01 ft/s, ...).
+  const SequenceRequest& sequence() const { return _seq; }
+
+  // Valid after Result::PING.
+  const PingRequest& ping() const { return _ping; }
+
+  // Valid after Result::POSE.
+  const PoseReset& pose() const { return _pose; }
+
+  // Valid after Result::PARAM.
+  const ParamRequest& param() const { return _param; }
+
+  // Valid after Result::TEST.
+  const TestRequest& test() const { return _test; }
+
+  // Valid after Result::LOG.
+  const LogRequest& log() const { return _log; }
+
+  // Valid after Result::PATH.
+  const PathRequest& path() const { return _path; }
+
+  // Bytes in the line that just completed (or so far).
+  uint16_t lineLength() const { return _len; }
+
+  // Byte offset where the last ERROR was detected.
+  uint16_t errorOffset() const { return _err_at; }
+
+private:
+  // Which object we are inside (determines how keys are interpreted)
+  enum Ctx : uint8_t {
+    CTX_ROOT = 0,
+    CTX_DRIVE,
+    CTX_MECH,
+    CTX_MOTOR_RHS,
+    CTX_MOTOR_LHS,
+    CTX_STEPS,        // the "steps" array of a "seq" frame
+    CTX_POINTS,       // the "points" array of a "path" frame
+    CTX_SKIP,
+  };
+
+  enum Key : uint8_t {
+    K_UNKNOWN = 0,
+    K_TYPE,
+    K_SEQ,
+    K_HOST_TIME_MS,
+    K_DRIVE,
+    K_MECH,
+    K_LINEAR,
+    K_ANGULAR,
+    K_SERVO_LID,
+    K_SERVO_SWEEP,
+    K_MOTOR_RHS,
+    K_MOTOR_LHS,
+    K_MODE,
+    K_VALUE,
+    K_DELTA,
+    K_KEYFRAME,
+    K_TELEMETRY,
+    K_WHEEL,
+    K_ULTRASONIC,
+    K_NOTE,
+    K_RUN,
+    K_ABORT,
+    K_STEPS,
+    K_ID,
+    K_T1_US,
+    K_PREV_ID,
+    K_PREV_T4_US,
+    K_AT_MS,
+    K_TEL_ACK,
+    K_X_FT,
+    K_Y_FT,
+    K_HEADING_DEG,
+    K_OP,
+    K_NAME,
+    K_INDEX,
+    K_POINTS,
+    K_SPEED,
+    K_LOOKAHEAD,
+  };
+
+  enum State : uint8_t {
+    S_START,          // expect '{'
+    S_KEY_OR_END,     // after '{': expect '"' or '}'
+    S_KEY,            // after ',' in object: expect '"'
+    S_COLON,
+    S_VALUE,
+    S_VALUE_OR_END,   // after '[': expect value or ']'
+    S_AFTER_VALUE,    // expect ',' or closer
+    S_STRING,
+    S_STRING_ESC,
+    S_NUMBER,
+    S_LITERAL,
+    S_DONE,           // root closed, expect only whitespace
+    S_ERROR,          // discard until '\n'
+  };
+
+  enum Type : uint8_t { T_NONE = 0, T_CMD, T_LINK, T_TLM, T_SUBSCRIBE, T_SEQ, T_PING, T_POSE, T_PARAM, T_TEST, T_LOG, T_PATH, T_OTHER };
+
+  static constexpr uint8_t MAX_DEPTH = 8;
+  static constexpr uint8_t TOK_BYTES = PARAM_NAME_BYTES;   // longest parameter name + NUL
+  static constexpr uint8_t ARRAY_BIT = 0x80;
+
+  void step_(char c);
+  Result finishLine_();
+  void fail_();
+
+  void beginValue_(char c);
+  void endValue_();
+  void closeContainer_(bool is_array);
+
+  void onKey_();
+  void onString_();
+  void onNumber_();
+  void onNull_();
+  void onObjectOpen_();
+  void onObjectClose_(uint8_t ctx);
+  void nextStepField_();
+
+  uint8_t ctx_() const { return _depth ? (uint8_t)(_stack[_depth - 1] & ~ARRAY_BIT) : (uint8_t)CTX_ROOT; }
+  bool inArray_() const { return _depth && (_stack[_depth - 1] & ARRAY_BIT); }
+
+  uint16_t _max_line;
+  uint16_t _len = 0;
+  uint16_t _err_at = 0;
+
+  State _state = S_START;
+  bool _str_is_key = false;
+  bool _line_done = false;
+
+  uint8_t _stack[MAX_DEPTH];
+  uint8_t _depth = 0;
+
+  Key _key = K_UNKNOWN;
+
+  // Short token buffer (keys, short string values, literals)
+  char _tok[TOK_BYTES];
+  uint8_t _tok_len = 0;
+  bool _tok_trunc = false;
+
+  // Incremental number parse
+  bool _num_neg = false;
+  uint32_t _num_int = 0;
+  float _num_frac = 0.0f;
+  float _num_scale = 1.0f;
+  int8_t _num_exp = 0;
+  bool _num_exp_neg = false;
+  uint8_t _num_part = 0;   // 0 = int, 1 = frac, 2 = exp
+
+  // Frame being assembled
+  Type _type = T_NONE;
+  uint8_t _seen = 0;       // SEEN_* bits
+  CommandFrame _cmd;
+  MechMotorMode _motor_mode = MechMotorMode::UNKNOWN;
+  float _motor_value = 0.0f;
+  WireMode _link_mode = WireMode::JSON;
+  bool _link_mode_ok = false;
+  TelemetryControl _tlm;
+  TelemetrySubscription _sub;
+  SequenceRequest _seq;
+  uint8_t _step_field = 0;   // position in the current (op, arg, timeout) triple
+  bool _steps_seen = false;
+  bool _steps_bad = false;
+  bool _abort = false;
+  PingRequest _ping;
+  PoseReset _pose;
+  ParamRequest _param;
+  bool _param_op_ok = false;
+  TestRequest _test;
+  LogRequest _log;
+  PathRequest _path;
+  uint8_t _point_values = 0;   // numbers taken from "points" (x, y, x, ...)
+  bool _points_seen = false;
+  bool _points_bad = false;
+};
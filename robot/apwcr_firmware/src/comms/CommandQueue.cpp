@@ -0,0 +1,41 @@
+#include "comms/CommandQueue.h"
+
+/*
+===============================================================================
+  CommandQueue.cpp
+===============================================================================
+*/
+
+static_assert(COMMAND_QUEUE_DEPTH > 0 && COMMAND_QUEUE_DEPTH < 128, "COMMAND_QUEUE_DEPTH out of range");
+
+CommandQueue::Push CommandQueue::push(const CommandFrame& cmd, uint32_t now_ms) {
+  Push r = Push::OK;
+  if (_count >= DEPTH) {
+    r = Push::FULL;
+  } else if ((int32_t)(cmd.at_ms - now_ms) > (int32_t)COMMAND_QUEUE_MAX_AHEAD_MS) {
+    r = Push::TOO_FAR;
+  } else if (_count && (int32_t)(cmd.at_ms - at_(_count - 1).at_ms) < 0) {
+    r = Push::OUT_OF_ORDER;
+  }
+
+  if (r != Push::OK) {
+    _rejected++;
+    return r;
+  }
+
+  _buf[(uint8_t)((_head + _count) % DEPTH)] = cmd;
+  _count++;
+  return Push::OK;
+}
+
+bool CommandQueue::popDue(uint32_t now_ms, CommandFrame& out) {
+  bool any = false;
+  while (_count && (int32_t)(now_ms - at_(0).at_ms) >= 0) {
+    if (any) _superseded++;
+    out = at_(0);
+    any = true;
+    _head = (uint8_t)((_head + 1) % DEPTH);
+    _count--;
+  }
+  return any;
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include <Arduino.h>
+
+#include "Params.h"
+#include "comms/Messages.h"
+
+/*
+===============================================================================
+  CommandQueue.h
+===============================================================================
+
+  PURPOSE
+  -------
+  Bounded queue of timed setpoints ("cmd" frames carrying at_ms), so the
+  host can send a short drive/mech trajectory in one burst and the
+  firmware plays it back on its own clock.
+
+    - Entries are kept in at_ms order; a frame older than the tail, more
+      than COMMAND_QUEUE_MAX_AHEAD_MS ahead, or arriving when full is
+      rejected (the host watches queue_free in telemetry for flow control)
+    - popDue() hands out the newest entry whose time has come; older due
+      entries are superseded (setpoints are absolute, so only the latest
+      one matters once both are late)
+    - An untimed command supersedes the whole queue (SerialLink clears it)
+
+  Times are millis(); comparisons are wrap-safe. COMMAND_QUEUE_DEPTH
+  CommandFrames of SRAM.
+===============================================================================
+*/
+
+class CommandQueue {
+public:
+  static constexpr uint8_t DEPTH = COMMAND_QUEUE_DEPTH;
+
+  enum class Push : uint8_t {
+    OK = 0,
+    FULL,
+    OUT_OF_ORDER,   // at_ms earlier than the last queued entry
+    TOO_FAR,        // at_ms beyond COMMAND_QUEUE_MAX_AHEAD_MS
+  };
+
+  void clear() { _head = 0; _count = 0; }
+
+  Push push(const CommandFrame& cmd, uint32_t now_ms);
+
+  // Newest entry due at now_ms (earlier due entries are dropped).
+  // false = nothing due yet.
+  bool popDue(uint32_t now_ms, CommandFrame& out);
+
+  uint8_t depth() const { return _count; }
+  uint8_t free() const { return (uint8_t)(DEPTH - _count); }
+
+  uint32_t rejected() const { return _rejected; }
+  uint32_t superseded() const { return _superseded; }
+
+private:
+  const CommandFrame& at_(uint8_t i) const { return _buf[(uint8_t)((_head + i) % DEPTH)]; }
+
+  CommandFrame _buf[DEPTH];
+  uint8_t _head = 0;
+  uint8_t _count = 0;
+
+  uint32_t _rejected = 0;
+  uint32_t _superseded = 0;
+};
@@ -0,0 +1,207 @@
+#include "comms/JsonWriter.h"
+#include <math.h>
+
+/*
+===============================================================================
+  JsonWriter.cpp
+===============================================================================
+
+  Integer formatting uses repeated subtraction of powers of ten instead of
+  32-bit division: the AVR has no divide instruction, and a /10 per digit
+  costs far more than a handful of subtractions.
+===============================================================================
+*/
+
+namespace {
+
+const uint32_t kPow10[] PROGMEM = {
+  1000000000UL, 100000000UL, 10000000UL, 1000000UL, 100000UL,
+  10000UL, 1000UL, 100UL, 10UL, 1UL,
+};
+
+// Writes v as decimal into buf (no terminator). Returns digit count.
+uint8_t formatU32(uint32_t v, char* buf) {
+  uint8_t n = 0;
+  bool started = false;
+
+  for (uint8_t i = 0; i < 10; i++) {
+    const uint32_t p = pgm_read_dword(&kPow10[i]);
+    char d = '0';
+    while (v >= p) {
+      v -= p;
+      d++;
+    }
+    if (d != '0' || started || i == 9) {
+      buf[n++] = d;
+      started = true;
+    }
+  }
+  return n;
+}
+
+// Fractional part scale for 0..6 decimals
+const uint32_t kFracScale[] PROGMEM = { 1UL, 10UL, 100UL, 1000UL, 10000UL, 100000UL, 1000000UL };
+
+}  // namespace
+
+
+void JsonWriter::separator_() {
+  if (_depth == 0) return;
+  const uint8_t bit = (uint8_t)(1u << ((_depth - 1) & 7));
+  if (_has_member & bit) _out.write(',');
+  _has_member |= bit;
+}
+
+void JsonWriter::beginObject() {
+  _out.write('{');
+  _depth++;
+  _has_member &= (uint8_t)~(1u << ((_depth - 1) & 7));
+}
+
+void JsonWriter::endObject() {
+  _out.write('}');
+  if (_depth) _depth--;
+}
+
+void JsonWriter::beginArray() {
+  _out.write('[');
+  _depth++;
+  _has_member &= (uint8_t)~(1u << ((_depth - 1) & 7));
+}
+
+void JsonWriter::endArray() {
+  _out.write(']');
+  if (_depth) _depth--;
+}
+
+void JsonWriter::key(const __FlashStringHelper* k) {
+  separator_();
+  _out.write('"');
+  _out.print(k);
+  _out.write("\":", 2);
+}
+
+void JsonWriter::element() {
+  separator_();
+}
+
+void JsonWriter::u32(uint32_t v) {
+  char buf[10];
+  const uint8_t n = formatU32(v, buf);
+  _out.write(buf, n);
+}
+
+void JsonWriter::i32(int32_t v) {
+  if (v < 0) {
+    _out.write('-');
+    u32((uint32_t)(-(v + 1)) + 1u);
+    return;
+  }
+  u32((uint32_t)v);
+}
+
+void JsonWriter::number(float v, uint8_t decimals) {
+  if (!isfinite(v)) {
+    null();
+    return;
+  }
+
+  if (decimals > 6) decimals = 6;
+
+  char buf[20];
+  uint8_t n = 0;
+
+  if (v < 0.0f) {
+    v = -v;
+    buf[n++] = '-';
+  }
+
+  // Integer part saturates at 4e9 (far beyond anything we report)
+  if (v > 4.0e9f) v = 4.0e9f;
+
+  const uint32_t scale = pgm_read_dword(&kFracScale[decimals]);
+  uint32_t ip = (uint32_t)v;
+  uint32_t fp = (uint32_t)((v - (float)ip) * (float)scale + 0.5f);
+  if (fp >= scale) {
+    ip++;
+    fp -= scale;
+  }
+
+  // Don't emit "-0"
+  if (ip == 0 && fp == 0) n = 0;
+
+  n += formatU32(ip, buf + n);
+
+  if (fp != 0) {
+    buf[n++] = '.';
+
+    // Zero-padded fraction, then trim trailing zeros
+    for (int8_t i = (int8_t)decimals - 1; i >= 0; i--) {
+      const uint32_t p = pgm_read_dword(&kFracScale[i]);
+      char d = '0';
+      while (fp >= p) {
+        fp -= p;
+        d++;
+      }
+      buf[n++] = d;
+    }
+    while (buf[n - 1] == '0') n--;
+  }
+
+  _out.write(buf, n);
+}
+
+void JsonWriter::boolean(bool b) {
+  if (b) _out.write("true", 4);
+  else   _out.write("false", 5);
+}
+
+void JsonWriter::null() {
+  _out.write("null", 4);
+}
+
+void JsonWriter::string(const char* s) {
+  if (!s) {
+    null();
+    return;
+  }
+
+  _out.write('"');
+  const char* run = s;
+  while (*s) {
+    const char c = *s;
+    if (c == '"' || c == '\\' || (uint8_t)c < 0x20) {
+      if (s > run) _out.write(run, (size_t)(s - run));
+      _out.write('\\');
+      if (c == '"' || c == '\\') _out.write(c);
+      else if (c == '\n') _out.write('n');
+      else if (c == '\r') _out.write('r');
+      else if (c == '\t') _out.write('t');
+      else {
+        static const char hex[] = "0123456789abcdef";
+        _out.write("u00", 3);
+        _out.write(hex[((uint8_t)c >> 4) & 0x0F]);
+        _out.write(hex[(uint8_t)c & 0x0F]);
+      }
+      run = s + 1;
+    }
+    s++;
+  }
+  if (s > run) _out.write(run, (size_t)(s - run));
+  _out.write('"');
+}
+
+void JsonWriter::string(const __FlashStringHelper* s) {
+  if (!s) {
+    null();
+    return;
+  }
+
+  _out.write('"');
+  _out.print(s);
+  _out.write('"');
+}
+
+void JsonWriter::endLine() {
+  _out.write("\r\n", 2);
+}
@@ -0,0 +1,69 @@
+#pragma once
+#include <Arduino.h>
+
+/*
+===============================================================================
+  JsonWriter.h
+===============================================================================
+
+  PURPOSE
+  -------
+  Straight-line JSON emitter that writes directly to a Print as it goes.
+  No document tree, no intermediate buffer, no dtostrf/printf.
+
+  Formatting:
+    - Integers: exact decimal
+    - Floats: fixed-point with up to `decimals` fractional digits, trailing
+      zeros trimmed ("12.5", "0", "-3.125"); non-finite values become null
+    - Strings: JSON-escaped (quotes, backslash, control characters)
+
+  Keys are passed as F("...") strings so they stay in flash.
+
+  USAGE
+  -----
+    JsonWriter w(out);
+    w.beginObject();
+    w.key(F("seq")); w.u32(12);
+    w.endObject();
+    w.endLine();
+===============================================================================
+*/
+
+class JsonWriter {
+public:
+  explicit JsonWriter(Print& out) : _out(out) {}
+
+  void beginObject();
+  void endObject();
+
+  void beginArray();
+  void endArray();
+
+  // Writes the separator (if needed) and "key":
+  void key(const __FlashStringHelper* k);
+
+  // Array element separator (call before each element inside an array)
+  void element();
+
+  void u32(uint32_t v);
+  void i32(int32_t v);
+  void number(float v, uint8_t decimals = 3);
+  void boolean(bool b);
+  void null();
+  void string(const char* s);
+  void string(const __FlashStringHelper* s);   // not escaped (flash literals)
+
+  // Terminates the line exactly like Print::println()
+  void endLine();
+
+  Print& out() { return _out; }
+
+private:
+  void separator_();
+
+  Print& _out;
+
+  // Bit n set = container at depth n already has a member (needs ',')
+  uint8_t _has_member = 0;
+  uint8_t _depth = 0;
+};
@@ -9,7 +9,8 @@
   PURPOSE
   -------
   Defines command and telemetry data structures exchanged between
-  Arduino and laptop over newline-delimited JSON.
+  Arduino and laptop over newline-delimited JSON (or the compact binary
+  framing in BinaryProtocol.h).
 
   Must mirror:
     pwc_robot/comms/types.py
@@ -22,6 +23,53 @@
 */
 
 
+/*=============================================================================
+  LINK
+=============================================================================*/
+
+// Wire encoding currently spoken by SerialLink.
+// JSON: {"type": "link", "mode": "json" | "binary"}
+enum class WireMode : uint8_t {
+  JSON = 0,
+  BINARY = 1,
+};
+
+// Telemetry encoding control (JSON wire mode).
+// JSON: {"type": "tlm", "delta": 0 | 1, "keyframe": 1}   (both keys optional)
+struct TelemetryControl {
+  bool delta_present = false;
+  bool delta = false;         // send "tdelta" frames between keyframes
+  bool keyframe = false;      // send a full frame next
+};
+
+// Per-group telemetry subscription. Rates in Hz, 0 = group off.
+// JSON: {"type": "subscribe", "telemetry": Hz, "wheel": Hz, "ultrasonic": Hz,
+//        "mech": Hz, "note": 0 | 1}                     (missing keys = 0)
+// A subscription with everything off restores the boot default (full
+// "telemetry" frames at the wire mode's rate).
+struct TelemetrySubscription {
+  uint16_t telemetry_hz = 0;    // full TelemetryFrame
+  uint16_t wheel_hz = 0;        // WheelState
+  uint16_t ultrasonic_hz = 0;   // UltrasonicState
+  uint16_t mech_hz = 0;         // MechanismState (servo + mech motor angles)
+  bool note = false;            // debug note, sent once each time it changes
+
+  bool any() const {
+    return telemetry_hz || wheel_hz || ultrasonic_hz || mech_hz || note;
+  }
+};
+
+// Small per-group frames sent instead of (or alongside) the full frame.
+// Each carries arduino_time_ms, tel_seq + ack_seq and one part of TelemetryFrame:
+// {"type": "wheel", "arduino_time_ms": ..., "tel_seq": ..., "ack_seq": ..., "left_rpm": ..., ...}
+enum class TelemetryGroup : uint8_t {
+  WHEEL = 0,
+  ULTRASONIC,
+  MECH,
+  NOTE,
+};
+
+
 /*=============================================================================
   COMMAND STRUCTURES (Laptop -> Arduino)
 =============================================================================*/
@@ -58,11 +106,20 @@ struct MechanismCommand {
   bool servo_SWEEP_present = false;
 };
 
-// Full command frame
+// Full command frame. "at_ms" (optional, Arduino millis()) queues it for
+// playback at that time instead of applying it on arrival. "tel_ack"
+// (optional): the newest telemetry tel_seq the host has read, for the
+// link's telemetry credit (see SerialLink.h).
 struct CommandFrame {
   uint32_t seq = 0;
   uint32_t host_time_ms = 0;
 
+  uint32_t at_ms = 0;
+  bool at_present = false;
+
+  uint16_t tel_ack = 0;
+  bool tel_ack_present = false;
+
   DriveCommand drive;
   MechanismCommand mech;
 
@@ -70,6 +127,212 @@ struct CommandFrame {
 };
 
 
+// Clock sync, NTP style (comms/TimeSync). Host stamps are epoch us mod
+// 2^32, the same clock as host_time_ms * 1000; Arduino stamps are micros().
+// {"type": "ping", "id": n, "t1_us": ..., "prev_id": n, "prev_t4_us": ...}
+//   t1_us:      host clock when this ping was sent
+//   prev_*:     host clock (t4) when the pong for ping prev_id arrived, so
+//               the Arduino has that whole exchange one ping later
+//               (prev_id 0 = none, ids start at 1)
+struct PingRequest {
+  uint16_t id = 0;
+  uint32_t t1_us = 0;
+  uint16_t prev_id = 0;
+  uint32_t prev_t4_us = 0;
+};
+
+// Reply to every ping, staged as soon as it is parsed:
+// {"type": "pong", "id": n, "t1_us": ..., "t2_us": ..., "t3_us": ...,
+//  "synced": <bool>, "offset_us": ..., "drift_ppm": ..., "delay_us": ...,
+//  "cmd_latency_us": <int>|null}
+struct PongFrame {
+  uint16_t id = 0;
+  uint32_t t1_us = 0;         // echoed
+  uint32_t t2_us = 0;         // Arduino: ping parsed
+  uint32_t t3_us = 0;         // Arduino: pong staged for TX
+
+  bool synced = false;
+  uint32_t offset_us = 0;     // host - Arduino at t3 (mod 2^32)
+  float drift_ppm = 0.0f;     // host clock rate vs Arduino, parts per million
+  uint32_t delay_us = 0;      // round trip of the last accepted exchange
+
+  // Host send (host_time_ms) -> Arduino parse of the latest command
+  int32_t cmd_latency_us = 0;
+  bool cmd_latency_valid = false;
+};
+
+
+// On-board step sequences (control/Sequencer). One frame runs a whole
+// macro (e.g. a pickup) without a command round trip per step.
+// JSON: {"type": "seq", "run": "pickup" | "stow"}
+//       {"type": "seq", "steps": ["lid", 80, 0, "wait_servos", 0, 6000, ...]}
+//       {"type": "seq", "abort": 1}
+// "steps" is flat (op, arg, timeout_ms) triples in host units (deg, ft/s,
+// deg/s, ft, ms) and runs the uploaded list at once.
+enum class SeqOp : uint8_t {
+  END = 0,
+  LID,            // arg: servo target, tenths of a degree
+  SWEEP,          // arg: servo target, tenths of a degree
+  WAIT_SERVOS,    // until the servo move is done and both are at_target
+  WAIT_MS,        // arg: ms
+  DRIVE,          // arg: linear speed, 0.01 ft/s
+  TURN,           // arg: angular speed, deg/s
+  WAIT_TRAVEL,    // arg: drive distance since this step, 0.01 ft
+};
+
+constexpr uint8_t SEQ_MAX_STEPS = 16;
+
+// timeout_ms applies to the WAIT_* ops: a wait that runs out moves on to
+// the next step (and is counted), 0 = SEQ_DEFAULT_TIMEOUT_MS
+struct SeqStep {
+  uint8_t op = (uint8_t)SeqOp::END;
+  int16_t arg = 0;
+  uint16_t timeout_ms = 0;
+};
+
+// Built-in sequence ids ("run"); UPLOAD is the host's own list
+enum class SeqId : uint8_t {
+  UPLOAD = 0,
+  PICKUP,
+  STOW,
+};
+
+enum class SeqAction : uint8_t {
+  NONE = 0,
+  RUN,            // built-in sequence `id`
+  UPLOAD,         // run steps[0..step_count-1]
+  ABORT,
+};
+
+struct SequenceRequest {
+  SeqAction action = SeqAction::NONE;
+  SeqId id = SeqId::UPLOAD;
+  uint8_t step_count = 0;
+  SeqStep steps[SEQ_MAX_STEPS];
+};
+
+// Sets the on-board odometry pose (sensors/Odometry); missing fields are 0
+// {"type": "pose", "x_ft": ..., "y_ft": ..., "heading_deg": ...}
+struct PoseReset {
+  float x_ft = 0.0f;
+  float y_ft = 0.0f;
+  float heading_deg = 0.0f;
+};
+
+// Path following (control/PathFollower): waypoints in the odometry frame,
+// tracked from the pose at the start (the robot's position is the first
+// point of the first segment). A curve goes up sampled into points.
+// JSON: {"type": "path", "points": [x0, y0, x1, y1, ...], "speed": ft/s,
+//        "lookahead": ft (optional)}
+//       {"type": "path", "abort": 1}
+constexpr uint8_t PATH_MAX_POINTS = 16;
+
+struct PathPoint {
+  float x_ft = 0.0f;
+  float y_ft = 0.0f;
+};
+
+enum class PathAction : uint8_t {
+  NONE = 0,
+  RUN,            // follow points[0..count-1]
+  ABORT,
+};
+
+struct PathRequest {
+  PathAction action = PathAction::NONE;
+  uint8_t count = 0;
+  float speed_ftps = NAN;                    // NAN = PATH_DEFAULT_SPEED_FTPS
+  float lookahead_ft = NAN;                  // NAN = PATH_LOOKAHEAD_FT
+  PathPoint points[PATH_MAX_POINTS];
+};
+
+
+// Runtime tuning (utils/ParamStore). Parameters are addressed by their
+// Params.h name or by registry index (0 .. count-1, for enumerating):
+// {"type": "param", "op": "get", "name": "DRIVE_KP"}
+// {"type": "param", "op": "set", "name": "DRIVE_KP", "value": 1.1}
+// {"type": "param", "op": "get", "index": 3}
+// {"type": "param", "op": "save" | "load" | "defaults"}
+// set stages the value; it goes live before the next control tick. save
+// writes the live set to EEPROM, load / defaults stage the EEPROM image /
+// the Params.h values. Every request gets one "param" reply.
+enum class ParamOp : uint8_t {
+  GET = 0,
+  SET,
+  SAVE,
+  LOAD,
+  DEFAULTS,
+};
+
+constexpr uint8_t PARAM_NAME_BYTES = 24;     // longest name + NUL
+constexpr uint8_t PARAM_BY_NAME = 0xFF;      // index: look the name up
+constexpr uint8_t PARAM_NO_INDEX = 0xFE;     // index: out of range on the wire
+
+struct ParamRequest {
+  ParamOp op = ParamOp::GET;
+  uint8_t index = PARAM_BY_NAME;
+  char name[PARAM_NAME_BYTES] = {};
+  float value = NAN;                         // SET only
+};
+
+enum class ParamStatus : uint8_t {
+  OK = 0,
+  UNKNOWN,        // no parameter with that name / index
+  RANGE,          // value outside [min, max] (or not finite): not staged
+  BUSY,           // an EEPROM save is still being written
+  NO_IMAGE,       // load: no valid EEPROM image
+};
+
+// {"type": "param", "op": "set", "status": "ok", "index": 0, "count": 16,
+//  "name": "DRIVE_KP", "value": 1.1, "min": 0, "max": 10}
+// index / name / value / min / max only for get and set on a known parameter
+struct ParamReply {
+  ParamOp op = ParamOp::GET;
+  ParamStatus status = ParamStatus::OK;
+  uint8_t index = PARAM_NO_INDEX;            // PARAM_NO_INDEX = none
+  uint8_t count = 0;                         // parameters in the registry
+  char name[PARAM_NAME_BYTES] = {};
+  float value = NAN;                         // staged (= live after the next tick)
+  float min = NAN;
+  float max = NAN;
+};
+
+// Built-in test modes, on blocks (control/DriveController step test,
+// control/SysId characterization):
+// {"type": "test", "op": "drive_step" | "sysid_drive" | "sysid_arm",
+//  "value": <duty, optional>}
+// {"type": "test", "op": "abort"}
+// Results come back as a note (sysid also streams its capture, see
+// SysIdChunk); a test needs the host to keep commanding (the watchdogs
+// abort it otherwise).
+enum class TestOp : uint8_t {
+  NONE = 0,
+  DRIVE_STEP,
+  ABORT,
+  SYSID_DRIVE,
+  SYSID_ARM,
+};
+
+struct TestRequest {
+  TestOp op = TestOp::NONE;
+  float value = NAN;                         // NAN = the mode's default
+};
+
+// Event log (utils/EventLog) read-out:
+// {"type": "log", "op": "dump" | "clear"}
+// dump streams the ring as it is now (oldest first, see EventLogChunk);
+// clear empties it
+enum class LogOp : uint8_t {
+  NONE = 0,
+  DUMP,
+  CLEAR,
+};
+
+struct LogRequest {
+  LogOp op = LogOp::NONE;
+};
+
+
 /*=============================================================================
   TELEMETRY STRUCTURES (Arduino -> Laptop)
 =============================================================================*/
@@ -80,6 +343,17 @@ struct WheelState {
   float right_rpm = NAN;
 };
 
+// Dead-reckoned pose (sensors/Odometry), sent with the wheel group:
+// {"x_ft": , "y_ft": , "heading_deg": (-180, 180], "sigma_xy_ft": ,
+//  "sigma_heading_deg": }
+struct PoseState {
+  float x_ft = 0.0f;
+  float y_ft = 0.0f;
+  float heading_deg = 0.0f;      // CCW from the reset heading
+  float sigma_xy_ft = 0.0f;
+  float sigma_heading_deg = 0.0f;
+};
+
 // {"servo_LID_deg": <float>|null, ...}
 struct MechanismState {
   float servo_LID_deg   = NAN;
@@ -89,20 +363,321 @@ struct MechanismState {
   float motor_LHS_deg = NAN;
 };
 
-// {"distance_in": <float>|null, "valid": <bool>}
+// {"distance_in": <float>|null, "valid": <bool>,
+//  "closing_inps": <float>|null, "confidence": <float>, "stop": <bool>}
+// Filtered on board (sensors/RangeFilter); valid = the filter has a track.
+// stop = the on-board obstacle guard is holding forward speed at 0.
 struct UltrasonicState {
   float distance_in = NAN;
+  float closing_inps = NAN;    // in/s, positive = obstacle getting closer
+  float confidence = 0.0f;     // 0..1
   bool  valid = false;
+  bool  obstacle_stop = false;
+};
+
+// Every HC-SR04 of the DistanceSensorArray, filtered like UltrasonicState,
+// as struct-of-arrays (the wire block packs it column by column). Only sent
+// when more than one sensor is fitted:
+// "sonar": {"valid": <mask>, "d": [in|null, ...], "c": [in/s|null, ...],
+//           "q": [0..1, ...]}
+constexpr uint8_t SONAR_MAX_SENSORS = 4;
+
+struct SonarArray {
+  uint8_t count = 0;
+  uint8_t valid_mask = 0;                          // bit i: sensor i has a track
+  float distance_in[SONAR_MAX_SENSORS] = {};       // meaningful if valid
+  float closing_inps[SONAR_MAX_SENSORS] = {};      // positive = getting closer
+  uint8_t confidence[SONAR_MAX_SENSORS] = {};      // 0..255 = 0..1
+  uint32_t updated_ms[SONAR_MAX_SENSORS] = {};     // last published ping
+};
+
+// Drive encoder samples taken by the Timer1 sampler (sensors/EncoderSampler)
+// since the previous batch. Binary wire mode only: appended to the
+// telemetry / wheel packet (see BinaryProtocol.h), never its own frame.
+constexpr uint8_t ENCODER_BATCH_CHANNELS = 2;   // left, right drive
+constexpr uint8_t ENCODER_BATCH_MAX = 16;
+
+struct EncoderSample {
+  uint32_t t_us = 0;                          // micros() in the sampler ISR
+  int32_t count[ENCODER_BATCH_CHANNELS] = {}; // signed accumulated counts
+};
+
+struct EncoderBatch {
+  uint8_t count = 0;          // samples in use (oldest first)
+  uint32_t overflows = 0;     // samples lost to a full ring since boot
+  EncoderSample samples[ENCODER_BATCH_MAX];
+};
+
+// One control/SysId capture sample: SYSID_DECIMATE drive ticks
+struct __attribute__((packed)) SysIdSample {
+  int8_t duty = 0;            // mean duty * 127
+  int16_t delta[2] = {};      // count change per motor (left/LHS, right/RHS)
+};
+
+// A run of capture samples, binary wire mode only (PKT_SYSID frames, sent
+// while the run goes: total is the samples taken so far, and a first past
+// the previous chunk's end means samples were overwritten unsent)
+struct SysIdChunk {
+  uint8_t target = 0;         // SysId::Target
+  uint8_t gen = 0;            // run it belongs to
+  uint8_t period_ms = 0;      // per sample
+  float units_per_count = 0;  // ft (drive) or deg (arm)
+  uint16_t first = 0;
+  uint16_t total = 0;
+  uint8_t count = 0;
+  const SysIdSample* samples = nullptr;
 };
 
 // Full telemetry frame
 struct TelemetryFrame {
   uint32_t arduino_time_ms = 0;
+  uint16_t tel_seq = 0;        // publication counter of the sending link (SerialLink stamps it)
   uint32_t ack_seq = 0;
 
+  // Timed command queue (flow control for at_ms commands)
+  uint8_t queue_depth = 0;
+  uint8_t queue_free = 0;
+
+  // Sample time on the host clock (epoch us mod 2^32) once clock sync has
+  // converged, see PingRequest
+  uint32_t host_time_us = 0;
+  bool host_time_valid = false;
+
   WheelState wheel;
+  PoseState pose;
   MechanismState mech;
   UltrasonicState ultrasonic;
 
   const char* note = nullptr;  // optional debug string
+
+  const EncoderBatch* encoders = nullptr;  // optional, binary wire mode only
+  const SonarArray* sonar = nullptr;       // optional, more than one sensor fitted
+};
+
+
+// Sequencer progress, sent once each time it changes (its own frame, not
+// part of the periodic telemetry):
+// {"type": "seq", "arduino_time_ms": ..., "name": "pickup", "state": "running",
+//  "step": 3, "steps": 11, "timeouts": 0}
+enum class SeqState : uint8_t {
+  IDLE = 0,
+  RUNNING,
+  DONE,
+  ABORTED,
+};
+
+struct SequenceStatus {
+  uint32_t arduino_time_ms = 0;
+  SeqId id = SeqId::UPLOAD;
+  SeqState state = SeqState::IDLE;
+  uint8_t step = 0;           // index of the step in progress (== steps once done)
+  uint8_t steps = 0;
+  uint8_t timeouts = 0;       // waits that ran out in this run
+};
+
+
+/*=============================================================================
+  BOOT (Arduino -> Laptop, once per boot)
+=============================================================================*/
+
+// Sent on each port as soon as it is up, before the actuators, so a host
+// that just opened the port (resetting the board) knows the bootloader is
+// done and can configure the link. Sent again with stage "ready" and the
+// boot timing once the first telemetry frame has been staged:
+// {"type": "hello", "arduino_time_ms": ..., "stage": "link" | "ready",
+//  "fw": 104, "build": "Oct 14 2026 09:12:55", "proto": 1, "features": ...,
+//  "reset_flags": ..., "link_us": ..., "setup_us": ..., "first_tel_us": ...}
+// Times are micros() since the core started (the bootloader before it is
+// not counted); setup_us and first_tel_us are 0 in the "link" hello.
+enum class BootStage : uint8_t {
+  LINK = 0,
+  READY,
+};
+
+// HelloFrame.features: this build's Params.h switches
+constexpr uint16_t FEATURE_ENCODER_SAMPLER = 1u << 0;
+constexpr uint16_t FEATURE_PERF_REPORT     = 1u << 1;
+constexpr uint16_t FEATURE_IDLE_SLEEP      = 1u << 2;
+constexpr uint16_t FEATURE_AUX_LINK        = 1u << 3;
+constexpr uint16_t FEATURE_RX_CAPTURE      = 1u << 4;
+constexpr uint16_t FEATURE_WATCHDOG        = 1u << 5;
+constexpr uint16_t FEATURE_MOTION_PROFILES = 1u << 6;
+constexpr uint16_t FEATURE_BINARY_AT_BOOT  = 1u << 7;
+constexpr uint16_t FEATURE_DELTA_AT_BOOT   = 1u << 8;
+constexpr uint16_t FEATURE_SCOPE_MARKERS   = 1u << 9;
+constexpr uint16_t FEATURE_DRIVE_ISR_LOOP  = 1u << 10;
+
+constexpr uint8_t BUILD_ID_BYTES = 20;   // fits __DATE__ " " __TIME__ (binary: no NUL)
+
+struct HelloFrame {
+  uint32_t arduino_time_ms = 0;
+  BootStage stage = BootStage::LINK;
+  uint16_t fw_version = 0;      // FIRMWARE_VERSION
+  uint16_t features = 0;        // FEATURE_* bits
+  uint8_t reset_flags = 0;      // MCUSR at reset (utils/Watchdog classifies it)
+  const char* build = "";       // build stamp (main.cpp's compile time)
+  uint32_t link_us = 0;         // hello staged on the USB link
+  uint32_t setup_us = 0;        // setup() start to end
+  uint32_t first_tel_us = 0;    // first telemetry frame staged
+};
+
+
+/*=============================================================================
+  EVENT LOG (Arduino -> Laptop, on request)
+=============================================================================*/
+
+// What happened, for the post-mortem (utils/EventLog). Wire values: append
+// only. Args (a, b) per id:
+enum class EventId : uint8_t {
+  NONE = 0,
+  BOOT,             // MCUSR at reset, FIRMWARE_VERSION
+  CMD_APPLIED,      // seq (low 16 bits), ms past its at_ms (0 = untimed)
+  WATCHDOG_STALE,   // channel, trips since boot
+  WATCHDOG_FED,     // channel back after a trip, -
+  SERVO_DETACH,     // pin, position (0.1 deg)
+  SERVO_ATTACH,     // pin, position (0.1 deg)
+  RX_OVERFLOW,      // bytes, port (0 = command port, 1 = telemetry-only)
+  RX_FAIL,          // bytes, port
+  TX_DROP,          // bytes still staged, port
+  LINK_MODE,        // WireMode, port
+  OBSTACLE_STOP,    // nearest (0.1 in), time to collision (ms, 32767 = none)
+  OBSTACLE_CLEAR,   // nearest (0.1 in, -1 = no track), -
+  SEQ_START,        // SeqId, steps
+  SEQ_END,          // SeqState, step
+  TEST_START,       // TestOp, value (1e-3, 0 = default)
+  PATH_START,       // points, speed (0.01 ft/s)
+  PATH_END,         // PathFollower::State, distance left to the goal (0.01 ft)
+  DRIVE_ISR_STALE,  // stale trips since boot, - (logged once the drive task runs again)
+};
+
+// One record. Repeats of the newest record's id fold into it: t_ms stays
+// the first one's, count goes up (255 at most, the next one starts a new
+// record) and a, b are the latest.
+struct __attribute__((packed)) EventRecord {
+  uint32_t t_ms = 0;          // millis()
+  uint8_t id = 0;             // EventId
+  uint8_t count = 0;          // occurrences folded in (>= 1)
+  int16_t a = 0;
+  int16_t b = 0;
+};
+
+// A run of records, binary wire mode only (PKT_EVENT_LOG frames). Records
+// are numbered from boot mod 2^16; a dump covers [first of the first
+// chunk, end) and is over with the chunk that reaches end. A number
+// missing between chunks was overwritten before it went out.
+struct EventLogChunk {
+  uint16_t first = 0;         // number of records[0]
+  uint16_t end = 0;           // one past the last record of the dump
+  uint8_t count = 0;
+  const EventRecord* records = nullptr;
+};
+
+
+/*=============================================================================
+  DIAGNOSTICS (Arduino -> Laptop, low rate)
+=============================================================================*/
+
+// Per-task timing (one Profiler window)
+// {"name": "rx", "runs": ..., "overruns": ..., "min_us": ..., "max_us": ...,
+//  "mean_us": ..., "p99_us": ...}
+struct TaskPerf {
+  const __FlashStringHelper* name = nullptr;
+  uint32_t runs = 0;        // runs in this window
+  uint32_t overruns = 0;    // missed releases since boot
+  uint32_t min_us = 0;
+  uint32_t max_us = 0;
+  uint32_t mean_us = 0;
+  uint32_t p99_us = 0;
+};
+
+// Main loop period over the window
+// {"n": ..., "min_us": ..., "max_us": ..., "mean_us": ..., "jitter_us": ..., "idle_permille": ...}
+struct LoopPerf {
+  uint32_t count = 0;
+  uint32_t min_us = 0;
+  uint32_t max_us = 0;      // worst-case loop latency
+  uint32_t mean_us = 0;
+  uint32_t jitter_us = 0;   // max - min
+  uint16_t idle_permille = 0;   // share of the window asleep (utils/PowerSaver)
+};
+
+// SRAM use in bytes (utils/StackMonitor); the peaks are since reset
+// {"static": ..., "stack_peak": ..., "free_min": ..., "free_now": ...}
+struct MemPerf {
+  uint16_t static_bytes = 0;      // .data + .bss + .noinit
+  uint16_t stack_peak = 0;        // deepest stack, ISRs included
+  uint16_t free_min = 0;          // never-touched gap between statics and stack
+  uint16_t free_now = 0;          // gap at the stack pointer now
+};
+
+// Servo hold policy over the window (actuators/ServoPair)
+// {"attached": ..., "active_permille": ..., "isr_ppm": ..., "detaches": ...}
+struct ServoPerf {
+  uint8_t attached = 0;           // now
+  uint16_t active_permille = 0;   // share of the window the Servo timer ran
+  uint16_t isr_ppm = 0;           // estimated share spent in its ISR
+  uint16_t detaches = 0;          // by the hold policy, since boot
+};
+
+constexpr uint8_t PERF_MAX_TASKS = 9;
+
+// {"type": "perf", "arduino_time_ms": ..., "window_ms": ..., "loop": {...}, "mem": {...},
+//  "servo": {...}, "tasks": [...]}
+struct PerfFrame {
+  uint32_t arduino_time_ms = 0;
+  uint32_t window_ms = 0;
+
+  LoopPerf loop;
+  MemPerf mem;
+  ServoPerf servo;
+
+  uint8_t task_count = 0;
+  TaskPerf tasks[PERF_MAX_TASKS];
+};
+
+// Command inter-arrival jitter: bin b counts commands whose gap differed
+// from the running mean gap by [2^(b-1), 2^b) ms (bin 0: < 1 ms, last
+// bin: >= 64 ms)
+constexpr uint8_t LINK_JITTER_BINS = 8;
+
+// Link quality, follows each perf frame. Counters are since boot; the
+// parse, inter-arrival and RX high-water figures cover one window.
+// {"type": "linkstats", "arduino_time_ms": ..., "window_ms": ...,
+//  "frames": ..., "ok": ..., "fail": ..., "ovf": ..., "max_frame": ...,
+//  "seq_gaps": ..., "seq_stale": ..., "rx_hwm": ...,
+//  "tel": {"held": ..., "unread_max": ...},
+//  "parse": {"n": ..., "min_us": ..., "max_us": ..., "mean_us": ...},
+//  "cmd": {"n": ..., "min_us": ..., "max_us": ..., "mean_us": ..., "jitter_hist": [...]}}
+struct LinkStatsFrame {
+  uint32_t arduino_time_ms = 0;
+  uint32_t window_ms = 0;
+
+  uint32_t frames = 0;          // RX frames (lines), including failures
+  uint32_t ok = 0;
+  uint32_t fail = 0;
+  uint32_t overflow = 0;
+  uint16_t max_frame_bytes = 0;
+
+  uint32_t seq_gaps = 0;        // commands missing from the seq stream (dropped)
+  uint32_t seq_stale = 0;       // repeated or out-of-order seq
+
+  uint16_t rx_high_water = 0;   // most RX bytes waiting at one tick
+
+  // Telemetry credit (host tel_ack): publications held back since boot,
+  // and the most sent but not yet read by the host in this window
+  uint32_t tel_held = 0;
+  uint16_t tel_unread_max = 0;
+
+  // RX processing per frame: parse + handling (us)
+  uint32_t parse_count = 0;
+  uint32_t parse_min_us = 0;
+  uint32_t parse_max_us = 0;
+  uint32_t parse_mean_us = 0;
+
+  // Time between accepted commands (us)
+  uint32_t cmd_count = 0;
+  uint32_t gap_min_us = 0;
+  uint32_t gap_max_us = 0;
+  uint32_t gap_mean_us = 0;
+  uint16_t jitter_hist[LINK_JITTER_BINS] = {};
 };
@@ -1,6 +1,9 @@
 #include "comms/Protocol.h"
 #include <math.h>
 #include "Params.h"
+#include "comms/CommandParser.h"
+#include "comms/JsonWriter.h"
+#include "comms/Schema.h"
 
 /*
 ===============================================================================
@@ -14,169 +17,457 @@
   Wire format:
     - One JSON object per line
     - Laptop -> Arduino: type="cmd"
-    - Arduino -> Laptop: type="telemetry"
+    - Arduino -> Laptop: type="telemetry", type="perf" (low-rate diagnostics),
+      per-group "wheel" / "ultrasonic" / "mech" / "note" once subscribed,
+      type="seq" when the sequencer's progress changes, type="pong" per ping,
+      type="linkstats" after each perf frame
 
   Notes:
-  - Telemetry encoding uses simple Serial/Print printing.
-  - Command decoding uses ArduinoJson for safe parsing.
+  - Telemetry encoding streams fields straight to the Print via JsonWriter
+    (no intermediate document, fixed-point float formatting).
+  - The group values (wheel speeds, mech angles, ultrasonic range) are
+    expanded from comms/Schema.h, so the JSON keys are the binary field
+    names.
+  - Command decoding uses the zero-allocation CommandParser.
 ===============================================================================
 */
 
-#include <ArduinoJson.h>
 #include <string.h>
 
 
+namespace protocol {
+
 /*=============================================================================
-  SMALL HELPERS
+  ENCODE (Arduino -> Laptop)
 =============================================================================*/
 
-// Convert mode string -> enum
-static MechMotorMode parseMode(const char* s) {
-  if (!s) return MechMotorMode::UNKNOWN;
-  if (strcmp(s, "POS_DEG") == 0) return MechMotorMode::POS_DEG;
-  if (strcmp(s, "DUTY") == 0)    return MechMotorMode::DUTY;
-  return MechMotorMode::UNKNOWN;
+// One schema value: "<name>": <number> (non-finite -> null)
+static void writeValue(JsonWriter& w, const __FlashStringHelper* k, float v, uint8_t decimals) {
+  w.key(k);
+  w.number(v, decimals);
 }
 
+template <class T>
+static void writeValue(JsonWriter& w, const __FlashStringHelper* k, T v, uint8_t) {
+  w.key(k);
+  if ((T)-1 < (T)0) w.i32((int32_t)v);
+  else              w.u32((uint32_t)v);
+}
 
-namespace protocol {
+// V(...) of a PWC_VAL_* list; needs JsonWriter `w` and TelemetryFrame `t`
+#define WRITE_VALUE_(type, name, src, decimals, eps) writeValue(w, F(#name), (type)(src), decimals);
 
-/*=============================================================================
-  ENCODE (Arduino -> Laptop)
-=============================================================================*/
+// "host_time_us": <u32> | null (clock sync not converged yet)
+static void writeHostTime(JsonWriter& w, const TelemetryFrame& t) {
+  w.key(F("host_time_us"));
+  if (t.host_time_valid) w.u32(t.host_time_us);
+  else                   w.null();
+}
 
-void encodeTelemetryLine(const TelemetryFrame& t, Print& out) {
-  StaticJsonDocument<1024> doc;
+// "pose": {...} (odometry, rides with the wheel data)
+static void writePose(JsonWriter& w, const PoseState& p) {
+  w.key(F("pose"));
+  w.beginObject();
+  w.key(F("x_ft"));              w.number(p.x_ft);
+  w.key(F("y_ft"));              w.number(p.y_ft);
+  w.key(F("heading_deg"));       w.number(p.heading_deg, 2);
+  w.key(F("sigma_xy_ft"));       w.number(p.sigma_xy_ft);
+  w.key(F("sigma_heading_deg")); w.number(p.sigma_heading_deg, 2);
+  w.endObject();
+}
+
+void writeSonarArray(JsonWriter& w, const SonarArray& a) {
+  const uint8_t n = (a.count < SONAR_MAX_SENSORS) ? a.count : SONAR_MAX_SENSORS;
+
+  w.key(F("sonar"));
+  w.beginObject();
+  w.key(F("valid")); w.u32(a.valid_mask);
 
-  doc["type"] = "telemetry";
-  doc["arduino_time_ms"] = t.arduino_time_ms;
-  doc["ack_seq"] = t.ack_seq;
+  w.key(F("d"));
+  w.beginArray();
+  for (uint8_t i = 0; i < n; i++) {
+    w.element();
+    if (a.valid_mask & (1u << i)) w.number(a.distance_in[i], 2);
+    else                          w.null();
+  }
+  w.endArray();
+
+  w.key(F("c"));
+  w.beginArray();
+  for (uint8_t i = 0; i < n; i++) {
+    w.element();
+    if (a.valid_mask & (1u << i)) w.number(a.closing_inps[i], 1);
+    else                          w.null();
+  }
+  w.endArray();
+
+  w.key(F("q"));
+  w.beginArray();
+  for (uint8_t i = 0; i < n; i++) {
+    w.element();
+    w.number((float)a.confidence[i] * (1.0f / 255.0f), 2);
+  }
+  w.endArray();
+
+  w.endObject();
+}
 
-  // wheel
-  JsonObject wheel = doc.createNestedObject("wheel");
-  if (isfinite(t.wheel.left_rpm))
-    wheel["left_rpm"] = t.wheel.left_rpm;
-  else
-    wheel["left_rpm"] = nullptr;
+static void writeTelemetry(const TelemetryFrame& t, Print& out, const uint32_t* frame) {
+  JsonWriter w(out);
 
-  if (isfinite(t.wheel.right_rpm))
-    wheel["right_rpm"] = t.wheel.right_rpm;
-  else
-    wheel["right_rpm"] = nullptr;
+  w.beginObject();
+
+  w.key(F("type"));            w.string("telemetry");
+  if (frame) {
+    w.key(F("frame"));         w.u32(*frame);
+  }
+  w.key(F("arduino_time_ms")); w.u32(t.arduino_time_ms);
+  writeHostTime(w, t);
+  w.key(F("tel_seq"));         w.u32(t.tel_seq);
+  w.key(F("ack_seq"));         w.u32(t.ack_seq);
+  w.key(F("queue_depth"));     w.u32(t.queue_depth);
+  w.key(F("queue_free"));      w.u32(t.queue_free);
+
+  // wheel (non-finite -> null)
+  w.key(F("wheel"));
+  w.beginObject();
+  PWC_VAL_Wheel(WRITE_VALUE_)
+  w.endObject();
+  writePose(w, t.pose);
 
   // mech
-  JsonObject mech = doc.createNestedObject("mech");
-
-  if (isfinite(t.mech.servo_LID_deg))    
-    mech["servo_LID_deg"] = t.mech.servo_LID_deg;
-  else                                  
-    mech["servo_LID_deg"] = nullptr;
-
-  if (isfinite(t.mech.servo_SWEEP_deg))  
-    mech["servo_SWEEP_deg"] = t.mech.servo_SWEEP_deg;
-  else                                  
-    mech["servo_SWEEP_deg"] = nullptr;
-  if (isfinite(t.mech.motor_RHS_deg))    
-    mech["motor_RHS_deg"] = t.mech.motor_RHS_deg;
-  else                                  
-    mech["motor_RHS_deg"] = nullptr;
-
-  if (isfinite(t.mech.motor_LHS_deg))    
-    mech["motor_LHS_deg"] = t.mech.motor_LHS_deg;
-  else                                  
-    mech["motor_LHS_deg"] = nullptr;
+  w.key(F("mech"));
+  w.beginObject();
+  PWC_VAL_Mech(WRITE_VALUE_)
+  w.endObject();
 
   // ultrasonic
-  JsonObject us = doc.createNestedObject("ultrasonic");
-  us["valid"] = t.ultrasonic.valid;
-
-  if (t.ultrasonic.valid && isfinite(t.ultrasonic.distance_in)) 
-    us["distance_in"] = t.ultrasonic.distance_in;
-  else                                                          
-    us["distance_in"] = nullptr;
+  w.key(F("ultrasonic"));
+  w.beginObject();
+  w.key(F("valid")); w.boolean(t.ultrasonic.valid);
+  PWC_VAL_Range(WRITE_VALUE_)
+  w.key(F("confidence")); w.number(t.ultrasonic.confidence);
+  w.key(F("stop")); w.boolean(t.ultrasonic.obstacle_stop);
+  w.endObject();
+  if (t.sonar) writeSonarArray(w, *t.sonar);
 
   // note
-  if (t.note)
-    doc["note"] = t.note;
-  else
-    doc["note"] = nullptr;
+  w.key(F("note")); w.string(t.note);
 
-  serializeJson(doc, out);
-  out.println();
+  w.endObject();
+  w.endLine();
 }
 
+void encodeTelemetryLine(const TelemetryFrame& t, Print& out) {
+  writeTelemetry(t, out, nullptr);
+}
 
-/*=============================================================================
-  DECODE (Laptop -> Arduino)
-=============================================================================*/
+void encodeTelemetryLine(const TelemetryFrame& t, Print& out, uint32_t frame) {
+  writeTelemetry(t, out, &frame);
+}
 
-bool decodeCommandLine(const char* line, CommandFrame& out_cmd) {
-  out_cmd = CommandFrame();
-  if (!line) return false;
+void encodeGroupLine(TelemetryGroup g, const TelemetryFrame& t, Print& out) {
+  JsonWriter w(out);
+
+  w.beginObject();
+
+  w.key(F("type"));
+  switch (g) {
+    case TelemetryGroup::WHEEL:      w.string("wheel");      break;
+    case TelemetryGroup::ULTRASONIC: w.string("ultrasonic"); break;
+    case TelemetryGroup::MECH:       w.string("mech");       break;
+    case TelemetryGroup::NOTE:       w.string("note");       break;
+  }
+  w.key(F("arduino_time_ms")); w.u32(t.arduino_time_ms);
+  writeHostTime(w, t);
+  w.key(F("tel_seq"));         w.u32(t.tel_seq);
+  w.key(F("ack_seq"));         w.u32(t.ack_seq);
+  w.key(F("queue_depth"));     w.u32(t.queue_depth);
+  w.key(F("queue_free"));      w.u32(t.queue_free);
+
+  // Group fields sit at the top level (same names as the nested objects
+  // in a full telemetry frame)
+  switch (g) {
+    case TelemetryGroup::WHEEL:
+      PWC_VAL_Wheel(WRITE_VALUE_)
+      writePose(w, t.pose);
+      break;
+
+    case TelemetryGroup::ULTRASONIC:
+      w.key(F("valid")); w.boolean(t.ultrasonic.valid);
+      PWC_VAL_Range(WRITE_VALUE_)
+      w.key(F("confidence")); w.number(t.ultrasonic.confidence);
+      w.key(F("stop")); w.boolean(t.ultrasonic.obstacle_stop);
+      if (t.sonar) writeSonarArray(w, *t.sonar);
+      break;
+
+    case TelemetryGroup::MECH:
+      PWC_VAL_Mech(WRITE_VALUE_)
+      break;
+
+    case TelemetryGroup::NOTE:
+      w.key(F("note")); w.string(t.note);
+      break;
+  }
+
+  w.endObject();
+  w.endLine();
+}
 
-  StaticJsonDocument<SERIAL_JSON_DOC_BYTES> doc;  // define SERIAL_JSON_DOC_BYTES in Params.h
+void encodePerfLine(const PerfFrame& p, Print& out) {
+  JsonWriter w(out);
+
+  w.beginObject();
+
+  w.key(F("type"));            w.string("perf");
+  w.key(F("arduino_time_ms")); w.u32(p.arduino_time_ms);
+  w.key(F("window_ms"));       w.u32(p.window_ms);
+
+  w.key(F("loop"));
+  w.beginObject();
+  w.key(F("n"));         w.u32(p.loop.count);
+  w.key(F("min_us"));    w.u32(p.loop.min_us);
+  w.key(F("max_us"));    w.u32(p.loop.max_us);
+  w.key(F("mean_us"));   w.u32(p.loop.mean_us);
+  w.key(F("jitter_us")); w.u32(p.loop.jitter_us);
+  w.key(F("idle_permille")); w.u32(p.loop.idle_permille);
+  w.endObject();
+
+  w.key(F("mem"));
+  w.beginObject();
+  w.key(F("static"));     w.u32(p.mem.static_bytes);
+  w.key(F("stack_peak")); w.u32(p.mem.stack_peak);
+  w.key(F("free_min"));   w.u32(p.mem.free_min);
+  w.key(F("free_now"));   w.u32(p.mem.free_now);
+  w.endObject();
+
+  w.key(F("servo"));
+  w.beginObject();
+  w.key(F("attached"));        w.u32(p.servo.attached);
+  w.key(F("active_permille")); w.u32(p.servo.active_permille);
+  w.key(F("isr_ppm"));         w.u32(p.servo.isr_ppm);
+  w.key(F("detaches"));        w.u32(p.servo.detaches);
+  w.endObject();
+
+  w.key(F("tasks"));
+  w.beginArray();
+  for (uint8_t i = 0; i < p.task_count && i < PERF_MAX_TASKS; i++) {
+    const TaskPerf& tp = p.tasks[i];
+    w.element();
+    w.beginObject();
+    w.key(F("name"));     w.string(tp.name);
+    w.key(F("runs"));     w.u32(tp.runs);
+    w.key(F("overruns")); w.u32(tp.overruns);
+    w.key(F("min_us"));   w.u32(tp.min_us);
+    w.key(F("max_us"));   w.u32(tp.max_us);
+    w.key(F("mean_us"));  w.u32(tp.mean_us);
+    w.key(F("p99_us"));   w.u32(tp.p99_us);
+    w.endObject();
+  }
+  w.endArray();
+
+  w.endObject();
+  w.endLine();
+}
 
-  DeserializationError err = deserializeJson(doc, line);
-  if (err) {
-    // Optional: stash reason somewhere global if you want,
-    // but easiest is to just fail and let SerialLink print the head/len.
-    return false;
+
+void encodeLinkStatsLine(const LinkStatsFrame& s, Print& out) {
+  JsonWriter w(out);
+
+  w.beginObject();
+
+  w.key(F("type"));            w.string("linkstats");
+  w.key(F("arduino_time_ms")); w.u32(s.arduino_time_ms);
+  w.key(F("window_ms"));       w.u32(s.window_ms);
+
+  w.key(F("frames"));    w.u32(s.frames);
+  w.key(F("ok"));        w.u32(s.ok);
+  w.key(F("fail"));      w.u32(s.fail);
+  w.key(F("ovf"));       w.u32(s.overflow);
+  w.key(F("max_frame")); w.u32(s.max_frame_bytes);
+  w.key(F("seq_gaps"));  w.u32(s.seq_gaps);
+  w.key(F("seq_stale")); w.u32(s.seq_stale);
+  w.key(F("rx_hwm"));    w.u32(s.rx_high_water);
+
+  w.key(F("tel"));
+  w.beginObject();
+  w.key(F("held"));       w.u32(s.tel_held);
+  w.key(F("unread_max")); w.u32(s.tel_unread_max);
+  w.endObject();
+
+  w.key(F("parse"));
+  w.beginObject();
+  w.key(F("n"));       w.u32(s.parse_count);
+  w.key(F("min_us"));  w.u32(s.parse_min_us);
+  w.key(F("max_us"));  w.u32(s.parse_max_us);
+  w.key(F("mean_us")); w.u32(s.parse_mean_us);
+  w.endObject();
+
+  w.key(F("cmd"));
+  w.beginObject();
+  w.key(F("n"));       w.u32(s.cmd_count);
+  w.key(F("min_us"));  w.u32(s.gap_min_us);
+  w.key(F("max_us"));  w.u32(s.gap_max_us);
+  w.key(F("mean_us")); w.u32(s.gap_mean_us);
+  w.key(F("jitter_hist"));
+  w.beginArray();
+  for (uint8_t b = 0; b < LINK_JITTER_BINS; b++) {
+    w.element();
+    w.u32(s.jitter_hist[b]);
   }
+  w.endArray();
+  w.endObject();
+
+  w.endObject();
+  w.endLine();
+}
 
-  JsonObject obj = doc.as<JsonObject>();
-  if (obj.isNull()) return false;
 
-  const char* type = obj["type"];
-  if (!type || strcmp(type, "cmd") != 0) return false;
+void encodeSequenceLine(const SequenceStatus& s, Print& out) {
+  JsonWriter w(out);
 
-  if (!obj.containsKey("seq")) return false;
-  if (!obj.containsKey("host_time_ms")) return false;
-  if (!obj.containsKey("drive")) return false;
-  if (!obj.containsKey("mech")) return false;
+  w.beginObject();
 
-  out_cmd.seq = obj["seq"].as<uint32_t>();
-  out_cmd.host_time_ms = obj["host_time_ms"].as<uint32_t>();
+  w.key(F("type"));            w.string("seq");
+  w.key(F("arduino_time_ms")); w.u32(s.arduino_time_ms);
 
-  JsonObject drive = obj["drive"].as<JsonObject>();
-  if (drive.isNull()) return false;
+  w.key(F("name"));
+  switch (s.id) {
+    case SeqId::UPLOAD: w.string("upload"); break;
+    case SeqId::PICKUP: w.string("pickup"); break;
+    case SeqId::STOW:   w.string("stow");   break;
+  }
 
-  out_cmd.drive.linear_ftps = drive["linear"] | 0.0f;
-  out_cmd.drive.angular_dps = drive["angular"] | 0.0f;
+  w.key(F("state"));
+  switch (s.state) {
+    case SeqState::IDLE:    w.string("idle");    break;
+    case SeqState::RUNNING: w.string("running"); break;
+    case SeqState::DONE:    w.string("done");    break;
+    case SeqState::ABORTED: w.string("aborted"); break;
+  }
 
-  JsonObject mech = obj["mech"].as<JsonObject>();
-  if (mech.isNull()) return false;
+  w.key(F("step"));     w.u32(s.step);
+  w.key(F("steps"));    w.u32(s.steps);
+  w.key(F("timeouts")); w.u32(s.timeouts);
+
+  w.endObject();
+  w.endLine();
+}
 
-  if (!mech["servo_LID_deg"].isNull()) {
-    out_cmd.mech.servo_LID_deg = mech["servo_LID_deg"] | 0.0f;
-    out_cmd.mech.servo_LID_present = true;
+void encodePongLine(const PongFrame& p, Print& out) {
+  JsonWriter w(out);
+
+  w.beginObject();
+
+  w.key(F("type"));      w.string("pong");
+  w.key(F("id"));        w.u32(p.id);
+  w.key(F("t1_us"));     w.u32(p.t1_us);
+  w.key(F("t2_us"));     w.u32(p.t2_us);
+  w.key(F("t3_us"));     w.u32(p.t3_us);
+  w.key(F("synced"));    w.boolean(p.synced);
+  w.key(F("offset_us")); w.u32(p.offset_us);
+  w.key(F("drift_ppm")); w.number(p.drift_ppm, 2);
+  w.key(F("delay_us"));  w.u32(p.delay_us);
+  w.key(F("cmd_latency_us"));
+  if (p.cmd_latency_valid) w.i32(p.cmd_latency_us);
+  else                     w.null();
+
+  w.endObject();
+  w.endLine();
+}
+
+void encodeParamLine(const ParamReply& r, Print& out) {
+  JsonWriter w(out);
+
+  w.beginObject();
+
+  w.key(F("type")); w.string("param");
+
+  w.key(F("op"));
+  switch (r.op) {
+    case ParamOp::GET:      w.string("get");      break;
+    case ParamOp::SET:      w.string("set");      break;
+    case ParamOp::SAVE:     w.string("save");     break;
+    case ParamOp::LOAD:     w.string("load");     break;
+    case ParamOp::DEFAULTS: w.string("defaults"); break;
   }
 
-  if (!mech["servo_SWEEP_deg"].isNull()) {
-    out_cmd.mech.servo_SWEEP_deg = mech["servo_SWEEP_deg"] | 0.0f;
-    out_cmd.mech.servo_SWEEP_present = true;
+  w.key(F("status"));
+  switch (r.status) {
+    case ParamStatus::OK:       w.string("ok");       break;
+    case ParamStatus::UNKNOWN:  w.string("unknown");  break;
+    case ParamStatus::RANGE:    w.string("range");    break;
+    case ParamStatus::BUSY:     w.string("busy");     break;
+    case ParamStatus::NO_IMAGE: w.string("no_image"); break;
   }
 
-  if (!mech["motor_RHS"].isNull()) {
-    JsonObject m = mech["motor_RHS"].as<JsonObject>();
-    MechMotorMode mode = parseMode(m["mode"]);
-    if (mode != MechMotorMode::UNKNOWN) {
-      out_cmd.mech.motor_RHS.mode = mode;
-      out_cmd.mech.motor_RHS.value = m["value"] | 0.0f;
-      out_cmd.mech.motor_RHS.present = true;
-    }
+  w.key(F("count")); w.u32(r.count);
+
+  if (r.index != PARAM_NO_INDEX) {
+    w.key(F("index")); w.u32(r.index);
+    w.key(F("name"));  w.string(r.name);
+    w.key(F("value")); w.number(r.value, 4);
+    w.key(F("min"));   w.number(r.min, 4);
+    w.key(F("max"));   w.number(r.max, 4);
   }
 
-  if (!mech["motor_LHS"].isNull()) {
-    JsonObject m = mech["motor_LHS"].as<JsonObject>();
-    MechMotorMode mode = parseMode(m["mode"]);
-    if (mode != MechMotorMode::UNKNOWN) {
-      out_cmd.mech.motor_LHS.mode = mode;
-      out_cmd.mech.motor_LHS.value = m["value"] | 0.0f;
-      out_cmd.mech.motor_LHS.present = true;
-    }
+  w.endObject();
+  w.endLine();
+}
+
+void encodeHelloLine(const HelloFrame& h, Print& out) {
+  JsonWriter w(out);
+
+  w.beginObject();
+
+  w.key(F("type"));            w.string("hello");
+  w.key(F("arduino_time_ms")); w.u32(h.arduino_time_ms);
+  w.key(F("stage"));           w.string(h.stage == BootStage::READY ? "ready" : "link");
+  w.key(F("fw"));              w.u32(h.fw_version);
+  w.key(F("build"));           w.string(h.build);
+  w.key(F("proto"));           w.u32(bin::PROTOCOL_VERSION);
+  w.key(F("features"));        w.u32(h.features);
+  w.key(F("reset_flags"));     w.u32(h.reset_flags);
+  w.key(F("link_us"));         w.u32(h.link_us);
+  w.key(F("setup_us"));        w.u32(h.setup_us);
+  w.key(F("first_tel_us"));    w.u32(h.first_tel_us);
+
+  w.endObject();
+  w.endLine();
+}
+
+
+/*=============================================================================
+  DECODE (Laptop -> Arduino)
+=============================================================================*/
+
+// Runs a complete line through the streaming parser (the RX path feeds
+// CommandParser directly; these helpers exist for tools and one-off lines).
+static CommandParser::Result parseLine(const char* line, CommandParser& parser) {
+  while (*line && *line != '\n') {
+    parser.feed(*line++);
   }
+  return parser.feed('\n');
+}
+
+bool decodeCommandLine(const char* line, CommandFrame& out_cmd) {
+  out_cmd = CommandFrame();
+  if (!line) return false;
+
+  CommandParser parser(SERIAL_LINE_MAX_BYTES);
+  if (parseLine(line, parser) != CommandParser::Result::COMMAND) return false;
+
+  out_cmd = parser.command();
+  return true;
+}
+
+bool decodeLinkLine(const char* line, WireMode& out_mode) {
+  if (!line) return false;
+
+  CommandParser parser(SERIAL_LINE_MAX_BYTES);
+  if (parseLine(line, parser) != CommandParser::Result::LINK) return false;
 
-  out_cmd.valid = true;
+  out_mode = parser.linkMode();
   return true;
 }
 
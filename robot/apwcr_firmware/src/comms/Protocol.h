@@ -3,6 +3,8 @@
 
 #include "comms/Messages.h"
 
+class JsonWriter;
+
 /*
 ===============================================================================
   Protocol.h
@@ -29,6 +31,34 @@ namespace protocol {
 // Writes one telemetry JSON line (includes trailing '\n')
 void encodeTelemetryLine(const TelemetryFrame& t, Print& out);
 
+// Same, plus "frame": <counter> (a keyframe in delta mode, see TelemetryDelta)
+void encodeTelemetryLine(const TelemetryFrame& t, Print& out, uint32_t frame);
+
+// Writes one per-group frame ("wheel", "ultrasonic", "mech" or "note")
+// carrying only that part of t (includes trailing '\n')
+void encodeGroupLine(TelemetryGroup g, const TelemetryFrame& t, Print& out);
+
+// Writes "sonar": {...} (see SonarArray) into the object w is inside
+void writeSonarArray(JsonWriter& w, const SonarArray& a);
+
+// Writes one "perf" diagnostics JSON line (includes trailing '\n')
+void encodePerfLine(const PerfFrame& p, Print& out);
+
+// Writes one "linkstats" link quality JSON line (includes trailing '\n')
+void encodeLinkStatsLine(const LinkStatsFrame& s, Print& out);
+
+// Writes one "seq" sequencer status JSON line (includes trailing '\n')
+void encodeSequenceLine(const SequenceStatus& s, Print& out);
+
+// Writes one "pong" clock sync reply JSON line (includes trailing '\n')
+void encodePongLine(const PongFrame& p, Print& out);
+
+// Writes one "param" reply JSON line (includes trailing '\n')
+void encodeParamLine(const ParamReply& r, Print& out);
+
+// Writes one "hello" boot JSON line (includes trailing '\n')
+void encodeHelloLine(const HelloFrame& h, Print& out);
+
 
 /*=============================================================================
   DECODE (Laptop -> Arduino)
@@ -43,4 +73,14 @@ void encodeTelemetryLine(const TelemetryFrame& t, Print& out);
 */
 bool decodeCommandLine(const char* line, CommandFrame& out_cmd);
 
+/*
+  Attempts to parse one link-control JSON line:
+    {"type": "link", "mode": "json" | "binary"}
+
+  Returns:
+    - true if decoded into out_mode
+    - false if not a link frame or parse failed
+*/
+bool decodeLinkLine(const char* line, WireMode& out_mode);
+
 }  // namespace protocol
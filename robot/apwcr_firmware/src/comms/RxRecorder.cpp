@@ -0,0 +1,46 @@
+#include "comms/RxRecorder.h"
+
+#include "comms/BinaryProtocol.h"
+
+/*
+===============================================================================
+  RxRecorder.cpp
+===============================================================================
+*/
+
+static_assert(RX_CAPTURE_CHUNK_BYTES > 0, "RX_CAPTURE_CHUNK_BYTES must be > 0");
+
+int RxRecorder::read() {
+  const int c = _port.read();
+  if (c >= 0) {
+    const uint8_t b = (uint8_t)c;
+    record_(&b, 1);
+  }
+  return c;
+}
+
+size_t RxRecorder::peekBuffer(const uint8_t*& data) {
+  _run_len = _port.peekBuffer(data);
+  _run = data;
+  return _run_len;
+}
+
+void RxRecorder::consume(size_t n) {
+  record_(_run, (n < _run_len) ? n : _run_len);
+  _run = nullptr;
+  _run_len = 0;
+  _port.consume(n);
+}
+
+void RxRecorder::record_(const uint8_t* data, size_t n) {
+  const uint32_t t_us = micros();
+
+  while (n > 0) {
+    const size_t len = (n < RX_CAPTURE_CHUNK_BYTES) ? n : RX_CAPTURE_CHUNK_BYTES;
+    protocol::bin::encodeRxCaptureFrame(t_us, _seq++, data, len, _sink);
+    _records++;
+    _bytes += len;
+    data += len;
+    n -= len;
+  }
+}
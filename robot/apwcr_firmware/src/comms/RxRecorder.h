@@ -0,0 +1,75 @@
+#pragma once
+#include <Arduino.h>
+
+#include "Params.h"
+#include "comms/BulkStream.h"
+
+/*
+===============================================================================
+  RxRecorder.h
+===============================================================================
+
+  PURPOSE
+  -------
+  Field capture of what the link actually received, for offline replay.
+  Sits between SerialLink and its port as a BulkStream: everything passes
+  straight through, and every run SerialLink consumes is also written to
+  a sink as PKT_RX_CAPTURE records (comms/BinaryProtocol.h):
+
+    [t_us = micros() when SerialLink took the bytes][seq][bytes]
+
+  Runs longer than RX_CAPTURE_CHUNK_BYTES are split into several records
+  with the same t_us. The sink sees only records (COBS frames), so a raw
+  dump of it (the Pi reading SERIAL_AUX) is the capture file. env:native
+  replays it through SerialLink under a virtual clock (native/RxReplay.h).
+
+  The timestamps are the tick that consumed the bytes, not when the UART
+  got them: that is what the firmware acted on, so a replay that ticks at
+  the same instants makes the same decisions.
+
+  Recording costs one COBS frame per run; the sink write waits only if
+  its TX ring is full (see ENABLE_RX_CAPTURE in Params.h).
+
+  USAGE
+  -----
+    RxRecorder rec(SERIAL_USB, SERIAL_AUX);
+    SerialLink link(rec, stage, sizeof(stage));
+===============================================================================
+*/
+
+class RxRecorder : public BulkStream {
+public:
+  RxRecorder(BulkStream& port, Print& sink) : _port(port), _sink(sink) {}
+
+  // Stream (reads are recorded, writes go to the port unrecorded)
+  int available() override { return _port.available(); }
+  int read() override;
+  int peek() override { return _port.peek(); }
+
+  size_t write(uint8_t c) override { return _port.write(c); }
+  size_t write(const uint8_t* buffer, size_t size) override { return _port.write(buffer, size); }
+  using Print::write;
+
+  int availableForWrite() override { return _port.availableForWrite(); }
+  void flush() override { _port.flush(); }
+
+  // BulkStream
+  size_t peekBuffer(const uint8_t*& data) override;
+  void consume(size_t n) override;
+
+  uint32_t records() const { return _records; }
+  uint32_t bytes() const { return _bytes; }
+
+private:
+  void record_(const uint8_t* data, size_t n);
+
+  BulkStream& _port;
+  Print& _sink;
+
+  const uint8_t* _run = nullptr;   // last peekBuffer() run, recorded on consume()
+  size_t _run_len = 0;
+
+  uint8_t _seq = 0;
+  uint32_t _records = 0;
+  uint32_t _bytes = 0;
+};
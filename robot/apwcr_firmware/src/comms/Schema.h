@@ -0,0 +1,444 @@
+#pragma once
+#include <Arduino.h>
+
+#include "Params.h"
+#include "comms/Messages.h"
+
+/*
+===============================================================================
+  Schema.h
+===============================================================================
+
+  PURPOSE
+  -------
+  The one definition of the binary wire layouts and the telemetry group
+  values, as X-macros. Everything that has to agree on them is expanded
+  from here instead of written out per field:
+
+    - the packed payload structs (BinaryProtocol.h)
+    - the group values' fill from a TelemetryFrame, their JSON fields
+      (full frame, group lines) and their delta-line fields
+      (Protocol.cpp, BinaryProtocol.cpp, TelemetryDelta.cpp)
+    - the Python mirror pwc_robot/comms/schema.py: struct formats, field
+      names and offsets (scripts/gen_schema.py, run before every build)
+
+  A new value in a group is one V(...) line; the structs, encoders, delta
+  and Python decoders follow. A new layout is one PWC_PKT_* macro plus its
+  entry in PWC_SCHEMA_PACKETS.
+
+  Notation (one entry per line, the generator parses this file):
+    Layout:  PWC_PKT_<Name>(F, A)
+               F(type, name)       one field; type may be an earlier layout
+                                   or a <Group>Values struct
+               A(type, name, n)    fixed array (char = NUL-padded string)
+    Values:  PWC_VAL_<Group>(V)
+               V(type, name, src, decimals, eps)
+                 src       expression of TelemetryFrame `t` (NAN = null)
+                 decimals  JSON decimals
+                 eps       smallest change a delta line sends
+
+  Layouts are little-endian and packed (AVR and the Pi both are) and are
+  copied straight to/from the wire. Values that need more than a copy
+  (the pose sigmas, confidence bytes, flags) stay hand-written around them.
+===============================================================================
+*/
+
+namespace protocol {
+namespace bin {
+
+// Bumped on any change to the layouts or values below; sent in the hello
+// (HelloPacket.proto) and checked by the host against schema.py
+constexpr uint8_t PROTOCOL_VERSION = 3;
+
+constexpr size_t PERF_NAME_BYTES = 6;   // TaskPerfPacket.name: zero-padded, truncated
+
+}  // namespace bin
+}  // namespace protocol
+
+
+/*=============================================================================
+  GROUP VALUES
+=============================================================================*/
+
+// Measured wheel speed (encoder)
+#define PWC_VAL_Wheel(V) \
+  V(float, left_rpm,  t.wheel.left_rpm,  3, TELEMETRY_EPS_RPM) \
+  V(float, right_rpm, t.wheel.right_rpm, 3, TELEMETRY_EPS_RPM)
+
+// Servo setpoints being output and live arm joint angles
+#define PWC_VAL_Mech(V) \
+  V(float, servo_LID_deg,   t.mech.servo_LID_deg,   3, TELEMETRY_EPS_DEG) \
+  V(float, servo_SWEEP_deg, t.mech.servo_SWEEP_deg, 3, TELEMETRY_EPS_DEG) \
+  V(float, motor_RHS_deg,   t.mech.motor_RHS_deg,   3, TELEMETRY_EPS_DEG) \
+  V(float, motor_LHS_deg,   t.mech.motor_LHS_deg,   3, TELEMETRY_EPS_DEG)
+
+// Front ultrasonic track, NAN (null) when not valid
+#define PWC_VAL_Range(V) \
+  V(float, distance_in,  (t.ultrasonic.valid ? t.ultrasonic.distance_in : NAN),  3, TELEMETRY_EPS_IN) \
+  V(float, closing_inps, (t.ultrasonic.valid ? t.ultrasonic.closing_inps : NAN), 3, TELEMETRY_EPS_INPS)
+
+#define PWC_SCHEMA_GROUPS(X) \
+  X(Wheel) \
+  X(Mech) \
+  X(Range)
+
+
+/*=============================================================================
+  LAYOUTS (Laptop -> Arduino)
+=============================================================================*/
+
+// Mirrors CommandFrame. Motor mode UNKNOWN (0) means "not present",
+// NAN servo angle means "not present".
+#define PWC_PKT_CommandPacket(F, A) \
+  F(uint32_t, seq) \
+  F(uint32_t, host_time_ms) \
+  F(uint32_t, at_ms) \
+  F(float,    drive_linear_ftps) \
+  F(float,    drive_angular_dps) \
+  F(uint8_t,  motor_RHS_mode) \
+  F(float,    motor_RHS_value) \
+  F(uint8_t,  motor_LHS_mode) \
+  F(float,    motor_LHS_value) \
+  F(float,    servo_LID_deg) \
+  F(float,    servo_SWEEP_deg)
+
+// Optional CommandPacket tail: the host's telemetry credit (CommandFrame
+// tel_ack). A packet without it leaves credit control off.
+#define PWC_PKT_CommandCreditPacket(F, A) \
+  F(uint16_t, tel_ack)
+
+#define PWC_PKT_WireModePacket(F, A) \
+  F(uint8_t, mode)
+
+// Mirrors TelemetrySubscription (rates in Hz, 0 = off)
+#define PWC_PKT_SubscribePacket(F, A) \
+  F(uint16_t, telemetry_hz) \
+  F(uint16_t, wheel_hz) \
+  F(uint16_t, ultrasonic_hz) \
+  F(uint16_t, mech_hz) \
+  F(uint8_t,  note)
+
+// Mirrors SequenceRequest. RUN: id is a built-in SeqId, no steps.
+// UPLOAD: 1..SEQ_MAX_STEPS steps follow (args in SeqStep units). ABORT: no steps.
+#define PWC_PKT_SequencePacket(F, A) \
+  F(uint8_t, action) \
+  F(uint8_t, id) \
+  F(uint8_t, step_count)
+
+#define PWC_PKT_SeqStepPacket(F, A) \
+  F(uint8_t,  op) \
+  F(int16_t,  arg) \
+  F(uint16_t, timeout_ms)
+
+// Mirrors PoseReset
+#define PWC_PKT_PoseResetPacket(F, A) \
+  F(float, x_ft) \
+  F(float, y_ft) \
+  F(float, heading_deg)
+
+// Mirrors ParamRequest. name is NUL-padded and only used when index is
+// PARAM_BY_NAME; value is only used by SET.
+#define PWC_PKT_ParamPacket(F, A) \
+  F(uint8_t, op) \
+  F(uint8_t, index) \
+  F(float,   value) \
+  A(char,    name, PARAM_NAME_BYTES)
+
+// Mirrors TestRequest (value NAN = the mode's default)
+#define PWC_PKT_TestPacket(F, A) \
+  F(uint8_t, op) \
+  F(float,   value)
+
+// Mirrors LogRequest
+#define PWC_PKT_LogPacket(F, A) \
+  F(uint8_t, op)
+
+// Mirrors PathRequest. RUN: 1..PATH_MAX_POINTS PathPointPackets follow
+// (speed / lookahead NAN = default). ABORT: no points.
+#define PWC_PKT_PathPacket(F, A) \
+  F(uint8_t, action) \
+  F(uint8_t, count) \
+  F(float,   speed_ftps) \
+  F(float,   lookahead_ft)
+
+#define PWC_PKT_PathPointPacket(F, A) \
+  F(float, x_ft) \
+  F(float, y_ft)
+
+// Mirrors PingRequest
+#define PWC_PKT_PingPacket(F, A) \
+  F(uint16_t, id) \
+  F(uint32_t, t1_us) \
+  F(uint16_t, prev_id) \
+  F(uint32_t, prev_t4_us)
+
+
+/*=============================================================================
+  LAYOUTS (Arduino -> Laptop)
+=============================================================================*/
+
+// Mirrors PoseState; sigmas saturate at 0xFFFF
+#define PWC_PKT_PosePacket(F, A) \
+  F(float,    x_ft) \
+  F(float,    y_ft) \
+  F(float,    heading_deg) \
+  F(uint16_t, sigma_xy_mft) \
+  F(uint16_t, sigma_heading_cdeg)
+
+// Mirrors TelemetryFrame. Optional tail, in order:
+//   - EncoderBatch (TEL_FLAG_ENCODER_BATCH): header + (count - 1) steps
+//   - SonarArray (TEL_FLAG_SONAR_ARRAY): see SonarHeaderPacket
+//   - note: raw bytes (no terminator), length implied by the packet
+#define PWC_PKT_TelemetryPacket(F, A) \
+  F(uint32_t,    arduino_time_ms) \
+  F(uint16_t,    tel_seq) \
+  F(uint32_t,    ack_seq) \
+  F(uint8_t,     queue_depth) \
+  F(uint8_t,     queue_free) \
+  F(uint32_t,    host_time_us) \
+  F(WheelValues, wheel) \
+  F(PosePacket,  pose) \
+  F(MechValues,  mech) \
+  F(RangeValues, ultrasonic) \
+  F(uint8_t,     ultrasonic_confidence) \
+  F(uint8_t,     flags)
+
+// Common prefix of every per-group packet (host_time_us 0 = clock sync
+// not converged)
+#define PWC_PKT_GroupHeaderPacket(F, A) \
+  F(uint32_t, arduino_time_ms) \
+  F(uint16_t, tel_seq) \
+  F(uint32_t, ack_seq) \
+  F(uint8_t,  queue_depth) \
+  F(uint8_t,  queue_free) \
+  F(uint32_t, host_time_us)
+
+// An EncoderBatch may follow (any bytes after the fixed payload)
+#define PWC_PKT_WheelPacket(F, A) \
+  F(GroupHeaderPacket, h) \
+  F(WheelValues,       wheel) \
+  F(PosePacket,        pose)
+
+// EncoderBatch: the first sample in full, then one delta step per sample
+// (overflows: ring overflows since boot, saturating)
+#define PWC_PKT_EncoderBatchHeaderPacket(F, A) \
+  F(uint8_t,  count) \
+  F(uint16_t, overflows) \
+  F(uint32_t, t0_us) \
+  A(int32_t,  count0, ENCODER_BATCH_CHANNELS)
+
+// dt_us: since the previous sample
+#define PWC_PKT_EncoderStepPacket(F, A) \
+  F(uint16_t, dt_us) \
+  A(int16_t,  dcount, ENCODER_BATCH_CHANNELS)
+
+// SonarArray block, columns in struct-of-arrays order after the header:
+//   uint16_t distance_cin[count]   0.01 in, SONAR_NO_TRACK when not valid
+//   int16_t  closing_dinps[count]  0.1 in/s, positive = getting closer
+//   uint8_t  confidence[count]     0..255 = 0..1
+#define PWC_PKT_SonarHeaderPacket(F, A) \
+  F(uint8_t, count) \
+  F(uint8_t, valid_mask)
+
+// A SonarArray block may follow (any bytes after the fixed payload).
+// confidence 0..255 = 0..1; flags TEL_FLAG_ULTRASONIC_VALID, _OBSTACLE_STOP
+#define PWC_PKT_UltrasonicPacket(F, A) \
+  F(GroupHeaderPacket, h) \
+  F(RangeValues,       range) \
+  F(uint8_t,           confidence) \
+  F(uint8_t,           flags)
+
+#define PWC_PKT_MechPacket(F, A) \
+  F(GroupHeaderPacket, h) \
+  F(MechValues,        mech)
+
+// Mirrors PerfFrame. Microsecond and count fields saturate at 0xFFFF;
+// jitter is max_us - min_us.
+#define PWC_PKT_PerfHeaderPacket(F, A) \
+  F(uint32_t, arduino_time_ms) \
+  F(uint16_t, window_ms) \
+  F(uint16_t, loop_count) \
+  F(uint16_t, loop_min_us) \
+  F(uint16_t, loop_max_us) \
+  F(uint16_t, loop_mean_us) \
+  F(uint16_t, loop_idle_permille) \
+  F(uint16_t, mem_static) \
+  F(uint16_t, mem_stack_peak) \
+  F(uint16_t, mem_free_min) \
+  F(uint16_t, mem_free_now) \
+  F(uint8_t,  servo_attached) \
+  F(uint16_t, servo_active_permille) \
+  F(uint16_t, servo_isr_ppm) \
+  F(uint16_t, servo_detaches) \
+  F(uint8_t,  task_count)
+
+#define PWC_PKT_TaskPerfPacket(F, A) \
+  A(char,     name, PERF_NAME_BYTES) \
+  F(uint16_t, runs) \
+  F(uint16_t, overruns) \
+  F(uint16_t, min_us) \
+  F(uint16_t, max_us) \
+  F(uint16_t, mean_us) \
+  F(uint16_t, p99_us)
+
+// Mirrors LinkStatsFrame. Window figures saturate at 0xFFFF like perf;
+// the command gaps go in ms (us would not fit 16 bits).
+#define PWC_PKT_LinkStatsPacket(F, A) \
+  F(uint32_t, arduino_time_ms) \
+  F(uint16_t, window_ms) \
+  F(uint32_t, frames) \
+  F(uint32_t, ok) \
+  F(uint32_t, fail) \
+  F(uint32_t, overflow) \
+  F(uint16_t, max_frame_bytes) \
+  F(uint32_t, seq_gaps) \
+  F(uint32_t, seq_stale) \
+  F(uint16_t, rx_high_water) \
+  F(uint32_t, tel_held) \
+  F(uint16_t, tel_unread_max) \
+  F(uint16_t, parse_count) \
+  F(uint16_t, parse_min_us) \
+  F(uint16_t, parse_max_us) \
+  F(uint16_t, parse_mean_us) \
+  F(uint16_t, cmd_count) \
+  F(uint16_t, gap_min_ms) \
+  F(uint16_t, gap_max_ms) \
+  F(uint16_t, gap_mean_ms) \
+  A(uint16_t, jitter_hist, LINK_JITTER_BINS)
+
+// Mirrors SequenceStatus
+#define PWC_PKT_SeqStatusPacket(F, A) \
+  F(uint32_t, arduino_time_ms) \
+  F(uint8_t,  id) \
+  F(uint8_t,  state) \
+  F(uint8_t,  step) \
+  F(uint8_t,  steps) \
+  F(uint8_t,  timeouts)
+
+// Mirrors PongFrame
+#define PWC_PKT_PongPacket(F, A) \
+  F(uint16_t, id) \
+  F(uint32_t, t1_us) \
+  F(uint32_t, t2_us) \
+  F(uint32_t, t3_us) \
+  F(uint8_t,  flags) \
+  F(uint32_t, offset_us) \
+  F(float,    drift_ppm) \
+  F(uint32_t, delay_us) \
+  F(int32_t,  cmd_latency_us)
+
+// Mirrors ParamReply (name NUL-padded, empty without a parameter;
+// index PARAM_NO_INDEX = none)
+#define PWC_PKT_ParamReplyPacket(F, A) \
+  F(uint8_t, op) \
+  F(uint8_t, status) \
+  F(uint8_t, index) \
+  F(uint8_t, count) \
+  F(float,   value) \
+  F(float,   min) \
+  F(float,   max) \
+  A(char,    name, PARAM_NAME_BYTES)
+
+// One RxRecorder record: bytes SerialLink took from the port at t_us. seq
+// counts records (mod 256) so a lost one shows up on replay.
+#define PWC_PKT_RxCapturePacket(F, A) \
+  F(uint32_t, t_us) \
+  F(uint8_t,  seq)
+
+// Mirrors SysIdChunk (the samples follow as packed SysIdSample, 5 bytes)
+#define PWC_PKT_SysIdHeaderPacket(F, A) \
+  F(uint8_t,  target) \
+  F(uint8_t,  gen) \
+  F(uint8_t,  period_ms) \
+  F(float,    units_per_count) \
+  F(uint16_t, first) \
+  F(uint16_t, total)
+
+// Mirrors HelloFrame (proto = PROTOCOL_VERSION; build NUL-padded)
+#define PWC_PKT_HelloPacket(F, A) \
+  F(uint32_t, arduino_time_ms) \
+  F(uint8_t,  stage) \
+  F(uint16_t, fw_version) \
+  F(uint8_t,  proto) \
+  F(uint16_t, features) \
+  F(uint8_t,  reset_flags) \
+  F(uint32_t, link_us) \
+  F(uint32_t, setup_us) \
+  F(uint32_t, first_tel_us) \
+  A(char,     build, BUILD_ID_BYTES)
+
+// Mirrors EventLogChunk (the records follow as EventRecordPacket)
+#define PWC_PKT_EventLogHeaderPacket(F, A) \
+  F(uint16_t, first) \
+  F(uint16_t, end)
+
+// Mirrors EventRecord
+#define PWC_PKT_EventRecordPacket(F, A) \
+  F(uint32_t, t_ms) \
+  F(uint8_t,  id) \
+  F(uint8_t,  count) \
+  F(int16_t,  a) \
+  F(int16_t,  b)
+
+// Every layout, nested ones before their users
+#define PWC_SCHEMA_PACKETS(X) \
+  X(CommandPacket) \
+  X(CommandCreditPacket) \
+  X(WireModePacket) \
+  X(SubscribePacket) \
+  X(SequencePacket) \
+  X(SeqStepPacket) \
+  X(PoseResetPacket) \
+  X(ParamPacket) \
+  X(TestPacket) \
+  X(LogPacket) \
+  X(PathPacket) \
+  X(PathPointPacket) \
+  X(PingPacket) \
+  X(PosePacket) \
+  X(TelemetryPacket) \
+  X(GroupHeaderPacket) \
+  X(WheelPacket) \
+  X(EncoderBatchHeaderPacket) \
+  X(EncoderStepPacket) \
+  X(SonarHeaderPacket) \
+  X(UltrasonicPacket) \
+  X(MechPacket) \
+  X(PerfHeaderPacket) \
+  X(TaskPerfPacket) \
+  X(LinkStatsPacket) \
+  X(SeqStatusPacket) \
+  X(PongPacket) \
+  X(ParamReplyPacket) \
+  X(RxCapturePacket) \
+  X(SysIdHeaderPacket) \
+  X(HelloPacket) \
+  X(EventLogHeaderPacket) \
+  X(EventRecordPacket)
+
+
+/*=============================================================================
+  EXPANSIONS
+=============================================================================*/
+
+#define PWC_SCHEMA_MEMBER_(type, name) type name;
+#define PWC_SCHEMA_ARRAY_(type, name, n) type name[n];
+#define PWC_SCHEMA_VALUE_MEMBER_(type, name, src, decimals, eps) type name;
+#define PWC_SCHEMA_VALUE_FILL_(type, name, src, decimals, eps) v.name = (src);
+
+// struct <Group>Values { ... } and fill(<Group>Values&, t)
+#define PWC_SCHEMA_VALUES_(G) \
+  struct __attribute__((packed)) G##Values { PWC_VAL_##G(PWC_SCHEMA_VALUE_MEMBER_) }; \
+  inline void fill(G##Values& v, const TelemetryFrame& t) { PWC_VAL_##G(PWC_SCHEMA_VALUE_FILL_) }
+
+#define PWC_SCHEMA_STRUCT_(P) \
+  struct __attribute__((packed)) P { PWC_PKT_##P(PWC_SCHEMA_MEMBER_, PWC_SCHEMA_ARRAY_) };
+
+namespace protocol {
+namespace bin {
+
+PWC_SCHEMA_GROUPS(PWC_SCHEMA_VALUES_)
+PWC_SCHEMA_PACKETS(PWC_SCHEMA_STRUCT_)
+
+}  // namespace bin
+}  // namespace protocol
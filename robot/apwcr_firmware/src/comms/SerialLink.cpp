@@ -1,48 +1,99 @@
 #include "comms/SerialLink.h"
 
+#include <math.h>
 #include <string.h>
 #include <stdarg.h>
 
 #include "comms/Protocol.h"
+#include "comms/BinaryProtocol.h"
+#include "utils/EventLog.h"
 
 /*
 ===============================================================================
   SerialLink.cpp
 ===============================================================================
 
-  Key behavior:
-  - Ignores '\r'
+  RX is drained a contiguous run at a time (BulkStream::peekBuffer), so the
+  per-byte cost is a memchr plus the parser step, not two virtual calls.
+
+  Key behavior (JSON mode):
+  - Runs are fed straight into CommandParser (no line buffer)
+  - Ignores '\r' (and stray 0x00 delimiters left over from binary mode)
   - '\n' ends a frame
-  - If RX buffer would overflow, enters "dropping" mode until next '\n'
+  - Lines longer than SERIAL_LINE_MAX_BYTES are dropped until next '\n'
+
+  Key behavior (binary mode):
+  - 0x00 ends a COBS frame; empty frames are ignored
+  - Frames are decoded in place in a small frame buffer
+  - If the frame buffer would overflow, enters "dropping" mode until next 0x00
 ===============================================================================
 */
 
-SerialLink::SerialLink(Stream& serial)
-: _serial(serial)
+SerialLink::SerialLink(BulkStream& serial, uint8_t* tx_buf, uint16_t tx_size)
+: _serial(serial),
+  _parser(SERIAL_LINE_MAX_BYTES),
+  _tx_buf(tx_buf),
+  _tx_size(tx_size)
 {
-  memset(_rx_buf, 0, sizeof(_rx_buf));
   memset(_note_buf, 0, sizeof(_note_buf));
 }
 
 void SerialLink::begin() {
-  _rx_len = 0;
+  _parser.reset();
+  _frame_len = 0;
   _dropping = false;
 
   _has_cmd = false;
+  _cmd_pending = false;
+  _queue.clear();
   _last_cmd_ms = 0;
   _ack_seq = 0;
+  _has_seq_req = false;
+  _has_pose_req = false;
+  _has_param_req = false;
+  _has_test_req = false;
+  _has_log_req = false;
+  _has_path_req = false;
+
+  _sync.reset();
+  _pong_id = 0;
+  _cmd_latency_us = 0;
+  _cmd_latency_valid = false;
 
   _lines = _ok = _fail = _ovf = 0;
   _max_len_seen = 0;
 
-  memset(_rx_buf, 0, sizeof(_rx_buf));
+  _seq_gaps = _seq_stale = 0;
+  _last_cmd_us = 0;
+  _gap_ema_us = 0;
+  _win = LinkWindow();
+  _parse_acc_us = 0;
+  _link_stats_due = false;
+
+  _tx_len = _tx_off = 0;
+  _tx_frames = _tx_dropped = _tx_oversize = 0;
+  _perf = nullptr;
+
+  _tel_seq = _tel_ack = 0;
+  _tel_ack_ms = _tel_sent_ms = 0;
+  _tel_held = 0;
+  _credit = false;
+
+  _mode = SERIAL_BINARY_AT_BOOT ? WireMode::BINARY : WireMode::JSON;
+  _delta_enabled = TELEMETRY_DELTA_AT_BOOT;
+  _delta.requestKeyframe();
+
+  _sub = TelemetrySubscription();
+  _subscribed = false;
+  _pub_carry = 0;
+
   memset(_note_buf, 0, sizeof(_note_buf));
   _note_until_ms = 0;
-  note_(0, "BOOT RX_BUF_SIZE=%u", (unsigned)RX_BUF_SIZE);
+  note_(0, "BOOT LINE_MAX=%u", (unsigned)SERIAL_LINE_MAX_BYTES);
 
 }
 
-void SerialLink::TxTick(const TelemetryFrame& t) {
+void SerialLink::TxTick(TelemetryFrame& t) {
   sendTelemetry(t);
 }
 
@@ -56,8 +107,398 @@ uint32_t SerialLink::commandAgeMs(uint32_t now_ms) const {
   return now_ms - _last_cmd_ms;
 }
 
-void SerialLink::sendTelemetry(const TelemetryFrame& t) {
-  protocol::encodeTelemetryLine(t, _serial);
+bool SerialLink::sendTelemetry(TelemetryFrame& t) {
+  return sendTelemetry_(t, millis());
+}
+
+bool SerialLink::sendTelemetry_(TelemetryFrame& t, uint32_t now_ms) {
+  if (!beginTx_(TxKind::PERIODIC)) return false;
+  BufferPrint out(_tx_buf, _tx_size);
+  t.tel_seq = (uint16_t)(_tel_seq + 1);
+  encodeTelemetry_(t, out);
+  return published_(commitTx_(out, TxKind::PERIODIC), now_ms);
+}
+
+void SerialLink::encodeTelemetry_(const TelemetryFrame& t, Print& out) {
+  if (_mode == WireMode::JSON && _delta_enabled) {
+    _delta.encodeLine(t, out);
+
+  } else if (_mode == WireMode::JSON) {
+    protocol::encodeTelemetryLine(t, out);
+
+  } else if (t.note && t.note == _note_buf && _note_sent_gen == _note_gen) {
+    // At binary rates the same note would repeat hundreds of times; send it
+    // once per note_() call instead.
+    TelemetryFrame quiet = t;
+    quiet.note = nullptr;
+    protocol::bin::encodeTelemetryFrame(quiet, out);
+
+  } else {
+    if (t.note == _note_buf) _note_sent_gen = _note_gen;
+    protocol::bin::encodeTelemetryFrame(t, out);
+  }
+}
+
+bool SerialLink::publish(TelemetryFrame& t, uint32_t now_ms) {
+  const bool json = (_mode == WireMode::JSON);
+  const Credit credit = credit_(now_ms);
+
+  if (!_subscribed) {
+    if (credit == Credit::HOLD) {
+      _tel_held++;
+      pumpTx_();
+      return json;
+    }
+    return sendTelemetry_(t, now_ms) || json;
+  }
+
+  // Encoder batches ride on full and wheel frames (binary only)
+  const bool carrier = !json && (_pub_full.period_us || _pub_wheel.period_us);
+
+  // Group releases keep their schedule while held
+  const bool full       = groupDue_(_pub_full, now_ms);
+  const bool wheel      = groupDue_(_pub_wheel, now_ms);
+  const bool ultrasonic = groupDue_(_pub_ultrasonic, now_ms);
+  const bool mech       = groupDue_(_pub_mech, now_ms);
+  const bool note       = _sub.note && t.note == _note_buf && _note_pub_gen != _note_gen;
+  const bool any        = full || wheel || ultrasonic || mech || note || _pub_carry;
+
+  if (credit == Credit::PROBE) {
+    // One full frame in place of the groups: all of the latest state
+    if (t.note == _note_buf) _note_pub_gen = _note_gen;
+    _pub_carry = 0;
+    return sendTelemetry_(t, now_ms) || !carrier;
+  }
+
+  if (credit == Credit::HOLD || !any) {
+    if (any) _tel_held++;
+    pumpTx_();
+    return !carrier;
+  }
+
+  if (!beginTx_(TxKind::PERIODIC)) return !carrier;
+  BufferPrint out(_tx_buf, _tx_size);
+  t.tel_seq = (uint16_t)(_tel_seq + 1);
+
+  if (full) encodeTelemetry_(t, out);
+
+  const TelemetryGroup groups[] = {
+    TelemetryGroup::WHEEL, TelemetryGroup::ULTRASONIC, TelemetryGroup::MECH, TelemetryGroup::NOTE,
+  };
+  const bool due[] = { wheel, ultrasonic, mech, note };
+
+  // A JSON publication of every group can outgrow the stage: the groups
+  // that don't fit after the others (freshly encoded) lead the next one
+  uint8_t sent = 0;
+  uint8_t carry = 0;
+  for (uint8_t i = 0; i < sizeof(due); i++) {
+    const uint8_t bit = (uint8_t)(1u << (uint8_t)groups[i]);
+    if (!due[i] && !(_pub_carry & bit)) continue;
+    if (groups[i] == TelemetryGroup::NOTE && t.note != _note_buf) continue;
+
+    const size_t mark = out.length();
+    if (json) protocol::encodeGroupLine(groups[i], t, out);
+    else      protocol::bin::encodeGroupFrame(groups[i], t, out);
+    if (out.overflowed() && mark > 0) {
+      out.truncate(mark);
+      carry |= bit;
+    } else {
+      sent |= bit;
+    }
+  }
+  _pub_carry = carry;
+
+  if (sent & (1u << (uint8_t)TelemetryGroup::NOTE)) _note_pub_gen = _note_gen;
+  const bool staged = published_(commitTx_(out, TxKind::PERIODIC), now_ms);
+  return !carrier || (staged && (full || (sent & (1u << (uint8_t)TelemetryGroup::WHEEL))));
+}
+
+uint16_t SerialLink::telUnread() const {
+  if (!_credit) return 0;
+  const int16_t d = (int16_t)(_tel_seq - _tel_ack);   // ack ahead: a host from before a reboot
+  return (d > 0) ? (uint16_t)d : 0;
+}
+
+// Whether the next publication may go out, from the host's last tel_ack
+SerialLink::Credit SerialLink::credit_(uint32_t now_ms) {
+  if (_credit && now_ms - _tel_ack_ms > TELEMETRY_CREDIT_TIMEOUT_MS) _credit = false;
+
+  const uint16_t unread = telUnread();
+  if (unread > _win.tel_unread_max) _win.tel_unread_max = unread;
+  if (unread < TELEMETRY_CREDIT_FRAMES) return Credit::SEND;
+
+  return (now_ms - _tel_sent_ms >= TELEMETRY_CREDIT_PROBE_MS) ? Credit::PROBE : Credit::HOLD;
+}
+
+bool SerialLink::published_(bool staged, uint32_t now_ms) {
+  if (staged) {
+    _tel_seq++;
+    _tel_sent_ms = now_ms;
+  }
+  return staged;
+}
+
+uint16_t SerialLink::publishHz() const {
+  if (!_subscribed) {
+    return (_mode == WireMode::BINARY) ? TELEMETRY_BINARY_UPDATE_HZ : TELEMETRY_UPDATE_HZ;
+  }
+
+  uint16_t hz = _sub.note ? TELEMETRY_NOTE_POLL_HZ : 0;
+  if (_sub.telemetry_hz > hz)  hz = _sub.telemetry_hz;
+  if (_sub.wheel_hz > hz)      hz = _sub.wheel_hz;
+  if (_sub.ultrasonic_hz > hz) hz = _sub.ultrasonic_hz;
+  if (_sub.mech_hz > hz)       hz = _sub.mech_hz;
+  return hz;
+}
+
+void SerialLink::setSubscription(const TelemetrySubscription& sub, uint32_t now_ms) {
+  _sub = sub.any() ? sub : TelemetrySubscription();
+  _subscribed = sub.any();
+
+  // Every group releases on the next publish(), then at its own period
+  const uint16_t rates[] = { _sub.telemetry_hz, _sub.wheel_hz, _sub.ultrasonic_hz, _sub.mech_hz };
+  PubGroup* groups[] = { &_pub_full, &_pub_wheel, &_pub_ultrasonic, &_pub_mech };
+  for (uint8_t i = 0; i < 4; i++) {
+    groups[i]->period_us = rates[i] ? (1000000UL / rates[i]) : 0;
+    groups[i]->next_us = now_ms * 1000UL;
+  }
+
+  const uint16_t hz = publishHz();
+  _pub_slack_us = hz ? (500000UL / hz) : 0;
+
+  _note_pub_gen = _note_gen;
+  _pub_carry = 0;
+  _delta.requestKeyframe();
+}
+
+bool SerialLink::groupDue_(PubGroup& g, uint32_t now_ms) {
+  if (g.period_us == 0) return false;
+
+  // publish() runs at the fastest group's rate, but millis() steps unevenly:
+  // accept a release up to half a publish period early so that group isn't
+  // pushed a whole period late. next += period keeps the average exact.
+  // (now_ms * 1000 wraps mod 2^32 in step with next_us.)
+  const uint32_t now_us = now_ms * 1000UL;
+  if ((int32_t)(now_us + _pub_slack_us - g.next_us) < 0) return false;
+
+  g.next_us += g.period_us;
+  if ((int32_t)(now_us - g.next_us) >= 0) g.next_us = now_us + g.period_us;   // stalled: re-anchor
+  return true;
+}
+
+void SerialLink::sendPerf(const PerfFrame& p) {
+  _link_stats_due = true;
+  if (_perf) {                     // the last one is still streaming
+    _tx_dropped++;
+    logEvent(millis(), EventId::TX_DROP, (int16_t)_tx_len, port_());
+    return;
+  }
+  if (!beginTx_(TxKind::PERIODIC)) return;
+
+  _perf = &p;
+  _perf_off = 0;
+  _tx_frames++;
+  stagePerf_();
+  pumpTx_();
+}
+
+void SerialLink::encodePerf_(const PerfFrame& p, Print& out) const {
+  if (_mode == WireMode::JSON) {
+    protocol::encodePerfLine(p, out);
+  } else {
+    protocol::bin::encodePerfFrame(p, out);
+  }
+}
+
+// Next window of the perf frame into the (free) stage. A frame that fits
+// whole is periodic like telemetry; once it needs more than one window,
+// each piece is one-shot (half a line can't be replaced).
+void SerialLink::stagePerf_() {
+  BufferPrint out(_tx_buf, _tx_size, _perf_off);
+  encodePerf_(*_perf, out);
+
+  const bool more = out.overflowed();
+  _tx_len = (uint16_t)out.length();
+  _tx_off = 0;
+  _tx_kind = (_perf_off == 0 && !more) ? TxKind::PERIODIC : TxKind::ONESHOT;
+  _perf_off = (uint16_t)(_perf_off + _tx_len);
+  if (!more) _perf = nullptr;
+}
+
+void SerialLink::linkStats(LinkStatsFrame& s, uint32_t now_ms) const {
+  s.arduino_time_ms = now_ms;
+  s.window_ms = now_ms - _win.start_ms;
+
+  s.frames = _lines;
+  s.ok = _ok;
+  s.fail = _fail;
+  s.overflow = _ovf;
+  s.max_frame_bytes = _max_len_seen;
+  s.seq_gaps = _seq_gaps;
+  s.seq_stale = _seq_stale;
+  s.rx_high_water = _win.rx_high_water;
+  s.tel_held = _tel_held;
+  s.tel_unread_max = _win.tel_unread_max;
+
+  s.parse_count = _win.parse_count;
+  s.parse_min_us = _win.parse_count ? _win.parse_min_us : 0;
+  s.parse_max_us = _win.parse_max_us;
+  s.parse_mean_us = _win.parse_count ? (_win.parse_sum_us / _win.parse_count) : 0;
+
+  s.cmd_count = _win.cmd_count;
+  s.gap_min_us = _win.cmd_count ? _win.gap_min_us : 0;
+  s.gap_max_us = _win.gap_max_us;
+  s.gap_mean_us = _win.cmd_count ? (_win.gap_sum_us / _win.cmd_count) : 0;
+  memcpy(s.jitter_hist, _win.jitter_hist, sizeof(s.jitter_hist));
+}
+
+// Stages the link stats frame once the TX stage is free, then starts a
+// new window
+void SerialLink::sendLinkStats_(uint32_t now_ms) {
+  LinkStatsFrame s;
+  linkStats(s, now_ms);
+
+  BufferPrint out(_tx_buf, _tx_size);
+  if (_mode == WireMode::JSON) {
+    protocol::encodeLinkStatsLine(s, out);
+  } else {
+    protocol::bin::encodeLinkStatsFrame(s, out);
+  }
+  if (!commitTx_(out, TxKind::ONESHOT)) return;
+
+  _link_stats_due = false;
+  _win = LinkWindow();
+  _win.start_ms = now_ms;
+}
+
+bool SerialLink::sendSequence(const SequenceStatus& st) {
+  if (!beginTx_(TxKind::ONESHOT)) return false;
+  BufferPrint out(_tx_buf, _tx_size);
+
+  if (_mode == WireMode::JSON) {
+    protocol::encodeSequenceLine(st, out);
+  } else {
+    protocol::bin::encodeSequenceFrame(st, out);
+  }
+
+  return commitTx_(out, TxKind::ONESHOT);
+}
+
+bool SerialLink::sendHello(const HelloFrame& h) {
+  if (!beginTx_(TxKind::ONESHOT)) return false;
+  BufferPrint out(_tx_buf, _tx_size);
+
+  if (_mode == WireMode::JSON) {
+    protocol::encodeHelloLine(h, out);
+  } else {
+    protocol::bin::encodeHelloFrame(h, out);
+  }
+
+  return commitTx_(out, TxKind::ONESHOT);
+}
+
+bool SerialLink::sendSysId(const SysIdChunk& c) {
+  if (_mode == WireMode::JSON) return true;
+  if (!beginTx_(TxKind::ONESHOT)) return false;
+  BufferPrint out(_tx_buf, _tx_size);
+  protocol::bin::encodeSysIdFrame(c, out);
+  return commitTx_(out, TxKind::ONESHOT);
+}
+
+bool SerialLink::sendEventLog(const EventLogChunk& c) {
+  if (_mode == WireMode::JSON) return true;
+  if (!beginTx_(TxKind::ONESHOT)) return false;
+  BufferPrint out(_tx_buf, _tx_size);
+  protocol::bin::encodeEventLogFrame(c, out);
+  return commitTx_(out, TxKind::ONESHOT);
+}
+
+bool SerialLink::sendParam(const ParamReply& r) {
+  if (!beginTx_(TxKind::ONESHOT)) return false;
+  BufferPrint out(_tx_buf, _tx_size);
+
+  if (_mode == WireMode::JSON) {
+    protocol::encodeParamLine(r, out);
+  } else {
+    protocol::bin::encodeParamFrame(r, out);
+  }
+
+  return commitTx_(out, TxKind::ONESHOT);
+}
+
+bool SerialLink::beginTx_(TxKind kind) {
+  pumpTx_();
+  if (_tx_len == 0) return true;
+
+  // A one-shot frame waits for the stage; nothing is lost, the caller
+  // sends it again
+  const bool replace = (_tx_off == 0 && _tx_kind == TxKind::PERIODIC);
+  if (!replace && kind == TxKind::ONESHOT) return false;
+
+  // Otherwise the host misses a telemetry frame; a delta chain can't
+  // survive that
+  _tx_dropped++;
+  logEvent(millis(), EventId::TX_DROP, (int16_t)_tx_len, port_());
+  _delta.requestKeyframe();
+  if (!replace) return false;      // partly sent, or a one-shot: keep it, drop the new one
+
+  _tx_len = 0;                     // periodic, never started: replace it
+  return true;
+}
+
+bool SerialLink::commitTx_(const BufferPrint& out, TxKind kind) {
+  if (out.overflowed()) {
+    _tx_oversize++;
+    _tx_len = 0;
+    return false;
+  }
+
+  _tx_len = (uint16_t)out.length();
+  _tx_off = 0;
+  _tx_kind = kind;
+  _tx_frames++;
+  pumpTx_();
+  return true;
+}
+
+void SerialLink::pumpTx_() {
+  while (_tx_len > 0) {
+    const int room = _serial.availableForWrite();
+    if (room <= 0) return;
+
+    size_t n = (size_t)(_tx_len - _tx_off);
+    if (n > (size_t)room) n = (size_t)room;
+
+    _serial.write(_tx_buf + _tx_off, n);
+    _tx_off = (uint16_t)(_tx_off + n);
+    if (_tx_off < _tx_len) return;
+
+    _tx_len = _tx_off = 0;
+    if (_perf) stagePerf_();       // the rest of a streamed perf frame first
+  }
+}
+
+void SerialLink::setWireMode(WireMode mode) {
+  if (mode == _mode) return;
+  _mode = mode;
+  logEvent(millis(), EventId::LINK_MODE, (int16_t)mode, port_());
+
+  // Any partial frame belongs to the old framing
+  _parser.reset();
+  _frame_len = 0;
+  _dropping = false;
+
+  // So does a staged TX frame that hasn't started going out, and the rest
+  // of a streamed perf frame
+  if (_tx_len > 0 && _tx_off == 0) _tx_len = 0;
+  _perf = nullptr;
+
+  _delta.requestKeyframe();
+}
+
+void SerialLink::setDeltaTelemetry(bool enable) {
+  _delta_enabled = enable;
+  _delta.requestKeyframe();
 }
 
 void SerialLink::note_(uint32_t now_ms, const char* fmt, ...) {
@@ -66,100 +507,420 @@ void SerialLink::note_(uint32_t now_ms, const char* fmt, ...) {
   vsnprintf(_note_buf, sizeof(_note_buf), fmt, args);
   va_end(args);
   _note_until_ms = now_ms + 1500;
+  _note_gen++;
 }
 
 void SerialLink::tick(uint32_t now_ms) {
-  while (_serial.available() > 0) {
-    int c = _serial.read();
-    if (c < 0) break;
-
-    char ch = (char)c;
-
-    if (ch == '\r') continue;
-
-    if (_dropping) {
-      // We overflowed earlier; discard until newline to resync
-      if (ch == '\n') {
-        _dropping = false;
-        _rx_len = 0;
-        memset(_rx_buf, 0, sizeof(_rx_buf));
-        // note_(now_ms, "RX RESYNC");
-      }
-      continue;
-    }
-
-    if (ch == '\n') {
-      // End of frame
-      _rx_buf[_rx_len] = '\0';
-
-      _lines++;
-
-      // Track max length seen (helps confirm sizing)
-      if (_rx_len > _max_len_seen) _max_len_seen = (uint16_t)_rx_len;
+  pumpTx_();
+  if (_link_stats_due && _tx_len == 0) sendLinkStats_(now_ms);
+
+  // RX backlog this tick has to work through (the ring only grows between
+  // ticks, so this is the high-water mark at tick resolution)
+  const int waiting = _serial.available();
+  if (waiting > (int)_win.rx_high_water) _win.rx_high_water = (uint16_t)waiting;
+
+  const uint8_t* data;
+  size_t n;
+  while ((n = _serial.peekBuffer(data)) > 0) {
+    const size_t used = (_mode == WireMode::BINARY) ? rxBinary_(data, n, now_ms)
+                                                    : rxJson_(data, n, now_ms);
+    _serial.consume(used);
+  }
+}
 
-      handleLine_(now_ms);
+size_t SerialLink::rxJson_(const uint8_t* data, size_t len, uint32_t now_ms) {
+  size_t off = 0;
+  while (off < len) {
+    const uint32_t t0 = micros();
+    size_t used = 0;
+    const CommandParser::Result r = _parser.feed((const char*)data + off, len - off, used);
+    off += used;
 
-      _rx_len = 0;
+    if (r == CommandParser::Result::NONE) {
+      _parse_acc_us += micros() - t0;   // line continues in the next run
       continue;
     }
 
-    // Append to buffer if there is room (leave space for '\0')
-    if (_rx_len + 1 < RX_BUF_SIZE) {
-      _rx_buf[_rx_len++] = ch;
+    handleLine_(r, now_ms);
+    if (r != CommandParser::Result::EMPTY) recordParse_(_parse_acc_us + (micros() - t0));
+    _parse_acc_us = 0;
+    if (_mode != WireMode::JSON) break;
+  }
+  return off;
+}
+
+size_t SerialLink::rxBinary_(const uint8_t* data, size_t len, uint32_t now_ms) {
+  const uint32_t t0 = micros();
+  const uint8_t* end = (const uint8_t*)memchr(data, 0x00, len);
+  const size_t body = end ? (size_t)(end - data) : len;
+
+  if (!_dropping && body > 0) {
+    if (_frame_len + body <= sizeof(_frame_buf)) {
+      memcpy(_frame_buf + _frame_len, data, body);
+      _frame_len += body;
     } else {
-      // Buffer overflow: discard remainder until newline
       _ovf++;
       _dropping = true;
-
-      // Capture a short debug note (head + stats)
-      // NOTE: _rx_buf currently holds the head of the frame, which is useful.
-      _rx_buf[RX_BUF_SIZE - 1] = '\0';
-      const size_t n = strlen(_rx_buf);
-      const char* tail = (n > 24) ? (_rx_buf + (n - 24)) : _rx_buf;
-      note_(now_ms,
-            "RX FAIL lines=%lu ok=%lu fail=%lu ovf=%lu len=%u head=%.24s tail=%.24s",
-            (unsigned long)_lines,
-            (unsigned long)_ok,
-            (unsigned long)_fail,
-            (unsigned long)_ovf,
-            (unsigned)_rx_len,
-            _rx_buf,
-            tail);
-
-      // Reset buffer for next frame after resync
-      _rx_len = 0;
-      memset(_rx_buf, 0, sizeof(_rx_buf));
+      logEvent(now_ms, EventId::RX_OVERFLOW, (int16_t)(_frame_len + body), port_());
+      _frame_len = 0;
+      note_(now_ms, "RX OVF (binary) ovf=%lu", (unsigned long)_ovf);
     }
   }
+
+  if (!end) {
+    _parse_acc_us += micros() - t0;
+    return len;
+  }
+
+  // End of COBS frame
+  if (!_dropping && _frame_len > 0) {
+    _lines++;
+    if (_frame_len > _max_len_seen) _max_len_seen = (uint16_t)_frame_len;
+    handleBinaryFrame_(now_ms);
+    recordParse_(_parse_acc_us + (micros() - t0));
+  }
+  _parse_acc_us = 0;
+  _dropping = false;
+  _frame_len = 0;
+
+  // A link frame may have switched us back to JSON mid-run
+  return body + 1;
 }
 
-void SerialLink::handleLine_(uint32_t now_ms) {
-  if (_rx_buf[0] == '\0') return;
+void SerialLink::handleLine_(CommandParser::Result r, uint32_t now_ms) {
+  if (r == CommandParser::Result::EMPTY) return;
 
-  CommandFrame cmd;
-  if (protocol::decodeCommandLine(_rx_buf, cmd) && cmd.valid) {
-    _latest_cmd = cmd;
-    _has_cmd = true;
-    _last_cmd_ms = now_ms;
-    _ack_seq = cmd.seq;
+  _lines++;
+
+  // Track max length seen (helps confirm sizing)
+  const uint16_t len = _parser.lineLength();
+  if (len > _max_len_seen) _max_len_seen = len;
+
+  if (r == CommandParser::Result::COMMAND) {
+    acceptCommand_(_parser.command(), now_ms);
+
+  } else if (r == CommandParser::Result::LINK) {
+    _ok++;
+    setWireMode(_parser.linkMode());
+    note_(now_ms, "LINK mode=%s", (_mode == WireMode::BINARY) ? "binary" : "json");
+
+  } else if (r == CommandParser::Result::TLM) {
+    _ok++;
+    const TelemetryControl& c = _parser.tlmControl();
+    if (c.delta_present) setDeltaTelemetry(c.delta);
+    if (c.keyframe) _delta.requestKeyframe();
+
+  } else if (r == CommandParser::Result::SUBSCRIBE) {
     _ok++;
+    setSubscription(_parser.subscription(), now_ms);
+    noteSubscription_(now_ms);
 
-    // Optional: success note (comment out later)
-    note_(now_ms, "RX OK seq=%lu len=%u",
-          (unsigned long)cmd.seq,
-          (unsigned)_rx_len);
+  } else if (r == CommandParser::Result::SEQUENCE) {
+    acceptSequence_(_parser.sequence(), now_ms);
+
+  } else if (r == CommandParser::Result::PING) {
+    acceptPing_(_parser.ping());
+
+  } else if (r == CommandParser::Result::POSE) {
+    acceptPose_(_parser.pose(), now_ms);
+
+  } else if (r == CommandParser::Result::PARAM) {
+    acceptParam_(_parser.param(), now_ms);
+
+  } else if (r == CommandParser::Result::TEST) {
+    acceptTest_(_parser.test(), now_ms);
+
+  } else if (r == CommandParser::Result::LOG) {
+    acceptLog_(_parser.log(), now_ms);
+
+  } else if (r == CommandParser::Result::PATH) {
+    acceptPath_(_parser.path(), now_ms);
+
+  } else if (r == CommandParser::Result::OVERFLOW) {
+    _ovf++;
+    logEvent(now_ms, EventId::RX_OVERFLOW, (int16_t)len, port_());
+    note_(now_ms,
+          "RX OVF (lines=%lu ok=%lu fail=%lu ovf=%lu) len=%u",
+          (unsigned long)_lines,
+          (unsigned long)_ok,
+          (unsigned long)_fail,
+          (unsigned long)_ovf,
+          (unsigned)len);
 
   } else {
     _fail++;
+    logEvent(now_ms, EventId::RX_FAIL, (int16_t)len, port_());
 
-    // Show head + length so we can tell if schema/JSON is weird
+    // Show length + where parsing stopped so we can tell if schema/JSON is weird
     note_(now_ms,
-          "RX FAIL (lines=%lu ok=%lu fail=%lu ovf=%lu) len=%u head=%.24s",
+          "RX FAIL (lines=%lu ok=%lu fail=%lu ovf=%lu) len=%u at=%u",
           (unsigned long)_lines,
           (unsigned long)_ok,
           (unsigned long)_fail,
           (unsigned long)_ovf,
-          (unsigned)_rx_len,
-          _rx_buf);
+          (unsigned)len,
+          (unsigned)_parser.errorOffset());
   }
 }
+
+void SerialLink::handleBinaryFrame_(uint32_t now_ms) {
+  const uint8_t* payload = nullptr;
+  size_t payload_len = 0;
+  const size_t frame_len = _frame_len;
+
+  const uint8_t type = protocol::bin::decodeFrame(_frame_buf, _frame_len, payload, payload_len);
+
+  CommandFrame cmd;
+  WireMode mode;
+  TelemetrySubscription sub;
+  SequenceRequest seq;
+  PingRequest ping;
+  PoseReset pose;
+  ParamRequest param;
+  TestRequest test;
+  LogRequest log;
+  PathRequest path;
+
+  if (type == protocol::bin::PKT_CMD &&
+      protocol::bin::decodeCommandPayload(payload, payload_len, cmd)) {
+    acceptCommand_(cmd, now_ms);
+
+  } else if (type == protocol::bin::PKT_LINK &&
+             protocol::bin::decodeLinkPayload(payload, payload_len, mode)) {
+    _ok++;
+    setWireMode(mode);
+    note_(now_ms, "LINK mode=%s", (mode == WireMode::BINARY) ? "binary" : "json");
+
+  } else if (type == protocol::bin::PKT_SUBSCRIBE &&
+             protocol::bin::decodeSubscribePayload(payload, payload_len, sub)) {
+    _ok++;
+    setSubscription(sub, now_ms);
+    noteSubscription_(now_ms);
+
+  } else if (type == protocol::bin::PKT_SEQUENCE &&
+             protocol::bin::decodeSequencePayload(payload, payload_len, seq)) {
+    acceptSequence_(seq, now_ms);
+
+  } else if (type == protocol::bin::PKT_PING &&
+             protocol::bin::decodePingPayload(payload, payload_len, ping)) {
+    acceptPing_(ping);
+
+  } else if (type == protocol::bin::PKT_POSE &&
+             protocol::bin::decodePosePayload(payload, payload_len, pose)) {
+    acceptPose_(pose, now_ms);
+
+  } else if (type == protocol::bin::PKT_PARAM &&
+             protocol::bin::decodeParamPayload(payload, payload_len, param)) {
+    acceptParam_(param, now_ms);
+
+  } else if (type == protocol::bin::PKT_TEST &&
+             protocol::bin::decodeTestPayload(payload, payload_len, test)) {
+    acceptTest_(test, now_ms);
+
+  } else if (type == protocol::bin::PKT_LOG &&
+             protocol::bin::decodeLogPayload(payload, payload_len, log)) {
+    acceptLog_(log, now_ms);
+
+  } else if (type == protocol::bin::PKT_PATH &&
+             protocol::bin::decodePathPayload(payload, payload_len, path)) {
+    acceptPath_(path, now_ms);
+
+  } else {
+    _fail++;
+    logEvent(now_ms, EventId::RX_FAIL, (int16_t)frame_len, port_());
+    note_(now_ms,
+          "RX FAIL (binary lines=%lu ok=%lu fail=%lu ovf=%lu) len=%u type=%u",
+          (unsigned long)_lines,
+          (unsigned long)_ok,
+          (unsigned long)_fail,
+          (unsigned long)_ovf,
+          (unsigned)frame_len,
+          (unsigned)type);
+  }
+}
+
+void SerialLink::acceptCommand_(const CommandFrame& cmd, uint32_t now_ms) {
+  if (refuseInput_("cmd", now_ms)) return;
+  const uint32_t now_us = micros();
+
+  // A resent seq still counts as a sign of life but is applied only once
+  const bool fresh = !_has_cmd || cmd.seq != _ack_seq;
+
+  if (_has_cmd) {
+    // The host numbers every command, so a jump is that many lost on the way
+    const int32_t step = (int32_t)(cmd.seq - _ack_seq);
+    if (step > 1) _seq_gaps += (uint32_t)(step - 1);
+    else if (step <= 0) _seq_stale++;
+
+    const uint32_t gap = now_us - _last_cmd_us;
+    _win.cmd_count++;
+    _win.gap_sum_us += gap;
+    if (gap < _win.gap_min_us) _win.gap_min_us = gap;
+    if (gap > _win.gap_max_us) _win.gap_max_us = gap;
+
+    // Jitter against the running mean; the first gap seeds it
+    if (_gap_ema_us == 0) _gap_ema_us = (int32_t)gap;
+    int32_t dev = (int32_t)gap - _gap_ema_us;
+    _gap_ema_us += dev / 8;
+    if (dev < 0) dev = -dev;
+
+    uint8_t bin = 0;
+    for (uint32_t ms = (uint32_t)dev / 1000UL; ms && bin < LINK_JITTER_BINS - 1; ms >>= 1) bin++;
+    if (_win.jitter_hist[bin] < 0xFFFF) _win.jitter_hist[bin]++;
+  }
+  _last_cmd_us = now_us;
+
+  _latest_cmd = cmd;
+  _has_cmd = true;
+  _last_cmd_ms = now_ms;
+  _ack_seq = cmd.seq;
+  _ok++;
+
+  if (cmd.tel_ack_present) {
+    _tel_ack = cmd.tel_ack;
+    _tel_ack_ms = now_ms;
+    _credit = true;
+  }
+
+  if (!fresh) {
+    // already queued / applied
+  } else if (cmd.at_present) {
+    const CommandQueue::Push r = _queue.push(cmd, now_ms);
+    if (r != CommandQueue::Push::OK) {
+      note_(now_ms, "QUEUE reject seq=%lu why=%u depth=%u",
+            (unsigned long)cmd.seq, (unsigned)r, (unsigned)_queue.depth());
+    }
+  } else {
+    // The host took over: its own setpoint replaces any queued trajectory
+    _queue.clear();
+    _cmd_pending = true;
+  }
+
+  // host_time_ms * 1000 wraps mod 2^32 exactly like the host's us clock
+  _cmd_latency_valid = _sync.synced();
+  if (_cmd_latency_valid) {
+    _cmd_latency_us = (int32_t)(_sync.toHostUs(micros()) - cmd.host_time_ms * 1000UL);
+  }
+}
+
+void SerialLink::recordParse_(uint32_t dur_us) {
+  _win.parse_count++;
+  _win.parse_sum_us += dur_us;
+  if (dur_us < _win.parse_min_us) _win.parse_min_us = dur_us;
+  if (dur_us > _win.parse_max_us) _win.parse_max_us = dur_us;
+}
+
+bool SerialLink::takeCommand(uint32_t now_ms, CommandFrame& out) {
+  if (_cmd_pending) {
+    _cmd_pending = false;
+    out = _latest_cmd;
+    return true;
+  }
+  return _queue.popDue(now_ms, out);
+}
+
+void SerialLink::acceptPose_(const PoseReset& pose, uint32_t now_ms) {
+  if (refuseInput_("pose", now_ms)) return;
+  _pose_req = pose;
+  _has_pose_req = true;
+  _ok++;
+  note_(now_ms, "POSE x=%ld y=%ld (0.01 ft) heading=%ld",
+        lroundf(pose.x_ft * 100.0f), lroundf(pose.y_ft * 100.0f), lroundf(pose.heading_deg));
+}
+
+// No note: the reply is the acknowledgement
+void SerialLink::acceptParam_(const ParamRequest& req, uint32_t now_ms) {
+  if (refuseInput_("param", now_ms)) return;
+  _param_req = req;
+  _has_param_req = true;
+  _ok++;
+}
+
+void SerialLink::acceptTest_(const TestRequest& req, uint32_t now_ms) {
+  if (refuseInput_("test", now_ms)) return;
+  _test_req = req;
+  _has_test_req = true;
+  _ok++;
+  note_(now_ms, "TEST op=%u", (unsigned)req.op);
+}
+
+// No note: the dump is the acknowledgement
+void SerialLink::acceptLog_(const LogRequest& req, uint32_t now_ms) {
+  if (refuseInput_("log", now_ms)) return;
+  _log_req = req;
+  _has_log_req = true;
+  _ok++;
+}
+
+void SerialLink::acceptPath_(const PathRequest& req, uint32_t now_ms) {
+  if (refuseInput_("path", now_ms)) return;
+  _path_req = req;
+  _has_path_req = true;
+  _ok++;
+  note_(now_ms, "PATH action=%u points=%u speed=%ld (0.01 ft/s)",
+        (unsigned)req.action, (unsigned)req.count, isnan(req.speed_ftps) ? -1L : lroundf(req.speed_ftps * 100.0f));
+}
+
+void SerialLink::acceptSequence_(const SequenceRequest& req, uint32_t now_ms) {
+  if (refuseInput_("seq", now_ms)) return;
+  _seq_req = req;
+  _has_seq_req = true;
+  _ok++;
+  note_(now_ms, "SEQ action=%u id=%u steps=%u",
+        (unsigned)req.action, (unsigned)req.id, (unsigned)req.step_count);
+}
+
+// Telemetry-only port: the frame parsed but is not this port's to take
+bool SerialLink::refuseInput_(const char* what, uint32_t now_ms) {
+  if (_command_input) return false;
+  _fail++;
+  note_(now_ms, "RX REFUSED %s (telemetry-only link)", what);
+  return true;
+}
+
+void SerialLink::acceptPing_(const PingRequest& ping) {
+  const uint32_t t2 = micros();
+  _ok++;
+
+  // The host's prev_t4 completes the exchange we answered last time
+  if (_pong_id != 0 && ping.prev_id == _pong_id) {
+    _sync.addExchange(_pong_t1_us, _pong_t2_us, _pong_t3_us, ping.prev_t4_us);
+  }
+  _pong_id = 0;
+
+  if (!beginTx_(TxKind::ONESHOT)) {   // no pong, so no exchange to complete either
+    _tx_dropped++;
+    return;
+  }
+  BufferPrint out(_tx_buf, _tx_size);
+
+  PongFrame p;
+  p.id = ping.id;
+  p.t1_us = ping.t1_us;
+  p.t2_us = t2;
+  p.t3_us = micros();
+  p.synced = _sync.synced();
+  p.offset_us = _sync.offsetUs(p.t3_us);
+  p.drift_ppm = _sync.driftPpm();
+  p.delay_us = _sync.delayUs();
+  p.cmd_latency_us = _cmd_latency_us;
+  p.cmd_latency_valid = _cmd_latency_valid;
+
+  if (_mode == WireMode::JSON) protocol::encodePongLine(p, out);
+  else                         protocol::bin::encodePongFrame(p, out);
+
+  if (!commitTx_(out, TxKind::ONESHOT)) return;
+  _pong_id = p.id;
+  _pong_t1_us = p.t1_us;
+  _pong_t2_us = p.t2_us;
+  _pong_t3_us = p.t3_us;
+}
+
+void SerialLink::noteSubscription_(uint32_t now_ms) {
+  note_(now_ms, "SUB tel=%u wheel=%u us=%u mech=%u note=%u",
+        (unsigned)_sub.telemetry_hz,
+        (unsigned)_sub.wheel_hz,
+        (unsigned)_sub.ultrasonic_hz,
+        (unsigned)_sub.mech_hz,
+        (unsigned)_sub.note);
+}
@@ -3,6 +3,13 @@
 
 #include "Params.h"
 #include "comms/Messages.h"
+#include "comms/BulkStream.h"
+#include "comms/BufferPrint.h"
+#include "comms/BinaryProtocol.h"
+#include "comms/CommandParser.h"
+#include "comms/CommandQueue.h"
+#include "comms/TelemetryDelta.h"
+#include "comms/TimeSync.h"
 
 /*
 ===============================================================================
@@ -13,23 +20,88 @@
   -------
   Arduino-side serial link handler:
 
-    - Non-blocking read from Stream
-    - Accumulate bytes into a newline-delimited line buffer
-    - Decode "cmd" frames and store latest valid command
+    - Non-blocking bulk drain of a BulkStream (the Uart RX ring): each
+      contiguous run is scanned with memchr for the frame delimiter
+    - Runs go straight into CommandParser (JSON mode) or are copied into a
+      0x00-delimited COBS frame (binary mode)
+    - Decode "cmd" frames: apply-on-arrival ones replace the latest
+      command, timed ones (at_ms) go into a CommandQueue for playback
+    - Switch wire mode on "link" frames from the host
+    - Hold the latest "seq" request (run / upload / abort) for the main
+      loop, and send sequencer status frames
+    - Hold the latest "pose" (odometry reset) for the main loop
+    - Hold the latest "param" request for the main loop (utils/ParamStore),
+      and send its reply
+    - Hold the latest "test" request (built-in test modes) for the main loop
+    - Hold the latest "log" request (utils/EventLog) for the main loop, and
+      send the dump's chunks
+    - Hold the latest "path" request (control/PathFollower) for the main loop
+    - Answer "ping" frames with a "pong" and feed each completed exchange
+      to a TimeSync (host clock estimate, command latency)
     - Track command age for COMMAND_TIMEOUT_MS
-    - Send telemetry frames via Protocol
+    - Link quality stats (parse time per frame, command inter-arrival
+      jitter, seq gaps, RX backlog high-water), sent after each perf frame
+    - Send the boot hello, telemetry (and low-rate perf) frames via
+      Protocol / BinaryProtocol
+    - Per-group telemetry on a host "subscribe" frame: each group (full
+      frame, wheel, ultrasonic, mech) keeps its own drift-free release
+      time, notes go out once per change
+    - Telemetry credit (host backpressure, below)
+
+  TX never waits for the wire. Each frame is encoded into a RAM stage
+  (caller-owned, sized for the largest frame the port carries, perf
+  aside), then moved into the UART's TX ring as space
+  frees up (the ring is drained by the UDRE interrupt; tick() and every
+  send top it up). Each staged frame is periodic (telemetry, perf) or
+  one-shot (replies, hello, sequence status, sysid and log chunks, link
+  stats, pong). If the host falls behind:
+    - a periodic frame that has not started transmitting is replaced by
+      the next frame (the oldest telemetry is dropped, not the newest)
+    - a one-shot frame is never displaced: new telemetry is dropped, and
+      another one-shot send returns false until the stage is free
+    - a frame already partly on the wire can't be pulled back, so the new
+      telemetry is dropped / the new one-shot waits
+  txDropped() counts the telemetry (and pongs) lost. A one-shot send that
+  returns true goes out whole; the only exception is a wire mode switch,
+  which discards an unstarted frame in the old framing.
+
+  A perf frame longer than the stage (a JSON perf line is ~1.3 KB) is
+  streamed: the encoder runs once per stage-sized window of the line and
+  each window is staged as soon as the previous one is on the UART, so
+  no other frame gets in between. The caller's PerfFrame must stay
+  unchanged while perfPending().
+
+  Telemetry credit: every publication (one publish() / sendTelemetry()
+  commit, all its frames alike) carries tel_seq, and a host that echoes
+  the newest tel_seq it has read as tel_ack in its commands gets at most
+  TELEMETRY_CREDIT_FRAMES publications unread. Past that, publish() holds
+  the due frames (counted, the group schedules keep running, encoder
+  samples stay in the ring) and sends one full frame every
+  TELEMETRY_CREDIT_PROBE_MS, so a host that stalled reads a few fresh
+  frames instead of a backlog in the OS buffer. A host that never sends
+  tel_ack is never held; credit ends TELEMETRY_CREDIT_TIMEOUT_MS after
+  the last one.
+
+  One instance per port, each with its own stage, parser and stats. A
+  telemetry-only port (setCommandInput(false)) still answers link,
+  subscribe, tlm and ping frames, but refuses cmd, seq, pose, param, test,
+  log and path frames (counted as RX failures) so only one host can drive.
 
   IMPORTANT
   ---------
-  On RX buffer overflow, this class will DISCARD bytes until the next '\n'
-  to resynchronize cleanly. This prevents "tail fragments" from being decoded.
+  On overflow (line longer than SERIAL_LINE_MAX_BYTES, or a binary frame
+  larger than the frame buffer) this class will DISCARD bytes until the next
+  '\n' (or 0x00 in binary mode) to resynchronize cleanly. This prevents
+  "tail fragments" from being decoded.
 
 ===============================================================================
 */
 
 class SerialLink {
 public:
-  explicit SerialLink(Stream& serial);
+  // tx_buf: TX stage, at least protocol::bin::MAX_FRAME_BYTES (and the
+  // longest JSON line the port should carry)
+  SerialLink(BulkStream& serial, uint8_t* tx_buf, uint16_t tx_size);
 
   void begin();
 
@@ -39,7 +111,7 @@ public:
 
   // Convenience aliases
   void RxTick(uint32_t now_ms) { tick(now_ms); }
-  void TxTick(const TelemetryFrame& t);
+  void TxTick(TelemetryFrame& t);
 
   // True if at least one valid command has been received since boot.
   bool hasCommand() const { return _has_cmd; }
@@ -47,23 +119,163 @@ public:
   // Latest successfully decoded command (only meaningful if hasCommand()).
   const CommandFrame& latestCommand() const { return _latest_cmd; }
 
+  // Next command to apply at now_ms, in order: a new apply-on-arrival
+  // command (once), then each queued command that has come due. Call
+  // until it returns false.
+  bool takeCommand(uint32_t now_ms, CommandFrame& out);
+
+  // Timed setpoints waiting for their at_ms
+  const CommandQueue& commandQueue() const { return _queue; }
+  void clearCommandQueue() { _queue.clear(); }
+
   // True if we have not received a command recently.
   bool commandTimedOut(uint32_t now_ms) const;
 
   // Time since last command was received (ms). If never received, returns large.
   uint32_t commandAgeMs(uint32_t now_ms) const;
 
+  // millis() of the last command received (0 = none yet); changes on every
+  // command, including a repeated seq
+  uint32_t lastCommandMs() const { return _last_cmd_ms; }
+
   // ACK = last command seq that was received + parsed successfully
   uint32_t ackSeq() const { return _ack_seq; }
 
-  // Encodes and writes one telemetry line to the serial stream.
-  void sendTelemetry(const TelemetryFrame& t);
+  // Host clock estimate from ping exchanges (see comms/TimeSync.h)
+  const TimeSync& timeSync() const { return _sync; }
+
+  // Host send -> parse latency of the latest command (us), only meaningful
+  // while cmdLatencyValid() (clock synced when it arrived)
+  int32_t cmdLatencyUs() const { return _cmd_latency_us; }
+  bool cmdLatencyValid() const { return _cmd_latency_valid; }
+
+  // Encodes and writes one telemetry frame in the current wire mode
+  // (stamps t.tel_seq). Returns true if the frame was staged (false =
+  // dropped). Not subject to the credit.
+  bool sendTelemetry(TelemetryFrame& t);
+
+  // Telemetry publisher, call at publishHz(). Until the host subscribes this
+  // is sendTelemetry(); afterwards it sends whichever groups are due (all
+  // of them staged together, so groups due on the same tick go out as one
+  // TX commit; a group that doesn't fit in the stage after the others goes
+  // with the next call). Stamps t.tel_seq; held while the host is out of
+  // credit.
+  //
+  // Returns true once t.encoders is no longer needed: it went out in a
+  // staged binary telemetry/wheel frame, or the link can't carry it at all
+  // (JSON mode, or neither group subscribed). false = keep the samples for
+  // the next call.
+  bool publish(TelemetryFrame& t, uint32_t now_ms);
+
+  // Rate publish() should run at: the wire mode's telemetry rate, or the
+  // fastest subscribed group.
+  uint16_t publishHz() const;
+
+  // Telemetry credit: tel_seq of the last publication, whether the host
+  // reports tel_ack, and how many it hasn't read (0 without credit)
+  uint16_t telSeq() const { return _tel_seq; }
+  bool telemetryCredit() const { return _credit; }
+  uint16_t telUnread() const;
+  uint32_t telHeld() const { return _tel_held; }
+
+  // Per-group subscription (host sends {"type":"subscribe",...}). An empty
+  // subscription restores the boot default.
+  bool subscribed() const { return _subscribed; }
+  const TelemetrySubscription& subscription() const { return _sub; }
+  void setSubscription(const TelemetrySubscription& sub, uint32_t now_ms);
+
+  // Encodes and writes one perf diagnostics frame in the current wire mode,
+  // in stage-sized pieces if it doesn't fit the stage (see TX above: `p`
+  // is read again for each piece). A link stats frame for the same window
+  // follows once the whole frame is out.
+  void sendPerf(const PerfFrame& p);
+  bool perfPending() const { return _perf != nullptr; }
+
+  // Link quality so far; the window started at the last link stats frame
+  void linkStats(LinkStatsFrame& out, uint32_t now_ms) const;
+
+  // Link stats frame without a perf frame on this port (perf went out on
+  // another one); sent as soon as the TX stage is free
+  void requestLinkStats() { _link_stats_due = true; }
+
+  // Latest sequence request not yet taken by the main loop (nullptr = none).
+  // A newer request replaces one that was never taken.
+  const SequenceRequest* pendingSequence() const { return _has_seq_req ? &_seq_req : nullptr; }
+  void clearPendingSequence() { _has_seq_req = false; }
+
+  // Latest odometry reset not yet taken by the main loop (nullptr = none)
+  const PoseReset* pendingPose() const { return _has_pose_req ? &_pose_req : nullptr; }
+  void clearPendingPose() { _has_pose_req = false; }
+
+  // Latest parameter request not yet taken by the main loop (nullptr =
+  // none). One at a time: the host waits for each reply before the next.
+  const ParamRequest* pendingParam() const { return _has_param_req ? &_param_req : nullptr; }
+  void clearPendingParam() { _has_param_req = false; }
+
+  // Latest test mode request not yet taken by the main loop (nullptr = none)
+  const TestRequest* pendingTest() const { return _has_test_req ? &_test_req : nullptr; }
+  void clearPendingTest() { _has_test_req = false; }
+
+  // Latest event log request not yet taken by the main loop (nullptr = none)
+  const LogRequest* pendingLog() const { return _has_log_req ? &_log_req : nullptr; }
+  void clearPendingLog() { _has_log_req = false; }
+
+  // Latest path request not yet taken by the main loop (nullptr = none).
+  // A newer request replaces one that was never taken.
+  const PathRequest* pendingPath() const { return _has_path_req ? &_path_req : nullptr; }
+  void clearPendingPath() { _has_path_req = false; }
+
+  // Encodes and writes one parameter reply in the current wire mode.
+  // Returns true if the frame was staged (it can't be displaced, see TX
+  // above), false = not staged, send it again.
+  bool sendParam(const ParamReply& r);
+
+  // Writes one sysid capture chunk (binary mode only). Returns true if it
+  // was staged or the link can't carry it (JSON mode), false = not staged,
+  // send it again.
+  bool sendSysId(const SysIdChunk& c);
+
+  // Writes one event log chunk (binary mode only). Returns true if it was
+  // staged or the link can't carry it (JSON mode), false = not staged,
+  // send it again.
+  bool sendEventLog(const EventLogChunk& c);
+
+  // Encodes and writes one sequencer status frame in the current wire mode.
+  // Returns true if the frame was staged (false = not staged, send it again).
+  bool sendSequence(const SequenceStatus& s);
+
+  // Encodes and writes the boot hello in the current wire mode. Returns
+  // true if the frame was staged (false = not staged, send it again).
+  bool sendHello(const HelloFrame& h);
+
+  // JSON delta telemetry (starts at TELEMETRY_DELTA_AT_BOOT, host may
+  // switch it with a "tlm" frame; see comms/TelemetryDelta.h)
+  bool deltaTelemetry() const { return _delta_enabled; }
+  void setDeltaTelemetry(bool enable);
 
-  // Optional: expose a short RX debug note (valid until _note_until_ms)
+  // Wire mode (starts at SERIAL_BINARY_AT_BOOT, host may switch it)
+  WireMode wireMode() const { return _mode; }
+  void setWireMode(WireMode mode);
+
+  // Short RX debug note, for failures and mode changes (valid until
+  // _note_until_ms); routine frames are counted in linkStats() instead
   const char* debugNote(uint32_t now_ms) const {
     return (now_ms <= _note_until_ms) ? _note_buf : nullptr;
   }
 
+  // Command input (default on). Off = telemetry-only port, see above.
+  bool commandInput() const { return _command_input; }
+  void setCommandInput(bool enable) { _command_input = enable; }
+
+  // Posts a note from outside the link (same lifetime as the RX notes)
+  void postNote(uint32_t now_ms, const char* text) { note_(now_ms, "%s", text); }
+
+  // TX stats
+  uint32_t txFrames() const { return _tx_frames; }
+  uint32_t txDropped() const { return _tx_dropped; }
+  uint32_t txOversize() const { return _tx_oversize; }   // frame > stage
+  bool txPending() const { return _tx_len > 0; }
+
   // Optional: RX stats
   uint32_t rxLines() const { return _lines; }
   uint32_t rxOk() const { return _ok; }
@@ -72,21 +284,113 @@ public:
   uint16_t rxMaxLenSeen() const { return _max_len_seen; }
 
 private:
-  void handleLine_(uint32_t now_ms);
+  // Consume bytes from one RX run; return how many were used. Both stop
+  // early after a link frame so the rest is read in the new wire mode.
+  size_t rxJson_(const uint8_t* data, size_t len, uint32_t now_ms);
+  size_t rxBinary_(const uint8_t* data, size_t len, uint32_t now_ms);
+
+  void handleLine_(CommandParser::Result r, uint32_t now_ms);
+  void handleBinaryFrame_(uint32_t now_ms);
+  void acceptCommand_(const CommandFrame& cmd, uint32_t now_ms);
+  void acceptSequence_(const SequenceRequest& req, uint32_t now_ms);
+  void acceptPose_(const PoseReset& pose, uint32_t now_ms);
+  void acceptParam_(const ParamRequest& req, uint32_t now_ms);
+  void acceptTest_(const TestRequest& req, uint32_t now_ms);
+  void acceptLog_(const LogRequest& req, uint32_t now_ms);
+  void acceptPath_(const PathRequest& req, uint32_t now_ms);
+  void acceptPing_(const PingRequest& ping);
+  bool refuseInput_(const char* what, uint32_t now_ms);
+  int16_t port_() const { return _command_input ? 0 : 1; }   // EventRecord arg
+  void recordParse_(uint32_t dur_us);
+  void sendLinkStats_(uint32_t now_ms);
+  void noteSubscription_(uint32_t now_ms);
+
+  // One publish() group: period 0 = off. Kept in us (on the now_ms * 1000
+  // timeline) so 15 Hz is 66667 us, not a truncated 66 ms.
+  struct PubGroup {
+    uint32_t period_us = 0;
+    uint32_t next_us = 0;
+  };
+  bool groupDue_(PubGroup& g, uint32_t now_ms);
+  bool sendTelemetry_(TelemetryFrame& t, uint32_t now_ms);
+
+  // Telemetry credit: SEND as usual, HOLD the due frames, or PROBE with
+  // one full frame
+  enum class Credit : uint8_t { SEND, HOLD, PROBE };
+  Credit credit_(uint32_t now_ms);
+  bool published_(bool staged, uint32_t now_ms);
+  void encodeTelemetry_(const TelemetryFrame& t, Print& out);
+
+  // TX stage priority (see TX above)
+  enum class TxKind : uint8_t { PERIODIC, ONESHOT };
+
+  // Frees the TX stage for a new frame of `kind`; false = the stage is
+  // kept, drop (periodic) or retry (one-shot) the new frame.
+  bool beginTx_(TxKind kind);
+  bool commitTx_(const BufferPrint& out, TxKind kind);
+  void pumpTx_();
+  void encodePerf_(const PerfFrame& p, Print& out) const;
+  void stagePerf_();
   void note_(uint32_t now_ms, const char* fmt, ...);
 
-  Stream& _serial;
+  BulkStream& _serial;
 
-  static constexpr size_t RX_BUF_SIZE = SERIAL_LINE_BUFFER_BYTES;
-  char _rx_buf[RX_BUF_SIZE];
-  size_t _rx_len = 0;
+  // JSON mode: incremental parser, fills a CommandFrame as bytes arrive
+  CommandParser _parser;
 
-  // When true, we are discarding bytes until newline due to overflow
+  // Binary mode: one COBS frame, decoded in place
+  uint8_t _frame_buf[protocol::bin::MAX_FRAME_BYTES];
+  size_t _frame_len = 0;
+
+  // When true, we are discarding binary bytes until 0x00 due to overflow
   bool _dropping = false;
 
+  WireMode _mode = WireMode::JSON;
+
+  TelemetryDelta _delta;
+  bool _delta_enabled = false;
+
+  // Per-group publishing
+  TelemetrySubscription _sub;
+  bool _subscribed = false;
+  PubGroup _pub_full;
+  PubGroup _pub_wheel;
+  PubGroup _pub_ultrasonic;
+  PubGroup _pub_mech;
+  uint32_t _pub_slack_us = 0;   // half a publish() period: millis() jitter
+  uint8_t _pub_carry = 0;       // groups (bit = TelemetryGroup) that didn't fit last time
+
+  // Telemetry credit
+  uint16_t _tel_seq = 0;         // last publication staged
+  uint16_t _tel_ack = 0;         // newest the host has read
+  uint32_t _tel_ack_ms = 0;
+  uint32_t _tel_sent_ms = 0;     // last publication staged (probe timing)
+  uint32_t _tel_held = 0;        // publications held, since boot
+  bool _credit = false;          // host sends tel_ack
+
+  // TX stage: one encoded frame waiting for room in the UART ring
+  uint8_t* _tx_buf;
+  uint16_t _tx_size;
+  uint16_t _tx_len = 0;    // 0 = stage free
+  uint16_t _tx_off = 0;    // bytes already handed to the UART
+  TxKind _tx_kind = TxKind::PERIODIC;
+  uint32_t _tx_frames = 0;
+  uint32_t _tx_dropped = 0;
+  uint32_t _tx_oversize = 0;
+
+  // Perf frame being streamed through the stage (nullptr = none)
+  const PerfFrame* _perf = nullptr;
+  uint16_t _perf_off = 0;  // bytes of it staged so far
+
+  bool _command_input = true;
+
   // Latest decoded command
   CommandFrame _latest_cmd;
   bool _has_cmd = false;
+  bool _cmd_pending = false;    // apply-on-arrival command not taken yet
+
+  // Timed commands
+  CommandQueue _queue;
 
   // Command freshness
   uint32_t _last_cmd_ms = 0;
@@ -94,6 +398,40 @@ private:
   // ACK bookkeeping
   uint32_t _ack_seq = 0;
 
+  // Clock sync: the Arduino half of the last exchange, completed by the
+  // host's t4 in the next ping
+  TimeSync _sync;
+  uint16_t _pong_id = 0;          // 0 = none outstanding
+  uint32_t _pong_t1_us = 0;
+  uint32_t _pong_t2_us = 0;
+  uint32_t _pong_t3_us = 0;
+  int32_t _cmd_latency_us = 0;
+  bool _cmd_latency_valid = false;
+
+  // Sequence request waiting for the main loop
+  SequenceRequest _seq_req;
+  bool _has_seq_req = false;
+
+  // Odometry reset waiting for the main loop
+  PoseReset _pose_req;
+  bool _has_pose_req = false;
+
+  // Parameter request waiting for the main loop
+  ParamRequest _param_req;
+  bool _has_param_req = false;
+
+  // Test mode request waiting for the main loop
+  TestRequest _test_req;
+  bool _has_test_req = false;
+
+  // Event log request waiting for the main loop
+  LogRequest _log_req;
+  bool _has_log_req = false;
+
+  // Path request waiting for the main loop
+  PathRequest _path_req;
+  bool _has_path_req = false;
+
   // RX debug stats
   uint32_t _lines = 0;
   uint32_t _ok = 0;
@@ -101,7 +439,37 @@ private:
   uint32_t _ovf = 0;
   uint16_t _max_len_seen = 0;
 
+  // Link quality: since boot
+  uint32_t _seq_gaps = 0;
+  uint32_t _seq_stale = 0;
+  uint32_t _last_cmd_us = 0;
+  int32_t _gap_ema_us = 0;       // running mean command gap (jitter reference)
+
+  // Link quality: current window (since the last link stats frame)
+  struct LinkWindow {
+    uint32_t start_ms = 0;
+    uint16_t rx_high_water = 0;
+    uint16_t tel_unread_max = 0;
+    uint32_t parse_count = 0;
+    uint32_t parse_min_us = 0xFFFFFFFFUL;
+    uint32_t parse_max_us = 0;
+    uint32_t parse_sum_us = 0;
+    uint32_t cmd_count = 0;
+    uint32_t gap_min_us = 0xFFFFFFFFUL;
+    uint32_t gap_max_us = 0;
+    uint32_t gap_sum_us = 0;
+    uint16_t jitter_hist[LINK_JITTER_BINS] = {};
+  };
+  LinkWindow _win;
+  uint32_t _parse_acc_us = 0;    // time spent on the frame in progress
+  bool _link_stats_due = false;
+
   // Debug note buffer (for telemetry note)
   char _note_buf[96];
   uint32_t _note_until_ms = 0;
+
+  // Binary mode only sends each note once instead of every frame
+  uint8_t _note_gen = 0;
+  uint8_t _note_sent_gen = 0;
+  uint8_t _note_pub_gen = 0;    // same, for the "note" group
 };
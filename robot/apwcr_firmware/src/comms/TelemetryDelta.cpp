@@ -0,0 +1,201 @@
+#include "comms/TelemetryDelta.h"
+#include <math.h>
+#include <string.h>
+
+#include "Params.h"
+#include "comms/Protocol.h"
+#include "comms/BinaryProtocol.h"   // crc16
+#include "comms/JsonWriter.h"
+
+/*
+===============================================================================
+  TelemetryDelta.cpp
+===============================================================================
+*/
+
+namespace {
+
+// Non-finite values are sent as null, so a change to/from null always counts
+bool moved(float now, float sent, float eps) {
+  const bool fn = isfinite(now);
+  const bool fs = isfinite(sent);
+  if (!fn || !fs) return fn != fs;
+  return fabsf(now - sent) > eps;
+}
+
+uint16_t noteHash(const char* note) {
+  return note ? protocol::bin::crc16((const uint8_t*)note, strlen(note)) : 0;
+}
+
+// Nested object that is only opened if one of its fields is written
+class Group {
+public:
+  Group(JsonWriter& w, const __FlashStringHelper* name) : _w(w), _name(name) {}
+
+  JsonWriter& field(const __FlashStringHelper* k) {
+    if (!_open) {
+      _w.key(_name);
+      _w.beginObject();
+      _open = true;
+    }
+    _w.key(k);
+    return _w;
+  }
+
+  void close() {
+    if (_open) _w.endObject();
+  }
+
+private:
+  JsonWriter& _w;
+  const __FlashStringHelper* _name;
+  bool _open = false;
+};
+
+void floatField(Group& g, const __FlashStringHelper* k, float now, float& sent, float eps) {
+  if (!moved(now, sent, eps)) return;
+  g.field(k).number(now);
+  sent = now;
+}
+
+// V(...) of a PWC_VAL_* list (comms/Schema.h) into Group `g`, against the
+// values last sent `sent`: changed ones only, or all of them
+#define DELTA_VALUE_(type, name, src, decimals, eps) \
+  if (moved((src), sent.name, eps)) { g.field(F(#name)).number((src), decimals); sent.name = (src); }
+#define DELTA_ALWAYS_(type, name, src, decimals, eps) \
+  g.field(F(#name)).number((src), decimals); sent.name = (src);
+
+}  // namespace
+
+
+void TelemetryDelta::remember_(const TelemetryFrame& t) {
+  _sent.ack_seq = t.ack_seq;
+  _sent.queue_depth = t.queue_depth;
+  _sent.queue_free = t.queue_free;
+  protocol::bin::fill(_sent.wheel, t);
+  _sent.pose = t.pose;
+  protocol::bin::fill(_sent.mech, t);
+  _sent.us_valid = t.ultrasonic.valid;
+  protocol::bin::fill(_sent.range, t);
+  _sent.confidence = t.ultrasonic.confidence;
+  _sent.obstacle_stop = t.ultrasonic.obstacle_stop;
+  _sent.note_present = (t.note != nullptr);
+  _sent.note_hash = noteHash(t.note);
+  if (t.sonar) rememberSonar_(*t.sonar);
+}
+
+void TelemetryDelta::rememberSonar_(const SonarArray& a) {
+  _sent.sonar_valid = a.valid_mask;
+  for (uint8_t i = 0; i < SONAR_MAX_SENSORS; i++) {
+    _sent.sonar_distance_in[i] = a.distance_in[i];
+    _sent.sonar_closing_inps[i] = a.closing_inps[i];
+    _sent.sonar_confidence[i] = a.confidence[i];
+  }
+}
+
+bool TelemetryDelta::sonarMoved_(const SonarArray& a) const {
+  if (a.valid_mask != _sent.sonar_valid) return true;
+
+  constexpr int16_t EPS_CONF = (int16_t)(TELEMETRY_EPS_CONF * 255.0f);
+  const uint8_t n = (a.count < SONAR_MAX_SENSORS) ? a.count : SONAR_MAX_SENSORS;
+  for (uint8_t i = 0; i < n; i++) {
+    if (abs((int16_t)a.confidence[i] - (int16_t)_sent.sonar_confidence[i]) > EPS_CONF) return true;
+    if (!(a.valid_mask & (1u << i))) continue;
+    if (fabsf(a.distance_in[i] - _sent.sonar_distance_in[i]) > TELEMETRY_EPS_IN) return true;
+    if (fabsf(a.closing_inps[i] - _sent.sonar_closing_inps[i]) > TELEMETRY_EPS_INPS) return true;
+  }
+  return false;
+}
+
+void TelemetryDelta::encodeLine(const TelemetryFrame& t, Print& out) {
+  _frame++;
+
+  if (_force_key || _since_key + 1 >= TELEMETRY_KEYFRAME_EVERY) {
+    protocol::encodeTelemetryLine(t, out, _frame);
+    remember_(t);
+    _since_key = 0;
+    _force_key = false;
+    return;
+  }
+  _since_key++;
+
+  JsonWriter w(out);
+  w.beginObject();
+
+  w.key(F("type"));            w.string("tdelta");
+  w.key(F("frame"));           w.u32(_frame);
+  w.key(F("arduino_time_ms")); w.u32(t.arduino_time_ms);
+  if (t.host_time_valid) {
+    w.key(F("host_time_us")); w.u32(t.host_time_us);
+  }
+  w.key(F("tel_seq"));         w.u32(t.tel_seq);
+
+  if (t.ack_seq != _sent.ack_seq) {
+    w.key(F("ack_seq")); w.u32(t.ack_seq);
+    _sent.ack_seq = t.ack_seq;
+  }
+
+  if (t.queue_depth != _sent.queue_depth || t.queue_free != _sent.queue_free) {
+    w.key(F("queue_depth")); w.u32(t.queue_depth);
+    w.key(F("queue_free"));  w.u32(t.queue_free);
+    _sent.queue_depth = t.queue_depth;
+    _sent.queue_free = t.queue_free;
+  }
+
+  {
+    Group g(w, F("wheel"));
+    protocol::bin::WheelValues& sent = _sent.wheel;
+    PWC_VAL_Wheel(DELTA_VALUE_)
+    g.close();
+  }
+
+  Group pose(w, F("pose"));
+  floatField(pose, F("x_ft"),              t.pose.x_ft,              _sent.pose.x_ft,              TELEMETRY_EPS_FT);
+  floatField(pose, F("y_ft"),              t.pose.y_ft,              _sent.pose.y_ft,              TELEMETRY_EPS_FT);
+  floatField(pose, F("heading_deg"),       t.pose.heading_deg,       _sent.pose.heading_deg,       TELEMETRY_EPS_DEG);
+  floatField(pose, F("sigma_xy_ft"),       t.pose.sigma_xy_ft,       _sent.pose.sigma_xy_ft,       TELEMETRY_EPS_FT);
+  floatField(pose, F("sigma_heading_deg"), t.pose.sigma_heading_deg, _sent.pose.sigma_heading_deg, TELEMETRY_EPS_DEG);
+  pose.close();
+
+  {
+    Group g(w, F("mech"));
+    protocol::bin::MechValues& sent = _sent.mech;
+    PWC_VAL_Mech(DELTA_VALUE_)
+    g.close();
+  }
+
+  // valid and the range values travel together when valid flips
+  {
+    Group g(w, F("ultrasonic"));
+    protocol::bin::RangeValues& sent = _sent.range;
+    if (t.ultrasonic.valid != _sent.us_valid) {
+      g.field(F("valid")).boolean(t.ultrasonic.valid);
+      PWC_VAL_Range(DELTA_ALWAYS_)
+      _sent.us_valid = t.ultrasonic.valid;
+    } else if (t.ultrasonic.valid) {
+      PWC_VAL_Range(DELTA_VALUE_)
+    }
+    floatField(g, F("confidence"), t.ultrasonic.confidence, _sent.confidence, TELEMETRY_EPS_CONF);
+    if (t.ultrasonic.obstacle_stop != _sent.obstacle_stop) {
+      g.field(F("stop")).boolean(t.ultrasonic.obstacle_stop);
+      _sent.obstacle_stop = t.ultrasonic.obstacle_stop;
+    }
+    g.close();
+  }
+
+  if (t.sonar && sonarMoved_(*t.sonar)) {
+    protocol::writeSonarArray(w, *t.sonar);
+    rememberSonar_(*t.sonar);
+  }
+
+  const bool note_present = (t.note != nullptr);
+  const uint16_t note_hash = noteHash(t.note);
+  if (note_present != _sent.note_present || note_hash != _sent.note_hash) {
+    w.key(F("note")); w.string(t.note);
+    _sent.note_present = note_present;
+    _sent.note_hash = note_hash;
+  }
+
+  w.endObject();
+  w.endLine();
+}
@@ -0,0 +1,82 @@
+#pragma once
+#include <Arduino.h>
+
+#include "comms/Messages.h"
+#include "comms/Schema.h"
+
+/*
+===============================================================================
+  TelemetryDelta.h
+===============================================================================
+
+  PURPOSE
+  -------
+  Stateful JSON telemetry encoder that only sends what changed. On a parked
+  robot almost nothing moves between 20 Hz frames, yet a full telemetry
+  line resends every key and null (~250 B).
+
+  Frames:
+    keyframe  {"type": "telemetry", "frame": N, ...every field...}
+    delta     {"type": "tdelta", "frame": N, "arduino_time_ms": ...,
+               ...only fields that changed...}
+
+  Rules:
+    - A float field is sent when it moved more than its epsilon
+      (TELEMETRY_EPS_*) from the value last SENT, or became / stopped being
+      null; so the host's copy is never off by more than the epsilon.
+    - ack_seq, queue_depth/queue_free, ultrasonic.valid / .stop and note
+      are sent whenever they change.
+    - The "sonar" block (SonarArray) is resent whole when any sensor's
+      value moved past its epsilon or its track came or went.
+    - host_time_us is sent in every delta once the clock is synced (like
+      arduino_time_ms and tel_seq, it always moves).
+    - A keyframe goes out every TELEMETRY_KEYFRAME_EVERY frames, and on
+      requestKeyframe() (host request, mode switch, dropped TX frame).
+    - "frame" counts every frame, key or delta. A gap tells the host it
+      missed something; it should ask for a keyframe and ignore deltas
+      until one arrives.
+
+  Python mirror: pwc_robot/comms/protocol.py, TelemetryDeltaDecoder.
+===============================================================================
+*/
+
+class TelemetryDelta {
+public:
+  // Next frame is a keyframe; the counter keeps running.
+  void requestKeyframe() { _force_key = true; }
+
+  // Writes one keyframe or delta line (includes trailing '\n').
+  void encodeLine(const TelemetryFrame& t, Print& out);
+
+  uint32_t frame() const { return _frame; }
+
+private:
+  // Values as last sent (the host's view)
+  struct Sent {
+    uint32_t ack_seq = 0;
+    uint8_t queue_depth = 0;
+    uint8_t queue_free = 0;
+    protocol::bin::WheelValues wheel = {NAN, NAN};
+    PoseState pose;
+    protocol::bin::MechValues mech = {NAN, NAN, NAN, NAN};
+    bool us_valid = false;
+    protocol::bin::RangeValues range = {NAN, NAN};
+    float confidence = 0.0f;
+    bool obstacle_stop = false;
+    uint8_t sonar_valid = 0;
+    float sonar_distance_in[SONAR_MAX_SENSORS] = {};
+    float sonar_closing_inps[SONAR_MAX_SENSORS] = {};
+    uint8_t sonar_confidence[SONAR_MAX_SENSORS] = {};
+    bool note_present = false;
+    uint16_t note_hash = 0;
+  };
+
+  void remember_(const TelemetryFrame& t);
+  void rememberSonar_(const SonarArray& a);
+  bool sonarMoved_(const SonarArray& a) const;
+
+  Sent _sent;
+  uint32_t _frame = 0;
+  uint16_t _since_key = 0;
+  bool _force_key = true;
+};
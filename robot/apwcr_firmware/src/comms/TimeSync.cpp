@@ -0,0 +1,84 @@
+#include "comms/TimeSync.h"
+
+/*
+===============================================================================
+  TimeSync.cpp
+===============================================================================
+
+  Runs once per ping (10 Hz or so), so float math is fine here; toHostUs()
+  is one float multiply per telemetry frame.
+===============================================================================
+*/
+
+namespace {
+
+constexpr float MAX_DRIFT = TIMESYNC_MAX_DRIFT_PPM * 1e-6f;
+
+inline int32_t absI32(int32_t v) { return (v < 0) ? -v : v; }
+
+}  // namespace
+
+
+void TimeSync::reset() {
+  *this = TimeSync();
+}
+
+bool TimeSync::addExchange(uint32_t t1, uint32_t t2, uint32_t t3, uint32_t t4) {
+  int32_t delay = (int32_t)((t4 - t1) - (t3 - t2));
+  if (delay < 0) delay = 0;   // host stamp granularity
+
+  // Relax the fast-trip bound a little every exchange so it can recover
+  // after the link gets slower for good
+  if (_accepted) _best_delay_us += TIMESYNC_DELAY_SLACK_US / 8;
+
+  if ((uint32_t)delay > TIMESYNC_MAX_DELAY_US ||
+      (_accepted && (uint32_t)delay > _best_delay_us + TIMESYNC_DELAY_SLACK_US)) {
+    if (_rejected < 0xFFFF) _rejected++;
+    return false;
+  }
+
+  // Measured at the midpoint of the Arduino's hold time
+  const uint32_t offset = (t1 - t2) + (uint32_t)(delay / 2);
+  const uint32_t mid = t2 + (t3 - t2) / 2;
+
+  if (!_accepted) {
+    restart_(mid, offset, (uint32_t)delay);
+    return true;
+  }
+
+  const uint32_t predicted = offsetUs(mid);
+  const int32_t err = (int32_t)(offset - predicted);
+  if (absI32(err) > (int32_t)TIMESYNC_RESYNC_US) {
+    restart_(mid, offset, (uint32_t)delay);
+    return true;
+  }
+
+  const int32_t dt = (int32_t)(mid - _ref_us);
+  if (dt > 0) {
+    _drift += TIMESYNC_DRIFT_GAIN * (float)err / (float)dt;
+    if (_drift > MAX_DRIFT) _drift = MAX_DRIFT;
+    if (_drift < -MAX_DRIFT) _drift = -MAX_DRIFT;
+  }
+
+  _offset_us = predicted + (uint32_t)(int32_t)(TIMESYNC_OFFSET_GAIN * (float)err);
+  _ref_us = mid;
+
+  _delay_us = (uint32_t)delay;
+  if (_delay_us < _best_delay_us) _best_delay_us = _delay_us;
+  if (_accepted < 0xFFFF) _accepted++;
+  return true;
+}
+
+uint32_t TimeSync::toHostUs(uint32_t arduino_us) const {
+  const int32_t dt = (int32_t)(arduino_us - _ref_us);
+  return arduino_us + _offset_us + (uint32_t)(int32_t)(_drift * (float)dt);
+}
+
+void TimeSync::restart_(uint32_t mid_us, uint32_t offset_us, uint32_t delay_us) {
+  _ref_us = mid_us;
+  _offset_us = offset_us;
+  _drift = 0.0f;
+  _delay_us = delay_us;
+  _best_delay_us = delay_us;
+  _accepted = 1;
+}
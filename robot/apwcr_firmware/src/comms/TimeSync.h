@@ -0,0 +1,84 @@
+#pragma once
+#include <Arduino.h>
+
+#include "Params.h"
+
+/*
+===============================================================================
+  TimeSync.h
+===============================================================================
+
+  PURPOSE
+  -------
+  Keeps a running estimate of the host clock in terms of micros(), from
+  NTP-style ping exchanges (see PingRequest in comms/Messages.h):
+
+    t1  host sends ping         t2  Arduino parses it
+    t4  host receives pong      t3  Arduino stages the pong
+
+    offset = ((t1 - t2) + (t4 - t3)) / 2      host - Arduino
+    delay  = (t4 - t1) - (t3 - t2)            round trip on the wire
+
+  All stamps are 32-bit microseconds and every difference is taken modulo
+  2^32, so neither clock's wrap (71 min) matters.
+
+  Estimate:
+    host(a) = offset + (a - ref) * (1 + drift)
+  Each accepted exchange compares its measured offset with the prediction
+  at the exchange midpoint and moves the offset by TIMESYNC_OFFSET_GAIN of
+  the error and the drift by TIMESYNC_DRIFT_GAIN of the error rate (a
+  second-order PLL, so a constant rate difference is tracked with no
+  steady offset error).
+
+  Filtering:
+    - Exchanges slower than TIMESYNC_MAX_DELAY_US are ignored
+    - So is any exchange more than TIMESYNC_DELAY_SLACK_US slower than the
+      fastest recent one (queuing makes a slow trip asymmetric); the
+      "fastest recent" bound relaxes by a slack/8 per exchange
+    - A measured error over TIMESYNC_RESYNC_US (host clock stepped, e.g.
+      NTP on the laptop) restarts the estimate from that exchange
+
+  t2 is taken when the RX task parses the ping, so it can be up to one RX
+  period late; that reads as a shorter delay and biases the offset by
+  about half of it.
+===============================================================================
+*/
+
+class TimeSync {
+public:
+  void reset();
+
+  /*
+    One complete exchange: host t1/t4, Arduino t2/t3 (us). Returns false
+    if it was rejected by the delay filter.
+  */
+  bool addExchange(uint32_t t1, uint32_t t2, uint32_t t3, uint32_t t4);
+
+  // TIMESYNC_SYNC_EXCHANGES accepted since the last (re)start
+  bool synced() const { return _accepted >= TIMESYNC_SYNC_EXCHANGES; }
+
+  // Arduino micros() -> host clock (meaningful once synced())
+  uint32_t toHostUs(uint32_t arduino_us) const;
+
+  // host - Arduino at arduino_us (mod 2^32)
+  uint32_t offsetUs(uint32_t arduino_us) const { return toHostUs(arduino_us) - arduino_us; }
+
+  float driftPpm() const { return _drift * 1e6f; }
+  uint32_t delayUs() const { return _delay_us; }    // last accepted exchange
+
+  uint16_t accepted() const { return _accepted; }
+  uint16_t rejected() const { return _rejected; }
+
+private:
+  void restart_(uint32_t mid_us, uint32_t offset_us, uint32_t delay_us);
+
+  uint32_t _ref_us = 0;        // Arduino time of the current estimate
+  uint32_t _offset_us = 0;     // host - Arduino at _ref_us
+  float _drift = 0.0f;         // host us per Arduino us, minus 1
+
+  uint32_t _delay_us = 0;
+  uint32_t _best_delay_us = 0;
+
+  uint16_t _accepted = 0;
+  uint16_t _rejected = 0;
+};
@@ -0,0 +1,260 @@
+#include "comms/Uart.h"
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+#include <string.h>
+
+#include "Params.h"
+#include "utils/ScopeMarker.h"
+
+/*
+===============================================================================
+  Uart.cpp
+===============================================================================
+
+  Ownership of the ring indices:
+    RX: ISR writes _rx_head, main writes _rx_tail
+    TX: main writes _tx_head, ISR writes _tx_tail
+  Indices are 16-bit, so the owner of each one writes it with interrupts
+  off and the other side reads it the same way (one AVR load is 8 bits).
+
+  Register bit positions are identical for USART0..3 on the ATmega2560,
+  so the USART0 names are used for every instance.
+===============================================================================
+*/
+
+namespace {
+
+constexpr bool isPow2(uint16_t n) { return n && ((n & (n - 1)) == 0); }
+
+static_assert(isPow2(SERIAL_RX_RING_BYTES), "SERIAL_RX_RING_BYTES must be a power of two");
+static_assert(isPow2(SERIAL_TX_RING_BYTES), "SERIAL_TX_RING_BYTES must be a power of two");
+
+static_assert(isPow2(AUX_RX_RING_BYTES), "AUX_RX_RING_BYTES must be a power of two");
+static_assert(isPow2(AUX_TX_RING_BYTES), "AUX_TX_RING_BYTES must be a power of two");
+
+uint8_t g_uart0_rx[SERIAL_RX_RING_BYTES];
+uint8_t g_uart0_tx[SERIAL_TX_RING_BYTES];
+
+// USART2 only runs for the aux link or RX capture; otherwise Uart2 is never
+// begun and its rings shrink to a byte
+constexpr bool UART2_USED = ENABLE_AUX_LINK || ENABLE_RX_CAPTURE;
+uint8_t g_uart2_rx[UART2_USED ? AUX_RX_RING_BYTES : 1];
+uint8_t g_uart2_tx[UART2_USED ? AUX_TX_RING_BYTES : 1];
+
+bool interruptsEnabled() { return (SREG & (1 << SREG_I)) != 0; }
+
+}  // namespace
+
+Uart Uart0({ &UBRR0H, &UBRR0L, &UCSR0A, &UCSR0B, &UCSR0C, &UDR0 },
+           g_uart0_rx, sizeof(g_uart0_rx),
+           g_uart0_tx, sizeof(g_uart0_tx));
+
+ISR(USART0_RX_vect) { ScopeSpan mark(ScopeMark::UART0_ISR); Uart0.rxIsr_(); }
+ISR(USART0_UDRE_vect) { ScopeSpan mark(ScopeMark::UART0_ISR); Uart0.udreIsr_(); }
+
+Uart Uart2({ &UBRR2H, &UBRR2L, &UCSR2A, &UCSR2B, &UCSR2C, &UDR2 },
+           g_uart2_rx, sizeof(g_uart2_rx),
+           g_uart2_tx, sizeof(g_uart2_tx));
+
+ISR(USART2_RX_vect) { ScopeSpan mark(ScopeMark::UART2_ISR); Uart2.rxIsr_(); }
+ISR(USART2_UDRE_vect) { ScopeSpan mark(ScopeMark::UART2_ISR); Uart2.udreIsr_(); }
+
+
+Uart::Uart(const Regs& regs,
+           uint8_t* rx_buf, uint16_t rx_size,
+           uint8_t* tx_buf, uint16_t tx_size)
+: _regs(regs),
+  _rx_buf(rx_buf),
+  _rx_mask((uint16_t)(rx_size - 1)),
+  _tx_buf(tx_buf),
+  _tx_mask((uint16_t)(tx_size - 1))
+{
+}
+
+void Uart::begin(uint32_t baud) {
+  // Double-speed mode first, as HardwareSerial does (57600 @ 16 MHz is
+  // closer to nominal without it)
+  uint16_t setting = (uint16_t)((F_CPU / 4 / baud - 1) / 2);
+  *_regs.ucsra = (1 << U2X0);
+  if (((F_CPU == 16000000UL) && (baud == 57600)) || (setting > 4095)) {
+    *_regs.ucsra = 0;
+    setting = (uint16_t)((F_CPU / 8 / baud - 1) / 2);
+  }
+
+  *_regs.ubrrh = (uint8_t)(setting >> 8);
+  *_regs.ubrrl = (uint8_t)setting;
+
+  _written = false;
+
+  *_regs.ucsrc = (1 << UCSZ01) | (1 << UCSZ00);   // 8N1
+  *_regs.ucsrb = (1 << RXEN0) | (1 << TXEN0) | (1 << RXCIE0);
+}
+
+void Uart::end() {
+  flush();
+  *_regs.ucsrb &= (uint8_t)~((1 << RXEN0) | (1 << TXEN0) | (1 << RXCIE0) | (1 << UDRIE0));
+
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    _rx_head = _rx_tail = 0;
+    _tx_head = _tx_tail = 0;
+  }
+}
+
+
+/*=============================================================================
+  RX
+=============================================================================*/
+
+uint16_t Uart::rxHead_() const {
+  uint16_t h;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { h = _rx_head; }
+  return h;
+}
+
+void Uart::rxIsr_() {
+  // Status must be read before UDR (reading UDR clears DOR)
+  const uint8_t status = *_regs.ucsra;
+  const uint8_t c = *_regs.udr;
+
+  if (status & (1 << DOR0)) _rx_dropped++;
+
+  const uint16_t next = (uint16_t)((_rx_head + 1) & _rx_mask);
+  if (next == _rx_tail) {
+    _rx_dropped++;
+    return;
+  }
+
+  _rx_buf[_rx_head] = c;
+  _rx_head = next;
+}
+
+int Uart::available() {
+  return (int)((uint16_t)(rxHead_() - _rx_tail) & _rx_mask);
+}
+
+int Uart::peek() {
+  if (rxHead_() == _rx_tail) return -1;
+  return _rx_buf[_rx_tail];
+}
+
+int Uart::read() {
+  if (rxHead_() == _rx_tail) return -1;
+  const uint8_t c = _rx_buf[_rx_tail];
+  consume(1);
+  return c;
+}
+
+size_t Uart::peekBuffer(const uint8_t*& data) {
+  const uint16_t head = rxHead_();
+  data = _rx_buf + _rx_tail;
+
+  // Up to the head, or to the end of the array if the data wraps
+  if (head >= _rx_tail) return (size_t)(head - _rx_tail);
+  return (size_t)(_rx_mask + 1 - _rx_tail);
+}
+
+void Uart::consume(size_t n) {
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    _rx_tail = (uint16_t)((_rx_tail + n) & _rx_mask);
+  }
+}
+
+uint32_t Uart::rxDropped() const {
+  uint32_t n;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { n = _rx_dropped; }
+  return n;
+}
+
+
+/*=============================================================================
+  TX
+=============================================================================*/
+
+uint16_t Uart::txTail_() const {
+  uint16_t t;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { t = _tx_tail; }
+  return t;
+}
+
+void Uart::udreIsr_() {
+  const uint8_t c = _tx_buf[_tx_tail];
+  _tx_tail = (uint16_t)((_tx_tail + 1) & _tx_mask);
+
+  *_regs.udr = c;
+
+  // Clear TXC (write 1) so flush() can tell when the last byte is out
+  *_regs.ucsra = (uint8_t)((*_regs.ucsra & ((1 << U2X0) | (1 << MPCM0))) | (1 << TXC0));
+
+  if (_tx_tail == _tx_head) *_regs.ucsrb &= (uint8_t)~(1 << UDRIE0);
+}
+
+size_t Uart::write(uint8_t c) {
+  _written = true;
+
+  // Ring empty and data register free: skip the ring (and the interrupt)
+  if (_tx_head == txTail_() && (*_regs.ucsra & (1 << UDRE0))) {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+      *_regs.udr = c;
+      *_regs.ucsra = (uint8_t)((*_regs.ucsra & ((1 << U2X0) | (1 << MPCM0))) | (1 << TXC0));
+    }
+    return 1;
+  }
+
+  const uint16_t next = (uint16_t)((_tx_head + 1) & _tx_mask);
+  while (next == txTail_()) {
+    // With interrupts off nothing else drains the ring; poll the register
+    if (!interruptsEnabled() && (*_regs.ucsra & (1 << UDRE0))) udreIsr_();
+  }
+
+  _tx_buf[_tx_head] = c;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    _tx_head = next;
+    *_regs.ucsrb |= (1 << UDRIE0);
+  }
+  return 1;
+}
+
+size_t Uart::write(const uint8_t* buffer, size_t size) {
+  size_t done = 0;
+  while (done < size) {
+    const uint16_t tail = txTail_();
+    const uint16_t room = (uint16_t)((tail - _tx_head - 1) & _tx_mask);
+
+    // Empty ring (direct-to-UDR path) or full ring (wait): one byte at a time
+    if (room == 0 || _tx_head == tail) {
+      write(buffer[done++]);
+      continue;
+    }
+
+    size_t n = size - done;
+    if (n > room) n = room;
+    const size_t to_end = (size_t)(_tx_mask + 1 - _tx_head);
+    if (n > to_end) n = to_end;
+
+    memcpy(_tx_buf + _tx_head, buffer + done, n);
+    done += n;
+    _written = true;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+      _tx_head = (uint16_t)((_tx_head + n) & _tx_mask);
+      *_regs.ucsrb |= (1 << UDRIE0);
+    }
+  }
+  return size;
+}
+
+int Uart::availableForWrite() {
+  return (int)((uint16_t)(txTail_() - _tx_head - 1) & _tx_mask);
+}
+
+void Uart::flush() {
+  if (!_written) return;
+
+  while ((*_regs.ucsrb & (1 << UDRIE0)) || !(*_regs.ucsra & (1 << TXC0))) {
+    if (!interruptsEnabled() && (*_regs.ucsrb & (1 << UDRIE0)) && (*_regs.ucsra & (1 << UDRE0))) {
+      udreIsr_();
+    }
+  }
+}
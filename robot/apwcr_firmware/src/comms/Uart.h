@@ -0,0 +1,102 @@
+#pragma once
+#include <Arduino.h>
+
+#include "comms/BulkStream.h"
+
+/*
+===============================================================================
+  Uart.h
+===============================================================================
+
+  PURPOSE
+  -------
+  Interrupt-driven USART driver with caller-sized ring buffers. Replaces
+  HardwareSerial for the laptop link, whose fixed 64 B RX buffer overflows
+  after ~3 ms of traffic at 230400 baud whenever loop() stalls.
+
+    - RX ISR stores each byte in an RX ring (SERIAL_RX_RING_BYTES, or
+      AUX_RX_RING_BYTES for Uart2)
+    - TX bytes go into a TX ring drained by the UDRE interrupt
+    - peekBuffer()/consume() expose the RX ring for bulk scanning
+
+  Ring sizes must be powers of two (index wrap is a mask).
+
+  IMPORTANT
+  ---------
+  Uart0 owns the USART0 vectors, so the core's `Serial` must never be
+  referenced anywhere in the build (its ISRs would collide at link time).
+  Use SERIAL_USB (Pins.h), which maps to Uart0. Likewise Uart2 owns USART2
+  (SERIAL_AUX), so `Serial2` must not be used either.
+===============================================================================
+*/
+
+class Uart : public BulkStream {
+public:
+  struct Regs {
+    volatile uint8_t* ubrrh;
+    volatile uint8_t* ubrrl;
+    volatile uint8_t* ucsra;
+    volatile uint8_t* ucsrb;
+    volatile uint8_t* ucsrc;
+    volatile uint8_t* udr;
+  };
+
+  Uart(const Regs& regs,
+       uint8_t* rx_buf, uint16_t rx_size,
+       uint8_t* tx_buf, uint16_t tx_size);
+
+  // 8N1, same baud divisor selection as HardwareSerial::begin
+  void begin(uint32_t baud);
+  void end();
+
+  // Stream
+  int available() override;
+  int read() override;
+  int peek() override;
+
+  // Print. Blocks only while the TX ring is full.
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t* buffer, size_t size) override;   // memcpy into the ring
+  using Print::write;
+
+  int availableForWrite() override;
+
+  // Wait until every queued byte has left the shift register.
+  void flush() override;
+
+  // BulkStream
+  size_t peekBuffer(const uint8_t*& data) override;
+  void consume(size_t n) override;
+
+  // Bytes lost because the RX ring was full, or to hardware overruns
+  uint32_t rxDropped() const;
+
+  // Called from the USART interrupts (public only so the ISRs can reach them)
+  void rxIsr_();
+  void udreIsr_();
+
+private:
+  uint16_t rxHead_() const;
+  uint16_t txTail_() const;
+
+  Regs _regs;
+
+  uint8_t* _rx_buf;
+  uint16_t _rx_mask;
+  volatile uint16_t _rx_head = 0;   // written by ISR
+  volatile uint16_t _rx_tail = 0;
+
+  uint8_t* _tx_buf;
+  uint16_t _tx_mask;
+  volatile uint16_t _tx_head = 0;
+  volatile uint16_t _tx_tail = 0;   // written by ISR
+
+  volatile uint32_t _rx_dropped = 0;
+  bool _written = false;
+};
+
+// USART0 (USB / laptop link)
+extern Uart Uart0;
+
+// USART2 (Pi GPIO UART, telemetry offload)
+extern Uart Uart2;
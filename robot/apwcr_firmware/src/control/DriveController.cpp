@@ -0,0 +1,303 @@
+#include "control/DriveController.h"
+#include <math.h>  // fabsf
+
+#include "Params.h"
+
+/*
+===============================================================================
+  DriveController.cpp
+===============================================================================
+*/
+
+namespace {
+
+constexpr float DEG_TO_RAD_F = PI / 180.0f;
+constexpr float HALF_TRACK_FT = 0.5f * TRACK_WIDTH_FT;
+
+float clampAbs(float v, float limit) {
+  if (v > limit) return limit;
+  if (v < -limit) return -limit;
+  return v;
+}
+
+}  // namespace
+
+
+DriveController::DriveController(EncoderSensor& left_enc,
+                                 EncoderSensor& right_enc,
+                                 DcMotorActuator& left_motor,
+                                 DcMotorActuator& right_motor)
+: _left_enc(left_enc),
+  _right_enc(right_enc),
+  _left_motor(left_motor),
+  _right_motor(right_motor),
+  _left_pid(DRIVE_KP, DRIVE_KI, DRIVE_KD, DRIVE_INTEGRAL_LIMIT, -1.0f, 1.0f),
+  _right_pid(DRIVE_KP, DRIVE_KI, DRIVE_KD, DRIVE_INTEGRAL_LIMIT, -1.0f, 1.0f)
+{
+}
+
+void DriveController::begin() {
+  _left_enc.begin();
+  _right_enc.begin();
+  _left_motor.begin();
+  _right_motor.begin();
+
+  _state = State();
+  _has_tick = false;
+  stop();
+}
+
+void DriveController::setCommand(const DriveCommand& cmd) {
+  _cmd = cmd;
+  applyCommand_();
+}
+
+void DriveController::setForwardLimit(float limit_ftps) {
+  if (limit_ftps < 0.0f) limit_ftps = 0.0f;
+  if (limit_ftps == _state.forward_limit_ftps) return;
+  _state.forward_limit_ftps = limit_ftps;
+  applyCommand_();
+}
+
+void DriveController::setGains(float kp, float ki, float kd, float integral_limit) {
+  _left_pid.setGains(kp, ki, kd);
+  _right_pid.setGains(kp, ki, kd);
+  _left_pid.setIntegralLimit(integral_limit);
+  _right_pid.setIntegralLimit(integral_limit);
+  if (_inner) _inner->setGains(kp, ki, kd, integral_limit);
+}
+
+void DriveController::setLimits(float max_linear_ftps, float max_angular_dps) {
+  _max_linear_ftps = constrain(max_linear_ftps, 0.0f, MAX_LINEAR_SPEED_FTPS);
+  _max_angular_dps = constrain(max_angular_dps, 0.0f, MAX_ANGULAR_SPEED_DPS);
+  applyCommand_();
+}
+
+void DriveController::applyCommand_() {
+  float v = clampAbs(_cmd.linear_ftps, _max_linear_ftps);
+  const float w_rad = clampAbs(_cmd.angular_dps, _max_angular_dps) * DEG_TO_RAD_F;
+
+  _state.limited = (v > _state.forward_limit_ftps);
+  if (_state.limited) v = _state.forward_limit_ftps;
+
+  float left = v - w_rad * HALF_TRACK_FT;
+  float right = v + w_rad * HALF_TRACK_FT;
+
+  // Desaturate together so the commanded curvature is kept
+  const float peak = fmaxf(fabsf(left), fabsf(right));
+  if (peak > _max_linear_ftps) {
+    const float k = _max_linear_ftps / peak;
+    left *= k;
+    right *= k;
+  }
+
+  _state.left.target_ftps = left;
+  _state.right.target_ftps = right;
+}
+
+void DriveController::stop() {
+  if (stepTestRunning()) endStepTest_(StepTest::Phase::ABORTED);
+
+  _cmd = DriveCommand();
+  _state.limited = false;
+  _state.left.target_ftps = 0.0f;
+  _state.right.target_ftps = 0.0f;
+
+  coastBoth_();
+  _state.active = false;
+}
+
+void DriveController::coastBoth_() {
+  if (_inner) _inner->release();
+  _left_motor.coast();
+  _right_motor.coast();
+  _state.left.duty = _state.left.ff_duty = _state.left.ramp_ftps = 0.0f;
+  _state.right.duty = _state.right.ff_duty = _state.right.ramp_ftps = 0.0f;
+
+  _left_pid.reset();
+  _right_pid.reset();
+}
+
+void DriveController::tick(uint32_t now_ms) {
+  const uint32_t dt_ms = _has_tick ? (now_ms - _state.last_tick_ms) : 0;
+  _state.last_tick_ms = now_ms;
+  _has_tick = true;
+
+  const float dt_s = (float)dt_ms * 0.001f;
+  measure_(_left_enc, _state.left);
+  measure_(_right_enc, _state.right);
+
+  bool closed = false;
+  if (stepTestRunning()) {
+    runStepTest_(now_ms, dt_s);
+  } else {
+    const bool left = runWheel_(_left_motor, _left_pid, _state.left, dt_s);
+    const bool right = runWheel_(_right_motor, _right_pid, _state.right, dt_s);
+    if (_inner) runInner_(left, right);
+    closed = left || right;
+  }
+
+  // (the ISR may not have written a duty yet for a wheel just handed over)
+  _state.active = (_state.left.duty != 0.0f) || (_state.right.duty != 0.0f) || (_inner && closed);
+}
+
+void DriveController::runInner_(bool left_run, bool right_run) {
+  DriveInnerLoop::Wheel left, right;
+  left.run = left_run;
+  left.ref_ftps = _state.left.ramp_ftps;
+  left.ff_duty = _state.left.ff_duty;
+  right.run = right_run;
+  right.ref_ftps = _state.right.ramp_ftps;
+  right.ff_duty = _state.right.ff_duty;
+  _inner->setTargets(left, right);
+
+  if (left_run) _state.left.duty = _inner->duty(0);
+  if (right_run) _state.right.duty = _inner->duty(1);
+}
+
+void DriveController::measure_(EncoderSensor& enc, WheelState& ws) {
+  const EncoderSensor::State& es = enc.getState();
+  if (es.valid_speed) {
+    ws.rpm = es.rpm;
+    ws.speed_ftps = es.rps_filtered * WHEEL_CIRCUMFERENCE_FT;
+  }
+}
+
+bool DriveController::runWheel_(DcMotorActuator& motor, PID& pid, WheelState& ws, float dt_s) {
+  // Parked: coast instead of holding zero with a twitchy loop (the inner
+  // loop coasts it when it lets go)
+  if (ws.target_ftps == 0.0f && fabsf(ws.speed_ftps) < DRIVE_STOPPED_FTPS) {
+    if (ws.duty != 0.0f && !_inner) motor.coast();
+    ws.duty = ws.ff_duty = ws.ramp_ftps = 0.0f;
+    pid.reset();
+    return false;
+  }
+
+  // Slew toward the target: speeding up at accel, slowing down (and
+  // through zero on a reversal) at decel
+  const bool speeding_up = (ws.target_ftps * ws.ramp_ftps >= 0.0f) && fabsf(ws.target_ftps) > fabsf(ws.ramp_ftps);
+  const float step = (speeding_up ? _accel_ftps2 : _decel_ftps2) * dt_s;
+  const float err = ws.target_ftps - ws.ramp_ftps;
+  ws.ramp_ftps = (fabsf(err) <= step) ? ws.target_ftps : ws.ramp_ftps + ((err > 0.0f) ? step : -step);
+
+  ws.ff_duty = (ws.ramp_ftps == 0.0f) ? 0.0f : copysignf(_ff_ks, ws.ramp_ftps) + _ff_kv * ws.ramp_ftps;
+  ws.ff_duty = clampAbs(ws.ff_duty, 1.0f);
+  if (_inner) return true;
+
+  // The PID gets what the feed-forward leaves of the duty range
+  pid.setOutputLimits(-1.0f - ws.ff_duty, 1.0f - ws.ff_duty);
+  ws.duty = ws.ff_duty + pid.update(ws.ramp_ftps, ws.speed_ftps, dt_s);
+  motor.setDuty(ws.duty);
+  return true;
+}
+
+
+/*=============================================================================
+  STEP TEST
+=============================================================================*/
+
+bool DriveController::startStepTest(float duty, uint32_t now_ms) {
+  if (!(duty > 0.0f) || stepTestRunning()) return false;
+
+  coastBoth_();
+  _test.phase = StepTest::Phase::BREAKAWAY;
+  _test.duty = (duty < DRIVE_STEP_MAX_DUTY) ? duty : DRIVE_STEP_MAX_DUTY;
+  _test.left = StepResult();
+  _test.right = StepResult();
+  _test_t0_ms = now_ms;
+  _ramp_duty = 0.0f;
+  return true;
+}
+
+void DriveController::abortStepTest() {
+  if (stepTestRunning()) endStepTest_(StepTest::Phase::ABORTED);
+}
+
+bool DriveController::stepTestRunning() const {
+  return _test.phase == StepTest::Phase::BREAKAWAY ||
+         _test.phase == StepTest::Phase::REST ||
+         _test.phase == StepTest::Phase::STEP;
+}
+
+void DriveController::endStepTest_(StepTest::Phase phase) {
+  coastBoth_();
+  _test.phase = phase;
+  _test.gen++;
+}
+
+void DriveController::runStepTest_(uint32_t now_ms, float dt_s) {
+  WheelState* const ws[2] = {&_state.left, &_state.right};
+  DcMotorActuator* const motor[2] = {&_left_motor, &_right_motor};
+  StepResult* const res[2] = {&_test.left, &_test.right};
+  const uint32_t t_ms = now_ms - _test_t0_ms;
+
+  switch (_test.phase) {
+    case StepTest::Phase::BREAKAWAY: {
+      // Ramp until each wheel turns; a wheel that has turned is let go
+      _ramp_duty += DRIVE_STEP_KS_RAMP * dt_s;
+      bool all_free = true;
+      for (uint8_t i = 0; i < 2; i++) {
+        if (!isnan(res[i]->ks)) continue;
+        if (ws[i]->speed_ftps > DRIVE_STOPPED_FTPS) {
+          res[i]->ks = _ramp_duty;
+          motor[i]->coast();
+          ws[i]->duty = 0.0f;
+        } else {
+          all_free = false;
+          ws[i]->duty = _ramp_duty;
+          motor[i]->setDuty(ws[i]->duty);
+        }
+      }
+      if (all_free || _ramp_duty >= DRIVE_STEP_MAX_DUTY) {
+        coastBoth_();
+        _test.phase = StepTest::Phase::REST;
+        _test_t0_ms = now_ms;
+      }
+      break;
+    }
+
+    case StepTest::Phase::REST: {
+      const bool stopped = fabsf(_state.left.speed_ftps) < DRIVE_STOPPED_FTPS &&
+                           fabsf(_state.right.speed_ftps) < DRIVE_STOPPED_FTPS;
+      if ((t_ms >= DRIVE_STEP_REST_MS && stopped) || t_ms >= 4UL * DRIVE_STEP_REST_MS) {
+        _test.phase = StepTest::Phase::STEP;
+        _test_t0_ms = now_ms;
+        _step_area[0] = _step_area[1] = 0.0f;
+        _tail_sum[0] = _tail_sum[1] = 0.0f;
+        _step_s = _tail_s = 0.0f;
+        for (uint8_t i = 0; i < 2; i++) {
+          ws[i]->duty = _test.duty;
+          motor[i]->setDuty(ws[i]->duty);
+        }
+      }
+      break;
+    }
+
+    case StepTest::Phase::STEP: {
+      // Speed integral over the step, and over its last quarter
+      const bool tail = t_ms * 4UL >= 3UL * DRIVE_STEP_MS;
+      _step_s += dt_s;
+      if (tail) _tail_s += dt_s;
+      for (uint8_t i = 0; i < 2; i++) {
+        _step_area[i] += ws[i]->speed_ftps * dt_s;
+        if (tail) _tail_sum[i] += ws[i]->speed_ftps * dt_s;
+      }
+      if (t_ms < DRIVE_STEP_MS) break;
+
+      // First order: the area between v_ss and the response is v_ss * tau
+      for (uint8_t i = 0; i < 2; i++) {
+        const float v_ss = (_tail_s > 0.0f) ? _tail_sum[i] / _tail_s : 0.0f;
+        if (v_ss <= DRIVE_STOPPED_FTPS) continue;   // didn't move (or turned backwards)
+        const float ks = isnan(res[i]->ks) ? 0.0f : res[i]->ks;
+        res[i]->v_ss = v_ss;
+        res[i]->kv = (_test.duty - ks) / v_ss;
+        res[i]->tau_s = fmaxf(0.0f, (v_ss * _step_s - _step_area[i]) / v_ss);
+      }
+      endStepTest_(StepTest::Phase::DONE);
+      break;
+    }
+
+    default:
+      break;
+  }
+}
@@ -0,0 +1,189 @@
+#pragma once
+#include <Arduino.h>
+
+#include "Params.h"
+#include "comms/Messages.h"
+#include "control/PID.h"
+#include "control/DriveInnerLoop.h"
+#include "sensors/EncoderSensor.h"
+#include "actuators/DcMotorActuator.h"
+
+/*
+===============================================================================
+  DriveController.h
+===============================================================================
+
+  PURPOSE
+  -------
+  Closed-loop controller for the differential drive base. Converts the
+  host's DriveCommand (linear ft/s, angular deg/s) into per-wheel speed
+  targets and runs one velocity PID per wheel on encoder feedback.
+
+  Kinematics (TRACK_WIDTH_FT = W):
+    v_left  = v - omega * W / 2
+    v_right = v + omega * W / 2
+  with omega in rad/s. Commands are clamped to the speed limits
+  (MAX_LINEAR_SPEED_FTPS / MAX_ANGULAR_SPEED_DPS unless setLimits() lowered
+  them), then both wheel targets are scaled down together if either
+  exceeds the linear limit (turn radius is preserved).
+  A forward limit (ObstacleGuard) caps positive v on top of that; the
+  angular rate is kept, so the base can still turn away or back off.
+
+  Control:
+    - Each wheel target is slewed (DRIVE_ACCEL_FTPS2 speeding up,
+      DRIVE_DECEL_FTPS2 slowing down), so a step command doesn't jerk
+      the chassis; the loops track the slewed target
+    - Feed-forward sign(v) * kS + kV * v puts the duty close to right at
+      once; the PID (error in wheel surface speed, ft/s) trims the rest.
+      The PID is clamped to what the feed-forward leaves of [-1, 1], so
+      its anti-windup sees the real saturation
+    - Feedback is the encoders' filtered edge-timed velocity (rps_filtered),
+      which stays usable down to crawl speed
+    - Zero target with the wheel (nearly) stopped coasts the motor and
+      clears the integrator so the base doesn't hum at rest
+
+  Inner loop (setInnerLoop, ENABLE_DRIVE_ISR_LOOP): the PID step and the
+  motor writes move to a DriveInnerLoop in the Timer1 ISR. tick() still
+  does everything up to the feed-forward and hands each wheel's slewed
+  target and ff duty over; a parked wheel is released to coast. The
+  duties in State are then the ones the ISR last wrote.
+
+  Step test (startStepTest): open-loop identification of kS, kV and the
+  time constant per wheel (phases and constants in Params.h, DRIVE_STEP_*).
+  While it runs the test owns the motors; commands are still taken and
+  apply, slewed from rest, once it is over. stop() aborts it.
+
+  USAGE
+  -----
+  - begin() once in setup() (after the encoders/motors exist)
+  - setCommand(...) when a new command arrives, stop() on timeout
+  - setForwardLimit(...) each tick from the obstacle guard
+  - setGains / setLimits / setFeedForward / setSlew between ticks when
+    tuning (utils/ParamStore)
+  - tick(now_ms) at DRIVE_UPDATE_HZ, right after the encoders were sampled
+    (EncoderBank::sample): tick() uses their State, it doesn't sample
+===============================================================================
+*/
+
+class DriveController {
+public:
+  struct WheelState {
+    float target_ftps = 0.0f;
+    float ramp_ftps = 0.0f;     // slewed target the loop tracks
+    float speed_ftps = 0.0f;    // measured surface speed (filtered)
+    float rpm = 0.0f;           // measured wheel RPM
+    float ff_duty = 0.0f;       // feed-forward part of duty
+    float duty = 0.0f;          // last motor command
+  };
+
+  struct StepResult {
+    float ks = NAN;             // breakaway duty (NAN = didn't turn by DRIVE_STEP_MAX_DUTY)
+    float v_ss = NAN;           // steady speed at the step duty (ft/s)
+    float kv = NAN;             // (duty - ks) / v_ss
+    float tau_s = NAN;          // first-order time constant
+  };
+
+  struct StepTest {
+    enum class Phase : uint8_t { IDLE = 0, BREAKAWAY, REST, STEP, DONE, ABORTED };
+    Phase phase = Phase::IDLE;
+    float duty = 0.0f;          // step duty
+    StepResult left;
+    StepResult right;
+    uint8_t gen = 0;            // bumped when a test ends (DONE or ABORTED)
+  };
+
+  struct State {
+    WheelState left;
+    WheelState right;
+    float forward_limit_ftps = MAX_LINEAR_SPEED_FTPS;
+    bool limited = false;       // the forward limit is cutting the command
+    bool active = false;        // false = coasting with zero targets
+    uint32_t last_tick_ms = 0;
+  };
+
+  DriveController(EncoderSensor& left_enc,
+                  EncoderSensor& right_enc,
+                  DcMotorActuator& left_motor,
+                  DcMotorActuator& right_motor);
+
+  void begin();
+
+  // Wheel PIDs run by `loop` from the Timer1 ISR (nullptr = in tick()).
+  // Set before begin().
+  void setInnerLoop(DriveInnerLoop* loop) { _inner = loop; }
+
+  // Converts (linear, angular) into wheel targets. Does not touch motors.
+  void setCommand(const DriveCommand& cmd);
+
+  // Cap on forward linear speed (ft/s, >= 0), applied to the current and
+  // every later command until changed.
+  void setForwardLimit(float limit_ftps);
+
+  // Both wheel PIDs (as DRIVE_KP .. DRIVE_INTEGRAL_LIMIT). Integrators are kept.
+  void setGains(float kp, float ki, float kd, float integral_limit);
+
+  // Speed limits for later commands (and the current one), clamped to
+  // MAX_LINEAR_SPEED_FTPS / MAX_ANGULAR_SPEED_DPS.
+  void setLimits(float max_linear_ftps, float max_angular_dps);
+
+  // Feed-forward (as DRIVE_FF_KS / DRIVE_FF_KV)
+  void setFeedForward(float ks, float kv) { _ff_ks = ks; _ff_kv = kv; }
+
+  // Target slew limits in ft/s^2 (as DRIVE_ACCEL_FTPS2 / DRIVE_DECEL_FTPS2)
+  void setSlew(float accel_ftps2, float decel_ftps2) { _accel_ftps2 = accel_ftps2; _decel_ftps2 = decel_ftps2; }
+
+  // Starts the step test at `duty` (clamped to DRIVE_STEP_MAX_DUTY). false
+  // if duty is not positive or a test is already running.
+  bool startStepTest(float duty, uint32_t now_ms);
+  void abortStepTest();
+  bool stepTestRunning() const;
+  const StepTest& stepTest() const { return _test; }
+
+  // Zero targets, coast both motors, reset both PIDs (aborts a step test).
+  void stop();
+
+  // Samples encoders and runs both wheel loops.
+  void tick(uint32_t now_ms);
+
+  const State& getState() const { return _state; }
+
+private:
+  void applyCommand_();
+  void measure_(EncoderSensor& enc, WheelState& ws);
+  bool runWheel_(DcMotorActuator& motor, PID& pid, WheelState& ws, float dt_s);
+  void runInner_(bool left_run, bool right_run);
+  void runStepTest_(uint32_t now_ms, float dt_s);
+  void endStepTest_(StepTest::Phase phase);
+  void coastBoth_();
+
+  EncoderSensor& _left_enc;
+  EncoderSensor& _right_enc;
+  DcMotorActuator& _left_motor;
+  DcMotorActuator& _right_motor;
+
+  PID _left_pid;
+  PID _right_pid;
+  DriveInnerLoop* _inner = nullptr;
+
+  float _max_linear_ftps = MAX_LINEAR_SPEED_FTPS;
+  float _max_angular_dps = MAX_ANGULAR_SPEED_DPS;
+
+  float _ff_ks = DRIVE_FF_KS;
+  float _ff_kv = DRIVE_FF_KV;
+  float _accel_ftps2 = DRIVE_ACCEL_FTPS2;
+  float _decel_ftps2 = DRIVE_DECEL_FTPS2;
+
+  // Step test bookkeeping: phase start, and per wheel the step's speed
+  // integral and its last-quarter sum (with the time each covers)
+  StepTest _test;
+  uint32_t _test_t0_ms = 0;
+  float _ramp_duty = 0.0f;
+  float _step_area[2] = {0.0f, 0.0f};
+  float _tail_sum[2] = {0.0f, 0.0f};
+  float _tail_s = 0.0f;
+  float _step_s = 0.0f;
+
+  DriveCommand _cmd;            // as commanded, before the forward limit
+  State _state;
+  bool _has_tick = false;
+};
@@ -0,0 +1,177 @@
+#include "control/DriveInnerLoop.h"
+
+#include <util/atomic.h>
+
+/*
+===============================================================================
+  DriveInnerLoop.cpp
+===============================================================================
+
+  With W = DRIVE_ISR_VEL_WINDOW ticks and c(n) the count at tick n:
+    speed    = (c(n) - c(n-W)) * FEET_PER_COUNT * DRIVE_ISR_HZ / W
+    rate     = (speed(n) - speed(n-W)) * DRIVE_ISR_HZ / W
+             = (c(n) - 2 c(n-W) + c(n-2W)) * FEET_PER_COUNT * DRIVE_ISR_HZ^2 / W^2
+  The ring holds 2W counts, so the slot about to be overwritten is c(n-2W).
+  The rate is low-passed (RATE_FILTER_SHIFT) before the derivative term.
+  Differences are taken in int16: a window is far fewer than 32768 counts,
+  so the low 16 bits of the counts are enough.
+===============================================================================
+*/
+
+static_assert((DRIVE_ISR_VEL_WINDOW & (DRIVE_ISR_VEL_WINDOW - 1)) == 0 && DRIVE_ISR_VEL_WINDOW <= 64,
+              "DRIVE_ISR_VEL_WINDOW must be a power of two, <= 64");
+static_assert(DRIVE_ISR_HZ % ENCODER_SAMPLE_HZ == 0,
+              "DRIVE_ISR_HZ must be a multiple of ENCODER_SAMPLE_HZ (the sampler queues every n-th tick)");
+static_assert((uint32_t)DRIVE_ISR_STALE_MS * DRIVE_ISR_HZ / 1000UL < 255, "stale age is 8-bit");
+
+namespace {
+
+constexpr float SPEED_PER_COUNT = FEET_PER_COUNT * DRIVE_ISR_HZ / DRIVE_ISR_VEL_WINDOW;
+static_assert(SPEED_PER_COUNT < 0.5f, "speed scale must fit scaleQ32");
+constexpr uint32_t SPEED_PER_COUNT_Q32 = fx::q32(SPEED_PER_COUNT);
+
+constexpr Fixed RATE_PER_COUNT = Fixed::fromFloat(SPEED_PER_COUNT * DRIVE_ISR_HZ / DRIVE_ISR_VEL_WINDOW);
+
+// Rate low-pass, a shift: 1/8 per tick (~10 ms at 800 Hz). A count in or
+// out of a window is a 1.8 ft/s^2 step in the raw rate.
+constexpr uint8_t RATE_FILTER_SHIFT = 3;
+
+constexpr uint8_t STALE_TICKS = (uint8_t)((uint32_t)DRIVE_ISR_STALE_MS * DRIVE_ISR_HZ / 1000UL);
+
+constexpr float DT_S = 1.0f / DRIVE_ISR_HZ;
+
+}  // namespace
+
+
+DriveInnerLoop::DriveInnerLoop(DcMotorActuator& left_motor, DcMotorActuator& right_motor)
+: _motor{&left_motor, &right_motor},
+  _pid{PIDFx(DRIVE_KP, DRIVE_KI, DRIVE_KD, DT_S, DRIVE_INTEGRAL_LIMIT),
+       PIDFx(DRIVE_KP, DRIVE_KI, DRIVE_KD, DT_S, DRIVE_INTEGRAL_LIMIT)}
+{
+  _staged.kp = Fixed::fromFloat(DRIVE_KP);
+  _staged.ki = Fixed::fromFloat(DRIVE_KI);
+  _staged.kd = Fixed::fromFloat(DRIVE_KD);
+  _staged.integral_limit = Fixed::fromFloat(DRIVE_INTEGRAL_LIMIT);
+  _buf[0] = _buf[1] = _staged;
+}
+
+void DriveInnerLoop::setGains(float kp, float ki, float kd, float integral_limit) {
+  _staged.kp = Fixed::fromFloat(kp);
+  _staged.ki = Fixed::fromFloat(ki);
+  _staged.kd = Fixed::fromFloat(kd);
+  _staged.integral_limit = Fixed::fromFloat(integral_limit);
+  _staged.gains_gen++;
+}
+
+void DriveInnerLoop::setTargets(const Wheel& left, const Wheel& right) {
+  const Wheel* const w[WHEELS] = {&left, &right};
+  const uint8_t was = _staged.run_mask;
+
+  uint8_t mask = 0;
+  for (uint8_t i = 0; i < WHEELS; i++) {
+    if (!w[i]->run) continue;
+    mask |= (uint8_t)(1u << i);
+    _staged.ref[i] = Fixed::fromFloat(w[i]->ref_ftps);
+    _staged.ff[i] = Fixed::fromFloat(w[i]->ff_duty);
+  }
+  _staged.run_mask = mask;
+  publish_();
+
+  for (uint8_t i = 0; i < WHEELS; i++) {
+    if ((was & ~mask) & (1u << i)) _motor[i]->coast();
+  }
+}
+
+void DriveInnerLoop::release() {
+  _staged.run_mask = 0;
+  publish_();
+  for (uint8_t i = 0; i < WHEELS; i++) _motor[i]->coast();
+}
+
+float DriveInnerLoop::duty(uint8_t wheel) const {
+  int32_t raw;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { raw = _duty_raw[wheel]; }
+  return Fixed::fromRaw(raw).toFloat();
+}
+
+uint16_t DriveInnerLoop::staleTrips() const {
+  uint16_t n;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { n = _stale_trips; }
+  return n;
+}
+
+void DriveInnerLoop::publish_() {
+  const uint8_t back = (uint8_t)(_front ^ 1u);
+  _staged.gen++;
+  _buf[back] = _staged;
+  // The block must be complete before the index points at it
+  asm volatile("" : : : "memory");
+  _front = back;
+}
+
+void DriveInnerLoop::tickIsr_(const int32_t* count) {
+  const Block& b = _buf[_front];
+
+  if (b.gen != _seen_gen) {
+    _seen_gen = b.gen;
+    _age = 0;
+  } else if (_age < STALE_TICKS) {
+    _age++;
+  }
+
+  if (b.gains_gen != _seen_gains) {
+    _seen_gains = b.gains_gen;
+    for (uint8_t i = 0; i < WHEELS; i++) {
+      _pid[i].setGains(b.kp, b.ki, b.kd);
+      _pid[i].setIntegralLimit(b.integral_limit);
+    }
+  }
+
+  const bool stale = (_age >= STALE_TICKS);
+  if (stale && _active) _stale_trips++;
+  const uint8_t run = stale ? 0 : b.run_mask;
+
+  const uint8_t pos = _pos;
+  for (uint8_t i = 0; i < WHEELS; i++) {
+    int16_t* const h = _hist[i];
+    const int16_t c = (int16_t)count[i];
+    if (!_primed) {
+      for (uint8_t j = 0; j < HISTORY; j++) h[j] = c;
+    }
+    const int16_t c_w = h[(uint8_t)(pos - DRIVE_ISR_VEL_WINDOW) & MASK];
+    const int16_t c_2w = h[pos];
+    h[pos] = c;
+
+    const int16_t d1 = (int16_t)(c - c_w);
+    const int16_t d0 = (int16_t)(c_w - c_2w);
+    const int32_t rate_raw = (RATE_PER_COUNT * (int32_t)(d1 - d0)).raw();
+    _rate_raw[i] += (rate_raw - _rate_raw[i]) >> RATE_FILTER_SHIFT;
+
+    const uint8_t bit = (uint8_t)(1u << i);
+    if (!(run & bit)) {
+      if (_active & bit) {
+        _active &= (uint8_t)~bit;
+        _duty_raw[i] = 0;
+        if (stale) _motor[i]->coast();   // otherwise the task coasts it
+      }
+      continue;
+    }
+    if (!(_active & bit)) {
+      _active |= bit;
+      _pid[i].reset();
+    }
+
+    const Fixed speed = fx::scaleQ32(d1, SPEED_PER_COUNT_Q32);
+    const Fixed rate = Fixed::fromRaw(_rate_raw[i]);
+
+    // The PID gets what the feed-forward leaves of the duty range
+    const Fixed ff = b.ff[i];
+    _pid[i].setOutputLimits(-fx::ONE - ff, fx::ONE - ff);
+    const Fixed duty = ff + _pid[i].update(b.ref[i], speed, rate);
+    _motor[i]->setDuty(duty);
+    _duty_raw[i] = duty.raw();
+  }
+
+  _primed = true;
+  _pos = (uint8_t)((pos + 1) & MASK);
+}
@@ -0,0 +1,139 @@
+#pragma once
+#include <Arduino.h>
+
+#include "Params.h"
+#include "control/PIDFx.h"
+#include "actuators/DcMotorActuator.h"
+#include "utils/Fixed.h"
+
+/*
+===============================================================================
+  DriveInnerLoop.h
+===============================================================================
+
+  PURPOSE
+  -------
+  Hard real-time tier of the drive (ENABLE_DRIVE_ISR_LOOP): the two wheel
+  velocity PIDs and their PWM writes, run from the encoder sampler's
+  Timer1 compare ISR at DRIVE_ISR_HZ. However long a telemetry frame or a
+  JSON parse keeps loop() busy, the wheels are corrected on time, each
+  DRIVE_ISR_HZ tick.
+
+  Split with DriveController (the soft tier, drive task, DRIVE_UPDATE_HZ):
+    - DriveController: command -> wheel targets, slew, feed-forward,
+      parking, step test; publishes per wheel {run, ref ft/s, ff duty}
+    - DriveInnerLoop (ISR): speed from the sampler's count snapshot,
+      PIDFx on (ref, speed), duty = ff + PID -> DcMotorActuator::setDuty
+  Each tick is fixed point only (utils/Fixed.h): one scale for the speed,
+  the PIDFx update, the PWM write, no divides.
+
+  Speed and derivative:
+    - speed = counts over the last DRIVE_ISR_VEL_WINDOW ticks (20 ms), an
+      edge count rather than EncoderSensor's edge-timed estimate (which
+      needs a divide per wheel)
+    - a one-tick difference of that speed is mostly quantization (one
+      count in or out of the window), so the derivative term uses the
+      speed change over a whole window, low-passed, instead (PIDFx's
+      rate overload)
+
+  Setpoint handoff, lock-free: two setpoint blocks and a one-byte index.
+  setTargets() fills the block the ISR isn't reading and flips the index
+  (one store). The ISR can interrupt the task but not the other way
+  round, so it always reads a whole block, and never one being written.
+
+  Ownership of the motors: a running wheel is the ISR's; a released one
+  is the task's (step test, sysid, coasting). release() / a wheel set to
+  !run hands it back: the ISR stops on its next tick, and the task
+  coasts it right away (a write racing the ISR's last one can't happen:
+  the ISR ran to completion before the flip, and won't touch it after).
+
+  Stale setpoint: no new block for DRIVE_ISR_STALE_MS (the drive task
+  isn't running) and the ISR coasts the running wheels itself and counts
+  a stale trip; the next setTargets() picks them up again.
+
+  The arm loop (MechanismController) stays in the drive task: a position
+  loop on a slow joint gains little from 800 Hz, its encoders aren't in
+  the sampler's snapshot, and its float PID, profile and pair sync would
+  add to a Timer1 tick that already carries both wheel PIDs.
+
+  USAGE
+  -----
+    before the sampler's begin(): sampler.setControlLoop(&loop),
+                                  drive.setInnerLoop(&loop)
+    drive task:  setTargets(left, right) every tick; release() to stop
+    tuning:      setGains(...) (taken by the ISR with the next block)
+===============================================================================
+*/
+
+class DriveInnerLoop {
+public:
+  static constexpr uint8_t WHEELS = 2;   // 0 = left, 1 = right (sampler channels)
+
+  // One wheel's setpoint: track ref_ftps, ff_duty added to the PID output
+  struct Wheel {
+    bool run = false;
+    float ref_ftps = 0.0f;
+    float ff_duty = 0.0f;
+  };
+
+  DriveInnerLoop(DcMotorActuator& left_motor, DcMotorActuator& right_motor);
+
+  // Both PIDs (as DRIVE_KP .. DRIVE_INTEGRAL_LIMIT), sent with the next
+  // setTargets(). Integrators are kept.
+  void setGains(float kp, float ki, float kd, float integral_limit);
+
+  // Publishes both setpoints. A wheel going from run to !run is coasted.
+  void setTargets(const Wheel& left, const Wheel& right);
+
+  // Both wheels back to the task, coasted.
+  void release();
+
+  // Last duty the ISR wrote (0 once it let the wheel go)
+  float duty(uint8_t wheel) const;
+
+  // Times the ISR coasted the wheels on a stale setpoint
+  uint16_t staleTrips() const;
+
+  // Timer1 ISR body (sensors/EncoderSampler), interrupts enabled: the
+  // sampler's count snapshot (public only so the sampler can reach it)
+  void tickIsr_(const int32_t* count);
+
+private:
+  // Counts kept per wheel: two speed windows (the derivative's span)
+  static constexpr uint8_t HISTORY = 2 * DRIVE_ISR_VEL_WINDOW;
+  static constexpr uint8_t MASK = HISTORY - 1;
+
+  struct Block {
+    Fixed ref[WHEELS];
+    Fixed ff[WHEELS];
+    Fixed kp;
+    Fixed ki;
+    Fixed kd;
+    Fixed integral_limit;
+    uint8_t run_mask = 0;       // bit per wheel
+    uint8_t gen = 0;            // bumped per publish (ISR staleness)
+    uint8_t gains_gen = 0;      // bumped per setGains()
+  };
+
+  void publish_();
+
+  DcMotorActuator* _motor[WHEELS];
+
+  // Task side: the next block, and the two the ISR reads from
+  Block _staged;
+  Block _buf[2];
+  volatile uint8_t _front = 0;  // block the ISR reads
+
+  // ISR side
+  PIDFx _pid[WHEELS];
+  int16_t _hist[WHEELS][HISTORY];   // low 16 bits of the counts, a ring
+  int32_t _rate_raw[WHEELS] = {0, 0};  // low-passed speed change (Fixed raw, ft/s^2)
+  uint8_t _pos = 0;
+  bool _primed = false;
+  uint8_t _seen_gen = 0;
+  uint8_t _seen_gains = 0;
+  uint8_t _age = 0;             // ticks since a new block
+  uint8_t _active = 0;          // wheels the ISR is driving (bit per wheel)
+  volatile int32_t _duty_raw[WHEELS] = {0, 0};
+  volatile uint16_t _stale_trips = 0;
+};
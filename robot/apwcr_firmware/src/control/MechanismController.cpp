@@ -0,0 +1,207 @@
+#include "control/MechanismController.h"
+#include <math.h>  // fabsf
+
+#include "Params.h"
+
+/*
+===============================================================================
+  MechanismController.cpp
+===============================================================================
+*/
+
+namespace {
+
+constexpr float MAX_PWM_F = (float)ARM_MAX_PWM;
+constexpr float MAX_DUTY = (float)ARM_MAX_PWM / (float)PWM_MAX;
+
+static_assert(ARM_MAX_PWM > 0 && ARM_MAX_PWM <= PWM_MAX, "ARM_MAX_PWM must be within 1..PWM_MAX");
+static_assert(MotionProfile::MAX_AXES >= 2, "arm profile needs two axes");
+
+float clampAbs(float v, float limit) {
+  if (v > limit) return limit;
+  if (v < -limit) return -limit;
+  return v;
+}
+
+float clampDeg(float deg) {
+  if (deg < ARM_MIN_DEG) return ARM_MIN_DEG;
+  if (deg > ARM_MAX_DEG) return ARM_MAX_DEG;
+  return deg;
+}
+
+}  // namespace
+
+
+MechanismController::MechanismController(EncoderSensor& lhs_enc,
+                                         EncoderSensor& rhs_enc,
+                                         DcMotorActuator& lhs_motor,
+                                         DcMotorActuator& rhs_motor)
+: _lhs_enc(lhs_enc),
+  _rhs_enc(rhs_enc),
+  _lhs_motor(lhs_motor),
+  _rhs_motor(rhs_motor),
+  _lhs_pid(ARM_KP, ARM_KI, ARM_KD, ARM_INTEGRAL_LIMIT, -MAX_PWM_F, MAX_PWM_F),
+  _rhs_pid(ARM_KP, ARM_KI, ARM_KD, ARM_INTEGRAL_LIMIT, -MAX_PWM_F, MAX_PWM_F)
+{
+}
+
+void MechanismController::begin() {
+  _lhs_enc.begin();
+  _rhs_enc.begin();
+  _lhs_motor.begin();
+  _rhs_motor.begin();
+
+  _state = State();
+  _has_tick = false;
+  stop();
+}
+
+void MechanismController::setGains(float kp, float ki, float kd, float integral_limit) {
+  _lhs_pid.setGains(kp, ki, kd);
+  _rhs_pid.setGains(kp, ki, kd);
+  _lhs_pid.setIntegralLimit(integral_limit);
+  _rhs_pid.setIntegralLimit(integral_limit);
+}
+
+void MechanismController::setCommand(const MechanismCommand& cmd, uint32_t now_ms) {
+  const MechMotorCommand& l = cmd.motor_LHS;
+  const MechMotorCommand& r = cmd.motor_RHS;
+
+  if (l.present && l.mode == MechMotorMode::DUTY) setDuty_(_state.lhs, _lhs_pid, l.value);
+  if (r.present && r.mode == MechMotorMode::DUTY) setDuty_(_state.rhs, _rhs_pid, r.value);
+
+  const bool lhs_pos = l.present && l.mode == MechMotorMode::POS_DEG;
+  const bool rhs_pos = r.present && r.mode == MechMotorMode::POS_DEG;
+  if (lhs_pos || rhs_pos) setPositions(lhs_pos, l.value, rhs_pos, r.value, now_ms);
+}
+
+void MechanismController::setPositions(bool lhs, float lhs_deg, bool rhs, float rhs_deg, uint32_t now_ms) {
+  JointState* js[AXES] = {&_state.lhs, &_state.rhs};
+  PID* pid[AXES] = {&_lhs_pid, &_rhs_pid};
+  const bool want[AXES] = {lhs, rhs};
+  const float target[AXES] = {clampDeg(lhs_deg), clampDeg(rhs_deg)};
+
+  bool changed = false;
+  for (uint8_t i = 0; i < AXES; i++) {
+    if (!want[i]) continue;
+
+    // Entering position mode: the move starts where the joint is now
+    if (js[i]->mode != Mode::POSITION) {
+      js[i]->mode = Mode::POSITION;
+      js[i]->setpoint_deg = js[i]->angle_deg;
+      js[i]->target_deg = js[i]->angle_deg;
+      pid[i]->reset();
+      changed = true;
+    }
+    if (target[i] != js[i]->target_deg) {
+      js[i]->target_deg = target[i];
+      changed = true;
+    }
+    js[i]->at_target = false;
+  }
+  if (!changed) return;
+
+  // One plan for both joints (a joint not in POSITION just holds still)
+  MotionProfile::AxisMove m[AXES];
+  for (uint8_t i = 0; i < AXES; i++) {
+    const bool pos = (js[i]->mode == Mode::POSITION);
+    m[i].from = pos ? js[i]->setpoint_deg : js[i]->angle_deg;
+    m[i].to = pos ? js[i]->target_deg : m[i].from;
+    m[i].vmax = ARM_MAX_DPS;
+    m[i].amax = ARM_ACCEL_DPS2;
+  }
+  _profile.plan(m, AXES, now_ms);
+}
+
+void MechanismController::stop() {
+  _profile.cancel();
+
+  JointState* js[AXES] = {&_state.lhs, &_state.rhs};
+  for (uint8_t i = 0; i < AXES; i++) {
+    js[i]->mode = Mode::IDLE;
+    js[i]->duty = 0.0f;
+    js[i]->at_target = false;
+  }
+
+  _lhs_motor.coast();
+  _rhs_motor.coast();
+
+  _lhs_pid.reset();
+  _rhs_pid.reset();
+  _state.synced = false;
+  _state.mismatch_deg = 0.0f;
+}
+
+void MechanismController::tick(uint32_t now_ms) {
+  const uint32_t dt_ms = _has_tick ? (now_ms - _state.last_tick_ms) : 0;
+  _state.last_tick_ms = now_ms;
+  _has_tick = true;
+
+  JointState& l = _state.lhs;
+  JointState& r = _state.rhs;
+
+  const EncoderSensor::State& les = _lhs_enc.getState();
+  const EncoderSensor::State& res = _rhs_enc.getState();
+  l.angle_deg = les.degrees;
+  r.angle_deg = res.degrees;
+  if (les.valid_speed) l.speed_dps = les.rps_filtered * 360.0f;
+  if (res.valid_speed) r.speed_dps = res.rps_filtered * 360.0f;
+
+  if (_profile.active()) {
+    float pos[AXES];
+    _profile.sample(now_ms, pos);
+    if (l.mode == Mode::POSITION) l.setpoint_deg = pos[AXIS_LHS];
+    if (r.mode == Mode::POSITION) r.setpoint_deg = pos[AXIS_RHS];
+  }
+
+  // Pair correction: positive when LHS is further behind its setpoint
+  float sync_pwm = 0.0f;
+  _state.synced = ARM_SYNC_ENABLE && l.mode == Mode::POSITION && r.mode == Mode::POSITION;
+  if (_state.synced) {
+    _state.mismatch_deg = (l.setpoint_deg - l.angle_deg) - (r.setpoint_deg - r.angle_deg);
+    sync_pwm = clampAbs(ARM_SYNC_KP * _state.mismatch_deg, MAX_PWM_F);
+  } else {
+    _state.mismatch_deg = 0.0f;
+  }
+
+  const float dt_s = (float)dt_ms * 0.001f;
+  runJoint_(_lhs_motor, _lhs_pid, l, dt_s, sync_pwm);
+  runJoint_(_rhs_motor, _rhs_pid, r, dt_s, -sync_pwm);
+}
+
+bool MechanismController::atTarget() const {
+  if (_state.lhs.mode == Mode::POSITION && !_state.lhs.at_target) return false;
+  if (_state.rhs.mode == Mode::POSITION && !_state.rhs.at_target) return false;
+  return true;
+}
+
+void MechanismController::setDuty_(JointState& js, PID& pid, float duty) {
+  js.mode = Mode::DUTY;
+  js.duty = clampAbs(duty, MAX_DUTY);
+  js.at_target = false;
+  pid.reset();
+}
+
+void MechanismController::runJoint_(DcMotorActuator& motor, PID& pid, JointState& js,
+                                    float dt_s, float sync_pwm) {
+  switch (js.mode) {
+    case Mode::IDLE:
+      if (js.duty != 0.0f) motor.coast();
+      js.duty = 0.0f;
+      return;
+
+    case Mode::DUTY:
+      motor.setDuty(js.duty);
+      return;
+
+    case Mode::POSITION:
+      break;
+  }
+
+  const float pwm = clampAbs(pid.update(js.setpoint_deg, js.angle_deg, dt_s) + sync_pwm, MAX_PWM_F);
+  js.duty = pwm / (float)PWM_MAX;
+  motor.setDuty(js.duty);
+
+  js.at_target = (js.setpoint_deg == js.target_deg) &&
+                 fabsf(js.target_deg - js.angle_deg) <= ARM_POS_TOLERANCE_DEG;
+}
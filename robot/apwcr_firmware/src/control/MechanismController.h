@@ -0,0 +1,120 @@
+#pragma once
+#include <Arduino.h>
+
+#include "comms/Messages.h"
+#include "control/PID.h"
+#include "control/MotionProfile.h"
+#include "sensors/EncoderSensor.h"
+#include "actuators/DcMotorActuator.h"
+
+/*
+===============================================================================
+  MechanismController.h
+===============================================================================
+
+  PURPOSE
+  -------
+  Closed-loop controller for the two pickup arm motors. Takes the host's
+  MechanismCommand motor fields and drives each joint either to a position
+  (POS_DEG) or at an open-loop duty (DUTY). The servos are not handled
+  here (see commandServos in main.cpp).
+
+  Position control:
+    - A new POS_DEG target plans an accel-limited move (MotionProfile,
+      ARM_MAX_DPS / ARM_ACCEL_DPS2) from the current setpoint; both joints
+      share one plan, so a common target is reached at the same time
+    - One PID per joint tracks the moving setpoint: error in joint degrees,
+      output in PWM counts (+/-ARM_MAX_PWM), written as duty / PWM_MAX
+    - Once there, the loop keeps running and holds the joint against load
+  Synchronized pair (ARM_SYNC_ENABLE, both joints in POS_DEG):
+    mismatch = (sp_L - deg_L) - (sp_R - deg_R)
+    u_L += ARM_SYNC_KP * mismatch,  u_R -= ARM_SYNC_KP * mismatch
+  so a side that falls behind pushes harder while the other waits for it.
+  DUTY mode writes the value (clamped to ARM_MAX_PWM / PWM_MAX) directly
+  and drops that joint out of the plan and the pair.
+
+  Angles are relative to where the arms were at begin() (stowed).
+
+  USAGE
+  -----
+  - begin() once in setup()
+  - setCommand(cmd.mech, now_ms) when a new command arrives, stop() on
+    timeout
+  - tick(now_ms) at a fixed rate (DRIVE_UPDATE_HZ, with the drive loop),
+    after the EncoderBank sample that covers the arm encoders
+  - setGains(...) between ticks when tuning (utils/ParamStore)
+===============================================================================
+*/
+
+class MechanismController {
+public:
+  enum class Mode : uint8_t {
+    IDLE = 0,     // coasting
+    POSITION,
+    DUTY,
+  };
+
+  struct JointState {
+    Mode mode = Mode::IDLE;
+    float target_deg = 0.0f;     // POSITION: final target
+    float setpoint_deg = 0.0f;   // POSITION: profiled setpoint this tick
+    float angle_deg = 0.0f;      // measured
+    float speed_dps = 0.0f;      // measured (filtered)
+    float duty = 0.0f;           // last motor command
+    bool at_target = false;      // POSITION, move done, within tolerance
+  };
+
+  struct State {
+    JointState lhs;
+    JointState rhs;
+    bool synced = false;         // pair correction applied last tick
+    float mismatch_deg = 0.0f;   // LHS - RHS tracking error last tick
+    uint32_t last_tick_ms = 0;
+  };
+
+  MechanismController(EncoderSensor& lhs_enc,
+                      EncoderSensor& rhs_enc,
+                      DcMotorActuator& lhs_motor,
+                      DcMotorActuator& rhs_motor);
+
+  void begin();
+
+  // Applies the motor fields that are present; absent ones keep their mode.
+  void setCommand(const MechanismCommand& cmd, uint32_t now_ms);
+
+  // Position targets for either joint (deg, clamped to ARM_MIN/MAX_DEG).
+  void setPositions(bool lhs, float lhs_deg, bool rhs, float rhs_deg, uint32_t now_ms);
+
+  // Both joint PIDs (as ARM_KP .. ARM_INTEGRAL_LIMIT). Integrators are kept.
+  void setGains(float kp, float ki, float kd, float integral_limit);
+
+  // Both joints IDLE, coast both motors, reset both PIDs.
+  void stop();
+
+  // Samples encoders and runs both joint loops.
+  void tick(uint32_t now_ms);
+
+  // Every POSITION joint is at_target (true when none is in POSITION)
+  bool atTarget() const;
+
+  const State& getState() const { return _state; }
+
+private:
+  enum : uint8_t { AXIS_LHS = 0, AXIS_RHS, AXES };
+
+  void setDuty_(JointState& js, PID& pid, float duty);
+  void runJoint_(DcMotorActuator& motor, PID& pid, JointState& js, float dt_s, float sync_pwm);
+
+  EncoderSensor& _lhs_enc;
+  EncoderSensor& _rhs_enc;
+  DcMotorActuator& _lhs_motor;
+  DcMotorActuator& _rhs_motor;
+
+  PID _lhs_pid;
+  PID _rhs_pid;
+
+  MotionProfile _profile;
+
+  State _state;
+  bool _has_tick = false;
+};
@@ -0,0 +1,112 @@
+#include "control/MotionProfile.h"
+#include <math.h>  // fabsf, sqrtf
+
+/*
+===============================================================================
+  MotionProfile.cpp
+===============================================================================
+
+  Each axis' table is always three segments; a triangle has a zero-length
+  cruise, an axis that doesn't move (or jumps) has all three at its target
+  with zero velocity. sample() never divides; plan() does a handful of
+  divides and one sqrtf per axis.
+===============================================================================
+*/
+
+float MotionProfile::minTimeS_(float d, float v, float a) {
+  if (d <= 0.0f || v <= 0.0f) return 0.0f;
+  if (a <= 0.0f) return d / v;                 // no accel limit: pure cruise
+  if (d < v * v / a) return 2.0f * sqrtf(d / a);   // never reaches vmax
+  return d / v + v / a;
+}
+
+bool MotionProfile::plan(const AxisMove* moves, uint8_t n, uint32_t now_ms) {
+  if (!moves || n == 0 || n > MAX_AXES) return false;
+
+  float t = 0.0f;
+  for (uint8_t i = 0; i < n; i++) {
+    const float ti = minTimeS_(fabsf(moves[i].to - moves[i].from), moves[i].vmax, moves[i].amax);
+    if (ti > t) t = ti;
+  }
+
+  _duration_s = t;
+  _axes = n;
+  for (uint8_t i = 0; i < n; i++) planAxis_(i, moves[i]);
+
+  _start_ms = now_ms;
+  _active = true;
+  return true;
+}
+
+void MotionProfile::planAxis_(uint8_t i, const AxisMove& m) {
+  Segment* s = _seg[i];
+  const float T = _duration_s;
+  const float d = fabsf(m.to - m.from);
+  const float dir = (m.to >= m.from) ? 1.0f : -1.0f;
+
+  _to[i] = m.to;
+
+  // Still (or jump): hold the target for the whole move
+  if (d <= 0.0f || m.vmax <= 0.0f || T <= 0.0f) {
+    for (uint8_t k = 0; k < SEGMENTS; k++) {
+      s[k] = Segment();
+      s[k].p0 = m.to;
+    }
+    return;
+  }
+
+  // Cruise speed and ramp time that make this axis take exactly T
+  float v, t_acc, a;
+  if (m.amax <= 0.0f) {
+    v = d / T;
+    t_acc = 0.0f;
+    a = 0.0f;
+  } else {
+    a = m.amax;
+    float disc = a * a * T * T - 4.0f * a * d;
+    if (disc < 0.0f) disc = 0.0f;              // rounding on the slowest axis
+    v = 0.5f * (a * T - sqrtf(disc));
+    t_acc = v / a;
+    if (t_acc > 0.5f * T) t_acc = 0.5f * T;
+  }
+
+  // Accelerate
+  s[0].t0_s = 0.0f;
+  s[0].p0 = m.from;
+  s[0].v0 = 0.0f;
+  s[0].a = dir * a;
+
+  // Cruise
+  s[1].t0_s = t_acc;
+  s[1].p0 = m.from + dir * 0.5f * a * t_acc * t_acc;
+  s[1].v0 = dir * v;
+  s[1].a = 0.0f;
+
+  // Decelerate: starts with as much distance left as the accel covered
+  const float t_dec = T - t_acc;
+  s[2].t0_s = t_dec;
+  s[2].p0 = m.to - dir * 0.5f * a * t_acc * t_acc;
+  s[2].v0 = dir * v;
+  s[2].a = -dir * a;
+}
+
+bool MotionProfile::sample(uint32_t now_ms, float* pos) {
+  if (!_active) return false;
+
+  const float t = (float)(now_ms - _start_ms) * 0.001f;
+  if (t >= _duration_s) {
+    for (uint8_t i = 0; i < _axes; i++) pos[i] = _to[i];
+    _active = false;
+    return false;
+  }
+
+  for (uint8_t i = 0; i < _axes; i++) {
+    const Segment* s = _seg[i];
+    uint8_t k = SEGMENTS - 1;
+    while (k > 0 && t < s[k].t0_s) k--;
+
+    const float dt = t - s[k].t0_s;
+    pos[i] = s[k].p0 + (s[k].v0 + 0.5f * s[k].a * dt) * dt;
+  }
+  return true;
+}
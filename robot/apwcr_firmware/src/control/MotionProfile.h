@@ -0,0 +1,89 @@
+#pragma once
+#include <Arduino.h>
+
+#include "Params.h"
+
+/*
+===============================================================================
+  MotionProfile.h
+===============================================================================
+
+  PURPOSE
+  -------
+  Time-synchronized, acceleration-limited point-to-point moves for up to
+  MOTION_MAX_AXES axes (servos now; arm joints use the same engine).
+
+  plan() runs once per command:
+    1. For each axis, the fastest trapezoid (or triangle) that respects its
+       vmax / amax: T_i = d/v + v/a, or 2*sqrt(d/a) if it never cruises.
+    2. T = max(T_i). Every other axis is slowed to a cruise speed that
+       takes exactly T at its own amax:  v = (a*T - sqrt(a^2*T^2 - 4*a*d)) / 2
+    3. The result is stored as a segment table: per axis, three constant-
+       acceleration segments (accelerate, cruise, decelerate).
+  sample() then just finds the segment and evaluates
+    p = p0 + v0*dt + a*dt^2/2
+  per axis, so all axes start together and arrive together.
+
+  Moves always start from rest at the given position; a replan mid-move
+  restarts from the current setpoint with zero velocity.
+
+  USAGE
+  -----
+    MotionProfile::AxisMove m[2] = {{from0, to0, vmax0, amax0}, {...}};
+    profile.plan(m, 2, now_ms);
+    each tick:  profile.sample(now_ms, pos);   // false once finished
+===============================================================================
+*/
+
+class MotionProfile {
+public:
+  static constexpr uint8_t MAX_AXES = MOTION_MAX_AXES;
+  static constexpr uint8_t SEGMENTS = 3;
+
+  struct AxisMove {
+    float from = 0.0f;
+    float to = 0.0f;
+    float vmax = 0.0f;     // units/s, <= 0 = jump to `to`
+    float amax = 0.0f;     // units/s^2, <= 0 = no accel limit
+  };
+
+  // Constant acceleration from t0_s; p0/v0 are the values at t0_s
+  struct Segment {
+    float t0_s = 0.0f;
+    float p0 = 0.0f;
+    float v0 = 0.0f;
+    float a = 0.0f;
+  };
+
+  /*
+    Plan a synchronized move for n axes (n <= MAX_AXES). Replaces any
+    move in progress. Returns false (and plans nothing) if n is out of
+    range.
+  */
+  bool plan(const AxisMove* moves, uint8_t n, uint32_t now_ms);
+
+  /*
+    Writes each axis' setpoint at now_ms into pos[0..axes()-1]. Returns
+    true while the move is running; on the first call after it ends it
+    writes the final positions, returns false and goes idle.
+  */
+  bool sample(uint32_t now_ms, float* pos);
+
+  void cancel() { _active = false; }
+
+  bool active() const { return _active; }
+  uint8_t axes() const { return _axes; }
+  float durationS() const { return _duration_s; }
+  float target(uint8_t axis) const { return _to[axis]; }
+
+private:
+  static float minTimeS_(float d, float v, float a);
+  void planAxis_(uint8_t i, const AxisMove& m);
+
+  Segment _seg[MAX_AXES][SEGMENTS];
+  float _to[MAX_AXES] = {};
+  float _duration_s = 0.0f;
+  uint32_t _start_ms = 0;
+  uint8_t _axes = 0;
+  bool _active = false;
+};
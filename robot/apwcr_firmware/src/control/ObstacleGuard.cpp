@@ -0,0 +1,79 @@
+#include "control/ObstacleGuard.h"
+#include <math.h>  // sqrtf
+
+/*
+===============================================================================
+  ObstacleGuard.cpp
+===============================================================================
+
+  Runs at DRIVE_UPDATE_HZ on at most SONAR_MAX_SENSORS tracks: two sqrtf
+  per track, fine next to the wheel PIDs.
+===============================================================================
+*/
+
+static_assert(OBSTACLE_DECEL_FTPS2 > 0.0f && OBSTACLE_STOP_DECEL_FTPS2 >= OBSTACLE_DECEL_FTPS2,
+              "OBSTACLE_STOP_DECEL_FTPS2 must be at least OBSTACLE_DECEL_FTPS2");
+
+namespace {
+
+constexpr float INCHES_PER_FT = 12.0f;
+
+// Fastest speed (ft/s) that still stops within gap_ft at decel_ftps2, after
+// OBSTACLE_LATENCY_S of travel before the brakes see it
+float stoppingSpeed(float gap_ft, float decel_ftps2) {
+  if (gap_ft <= 0.0f) return 0.0f;
+  const float t = OBSTACLE_LATENCY_S;
+  return decel_ftps2 * (sqrtf(t * t + 2.0f * gap_ft / decel_ftps2) - t);
+}
+
+}  // namespace
+
+
+void ObstacleGuard::reset() {
+  *this = ObstacleGuard();
+}
+
+void ObstacleGuard::update(const RangeFilter::Output* const* ranges, uint8_t n) {
+  if (!OBSTACLE_GUARD_ENABLE) return;
+
+  float cap = MAX_LINEAR_SPEED_FTPS;
+  float nearest = NAN;
+  float ttc = INFINITY;
+  bool seen = false;    // any trusted track
+  bool trip = false;    // some track needs a stop now
+  bool clear = true;    // every track is past the release band
+
+  for (uint8_t i = 0; i < n; i++) {
+    const RangeFilter::Output* r = ranges[i];
+    if (!r || !r->valid || r->confidence < OBSTACLE_MIN_CONFIDENCE) continue;
+    seen = true;
+
+    const float gap_in = r->distance_in - OBSTACLE_MARGIN_IN;
+    const float gap_ft = gap_in / INCHES_PER_FT;
+    if (!(nearest <= r->distance_in)) nearest = r->distance_in;
+
+    const float v = stoppingSpeed(gap_ft, OBSTACLE_DECEL_FTPS2);
+    if (v < cap) cap = v;
+
+    if (gap_in <= 0.0f) trip = true;
+    if (gap_in <= OBSTACLE_RELEASE_IN) clear = false;
+
+    if (r->closing_inps > 0.0f) {
+      const float t = (gap_in > 0.0f) ? gap_in / r->closing_inps : 0.0f;
+      if (t < ttc) ttc = t;
+      if (r->closing_inps / INCHES_PER_FT > stoppingSpeed(gap_ft, OBSTACLE_STOP_DECEL_FTPS2)) trip = true;
+    }
+  }
+
+  // A stop holds until the tracks say it's clear; with no track at all it
+  // holds only if the obstacle was last seen inside the release band
+  bool stop = trip;
+  if (!stop && _state.stop) stop = seen ? !clear : _hold;
+  if (seen) _hold = !clear;
+
+  if (stop && !_state.stop && _state.stops < 0xFFFF) _state.stops++;
+  _state.stop = stop;
+  _state.limit_ftps = stop ? 0.0f : cap;
+  _state.nearest_in = nearest;
+  _state.ttc_s = ttc;
+}
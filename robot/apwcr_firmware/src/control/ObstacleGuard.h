@@ -0,0 +1,67 @@
+#pragma once
+#include <Arduino.h>
+
+#include "Params.h"
+#include "sensors/RangeFilter.h"
+
+/*
+===============================================================================
+  ObstacleGuard.h
+===============================================================================
+
+  PURPOSE
+  -------
+  On-board safety layer between the DriveCommand and the DriveController:
+  caps the forward linear speed from the front ultrasonic tracks (filtered,
+  see RangeFilter) every drive tick, so the robot stops at the same
+  distance however late the host's own reaction is.
+
+  Per front track with confidence >= OBSTACLE_MIN_CONFIDENCE:
+    gap    = distance - OBSTACLE_MARGIN_IN
+    v(a)   = a * (sqrt(t^2 + 2 gap / a) - t),   t = OBSTACLE_LATENCY_S
+             (fastest speed that can still stop within gap at decel a)
+    cap    = v(OBSTACLE_DECEL_FTPS2)
+    stop   = gap <= 0, or time-to-collision (gap / closing rate) shorter
+             than braking at OBSTACLE_STOP_DECEL_FTPS2 needs, i.e. the
+             closing rate is above v(OBSTACLE_STOP_DECEL_FTPS2)
+  The closing rate is the measured range rate, so an obstacle moving
+  toward the robot counts as well as the robot's own speed. A limited
+  approach closes at the softer curve with room to spare, so the stop only
+  fires for something faster than the cap can handle.
+
+  While stopped the forward cap is 0 until every track is further than
+  OBSTACLE_MARGIN_IN + OBSTACLE_RELEASE_IN and none is closing too fast.
+  A track lost while the obstacle was inside that band (closer than the
+  sensor's minimum range, or the echo turned away) keeps the stop.
+
+  USAGE
+  -----
+  - update(front ranges) once per drive tick, before DriveController::tick
+  - DriveController::setForwardLimit(forwardLimitFtps())
+===============================================================================
+*/
+
+class ObstacleGuard {
+public:
+  struct State {
+    float limit_ftps = MAX_LINEAR_SPEED_FTPS;   // forward cap now
+    float nearest_in = NAN;                     // closest trusted track (NAN = none)
+    float ttc_s = INFINITY;                     // shortest time-to-collision
+    bool  stop = false;                         // forward cap forced to 0
+    uint16_t stops = 0;                         // stop activations since begin()
+  };
+
+  void reset();
+
+  // n front tracks (any may be invalid)
+  void update(const RangeFilter::Output* const* ranges, uint8_t n);
+
+  float forwardLimitFtps() const { return _state.limit_ftps; }
+  bool stopActive() const { return _state.stop; }
+
+  const State& getState() const { return _state; }
+
+private:
+  State _state;
+  bool _hold = false;   // last trusted track was inside the release band
+};
@@ -0,0 +1,103 @@
+#include "control/PID.h"
+
+/*
+===============================================================================
+  PID.cpp
+===============================================================================
+
+  u = kp * e + ki * integral(e dt) - kd * d(measurement)/dt
+===============================================================================
+*/
+
+PID::PID(float kp,
+         float ki,
+         float kd,
+         float integral_limit,
+         float out_min,
+         float out_max)
+: _kp(kp),
+  _ki(ki),
+  _kd(kd),
+  _integral_limit(integral_limit),
+  _out_min(out_min),
+  _out_max(out_max)
+{
+  if (_integral_limit < 0.0f) _integral_limit = -_integral_limit;
+
+  // Guard against swapped bounds
+  if (_out_max < _out_min) {
+    float tmp = _out_max;
+    _out_max = _out_min;
+    _out_min = tmp;
+  }
+}
+
+void PID::setGains(float kp, float ki, float kd) {
+  _kp = kp;
+  _ki = ki;
+  _kd = kd;
+}
+
+void PID::setIntegralLimit(float limit) {
+  _integral_limit = (limit < 0.0f) ? -limit : limit;
+}
+
+void PID::setOutputLimits(float out_min, float out_max) {
+  if (out_max < out_min) {
+    float tmp = out_max;
+    out_max = out_min;
+    out_min = tmp;
+  }
+  _out_min = out_min;
+  _out_max = out_max;
+}
+
+void PID::reset() {
+  _state = State();
+  _has_last = false;
+}
+
+float PID::clampOut_(float u) const {
+  if (u > _out_max) return _out_max;
+  if (u < _out_min) return _out_min;
+  return u;
+}
+
+float PID::update(float setpoint, float measurement, float dt_s) {
+  const float e = setpoint - measurement;
+  _state.error = e;
+  _state.p_term = _kp * e;
+
+  if (dt_s <= 0.0f) {
+    _state.output = clampOut_(_state.p_term + _state.i_term);
+    _state.saturated = (_state.output != _state.p_term + _state.i_term);
+    return _state.output;
+  }
+
+  // Derivative on measurement
+  float d_term = 0.0f;
+  if (_has_last) {
+    d_term = -_kd * (measurement - _last_measurement) / dt_s;
+  }
+  _last_measurement = measurement;
+  _has_last = true;
+  _state.d_term = d_term;
+
+  // Conditional integration (anti-windup)
+  float integral = _state.integral + e * dt_s;
+  if (integral > _integral_limit) integral = _integral_limit;
+  if (integral < -_integral_limit) integral = -_integral_limit;
+
+  const float u_trial = _state.p_term + _ki * integral + d_term;
+  const bool pushing_high = (u_trial > _out_max) && (e > 0.0f);
+  const bool pushing_low  = (u_trial < _out_min) && (e < 0.0f);
+  if (!pushing_high && !pushing_low) {
+    _state.integral = integral;
+  }
+  _state.i_term = _ki * _state.integral;
+
+  const float u = _state.p_term + _state.i_term + d_term;
+  _state.output = clampOut_(u);
+  _state.saturated = (_state.output != u);
+  return _state.output;
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include <Arduino.h>
+
+/*
+===============================================================================
+  PID.h
+===============================================================================
+
+  PURPOSE
+  -------
+  Small reusable PID controller. Used for:
+    - drive wheel speed control (DriveController)
+    - mechanism position control (later)
+
+  Design:
+    - Multiple independent instances, no globals
+    - Explicit dt input so it works with scheduler task timing
+    - Derivative on measurement (setpoint steps don't kick the output)
+    - Integrator clamped to +/- integral_limit (in error * seconds)
+    - Conditional integration: while the output is saturated, the
+      integrator only moves in the direction that unsaturates it
+    - Output clamped to [out_min, out_max]
+===============================================================================
+*/
+
+class PID {
+public:
+  struct State {
+    float error = 0.0f;
+    float integral = 0.0f;     // sum(error * dt), clamped
+    float p_term = 0.0f;
+    float i_term = 0.0f;
+    float d_term = 0.0f;
+    float output = 0.0f;
+    bool saturated = false;
+  };
+
+  PID(float kp,
+      float ki,
+      float kd,
+      float integral_limit,
+      float out_min = -1.0f,
+      float out_max = 1.0f);
+
+  void setGains(float kp, float ki, float kd);
+  void setIntegralLimit(float limit);
+  void setOutputLimits(float out_min, float out_max);
+
+  // Clears integrator and derivative history.
+  void reset();
+
+  // One control step. dt_s <= 0 skips I/D and returns the P-only output.
+  float update(float setpoint, float measurement, float dt_s);
+
+  const State& getState() const { return _state; }
+
+private:
+  float clampOut_(float u) const;
+
+  float _kp;
+  float _ki;
+  float _kd;
+
+  float _integral_limit;
+  float _out_min;
+  float _out_max;
+
+  float _last_measurement = 0.0f;
+  bool _has_last = false;
+
+  State _state;
+};
@@ -0,0 +1,109 @@
+#include "control/PIDFx.h"
+
+/*
+===============================================================================
+  PIDFx.cpp
+===============================================================================
+
+  u = kp * e + ki * integral(e dt) - (kd / dt) * (measurement - last)
+  or, with the caller's rate:  ... - kd * measurement_rate
+===============================================================================
+*/
+
+PIDFx::PIDFx(float kp,
+             float ki,
+             float kd,
+             float dt_s,
+             float integral_limit,
+             float out_min,
+             float out_max)
+{
+  _dt_s = (dt_s > 0.0f) ? dt_s : 0.01f;
+  _dt = Fixed::fromFloat(_dt_s);
+  _inv_dt = Fixed::fromFloat(1.0f / _dt_s);
+
+  setGains(kp, ki, kd);
+
+  _integral_limit = Fixed::fromFloat(integral_limit < 0.0f ? -integral_limit : integral_limit);
+
+  // Guard against swapped bounds
+  if (out_max < out_min) {
+    float tmp = out_max;
+    out_max = out_min;
+    out_min = tmp;
+  }
+  _out_min = Fixed::fromFloat(out_min);
+  _out_max = Fixed::fromFloat(out_max);
+}
+
+void PIDFx::setGains(float kp, float ki, float kd) {
+  _kp = Fixed::fromFloat(kp);
+  _ki = Fixed::fromFloat(ki);
+  _kd = Fixed::fromFloat(kd);
+  _kd_over_dt = Fixed::fromFloat(kd / _dt_s);
+}
+
+void PIDFx::setGains(Fixed kp, Fixed ki, Fixed kd) {
+  _kp = kp;
+  _ki = ki;
+  _kd = kd;
+  _kd_over_dt = kd * _inv_dt;
+}
+
+void PIDFx::setOutputLimits(Fixed out_min, Fixed out_max) {
+  if (out_max < out_min) {
+    const Fixed tmp = out_max;
+    out_max = out_min;
+    out_min = tmp;
+  }
+  _out_min = out_min;
+  _out_max = out_max;
+}
+
+void PIDFx::reset() {
+  _state = State();
+  _has_last = false;
+}
+
+Fixed PIDFx::clampOut_(Fixed u) const {
+  return fx::clamp(u, _out_min, _out_max);
+}
+
+Fixed PIDFx::update(Fixed setpoint, Fixed measurement) {
+  // Derivative on measurement
+  Fixed d_term;
+  if (_has_last) {
+    d_term = -(_kd_over_dt * (measurement - _last_measurement));
+  }
+  _last_measurement = measurement;
+  _has_last = true;
+  return finish_(setpoint - measurement, d_term);
+}
+
+Fixed PIDFx::update(Fixed setpoint, Fixed measurement, Fixed measurement_rate) {
+  _last_measurement = measurement;
+  _has_last = true;
+  return finish_(setpoint - measurement, -(_kd * measurement_rate));
+}
+
+Fixed PIDFx::finish_(Fixed e, Fixed d_term) {
+  _state.error = e;
+  _state.p_term = _kp * e;
+  _state.d_term = d_term;
+
+  // Conditional integration (anti-windup)
+  const Fixed integral = fx::clamp(_state.integral + e * _dt, -_integral_limit, _integral_limit);
+
+  const Fixed u_trial = _state.p_term + _ki * integral + d_term;
+  const bool pushing_high = (u_trial > _out_max) && (e > fx::ZERO);
+  const bool pushing_low  = (u_trial < _out_min) && (e < fx::ZERO);
+  if (!pushing_high && !pushing_low) {
+    _state.integral = integral;
+  }
+  _state.i_term = _ki * _state.integral;
+
+  const Fixed u = _state.p_term + _state.i_term + d_term;
+  _state.output = clampOut_(u);
+  _state.saturated = (_state.output != u);
+  return _state.output;
+}
@@ -0,0 +1,94 @@
+#pragma once
+#include <Arduino.h>
+
+#include "utils/Fixed.h"
+
+/*
+===============================================================================
+  PIDFx.h
+===============================================================================
+
+  PURPOSE
+  -------
+  Fixed-point (Q16.16) variant of PID with the same behavior:
+    - derivative on measurement
+    - integrator clamped to +/- integral_limit (error * seconds)
+    - conditional integration while saturated
+    - output clamped to [out_min, out_max]
+
+  Difference from PID: the sample time is fixed at construction. ki * dt
+  and kd / dt are folded into two constants, so update() is three
+  multiplies and a few adds/compares, with no divide.
+
+  Values must stay inside the Q16.16 range (+/-32768); for wheel speed in
+  ft/s and duty in [-1, 1] that leaves plenty of headroom.
+
+  The Fixed overloads (setGains, setIntegralLimit, setOutputLimits) and
+  update() do no float math, so they can run in an ISR
+  (control/DriveInnerLoop).
+===============================================================================
+*/
+
+class PIDFx {
+public:
+  struct State {
+    Fixed error;
+    Fixed integral;     // sum(error * dt), clamped
+    Fixed p_term;
+    Fixed i_term;
+    Fixed d_term;
+    Fixed output;
+    bool saturated = false;
+  };
+
+  PIDFx(float kp,
+        float ki,
+        float kd,
+        float dt_s,
+        float integral_limit,
+        float out_min = -1.0f,
+        float out_max = 1.0f);
+
+  void setGains(float kp, float ki, float kd);
+
+  // Same in fixed point: one multiply (kd / dt from a stored 1 / dt)
+  void setGains(Fixed kp, Fixed ki, Fixed kd);
+  void setIntegralLimit(Fixed limit) { _integral_limit = fx::abs(limit); }
+  void setOutputLimits(Fixed out_min, Fixed out_max);
+
+  // Clears integrator and derivative history.
+  void reset();
+
+  // One control step at the configured sample time.
+  Fixed update(Fixed setpoint, Fixed measurement);
+
+  // Same, with the caller's own estimate of d(measurement)/dt (units per
+  // second) for the derivative term, -kd * rate, instead of the one-step
+  // difference: for a measurement whose step-to-step change is mostly
+  // quantization (a short encoder window).
+  Fixed update(Fixed setpoint, Fixed measurement, Fixed measurement_rate);
+
+  const State& getState() const { return _state; }
+
+private:
+  Fixed clampOut_(Fixed u) const;
+  Fixed finish_(Fixed e, Fixed d_term);
+
+  float _dt_s;
+
+  Fixed _kp;
+  Fixed _ki;
+  Fixed _dt;           // sample time (integrator step)
+  Fixed _inv_dt;
+  Fixed _kd;
+  Fixed _kd_over_dt;
+
+  Fixed _integral_limit;
+  Fixed _out_min;
+  Fixed _out_max;
+
+  Fixed _last_measurement;
+  bool _has_last = false;
+
+  State _state;
+};
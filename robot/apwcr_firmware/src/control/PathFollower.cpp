@@ -0,0 +1,157 @@
+#include "control/PathFollower.h"
+#include <math.h>
+#include <string.h>
+
+#include "utils/EventLog.h"
+
+/*
+===============================================================================
+  PathFollower.cpp
+===============================================================================
+
+  Segment lengths are worked out once in start(); a tick is one or two
+  projections, a walk of at most PATH_MAX_POINTS segments for the carrot
+  and the distance left, one sin/cos pair and a sqrt.
+===============================================================================
+*/
+
+namespace {
+
+constexpr float DEG_TO_RAD_F = PI / 180.0f;
+constexpr float RAD_TO_DEG_F = 180.0f / PI;
+
+// Waypoints closer than this to the previous one are dropped
+constexpr float MIN_SEGMENT_FT = 0.01f;
+
+}  // namespace
+
+
+bool PathFollower::start(const PathRequest& req, const PoseState& pose, uint32_t now_ms) {
+  if (req.action != PathAction::RUN || req.count == 0 || req.count > PATH_MAX_POINTS) return false;
+  if (!isnan(req.speed_ftps) && !(req.speed_ftps > 0.0f)) return false;
+
+  // Built in locals first: a refused request leaves the running path alone
+  PathPoint pts[PATH_MAX_POINTS + 1];
+  float len[PATH_MAX_POINTS];
+  uint8_t n = 0;
+  pts[0].x_ft = pose.x_ft;
+  pts[0].y_ft = pose.y_ft;
+  for (uint8_t i = 0; i < req.count; i++) {
+    const PathPoint& p = req.points[i];
+    if (!isfinite(p.x_ft) || !isfinite(p.y_ft)) return false;
+    const float l = hypotf(p.x_ft - pts[n].x_ft, p.y_ft - pts[n].y_ft);
+    if (l < MIN_SEGMENT_FT) continue;
+    len[n] = l;
+    pts[++n] = p;
+  }
+  if (n == 0) return false;
+
+  memcpy(_pts, pts, sizeof(PathPoint) * (n + 1));
+  memcpy(_len, len, sizeof(float) * n);
+  _segments = n;
+  _seg = 0;
+
+  _speed_ftps = isnan(req.speed_ftps) ? PATH_DEFAULT_SPEED_FTPS : req.speed_ftps;
+  if (_speed_ftps > MAX_LINEAR_SPEED_FTPS) _speed_ftps = MAX_LINEAR_SPEED_FTPS;
+  _lookahead_ft = isnan(req.lookahead_ft) ? PATH_LOOKAHEAD_FT : req.lookahead_ft;
+  if (!(_lookahead_ft >= PATH_MIN_LOOKAHEAD_FT)) _lookahead_ft = PATH_MIN_LOOKAHEAD_FT;
+
+  _remaining_ft = 0.0f;
+  for (uint8_t i = 0; i < n; i++) _remaining_ft += _len[i];
+
+  _state = State::RUNNING;
+  _gen++;
+  logEvent(now_ms, EventId::PATH_START, n, eventArgScaled(_speed_ftps, 100.0f));
+  return true;
+}
+
+void PathFollower::abort(uint32_t now_ms) {
+  if (running()) finish_(State::ABORTED, now_ms);
+}
+
+DriveCommand PathFollower::tick(const PoseState& pose, uint32_t now_ms) {
+  DriveCommand cmd;
+  if (!running()) return cmd;
+
+  const float x = pose.x_ft;
+  const float y = pose.y_ft;
+
+  float t, d2;
+  project_(_seg, x, y, t, d2);
+  while (_seg + 1 < _segments) {
+    float tn, dn2;
+    project_(_seg + 1, x, y, tn, dn2);
+    if (t < 1.0f && !(tn > 0.0f && dn2 < d2)) break;
+    _seg++;
+    t = tn;
+    d2 = dn2;
+  }
+  if (t < 0.0f) t = 0.0f;
+
+  // Distance left along the path, from the projection
+  float s = t * _len[_seg];   // along the current segment
+  _remaining_ft = -s;
+  for (uint8_t i = _seg; i < _segments; i++) _remaining_ft += _len[i];
+
+  const PathPoint& goal = _pts[_segments];
+  const bool last = (_seg + 1 == _segments);
+  if ((last && t >= 1.0f) || hypotf(goal.x_ft - x, goal.y_ft - y) <= PATH_GOAL_TOLERANCE_FT) {
+    if (_remaining_ft < 0.0f) _remaining_ft = 0.0f;
+    finish_(State::DONE, now_ms);
+    return cmd;
+  }
+
+  // Carrot: lookahead further along, the goal once the path runs out
+  s += _lookahead_ft;
+  uint8_t i = _seg;
+  while (s > _len[i] && i + 1 < _segments) s -= _len[i++];
+  float cx = goal.x_ft, cy = goal.y_ft;
+  if (s < _len[i]) {
+    const float f = s / _len[i];
+    cx = _pts[i].x_ft + f * (_pts[i + 1].x_ft - _pts[i].x_ft);
+    cy = _pts[i].y_ft + f * (_pts[i + 1].y_ft - _pts[i].y_ft);
+  }
+
+  const float h = pose.heading_deg * DEG_TO_RAD_F;
+  const float c = cosf(h), sn = sinf(h);
+  const float dx = cx - x, dy = cy - y;
+  const float xl = c * dx + sn * dy;
+  const float yl = -sn * dx + c * dy;
+
+  // Behind (start facing away, or overshot a corner): turn toward it first
+  if (xl <= 0.0f) {
+    cmd.angular_dps = (yl < 0.0f) ? -PATH_MAX_ANGULAR_DPS : PATH_MAX_ANGULAR_DPS;
+    return cmd;
+  }
+
+  const float k = 2.0f * yl / (xl * xl + yl * yl);
+
+  float v = sqrtf(2.0f * PATH_DECEL_FTPS2 * _remaining_ft);
+  if (v < PATH_MIN_SPEED_FTPS) v = PATH_MIN_SPEED_FTPS;
+  if (v > _speed_ftps) v = _speed_ftps;
+
+  const float w_max = PATH_MAX_ANGULAR_DPS * DEG_TO_RAD_F;
+  if (fabsf(v * k) > w_max) v = w_max / fabsf(k);
+
+  cmd.linear_ftps = v;
+  cmd.angular_dps = v * k * RAD_TO_DEG_F;
+  return cmd;
+}
+
+void PathFollower::project_(uint8_t i, float x, float y, float& t, float& d2) const {
+  const PathPoint& a = _pts[i];
+  const PathPoint& b = _pts[i + 1];
+  const float ex = b.x_ft - a.x_ft, ey = b.y_ft - a.y_ft;
+  const float px = x - a.x_ft, py = y - a.y_ft;
+
+  t = (px * ex + py * ey) / (_len[i] * _len[i]);
+  const float tc = (t < 0.0f) ? 0.0f : (t > 1.0f) ? 1.0f : t;
+  const float qx = px - tc * ex, qy = py - tc * ey;
+  d2 = qx * qx + qy * qy;
+}
+
+void PathFollower::finish_(State state, uint32_t now_ms) {
+  _state = state;
+  _gen++;
+  logEvent(now_ms, EventId::PATH_END, (int16_t)state, eventArgScaled(_remaining_ft, 100.0f));
+}
@@ -0,0 +1,103 @@
+#pragma once
+#include <Arduino.h>
+
+#include "Params.h"
+#include "comms/Messages.h"
+
+/*
+===============================================================================
+  PathFollower.h
+===============================================================================
+
+  PURPOSE
+  -------
+  Tracks a short host-uploaded path (PathRequest: up to PATH_MAX_POINTS
+  waypoints in the odometry frame) on the board, at the drive rate,
+  against the on-board pose (sensors/Odometry), so a curve doesn't depend
+  on a 20 Hz host loop and the link's latency. Splines and clothoids are
+  the host's business: it samples them into points, and the follower
+  treats the points as a polyline that starts at the robot.
+
+  Pure pursuit, each tick:
+    - move on to the next segment once the robot is past the end of the
+      current one (or already nearer the next one, after a cut corner)
+    - carrot = the point `lookahead` further along the path than the
+      robot's projection onto it (the last point once that runs out)
+    - carrot in the robot frame (xl forward, yl left):
+        curvature k = 2 yl / (xl^2 + yl^2),  angular = v k
+      a carrot behind the robot (xl <= 0) turns it on the spot first
+    - v = the request's speed, braking into the goal at PATH_DECEL_FTPS2
+      (not below PATH_MIN_SPEED_FTPS), lowered so |angular| stays under
+      PATH_MAX_ANGULAR_DPS
+  Done within PATH_GOAL_TOLERANCE_FT of the last point, or once past it.
+
+  Forward only. The follower never touches hardware: tick() returns the
+  DriveCommand (zero once the path ends) and the caller hands it to the
+  DriveController, so the obstacle guard and the drive limits still
+  apply. An obstacle stop just holds the robot where it is on the path.
+
+  USAGE
+  -----
+    follower.start(request, odom.pose(), now_ms);
+    each drive tick, while running():
+      drive.setCommand(follower.tick(odom.pose(), now_ms));
+    report whenever stateGen() changes
+===============================================================================
+*/
+
+class PathFollower {
+public:
+  enum class State : uint8_t {
+    IDLE = 0,
+    RUNNING,
+    DONE,
+    ABORTED,
+  };
+
+  /*
+    Starts following req.points from `pose`, replacing any path in
+    progress. Points closer than 0.01 ft to the one before are dropped.
+    Returns false (and changes nothing) for anything but a RUN with at
+    least one point away from the robot and a positive (or NAN) speed.
+  */
+  bool start(const PathRequest& req, const PoseState& pose, uint32_t now_ms);
+
+  // Stops following (state ABORTED); the caller stops the drive. No-op when idle.
+  void abort(uint32_t now_ms);
+
+  // Drive command for this tick; zero when not running (and on the tick
+  // that reaches the goal)
+  DriveCommand tick(const PoseState& pose, uint32_t now_ms);
+
+  bool running() const { return _state == State::RUNNING; }
+  State state() const { return _state; }
+
+  // Segment in progress (0 = robot -> points[0]) and segments in the path
+  uint8_t segment() const { return _seg; }
+  uint8_t segments() const { return _segments; }
+
+  // Path length left from the robot's projection to the goal (ft), as of
+  // the last tick
+  float remainingFt() const { return _remaining_ft; }
+
+  // Changes on every start and every end of a path
+  uint8_t stateGen() const { return _gen; }
+
+private:
+  // Robot's position along segment i: t (0..1 inside it) and squared distance
+  void project_(uint8_t i, float x, float y, float& t, float& d2) const;
+  void finish_(State state, uint32_t now_ms);
+
+  // _pts[0] is the robot at start(); segment i runs _pts[i] -> _pts[i + 1]
+  PathPoint _pts[PATH_MAX_POINTS + 1];
+  float _len[PATH_MAX_POINTS] = {};
+  uint8_t _segments = 0;
+  uint8_t _seg = 0;
+
+  float _speed_ftps = PATH_DEFAULT_SPEED_FTPS;
+  float _lookahead_ft = PATH_LOOKAHEAD_FT;
+  float _remaining_ft = 0.0f;
+
+  State _state = State::IDLE;
+  uint8_t _gen = 0;
+};
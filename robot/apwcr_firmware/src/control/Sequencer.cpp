@@ -0,0 +1,206 @@
+#include "control/Sequencer.h"
+#include <math.h>    // fabsf
+#include <string.h>
+
+#include "utils/EventLog.h"
+
+/*
+===============================================================================
+  Sequencer.cpp
+===============================================================================
+
+  Built-in sequences live in flash and are copied into the step buffer on
+  start(), so a run looks the same whether it came from the table or the
+  host. tick() walks forward until a wait isn't satisfied yet; each step
+  only ever moves forward, so one tick is at most one pass over the list.
+===============================================================================
+*/
+
+namespace {
+
+// Host units -> SeqStep::arg units (rounded, for the tables below)
+constexpr int16_t tenths(float v) { return (int16_t)(v * 10.0f + (v >= 0.0f ? 0.5f : -0.5f)); }
+constexpr int16_t hundredths(float v) { return (int16_t)(v * 100.0f + (v >= 0.0f ? 0.5f : -0.5f)); }
+
+constexpr SeqStep step(SeqOp op, int16_t arg = 0, uint16_t timeout_ms = 0) {
+  return SeqStep{(uint8_t)op, arg, timeout_ms};
+}
+
+/*=============================================================================
+  BUILTIN SEQUENCES
+=============================================================================*/
+
+const SeqStep PICKUP_STEPS[] PROGMEM = {
+  step(SeqOp::DRIVE, 0),
+  step(SeqOp::LID, tenths(LID_OPEN_DEG)),
+  step(SeqOp::SWEEP, tenths(SWEEP_DEPLOY_DEG)),
+  step(SeqOp::WAIT_SERVOS, 0, PICKUP_SERVO_TIMEOUT_MS),
+  step(SeqOp::DRIVE, hundredths(PICKUP_CREEP_FTPS)),
+  step(SeqOp::WAIT_TRAVEL, hundredths(PICKUP_CREEP_FT), PICKUP_CREEP_TIMEOUT_MS),
+  step(SeqOp::DRIVE, 0),
+  step(SeqOp::SWEEP, tenths(SWEEP_STOW_DEG)),
+  step(SeqOp::WAIT_SERVOS, 0, PICKUP_SERVO_TIMEOUT_MS),
+  step(SeqOp::LID, tenths(LID_CLOSED_DEG)),
+  step(SeqOp::WAIT_SERVOS, 0, PICKUP_SERVO_TIMEOUT_MS),
+};
+
+const SeqStep STOW_STEPS[] PROGMEM = {
+  step(SeqOp::DRIVE, 0),
+  step(SeqOp::SWEEP, tenths(SWEEP_STOW_DEG)),
+  step(SeqOp::LID, tenths(LID_CLOSED_DEG)),
+  step(SeqOp::WAIT_SERVOS, 0, PICKUP_SERVO_TIMEOUT_MS),
+};
+
+static_assert(sizeof(PICKUP_STEPS) / sizeof(SeqStep) <= SEQ_MAX_STEPS, "pickup sequence too long");
+static_assert(sizeof(STOW_STEPS) / sizeof(SeqStep) <= SEQ_MAX_STEPS, "stow sequence too long");
+
+}  // namespace
+
+
+Sequencer::Sequencer(Io& io)
+: _io(io)
+{
+}
+
+bool Sequencer::loadBuiltin_(SeqId id, SeqStep* steps, uint8_t& count) {
+  const SeqStep* src = nullptr;
+  size_t bytes = 0;
+
+  switch (id) {
+    case SeqId::PICKUP: src = PICKUP_STEPS; bytes = sizeof(PICKUP_STEPS); break;
+    case SeqId::STOW:   src = STOW_STEPS;   bytes = sizeof(STOW_STEPS);   break;
+    default: return false;   // steps untouched
+  }
+
+  memcpy_P(steps, src, bytes);
+  count = (uint8_t)(bytes / sizeof(SeqStep));
+  return true;
+}
+
+bool Sequencer::isWait_(uint8_t op) {
+  return op == (uint8_t)SeqOp::WAIT_SERVOS ||
+         op == (uint8_t)SeqOp::WAIT_MS ||
+         op == (uint8_t)SeqOp::WAIT_TRAVEL;
+}
+
+bool Sequencer::start(const SequenceRequest& req, uint32_t now_ms) {
+  if (req.action == SeqAction::RUN) {
+    if (!loadBuiltin_(req.id, _steps, _status.steps)) return false;
+  } else if (req.action == SeqAction::UPLOAD) {
+    if (req.step_count == 0 || req.step_count > SEQ_MAX_STEPS) return false;
+    memcpy(_steps, req.steps, req.step_count * sizeof(SeqStep));
+    _status.steps = req.step_count;
+  } else {
+    return false;
+  }
+
+  stopDrive_();
+
+  _status.id = (req.action == SeqAction::RUN) ? req.id : SeqId::UPLOAD;
+  _status.state = SeqState::RUNNING;
+  _status.step = 0;
+  _status.timeouts = 0;
+  enter_(now_ms);
+  changed_(now_ms);
+  logEvent(now_ms, EventId::SEQ_START, (int16_t)_status.id, _status.steps);
+
+  tick(now_ms);
+  return true;
+}
+
+void Sequencer::abort(uint32_t now_ms) {
+  if (!running()) return;
+  finish_(SeqState::ABORTED, now_ms);
+}
+
+void Sequencer::tick(uint32_t now_ms) {
+  while (running()) {
+    const SeqStep& st = _steps[_status.step];
+
+    if (isWait_(st.op)) {
+      if (!waitDone_(st, now_ms)) return;
+    } else {
+      act_(st, now_ms);
+    }
+
+    _status.step++;
+    if (_status.step >= _status.steps) {
+      finish_(SeqState::DONE, now_ms);
+      return;
+    }
+    enter_(now_ms);
+    changed_(now_ms);
+  }
+}
+
+void Sequencer::enter_(uint32_t now_ms) {
+  _step_start_ms = now_ms;
+  if (_steps[_status.step].op == (uint8_t)SeqOp::WAIT_TRAVEL) {
+    _travel_start_ft = _io.seqTravelFt();
+  }
+}
+
+void Sequencer::act_(const SeqStep& st, uint32_t now_ms) {
+  switch ((SeqOp)st.op) {
+    case SeqOp::LID:
+    case SeqOp::SWEEP:
+      _io.seqServo((SeqOp)st.op, st.arg, now_ms);
+      break;
+
+    case SeqOp::DRIVE:
+      _linear_ftps = (float)st.arg * 0.01f;
+      _io.seqDrive(_linear_ftps, _angular_dps);
+      break;
+
+    case SeqOp::TURN:
+      _angular_dps = (float)st.arg;
+      _io.seqDrive(_linear_ftps, _angular_dps);
+      break;
+
+    default:
+      break;   // END / unknown ops are skipped
+  }
+}
+
+bool Sequencer::waitDone_(const SeqStep& st, uint32_t now_ms) {
+  const uint32_t elapsed = now_ms - _step_start_ms;
+
+  if (st.op == (uint8_t)SeqOp::WAIT_MS) {
+    return st.arg <= 0 || elapsed >= (uint32_t)st.arg;
+  }
+
+  bool done = false;
+  if (st.op == (uint8_t)SeqOp::WAIT_SERVOS) {
+    done = _io.seqServosSettled();
+  } else {
+    const float moved = _io.seqTravelFt() - _travel_start_ft;
+    const float want = (float)st.arg * 0.01f;
+    done = fabsf(moved) >= fabsf(want);
+  }
+  if (done) return true;
+
+  const uint16_t timeout_ms = st.timeout_ms ? st.timeout_ms : SEQ_DEFAULT_TIMEOUT_MS;
+  if (elapsed < timeout_ms) return false;
+
+  if (_status.timeouts < 0xFF) _status.timeouts++;
+  return true;
+}
+
+void Sequencer::finish_(SeqState state, uint32_t now_ms) {
+  stopDrive_();
+  _status.state = state;
+  changed_(now_ms);
+  logEvent(now_ms, EventId::SEQ_END, (int16_t)state, _status.step);
+}
+
+void Sequencer::stopDrive_() {
+  if (_linear_ftps == 0.0f && _angular_dps == 0.0f) return;
+  _linear_ftps = 0.0f;
+  _angular_dps = 0.0f;
+  _io.seqDrive(0.0f, 0.0f);
+}
+
+void Sequencer::changed_(uint32_t now_ms) {
+  _status.arduino_time_ms = now_ms;
+  _gen++;
+}
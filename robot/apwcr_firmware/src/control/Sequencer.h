@@ -0,0 +1,100 @@
+#pragma once
+#include <Arduino.h>
+
+#include "Params.h"
+#include "comms/Messages.h"
+
+/*
+===============================================================================
+  Sequencer.h
+===============================================================================
+
+  PURPOSE
+  -------
+  Runs a short list of SeqSteps (a built-in macro such as "pickup", or one
+  the host uploaded) on the board, so a multi-step mechanism routine costs
+  one command instead of one host round trip per step.
+
+  Steps:
+    - LID / SWEEP / DRIVE / TURN set a target and finish at once, so a run
+      of them takes effect on the same tick
+    - WAIT_SERVOS waits for the servo move to finish (both at_target)
+    - WAIT_TRAVEL waits until the drive wheels have covered arg (0.01 ft)
+      since the step began, either direction
+    - WAIT_MS waits arg ms
+  A wait that runs past its timeout_ms (0 = SEQ_DEFAULT_TIMEOUT_MS) moves
+  on to the next step and is counted in status().timeouts; WAIT_MS has no
+  timeout of its own.
+
+  The sequencer never touches hardware: every step goes through the Io the
+  main loop implements. Leaving a sequence (done, abort, or a new start)
+  stops the drive if the sequence moved it; servos keep their targets.
+
+  USAGE
+  -----
+    Sequencer seq(io);
+    seq.start(request, now_ms);         // RUN or UPLOAD
+    each tick:  seq.tick(now_ms);
+    report status() whenever statusGen() changes
+===============================================================================
+*/
+
+class Sequencer {
+public:
+  // What the steps act on
+  class Io {
+  public:
+    // op is SeqOp::LID or SeqOp::SWEEP
+    virtual void seqServo(SeqOp op, int16_t ddeg, uint32_t now_ms) = 0;
+    virtual bool seqServosSettled() = 0;
+    virtual void seqDrive(float linear_ftps, float angular_dps) = 0;
+    // Mean signed distance of both drive wheels (ft)
+    virtual float seqTravelFt() = 0;
+  };
+
+  explicit Sequencer(Io& io);
+
+  /*
+    Starts a RUN (built-in id) or UPLOAD request, replacing any sequence in
+    progress, and runs its first steps at once. Returns false (and changes
+    nothing) for an unknown id, an empty upload or any other action.
+  */
+  bool start(const SequenceRequest& req, uint32_t now_ms);
+
+  // Stops the sequence in progress (state ABORTED). No-op when idle.
+  void abort(uint32_t now_ms);
+
+  // Advances through every step that can finish now.
+  void tick(uint32_t now_ms);
+
+  bool running() const { return _status.state == SeqState::RUNNING; }
+  const SequenceStatus& status() const { return _status; }
+
+  // Changes every time status() does (send a status frame when it moves)
+  uint8_t statusGen() const { return _gen; }
+
+private:
+  static bool loadBuiltin_(SeqId id, SeqStep* steps, uint8_t& count);
+  static bool isWait_(uint8_t op);
+
+  void enter_(uint32_t now_ms);
+  void act_(const SeqStep& st, uint32_t now_ms);
+  bool waitDone_(const SeqStep& st, uint32_t now_ms);
+  void finish_(SeqState state, uint32_t now_ms);
+  void stopDrive_();
+  void changed_(uint32_t now_ms);
+
+  Io& _io;
+
+  SeqStep _steps[SEQ_MAX_STEPS];
+  SequenceStatus _status;
+  uint8_t _gen = 0;
+
+  // Current step
+  uint32_t _step_start_ms = 0;
+  float _travel_start_ft = 0.0f;
+
+  // Drive the sequence asked for (0 = never moved it)
+  float _linear_ftps = 0.0f;
+  float _angular_dps = 0.0f;
+};
@@ -0,0 +1,277 @@
+#include "control/SysId.h"
+#include <math.h>  // sinf, logf
+#include <string.h>
+
+/*
+===============================================================================
+  SysId.cpp
+===============================================================================
+
+  Per tick: two count differences and a sinf during the chirp; per fit
+  period 20 multiply-adds per motor. The 4x4 solve (Gaussian elimination)
+  runs once, when the run ends.
+===============================================================================
+*/
+
+namespace {
+
+// Excitation per target: u = duty during the step, then
+// duty * (chirp_mean + chirp_amp * sin) for SYSID_CHIRP_MS
+struct Program {
+  float default_duty;
+  float max_duty;               // cap on the chirp peak
+  uint16_t step_ms;
+  float chirp_mean;
+  float chirp_amp;
+  float stopped;                // speeds below this stay out of the fit
+  uint8_t fit_ticks;            // ticks per fit period
+};
+
+Program program(SysId::Target target) {
+  if (target == SysId::Target::ARM) {
+    return { SYSID_ARM_DUTY, (float)ARM_MAX_PWM / (float)PWM_MAX, SYSID_ARM_STEP_MS,
+             SYSID_ARM_CHIRP_MEAN, SYSID_ARM_CHIRP_AMP, SYSID_ARM_STOPPED_DPS,
+             SYSID_ARM_FIT_TICKS };
+  }
+  return { SYSID_DRIVE_DUTY, DRIVE_STEP_MAX_DUTY, SYSID_DRIVE_STEP_MS,
+           SYSID_DRIVE_CHIRP_MEAN, SYSID_DRIVE_CHIRP_AMP, DRIVE_STOPPED_FTPS, 1 };
+}
+
+// Solves m x = r in place (partial pivoting). false if singular.
+template <uint8_t N>
+bool solve(float (&m)[N][N], float (&r)[N], float (&x)[N]) {
+  for (uint8_t col = 0; col < N; col++) {
+    uint8_t piv = col;
+    for (uint8_t i = col + 1; i < N; i++) {
+      if (fabsf(m[i][col]) > fabsf(m[piv][col])) piv = i;
+    }
+    if (!(fabsf(m[piv][col]) > 0.0f)) return false;
+    if (piv != col) {
+      for (uint8_t j = 0; j < N; j++) { const float t = m[col][j]; m[col][j] = m[piv][j]; m[piv][j] = t; }
+      const float t = r[col]; r[col] = r[piv]; r[piv] = t;
+    }
+    for (uint8_t i = col + 1; i < N; i++) {
+      const float f = m[i][col] / m[col][col];
+      for (uint8_t j = col; j < N; j++) m[i][j] -= f * m[col][j];
+      r[i] -= f * r[col];
+    }
+  }
+  for (int8_t i = N - 1; i >= 0; i--) {
+    float v = r[i];
+    for (uint8_t j = i + 1; j < N; j++) v -= m[i][j] * x[j];
+    x[i] = v / m[i][i];
+    if (!isfinite(x[i])) return false;
+  }
+  return true;
+}
+
+int16_t sat16(int32_t v) {
+  if (v > 32767) return 32767;
+  if (v < -32768) return -32768;
+  return (int16_t)v;
+}
+
+}  // namespace
+
+
+float SysId::unitsPerCount(Target target) {
+  return (target == Target::ARM) ? 360.0f / COUNTS_PER_ARM_REV : FEET_PER_COUNT;
+}
+
+bool SysId::start(Target target, float duty, uint32_t now_ms) {
+  if (running()) return false;
+
+  const Program pg = program(target);
+  if (!(isfinite(duty) && duty > 0.0f)) duty = pg.default_duty;
+  const float peak = fmaxf(1.0f, pg.chirp_mean + pg.chirp_amp);
+  if (duty * peak > pg.max_duty) duty = pg.max_duty / peak;
+
+  const uint8_t gen = _res.gen;
+  _res = Result();
+  _res.gen = gen;
+  _res.target = target;
+  _res.phase = Phase::STEP;
+  _res.duty = duty;
+
+  _t0_ms = now_ms;
+  _chirp_cycles = 0.0f;
+  _primed = false;
+  _prev_u = 0.0f;
+  _fit_delta[0] = _fit_delta[1] = 0;
+  _fit_duty = _fit_dt_s = 0.0f;
+  _fit_n = 0;
+  _prev_fu[0] = _prev_fu[1] = 0.0f;
+  _periods = 0;
+  memset(_acc, 0, sizeof(_acc));
+  _dt_sum = 0.0f;
+  _dt_n = 0;
+
+  _len = 0;
+  _run++;
+  _dec_delta[0] = _dec_delta[1] = 0;
+  _dec_duty = 0.0f;
+  _dec_n = 0;
+  return true;
+}
+
+void SysId::abort() {
+  if (running()) end_(Phase::ABORTED);
+}
+
+void SysId::end_(Phase phase) {
+  _res.phase = phase;
+  _res.gen++;
+}
+
+float SysId::tick(uint32_t now_ms, int32_t count0, int32_t count1) {
+  if (!running()) return 0.0f;
+
+  const int32_t count[2] = {count0, count1};
+  if (!_primed) {
+    _last_count[0] = count0;
+    _last_count[1] = count1;
+    _last_ms = now_ms;
+    _primed = true;
+    _prev_u = excite_(now_ms - _t0_ms, 0.0f);
+    return _prev_u;
+  }
+
+  const uint32_t dt_ms = now_ms - _last_ms;
+  if (dt_ms == 0) return _prev_u;   // same instant twice: nothing measured
+  _last_ms = now_ms;
+  const float dt_s = (float)dt_ms * 0.001f;
+
+  // Count change over the tick that just ended, under the duty set at its start
+  int32_t delta[2];
+  for (uint8_t i = 0; i < 2; i++) {
+    delta[i] = count[i] - _last_count[i];
+    _last_count[i] = count[i];
+  }
+  record_(delta, _prev_u);
+  fitPeriod_(delta, _prev_u, dt_s);
+
+  const Program pg = program(_res.target);
+  const uint32_t t_ms = now_ms - _t0_ms;
+  if (t_ms >= (uint32_t)pg.step_ms + SYSID_CHIRP_MS) {
+    finish_();
+    return 0.0f;
+  }
+
+  _prev_u = excite_(t_ms, dt_s);
+  return _prev_u;
+}
+
+float SysId::excite_(uint32_t t_ms, float dt_s) {
+  const Program pg = program(_res.target);
+  if (t_ms < pg.step_ms) return _res.duty;
+  _res.phase = Phase::CHIRP;
+
+  // Linear sweep: the phase integrates the instantaneous frequency
+  const float x = (float)(t_ms - pg.step_ms) / (float)SYSID_CHIRP_MS;
+  _chirp_cycles += (SYSID_CHIRP_F0_HZ + (SYSID_CHIRP_F1_HZ - SYSID_CHIRP_F0_HZ) * x) * dt_s;
+  if (_chirp_cycles >= 1.0f) _chirp_cycles -= 1.0f;
+  return _res.duty * (pg.chirp_mean + pg.chirp_amp * sinf(2.0f * PI * _chirp_cycles));
+}
+
+void SysId::record_(const int32_t* delta, float duty) {
+  _dec_delta[0] += delta[0];
+  _dec_delta[1] += delta[1];
+  _dec_duty += duty;
+  if (++_dec_n < SYSID_DECIMATE) return;
+
+  if (_len < 0xFFFF) {
+    SysIdSample& s = _buf[_len++ % _capacity];
+    s.duty = (int8_t)constrain(lroundf(_dec_duty / (float)_dec_n * 127.0f), -127L, 127L);
+    s.delta[0] = sat16(_dec_delta[0]);
+    s.delta[1] = sat16(_dec_delta[1]);
+  }
+  _dec_delta[0] = _dec_delta[1] = 0;
+  _dec_duty = 0.0f;
+  _dec_n = 0;
+}
+
+void SysId::fitPeriod_(const int32_t* delta, float duty, float dt_s) {
+  const Program pg = program(_res.target);
+  _fit_delta[0] += delta[0];
+  _fit_delta[1] += delta[1];
+  _fit_duty += duty;
+  _fit_dt_s += dt_s;
+  if (++_fit_n < pg.fit_ticks) return;
+
+  const float u = _fit_duty / (float)_fit_n;
+  const float upc = unitsPerCount(_res.target);
+  for (uint8_t i = 0; i < 2; i++) {
+    const float v = (float)_fit_delta[i] * upc / _fit_dt_s;
+
+    // (v[k], u[k], u[k-1], sign v[k]) -> v[k+1], this period's speed
+    const float pv = _prev_v[i];
+    if (_periods >= 2 && fabsf(pv) > pg.stopped) {
+      const float s = (pv > 0.0f) ? 1.0f : -1.0f;
+      const float x[TERMS] = { pv, u, _prev_fu[0], s };
+      const float z[TERMS] = { _prev_fu[1], u, _prev_fu[0], s };
+      Accum& a = _acc[i];
+      for (uint8_t r = 0; r < TERMS; r++) {
+        for (uint8_t c = 0; c < TERMS; c++) a.zx[r][c] += z[r] * x[c];
+        a.zy[r] += z[r] * v;
+      }
+      a.n++;
+    }
+    _prev_v[i] = v;
+    _fit_delta[i] = 0;
+  }
+  _prev_fu[1] = _prev_fu[0];
+  _prev_fu[0] = u;
+  if (_periods < 2) _periods++;
+  _dt_sum += _fit_dt_s;
+  _dt_n++;
+  _fit_duty = _fit_dt_s = 0.0f;
+  _fit_n = 0;
+}
+
+void SysId::finish_() {
+  const float dt_s = _dt_n ? _dt_sum / (float)_dt_n : 1.0f / (float)DRIVE_UPDATE_HZ;
+  solve_(_acc[0], dt_s, _res.fit[0]);
+  solve_(_acc[1], dt_s, _res.fit[1]);
+  end_(Phase::DONE);
+}
+
+void SysId::solve_(const Accum& a, float dt_s, Fit& out) {
+  out = Fit();
+  out.samples = a.n;
+  if (a.n < SYSID_MIN_FIT_SAMPLES) return;
+
+  float m[TERMS][TERMS], r[TERMS], th[TERMS];
+  memcpy(m, a.zx, sizeof(m));
+  memcpy(r, a.zy, sizeof(r));
+  if (!solve(m, r, th)) return;
+
+  // A stable lag that speeds up with duty, or no estimate
+  const float ka = th[0], kb = th[1] + th[2], kc = th[3];
+  if (!(ka > 0.0f && ka < 1.0f && kb > 0.0f)) return;
+  out.tau_s = -dt_s / logf(ka);
+  out.gain = kb / (1.0f - ka);
+  out.kv = (1.0f - ka) / kb;
+  out.ks = fmaxf(0.0f, -kc / kb);
+}
+
+bool SysId::chunk(uint16_t first, SysIdChunk& out) const {
+  if (first >= _len) return false;
+  const uint16_t oldest = (_len > _capacity) ? (uint16_t)(_len - _capacity) : 0;
+  if (first < oldest) first = oldest;   // overwritten before it went out
+
+  // Contiguous in the ring: a chunk stops at its end
+  const uint16_t slot = first % _capacity;
+  uint16_t n = _len - first;
+  if (n > SYSID_CHUNK_SAMPLES) n = SYSID_CHUNK_SAMPLES;
+  if (n > _capacity - slot) n = _capacity - slot;
+
+  out.target = (uint8_t)_res.target;
+  out.gen = _run;
+  out.period_ms = (uint8_t)(SYSID_DECIMATE * 1000UL / DRIVE_UPDATE_HZ);
+  out.units_per_count = unitsPerCount(_res.target);
+  out.first = first;
+  out.total = _len;
+  out.count = (uint8_t)n;
+  out.samples = _buf + slot;
+  return true;
+}
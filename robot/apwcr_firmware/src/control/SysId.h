@@ -0,0 +1,155 @@
+#pragma once
+#include <Arduino.h>
+
+#include "Params.h"
+#include "comms/Messages.h"
+
+/*
+===============================================================================
+  SysId.h
+===============================================================================
+
+  PURPOSE
+  -------
+  Open-loop characterization of one motor pair (the drive wheels or the
+  arm joints), run from the host with a "test" frame (Params.h,
+  SYSTEM IDENTIFICATION):
+
+    - Excitation: both motors get the same duty, a step and then a linear
+      chirp (the program per Target is in SysId.cpp)
+    - Estimate: a fit per motor of the first order lag as seen through
+      the encoder, v = mean speed over a fit period T (the count change),
+      u = duty held over it:
+        v[k+1] = a v[k] + b1 u[k] + b0 u[k-1] + c sign(v[k])
+      (exact for a lag with friction; moving samples only). Instrumental
+      variables: u[k-2] stands in for v[k] in the normal equations, since
+      count quantization makes neighbouring speeds' errors correlated and
+      plain least squares would pull a (tau) well low. At the end:
+      tau = -T / ln(a), gain K = (b1 + b0) / (1 - a), KV = 1 / K,
+      KS = -c / (b1 + b0). T is one tick for the drive, a few for the
+      coarser arm encoders (Params.h, SYSID_ARM_FIT_TICKS)
+    - Capture: one SysIdSample per SYSID_DECIMATE ticks into the caller's
+      ring, for the host to fit or plot; chunk() reads it out while the
+      run goes
+
+  The fit needs only sums, so it runs at the full tick rate whatever the
+  capture holds. Sample numbers count from the start of the run; the ring
+  keeps the newest `capacity` of them, so a stream that falls further
+  behind than that skips the overwritten ones (the chunk's first shows it).
+
+  No hardware here: tick() takes the pair's encoder counts and returns the
+  duty to write, so main keeps the motors and the native harness drives it
+  from a simulated plant. While running() the caller owns the safety
+  checks (watchdogs, the arms' travel) and keeps the controllers off the
+  pair.
+
+  USAGE
+  -----
+    static SysIdSample g_buf[SYSID_RING_SAMPLES];
+    static SysId g_sysid(g_buf, SYSID_RING_SAMPLES);
+    g_sysid.start(SysId::Target::DRIVE, NAN, now_ms);  next = 0
+    drive tick:  duty = g_sysid.tick(now_ms, left_count, right_count);
+    streaming:   chunk(next, c), send c, next = c.first + c.count
+                 (whole chunks while running(), the rest after)
+    once result().gen moves on: result()
+===============================================================================
+*/
+
+class SysId {
+public:
+  enum class Target : uint8_t { DRIVE = 0, ARM };
+  enum class Phase : uint8_t { IDLE = 0, STEP, CHIRP, DONE, ABORTED };
+
+  // Per motor; NAN = no estimate (too few moving samples, or the fit
+  // wasn't a stable first order lag)
+  struct Fit {
+    float gain = NAN;           // steady speed per unit duty (ft/s, deg/s)
+    float tau_s = NAN;          // time constant
+    float kv = NAN;             // duty per unit speed (1 / gain)
+    float ks = NAN;             // duty lost to friction
+    uint16_t samples = 0;       // ticks in the fit
+  };
+
+  struct Result {
+    Target target = Target::DRIVE;
+    Phase phase = Phase::IDLE;
+    float duty = 0.0f;          // step duty used
+    Fit fit[2];                 // left/LHS, right/RHS
+    uint8_t gen = 0;            // bumped when a run ends (DONE or ABORTED)
+  };
+
+  SysId(SysIdSample* buf, uint16_t capacity) : _buf(buf), _capacity(capacity) {}
+
+  // duty: step duty, NAN = the target's default; clamped so the chirp
+  // peak stays within the pair's limit. false while a run is going.
+  bool start(Target target, float duty, uint32_t now_ms);
+  void abort();
+  bool running() const { return _res.phase == Phase::STEP || _res.phase == Phase::CHIRP; }
+
+  // One control tick with the pair's signed counts (sampled this tick).
+  // Returns the duty for both motors: 0 once not running.
+  float tick(uint32_t now_ms, int32_t count0, int32_t count1);
+
+  const Result& result() const { return _res; }
+  Target target() const { return _res.target; }
+
+  // Samples taken in the current (or last) run so far
+  uint16_t captured() const { return _len; }
+
+  // Up to SYSID_CHUNK_SAMPLES samples from `first` (moved up to the oldest
+  // one still held), valid until the next tick(); false past the newest.
+  // out.gen is the run, the same from its first chunk to its last.
+  bool chunk(uint16_t first, SysIdChunk& out) const;
+
+  // Speed units per encoder count of the target (ft or deg)
+  static float unitsPerCount(Target target);
+
+private:
+  // Normal equations of the fit: Z'X and Z'y (Z = X with u[k-2] for v[k])
+  static constexpr uint8_t TERMS = 4;
+  struct Accum {
+    float zx[TERMS][TERMS];
+    float zy[TERMS];
+    uint16_t n;
+  };
+
+  float excite_(uint32_t t_ms, float dt_s);
+  void record_(const int32_t* delta, float duty);
+  void fitPeriod_(const int32_t* delta, float duty, float dt_s);
+  void finish_();
+  static void solve_(const Accum& a, float dt_s, Fit& out);
+  void end_(Phase phase);
+
+  SysIdSample* _buf;
+  uint16_t _capacity;
+  uint16_t _len = 0;            // samples this run (ring slot = _len % _capacity)
+  uint8_t _run = 0;             // bumped by start(), sent as the chunks' gen
+
+  Result _res;
+  uint32_t _t0_ms = 0;
+  uint32_t _last_ms = 0;
+  float _chirp_cycles = 0.0f;   // chirp phase, in cycles
+
+  int32_t _last_count[2] = {0, 0};
+  bool _primed = false;         // _last_count / _last_ms valid
+
+  float _prev_u = 0.0f;         // duty set last tick (applied since)
+
+  // Fit: the period being summed, then the previous period's speed and
+  // the previous two periods' duty (v[k], u[k-1], u[k-2])
+  int32_t _fit_delta[2] = {0, 0};
+  float _fit_duty = 0.0f;
+  float _fit_dt_s = 0.0f;
+  uint8_t _fit_n = 0;
+  float _prev_v[2] = {0.0f, 0.0f};
+  float _prev_fu[2] = {0.0f, 0.0f};
+  uint8_t _periods = 0;         // completed, counted up to 2
+  Accum _acc[2] = {};
+  float _dt_sum = 0.0f;
+  uint16_t _dt_n = 0;
+
+  // Capture decimation
+  int32_t _dec_delta[2] = {0, 0};
+  float _dec_duty = 0.0f;
+  uint8_t _dec_n = 0;
+};
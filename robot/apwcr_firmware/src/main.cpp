@@ -7,7 +7,47 @@
   For now:
   - RX: call SerialLink.RxTick() so we can receive + parse commands
   - TX: send telemetry at TELEMETRY_UPDATE_HZ so the GUI can display data
-  - No sensors yet (no DistanceSensor, encoders, motors, servos)
+    (or per group once the host subscribes, see SerialLink::publish)
+  - Drive: closed-loop wheel speed (DriveController) at DRIVE_UPDATE_HZ, all
+    four encoders sampled at one instant first (EncoderBank). With
+    ENABLE_DRIVE_ISR_LOOP the wheel PIDs and PWM writes run in the sampler's
+    Timer1 ISR at DRIVE_ISR_HZ instead (DriveInnerLoop), off a setpoint the
+    drive task hands over, so comms work can't delay them
+  - Odometry: pose integrated from the drive encoders at ENCODER_SAMPLE_HZ
+    (sampler ISR), reset by a host "pose" frame
+  - Arms: joint position PID, synchronized pair (MechanismController),
+    ticked with the drive loop
+  - Ultrasonic: DistanceSensorArray fires the HC-SR04s round-robin by slot
+    (one sensor unless ULTRASONIC_SENSOR_COUNT says otherwise)
+  - Sequences: on-board step lists ("pickup", or uploaded by the host) run
+    by the Sequencer; while one runs it owns the drive and servo targets
+  - Paths: host-uploaded waypoints tracked by pure pursuit on the odometry
+    pose every drive tick (PathFollower); while one runs it owns the drive
+  - Obstacle guard: forward speed capped every drive tick from the front
+    sonar tracks (stop distance doesn't wait on the host)
+  - Tuning: gains, limits, ramps and rates from the ParamStore (EEPROM,
+    else Params.h), changed by host "param" frames between drive ticks
+  - Tests: host "test" frames start the drive step test (feed-forward
+    identification, DriveController) or a motor pair characterization
+    (SysId: step + chirp, on-board fit seeding the ParamStore, capture
+    streamed as it runs); results come back as one note
+  - Safety: Watchdog liveness channels (drive 250 ms, arms, link, control
+    loop) each run their stop action once, plus the hardware WDT
+  - Event log: commands applied, watchdog trips, servo detaches, RX
+    failures, obstacle stops, ... in a RAM ring (EventLog), streamed to
+    the host on a "log" dump request
+  - Memory: painted-stack high-water mark and static SRAM (StackMonitor),
+    reported in the perf frame
+  - Power: SLEEP_MODE_IDLE between scheduler releases, ADC/SPI/TWI clocks
+    gated (PowerSaver); the perf frame reports the share of time asleep
+  - Aux link (ENABLE_AUX_LINK, off by default for the SRAM): second
+    SerialLink on the Pi's GPIO UART (SERIAL_AUX). While the Pi is
+    listening it carries the encoder batches and perf frames at its own
+    rate; commands, notes and param replies stay on USB
+  - RX capture (instead of the aux link): USB RX bytes, timestamped, out on
+    SERIAL_AUX for replay in env:native (RxRecorder, native/RxReplay.h)
+  - Scope markers (ENABLE_SCOPE_MARKERS): a GPIO pulse per task run and per
+    ISR for a logic analyzer (ScopeMarker, pin map in Pins.h)
 */
 
 #include <Arduino.h>
@@ -15,10 +55,35 @@
 #include "Pins.h"
 #include "Params.h"
 
-#include "utils/Rate.h"
+#include "utils/Scheduler.h"
+#include "utils/Profiler.h"
+#include "utils/Watchdog.h"
+#include "utils/ParamStore.h"
+#include "utils/PowerSaver.h"
+#include "utils/StackMonitor.h"
+#include "utils/EventLog.h"
+#include "utils/ScopeMarker.h"
+#include "comms/Uart.h"
+#include "comms/RxRecorder.h"
 #include "comms/SerialLink.h"
 #include "sensors/DistanceSensor.h"
-#include "actuators/ServoActuator.h"
+#include "sensors/DistanceSensorArray.h"
+#include "sensors/EncoderBank.h"
+#include "sensors/EncoderSensor.h"
+#include "sensors/EncoderSampler.h"
+#include "sensors/Odometry.h"
+#include "actuators/ServoActuatorT.h"
+#include "actuators/ServoPair.h"
+#include "actuators/DcMotorActuator.h"
+#include "control/DriveController.h"
+#include "control/DriveInnerLoop.h"
+#include "control/MechanismController.h"
+#include "control/ObstacleGuard.h"
+#include "control/MotionProfile.h"
+#include "control/Sequencer.h"
+#include "control/PathFollower.h"
+#include "control/SysId.h"
+#include "utils/Rate.h"
 
 
 
@@ -26,154 +91,989 @@
   GLOBALS
 =============================================================================*/
 
-// Serial link (USB)
-SerialLink g_link(SERIAL_USB);
+// Serial link (USB). With ENABLE_RX_CAPTURE it reads through the recorder,
+// which copies every byte it takes to SERIAL_AUX for offline replay.
+static RxRecorder g_rx_recorder(SERIAL_USB, SERIAL_AUX);
+static uint8_t g_link_tx[SERIAL_TX_FRAME_BYTES];
+SerialLink g_link(ENABLE_RX_CAPTURE ? static_cast<BulkStream&>(g_rx_recorder) : static_cast<BulkStream&>(SERIAL_USB),
+                  g_link_tx, sizeof(g_link_tx));
+static_assert(!(ENABLE_RX_CAPTURE && ENABLE_AUX_LINK), "RX capture uses SERIAL_AUX: turn ENABLE_AUX_LINK off");
+
+// Telemetry offload to the Pi (telemetry-only, see auxActive()). Built on
+// first use: every call sits behind ENABLE_AUX_LINK, so with it off the
+// second link and its stage (~2.7 KB with the USART2 rings) aren't linked.
+static SerialLink& auxLink() {
+  static uint8_t tx[AUX_TX_FRAME_BYTES];
+  static SerialLink link(SERIAL_AUX, tx, sizeof(tx));
+  return link;
+}
+static_assert(protocol::bin::MAX_FRAME_BYTES <= AUX_TX_FRAME_BYTES, "AUX_TX_FRAME_BYTES below the largest binary frame");
 
-// Distance Sensor
+// Distance Sensors (front first: it is the one in UltrasonicState)
 DistanceSensor g_distance_sensor(PIN_ULTRASONIC_TRIG, PIN_ULTRASONIC_ECHO, ULTRASONIC_MAX_DISTANCE_CM, ULTRASONIC_TIMEOUT_US, ULTRASONIC_MIN_IN, ULTRASONIC_MAX_VALID_IN);
+DistanceSensor g_sonar_fl(PIN_ULTRASONIC_FL_TRIG, PIN_ULTRASONIC_FL_ECHO, ULTRASONIC_MAX_DISTANCE_CM, ULTRASONIC_TIMEOUT_US, ULTRASONIC_MIN_IN, ULTRASONIC_MAX_VALID_IN);
+DistanceSensor g_sonar_fr(PIN_ULTRASONIC_FR_TRIG, PIN_ULTRASONIC_FR_ECHO, ULTRASONIC_MAX_DISTANCE_CM, ULTRASONIC_TIMEOUT_US, ULTRASONIC_MIN_IN, ULTRASONIC_MAX_VALID_IN);
+DistanceSensor g_sonar_rear(PIN_ULTRASONIC_REAR_TRIG, PIN_ULTRASONIC_REAR_ECHO, ULTRASONIC_MAX_DISTANCE_CM, ULTRASONIC_TIMEOUT_US, ULTRASONIC_MIN_IN, ULTRASONIC_MAX_VALID_IN);
+
+// Firing slots: front and rear face apart, so they share one
+static DistanceSensor* const SONARS[] = { &g_distance_sensor, &g_sonar_fl, &g_sonar_fr, &g_sonar_rear };
+static constexpr uint8_t SONAR_SLOTS[] = { 0, 1, 2, 0 };
+
+static constexpr uint8_t sonarSlotsUsed(uint8_t n) {
+  return n ? ((SONAR_SLOTS[n - 1] + 1 > sonarSlotsUsed(n - 1)) ? SONAR_SLOTS[n - 1] + 1 : sonarSlotsUsed(n - 1)) : 0;
+}
+
+static_assert(ULTRASONIC_SENSOR_COUNT >= 1 && ULTRASONIC_SENSOR_COUNT <= sizeof(SONAR_SLOTS), "ULTRASONIC_SENSOR_COUNT out of range");
+static_assert(sonarSlotsUsed(ULTRASONIC_SENSOR_COUNT) == ULTRASONIC_SLOTS, "ULTRASONIC_SLOTS must match SONAR_SLOTS");
+static_assert(1000UL / ((uint32_t)ULTRASONIC_UPDATE_HZ * ULTRASONIC_SLOTS) >=
+                  ULTRASONIC_TIMEOUT_US / 1000UL + ULTRASONIC_RINGDOWN_MS,
+              "ultrasonic slot shorter than echo timeout + ring-down: lower ULTRASONIC_UPDATE_HZ");
+
+DistanceSensorArray g_sonar(SONARS, SONAR_SLOTS, ULTRASONIC_SENSOR_COUNT);
+
+// Drive base
+EncoderSensor g_left_drive_enc(LhsDriveEncoder::channel(), COUNTS_PER_WHEEL_REV, LHS_DRIVE_ENCODER_INVERT);
+EncoderSensor g_right_drive_enc(RhsDriveEncoder::channel(), COUNTS_PER_WHEEL_REV, RHS_DRIVE_ENCODER_INVERT);
+
+DcMotorActuator g_left_drive_motor(PIN_LHS_DRIVE_DIR, PIN_LHS_DRIVE_PWM, LHS_DRIVE_MOTOR_INVERT, (uint8_t)PWM_MIN, (uint8_t)PWM_MAX);
+DcMotorActuator g_right_drive_motor(PIN_RHS_DRIVE_DIR, PIN_RHS_DRIVE_PWM, RHS_DRIVE_MOTOR_INVERT, (uint8_t)PWM_MIN, (uint8_t)PWM_MAX);
+
+DriveController g_drive(g_left_drive_enc, g_right_drive_enc, g_left_drive_motor, g_right_drive_motor);
+
+// Wheel PIDs in the sampler's Timer1 ISR (ENABLE_DRIVE_ISR_LOOP)
+static DriveInnerLoop g_drive_isr(g_left_drive_motor, g_right_drive_motor);
+static uint16_t g_drive_isr_sent_trips = 0;   // staleTrips() last logged
+static_assert(!ENABLE_DRIVE_ISR_LOOP || ENABLE_ENCODER_SAMPLER,
+              "the drive inner loop runs in the encoder sampler's ISR");
+
+// Obstacle guard on the forward-facing sonars (SONARS[0..2]: front, FL, FR)
+static ObstacleGuard g_obstacle;
+static const RangeFilter::Output* const FRONT_RANGES[] = {
+  &g_distance_sensor.filter().output(), &g_sonar_fl.filter().output(), &g_sonar_fr.filter().output()
+};
+static constexpr uint8_t FRONT_RANGE_COUNT =
+  (ULTRASONIC_SENSOR_COUNT < sizeof(FRONT_RANGES) / sizeof(FRONT_RANGES[0]))
+    ? ULTRASONIC_SENSOR_COUNT : (uint8_t)(sizeof(FRONT_RANGES) / sizeof(FRONT_RANGES[0]));
+
+// Pickup arms (angles from the power-up pose)
+EncoderSensor g_lhs_arm_enc(LhsArmEncoder::channel(), COUNTS_PER_ARM_REV, LHS_ARM_ENCODER_INVERT);
+EncoderSensor g_rhs_arm_enc(RhsArmEncoder::channel(), COUNTS_PER_ARM_REV, RHS_ARM_ENCODER_INVERT);
+
+DcMotorActuator g_lhs_arm_motor(PIN_LHS_ARM_DIR, PIN_LHS_ARM_PWM, LHS_ARM_MOTOR_INVERT, (uint8_t)PWM_MIN, (uint8_t)PWM_MAX);
+DcMotorActuator g_rhs_arm_motor(PIN_RHS_ARM_DIR, PIN_RHS_ARM_PWM, RHS_ARM_MOTOR_INVERT, (uint8_t)PWM_MIN, (uint8_t)PWM_MAX);
+
+MechanismController g_mech(g_lhs_arm_enc, g_rhs_arm_enc, g_lhs_arm_motor, g_rhs_arm_motor);
+
+// Every encoder sampled at one instant each drive tick
+static EncoderSensor* const ENCODERS[] = { &g_left_drive_enc, &g_right_drive_enc, &g_lhs_arm_enc, &g_rhs_arm_enc };
+static EncoderBank g_encoders(ENCODERS, sizeof(ENCODERS) / sizeof(ENCODERS[0]));
+static_assert(sizeof(ENCODERS) / sizeof(ENCODERS[0]) <= ENCODER_BANK_MAX, "ENCODER_BANK_MAX too small");
+
+// Full-rate drive encoder samples (Timer1 ISR), shipped in binary telemetry
+EncoderSampler g_enc_sampler(g_left_drive_enc, g_right_drive_enc);
+static EncoderBatch g_enc_batch;
+
+// Dead reckoning, fed by the sampler ISR (or the drive task without it)
+static Odometry g_odom;
+
+// Servos (types in actuators/ServoPair.h)
+LidServo g_lid_servo;
+SweepServo g_sweep_servo;
+
+// Coordinated servo moves: one profile per command, both servos arrive
+// together (axes that aren't moving are left alone)
+static ServoPair<LidServo, SweepServo> g_servos(g_lid_servo, g_sweep_servo);
+
+// On-board sequences: steps act through SeqIo (defined below commandServos)
+class SeqIo : public Sequencer::Io {
+public:
+  void seqServo(SeqOp op, int16_t ddeg, uint32_t now_ms) override;
+  bool seqServosSettled() override;
+  void seqDrive(float linear_ftps, float angular_dps) override;
+  float seqTravelFt() override;
+};
+
+static SeqIo g_seq_io;
+static Sequencer g_sequencer(g_seq_io);
+static uint8_t g_seq_sent_gen = 0;   // statusGen() last reported to the host
+static uint8_t g_step_sent_gen = 0;  // stepTest().gen last reported to the host
+
+// Host paths, followed from the drive task
+static PathFollower g_path;
+static uint8_t g_path_sent_gen = 0;  // stateGen() last reported to the host
+
+// Motor pair characterization; its capture streams out while each run goes
+static SysIdSample g_sysid_buf[SYSID_RING_SAMPLES];
+static SysId g_sysid(g_sysid_buf, SYSID_RING_SAMPLES);
+static uint8_t g_sysid_sent_gen = 0;   // result().gen last reported to the host
+static uint16_t g_sysid_tx = 0;        // next capture sample to stream
+static Rate g_sysid_rate(SYSID_STREAM_HZ);
+
+// Event log dump in progress: records [g_log_tx, g_log_end) still to send
+static bool g_log_dumping = false;
+static uint16_t g_log_tx = 0;
+static uint16_t g_log_end = 0;
+static Rate g_log_rate(EVENT_LOG_DUMP_HZ);
+
+// Scheduler (replaces one Rate per task)
+Scheduler g_sched;
+static uint8_t g_task_telemetry = Scheduler::INVALID_TASK;
+static uint8_t g_task_aux = Scheduler::INVALID_TASK;
+static uint8_t g_task_ultrasonic = Scheduler::INVALID_TASK;
+static uint8_t g_task_sequence = Scheduler::INVALID_TASK;
+
+// Runtime tuning; the reply to the last request is resent until staged
+static ParamStore g_params;
+static ParamReply g_param_reply;
+static bool g_param_reply_due = false;
+
+// Task/loop timing (reported in "perf" frames)
+Profiler g_profiler;
+static PerfFrame g_perf;
+
+// SRAM headroom (painted in .init3, reported in "perf" frames)
+static StackMonitor g_stack;
+
+// Safety watchdog (stop table below the SeqIo methods)
+enum : uint8_t { WD_DRIVE = 0, WD_ARM, WD_LINK, WD_CONTROL, WD_CHANNELS };
+static Watchdog g_watchdog;
+static uint32_t g_fed_cmd_ms = 0;    // lastCommandMs() last fed to the watchdog
+static bool g_host_seen = false;
+
+// MCUSR as it was at reset. Read in .init3, before the runtime clears .bss
+// (hence .noinit) and before a WDT reset's 15 ms WDT can fire again.
+static uint8_t g_reset_flags __attribute__((section(".noinit")));
+
+static void captureResetFlags() __attribute__((naked, used, section(".init3")));
+static void captureResetFlags() {
+  g_reset_flags = MCUSR;
+  MCUSR = 0;
+  wdt_disable();
+}
+
+// Boot hello (comms/Messages.h HelloFrame): the "link" one from setup(),
+// the "ready" one once the first telemetry frame is staged (resent until
+// it is staged itself)
+static constexpr uint16_t BUILD_FEATURES =
+  (ENABLE_ENCODER_SAMPLER ? FEATURE_ENCODER_SAMPLER : 0) |
+  (ENABLE_PERF_REPORT     ? FEATURE_PERF_REPORT : 0) |
+  (ENABLE_IDLE_SLEEP      ? FEATURE_IDLE_SLEEP : 0) |
+  (ENABLE_AUX_LINK        ? FEATURE_AUX_LINK : 0) |
+  (ENABLE_RX_CAPTURE      ? FEATURE_RX_CAPTURE : 0) |
+  (ENABLE_WATCHDOG        ? FEATURE_WATCHDOG : 0) |
+  (ENABLE_MOTION_PROFILES ? FEATURE_MOTION_PROFILES : 0) |
+  (SERIAL_BINARY_AT_BOOT  ? FEATURE_BINARY_AT_BOOT : 0) |
+  (TELEMETRY_DELTA_AT_BOOT ? FEATURE_DELTA_AT_BOOT : 0) |
+  (ENABLE_SCOPE_MARKERS   ? FEATURE_SCOPE_MARKERS : 0) |
+  (ENABLE_DRIVE_ISR_LOOP  ? FEATURE_DRIVE_ISR_LOOP : 0);
+static HelloFrame g_hello;
+static bool g_hello_due = false;       // g_hello not staged on the main link yet
+static bool g_aux_hello_due = false;   // ... on the aux link
+
+// Telemetry task rate follows the link: the wire mode's rate (binary frames
+// are ~6x smaller), or the fastest group the host subscribed to
+static uint16_t g_tel_hz = 0;
+
+static void applyTelemetryRate(uint16_t hz) {
+  g_tel_hz = hz;
+  g_sched.setHz(g_task_telemetry, hz);
+}
+
+// Same for the aux link, which the Pi subscribes on its own
+static uint16_t g_aux_hz = 0;
+
+static void applyAuxRate(uint16_t hz) {
+  g_aux_hz = hz;
+  g_sched.setHz(g_task_aux, hz);
+}
+
+// The aux link takes the encoder batches and perf frames only while the Pi
+// is listening: some valid frame (its pings, at least) within
+// AUX_LINK_TIMEOUT_MS. Otherwise they stay on USB.
+static uint32_t g_aux_ok = 0;        // rxOk() last seen
+static uint32_t g_aux_seen_ms = 0;
+static bool g_aux_seen = false;
+
+static bool auxActive(uint32_t now_ms) {
+  return ENABLE_AUX_LINK && g_aux_seen && (now_ms - g_aux_seen_ms) <= AUX_LINK_TIMEOUT_MS;
+}
+
+// Live parameters into the modules that keep their own copy (the servo
+// ramps are read per move in commandServos)
+static void applyParams() {
+  const TuningParams& p = g_params.active();
+
+  g_drive.setGains(p.drive_kp, p.drive_ki, p.drive_kd, p.drive_integral_limit);
+  g_drive.setLimits(p.max_linear_ftps, p.max_angular_dps);
+  g_drive.setFeedForward(p.drive_ff_ks, p.drive_ff_kv);
+  g_drive.setSlew(p.drive_accel_ftps2, p.drive_decel_ftps2);
+  g_mech.setGains(p.arm_kp, p.arm_ki, p.arm_kd, p.arm_integral_limit);
+
+  for (DistanceSensor* s : SONARS) s->setValidRange(p.ultrasonic_min_in, p.ultrasonic_max_valid_in);
+  g_sched.setHz(g_task_ultrasonic, (uint16_t)(p.ultrasonic_hz * g_sonar.slotCount()));
+  g_sched.setHz(g_task_sequence, p.sequencer_hz);
+
+  g_sched.setIdle(p.idle_sleep ? PowerSaver::idleUntil : nullptr);
+}
+
+
+// New servo targets (either may be absent), at the tunable ramp speeds
+static void commandServos(bool lid, float lid_deg, bool sweep, float sweep_deg, uint32_t now_ms) {
+  const TuningParams& p = g_params.active();
+  g_servos.command(lid, lid_deg, sweep, sweep_deg, p.lid_ramp_dps, p.sweep_ramp_dps, now_ms);
+}
+
+void SeqIo::seqServo(SeqOp op, int16_t ddeg, uint32_t now_ms) {
+  const float deg = (float)ddeg * 0.1f;
+  commandServos(op == SeqOp::LID, deg, op == SeqOp::SWEEP, deg, now_ms);
+}
+
+bool SeqIo::seqServosSettled() {
+  return g_servos.settled();
+}
+
+void SeqIo::seqDrive(float linear_ftps, float angular_dps) {
+  DriveCommand cmd;
+  cmd.linear_ftps = linear_ftps;
+  cmd.angular_dps = angular_dps;
+  g_drive.setCommand(cmd);
+}
 
-// Servos
-ServoActuator g_lid_servo(
-  PIN_SERVO_LID,
-  SERVO_MIN_DEG,
-  SERVO_MAX_DEG,
-  LID_SERVO_RAMP_DPS,
-  SERVO_DEADBAND_DEG,
-  LID_SERVO_SETTLE_MS,
-  LID_SERVO_AUTO_DETACH_ON_CLOSED,
-  (float)LID_CLOSED_DEG
-);
-
-ServoActuator g_sweep_servo(
-  PIN_SERVO_SWEEP,
-  SERVO_MIN_DEG,
-  SERVO_MAX_DEG,
-  SWEEP_SERVO_RAMP_DPS,
-  SERVO_DEADBAND_DEG,
-  SWEEP_SERVO_SETTLE_MS,        // settle_ms (or define SWEEP_SERVO_SETTLE_MS)
-  SWEEP_SERVO_AUTO_DETACH_ON_CLOSED,      // auto_detach_on_closed (usually false for sweep)
-  (float)SWEEP_STOW_DEG
-);
-
-// Rates
-Rate g_comms_rate(RxCOMM_UPDATE_HZ);                    // RX parsing tick (fast, non-blocking)
-Rate g_telemetry_rate(TELEMETRY_UPDATE_HZ);
-Rate g_ultrasonic_rate(ULTRASONIC_UPDATE_HZ);
-Rate g_servo_rate(SERVO_UPDATE_HZ);
-
-// Track last applied command seq so we only apply new targets once
-static uint32_t g_last_applied_seq = 0;
-static bool g_in_timeout = false;
+float SeqIo::seqTravelFt() {
+  const float revs = 0.5f * (g_left_drive_enc.getState().revolutions +
+                             g_right_drive_enc.getState().revolutions);
+  return revs * WHEEL_CIRCUMFERENCE_FT;
+}
 
 
 /*=============================================================================
-  SETUP
+  MOTOR CHARACTERIZATION (SysId)
 =============================================================================*/
 
-void setup() {
-  // Serial Comms Setup
-  SERIAL_USB.begin(SERIAL_BAUD);
-  g_link.begin();
+// Test results as "a/b" (left/right) at `scale`, "-" if not measured
+static void formatPair(char* out, size_t n, float l, float r, float scale) {
+  char a[8] = "-", b[8] = "-";
+  if (isfinite(l)) snprintf(a, sizeof(a), "%ld", lroundf(l * scale));
+  if (isfinite(r)) snprintf(b, sizeof(b), "%ld", lroundf(r * scale));
+  snprintf(out, n, "%s/%s", a, b);
+}
 
-  // Ultrasonic Sensor Setup
-  g_distance_sensor.begin();
+// The pair a run drives: 0 = left / LHS, 1 = right / RHS
+static DcMotorActuator& sysIdMotor(uint8_t i) {
+  if (g_sysid.target() == SysId::Target::ARM) return i ? g_rhs_arm_motor : g_lhs_arm_motor;
+  return i ? g_right_drive_motor : g_left_drive_motor;
+}
 
-  // Servo Setups
-  g_lid_servo.begin((float)LID_CLOSED_DEG);
-  g_sweep_servo.begin((float)SWEEP_STOW_DEG);
+static const EncoderSensor& sysIdEncoder(uint8_t i) {
+  if (g_sysid.target() == SysId::Target::ARM) return i ? g_rhs_arm_enc : g_lhs_arm_enc;
+  return i ? g_right_drive_enc : g_left_drive_enc;
+}
+
+static void abortSysId() {
+  if (!g_sysid.running()) return;
+  g_sysid.abort();
+  sysIdMotor(0).coast();
+  sysIdMotor(1).coast();
+}
 
+// Drive tick while a run owns its pair (the controllers were stopped)
+static void tickSysId(uint32_t now_ms) {
+  if (g_sysid.target() == SysId::Target::ARM &&
+      fmaxf(g_lhs_arm_enc.getState().degrees, g_rhs_arm_enc.getState().degrees) > ARM_MAX_DEG - SYSID_ARM_MARGIN_DEG) {
+    abortSysId();
+    return;
+  }
+
+  const float duty = g_sysid.tick(now_ms, sysIdEncoder(0).getState().count, sysIdEncoder(1).getState().count);
+  for (uint8_t i = 0; i < 2; i++) {
+    if (g_sysid.running()) sysIdMotor(i).setDuty(duty);
+    else sysIdMotor(i).coast();
+  }
+}
+
+// Stages one tuning value as a host "set" would. 1 = taken.
+static uint8_t seedParam(const char* name, float value) {
+  ParamRequest req;
+  req.op = ParamOp::SET;
+  strncpy(req.name, name, sizeof(req.name) - 1);
+  req.value = value;
+  ParamReply reply;
+  g_params.handle(req, reply);
+  return (reply.status == ParamStatus::OK) ? 1 : 0;
 }
 
+// Lambda tuning from the mean of the motors' fits (Params.h, SYSID_*_LAMBDA_S);
+// the host saves them once it is happy. Returns how many were staged.
+static uint8_t seedFromSysId() {
+  const SysId::Result& r = g_sysid.result();
+  float gain = 0.0f, tau = 0.0f, kv = 0.0f, ks = 0.0f;
+  uint8_t n = 0;
+  for (uint8_t i = 0; i < 2; i++) {
+    if (!isfinite(r.fit[i].gain)) continue;
+    gain += r.fit[i].gain;
+    tau += r.fit[i].tau_s;
+    kv += r.fit[i].kv;
+    ks += r.fit[i].ks;
+    n++;
+  }
+  if (n == 0) return 0;
+  gain /= n; tau /= n; kv /= n; ks /= n;
+
+  uint8_t seeded = 0;
+  if (r.target == SysId::Target::DRIVE) {
+    const float k_lambda = gain * SYSID_DRIVE_LAMBDA_S;
+    if (PWM_MIN == 0) seeded += seedParam("DRIVE_FF_KS", ks);   // else pwm_min covers it
+    seeded += seedParam("DRIVE_FF_KV", kv);
+    seeded += seedParam("DRIVE_KP", tau / k_lambda);
+    seeded += seedParam("DRIVE_KI", 1.0f / k_lambda);
+  } else {
+    const float kp = (float)PWM_MAX / (gain * SYSID_ARM_LAMBDA_S);
+    seeded += seedParam("ARM_KP", kp);
+    seeded += seedParam("ARM_KD", kp * tau);
+  }
+  return seeded;
+}
+
+static void noteSysId(uint32_t now_ms) {
+  const SysId::Result& r = g_sysid.result();
+  const char* what = (r.target == SysId::Target::ARM) ? "arm" : "drive";
+  char buf[96];
+  if (r.phase != SysId::Phase::DONE) {
+    snprintf(buf, sizeof(buf), "SYSID %s aborted (%u samples)", what, (unsigned)g_sysid.captured());
+    g_link.postNote(now_ms, buf);
+    return;
+  }
+
+  const uint8_t seeded = seedFromSysId();
+  char k[18], tau[18], ks[18], kv[18];
+  formatPair(k, sizeof(k), r.fit[0].gain, r.fit[1].gain, 100.0f);
+  formatPair(tau, sizeof(tau), r.fit[0].tau_s, r.fit[1].tau_s, 1000.0f);
+  formatPair(ks, sizeof(ks), r.fit[0].ks, r.fit[1].ks, 1000.0f);
+  formatPair(kv, sizeof(kv), r.fit[0].kv, r.fit[1].kv, 10000.0f);
+  snprintf(buf, sizeof(buf), "SYSID %s K=%s (0.01) tau=%s ms ks=%s (1e-3) kv=%s (1e-4) seeded %u",
+           what, k, tau, ks, kv, (unsigned)seeded);
+  g_link.postNote(now_ms, buf);
+}
+
+
 /*=============================================================================
-  LOOP
+  PATH FOLLOWING (PathFollower)
 =============================================================================*/
 
-void loop() {
+// Ends a running path and zeroes the drive command it was steering
+static void abortPath(uint32_t now_ms) {
+  if (!g_path.running()) return;
+  g_path.abort(now_ms);
+  g_drive.setCommand(DriveCommand());
+}
 
-  const uint32_t now_ms = millis();
+// One note per path end (the start has the link's PATH note)
+static void notePath(uint32_t now_ms) {
+  if (g_path.running()) return;
+
+  char buf[56];
+  snprintf(buf, sizeof(buf), "PATH %s seg=%u/%u left=%ld (0.01 ft)",
+           (g_path.state() == PathFollower::State::DONE) ? "done" : "aborted",
+           (unsigned)g_path.segment(), (unsigned)g_path.segments(),
+           lroundf(g_path.remainingFt() * 100.0f));
+  g_link.postNote(now_ms, buf);
+}
+
+
+/*=============================================================================
+  WATCHDOG STOP TABLE
+=============================================================================*/
+
+// Host quiet for WATCHDOG_DRIVE_TIMEOUT_MS: the drive (and any sequence or
+// path driving it) stops
+static void onDriveStale(uint32_t now_ms) {
+  abortSysId();
+  g_sequencer.abort(now_ms);
+  abortPath(now_ms);
+  g_link.clearCommandQueue();
+  g_drive.stop();
+}
+
+static void onArmStale(uint32_t) {
+  abortSysId();
+  g_mech.stop();
+}
+
+// Link lost for COMMAND_TIMEOUT_MS: park the servos too
+static void onLinkStale(uint32_t now_ms) {
+  g_link.clearCommandQueue();
+  commandServos(true, (float)LID_CLOSED_DEG, true, (float)SWEEP_STOW_DEG, now_ms);
+}
+
+// Drive task stopped running: cut the motors; the hardware WDT resets next
+static void onControlStale(uint32_t) {
+  g_drive.stop();
+  g_mech.stop();
+}
+
+static const Watchdog::Channel WATCHDOG_TABLE[WD_CHANNELS] PROGMEM = {
+  {WATCHDOG_DRIVE_TIMEOUT_MS,     onDriveStale,   false},   // WD_DRIVE
+  {WATCHDOG_ARM_TIMEOUT_MS,       onArmStale,     false},   // WD_ARM
+  {(uint16_t)COMMAND_TIMEOUT_MS,  onLinkStale,    false},   // WD_LINK
+  {WATCHDOG_CONTROL_TIMEOUT_MS,   onControlStale, true},    // WD_CONTROL
+};
+
+static_assert(COMMAND_TIMEOUT_MS <= 0xFFFF, "COMMAND_TIMEOUT_MS must fit a watchdog channel");
+static_assert(WD_CHANNELS <= Watchdog::MAX_CHANNELS, "raise WATCHDOG_MAX_CHANNELS");
+
+static void noteResetCause(uint32_t now_ms) {
+  char buf[56];
+  snprintf(buf, sizeof(buf), "RESET %s flags=0x%02X params=%s",
+           Watchdog::causeName(g_watchdog.resetCause()), (unsigned)g_watchdog.resetFlags(),
+           ParamStore::sourceName(g_params.source()));
+  g_link.postNote(now_ms, buf);
+}
+
+
+/*=============================================================================
+  TASKS
+=============================================================================*/
+
+// RX tick: read serial and parse command frames
+static void taskRx(uint32_t now_ms) {
+  ScopeSpan mark(ScopeMark::RX);
+  g_link.RxTick(now_ms);
+
+  if (ENABLE_AUX_LINK) {
+    auxLink().RxTick(now_ms);
+    if (auxLink().rxOk() != g_aux_ok) {
+      g_aux_ok = auxLink().rxOk();
+      g_aux_seen_ms = now_ms;
+      g_aux_seen = true;
+    }
+  }
 
-  // RX tick: read serial and parse command frames
-  if (g_comms_rate.ready(now_ms)) {
-    g_link.RxTick(now_ms);
+  // Any command (even a repeated seq) shows the host is alive
+  const uint32_t cmd_ms = g_link.lastCommandMs();
+  if (cmd_ms != g_fed_cmd_ms) {
+    g_fed_cmd_ms = cmd_ms;
+    g_watchdog.feed(WD_DRIVE, now_ms);
+    g_watchdog.feed(WD_ARM, now_ms);
+    g_watchdog.feed(WD_LINK, now_ms);
 
-    // Apply servo targets only when a new command arrives and return to closed, if commands time out
-    if (g_link.hasCommand()) {
-      const CommandFrame& cmd = g_link.latestCommand();
-      if (cmd.seq != g_last_applied_seq) {
-        g_last_applied_seq = cmd.seq;
+    // The boot note may have gone out before anyone was listening
+    if (!g_host_seen) {
+      g_host_seen = true;
+      noteResetCause(now_ms);
+    }
+  }
 
-        if (cmd.mech.servo_LID_present) {
-          g_lid_servo.setTargetDeg(cmd.mech.servo_LID_deg, now_ms);
-        }
+  // Sequence requests start (or stop) right away, not on the next seq tick
+  if (const SequenceRequest* req = g_link.pendingSequence()) {
+    if (req->action == SeqAction::ABORT) g_sequencer.abort(now_ms);
+    else { g_drive.abortStepTest(); abortSysId(); abortPath(now_ms); g_sequencer.start(*req, now_ms); }
+    g_link.clearPendingSequence();
+  }
 
-        if (cmd.mech.servo_SWEEP_present) {
-          g_sweep_servo.setTargetDeg(cmd.mech.servo_SWEEP_deg, now_ms);
-        }
+  // Paths too; the drive task follows them from its next tick. A refused
+  // one leaves whatever was running alone.
+  if (const PathRequest* req = g_link.pendingPath()) {
+    if (req->action == PathAction::ABORT) {
+      abortPath(now_ms);
+    } else if (g_path.start(*req, g_odom.pose(), now_ms)) {
+      g_drive.abortStepTest();
+      abortSysId();
+      g_sequencer.abort(now_ms);
+    } else {
+      g_link.postNote(now_ms, "PATH refused");
+    }
+    g_link.clearPendingPath();
+  }
 
+  // Test modes own the motors, so not while a sequence is driving them
+  if (const TestRequest* req = g_link.pendingTest()) {
+    if (req->op == TestOp::ABORT) {
+      g_drive.abortStepTest();
+      abortSysId();
+    } else if (g_sequencer.running()) {
+      g_link.postNote(now_ms, "TEST refused (sequence running)");
+    } else if (g_path.running()) {
+      g_link.postNote(now_ms, "TEST refused (path running)");
+    } else if (g_drive.stepTestRunning() || g_sysid.running()) {
+      g_link.postNote(now_ms, "TEST refused (already running)");
+    } else if (req->op == TestOp::DRIVE_STEP) {
+      logEvent(now_ms, EventId::TEST_START, (int16_t)req->op, eventArgScaled(req->value, 1000.0f));
+      const float duty = (isfinite(req->value) && req->value > 0.0f) ? req->value : DRIVE_STEP_DUTY;
+      g_drive.startStepTest(duty, now_ms);
+    } else {
+      // The run owns its pair: both controllers let go first
+      g_drive.stop();
+      g_mech.stop();
+      logEvent(now_ms, EventId::TEST_START, (int16_t)req->op, eventArgScaled(req->value, 1000.0f));
+      if (g_sysid.start((req->op == TestOp::SYSID_ARM) ? SysId::Target::ARM : SysId::Target::DRIVE,
+                        req->value, now_ms)) {
+        g_sysid_tx = 0;
       }
     }
+    g_link.clearPendingTest();
+  }
+
+  // Event log: a dump covers the ring as it is now (streamed from taskBackground)
+  if (const LogRequest* req = g_link.pendingLog()) {
+    if (req->op == LogOp::CLEAR) {
+      g_event_log.clear();
+    } else if (g_link.wireMode() != WireMode::BINARY) {
+      g_link.postNote(now_ms, "LOG dump: binary mode only");
+    } else {
+      g_log_tx = g_event_log.oldest();
+      g_log_end = g_event_log.written();
+      g_log_dumping = true;
+      g_log_rate.restart();
+    }
+    g_link.clearPendingLog();
+  }
+
+  // A new pose moves the frame a running path was given in: it ends there
+  if (const PoseReset* pose = g_link.pendingPose()) {
+    abortPath(now_ms);
+    g_odom.reset(*pose);
+    g_link.clearPendingPose();
+  }
+
+  // Parameter requests only touch the staged copy; the drive task makes
+  // them live. A reply the link didn't stage goes out again next tick, and
+  // the next request waits in the link until it has (a staged reply can't
+  // be displaced, so it's done once sendParam() returns true).
+  const ParamRequest* req = g_param_reply_due ? nullptr : g_link.pendingParam();
+  if (req) {
+    g_params.handle(*req, g_param_reply);
+    g_param_reply_due = true;
+    g_link.clearPendingParam();
+  }
+  if (g_param_reply_due && g_link.sendParam(g_param_reply)) {
+    g_param_reply_due = false;
+  }
+
+  // Hellos the link couldn't stage go again; once staged they can't be
+  // displaced. A "link" hello still due by the time the "ready" one is
+  // built is superseded by it (same fields, plus the timing).
+  if (g_hello_due && g_link.sendHello(g_hello)) {
+    g_hello_due = false;
+  }
+  if (ENABLE_AUX_LINK && g_aux_hello_due && auxLink().sendHello(g_hello)) {
+    g_aux_hello_due = false;
+  }
+
+  // Apply each new command once: untimed ones as they arrive, timed ones
+  // when their at_ms comes up (a running sequence, path or sysid run owns
+  // the targets; its commands still count as seen)
+  CommandFrame cmd;
+  while (g_link.takeCommand(now_ms, cmd)) {
+    if (g_sequencer.running() || g_path.running() || g_sysid.running()) continue;
+
+    const int32_t late_ms = cmd.at_present ? (int32_t)(now_ms - cmd.at_ms) : 0;
+    logEvent(now_ms, EventId::CMD_APPLIED, (int16_t)cmd.seq, eventArg(late_ms));
+    g_drive.setCommand(cmd.drive);
+    g_mech.setCommand(cmd.mech, now_ms);
+
+    commandServos(cmd.mech.servo_LID_present, cmd.mech.servo_LID_deg,
+                  cmd.mech.servo_SWEEP_present, cmd.mech.servo_SWEEP_deg, now_ms);
+  }
+}
+
+// Every loop: command timeout safety + cheap sensor polling
+static void taskBackground(uint32_t now_ms) {
+  // Liveness deadlines (runs a stop action only when one passes) + WDT kick
+  g_watchdog.check(now_ms);
+
+  // Distance Sensors: publish a finished echo as soon as it lands
+  g_sonar.poll(now_ms);
+
+  // Telemetry rate follows the link mode / subscription
+  if (g_link.publishHz() != g_tel_hz) {
+    applyTelemetryRate(g_link.publishHz());
+  }
+  if (ENABLE_AUX_LINK && auxLink().publishHz() != g_aux_hz) {
+    applyAuxRate(auxLink().publishHz());
+  }
+
+  // Parameter save: at most one EEPROM byte per pass
+  if (g_params.service()) {
+    char buf[40];
+    snprintf(buf, sizeof(buf), "PARAMS saved (%u bytes written)", (unsigned)g_params.lastSaveWrites());
+    g_link.postNote(now_ms, buf);
+  }
+
+  // Sysid capture: a chunk per SYSID_STREAM_HZ release, when the stage is
+  // free; whole chunks while the run goes, the rest once it's over. The
+  // cursor moves once the link staged the chunk: telemetry can't displace
+  // it from there, so it reaches the host whole.
+  const uint16_t sysid_waiting = g_sysid.captured() - g_sysid_tx;
+  if (sysid_waiting > 0 && (!g_sysid.running() || sysid_waiting >= SYSID_CHUNK_SAMPLES) &&
+      !g_link.txPending() && g_sysid_rate.ready(now_ms)) {
+    SysIdChunk c;
+    if (g_sysid.chunk(g_sysid_tx, c) && g_link.sendSysId(c)) g_sysid_tx = c.first + c.count;
+  }
+
+  // Event log dump: a chunk per EVENT_LOG_DUMP_HZ release, when the stage
+  // is free. An empty chunk at the end closes a dump that ran out early
+  // (records overwritten, or a clear). The cursor moves once the link
+  // staged the chunk: telemetry can't displace it from there. Records
+  // overwritten mid-dump show on the host as a gap in the chunks' first.
+  if (g_log_dumping && !g_link.txPending() && g_log_rate.ready(now_ms)) {
+    EventLogChunk c;
+    if (!g_event_log.chunk(g_log_tx, g_log_end, c)) {
+      c = EventLogChunk();
+      c.first = c.end = g_log_end;
+    }
+    if (g_link.sendEventLog(c)) {
+      g_log_tx = (uint16_t)(c.first + c.count);
+      g_log_dumping = (g_log_tx != g_log_end);
+    }
+  }
+
+  // Stack high-water mark: one scan chunk per pass
+  g_stack.service();
+}
+
+static void noteStepTest(uint32_t now_ms) {
+  const DriveController::StepTest& t = g_drive.stepTest();
+  if (t.phase != DriveController::StepTest::Phase::DONE) {
+    g_link.postNote(now_ms, "STEP aborted");
+    return;
+  }
+
+  char ks[18], kv[18], tau[18], vss[18];
+  formatPair(ks, sizeof(ks), t.left.ks, t.right.ks, 1000.0f);
+  formatPair(kv, sizeof(kv), t.left.kv, t.right.kv, 1000.0f);
+  formatPair(tau, sizeof(tau), t.left.tau_s, t.right.tau_s, 1000.0f);
+  formatPair(vss, sizeof(vss), t.left.v_ss, t.right.v_ss, 100.0f);
+
+  char buf[96];
+  snprintf(buf, sizeof(buf), "STEP ks=%s kv=%s (1e-3) tau=%s ms vss=%s (0.01 ft/s)", ks, kv, tau, vss);
+  g_link.postNote(now_ms, buf);
+}
+
+// Drive Tick: new parameters -> obstacle cap -> path command -> encoders
+// (one snapshot) -> wheel PIDs -> motors, then the same for the arms (a
+// sysid run replaces both loops)
+static void taskDrive(uint32_t now_ms) {
+  ScopeSpan mark(ScopeMark::DRIVE);
+  if (g_params.applyPending()) applyParams();
+
+  const bool was_stopped = g_obstacle.stopActive();
+  g_obstacle.update(FRONT_RANGES, FRONT_RANGE_COUNT);
+  g_drive.setForwardLimit(g_obstacle.forwardLimitFtps());
+
+  if (g_obstacle.stopActive() != was_stopped) {
+    const ObstacleGuard::State& os = g_obstacle.getState();
+    const int16_t nearest = eventArgScaled(os.nearest_in, 10.0f, -1);
+    if (os.stop) logEvent(now_ms, EventId::OBSTACLE_STOP, nearest, eventArgScaled(os.ttc_s, 1000.0f, INT16_MAX));
+    else         logEvent(now_ms, EventId::OBSTACLE_CLEAR, nearest);
+
+    char buf[40];
+    if (os.stop) snprintf(buf, sizeof(buf), "OBSTACLE STOP %d in", (int)lroundf(os.nearest_in));
+    else         snprintf(buf, sizeof(buf), "OBSTACLE CLEAR");
+    g_link.postNote(now_ms, buf);
+  }
+
+  if (g_path.running()) g_drive.setCommand(g_path.tick(g_odom.pose(), now_ms));
+  if (g_path.stateGen() != g_path_sent_gen) {
+    g_path_sent_gen = g_path.stateGen();
+    notePath(now_ms);
+  }
+
+  g_encoders.sample(now_ms);
+  if (g_sysid.running()) tickSysId(now_ms);
+  else g_drive.tick(now_ms);
+  if (ENABLE_DRIVE_ISR_LOOP && g_drive_isr.staleTrips() != g_drive_isr_sent_trips) {
+    g_drive_isr_sent_trips = g_drive_isr.staleTrips();
+    logEvent(now_ms, EventId::DRIVE_ISR_STALE, (int16_t)g_drive_isr_sent_trips);
+  }
+  if (g_drive.stepTest().gen != g_step_sent_gen) {
+    g_step_sent_gen = g_drive.stepTest().gen;
+    noteStepTest(now_ms);
+  }
+  if (g_sysid.result().gen != g_sysid_sent_gen) {
+    g_sysid_sent_gen = g_sysid.result().gen;
+    noteSysId(now_ms);
+  }
+  if (!ENABLE_ENCODER_SAMPLER) {
+    g_odom.integrate(g_left_drive_enc.getState().count, g_right_drive_enc.getState().count);
+  }
+  if (!g_sysid.running()) g_mech.tick(now_ms);
+  g_watchdog.feed(WD_CONTROL, now_ms);
+}
 
+// Distance Sensor Tick: fire the next slot's pings
+static void taskUltrasonic(uint32_t now_ms) {
+  ScopeSpan mark(ScopeMark::ULTRASONIC);
+  g_sonar.tick(now_ms, ULTRASONIC_AIR_TEMP_C);
+}
+
+// Servo Tick: follow the coordinated move (if any), then ramp/settle. The
+// drive running can knock a released servo off its target: hold it then.
+static void taskServo(uint32_t now_ms) {
+  ScopeSpan mark(ScopeMark::SERVO);
+  if (g_drive.getState().active) g_servos.disturb(now_ms);
+  g_servos.tick(now_ms);
+}
+
+// Sequence Tick: advance the running sequence, report progress on change.
+// A status the link didn't stage is sent again next tick; one it staged
+// can't be displaced by telemetry, so it's marked sent.
+static void taskSequence(uint32_t now_ms) {
+  g_sequencer.tick(now_ms);
+
+  const uint8_t gen = g_sequencer.statusGen();
+  if (gen != g_seq_sent_gen && g_link.sendSequence(g_sequencer.status())) {
+    g_seq_sent_gen = gen;
   }
+}
+
+// One telemetry frame; the host clock is the one the receiving link synced
+static void fillTelemetry(TelemetryFrame& t, const TimeSync& sync, uint32_t now_ms) {
+  t.arduino_time_ms = now_ms;
+  t.ack_seq = g_link.ackSeq();     // ACK = last received + parsed command seq
+  t.queue_depth = g_link.commandQueue().depth();
+  t.queue_free = g_link.commandQueue().free();
+
+  // Same instant on the host clock, once ping exchanges have converged
+  t.host_time_valid = sync.synced();
+  if (t.host_time_valid) t.host_time_us = sync.toHostUs(micros());
 
-  // Check if telemetry commands have timed out and apply safety logic if timed out
-  const bool timed_out = g_link.commandTimedOut(now_ms);
-  if (timed_out && !g_in_timeout) {
-    g_in_timeout = true;
-    g_lid_servo.setTargetDeg((float)LID_CLOSED_DEG, now_ms);
-    g_sweep_servo.setTargetDeg((float)SWEEP_STOW_DEG, now_ms);
-  } else if (!timed_out) {
-    g_in_timeout = false;
+  // Measured wheel speed (encoder)
+  const DriveController::State& drive_state = g_drive.getState();
+  t.wheel.left_rpm  = drive_state.left.rpm;
+  t.wheel.right_rpm = drive_state.right.rpm;
+  t.pose = g_odom.pose();
+
+
+  //t.mech       
+  t.mech.servo_LID_deg   = g_lid_servo.getState().currentDeg();
+  t.mech.servo_SWEEP_deg = g_sweep_servo.getState().currentDeg();
+
+  // Live arm joint angles (encoder)
+  const MechanismController::State& mech_state = g_mech.getState();
+  t.mech.motor_LHS_deg = mech_state.lhs.angle_deg;
+  t.mech.motor_RHS_deg = mech_state.rhs.angle_deg;
+
+
+  // Add ultrasonic data (filtered on board; see RangeFilter)
+  const auto& ultrasonic_state = g_distance_sensor.getState();
+  t.ultrasonic.valid = ultrasonic_state.filtered_valid;
+  t.ultrasonic.confidence = ultrasonic_state.confidence;
+  if (t.ultrasonic.valid) {
+    t.ultrasonic.distance_in = ultrasonic_state.filtered_in;
+    t.ultrasonic.closing_inps = ultrasonic_state.closing_inps;
+  } else {
+    t.ultrasonic.distance_in = NAN;
+    t.ultrasonic.closing_inps = NAN;
   }
+  t.ultrasonic.obstacle_stop = g_obstacle.stopActive();
+  if (g_sonar.count() > 1) t.sonar = &g_sonar.readings();
+}
+
+// Encoder samples since the last frame; only removed once they're sent
+static void publishWithEncoders(SerialLink& link, TelemetryFrame& t, uint32_t now_ms) {
+  const uint8_t n = g_enc_sampler.peek(g_enc_batch);
+  t.encoders = &g_enc_batch;
 
+  if (link.publish(t, now_ms)) g_enc_sampler.consume(n);
+}
+
+// TX tick: publish telemetry so Python/GUI can confirm link health
+static void taskTelemetry(uint32_t now_ms) {
+  ScopeSpan mark(ScopeMark::TELEMETRY);
+  TelemetryFrame t;
+  fillTelemetry(t, g_link.timeSync(), now_ms);
 
+  // Optional note
+  t.note = g_link.debugNote(now_ms);
 
-  // Distance Sensor Tick: Read Ultrasonic Sensor Data
-  if (g_ultrasonic_rate.ready(now_ms)) {
-    g_distance_sensor.tick(now_ms);
+  // ack_seq and queue_free keep flowing here; the aux link has the samples
+  if (auxActive(now_ms)) g_link.publish(t, now_ms);
+  else                   publishWithEncoders(g_link, t, now_ms);
+
+  // Time to first telemetry: the "ready" hello goes out from taskRx
+  if (g_hello.stage == BootStage::LINK && g_link.telSeq() != 0) {
+    g_hello.stage = BootStage::READY;
+    g_hello.arduino_time_ms = now_ms;
+    g_hello.first_tel_us = micros();
+    g_hello_due = true;
   }
+}
+
+// Aux TX tick: the Pi's telemetry, at the rate it subscribed (no notes)
+static void taskAuxTelemetry(uint32_t now_ms) {
+  ScopeSpan mark(ScopeMark::TELEMETRY);
+  if (!ENABLE_AUX_LINK || !auxActive(now_ms)) return;
+
+  TelemetryFrame t;
+  fillTelemetry(t, auxLink().timeSync(), now_ms);
+  publishWithEncoders(auxLink(), t, now_ms);
+}
+
 
+// Perf report: one Profiler window per frame, then start a new window
+static void taskPerf(uint32_t now_ms) {
+  // g_perf is still streaming out (a JSON perf line is longer than the TX
+  // stage): this window runs on until the next report
+  if (g_link.perfPending() || (ENABLE_AUX_LINK && auxLink().perfPending())) return;
 
-  // Servo Tick
-  if (g_servo_rate.ready(now_ms)) {
-    g_lid_servo.tick(now_ms);
-    g_sweep_servo.tick(now_ms);
+  g_perf.arduino_time_ms = now_ms;
+  g_perf.window_ms = now_ms - g_profiler.windowStartMs();
+
+  const Profiler::LoopStats& loop = g_profiler.loop();
+  g_perf.loop.count = loop.count;
+  g_perf.loop.min_us = loop.count ? loop.min_us : 0;
+  g_perf.loop.max_us = loop.max_us;
+  g_perf.loop.mean_us = loop.meanUs();
+  g_perf.loop.jitter_us = loop.jitterUs();
+  const uint32_t idle_pm = g_perf.window_ms ? loop.idle_us / g_perf.window_ms : 0;   // us per ms
+  g_perf.loop.idle_permille = (uint16_t)((idle_pm < 1000) ? idle_pm : 1000);
+
+  g_perf.mem.static_bytes = StackMonitor::staticBytes();
+  g_perf.mem.stack_peak = g_stack.stackPeakBytes();
+  g_perf.mem.free_min = g_stack.freeMinBytes();
+  g_perf.mem.free_now = StackMonitor::freeNowBytes();
+
+  const ServoPair<LidServo, SweepServo>::Stats& servo = g_servos.stats();
+  g_perf.servo.attached = servo.attached;
+  g_perf.servo.active_permille = servo.activePermille();
+  g_perf.servo.isr_ppm = servo.isrPpm();
+  g_perf.servo.detaches = servo.detaches;
+  g_servos.resetWindow();
+
+  const uint8_t n = (g_sched.count() < PERF_MAX_TASKS) ? g_sched.count() : PERF_MAX_TASKS;
+  g_perf.task_count = n;
+  for (uint8_t id = 0; id < n; id++) {
+    const Profiler::Slot& slot = g_profiler.slot(id);
+    TaskPerf& tp = g_perf.tasks[id];
+    tp.name = g_sched.name(id);
+    tp.runs = slot.count;
+    tp.overruns = g_sched.stats(id)->overruns;
+    tp.min_us = slot.count ? slot.min_us : 0;
+    tp.max_us = slot.max_us;
+    tp.mean_us = slot.meanUs();
+    tp.p99_us = slot.p99Us();
   }
 
+  // Perf to the Pi while it listens; the USB link still reports its own quality
+  if (ENABLE_AUX_LINK && auxActive(now_ms)) {
+    auxLink().sendPerf(g_perf);
+    g_link.requestLinkStats();
+  } else {
+    g_link.sendPerf(g_perf);
+  }
+  g_profiler.reset();
+}
 
-  // TX tick: publish telemetry so Python/GUI can confirm link health
-  if (g_telemetry_rate.ready(now_ms)) {
-    TelemetryFrame t;
-    t.arduino_time_ms = now_ms;
-    t.ack_seq = g_link.ackSeq();     // ACK = last received + parsed command seq
 
-    // For bring-up, these stay as null (NAN encodes to JSON null in Protocol.cpp)
-    t.wheel.left_rpm  = 0.0;
-    t.wheel.right_rpm = 0.0;
+/*=============================================================================
+  SETUP
+=============================================================================*/
+
+// Staged: the links and their hello first (the host waits for it instead
+// of a fixed bootloader delay), then tuning, actuators, sensors and tasks
+void setup() {
+  const uint32_t setup_start_us = micros();
 
+  scopeMarkersBegin();
 
-    //t.mech       
-    t.mech.servo_LID_deg   = g_lid_servo.getState().current_deg;
-    t.mech.servo_SWEEP_deg = g_sweep_servo.getState().current_deg;
+  // Unused peripherals off, Timer0 ready for idle wake-up alarms
+  PowerSaver::begin();
 
+  // Serial Comms Setup
+  SERIAL_USB.begin(SERIAL_BAUD);
+  g_link.begin();
 
-    // Add ultrasonic data
-    const auto& ultrasonic_state = g_distance_sensor.getState();
-    t.ultrasonic.valid = ultrasonic_state.valid;
-    if(ultrasonic_state.valid == true){
-      t.ultrasonic.distance_in = ultrasonic_state.distance_in;
-      
+  if (ENABLE_AUX_LINK) {
+    SERIAL_AUX.begin(AUX_SERIAL_BAUD);
+    auxLink().setCommandInput(false);
+    auxLink().begin();
+  } else if (ENABLE_RX_CAPTURE) {
+    SERIAL_AUX.begin(AUX_SERIAL_BAUD);
+  }
+
+  g_hello.fw_version = FIRMWARE_VERSION;
+  g_hello.features = BUILD_FEATURES;
+  g_hello.reset_flags = g_reset_flags;
+  g_hello.build = __DATE__ " " __TIME__;
+  g_hello.arduino_time_ms = millis();
+  g_hello.link_us = micros();
+  g_hello_due = !g_link.sendHello(g_hello);
+  g_aux_hello_due = ENABLE_AUX_LINK && !auxLink().sendHello(g_hello);
+  logEvent(millis(), EventId::BOOT, g_reset_flags, FIRMWARE_VERSION);
+
+  // Tuning (EEPROM image or Params.h defaults), pushed out once the tasks exist
+  g_params.begin();
+
+  // Drive base Setup (encoders + motors, motors coast); with the inner loop
+  // the sampler ticks at its rate and queues at ENCODER_SAMPLE_HZ
+  if (ENABLE_DRIVE_ISR_LOOP) g_drive.setInnerLoop(&g_drive_isr);
+  g_drive.begin();
+  if (ENABLE_ENCODER_SAMPLER) {
+    g_enc_sampler.setOdometry(&g_odom);
+    if (ENABLE_DRIVE_ISR_LOOP) {
+      g_enc_sampler.setControlLoop(&g_drive_isr);
+      g_enc_sampler.begin(DRIVE_ISR_HZ, (uint8_t)(DRIVE_ISR_HZ / ENCODER_SAMPLE_HZ));
     } else {
-      t.ultrasonic.distance_in = NAN;
+      g_enc_sampler.begin(ENCODER_SAMPLE_HZ);
     }
-    
+  }
 
-    // Optional note
-    t.note = g_link.debugNote(now_ms);
+  // Arm Setup (encoders zeroed at the stowed pose, motors coast)
+  g_mech.begin();
 
+  // Ultrasonic Sensor Setup
+  g_sonar.begin();
 
+  // The hello is longer than the TX ring: move the rest, and take any
+  // link / subscribe frame the host sent on seeing it
+  g_link.tick(millis());
 
+  // Servo Setups
+  g_lid_servo.begin((float)LID_CLOSED_DEG);
+  g_sweep_servo.begin((float)SWEEP_STOW_DEG);
+
+  // Task table
+  g_sched.add(taskDrive,      Scheduler::hzToUs(DRIVE_UPDATE_HZ),      DRIVE_PHASE_US,      TASK_PRIO_DRIVE,      F("drive"));
+  g_sched.add(taskRx,         Scheduler::hzToUs(RxCOMM_UPDATE_HZ),     0,                   TASK_PRIO_RX,         F("rx"));
+  g_sched.add(taskBackground, 0,                                       0,                   TASK_PRIO_SAFETY,     F("bg"));
+  g_sched.add(taskServo,      Scheduler::hzToUs(SERVO_UPDATE_HZ),      SERVO_PHASE_US,      TASK_PRIO_SERVO,      F("servo"));
+  g_task_ultrasonic =
+    g_sched.add(taskUltrasonic, Scheduler::hzToUs(ULTRASONIC_UPDATE_HZ * g_sonar.slotCount()), ULTRASONIC_PHASE_US, TASK_PRIO_ULTRASONIC, F("sonar"));
+  g_task_sequence =
+    g_sched.add(taskSequence,   Scheduler::hzToUs(SEQUENCER_UPDATE_HZ),  SEQUENCER_PHASE_US,  TASK_PRIO_SEQUENCER,  F("seq"));
+  g_task_telemetry =
+    g_sched.add(taskTelemetry, Scheduler::hzToUs(TELEMETRY_UPDATE_HZ), TELEMETRY_PHASE_US,  TASK_PRIO_TELEMETRY,  F("tel"));
+  if (ENABLE_AUX_LINK) {
+    g_task_aux =
+      g_sched.add(taskAuxTelemetry, Scheduler::hzToUs(auxLink().publishHz()), AUX_TELEMETRY_PHASE_US, TASK_PRIO_TELEMETRY, F("aux"));
+  }
 
-    g_link.TxTick(t);
+  if (ENABLE_PERF_REPORT) {
+    g_sched.add(taskPerf, Scheduler::hzToUs(PERF_REPORT_HZ), PERF_PHASE_US, TASK_PRIO_TELEMETRY, F("perf"));
+    g_sched.setProfiler(&g_profiler);
+    g_profiler.reset();
   }
 
+  applyTelemetryRate(g_link.publishHz());
+  if (ENABLE_AUX_LINK) applyAuxRate(auxLink().publishHz());
+  applyParams();
+
+  // Stack mark after setup()'s deepest calls, scanned in background from here
+  g_stack.begin();
+
+  // Watchdog last: setup() may take longer than the WDT period
+  const uint32_t now_ms = millis();
+  g_watchdog.begin(WATCHDOG_TABLE, WD_CHANNELS, g_reset_flags, now_ms);
+  noteResetCause(now_ms);
+
+  g_hello.setup_us = micros() - setup_start_us;
+  g_sched.start(micros());
+}
+
+/*=============================================================================
+  LOOP
+=============================================================================*/
+
+void loop() {
+  g_sched.tick();
 }
@@ -1,20 +1,69 @@
 #include "sensors/DistanceSensor.h"
-#include <HCSR04.h>  // Martinsos library
+
+#include "utils/ScopeMarker.h"
 
 /*
   DistanceSensor.cpp
 
-  This is a simple wrapper around the Martinsos HC-SR04 library.
+  Interrupt-driven HC-SR04 driver (replaces the Martinsos/pulseIn wrapper,
+  which blocked the loop for up to ULTRASONIC_TIMEOUT_US every ping).
 
   Responsibilities:
-  - Take a measurement when tick() is called
-  - Convert cm to inches
-  - Validate the reading
-  - Store the latest state for other code to read
+  - tick(): finish/timeout the previous ping, then fire a trigger pulse
+  - echo ISR: timestamp the rising and falling echo edges with micros()
+  - poll(): convert a finished echo to cm/inches, validate, store state
+    and run it (valid or not) through the RangeFilter
+
+  Conversion and range/timeout rules are the same as the Martinsos library:
+    speed_cm_per_us = 0.03313 + 0.0000606 * temp_c
+    timeout_us      = min(2.5 * max_cm / speed, max_timeout_us)
+    cm              = duration_us / 2 * speed   (0 or > max_cm -> -1)
 
   Rate limiting is handled in main.cpp using your Rate class.
 */
 
+namespace {
+
+// Same default as the Martinsos library (~343 m/s)
+constexpr float DEFAULT_TEMP_C = 19.307f;
+
+// Every begun sensor; the echo vectors are shared, so each edge is offered
+// to all of them (handleEchoEdge_ ignores pins that are not its own phase)
+DistanceSensor* g_sensors[SONAR_MAX_SENSORS] = {};
+uint8_t g_sensor_count = 0;
+
+void echoIsr() {
+  ScopeSpan mark(ScopeMark::ECHO_ISR);
+  for (uint8_t i = 0; i < g_sensor_count; i++) g_sensors[i]->handleEchoEdge_();
+}
+
+bool registerSensor(DistanceSensor* s) {
+  for (uint8_t i = 0; i < g_sensor_count; i++) {
+    if (g_sensors[i] == s) return true;
+  }
+  if (g_sensor_count >= SONAR_MAX_SENSORS) return false;
+
+  // The ISR may already be walking the table: publish the entry first
+  g_sensors[g_sensor_count] = s;
+  g_sensor_count++;
+  return true;
+}
+
+}  // namespace
+
+// Pin-change vectors (shared by every pin in the group; the handler checks
+// the echo pin level, so unrelated pins changing are harmless)
+#if defined(PCINT0_vect)
+ISR(PCINT0_vect) { echoIsr(); }
+#endif
+#if defined(PCINT1_vect)
+ISR(PCINT1_vect) { echoIsr(); }
+#endif
+#if defined(PCINT2_vect)
+ISR(PCINT2_vect) { echoIsr(); }
+#endif
+
+
 DistanceSensor::DistanceSensor(uint8_t trig_pin,
                                uint8_t echo_pin,
                                uint16_t max_distance_cm,
@@ -22,72 +71,144 @@ DistanceSensor::DistanceSensor(uint8_t trig_pin,
                                float min_valid_in,
                                float max_valid_in)
 {
+  _trig_pin = trig_pin;
+  _echo_pin = echo_pin;
+  _max_distance_cm = max_distance_cm;
+  _max_timeout_us = max_timeout_us;
+
   _min_valid_in = min_valid_in;
   _max_valid_in = max_valid_in;
-
-  // Martinsos constructor sets pinMode() internally
-  _sonar = new UltraSonicDistanceSensor(
-      trig_pin,
-      echo_pin,
-      max_distance_cm,
-      max_timeout_us
-  );
 }
 
-DistanceSensor::~DistanceSensor() {
-  if (_sonar) {
-    delete _sonar;
-    _sonar = nullptr;
+bool DistanceSensor::begin() {
+  pinMode(_trig_pin, OUTPUT);
+  digitalWrite(_trig_pin, LOW);
+  pinMode(_echo_pin, INPUT);
+
+  _echo_in_reg = portInputRegister(digitalPinToPort(_echo_pin));
+  _echo_mask = digitalPinToBitMask(_echo_pin);
+
+  _phase = IDLE;
+  _filter.reset();
+  if (!registerSensor(this)) return false;
+
+  // Pin-change only: INT0..INT5 belong to the encoders (QuadratureEncoder),
+  // and attachInterrupt() would link the core's vectors over them
+  volatile uint8_t* pcicr = digitalPinToPCICR(_echo_pin);
+  volatile uint8_t* pcmsk = digitalPinToPCMSK(_echo_pin);
+  if (pcicr && pcmsk) {
+    *pcmsk |= (uint8_t)(1u << digitalPinToPCMSKbit(_echo_pin));
+    *pcicr |= (uint8_t)(1u << digitalPinToPCICRbit(_echo_pin));
+    return true;
   }
-}
 
-void DistanceSensor::begin() {
-  // Nothing required here, but kept for consistency
+  // No interrupt on this pin: every ping will time out (invalid)
+  return false;
 }
 
 void DistanceSensor::tick(uint32_t now_ms) {
-  measure_(now_ms, nullptr);
+  poll(now_ms);
+  fire_(DEFAULT_TEMP_C);
 }
 
 void DistanceSensor::tick(uint32_t now_ms, float temp_c) {
-  measure_(now_ms, &temp_c);
+  poll(now_ms);
+  fire_(temp_c);
 }
 
-void DistanceSensor::measure_(uint32_t now_ms, const float* temp_c) {
+void DistanceSensor::fire_(float temp_c) {
+  // Previous ping still inside its timeout window: don't overlap pings
+  if (_phase != IDLE) return;
 
-  // Safety: ensure sonar exists
-  if (!_sonar) {
-    _state.valid = false;
-    _state.distance_cm = -1.0f;
-    _state.last_update_ms = now_ms;
-    return;
+  _speed_cm_per_us = 0.03313f + 0.0000606f * temp_c;
+
+  _wait_us = (uint32_t)(2.5f * (float)_max_distance_cm / _speed_cm_per_us);
+  if (_max_timeout_us > 0 && _max_timeout_us < _wait_us) {
+    _wait_us = _max_timeout_us;
   }
 
-  float cm;
+  // Arm before the trigger so a fast echo can't slip past
+  _phase = WAIT_RISE;
+
+  digitalWrite(_trig_pin, LOW);
+  delayMicroseconds(2);
+  digitalWrite(_trig_pin, HIGH);
+  delayMicroseconds(10);
+  digitalWrite(_trig_pin, LOW);
+
+  _trig_us = micros();
+}
+
+void DistanceSensor::handleEchoEdge_() {
+  if (_phase != WAIT_RISE && _phase != WAIT_FALL) return;
 
-  if (temp_c != nullptr) {
-    cm = _sonar->measureDistanceCm(*temp_c);
-  } else {
-    cm = _sonar->measureDistanceCm();
+  const uint32_t t = micros();
+  const bool high = (*_echo_in_reg & _echo_mask) != 0;
+
+  if (_phase == WAIT_RISE && high) {
+    _rise_us = t;
+    _phase = WAIT_FALL;
+  } else if (_phase == WAIT_FALL && !high) {
+    _fall_us = t;
+    _phase = DONE;
   }
+}
 
-  _state.last_update_ms = now_ms;
-  _state.distance_cm = cm;
+void DistanceSensor::poll(uint32_t now_ms) {
+  const Phase phase = _phase;
 
-  // Library returns -1.0 when invalid
-  if (cm <= 0.0f) {
-    _state.valid = false;
+  if (phase == IDLE) return;
+
+  if (phase == DONE) {
+    // ISR is finished with the timestamps once DONE is set
+    const uint32_t duration_us = _fall_us - _rise_us;
+    _phase = IDLE;
+
+    float cm = (float)duration_us * 0.5f * _speed_cm_per_us;
+    if (duration_us > _wait_us || cm == 0.0f || cm > (float)_max_distance_cm) {
+      cm = -1.0f;
+    }
+    publish_(now_ms, cm);
     return;
   }
 
-  // Convert cm to inches
-  float inches = cm * 0.3937007874f;
+  // WAIT_RISE / WAIT_FALL: same window pulseIn() would have waited
+  if ((uint32_t)(micros() - _trig_us) <= _wait_us) return;
 
-  if (inches < _min_valid_in || inches > _max_valid_in) {
-    _state.valid = false;
+  // Timed out, unless the falling edge landed just now
+  noInterrupts();
+  const bool done = (_phase == DONE);
+  if (!done) _phase = IDLE;
+  interrupts();
+
+  if (done) {
+    poll(now_ms);
     return;
   }
+  publish_(now_ms, -1.0f);
+}
+
+void DistanceSensor::publish_(uint32_t now_ms, float cm) {
+  _state.last_update_ms = now_ms;
+  _state.distance_cm = cm;
+  _state.valid = false;
+  _state.pings++;
+
+  // -1.0 when invalid (timeout / out of range)
+  if (cm > 0.0f) {
+    // Convert cm to inches
+    float inches = cm * 0.3937007874f;
+
+    if (inches >= _min_valid_in && inches <= _max_valid_in) {
+      _state.distance_in = inches;
+      _state.valid = true;
+    }
+  }
 
-  _state.distance_in = inches;
-  _state.valid = true;
+  _filter.update(now_ms, _state.valid, _state.distance_in);
+  const RangeFilter::Output& f = _filter.output();
+  _state.filtered_in = f.distance_in;
+  _state.closing_inps = f.closing_inps;
+  _state.confidence = f.confidence;
+  _state.filtered_valid = f.valid;
 }
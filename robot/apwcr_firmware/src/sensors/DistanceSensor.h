@@ -2,8 +2,36 @@
 
 #include <Arduino.h>
 
-// Forward declaration: we only store a pointer to the Martinsos class
-class UltraSonicDistanceSensor;
+#include "Params.h"
+#include "comms/Messages.h"   // SONAR_MAX_SENSORS
+#include "sensors/RangeFilter.h"
+
+/*
+  DistanceSensor
+
+  Purpose:
+  - Non-blocking HC-SR04 driver (trigger/echo state machine)
+  - Echo edges are timestamped in a pin-change / external interrupt, so
+    neither tick() nor poll() ever waits for the echo
+
+  Usage pattern:
+  - Call tick(now_ms) at ULTRASONIC_UPDATE_HZ: closes out the previous ping
+    (timeout if no echo) and fires the next trigger pulse (~12 us)
+  - Call poll(now_ms) every loop iteration: publishes a finished echo as
+    soon as the ISR has captured it
+  - Every published ping (echo or timeout) also runs the RangeFilter, so
+    State carries a gated/filtered distance, a closing rate and a
+    confidence next to the raw reading
+
+  IMPORTANT
+  ---------
+  The echo pin must have a pin-change interrupt (PCINTn). On the Mega:
+  D10-D15, D50-D53, A8-A15 (the INTn pins are the encoders').
+  Up to SONAR_MAX_SENSORS sensors can be begun; every echo interrupt checks
+  each of them (a sensor that is not pinging returns at once), so sensors
+  fired together all get their echo timed. Firing order / spacing is the
+  caller's job (see DistanceSensorArray).
+*/
 
 class DistanceSensor {
 public:
@@ -12,19 +40,26 @@ public:
     bool  valid = false;            // last reading valid?
     uint32_t last_update_ms = 0;    // millis() when last measurement happened
     float distance_cm = -1.0f;      // last raw cm value (-1 if invalid)
+    uint8_t pings = 0;              // +1 per published ping (wraps)
+
+    // RangeFilter output (see sensors/RangeFilter.h)
+    float filtered_in = NAN;        // NAN unless filtered_valid
+    float closing_inps = 0.0f;      // positive = obstacle getting closer
+    float confidence = 0.0f;        // 0..1, share of recent pings accepted
+    bool  filtered_valid = false;
   };
 
   /*
     Constructor
 
     trig_pin / echo_pin:
-      Pins connected to the HC-SR04.
+      Pins connected to the HC-SR04 (echo must be interrupt-capable).
 
     max_distance_cm:
-      Maximum measurable distance (library will not measure beyond this).
+      Maximum measurable distance (readings beyond this are invalid).
 
     max_timeout_us:
-      Hard timeout for pulseIn() to prevent long blocking.
+      Hard cap on how long to wait for an echo before declaring a timeout.
 
     min_valid_in / max_valid_in:
       Simple sanity bounds for accepting a reading.
@@ -36,25 +71,66 @@ public:
                  float min_valid_in = 0.8f,
                  float max_valid_in = 160.0f);
 
-  ~DistanceSensor();
+  // Configures pins and hooks the echo interrupt.
+  // Returns false if the echo pin has no usable interrupt, or
+  // SONAR_MAX_SENSORS sensors are already registered.
+  bool begin();
+
+  void tick(uint32_t now_ms);                // fire a ping (default temperature)
+  void tick(uint32_t now_ms, float temp_c);  // fire a ping (temperature-compensated)
 
-  void begin();                      // kept for consistency with other modules
-  void tick(uint32_t now_ms);        // measure using default temperature
-  void tick(uint32_t now_ms, float temp_c);  // measure using provided temperature
+  // Sanity bounds for later echoes (inches, see the constructor)
+  void setValidRange(float min_valid_in, float max_valid_in) {
+    _min_valid_in = min_valid_in;
+    _max_valid_in = max_valid_in;
+  }
+
+  // Cheap: publishes a completed echo or a timeout. Call every loop.
+  void poll(uint32_t now_ms);
 
   const State& getState() const { return _state; }
+  const RangeFilter& filter() const { return _filter; }
 
   uint32_t ageMs(uint32_t now_ms) const {
     return now_ms - _state.last_update_ms;
   }
 
+  // Called from the echo interrupt (public only so the ISR can reach it)
+  void handleEchoEdge_();
+
 private:
-  void measure_(uint32_t now_ms, const float* temp_c);
+  enum Phase : uint8_t {
+    IDLE = 0,
+    WAIT_RISE,    // trigger sent, waiting for echo to go high
+    WAIT_FALL,    // echo high, waiting for it to drop
+    DONE,         // both edges captured, waiting for poll()
+  };
+
+  void fire_(float temp_c);
+  void publish_(uint32_t now_ms, float cm);
 
   State _state;
+  RangeFilter _filter;
+
+  uint8_t _trig_pin;
+  uint8_t _echo_pin;
+  uint16_t _max_distance_cm;
+  uint32_t _max_timeout_us;
 
   float _min_valid_in = 0.8f;
   float _max_valid_in = 160.0f;
 
-  UltraSonicDistanceSensor* _sonar = nullptr;
+  // Echo pin fast read (resolved once in begin())
+  volatile uint8_t* _echo_in_reg = nullptr;
+  uint8_t _echo_mask = 0;
+
+  // Current ping
+  float _speed_cm_per_us = 0.0f;
+  uint32_t _wait_us = 0;          // timeout for this ping
+  uint32_t _trig_us = 0;
+
+  // Written by the ISR. Only read in poll() once _phase == DONE.
+  volatile Phase _phase = IDLE;
+  volatile uint32_t _rise_us = 0;
+  volatile uint32_t _fall_us = 0;
 };
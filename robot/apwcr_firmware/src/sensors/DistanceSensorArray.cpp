@@ -0,0 +1,80 @@
+#include "sensors/DistanceSensorArray.h"
+
+/*
+===============================================================================
+  DistanceSensorArray.cpp
+===============================================================================
+
+  poll() costs one poll and one byte compare per sensor when nothing
+  landed; a sensor's readings column is only rewritten after its ping was
+  published.
+===============================================================================
+*/
+
+namespace {
+
+uint8_t confidenceByte(float c) {
+  if (!(c > 0.0f)) return 0;
+  if (c >= 1.0f) return 255;
+  return (uint8_t)(c * 255.0f + 0.5f);
+}
+
+}  // namespace
+
+
+DistanceSensorArray::DistanceSensorArray(DistanceSensor* const* sensors, const uint8_t* slots, uint8_t n)
+: _sensors(sensors),
+  _slots(slots),
+  _n((n < MAX_SENSORS) ? n : MAX_SENSORS)
+{
+  for (uint8_t i = 0; i < _n; i++) {
+    if (_slots[i] >= _slot_count) _slot_count = (uint8_t)(_slots[i] + 1);
+  }
+  _readings.count = _n;
+}
+
+bool DistanceSensorArray::begin() {
+  bool ok = true;
+  for (uint8_t i = 0; i < _n; i++) {
+    if (!_sensors[i]->begin()) ok = false;
+    _seen[i] = _sensors[i]->getState().pings;
+  }
+  _next_slot = 0;
+  _readings = SonarArray();
+  _readings.count = _n;
+  return ok;
+}
+
+void DistanceSensorArray::tick(uint32_t now_ms, float temp_c) {
+  for (uint8_t i = 0; i < _n; i++) {
+    if (_slots[i] == _next_slot) {
+      _sensors[i]->tick(now_ms, temp_c);
+      copy_(i);   // tick() may have closed out a timed-out ping
+    }
+  }
+  _next_slot = (uint8_t)((_next_slot + 1) % _slot_count);
+}
+
+void DistanceSensorArray::poll(uint32_t now_ms) {
+  for (uint8_t i = 0; i < _n; i++) {
+    _sensors[i]->poll(now_ms);
+    copy_(i);
+  }
+}
+
+void DistanceSensorArray::copy_(uint8_t i) {
+  const DistanceSensor::State& s = _sensors[i]->getState();
+  if (s.pings == _seen[i]) return;
+  _seen[i] = s.pings;
+
+  const uint8_t bit = (uint8_t)(1u << i);
+  if (s.filtered_valid) {
+    _readings.valid_mask |= bit;
+    _readings.distance_in[i] = s.filtered_in;
+    _readings.closing_inps[i] = s.closing_inps;
+  } else {
+    _readings.valid_mask &= (uint8_t)~bit;
+  }
+  _readings.confidence[i] = confidenceByte(s.confidence);
+  _readings.updated_ms[i] = s.last_update_ms;
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include <Arduino.h>
+
+#include "Params.h"
+#include "comms/Messages.h"
+#include "sensors/DistanceSensor.h"
+
+/*
+===============================================================================
+  DistanceSensorArray.h
+===============================================================================
+
+  PURPOSE
+  -------
+  Runs several HC-SR04s without them hearing each other's pings.
+
+    - Each sensor is given a firing slot; tick() fires every sensor of the
+      next slot and moves on, round-robin. Sensors sharing a slot ping
+      together and their echoes are timed concurrently by the shared echo
+      interrupt (DistanceSensor), so only pair sensors facing apart
+    - Call tick() at ULTRASONIC_UPDATE_HZ * slotCount(): every sensor then
+      pings at ULTRASONIC_UPDATE_HZ, and a slot lasts long enough for the
+      echo timeout plus ring-down (checked in Params.h terms in main.cpp)
+    - poll() every loop publishes finished echoes into one statically
+      allocated SonarArray (struct-of-arrays), which telemetry sends as a
+      single block
+
+  The sensors and the slot table are owned by the caller (static tables in
+  main.cpp); nothing is allocated at run time.
+
+  USAGE
+  -----
+    DistanceSensor* const SENSORS[] = {&front, &left, &right, &rear};
+    const uint8_t SLOTS[] = {0, 1, 2, 0};
+    DistanceSensorArray sonar(SENSORS, SLOTS, 4);
+    sonar.begin();
+    at ULTRASONIC_UPDATE_HZ * sonar.slotCount():  sonar.tick(now_ms, temp_c);
+    every loop:                                   sonar.poll(now_ms);
+===============================================================================
+*/
+
+class DistanceSensorArray {
+public:
+  static constexpr uint8_t MAX_SENSORS = SONAR_MAX_SENSORS;
+
+  // n is capped at MAX_SENSORS; slots[i] is sensor i's firing slot
+  DistanceSensorArray(DistanceSensor* const* sensors, const uint8_t* slots, uint8_t n);
+
+  // Begins every sensor. false if any echo pin has no usable interrupt
+  // (that sensor then always reads invalid).
+  bool begin();
+
+  // Fires the sensors of the next slot (after closing out their last ping)
+  void tick(uint32_t now_ms, float temp_c);
+
+  // Cheap: publishes finished echoes / timeouts. Call every loop.
+  void poll(uint32_t now_ms);
+
+  const SonarArray& readings() const { return _readings; }
+
+  uint8_t count() const { return _n; }
+  uint8_t slotCount() const { return _slot_count; }
+  DistanceSensor& sensor(uint8_t i) { return *_sensors[i]; }
+
+private:
+  void copy_(uint8_t i);
+
+  DistanceSensor* const* _sensors;
+  const uint8_t* _slots;
+  uint8_t _n;
+  uint8_t _slot_count = 1;
+  uint8_t _next_slot = 0;
+
+  uint8_t _seen[MAX_SENSORS] = {};   // DistanceSensor::State::pings copied last
+  SonarArray _readings;
+};
@@ -0,0 +1,39 @@
+#include "sensors/EncoderBank.h"
+
+#include <util/atomic.h>
+
+/*
+===============================================================================
+  EncoderBank.cpp
+===============================================================================
+
+  micros() is read last inside the block, so no edge stamp in the
+  snapshot is later than t_us (the velocity estimate relies on that). The
+  block is four 8-byte copies plus micros(): a few us of held-off edges,
+  which the INTn flags latch.
+===============================================================================
+*/
+
+EncoderBank::EncoderBank(EncoderSensor* const* encoders, uint8_t n)
+: _encoders(encoders),
+  _count((n < MAX_ENCODERS) ? n : MAX_ENCODERS)
+{
+}
+
+const EncoderBank::Snapshot& EncoderBank::snapshot() {
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    for (uint8_t i = 0; i < _count; i++) {
+      _snap.reading[i] = _encoders[i]->readLocked();
+    }
+    _snap.t_us = micros();
+  }
+  _snap.count = _count;
+  return _snap;
+}
+
+void EncoderBank::sample(uint32_t now_ms) {
+  snapshot();
+  for (uint8_t i = 0; i < _count; i++) {
+    _encoders[i]->sample(now_ms, _snap.reading[i], _snap.t_us);
+  }
+}
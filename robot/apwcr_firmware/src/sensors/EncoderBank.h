@@ -0,0 +1,57 @@
+#pragma once
+#include <Arduino.h>
+
+#include "Params.h"
+#include "sensors/EncoderSensor.h"
+
+/*
+===============================================================================
+  EncoderBank.h
+===============================================================================
+
+  PURPOSE
+  -------
+  Samples a set of EncoderSensors at one instant: every count and edge
+  stamp is copied inside a single critical section, with one micros() for
+  all of them, then each sensor's State is updated from that snapshot.
+
+  One cli/sei instead of one per encoder, one micros() instead of one per
+  encoder, and the left/right (and arm) counts belong to the same moment,
+  so differences between them are real motion, not sampling skew.
+
+  USAGE
+  -----
+    EncoderSensor* const ENCODERS[] = {&left, &right, &lhs_arm, &rhs_arm};
+    EncoderBank bank(ENCODERS, 4);
+    each control tick:  bank.sample(now_ms);   // before the controllers
+  The sensors are still begun by their controllers; DriveController and
+  MechanismController read the State the bank left, they don't sample.
+===============================================================================
+*/
+
+class EncoderBank {
+public:
+  static constexpr uint8_t MAX_ENCODERS = ENCODER_BANK_MAX;
+
+  struct Snapshot {
+    uint32_t t_us = 0;                                  // micros() of the snapshot
+    uint8_t count = 0;
+    EncoderSensor::Reading reading[MAX_ENCODERS];       // same order as the table
+  };
+
+  // n is capped at MAX_ENCODERS
+  EncoderBank(EncoderSensor* const* encoders, uint8_t n);
+
+  // Counts and stamps of every encoder, one critical section
+  const Snapshot& snapshot();
+
+  // snapshot(), then every EncoderSensor::sample from it
+  void sample(uint32_t now_ms);
+
+  const Snapshot& last() const { return _snap; }
+
+private:
+  EncoderSensor* const* _encoders;
+  uint8_t _count;
+  Snapshot _snap;
+};
@@ -0,0 +1,156 @@
+#include "sensors/EncoderSampler.h"
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+
+#include "control/DriveInnerLoop.h"
+#include "utils/ScopeMarker.h"
+
+/*
+===============================================================================
+  EncoderSampler.cpp
+===============================================================================
+
+  The ISR is the only writer of _head and consume() the only writer of
+  _tail; both are 8-bit, so either side reads the other's index without a
+  lock. A row is complete before _head moves past it.
+
+  Interrupts are re-enabled once the counts are snapshotted, so the rest
+  of the ISR (inner loop, odometry, ring store) can be nested by encoder
+  edges (useful: they are never held off for long). The compare interrupt
+  itself can't re-enter: its next match is a whole period away (the inner
+  loop plus a queued tick is well under DRIVE_ISR_HZ's period).
+===============================================================================
+*/
+
+static_assert((ENCODER_RING_SAMPLES & (ENCODER_RING_SAMPLES - 1)) == 0,
+              "ENCODER_RING_SAMPLES must be a power of two");
+static_assert(ENCODER_RING_SAMPLES <= 128, "8-bit ring indices");
+
+namespace {
+
+EncoderSampler* g_sampler = nullptr;
+
+}  // namespace
+
+ISR(TIMER1_COMPA_vect) {
+  ScopeSpan mark(ScopeMark::SAMPLER_ISR);
+  if (g_sampler) g_sampler->sampleIsr_();
+}
+
+
+EncoderSampler::EncoderSampler(EncoderSensor& ch0, EncoderSensor& ch1)
+: _enc{&ch0, &ch1}
+{
+}
+
+void EncoderSampler::begin(uint16_t hz, uint8_t queue_every) {
+  if (hz == 0) hz = 1;
+  if (queue_every == 0) queue_every = 1;
+
+  // CTC: period = (OCR1A + 1) * prescale / F_CPU
+  uint32_t ticks = (F_CPU / 8UL) / hz;
+  uint8_t cs = _BV(CS11);                      // clk/8
+  if (ticks > 65536UL) {
+    ticks = (F_CPU / 64UL) / hz;
+    cs = _BV(CS11) | _BV(CS10);                // clk/64
+    if (ticks > 65536UL) ticks = 65536UL;
+  }
+
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    g_sampler = this;
+    _head = _tail = 0;
+    _overflows = 0;
+    _queue_every = queue_every;
+    _skip = 0;
+
+    TCCR1A = 0;
+    TCCR1B = 0;
+    TCNT1 = 0;
+    OCR1A = (uint16_t)(ticks - 1);
+    TIFR1 = _BV(OCF1A);                        // clear a stale match
+    TIMSK1 |= _BV(OCIE1A);
+    TCCR1B = _BV(WGM12) | cs;
+  }
+}
+
+void EncoderSampler::end() {
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    TIMSK1 &= (uint8_t)~_BV(OCIE1A);
+    TCCR1B = 0;
+    g_sampler = nullptr;
+  }
+}
+
+uint32_t EncoderSampler::overflows() const {
+  uint32_t n;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { n = _overflows; }
+  return n;
+}
+
+uint8_t EncoderSampler::peek(EncoderBatch& batch) const {
+  const uint8_t tail = _tail;
+  uint8_t avail = (uint8_t)(_head - tail);
+  if (avail > ENCODER_BATCH_MAX) avail = ENCODER_BATCH_MAX;
+
+  uint8_t n = 0;
+  for (; n < avail; n++) {
+    const EncoderSample& s = _ring[(uint8_t)(tail + n) & MASK];
+
+    // Stop where the next step won't pack (a stall or a very fast wheel);
+    // the rest goes in the next batch, which starts from absolute values
+    if (n > 0) {
+      const EncoderSample& prev = batch.samples[n - 1];
+      bool fits = (s.t_us - prev.t_us) <= 0xFFFFUL;
+      for (uint8_t c = 0; c < CHANNELS; c++) {
+        const int32_t d = s.count[c] - prev.count[c];
+        if (d > INT16_MAX || d < INT16_MIN) fits = false;
+      }
+      if (!fits) break;
+    }
+
+    batch.samples[n] = s;
+  }
+
+  batch.count = n;
+  batch.overflows = overflows();
+  return n;
+}
+
+void EncoderSampler::consume(uint8_t n) {
+  const uint8_t avail = available();
+  if (n > avail) n = avail;
+  _tail = (uint8_t)(_tail + n);
+}
+
+void EncoderSampler::sampleIsr_() {
+  const uint32_t t_us = micros();
+  int32_t count[CHANNELS];
+  for (uint8_t c = 0; c < CHANNELS; c++) {
+    count[c] = _enc[c]->readLocked().count;   // interrupts are off in the ISR
+  }
+  sei();
+  if (_loop) _loop->tickIsr_(count);
+
+  if (_skip) {
+    _skip--;
+    return;
+  }
+  _skip = (uint8_t)(_queue_every - 1);
+
+  if (_odom) _odom->integrate(count[0], count[1]);
+
+  const uint8_t head = _head;
+  if ((uint8_t)(head - _tail) >= ENCODER_RING_SAMPLES) {
+    _overflows++;
+    return;
+  }
+
+  EncoderSample& s = _ring[head & MASK];
+  s.t_us = t_us;
+  for (uint8_t c = 0; c < CHANNELS; c++) {
+    s.count[c] = count[c];
+  }
+  _head = (uint8_t)(head + 1);
+}
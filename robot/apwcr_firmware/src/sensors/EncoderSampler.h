@@ -0,0 +1,99 @@
+#pragma once
+#include <Arduino.h>
+
+#include "Params.h"
+#include "comms/Messages.h"
+#include "sensors/EncoderSensor.h"
+#include "sensors/Odometry.h"
+
+class DriveInnerLoop;
+
+/*
+===============================================================================
+  EncoderSampler.h
+===============================================================================
+
+  PURPOSE
+  -------
+  Samples the drive encoders at a fixed rate from a Timer1 compare
+  interrupt and queues every sample (micros() timestamp + signed count per
+  channel) in a ring, so the host sees full-rate position/velocity data
+  instead of one value per telemetry frame.
+
+  The ring is one row per tick with one column per encoder: both channels
+  are read in the same ISR, so they share the timestamp.
+
+  Ring full -> the new sample is dropped and overflows() counts it. Counts
+  are absolute, so a lost sample costs time resolution, never position.
+  An attached Odometry integrates every tick, ring full or not (channel 0
+  = left, 1 = right).
+
+  Control tier: an attached DriveInnerLoop runs first in every tick, on
+  the same snapshot, with interrupts back on. The timer then runs at the
+  loop's rate and only every queue_every-th tick is queued (and fed to
+  the odometry), so the batches keep their rate.
+
+  peek() hands out the oldest samples as an EncoderBatch without removing
+  them; consume() removes them once the batch is on the wire, so a dropped
+  TX frame doesn't lose samples either. peek() also ends a batch early
+  where a step would not fit the packed wire form (int16 count delta,
+  uint16 dt), so every batch it returns can be encoded as is.
+
+  Timer1 runs in CTC mode (clk/8, or clk/64 below 31 Hz). The robot build
+  has no other Timer1 user (the drive inner loop shares this ISR, not the
+  timer); the mega_bench CycleTimer also uses Timer1, so the bench never
+  calls begin().
+
+  USAGE
+  -----
+  - begin(ENCODER_SAMPLE_HZ) once in setup(), after the encoders' begin()
+    (with an inner loop: begin(DRIVE_ISR_HZ, DRIVE_ISR_HZ / ENCODER_SAMPLE_HZ))
+  - per telemetry frame: n = peek(batch); ...send...; consume(n)
+===============================================================================
+*/
+
+class EncoderSampler {
+public:
+  static constexpr uint8_t CHANNELS = ENCODER_BATCH_CHANNELS;
+
+  EncoderSampler(EncoderSensor& ch0, EncoderSensor& ch1);
+
+  // Starts Timer1 at hz and begins sampling (ring cleared); every
+  // queue_every-th tick is queued.
+  void begin(uint16_t hz, uint8_t queue_every = 1);
+  void end();
+
+  // Pose integrator fed from the ISR (nullptr = none); set before begin()
+  void setOdometry(Odometry* odom) { _odom = odom; }
+
+  // Drive loop run every tick from the ISR (nullptr = none); set before begin()
+  void setControlLoop(DriveInnerLoop* loop) { _loop = loop; }
+
+  // Copies the oldest samples (up to ENCODER_BATCH_MAX) into batch and
+  // returns how many; the ring is unchanged.
+  uint8_t peek(EncoderBatch& batch) const;
+
+  // Removes the n oldest samples (after a successful send).
+  void consume(uint8_t n);
+
+  uint8_t available() const { return (uint8_t)(_head - _tail); }
+  uint32_t overflows() const;
+
+  // Called from the Timer1 compare ISR (public only so the ISR can reach it)
+  void sampleIsr_();
+
+private:
+  static constexpr uint8_t MASK = ENCODER_RING_SAMPLES - 1;
+
+  EncoderSensor* _enc[CHANNELS];
+  Odometry* _odom = nullptr;
+  DriveInnerLoop* _loop = nullptr;
+
+  uint8_t _queue_every = 1;
+  uint8_t _skip = 0;             // ticks left before the next queued one (ISR only)
+
+  EncoderSample _ring[ENCODER_RING_SAMPLES];
+  volatile uint8_t _head = 0;    // written by the ISR only
+  volatile uint8_t _tail = 0;    // written by consume() only
+  volatile uint32_t _overflows = 0;
+};
@@ -1,20 +1,24 @@
 #include "sensors/EncoderSensor.h"
 
+#include "Params.h"
+
 /*
 ===============================================================================
   EncoderSensor.cpp
 ===============================================================================
 
-  The Encoder library gives raw signed counts.
+  QuadratureEncoder gives raw signed counts.
   This wrapper converts those counts into position and speed units.
+
+  QuadratureCounter::read(&edge_us) returns the count and its edge stamp
+  from one critical section, so the pair always matches.
 ===============================================================================
 */
 
-EncoderSensor::EncoderSensor(uint8_t pin_a,
-                             uint8_t pin_b,
+EncoderSensor::EncoderSensor(const QuadratureChannel& channel,
                              float counts_per_output_rev,
                              bool invert_direction)
-: _enc(pin_a, pin_b)
+: _ch(channel)
 {
   if (counts_per_output_rev > 0.0f) {
     _counts_per_output_rev = counts_per_output_rev;
@@ -24,15 +28,18 @@ EncoderSensor::EncoderSensor(uint8_t pin_a,
 
   _invert_direction = invert_direction;
   _last_sample_count = 0;
+  _rev_us_scale = 1000000.0f / _counts_per_output_rev;
 }
 
 void EncoderSensor::begin() {
-  _enc.write(0);
+  _ch.begin();
+  _ch.counter->write(0);
 
   _state = State();
   _state.last_sample_ms = millis();
 
   _last_sample_count = 0;
+  clearVelocity_();
 }
 
 int32_t EncoderSensor::applySign_(int32_t raw_count) const {
@@ -50,13 +57,13 @@ int32_t EncoderSensor::undoSign_(int32_t signed_count) const {
 }
 
 int32_t EncoderSensor::getCount(){
-  int32_t raw = (int32_t)_enc.read();
+  int32_t raw = _ch.counter->read();
   return applySign_(raw);
 }
 
 void EncoderSensor::reset(int32_t new_count) {
   int32_t raw_target = undoSign_(new_count);
-  _enc.write((long)raw_target);
+  _ch.counter->write(raw_target);
 
   _state = State();
   _state.count = new_count;
@@ -65,10 +72,31 @@ void EncoderSensor::reset(int32_t new_count) {
   _state.last_sample_ms = millis();
 
   _last_sample_count = new_count;
+  clearVelocity_();
+}
+
+void EncoderSensor::clearVelocity_() {
+  _edge_count = _last_sample_count;
+  _edge_us = 0;
+  _has_edge = false;
+}
+
+EncoderSensor::Reading EncoderSensor::readLocked() const {
+  Reading r;
+  r.count = applySign_(_ch.counter->count);
+  r.edge_us = _ch.counter->edge_us;
+  return r;
 }
 
 void EncoderSensor::sample(uint32_t now_ms) {
-  int32_t count_now = getCount();
+  Reading r;
+  r.count = applySign_(_ch.counter->read(&r.edge_us));
+  sample(now_ms, r, micros());   // micros() after the read: never before edge_us
+}
+
+void EncoderSensor::sample(uint32_t now_ms, const Reading& r, uint32_t now_us) {
+  const int32_t count_now = r.count;
+  const uint32_t edge_us = r.edge_us;
   int32_t dc = count_now - _last_sample_count;
   uint32_t dt_ms = now_ms - _state.last_sample_ms;
 
@@ -86,11 +114,35 @@ void EncoderSensor::sample(uint32_t now_ms) {
     return;
   }
 
-  float dt_s = (float)dt_ms / 1000.0f;
-  float d_rev = (float)dc / _counts_per_output_rev;
-
-  _state.rps = d_rev / dt_s;
+  _state.rps = estimateRps_(count_now, edge_us, now_us);
   _state.rpm = _state.rps * 60.0f;
   _state.dps = _state.rps * 360.0f;
+  _state.rps_filtered += ENCODER_VEL_FILTER_ALPHA * (_state.rps - _state.rps_filtered);
   _state.valid_speed = true;
 }
+
+float EncoderSensor::estimateRps_(int32_t count, uint32_t edge_us, uint32_t now_us) {
+  if (count != _edge_count) {
+    // Counts between the reference edge and the newest one, over the time
+    // between those two edges
+    const int32_t dc = count - _edge_count;
+    const uint32_t span_us = edge_us - _edge_us;
+    const bool have_period = _has_edge && span_us != 0 && span_us <= ENCODER_ZERO_SPEED_US;
+
+    _edge_count = count;
+    _edge_us = edge_us;
+    _has_edge = true;
+
+    return have_period ? ((float)dc * _rev_us_scale / (float)span_us) : 0.0f;
+  }
+
+  // No edge since the last sample
+  const uint32_t idle_us = now_us - _edge_us;
+  if (!_has_edge || idle_us >= ENCODER_ZERO_SPEED_US) return 0.0f;
+
+  // Still turning at most one count per idle_us
+  const float limit = _rev_us_scale / (float)idle_us;
+  if (_state.rps > limit) return limit;
+  if (_state.rps < -limit) return -limit;
+  return _state.rps;
+}
@@ -1,6 +1,7 @@
 #pragma once
 #include <Arduino.h>
-#include <Encoder.h>  // Paul Stoffregen Encoder library
+
+#include "sensors/QuadratureEncoder.h"
 
 /*
 ===============================================================================
@@ -9,16 +10,36 @@
 
   PURPOSE
   -------
-  Wrapper around the Encoder library that provides:
+  Position and speed from one QuadratureEncoder channel:
     - signed count
     - sampled delta counts
     - position in revolutions/degrees
-    - speed in rps/rpm/dps
+    - speed in rps/rpm/dps (hybrid M/T estimate, see below)
+    - low-pass filtered rps for control loops
+
+  VELOCITY
+  --------
+  Counting edges per sample (M method) quantizes badly at crawl speed: at
+  100 Hz one count is ~3.5 rpm on the drive wheels. The encoder ISR also
+  stamps each edge with micros(), so sample() divides the counts since
+  the last stamped edge by the exact time between the two edges instead:
+    - fast wheel (many counts per sample): same as the M method, but over
+      an edge-aligned window, so no +/-1 count jitter
+    - slow wheel (0-1 counts per sample): becomes the T method (one period)
+    - no edge this sample: speed is held, but capped at one count over the
+      time since the last edge, so it decays toward 0 as the wheel stops;
+      ENCODER_ZERO_SPEED_US without an edge reads as stopped
+  The first edge after standstill has no period yet and reads 0.
+
+  rps_filtered is a one-pole IIR (ENCODER_VEL_FILTER_ALPHA) on rps. All of
+  this is a few float ops per sample(); the ISR only adds the micros() read
+  (stamped on counted edges, see QuadratureEncoder.h).
 
   USAGE
   -----
   - Call begin() once in setup()
-  - Call sample(now_ms) at a fixed rate
+  - Call sample(now_ms) at a fixed rate, or let an EncoderBank sample
+    several encoders from one snapshot
   - Read getState() for position and speed
 
   IMPORTANT
@@ -41,14 +62,22 @@ public:
     float rps = 0.0f;              // revolutions per second
     float rpm = 0.0f;              // revolutions per minute
     float dps = 0.0f;              // degrees per second
+    float rps_filtered = 0.0f;     // low-passed rps (feedback for control)
 
     uint32_t last_sample_ms = 0;   // timestamp of last sample
     bool valid_speed = false;      // false until first valid dt > 0 sample
   };
 
+  // Signed count and the micros() of the edge that produced it
+  struct Reading {
+    int32_t count = 0;
+    uint32_t edge_us = 0;
+  };
+
   /*
-    pin_a / pin_b:
-      Quadrature encoder channels A and B
+    channel:
+      The encoder's ISR counter, e.g. LhsDriveEncoder::channel()
+      (QuadratureEncoder.h); begin() arms its pins and vectors
 
     counts_per_output_rev:
       Total counts for one output revolution (after gearing)
@@ -56,14 +85,19 @@ public:
     invert_direction:
       Set true if forward physical motion reads as negative count
   */
-  EncoderSensor(uint8_t pin_a,
-                uint8_t pin_b,
+  EncoderSensor(const QuadratureChannel& channel,
                 float counts_per_output_rev,
                 bool invert_direction = false);
 
   void begin();
   void sample(uint32_t now_ms);
 
+  // sample() from a reading taken at now_us (EncoderBank)
+  void sample(uint32_t now_ms, const Reading& r, uint32_t now_us);
+
+  // Interrupts must already be off (an ISR, or EncoderBank's snapshot)
+  Reading readLocked() const;
+
   int32_t getCount();
   void reset(int32_t new_count = 0);
 
@@ -72,12 +106,20 @@ public:
 private:
   int32_t applySign_(int32_t raw_count) const;
   int32_t undoSign_(int32_t signed_count) const;
+  float estimateRps_(int32_t count, uint32_t edge_us, uint32_t now_us);
+  void clearVelocity_();
 
-  Encoder _enc;
+  QuadratureChannel _ch;
 
   float _counts_per_output_rev;
   bool _invert_direction;
 
   int32_t _last_sample_count;
   State _state;
+
+  // Reference edge for the hybrid estimate: last edge seen by a sample()
+  float _rev_us_scale;             // 1e6 / counts_per_output_rev
+  int32_t _edge_count = 0;
+  uint32_t _edge_us = 0;
+  bool _has_edge = false;
 };
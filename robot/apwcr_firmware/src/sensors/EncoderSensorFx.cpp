@@ -0,0 +1,105 @@
+#include "sensors/EncoderSensorFx.h"
+
+/*
+===============================================================================
+  EncoderSensorFx.cpp
+===============================================================================
+
+  Mirrors EncoderSensor.cpp step for step, with Q16.16 / Q0.32 arithmetic.
+===============================================================================
+*/
+
+namespace {
+
+constexpr int32_t DEG_SAT = 32767;
+
+Fixed revToDeg(Fixed rev) {
+  // Saturate instead of wrapping past the Q16.16 range
+  const int32_t lim = (DEG_SAT * Fixed::ONE_RAW) / 360;
+  if (rev.raw() > lim) return Fixed::fromInt(DEG_SAT);
+  if (rev.raw() < -lim) return Fixed::fromInt(-DEG_SAT);
+  return rev * (int32_t)360;
+}
+
+}  // namespace
+
+
+EncoderSensorFx::EncoderSensorFx(const QuadratureChannel& channel,
+                                 uint32_t rev_per_count_q32,
+                                 bool invert_direction)
+: _ch(channel)
+{
+  // scaleQ32() needs 0 < k < 2^31 (i.e. more than 2 counts per rev)
+  _rev_per_count_q32 = (rev_per_count_q32 > 0 && rev_per_count_q32 < 0x80000000UL)
+                         ? rev_per_count_q32 : 1UL;
+  _invert_direction = invert_direction;
+}
+
+void EncoderSensorFx::begin() {
+  _ch.begin();
+  _ch.counter->write(0);
+
+  _state = State();
+  _state.last_sample_ms = millis();
+
+  _last_sample_count = 0;
+}
+
+int32_t EncoderSensorFx::getCount() {
+  int32_t raw = _ch.counter->read();
+  return _invert_direction ? -raw : raw;
+}
+
+void EncoderSensorFx::reset(int32_t new_count) {
+  _ch.counter->write(_invert_direction ? -new_count : new_count);
+
+  _state = State();
+  updatePosition_(new_count);
+  _state.last_sample_ms = millis();
+
+  _last_sample_count = new_count;
+}
+
+void EncoderSensorFx::updatePosition_(int32_t count) {
+  _state.count = count;
+  _state.revolutions = fx::scaleQ32(count, _rev_per_count_q32);
+  _state.degrees = revToDeg(_state.revolutions);
+}
+
+uint32_t EncoderSensorFx::rpsScale_(uint32_t dt_ms) {
+  for (uint8_t i = 0; i < 2; i++) {
+    if (_dt_cache[i].dt_ms == dt_ms) return _dt_cache[i].rps_per_count_q32;
+  }
+
+  // Cache miss: one 64-bit divide, then remember it
+  uint64_t k = ((uint64_t)_rev_per_count_q32 * 1000ULL) / dt_ms;
+  if (k > 0x7FFFFFFFULL) k = 0x7FFFFFFFULL;
+
+  DtCache& c = _dt_cache[_dt_next];
+  _dt_next ^= 1;
+  c.dt_ms = dt_ms;
+  c.rps_per_count_q32 = (uint32_t)k;
+  return c.rps_per_count_q32;
+}
+
+void EncoderSensorFx::sample(uint32_t now_ms) {
+  int32_t count_now = getCount();
+  int32_t dc = count_now - _last_sample_count;
+  uint32_t dt_ms = now_ms - _state.last_sample_ms;
+
+  updatePosition_(count_now);
+  _state.delta_counts = dc;
+
+  _state.last_sample_ms = now_ms;
+  _last_sample_count = count_now;
+
+  if (dt_ms == 0) {
+    _state.valid_speed = false;
+    return;
+  }
+
+  _state.rps = fx::scaleQ32(dc, rpsScale_(dt_ms));
+  _state.rpm = _state.rps * (int32_t)60;
+  _state.dps = _state.rps * (int32_t)360;
+  _state.valid_speed = true;
+}
@@ -0,0 +1,84 @@
+#pragma once
+#include <Arduino.h>
+#include "sensors/QuadratureEncoder.h"
+#include "utils/Fixed.h"
+
+/*
+===============================================================================
+  EncoderSensorFx.h
+===============================================================================
+
+  PURPOSE
+  -------
+  Fixed-point (Q16.16) variant of EncoderSensor. Same usage and state
+  fields, but sample() does no float math:
+
+    revolutions = count * rev_per_count          (Q0.32 scale, one multiply)
+    rps         = delta * rev_per_count * 1000 / dt_ms
+
+  The per-dt factor (rev_per_count * 1000 / dt_ms) needs one integer divide,
+  done only when dt_ms changes. With the scheduler running a fixed period,
+  dt_ms only alternates between two values (millis() granularity), so a
+  2-entry cache means sample() normally does no divide at all.
+
+  Range: degrees saturates at +/-32767 (~91 output revs). Use count or
+  revolutions for long-distance odometry.
+
+  EncoderSensor and EncoderSensorFx on the same channel share its counter,
+  so reset() on one moves the other too.
+===============================================================================
+*/
+
+class EncoderSensorFx {
+public:
+  struct State {
+    int32_t count = 0;             // signed accumulated counts
+    int32_t delta_counts = 0;      // counts since last sample
+
+    Fixed revolutions;             // output revolutions
+    Fixed degrees;                 // output angle in degrees (saturating)
+
+    Fixed rps;                     // revolutions per second
+    Fixed rpm;                     // revolutions per minute
+    Fixed dps;                     // degrees per second
+
+    uint32_t last_sample_ms = 0;   // timestamp of last sample
+    bool valid_speed = false;      // false until first valid dt > 0 sample
+  };
+
+  /*
+    rev_per_count_q32:
+      1 / counts_per_output_rev in Q0.32 (e.g. WHEEL_REV_PER_COUNT_Q32)
+  */
+  EncoderSensorFx(const QuadratureChannel& channel,
+                  uint32_t rev_per_count_q32,
+                  bool invert_direction = false);
+
+  void begin();
+  void sample(uint32_t now_ms);
+
+  int32_t getCount();
+  void reset(int32_t new_count = 0);
+
+  const State& getState() const { return _state; }
+
+private:
+  struct DtCache {
+    uint32_t dt_ms = 0;
+    uint32_t rps_per_count_q32 = 0;  // rev_per_count * 1000 / dt_ms, Q0.32
+  };
+
+  void updatePosition_(int32_t count);
+  uint32_t rpsScale_(uint32_t dt_ms);
+
+  QuadratureChannel _ch;
+
+  uint32_t _rev_per_count_q32;
+  bool _invert_direction;
+
+  int32_t _last_sample_count = 0;
+  State _state;
+
+  DtCache _dt_cache[2];
+  uint8_t _dt_next = 0;
+};
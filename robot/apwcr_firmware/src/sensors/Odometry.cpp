@@ -0,0 +1,154 @@
+#include "sensors/Odometry.h"
+#include <avr/pgmspace.h>
+#include <math.h>  // sqrtf, floorf
+#include <util/atomic.h>
+
+/*
+===============================================================================
+  Odometry.cpp
+===============================================================================
+
+  integrate() per sample: two 32-bit multiplies for the binary angle, one
+  table interpolation for cos and one for sin, two 32x16 multiplies into
+  the int64 accumulators. Well under 10 us at 16 MHz, every 5 ms.
+===============================================================================
+*/
+
+static_assert(ODOM_TURN_PER_COUNT_Q32 > 0 && ODOM_TURN_PER_COUNT_Q32 < 0x80000000UL,
+              "ODOM_TURN_PER_COUNT_Q32 out of range");
+
+namespace {
+
+// sin(i * 90 / 64 deg) in Q15
+const int16_t SIN_Q15[65] PROGMEM = {
+      0,   804,  1608,  2410,  3212,  4011,  4808,  5602,
+   6393,  7179,  7962,  8739,  9512, 10278, 11039, 11793,
+  12539, 13279, 14010, 14732, 15446, 16151, 16846, 17530,
+  18204, 18868, 19519, 20159, 20787, 21403, 22005, 22594,
+  23170, 23731, 24279, 24811, 25329, 25832, 26319, 26790,
+  27245, 27683, 28105, 28510, 28898, 29268, 29621, 29956,
+  30273, 30571, 30852, 31113, 31356, 31580, 31785, 31971,
+  32137, 32285, 32412, 32521, 32609, 32678, 32728, 32757,
+  32767,
+};
+
+// Quarter-wave sine: a = bits 29..16 of the angle (0 .. 90 deg)
+int16_t sinQuarter(uint16_t a) {
+  if (a >= 0x4000) return 32767;
+  const uint8_t i = (uint8_t)(a >> 8);          // 0..63
+  const uint8_t f = (uint8_t)a;
+  const int16_t lo = (int16_t)pgm_read_word(&SIN_Q15[i]);
+  const int16_t hi = (int16_t)pgm_read_word(&SIN_Q15[i + 1]);
+  return (int16_t)(lo + (int16_t)(((int32_t)(hi - lo) * f) >> 8));
+}
+
+inline uint32_t addSat(uint32_t acc, uint32_t v) {
+  const uint32_t s = acc + v;
+  return (s < acc) ? 0xFFFFFFFFUL : s;
+}
+
+inline uint32_t absDiff(int32_t d) { return (d < 0) ? (uint32_t)(-d) : (uint32_t)d; }
+
+constexpr float TURN_TO_DEG = 360.0f / 4294967296.0f;
+constexpr float ACC_TO_FT = 0.5f * FEET_PER_COUNT / 32768.0f;
+constexpr float RAD_PER_TURN_COUNT = FEET_PER_COUNT / TRACK_WIDTH_FT;
+
+}  // namespace
+
+
+void Odometry::cosSin_(uint32_t angle, int16_t& c, int16_t& s) {
+  const uint8_t quadrant = (uint8_t)(angle >> 30);
+  const uint16_t a = (uint16_t)((angle >> 16) & 0x3FFF);
+  const int16_t up = sinQuarter(a);                       // sin within the quadrant
+  const int16_t down = sinQuarter((uint16_t)(0x4000 - a)); // cos within the quadrant
+
+  switch (quadrant) {
+    case 0:  c = down;                 s = up;                 break;
+    case 1:  c = (int16_t)-up;         s = down;               break;
+    case 2:  c = (int16_t)-down;       s = (int16_t)-up;       break;
+    default: c = up;                   s = (int16_t)-down;     break;
+  }
+}
+
+void Odometry::integrate(int32_t left_count, int32_t right_count) {
+  if (!_primed) {
+    _last_left = left_count;
+    _last_right = right_count;
+    _primed = true;
+    return;
+  }
+
+  const int32_t dl = left_count - _last_left;
+  const int32_t dr = right_count - _last_right;
+  _last_left = left_count;
+  _last_right = right_count;
+  if (dl == 0 && dr == 0) return;
+
+  // Midpoint heading: old angle plus half this sample's turn
+  const uint32_t before = _heading0 + (uint32_t)_diff * ODOM_TURN_PER_COUNT_Q32;
+  const int32_t dd = dr - dl;
+  const int32_t turn = (int32_t)((uint32_t)dd * ODOM_TURN_PER_COUNT_Q32);
+  _diff += dd;
+
+  int16_t c, s;
+  cosSin_(before + (uint32_t)(turn / 2), c, s);
+
+  const int32_t ds = dl + dr;   // half-counts travelled
+  _x_acc += (int64_t)(ds * (int32_t)c);
+  _y_acc += (int64_t)(ds * (int32_t)s);
+
+  _travel_counts = addSat(_travel_counts, absDiff(dl) + absDiff(dr));
+  _turn_counts = addSat(_turn_counts, absDiff(dd));
+}
+
+void Odometry::reset(const PoseReset& p) {
+  float turns = p.heading_deg * (1.0f / 360.0f);
+  turns -= floorf(turns);
+  const uint32_t heading0 = (uint32_t)(turns * 4294967296.0f);
+
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    _diff = 0;
+    _heading0 = heading0;
+    _x_acc = 0;
+    _y_acc = 0;
+    _travel_counts = 0;
+    _turn_counts = 0;
+    _x0_ft = p.x_ft;
+    _y0_ft = p.y_ft;
+  }
+}
+
+PoseState Odometry::pose() const {
+  int32_t diff;
+  uint32_t heading0, travel, turned;
+  int64_t x_acc, y_acc;
+  float x0, y0;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    diff = _diff;
+    heading0 = _heading0;
+    x_acc = _x_acc;
+    y_acc = _y_acc;
+    travel = _travel_counts;
+    turned = _turn_counts;
+    x0 = _x0_ft;
+    y0 = _y0_ft;
+  }
+
+  PoseState out;
+  out.x_ft = x0 + (float)x_acc * ACC_TO_FT;
+  out.y_ft = y0 + (float)y_acc * ACC_TO_FT;
+
+  // Signed binary angle -> (-180, 180]
+  const int32_t h = (int32_t)(heading0 + (uint32_t)diff * ODOM_TURN_PER_COUNT_Q32);
+  out.heading_deg = (h == INT32_MIN) ? 180.0f : (float)h * TURN_TO_DEG;
+
+  const float s_ft = (float)travel * (0.5f * FEET_PER_COUNT);
+  const float t_rad = (float)turned * RAD_PER_TURN_COUNT;
+  const float var_h = ODOM_HEADING_SIGMA_PER_RAD * ODOM_HEADING_SIGMA_PER_RAD * t_rad +
+                      ODOM_HEADING_SIGMA_PER_FT * ODOM_HEADING_SIGMA_PER_FT * s_ft;
+  const float var_xy = ODOM_POS_SIGMA_PER_FT * ODOM_POS_SIGMA_PER_FT * s_ft +
+                       var_h * s_ft * s_ft * (1.0f / 3.0f);
+  out.sigma_xy_ft = sqrtf(var_xy);
+  out.sigma_heading_deg = sqrtf(var_h) * (180.0f / PI);
+  return out;
+}
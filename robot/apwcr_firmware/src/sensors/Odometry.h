@@ -0,0 +1,72 @@
+#pragma once
+#include <Arduino.h>
+
+#include "Params.h"
+#include "comms/Messages.h"
+
+/*
+===============================================================================
+  Odometry.h
+===============================================================================
+
+  PURPOSE
+  -------
+  Differential-drive dead reckoning on the MCU, integrated at the encoder
+  sample rate (EncoderSampler's Timer1 ISR, ENCODER_SAMPLE_HZ) from the
+  absolute drive counts, so the host gets pose without rebuilding it from
+  20 Hz RPM snapshots.
+
+  Fixed point, no trig calls, no floats in integrate():
+    - heading is a 32-bit binary angle (2^32 = one turn) computed from the
+      total count difference since reset, (R - L) * ODOM_TURN_PER_COUNT_Q32,
+      so it never accumulates rounding; the wrap is the 2 pi wrap
+    - each sample moves (dL + dR) half-counts along the midpoint heading;
+      cos/sin come from a 65-entry quarter-wave Q15 table with linear
+      interpolation (error < 1e-4), accumulated exactly in int64
+    - conversion to feet / degrees happens only in pose()
+
+  Frame: x forward at reset heading 0, y to the left, heading CCW
+  (right wheel faster = positive), reported in (-180, 180] degrees.
+
+  Covariance-lite: no matrix, one sigma for position and one for heading,
+  grown from the distance travelled S and the angle turned T since reset:
+    var_heading = ODOM_HEADING_SIGMA_PER_RAD^2 * T + ODOM_HEADING_SIGMA_PER_FT^2 * S
+    var_xy      = ODOM_POS_SIGMA_PER_FT^2 * S + var_heading * S^2 / 3
+  (the last term is a random-walk heading error swept over the path).
+
+  integrate() runs in the sampler ISR; reset() and pose() take a short
+  ATOMIC_BLOCK. Without ENABLE_ENCODER_SAMPLER, main calls integrate()
+  from the drive task instead.
+===============================================================================
+*/
+
+class Odometry {
+public:
+  // One encoder sample: absolute signed counts, forward positive. The first
+  // sample after reset() only primes the deltas.
+  void integrate(int32_t left_count, int32_t right_count);
+
+  // New pose; the integrator keeps its last counts, so no sample is lost
+  void reset(const PoseReset& pose);
+
+  // Current pose in feet / degrees with its sigmas
+  PoseState pose() const;
+
+private:
+  static void cosSin_(uint32_t angle, int16_t& c, int16_t& s);
+
+  bool _primed = false;
+  int32_t _last_left = 0;
+  int32_t _last_right = 0;
+
+  int32_t _diff = 0;              // (R - L) counts since reset
+  uint32_t _heading0 = 0;         // binary angle at reset
+
+  int64_t _x_acc = 0;             // half-counts * Q15 cosine
+  int64_t _y_acc = 0;
+  uint32_t _travel_counts = 0;    // sum |dL| + |dR| (saturating)
+  uint32_t _turn_counts = 0;      // sum |dR - dL|   (saturating)
+
+  float _x0_ft = 0.0f;
+  float _y0_ft = 0.0f;
+};
@@ -0,0 +1,73 @@
+#include "sensors/QuadratureEncoder.h"
+
+#include <avr/interrupt.h>
+
+#include "utils/ScopeMarker.h"
+
+/*
+===============================================================================
+  QuadratureEncoder.cpp
+===============================================================================
+
+  One vector per external interrupt line; each forwards, at compile time,
+  to the encoder whose pin sits on that line. At the drive encoders' top
+  speed this runs several thousand times a second per channel, so the
+  body is kept to the port reads, the table step and the stamp.
+
+  Lines no encoder owns get an empty vector that is never unmasked.
+===============================================================================
+*/
+
+namespace quadrature {
+
+// Encoder library order: 1, 7, 8, 14 = +1; 2, 4, 11, 13 = -1;
+// 3, 12 = +2 and 6, 9 = -2 (both channels moved: only A interrupts).
+const int8_t STEP[16] = {
+   0, +1, -1, +2,
+  -1,  0, -2, +1,
+  +1, -2,  0, -1,
+  +2, -1, +1,  0,
+};
+
+void enableExtInt(int8_t n) {
+  if (n < 0 || n > 7) return;
+  const uint8_t mask = (uint8_t)(1u << n);
+  if (n < 4) {
+    const uint8_t shift = (uint8_t)(2 * n);
+    EICRA = (uint8_t)((EICRA & ~(3u << shift)) | (1u << shift));        // ISCn = 01: any edge
+  } else {
+    const uint8_t shift = (uint8_t)(2 * (n - 4));
+    EICRB = (uint8_t)((EICRB & ~(3u << shift)) | (1u << shift));
+  }
+  EIFR = mask;     // drop an edge latched before begin
+  EIMSK |= mask;
+}
+
+}  // namespace quadrature
+
+namespace {
+
+template <int8_t N>
+constexpr uint8_t owners() {
+  return (uint8_t)(LhsDriveEncoder::ownsInt(N) + RhsDriveEncoder::ownsInt(N) +
+                   LhsArmEncoder::ownsInt(N) + RhsArmEncoder::ownsInt(N));
+}
+
+template <int8_t N>
+inline void extIntEdge() {
+  static_assert(owners<N>() <= 1, "two encoders on one external interrupt");
+  ScopeSpan mark(ScopeMark::ENCODER_ISR);
+  if (LhsDriveEncoder::ownsInt(N)) LhsDriveEncoder::edge();
+  else if (RhsDriveEncoder::ownsInt(N)) RhsDriveEncoder::edge();
+  else if (LhsArmEncoder::ownsInt(N)) LhsArmEncoder::edge();
+  else if (RhsArmEncoder::ownsInt(N)) RhsArmEncoder::edge();
+}
+
+}  // namespace
+
+ISR(INT0_vect) { extIntEdge<0>(); }
+ISR(INT1_vect) { extIntEdge<1>(); }
+ISR(INT2_vect) { extIntEdge<2>(); }
+ISR(INT3_vect) { extIntEdge<3>(); }
+ISR(INT4_vect) { extIntEdge<4>(); }
+ISR(INT5_vect) { extIntEdge<5>(); }
@@ -0,0 +1,170 @@
+#pragma once
+#include <Arduino.h>
+#include <avr/io.h>
+#include <util/atomic.h>
+
+#include "Pins.h"
+
+/*
+===============================================================================
+  QuadratureEncoder.h
+===============================================================================
+
+  PURPOSE
+  -------
+  The ISR side of EncoderSensor / EncoderSensorFx for the four project
+  encoders, replacing the Encoder library's generic dispatch
+  (attachInterrupt -> isrN -> update(arg) through pin register pointers).
+
+  Everything about a channel is a template argument, so each edge handler
+  compiles to:
+    - two direct PINx reads (sbic on a fixed port bit, no pointer loads)
+    - one 16-entry table lookup: (old AB, new AB) -> -2..+2, branch-free;
+      same table as the Encoder library, so counts are bit-identical
+      (including the +/-2 steps of the single-interrupt arm encoders)
+    - micros() for the velocity edge stamp, only when the count moved
+  and sits directly on its INTn vector (sensors/QuadratureEncoder.cpp), so
+  there is no attachInterrupt table or indirect call either.
+
+  The vectors are chosen at compile time from the pins in Pins.h: channel
+  A always has an external interrupt, channel B too on the drive encoders
+  (x4), a plain GPIO on the arm encoders (read on A edges only).
+
+  OWNERSHIP
+  ---------
+  This file owns INT0..INT5. Nothing else may attachInterrupt() on the
+  Mega's external interrupt pins (2, 3, 18..21): the Arduino core's
+  WInterrupts vectors would collide with these at link time.
+===============================================================================
+*/
+
+// Count + edge stamp written by one encoder's ISR
+struct QuadratureCounter {
+  volatile int32_t count = 0;
+  volatile uint32_t edge_us = 0;    // micros() of the latest counted edge
+  volatile uint8_t state = 0;       // last AB (bit 0 = A, bit 1 = B)
+
+  int32_t read() const {
+    int32_t c;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { c = count; }
+    return c;
+  }
+
+  // Count and its edge stamp from one critical section
+  int32_t read(uint32_t* stamp_us) const {
+    int32_t c;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+      c = count;
+      *stamp_us = edge_us;
+    }
+    return c;
+  }
+
+  void write(int32_t c) {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { count = c; }
+  }
+};
+
+// What EncoderSensor binds to: the counter and the pin/vector setup
+struct QuadratureChannel {
+  QuadratureCounter* counter;
+  void (*begin)();
+};
+
+namespace quadrature {
+
+/*=== Mega 2560 pin map (only the pins an encoder may use) ===*/
+
+enum Port : uint8_t { NO_PORT = 0, PORT_A, PORT_D, PORT_E };
+
+constexpr Port pinPort(uint8_t pin) {
+  return (pin == 2 || pin == 3) ? PORT_E
+       : (pin >= 18 && pin <= 21) ? PORT_D
+       : (pin >= 22 && pin <= 29) ? PORT_A
+       : NO_PORT;
+}
+
+constexpr uint8_t pinBit(uint8_t pin) {
+  return (pin == 2) ? 4 : (pin == 3) ? 5
+       : (pin >= 18 && pin <= 21) ? (uint8_t)(21 - pin)
+       : (uint8_t)(pin - 22);
+}
+
+// AVR external interrupt line (INTn), -1 if none
+constexpr int8_t pinExtInt(uint8_t pin) {
+  return (pin == 2) ? 4 : (pin == 3) ? 5
+       : (pin >= 18 && pin <= 21) ? (int8_t)(21 - pin)
+       : -1;
+}
+
+template <uint8_t PIN>
+inline uint8_t readPin() {
+  static_assert(pinPort(PIN) != NO_PORT, "encoder pin not in the QuadratureEncoder pin map");
+  constexpr uint8_t bit = pinBit(PIN);
+  if constexpr (pinPort(PIN) == PORT_E) return (uint8_t)((PINE >> bit) & 1u);
+  else if constexpr (pinPort(PIN) == PORT_D) return (uint8_t)((PIND >> bit) & 1u);
+  else return (uint8_t)((PINA >> bit) & 1u);
+}
+
+// Index: old A | old B << 1 | new A << 2 | new B << 3 (Encoder library order)
+extern const int8_t STEP[16];
+
+// Any-edge sense on INTn, flag cleared, then unmasked
+void enableExtInt(int8_t n);
+
+}  // namespace quadrature
+
+
+template <uint8_t PIN_A, uint8_t PIN_B>
+class QuadratureEncoder {
+public:
+  static_assert(quadrature::pinExtInt(PIN_A) >= 0, "encoder channel A needs an external interrupt");
+
+  static constexpr int8_t INT_A = quadrature::pinExtInt(PIN_A);
+  static constexpr int8_t INT_B = quadrature::pinExtInt(PIN_B);   // -1: read on A edges only
+
+  // INTn vector body
+  static inline void edge() {
+    const uint8_t ab = (uint8_t)(quadrature::readPin<PIN_A>() | (quadrature::readPin<PIN_B>() << 1));
+    const uint8_t s = (uint8_t)(_c.state | (ab << 2));
+    _c.state = ab;
+    const int8_t step = quadrature::STEP[s];
+    if (step) {
+      _c.count = _c.count + step;
+      _c.edge_us = micros();
+    }
+  }
+
+  // Pull-ups, initial AB, vectors armed. Idempotent.
+  static void begin() {
+    if (_begun) return;
+    _begun = true;
+
+    pinMode(PIN_A, INPUT_PULLUP);
+    pinMode(PIN_B, INPUT_PULLUP);
+    delayMicroseconds(2000);   // let an R-C filter charge through the pull-ups
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+      _c.state = (uint8_t)(quadrature::readPin<PIN_A>() | (quadrature::readPin<PIN_B>() << 1));
+      quadrature::enableExtInt(INT_A);
+      if (INT_B >= 0) quadrature::enableExtInt(INT_B);
+    }
+  }
+
+  static QuadratureCounter& counter() { return _c; }
+  static constexpr QuadratureChannel channel() { return { &_c, &begin }; }
+
+  // Does INTn belong to this encoder?
+  static constexpr bool ownsInt(int8_t n) { return n == INT_A || (INT_B >= 0 && n == INT_B); }
+
+private:
+  static inline QuadratureCounter _c;
+  static inline bool _begun = false;
+};
+
+/*=== Project encoders (Pins.h) ===*/
+
+using LhsDriveEncoder = QuadratureEncoder<PIN_ENC_LHS_DRIVE_A, PIN_ENC_LHS_DRIVE_B>;
+using RhsDriveEncoder = QuadratureEncoder<PIN_ENC_RHS_DRIVE_A, PIN_ENC_RHS_DRIVE_B>;
+using LhsArmEncoder   = QuadratureEncoder<PIN_ENC_LHS_ARM_A, PIN_ENC_LHS_ARM_B>;
+using RhsArmEncoder   = QuadratureEncoder<PIN_ENC_RHS_ARM_A, PIN_ENC_RHS_ARM_B>;
@@ -0,0 +1,159 @@
+#include "sensors/RangeFilter.h"
+
+/*
+===============================================================================
+  RangeFilter.cpp
+===============================================================================
+
+  Kalman model (state x = [distance, rate], one ping apart by dt):
+    F = [1 dt; 0 1]
+    Q = a^2 [dt^4/4  dt^3/2; dt^3/2  dt^2]    (white-noise acceleration)
+    H = [1 0],  R = ULTRASONIC_MEAS_SIGMA_IN^2
+  A missed ping only predicts, so the distance keeps following a closing
+  target and the gate widens until the next echo lands.
+===============================================================================
+*/
+
+static_assert(ULTRASONIC_MEDIAN_N >= 1 && ULTRASONIC_MEDIAN_N <= 9 && (ULTRASONIC_MEDIAN_N & 1),
+              "ULTRASONIC_MEDIAN_N must be odd, 1..9");
+
+namespace {
+
+constexpr float R_MEAS = ULTRASONIC_MEAS_SIGMA_IN * ULTRASONIC_MEAS_SIGMA_IN;
+constexpr float Q_ACCEL = ULTRASONIC_ACCEL_SIGMA_INPS2 * ULTRASONIC_ACCEL_SIGMA_INPS2;
+constexpr float INIT_RATE_VAR = 30.0f * 30.0f;   // (in/s)^2: anything a robot does
+constexpr float MEDIAN_RATE_ALPHA = 0.3f;        // median-only rate smoothing
+
+uint8_t popcount8(uint8_t v) {
+  uint8_t n = 0;
+  for (; v; v &= (uint8_t)(v - 1)) n++;
+  return n;
+}
+
+}  // namespace
+
+
+void RangeFilter::reset() {
+  *this = RangeFilter();
+}
+
+void RangeFilter::update(uint32_t now_ms, bool valid, float raw_in) {
+  // A track nobody has confirmed for a while is gone, and so is its ring
+  if (_track && (now_ms - _accept_ms) > ULTRASONIC_TRACK_TIMEOUT_MS) {
+    _track = false;
+    _ring_n = 0;
+  }
+
+  const float dt_s = (float)(now_ms - _t_ms) * 0.001f;
+  bool accepted = false;
+
+  if (valid) {
+    _ring[_ring_pos] = raw_in;
+    _ring_pos = (uint8_t)((_ring_pos + 1) % MEDIAN_N);
+    if (_ring_n < MEDIAN_N) _ring_n++;
+  }
+
+  if (!_track) {
+    if (valid) {
+      restart_(now_ms, raw_in);
+      accepted = true;
+    }
+  } else if (ULTRASONIC_KALMAN_ENABLE) {
+    predict_(dt_s);
+    _t_ms = now_ms;
+
+    if (valid) {
+      if (correct_(raw_in)) {
+        _outliers = 0;
+        accepted = true;
+      } else {
+        if (_rejected < 0xFFFF) _rejected++;
+        if (++_outliers >= ULTRASONIC_OUTLIER_RESET) {
+          restart_(now_ms, median_());
+          accepted = true;
+        }
+      }
+    }
+  } else if (valid) {
+    const float med = median_();
+    if (dt_s > 0.0f) _v += MEDIAN_RATE_ALPHA * ((med - _d) / dt_s - _v);
+    _d = med;
+    _t_ms = now_ms;
+    accepted = true;
+  }
+
+  if (accepted) _accept_ms = now_ms;
+  publish_(now_ms, accepted);
+}
+
+float RangeFilter::median_() const {
+  float v[MEDIAN_N];
+  const uint8_t n = _ring_n;
+  for (uint8_t i = 0; i < n; i++) {
+    // insertion sort: at most 9 entries
+    const float x = _ring[i];
+    uint8_t j = i;
+    for (; j > 0 && v[j - 1] > x; j--) v[j] = v[j - 1];
+    v[j] = x;
+  }
+  return v[n / 2];
+}
+
+void RangeFilter::restart_(uint32_t now_ms, float d_in) {
+  if (_track && _restarts < 0xFFFF) _restarts++;
+  _track = true;
+  _d = d_in;
+  _v = 0.0f;
+  _p00 = R_MEAS;
+  _p01 = 0.0f;
+  _p11 = INIT_RATE_VAR;
+  _t_ms = now_ms;
+  _outliers = 0;
+}
+
+void RangeFilter::predict_(float dt_s) {
+  if (dt_s <= 0.0f) return;
+
+  const float dt2 = dt_s * dt_s;
+  _d += _v * dt_s;
+  if (_d < 0.0f) _d = 0.0f;
+
+  // P = F P F' + Q
+  const float p00 = _p00 + dt_s * (2.0f * _p01 + dt_s * _p11) + Q_ACCEL * dt2 * dt2 * 0.25f;
+  const float p01 = _p01 + dt_s * _p11 + Q_ACCEL * dt2 * dt_s * 0.5f;
+  _p11 += Q_ACCEL * dt2;
+  _p00 = p00;
+  _p01 = p01;
+}
+
+bool RangeFilter::correct_(float z_in) {
+  const float s = _p00 + R_MEAS;
+  const float y = z_in - _d;
+
+  // |y| > k * sqrt(S), compared squared
+  const float gate = ULTRASONIC_GATE_SIGMA * ULTRASONIC_GATE_SIGMA * s;
+  if (y * y > gate && fabsf(y) > ULTRASONIC_GATE_MIN_IN) return false;
+
+  const float k0 = _p00 / s;
+  const float k1 = _p01 / s;
+  _d += k0 * y;
+  _v += k1 * y;
+
+  _p11 -= k1 * _p01;
+  _p00 -= k0 * _p00;
+  _p01 -= k0 * _p01;
+  return true;
+}
+
+void RangeFilter::publish_(uint32_t now_ms, bool accepted) {
+  _hist = (uint8_t)((_hist << 1) | (accepted ? 1 : 0));
+
+  _out.valid = _track && (now_ms - _accept_ms) <= ULTRASONIC_TRACK_TIMEOUT_MS;
+  if (!_out.valid) {
+    _out = Output();
+    return;
+  }
+  _out.distance_in = _d;
+  _out.closing_inps = -_v;
+  _out.confidence = (float)popcount8(_hist) * 0.125f;
+}
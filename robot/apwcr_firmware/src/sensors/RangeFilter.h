@@ -0,0 +1,83 @@
+#pragma once
+#include <Arduino.h>
+#include <math.h>  // NAN
+
+#include "Params.h"
+
+/*
+===============================================================================
+  RangeFilter.h
+===============================================================================
+
+  PURPOSE
+  -------
+  Turns the raw HC-SR04 echo stream (one reading per ping, some of them
+  timeouts, ghosts off the floor or a second reflection) into a distance,
+  closing rate and confidence the firmware can act on by itself.
+
+    - Every valid echo goes into a ULTRASONIC_MEDIAN_N ring; its median is
+      the robust fallback value
+    - ULTRASONIC_KALMAN_ENABLE: a constant-velocity Kalman filter
+      (distance, rate) is updated with each raw echo, so the output does
+      not carry the median's lag. An echo whose innovation is beyond
+      ULTRASONIC_GATE_SIGMA (never tighter than ULTRASONIC_GATE_MIN_IN) is
+      rejected; ULTRASONIC_OUTLIER_RESET rejects in a row means the scene
+      really changed, and the track restarts at the ring median
+    - Without the Kalman filter the output is the median itself and the
+      rate a smoothed difference of medians
+    - confidence = share of the last 8 pings that were accepted
+    - valid until ULTRASONIC_TRACK_TIMEOUT_MS without an accepted echo
+
+  Runs once per ping (15 Hz), so float math is fine here.
+===============================================================================
+*/
+
+class RangeFilter {
+public:
+  static constexpr uint8_t MEDIAN_N = ULTRASONIC_MEDIAN_N;
+
+  struct Output {
+    float distance_in = NAN;
+    float closing_inps = 0.0f;  // positive = target getting closer
+    float confidence = 0.0f;    // 0..1
+    bool  valid = false;
+  };
+
+  void reset();
+
+  // One finished ping: valid = false for a timeout / out-of-range echo
+  void update(uint32_t now_ms, bool valid, float raw_in);
+
+  const Output& output() const { return _out; }
+
+  uint16_t rejected() const { return _rejected; }   // gated-out echoes
+  uint16_t restarts() const { return _restarts; }
+
+private:
+  float median_() const;
+  void restart_(uint32_t now_ms, float d_in);
+  void predict_(float dt_s);
+  bool correct_(float z_in);    // false = gated out
+  void publish_(uint32_t now_ms, bool accepted);
+
+  // Raw echo ring (valid readings only)
+  float _ring[MEDIAN_N] = {};
+  uint8_t _ring_n = 0;
+  uint8_t _ring_pos = 0;
+
+  // Track: distance (in), rate (in/s, d/dt of distance), covariance
+  bool _track = false;
+  float _d = 0.0f;
+  float _v = 0.0f;
+  float _p00 = 0.0f, _p01 = 0.0f, _p11 = 0.0f;
+  uint32_t _t_ms = 0;           // time of _d / _v
+  uint32_t _accept_ms = 0;      // last accepted echo
+
+  uint8_t _outliers = 0;        // consecutive rejects
+  uint8_t _hist = 0;            // bit per ping, newest in bit 0: accepted
+
+  uint16_t _rejected = 0;
+  uint16_t _restarts = 0;
+
+  Output _out;
+};
@@ -0,0 +1,31 @@
+#include "utils/EventLog.h"
+
+/*
+===============================================================================
+  EventLog.cpp
+===============================================================================
+*/
+
+static_assert(sizeof(EventRecord) == 10, "EventRecord layout changed");
+static_assert(EVENT_LOG_CHUNK_RECORDS <= EVENT_LOG_RECORDS, "EVENT_LOG_CHUNK_RECORDS past the ring");
+
+EventLog g_event_log;
+
+bool EventLog::chunk(uint16_t first, uint16_t end, EventLogChunk& out) const {
+  const uint16_t oldest = this->oldest();
+  if ((int16_t)(first - oldest) < 0) first = oldest;
+  if ((int16_t)(_written - end) < 0) end = _written;
+  if ((int16_t)(end - first) <= 0) return false;
+
+  // Up to the end of the storage; the rest comes from index 0 next time
+  const uint8_t at = (uint8_t)(first & MASK);
+  uint16_t n = (uint16_t)(end - first);
+  if (n > (uint16_t)(CAPACITY - at)) n = (uint16_t)(CAPACITY - at);
+  if (n > EVENT_LOG_CHUNK_RECORDS) n = EVENT_LOG_CHUNK_RECORDS;
+
+  out.first = first;
+  out.end = end;
+  out.count = (uint8_t)n;
+  out.records = &_ring[at];
+  return true;
+}
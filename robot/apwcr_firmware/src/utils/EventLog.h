@@ -0,0 +1,110 @@
+#pragma once
+
+#include <Arduino.h>
+#include <math.h>
+
+#include "Params.h"
+#include "comms/Messages.h"
+
+/*
+===============================================================================
+  EventLog.h
+===============================================================================
+
+  PURPOSE
+  -------
+  Post-mortem history: the last EVENT_LOG_RECORDS events (EventRecord:
+  time, EventId, two int16 args) in a RAM ring, written from any module
+  with logEvent() and read back by the host with a "log" dump. The debug
+  note only keeps the newest message for 1.5 s; this keeps the sequence.
+
+  - Writing is a handful of stores: no formatting, no flash strings, no
+    link. What the args mean per id is listed with EventId
+    (comms/Messages.h)
+  - An event with the same id as the newest record folds into it (count
+    goes up, the args become the latest), so a 20 Hz stream of commands
+    takes one record, not the whole ring; the record keeps the time of
+    the first one
+  - When full, the oldest record is overwritten
+  - Records are numbered from boot (mod 2^16, clear() doesn't restart
+    them). A dump reads [oldest(), written()) as it was at the request in
+    chunks that point into the ring, so nothing is copied; whatever is
+    overwritten before its chunk goes out is skipped (a gap in the numbers)
+
+  Main loop context only (tasks, not ISRs): a record is several stores.
+  One ring for the whole firmware (g_event_log, EventLog.cpp).
+
+  USAGE
+  -----
+    logEvent(now_ms, EventId::SERVO_DETACH, pin, ddeg);
+    dump:  end = g_event_log.written(); n = g_event_log.oldest();
+           while (g_event_log.chunk(n, end, c)) { send(c); n = c.first + c.count; }
+===============================================================================
+*/
+
+class EventLog {
+public:
+  static constexpr uint8_t CAPACITY = EVENT_LOG_RECORDS;
+  static_assert(CAPACITY && (CAPACITY & (CAPACITY - 1)) == 0, "EVENT_LOG_RECORDS must be a power of two");
+
+  void log(uint32_t now_ms, EventId id, int16_t a, int16_t b) {
+    EventRecord& last = _ring[(uint16_t)(_written - 1) & MASK];
+    if (_held && last.id == (uint8_t)id && last.count < 0xFF) {
+      last.count++;
+      last.a = a;
+      last.b = b;
+      return;
+    }
+
+    EventRecord& r = _ring[_written & MASK];
+    r.t_ms = now_ms;
+    r.id = (uint8_t)id;
+    r.count = 1;
+    r.a = a;
+    r.b = b;
+    _written++;
+    if (_held < CAPACITY) _held++;
+  }
+
+  // Drops every record (the numbering carries on)
+  void clear() { _held = 0; }
+
+  // Number the next record will get
+  uint16_t written() const { return _written; }
+
+  // Number of the oldest record held (== written() when empty)
+  uint16_t oldest() const { return (uint16_t)(_written - _held); }
+  uint8_t held() const { return _held; }
+
+  // Held records from `first` up to `end`: at most EVENT_LOG_CHUNK_RECORDS,
+  // contiguous in the ring. A `first` already overwritten starts at
+  // oldest() instead (out.first says where). false = none left before end.
+  bool chunk(uint16_t first, uint16_t end, EventLogChunk& out) const;
+
+private:
+  static constexpr uint16_t MASK = CAPACITY - 1;
+
+  EventRecord _ring[CAPACITY];
+  uint16_t _written = 0;
+  uint8_t _held = 0;
+};
+
+extern EventLog g_event_log;
+
+inline void logEvent(uint32_t now_ms, EventId id, int16_t a = 0, int16_t b = 0) {
+  g_event_log.log(now_ms, id, a, b);
+}
+
+// Record args: saturated to int16; the float one scaled and rounded, with
+// `none` for NAN (INFINITY saturates)
+inline int16_t eventArg(int32_t v) {
+  return (v > INT16_MAX) ? INT16_MAX : (v < INT16_MIN) ? INT16_MIN : (int16_t)v;
+}
+
+inline int16_t eventArgScaled(float v, float scale, int16_t none = 0) {
+  if (isnan(v)) return none;
+  const float x = v * scale;
+  if (x >= (float)INT16_MAX) return INT16_MAX;
+  if (x <= (float)INT16_MIN) return INT16_MIN;
+  return (int16_t)lroundf(x);
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <Arduino.h>
+#include <string.h>
+
+/*
+===============================================================================
+  Fixed.h
+===============================================================================
+
+  PURPOSE
+  -------
+  Q16.16 fixed-point number for the control paths (the ATmega2560 has no
+  FPU: a float multiply is ~100+ cycles, a float divide several hundred).
+
+  Fixed
+    - int32_t raw, value = raw / 65536
+    - range +/-32768, resolution 1.5e-5
+    - + - and compares are plain integer ops
+    - * uses one 32x32->64 widening multiply (avr-gcc: __mulsidi3)
+    - no operator/ on purpose: divide by precomputing a reciprocal
+
+  Q0.32 scale factors
+    Conversion constants much smaller than 1 (1 / COUNTS_PER_WHEEL_REV,
+    FEET_PER_COUNT) lose most of their precision in Q16.16, so they are kept
+    as unsigned Q0.32 raw values (value = raw / 2^32) in Params.h and applied
+    with scaleQ32(count, k) -> Fixed.
+
+  Everything that can be constexpr is, so constants derived from Params.h
+  are folded at compile time.
+===============================================================================
+*/
+
+class Fixed {
+public:
+  static constexpr uint8_t FRAC_BITS = 16;
+  static constexpr int32_t ONE_RAW = (int32_t)1 << FRAC_BITS;
+
+  constexpr Fixed() : _raw(0) {}
+
+  static constexpr Fixed fromRaw(int32_t raw) { return Fixed(raw, RawTag()); }
+  static constexpr Fixed fromInt(int32_t v) { return Fixed(v * ONE_RAW, RawTag()); }
+  static constexpr Fixed fromFloat(float v) {
+    return Fixed((int32_t)(v * (float)ONE_RAW + (v >= 0.0f ? 0.5f : -0.5f)), RawTag());
+  }
+
+  constexpr int32_t raw() const { return _raw; }
+
+  float toFloat() const { return (float)_raw * (1.0f / (float)ONE_RAW); }
+
+  // Floor (toward -inf) and round-half-up
+  constexpr int32_t toInt() const { return _raw >> FRAC_BITS; }
+  constexpr int32_t roundToInt() const { return (_raw + (ONE_RAW / 2)) >> FRAC_BITS; }
+
+  constexpr Fixed operator-() const { return fromRaw(-_raw); }
+  constexpr Fixed operator+(Fixed o) const { return fromRaw(_raw + o._raw); }
+  constexpr Fixed operator-(Fixed o) const { return fromRaw(_raw - o._raw); }
+
+  Fixed operator*(Fixed o) const { return fromRaw(mulShift(_raw, o._raw)); }
+
+  // Multiply by a plain integer (no shift needed)
+  constexpr Fixed operator*(int32_t k) const { return fromRaw(_raw * k); }
+
+  Fixed& operator+=(Fixed o) { _raw += o._raw; return *this; }
+  Fixed& operator-=(Fixed o) { _raw -= o._raw; return *this; }
+  Fixed& operator*=(Fixed o) { _raw = mulShift(_raw, o._raw); return *this; }
+
+  constexpr bool operator==(Fixed o) const { return _raw == o._raw; }
+  constexpr bool operator!=(Fixed o) const { return _raw != o._raw; }
+  constexpr bool operator<(Fixed o) const { return _raw < o._raw; }
+  constexpr bool operator<=(Fixed o) const { return _raw <= o._raw; }
+  constexpr bool operator>(Fixed o) const { return _raw > o._raw; }
+  constexpr bool operator>=(Fixed o) const { return _raw >= o._raw; }
+
+  // (a * b) >> 16 with a 64-bit intermediate. The shift is done by taking
+  // bytes 2..5 of the product: a 64-bit shift is a slow loop on AVR.
+  static int32_t mulShift(int32_t a, int32_t b) {
+    const int64_t p = (int64_t)a * (int64_t)b;
+    int32_t r;
+    memcpy(&r, (const uint8_t*)&p + 2, sizeof(r));   // little-endian
+    return r;
+  }
+
+private:
+  struct RawTag {};
+  constexpr Fixed(int32_t raw, RawTag) : _raw(raw) {}
+
+  int32_t _raw;
+};
+
+namespace fx {
+
+constexpr Fixed ZERO = Fixed();
+constexpr Fixed ONE = Fixed::fromRaw(Fixed::ONE_RAW);
+
+// Q0.32 raw value for v in [0, 1)
+constexpr uint32_t q32(float v) {
+  return (uint32_t)(v * 4294967296.0f + 0.5f);
+}
+
+// x * (k / 2^32) as Q16.16: (x * k) >> 16
+inline Fixed scaleQ32(int32_t x, uint32_t k_q32) {
+  // k < 2^31 for every scale we use, so a signed widening multiply is safe
+  return Fixed::fromRaw(Fixed::mulShift(x, (int32_t)k_q32));
+}
+
+inline Fixed abs(Fixed v) { return (v.raw() < 0) ? -v : v; }
+
+inline Fixed clamp(Fixed v, Fixed lo, Fixed hi) {
+  if (v < lo) return lo;
+  if (v > hi) return hi;
+  return v;
+}
+
+}  // namespace fx
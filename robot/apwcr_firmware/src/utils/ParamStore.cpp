@@ -0,0 +1,285 @@
+#include "utils/ParamStore.h"
+
+#include <avr/eeprom.h>
+#include <avr/pgmspace.h>
+#include <math.h>     // isfinite, lroundf
+#include <stddef.h>   // offsetof
+
+#include "comms/BinaryProtocol.h"   // crc16
+
+/*
+===============================================================================
+  ParamStore.cpp
+===============================================================================
+
+  The registry is a flash table, one row per tunable. A row's name is the
+  stringified Params.h constant and its default is that constant, so
+  adding a parameter is one TuningParams field plus one PARAM_* row (and a
+  PARAM_STORE_VERSION bump).
+
+  Ranges are the safe envelope, not the useful one: the speed limits can
+  only go down from their Params.h values, and the ultrasonic rate stops
+  where a slot would no longer outlast the echo timeout.
+===============================================================================
+*/
+
+namespace {
+
+enum class ParamType : uint8_t { F32 = 0, U16 };
+
+struct ParamDef {
+  char name[PARAM_NAME_BYTES];
+  uint8_t offset;               // into TuningParams
+  ParamType type;
+  float min;
+  float max;
+  float def;
+};
+
+#define PARAM_F32(NAME, field, lo, hi) \
+  { #NAME, (uint8_t)offsetof(TuningParams, field), ParamType::F32, (lo), (hi), (float)(NAME) }
+#define PARAM_U16(NAME, field, lo, hi) \
+  { #NAME, (uint8_t)offsetof(TuningParams, field), ParamType::U16, (lo), (hi), (float)(NAME) }
+
+constexpr ParamDef PARAM_DEFS[] PROGMEM = {
+  PARAM_F32(DRIVE_KP,                drive_kp,                0.0f, 10.0f),
+  PARAM_F32(DRIVE_KI,                drive_ki,                0.0f, 10.0f),
+  PARAM_F32(DRIVE_KD,                drive_kd,                0.0f, 2.0f),
+  PARAM_F32(DRIVE_INTEGRAL_LIMIT,    drive_integral_limit,    0.0f, 200.0f),
+  PARAM_F32(MAX_LINEAR_SPEED_FTPS,   max_linear_ftps,         0.0f, MAX_LINEAR_SPEED_FTPS),
+  PARAM_F32(MAX_ANGULAR_SPEED_DPS,   max_angular_dps,         0.0f, MAX_ANGULAR_SPEED_DPS),
+  PARAM_F32(DRIVE_FF_KS,             drive_ff_ks,             0.0f, 0.5f),
+  PARAM_F32(DRIVE_FF_KV,             drive_ff_kv,             0.0f, 2.0f),
+  PARAM_F32(DRIVE_ACCEL_FTPS2,       drive_accel_ftps2,       0.5f, 50.0f),
+  PARAM_F32(DRIVE_DECEL_FTPS2,       drive_decel_ftps2,       0.5f, 50.0f),
+
+  PARAM_F32(ARM_KP,                  arm_kp,                  0.0f, 20.0f),
+  PARAM_F32(ARM_KI,                  arm_ki,                  0.0f, 10.0f),
+  PARAM_F32(ARM_KD,                  arm_kd,                  0.0f, 5.0f),
+  PARAM_F32(ARM_INTEGRAL_LIMIT,      arm_integral_limit,      0.0f, 500.0f),
+
+  PARAM_F32(LID_SERVO_RAMP_DPS,      lid_ramp_dps,            1.0f, 180.0f),
+  PARAM_F32(SWEEP_SERVO_RAMP_DPS,    sweep_ramp_dps,          1.0f, 180.0f),
+
+  PARAM_F32(ULTRASONIC_MIN_IN,       ultrasonic_min_in,       0.5f, 24.0f),
+  PARAM_F32(ULTRASONIC_MAX_VALID_IN, ultrasonic_max_valid_in, 6.0f, ULTRASONIC_MAX_RANGE_IN),
+  PARAM_U16(ULTRASONIC_UPDATE_HZ,    ultrasonic_hz,           1.0f, (float)ULTRASONIC_MAX_UPDATE_HZ),
+  PARAM_U16(SEQUENCER_UPDATE_HZ,     sequencer_hz,            5.0f, 200.0f),
+
+  PARAM_U16(ENABLE_IDLE_SLEEP,       idle_sleep,              0.0f, 1.0f),
+};
+
+#undef PARAM_F32
+#undef PARAM_U16
+
+constexpr uint8_t PARAM_COUNT = sizeof(PARAM_DEFS) / sizeof(PARAM_DEFS[0]);
+constexpr uint16_t PARAM_MAGIC = 0x5052;   // "RP" in EEPROM byte order
+
+constexpr bool defaultsInRange() {
+  for (uint8_t i = 0; i < PARAM_COUNT; i++) {
+    if (!(PARAM_DEFS[i].def >= PARAM_DEFS[i].min && PARAM_DEFS[i].def <= PARAM_DEFS[i].max)) return false;
+  }
+  return true;
+}
+
+static_assert(PARAM_COUNT < PARAM_NO_INDEX, "too many parameters for a u8 index");
+static_assert(defaultsInRange(), "a Params.h default is outside its tunable range");
+static_assert(sizeof(TuningParams) <= 0xFF, "TuningParams offsets are u8");
+
+ParamDef paramDef(uint8_t i) {
+  ParamDef d;
+  memcpy_P(&d, &PARAM_DEFS[i], sizeof(d));
+  return d;
+}
+
+float loadValue(const TuningParams& p, const ParamDef& d) {
+  const uint8_t* at = (const uint8_t*)&p + d.offset;
+  if (d.type == ParamType::U16) {
+    uint16_t u;
+    memcpy(&u, at, sizeof(u));
+    return (float)u;
+  }
+  float f;
+  memcpy(&f, at, sizeof(f));
+  return f;
+}
+
+void storeValue(TuningParams& p, const ParamDef& d, float v) {
+  uint8_t* at = (uint8_t*)&p + d.offset;
+  if (d.type == ParamType::U16) {
+    const uint16_t u = (uint16_t)lroundf(v);
+    memcpy(at, &u, sizeof(u));
+  } else {
+    memcpy(at, &v, sizeof(v));
+  }
+}
+
+bool inRange(const ParamDef& d, float v) {
+  return isfinite(v) && v >= d.min && v <= d.max;
+}
+
+}  // namespace
+
+
+uint8_t ParamStore::count() {
+  return PARAM_COUNT;
+}
+
+const char* ParamStore::sourceName(Source s) {
+  return (s == Source::EEPROM) ? "eeprom" : "defaults";
+}
+
+void ParamStore::begin() {
+  static_assert(PARAM_EEPROM_ADDR + sizeof(Image) <= (uint32_t)E2END + 1,
+                "parameter image does not fit the EEPROM");
+  static_assert(sizeof(Image) == sizeof(Header) + sizeof(TuningParams), "Image must not be padded");
+
+  _source = readImage_(_staged) ? Source::EEPROM : Source::DEFAULTS;
+  if (_source == Source::DEFAULTS) defaults_(_staged);
+
+  _active = _staged;
+  _dirty = false;
+  _save_pos = _save_len = 0;
+}
+
+bool ParamStore::applyPending() {
+  if (!_dirty) return false;
+  _dirty = false;
+  _active = _staged;
+  return true;
+}
+
+void ParamStore::handle(const ParamRequest& req, ParamReply& reply) {
+  reply = ParamReply();
+  reply.op = req.op;
+  reply.count = PARAM_COUNT;
+
+  switch (req.op) {
+    case ParamOp::GET:
+    case ParamOp::SET: {
+      const int8_t i = find_(req);
+      if (i < 0) {
+        reply.status = ParamStatus::UNKNOWN;
+        return;
+      }
+      if (req.op == ParamOp::SET) {
+        const ParamDef d = paramDef((uint8_t)i);
+        if (inRange(d, req.value)) {
+          storeValue(_staged, d, req.value);
+          _dirty = true;
+        } else {
+          reply.status = ParamStatus::RANGE;
+        }
+      }
+      describe_((uint8_t)i, reply);
+      return;
+    }
+
+    case ParamOp::SAVE:
+      if (saving()) {
+        reply.status = ParamStatus::BUSY;
+        return;
+      }
+      _image.p = _staged;
+      _image.h.magic = PARAM_MAGIC;
+      _image.h.version = PARAM_STORE_VERSION;
+      _image.h.count = PARAM_COUNT;
+      _image.h.size = sizeof(TuningParams);
+      _image.h.crc = imageCrc_(_image);
+      _save_pos = 0;
+      _save_len = sizeof(Image);
+      _save_writes = 0;
+      return;
+
+    case ParamOp::LOAD: {
+      if (saving()) {
+        reply.status = ParamStatus::BUSY;
+        return;
+      }
+      TuningParams p;
+      if (!readImage_(p)) {
+        reply.status = ParamStatus::NO_IMAGE;
+        return;
+      }
+      _staged = p;
+      _dirty = true;
+      return;
+    }
+
+    case ParamOp::DEFAULTS:
+      defaults_(_staged);
+      _dirty = true;
+      return;
+  }
+}
+
+bool ParamStore::service() {
+  if (!saving() || !eeprom_is_ready()) return false;
+
+  // Values first, header last (see the header comment)
+  const uint8_t* src = (const uint8_t*)&_image;
+  while (_save_pos < _save_len) {
+    const uint16_t off = (_save_pos < sizeof(TuningParams))
+                           ? (uint16_t)(sizeof(Header) + _save_pos)
+                           : (uint16_t)(_save_pos - sizeof(TuningParams));
+    _save_pos++;
+
+    uint8_t* addr = (uint8_t*)(uintptr_t)(PARAM_EEPROM_ADDR + off);
+    if (eeprom_read_byte(addr) != src[off]) {
+      eeprom_write_byte(addr, src[off]);   // returns at once: the EEPROM was ready
+      _save_writes++;
+      break;
+    }
+  }
+  return !saving();
+}
+
+void ParamStore::defaults_(TuningParams& p) {
+  memset(&p, 0, sizeof(p));
+  for (uint8_t i = 0; i < PARAM_COUNT; i++) {
+    const ParamDef d = paramDef(i);
+    storeValue(p, d, d.def);
+  }
+}
+
+bool ParamStore::readImage_(TuningParams& p) {
+  Image img;
+  eeprom_read_block(&img, (const void*)(uintptr_t)PARAM_EEPROM_ADDR, sizeof(img));
+
+  if (img.h.magic != PARAM_MAGIC || img.h.version != PARAM_STORE_VERSION ||
+      img.h.count != PARAM_COUNT || img.h.size != sizeof(TuningParams) ||
+      img.h.crc != imageCrc_(img)) {
+    return false;
+  }
+
+  for (uint8_t i = 0; i < PARAM_COUNT; i++) {
+    const ParamDef d = paramDef(i);
+    if (!inRange(d, loadValue(img.p, d))) return false;
+  }
+
+  p = img.p;
+  return true;
+}
+
+uint16_t ParamStore::imageCrc_(const Image& img) {
+  const uint16_t crc = protocol::bin::crc16((const uint8_t*)&img.h, offsetof(Header, crc));
+  return protocol::bin::crc16((const uint8_t*)&img.p, sizeof(img.p), crc);
+}
+
+int8_t ParamStore::find_(const ParamRequest& req) {
+  if (req.index != PARAM_BY_NAME) return (req.index < PARAM_COUNT) ? (int8_t)req.index : -1;
+
+  for (uint8_t i = 0; i < PARAM_COUNT; i++) {
+    if (strcmp_P(req.name, PARAM_DEFS[i].name) == 0) return (int8_t)i;
+  }
+  return -1;
+}
+
+void ParamStore::describe_(uint8_t index, ParamReply& reply) const {
+  const ParamDef d = paramDef(index);
+  reply.index = index;
+  memcpy(reply.name, d.name, sizeof(reply.name));
+  reply.value = loadValue(_staged, d);
+  reply.min = d.min;
+  reply.max = d.max;
+}
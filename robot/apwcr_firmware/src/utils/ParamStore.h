@@ -0,0 +1,150 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "Params.h"
+#include "comms/Messages.h"
+
+/*
+===============================================================================
+  ParamStore.h
+===============================================================================
+
+  PURPOSE
+  -------
+  Runtime tuning without a reflash: a typed registry of the gains, limits,
+  ramps and rates worth tuning in the field, settable over the link
+  ("param" frames, see ParamRequest) and kept in EEPROM across resets.
+
+  Registry:
+    - One flash row per parameter (ParamStore.cpp): its Params.h name,
+      type, [min, max] and the Params.h constexpr as the default, so the
+      wire name is literally the constant it overrides
+    - Values live in a plain TuningParams struct: hot paths read a field
+      (or the copy a controller took in its setter), never the registry
+
+  Two copies:
+    - staged: what get / set / load / defaults act on, from taskRx
+    - live (active()): replaced from staged in one struct copy by
+      applyPending(), which main runs at the top of the drive task, so a
+      control tick never sees half a change
+    Each set goes live on the next tick by itself; gains that have to
+    change together are safest changed with the drive stopped.
+
+  EEPROM image (PARAM_EEPROM_ADDR):
+    [magic u16][version u8][count u8][size u16][crc16 u16][TuningParams]
+    crc16 (CRC-16/CCITT-FALSE, comms/BinaryProtocol) covers the first six
+    header bytes and the values. begin() boots the image only if every
+    header field matches this build (PARAM_STORE_VERSION) and each value is
+    in range; anything else boots the Params.h defaults.
+
+  Saving never blocks: "save" snapshots the staged set, then service()
+  (every loop) starts at most one byte write per call, when the EEPROM is
+  idle (~3.4 ms each), skipping bytes that already match. The values are
+  written before the header, so a reset mid-save leaves a CRC mismatch
+  (defaults at boot), never a half-new set that passes.
+
+  USAGE
+  -----
+    setup():        g_params.begin();  then push active() into the modules
+    taskRx:         g_params.handle(request, reply);  send the reply
+    drive task:     if (g_params.applyPending()) push active() again
+    every loop:     if (g_params.service()) the save just finished
+===============================================================================
+*/
+
+// Live parameter values (names in ParamStore.cpp's registry)
+struct TuningParams {
+  float drive_kp;
+  float drive_ki;
+  float drive_kd;
+  float drive_integral_limit;
+  float max_linear_ftps;
+  float max_angular_dps;
+  float drive_ff_ks;
+  float drive_ff_kv;
+  float drive_accel_ftps2;
+  float drive_decel_ftps2;
+
+  float arm_kp;
+  float arm_ki;
+  float arm_kd;
+  float arm_integral_limit;
+
+  float lid_ramp_dps;           // coordinated moves (ENABLE_MOTION_PROFILES)
+  float sweep_ramp_dps;
+
+  float ultrasonic_min_in;
+  float ultrasonic_max_valid_in;
+  uint16_t ultrasonic_hz;       // per sensor
+  uint16_t sequencer_hz;
+
+  uint16_t idle_sleep;          // 0 / 1 (utils/PowerSaver)
+};
+
+class ParamStore {
+public:
+  enum class Source : uint8_t {
+    DEFAULTS = 0,
+    EEPROM,
+  };
+
+  // Loads the EEPROM image (or the defaults) into both copies
+  void begin();
+
+  // Where the boot values came from
+  Source source() const { return _source; }
+
+  const TuningParams& active() const { return _active; }
+
+  // Registry size (indices 0 .. count-1)
+  static uint8_t count();
+
+  // get / set / save / load / defaults; reply is filled in every case
+  void handle(const ParamRequest& req, ParamReply& reply);
+
+  // Staged values go live. true = something changed (push active() out).
+  bool applyPending();
+
+  // Advances a save by at most one EEPROM byte. true once, when the save
+  // that was in progress has just been completely written.
+  bool service();
+
+  bool saving() const { return _save_pos < _save_len; }
+
+  // Bytes actually written by the last save (unchanged ones are skipped)
+  uint16_t lastSaveWrites() const { return _save_writes; }
+
+  static const char* sourceName(Source s);
+
+private:
+  struct __attribute__((packed)) Header {
+    uint16_t magic;
+    uint8_t version;
+    uint8_t count;
+    uint16_t size;
+    uint16_t crc;
+  };
+
+  struct Image {
+    Header h;
+    TuningParams p;
+  };
+
+  static void defaults_(TuningParams& p);
+  static bool readImage_(TuningParams& p);
+  static uint16_t imageCrc_(const Image& img);
+  static int8_t find_(const ParamRequest& req);
+  void describe_(uint8_t index, ParamReply& reply) const;
+
+  TuningParams _active;
+  TuningParams _staged;
+  bool _dirty = false;
+  Source _source = Source::DEFAULTS;
+
+  // Save in progress: _image bytes in write order, see service()
+  Image _image;
+  uint16_t _save_pos = 0;
+  uint16_t _save_len = 0;
+  uint16_t _save_writes = 0;
+};
@@ -0,0 +1,72 @@
+#include "utils/PowerSaver.h"
+
+#include <avr/interrupt.h>
+#include <avr/io.h>
+#include <avr/sleep.h>
+
+#include "Pins.h"
+
+/*
+===============================================================================
+  PowerSaver.cpp
+===============================================================================
+
+  The wake-up alarm is aimed one Timer0 tick early: the CPU then spins the
+  last few microseconds in the scheduler instead of waking a tick late.
+  Interrupts stay off from reading the clock to the sleep instruction (sei
+  takes effect after the next instruction), so an interrupt in between
+  cannot be slept through.
+===============================================================================
+*/
+
+namespace {
+
+constexpr uint32_t T0_TICK_US = 64UL / (F_CPU / 1000000UL);   // prescaler 64 (Arduino core)
+constexpr uint32_t T0_PERIOD_US = 256UL * T0_TICK_US;
+
+static_assert(IDLE_MIN_US >= 2 * T0_TICK_US, "IDLE_MIN_US below two Timer0 ticks");
+
+// Timer0 leaves fast PWM: OC0A / OC0B (pins 13 / 4) can't be motor PWM pins
+constexpr bool onTimer0(uint8_t pin) { return pin == 4 || pin == 13; }
+static_assert(!onTimer0(PIN_LHS_DRIVE_PWM) && !onTimer0(PIN_RHS_DRIVE_PWM) &&
+              !onTimer0(PIN_LHS_ARM_PWM) && !onTimer0(PIN_RHS_ARM_PWM),
+              "a motor PWM pin is on Timer0, which PowerSaver runs in normal mode");
+
+}  // namespace
+
+// One-shot wake-up alarm: waking the CPU is all it is for
+ISR(TIMER0_COMPA_vect) {
+  TIMSK0 &= (uint8_t)~_BV(OCIE0A);
+}
+
+void PowerSaver::begin() {
+  ADCSRA &= (uint8_t)~_BV(ADEN);   // off before its clock is gated
+  ACSR |= _BV(ACD);
+  PRR0 |= _BV(PRADC) | _BV(PRSPI) | _BV(PRTWI);
+
+  // Normal mode: same 256-tick overflow, but OCR0A is not double-buffered
+  TCCR0A &= (uint8_t)~(_BV(WGM01) | _BV(WGM00));
+
+  set_sleep_mode(SLEEP_MODE_IDLE);
+}
+
+void PowerSaver::idleUntil(uint32_t wake_us) {
+  cli();
+  const int32_t dt_us = (int32_t)(wake_us - micros());
+  if (dt_us < (int32_t)IDLE_MIN_US) {
+    sei();
+    return;
+  }
+
+  // Closer than the next overflow: arm the compare A alarm
+  if ((uint32_t)dt_us < T0_PERIOD_US) {
+    OCR0A = (uint8_t)(TCNT0 + (uint8_t)((uint32_t)dt_us / T0_TICK_US) - 1);
+    TIFR0 = _BV(OCF0A);
+    TIMSK0 |= _BV(OCIE0A);
+  }
+
+  sleep_enable();
+  sei();
+  sleep_cpu();
+  sleep_disable();
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "Params.h"
+
+/*
+===============================================================================
+  PowerSaver.h
+===============================================================================
+
+  PURPOSE
+  -------
+  Cuts the MCU's share of the battery draw. The work is a few hundred
+  releases a second; without this, loop() spins through tick() tens of
+  thousands of times a second in between.
+
+  Idle sleep (Scheduler idle hook):
+    - idleUntil(wake_us) enters SLEEP_MODE_IDLE: the CPU clock stops, every
+      timer, USART, pin-change and INTn interrupt keeps running and wakes it
+    - Timer0 (millis) overflows every 1.024 ms, so a sleep never outlasts
+      that; when the release is closer than one overflow, a one-shot
+      Timer0 compare A alarm wakes the CPU at it (4 us steps, early rather
+      than late). begin() takes Timer0 from fast PWM to normal mode for
+      that (same overflow period, so millis()/micros() are unchanged; only
+      analogWrite on pins 4 and 13 is lost, which nothing uses)
+    - Gaps under IDLE_MIN_US are not worth the wake-up and return at once
+
+  Peripherals: begin() disables the ADC and the analog comparator and gates
+  the clocks of ADC, SPI and TWI in PRR0, none of which is used. Timers and
+  USARTs stay clocked: all six timers, USART0 (USB) and USART2 (aux link)
+  are in use, USART1/3 are left alone.
+
+  Servos are not touched here: the lid and sweep already auto-detach once
+  settled at their closed / stow setpoints (ServoActuatorT).
+
+  USAGE
+  -----
+    setup():  PowerSaver::begin();  g_sched.setIdle(PowerSaver::idleUntil);
+===============================================================================
+*/
+
+class PowerSaver {
+public:
+  // PRR / ADC / comparator, Timer0 to normal mode
+  static void begin();
+
+  // SLEEP_MODE_IDLE until wake_us (micros()) or the first interrupt
+  static void idleUntil(uint32_t wake_us);
+};
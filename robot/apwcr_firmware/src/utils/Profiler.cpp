@@ -0,0 +1,74 @@
+#include "utils/Profiler.h"
+
+/*
+===============================================================================
+  Profiler.cpp
+===============================================================================
+*/
+
+namespace {
+
+// Bin = bit length of dur_us (0 -> bin 0, 1 -> 1, 2..3 -> 2, ...), saturated
+inline uint8_t histBin(uint32_t dur_us) {
+  uint8_t b = 0;
+  while (dur_us && b < Profiler::HIST_BINS - 1) {
+    dur_us >>= 1;
+    b++;
+  }
+  return b;
+}
+
+}  // namespace
+
+
+uint32_t Profiler::Slot::p99Us() const {
+  if (count == 0) return 0;
+
+  uint32_t total = 0;
+  for (uint8_t b = 0; b < HIST_BINS; b++) total += hist[b];
+
+  // Smallest bin where the cumulative count reaches 99%
+  const uint32_t target = total - total / 100;
+  uint32_t cum = 0;
+  for (uint8_t b = 0; b < HIST_BINS; b++) {
+    cum += hist[b];
+    if (cum >= target) {
+      if (b == HIST_BINS - 1) return max_us;
+      const uint32_t edge = (1UL << b) - 1;   // largest value in bin b
+      return (edge < max_us) ? edge : max_us;
+    }
+  }
+  return max_us;
+}
+
+void Profiler::record(uint8_t slot, uint32_t dur_us) {
+  if (slot >= MAX_SLOTS) return;
+  Slot& s = _slots[slot];
+
+  s.count++;
+  s.sum_us += dur_us;
+  if (dur_us < s.min_us) s.min_us = dur_us;
+  if (dur_us > s.max_us) s.max_us = dur_us;
+
+  uint16_t& h = s.hist[histBin(dur_us)];
+  if (h != 0xFFFF) h++;
+}
+
+void Profiler::loopMark(uint32_t now_us) {
+  if (_have_last_loop) {
+    const uint32_t period_us = now_us - _last_loop_us;
+    _loop.count++;
+    _loop.sum_us += period_us;
+    if (period_us < _loop.min_us) _loop.min_us = period_us;
+    if (period_us > _loop.max_us) _loop.max_us = period_us;
+  }
+  _last_loop_us = now_us;
+  _have_last_loop = true;
+}
+
+void Profiler::reset() {
+  for (uint8_t i = 0; i < MAX_SLOTS; i++) _slots[i] = Slot();
+  _loop = LoopStats();
+  _have_last_loop = false;
+  _window_start_ms = millis();
+}
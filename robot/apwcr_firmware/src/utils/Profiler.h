@@ -0,0 +1,81 @@
+#pragma once
+
+#include <Arduino.h>
+
+/*
+===============================================================================
+  Profiler.h
+===============================================================================
+
+  PURPOSE
+  -------
+  Lightweight micros()-based timing for scheduler tasks and the main loop.
+
+  Per task slot (one window, cleared by reset()):
+    - count, min, max, mean execution time
+    - p99 from a log2 histogram (bin b holds durations in [2^(b-1), 2^b) us,
+      so the estimate is the bin's upper edge, clipped to max)
+
+  Main loop:
+    - period min/max/mean between successive loopMark() calls
+    - jitter = max - min period over the window
+    - worst-case latency = longest period (how long a due task could wait)
+    - time spent in the scheduler's idle hook (recordIdle); with idle
+      sleep on, periods include that time
+
+  Cost per record(): a compare/add plus a clz-style loop over <= 16 bits.
+===============================================================================
+*/
+
+class Profiler {
+public:
+  static constexpr uint8_t MAX_SLOTS = 10;
+  static constexpr uint8_t HIST_BINS = 16;   // last bin: >= 16.4 ms
+
+  struct Slot {
+    uint32_t count = 0;
+    uint32_t min_us = 0xFFFFFFFFUL;
+    uint32_t max_us = 0;
+    uint32_t sum_us = 0;
+    uint16_t hist[HIST_BINS] = {};
+
+    uint32_t meanUs() const { return count ? (sum_us / count) : 0; }
+    uint32_t p99Us() const;
+  };
+
+  struct LoopStats {
+    uint32_t count = 0;           // periods measured
+    uint32_t min_us = 0xFFFFFFFFUL;
+    uint32_t max_us = 0;          // worst-case loop latency
+    uint32_t sum_us = 0;
+    uint32_t idle_us = 0;         // asleep (scheduler idle hook)
+
+    uint32_t meanUs() const { return count ? (sum_us / count) : 0; }
+    uint32_t jitterUs() const { return count ? (max_us - min_us) : 0; }
+  };
+
+  // Adds one execution-time sample to a slot (ignored if out of range).
+  void record(uint8_t slot, uint32_t dur_us);
+
+  // Call once at the top of each loop iteration.
+  void loopMark(uint32_t now_us);
+
+  // Adds time spent idle (between ticks).
+  void recordIdle(uint32_t dur_us) { _loop.idle_us += dur_us; }
+
+  const Slot& slot(uint8_t i) const { return _slots[(i < MAX_SLOTS) ? i : 0]; }
+  const LoopStats& loop() const { return _loop; }
+
+  // Starts a new measurement window (the next loopMark() re-anchors).
+  void reset();
+
+  uint32_t windowStartMs() const { return _window_start_ms; }
+
+private:
+  Slot _slots[MAX_SLOTS];
+  LoopStats _loop;
+
+  uint32_t _last_loop_us = 0;
+  bool _have_last_loop = false;
+  uint32_t _window_start_ms = 0;
+};
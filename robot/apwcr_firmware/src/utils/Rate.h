@@ -2,41 +2,180 @@
 
 #include <Arduino.h>
 
+/*
+===============================================================================
+  Rate.h
+===============================================================================
+
+  PURPOSE
+  -------
+  Polled fixed-rate timer for code that runs outside the Scheduler (test
+  sketches, bench loops, a module's own sub-rate).
+
+  - Timing in microseconds with the fractional part of the period carried
+    from release to release, so the average rate is exact: 60 Hz releases
+    every 16666 or 16667 us, 400 Hz every 2500 us (1000 / hz in whole
+    milliseconds made those 62.5 Hz and 500 Hz)
+  - ready(now_ms) runs the same schedule on millis() (now_ms * 1000 wraps
+    mod 2^32 exactly like the schedule does); the release then slips to the
+    next whole millisecond, but the average rate stays exact
+  - Releases are next += period, not now + period, so running a little late
+    does not push every later release back
+  - A call that finds the release at least one whole period in the past is
+    an overrun. What happens to the releases missed in between is the
+    policy:
+      SKIP      drop them and keep the phase (default)
+      CATCH_UP  run them back to back (ready() stays true) until caught
+                up; more than MAX_CATCH_UP behind drops the excess
+      REPHASE   drop them and restart the phase from now
+  - Stats: runs, overruns, releases skipped, worst lateness (the same
+    accounting as Scheduler::TaskStats)
+
+  Lateness is measured against the release, so it includes up to one poll
+  interval.
+
+  USAGE
+  -----
+    Rate r(60);                          // or Rate r(400, Rate::Policy::CATCH_UP)
+    loop() { if (r.readyUs(micros())) step(); }
+    if (r.stats().overruns) ...
+===============================================================================
+*/
+
 class Rate {
 public:
+  enum class Policy : uint8_t { SKIP, CATCH_UP, REPHASE };
+
+  struct Stats {
+    uint32_t runs = 0;
+    uint32_t overruns = 0;       // calls at least one whole period late
+    uint32_t skipped = 0;        // releases dropped by the policy
+    uint32_t max_late_us = 0;    // worst start delay vs. scheduled release
+  };
+
+  // CATCH_UP runs at most this many releases late before dropping the rest
+  static constexpr uint8_t MAX_CATCH_UP = 4;
+
   // hz = how many times per second you want to run
-  explicit Rate(uint16_t hz = 1) { setHz(hz); }
+  explicit Rate(uint16_t hz = 1, Policy policy = Policy::SKIP) : _policy(policy) { setHz(hz); }
 
   void setHz(uint16_t hz) {
     if (hz == 0) hz = 1;
-    _period_ms = (uint32_t)(1000UL / hz);
-    if (_period_ms == 0) _period_ms = 1;
+    _period_us = 1000000UL / hz;
+    _frac_num = (uint16_t)(1000000UL % hz);
+    _frac_den = hz;
+    _frac = 0;
   }
 
-  void setPeriodMs(uint32_t period_ms) {
-    _period_ms = (period_ms == 0) ? 1 : period_ms;
+  void setPeriodUs(uint32_t period_us) {
+    _period_us = (period_us == 0) ? 1 : period_us;
+    _frac_num = 0;
+    _frac_den = 1;
+    _frac = 0;
   }
 
-  // Returns true when it's time to run. If true, it schedules the next tick.
-  bool ready(uint32_t now_ms) {
-    if (!_initialized) {
-      _next_ms = now_ms;      // run immediately on first call
-      _initialized = true;
-    }
+  void setPeriodMs(uint32_t period_ms) { setPeriodUs(period_ms * 1000UL); }
 
-    // Safe with millis() rollover because of signed subtraction trick
-    if ((int32_t)(now_ms - _next_ms) >= 0) {
-      _next_ms = now_ms + _period_ms;
-      return true;
-    }
-    return false;
-  }
+  void setPolicy(Policy policy) { _policy = policy; }
+
+  // Returns true when it's time to run. If true, it schedules the next
+  // release (per the policy if this one was overrun).
+  bool readyUs(uint32_t now_us);
+
+  // Same schedule on the millis() clock
+  bool ready(uint32_t now_ms) { return readyUs(now_ms * 1000UL); }
+
+  // Next release from now on (the first call releases at once)
+  void restart() { _initialized = false; }
+
+  const Stats& stats() const { return _stats; }
+  void resetStats() { _stats = Stats(); }
 
-  uint32_t periodMs() const { return _period_ms; }
-  uint32_t nextMs() const { return _next_ms; }
+  uint32_t periodUs() const { return _period_us; }   // whole part
+  uint32_t periodMs() const { return _period_us / 1000UL; }
+  uint32_t nextUs() const { return _next_us; }
+  Policy policy() const { return _policy; }
 
 private:
-  uint32_t _period_ms = 1000;
-  uint32_t _next_ms = 0;
+  // next += n periods, carrying the fraction
+  void advance_(uint32_t n) {
+    _next_us += n * _period_us;
+    if (_frac_num == 0) return;
+    if (n == 1) {
+      _frac += _frac_num;
+      if (_frac >= _frac_den) { _frac -= _frac_den; _next_us++; }
+      return;
+    }
+    const uint64_t f = _frac + (uint64_t)n * _frac_num;   // after a long stall only
+    _next_us += (uint32_t)(f / _frac_den);
+    _frac = (uint16_t)(f % _frac_den);
+  }
+
+  uint32_t _period_us = 1000000UL;
+  uint16_t _frac_num = 0;      // period = _period_us + _frac_num / _frac_den
+  uint16_t _frac_den = 1;
+  uint16_t _frac = 0;          // carried numerator, < _frac_den
+  uint8_t _backlog = 0;        // CATCH_UP releases still to run late
+  uint32_t _next_us = 0;
+  Policy _policy = Policy::SKIP;
   bool _initialized = false;
+
+  Stats _stats;
 };
+
+inline bool Rate::readyUs(uint32_t now_us) {
+  if (!_initialized) {
+    _next_us = now_us;      // run immediately on first call
+    _frac = 0;
+    _backlog = 0;
+    _initialized = true;
+  }
+
+  // Safe with rollover because of signed subtraction trick
+  const int32_t late = (int32_t)(now_us - _next_us);
+  if (late < 0) return false;
+
+  _stats.runs++;
+  if ((uint32_t)late > _stats.max_late_us) _stats.max_late_us = (uint32_t)late;
+
+  // Releases already due besides this one (division only when overrun)
+  const uint32_t behind = ((uint32_t)late < _period_us) ? 0 : (uint32_t)late / _period_us;
+  if (behind == 0 || _backlog) {
+    if (_backlog) _backlog--;   // catching up: counted when it fell behind
+    advance_(1);
+    return true;
+  }
+  _stats.overruns++;
+
+  switch (_policy) {
+    case Policy::CATCH_UP:
+      // Keep the backlog, but no more than MAX_CATCH_UP of it
+      if (behind > MAX_CATCH_UP) {
+        _stats.skipped += behind - MAX_CATCH_UP;
+        advance_(behind - MAX_CATCH_UP);
+      }
+      _backlog = (behind > MAX_CATCH_UP) ? MAX_CATCH_UP : (uint8_t)behind;
+      advance_(1);
+      break;
+
+    case Policy::REPHASE:
+      _stats.skipped += behind;
+      _next_us = now_us;
+      _frac = 0;
+      advance_(1);
+      break;
+
+    case Policy::SKIP:
+    default:
+      // The first release after now, on the original phase. `behind` used
+      // the whole period, so the fraction can leave one more already due.
+      _stats.skipped += behind;
+      advance_(behind + 1);
+      if ((int32_t)(now_us - _next_us) >= 0) {
+        _stats.skipped++;
+        advance_(1);
+      }
+      break;
+  }
+  return true;
+}
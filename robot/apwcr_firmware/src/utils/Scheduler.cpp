@@ -0,0 +1,159 @@
+#include "utils/Scheduler.h"
+#include "utils/Profiler.h"
+
+/*
+===============================================================================
+  Scheduler.cpp
+===============================================================================
+
+  All time comparisons use the signed-difference trick, so micros() rollover
+  (~71 minutes) is harmless as long as no period exceeds ~35 minutes.
+===============================================================================
+*/
+
+namespace {
+
+inline bool due(uint32_t now_us, uint32_t at_us) {
+  return (int32_t)(now_us - at_us) >= 0;
+}
+
+// Bound on releases skipped one at a time after a stall; beyond this the
+// task is re-anchored at now (phase is lost, but tick() stays cheap)
+constexpr uint8_t MAX_CATCHUP_STEPS = 32;
+
+}  // namespace
+
+
+uint8_t Scheduler::add(TaskFn fn, uint32_t period_us, uint32_t phase_us, uint8_t priority,
+                       const __FlashStringHelper* name) {
+  if (!fn || _count >= MAX_TASKS) return INVALID_TASK;
+
+  // Insertion keeps the table sorted by priority (stable for equal priority)
+  uint8_t pos = _count;
+  while (pos > 0 && _tasks[pos - 1].priority < priority) {
+    _tasks[pos] = _tasks[pos - 1];
+    pos--;
+  }
+
+  Task& t = _tasks[pos];
+  t.fn = fn;
+  t.period_us = period_us;
+  t.phase_us = phase_us;
+  t.next_us = 0;
+  t.priority = priority;
+  t.id = _count;
+  t.name = name;
+  t.stats = TaskStats();
+
+  return _count++;
+}
+
+void Scheduler::start(uint32_t now_us) {
+  for (uint8_t i = 0; i < _count; i++) {
+    _tasks[i].next_us = now_us + _tasks[i].phase_us;
+  }
+  _started = true;
+}
+
+void Scheduler::tick() {
+  if (!_started) start(micros());
+  if (_profiler) _profiler->loopMark(micros());
+
+  for (uint8_t i = 0; i < _count; i++) {
+    Task& t = _tasks[i];
+
+    // Re-read the clock per task: earlier tasks on this tick take time
+    const uint32_t now_us = micros();
+    if (!due(now_us, t.next_us)) continue;
+
+    const uint32_t late_us = now_us - t.next_us;
+    if (late_us > t.stats.max_late_us) t.stats.max_late_us = late_us;
+
+    t.fn(millis());
+    t.stats.runs++;
+
+    const uint32_t after_us = micros();
+    if (_profiler) _profiler->record(t.id, after_us - now_us);
+
+    if (t.period_us == 0) {
+      t.next_us = now_us;
+      continue;
+    }
+
+    // Drift-free release
+    t.next_us += t.period_us;
+
+    if (due(after_us, t.next_us)) {
+      t.stats.overruns++;
+
+      uint8_t steps = 0;
+      while (due(after_us, t.next_us) && steps < MAX_CATCHUP_STEPS) {
+        t.next_us += t.period_us;
+        steps++;
+      }
+      if (due(after_us, t.next_us)) {
+        t.next_us = after_us + t.period_us;
+      }
+      t.stats.skipped += steps;
+    }
+  }
+
+  if (_idle) idle_();
+}
+
+void Scheduler::idle_() {
+  bool timed = false;
+  uint32_t wake_us = 0;
+  for (uint8_t i = 0; i < _count; i++) {
+    const Task& t = _tasks[i];
+    if (t.period_us == 0) continue;
+    if (!timed || (int32_t)(t.next_us - wake_us) < 0) wake_us = t.next_us;
+    timed = true;
+  }
+
+  const uint32_t now_us = micros();
+  if (!timed || due(now_us, wake_us)) return;
+
+  _idle(wake_us);
+  if (_profiler) _profiler->recordIdle(micros() - now_us);
+}
+
+void Scheduler::setPeriodUs(uint8_t id, uint32_t period_us) {
+  Task* t = find_(id);
+  if (t) t->period_us = period_us;
+}
+
+uint32_t Scheduler::periodUs(uint8_t id) const {
+  const Task* t = find_(id);
+  return t ? t->period_us : 0;
+}
+
+const Scheduler::TaskStats* Scheduler::stats(uint8_t id) const {
+  const Task* t = find_(id);
+  return t ? &t->stats : nullptr;
+}
+
+const __FlashStringHelper* Scheduler::name(uint8_t id) const {
+  const Task* t = find_(id);
+  return t ? t->name : nullptr;
+}
+
+void Scheduler::resetStats() {
+  for (uint8_t i = 0; i < _count; i++) {
+    _tasks[i].stats = TaskStats();
+  }
+}
+
+Scheduler::Task* Scheduler::find_(uint8_t id) {
+  for (uint8_t i = 0; i < _count; i++) {
+    if (_tasks[i].id == id) return &_tasks[i];
+  }
+  return nullptr;
+}
+
+const Scheduler::Task* Scheduler::find_(uint8_t id) const {
+  for (uint8_t i = 0; i < _count; i++) {
+    if (_tasks[i].id == id) return &_tasks[i];
+  }
+  return nullptr;
+}
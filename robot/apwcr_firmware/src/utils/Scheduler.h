@@ -0,0 +1,123 @@
+#pragma once
+
+#include <Arduino.h>
+
+class Profiler;
+
+/*
+===============================================================================
+  Scheduler.h
+===============================================================================
+
+  PURPOSE
+  -------
+  Fixed-timestep cooperative scheduler for the main loop (replaces one Rate
+  object per task).
+
+  - Timing in micros(), so 400 Hz and 60 Hz periods are exact instead of
+    being rounded to whole milliseconds
+  - Drift-free: each release is next += period (not now + period), so a task
+    that runs a little late does not push every later release back
+  - Phase offsets: tasks with the same or harmonic periods can be staggered
+    so they don't all land on the same loop iteration
+  - Priorities: when several tasks are due on one tick, the higher priority
+    runs first (ties keep registration order)
+  - Overruns: a task whose next release is already in the past after it
+    runs has missed at least one whole period; that is counted and the
+    missed releases are skipped (the phase is kept)
+
+  A task with period 0 runs on every tick (cheap background polling).
+
+  Idle hook (setIdle): when a tick leaves no timed task due, the hook is
+  called with the earliest release and may sleep until then (or until an
+  interrupt). Period-0 tasks don't hold it off: they run once per wake-up,
+  so anything they poll must also raise an interrupt, or tolerate waiting
+  for the next one.
+
+  With a Profiler attached, every task run is timed into the profiler slot
+  matching its id, each tick() marks one loop iteration, and time in the
+  idle hook is recorded as idle.
+
+  USAGE
+  -----
+    Scheduler g_sched;
+    const uint8_t rx = g_sched.add(rxTask, Scheduler::hzToUs(400), 0, 3);
+    ...
+    g_sched.start(micros());
+    loop() { g_sched.tick(); }
+===============================================================================
+*/
+
+class Scheduler {
+public:
+  using TaskFn = void (*)(uint32_t now_ms);
+  using IdleFn = void (*)(uint32_t wake_us);
+
+  static constexpr uint8_t MAX_TASKS = 10;
+  static constexpr uint8_t INVALID_TASK = 0xFF;
+
+  struct TaskStats {
+    uint32_t runs = 0;
+    uint32_t overruns = 0;       // times a release was missed entirely
+    uint32_t skipped = 0;        // total releases skipped by overruns
+    uint32_t max_late_us = 0;    // worst start delay vs. scheduled release
+  };
+
+  static uint32_t hzToUs(uint16_t hz) {
+    return (hz == 0) ? 1000000UL : (1000000UL / hz);
+  }
+
+  // Registers a task. Returns its id, or INVALID_TASK if the table is full.
+  // Higher priority runs first when several tasks are due on the same tick.
+  // name (flash string) is only used for diagnostics.
+  uint8_t add(TaskFn fn, uint32_t period_us, uint32_t phase_us = 0, uint8_t priority = 0,
+              const __FlashStringHelper* name = nullptr);
+
+  // Anchors every task's first release at now_us + phase_us.
+  void start(uint32_t now_us);
+
+  // Runs every due task once, in priority order.
+  void tick();
+
+  // Change period at runtime (keeps the current release time).
+  void setPeriodUs(uint8_t id, uint32_t period_us);
+  void setHz(uint8_t id, uint16_t hz) { setPeriodUs(id, hzToUs(hz)); }
+
+  uint32_t periodUs(uint8_t id) const;
+  const TaskStats* stats(uint8_t id) const;
+  const __FlashStringHelper* name(uint8_t id) const;
+  uint8_t count() const { return _count; }
+
+  // Optional per-task timing (nullptr disables)
+  void setProfiler(Profiler* profiler) { _profiler = profiler; }
+
+  // Optional hook between ticks (nullptr: tick() returns at once, loop spins)
+  void setIdle(IdleFn idle) { _idle = idle; }
+
+  void resetStats();
+
+private:
+  struct Task {
+    TaskFn fn;
+    uint32_t period_us;
+    uint32_t phase_us;
+    uint32_t next_us;
+    uint8_t priority;
+    uint8_t id;
+    const __FlashStringHelper* name;
+    TaskStats stats;
+  };
+
+  void idle_();
+
+  Task* find_(uint8_t id);
+  const Task* find_(uint8_t id) const;
+
+  // Kept sorted by priority (descending), so tick() is a single pass
+  Task _tasks[MAX_TASKS];
+  uint8_t _count = 0;
+  bool _started = false;
+
+  Profiler* _profiler = nullptr;
+  IdleFn _idle = nullptr;
+};
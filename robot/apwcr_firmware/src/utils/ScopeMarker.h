@@ -0,0 +1,88 @@
+#pragma once
+#include <Arduino.h>
+
+#include "Pins.h"
+#include "Params.h"
+
+/*
+===============================================================================
+  ScopeMarker.h
+===============================================================================
+
+  PURPOSE
+  -------
+  Logic analyzer markers for timing validation (ENABLE_SCOPE_MARKERS): a
+  spare GPIO per task and per ISR group (pin map in Pins.h) is high while
+  it runs, so release jitter, run time and ISR preemption show up on the
+  analyzer as they happen, next to the Profiler's windowed figures.
+
+  - A marker flips its pin by writing the bit to the port's PINx register:
+    one store, atomic, no read-modify-write, so an ISR toggling a pin on
+    PORTL can't corrupt a task's marker on the same port (PORTL sits above
+    the SBI range, where `PORTL |= bit` would be three instructions)
+  - ScopeSpan flips it on construction and again on destruction, so a
+    span at the top of a task or ISR covers every return path
+  - The pins start low (scopeMarkersBegin()); each span is a pulse. An ISR
+    that preempts a span shows as its own pulse inside it
+  - With ENABLE_SCOPE_MARKERS off every marker compiles to nothing and the
+    pins are never driven
+
+  Cost with markers on: two stores (~4 cycles, 0.25 us) per span.
+
+  USAGE
+  -----
+    setup():        scopeMarkersBegin();
+    task / ISR:     ScopeSpan mark(ScopeMark::DRIVE);
+===============================================================================
+*/
+
+enum class ScopeMark : uint8_t {
+  // PORTL, bit = value
+  RX = 0,
+  DRIVE,
+  ULTRASONIC,
+  SERVO,
+  TELEMETRY,
+  SAMPLER_ISR,
+  ENCODER_ISR,
+  ECHO_ISR,
+  // PORTG, bit = value - 8
+  UART0_ISR,
+  UART2_ISR,
+};
+
+constexpr uint8_t SCOPE_PORTL_MASK = 0xFF;
+constexpr uint8_t SCOPE_PORTG_MASK = 0x03;
+
+// The bits above are the Pins.h map (PL0 = D49 ... PL7 = D42, PG0 = D41, PG1 = D40)
+static_assert(PIN_SCOPE_RX == 49 && PIN_SCOPE_ECHO_ISR == 42 &&
+              PIN_SCOPE_UART0_ISR == 41 && PIN_SCOPE_UART2_ISR == 40,
+              "ScopeMark bits follow the Pins.h scope marker map");
+
+__attribute__((always_inline)) inline void scopeToggle(ScopeMark m) {
+  if (!ENABLE_SCOPE_MARKERS) return;
+  const uint8_t n = (uint8_t)m;
+  if (n < 8) PINL = (uint8_t)(1u << n);
+  else       PING = (uint8_t)(1u << (n - 8));
+}
+
+// Marker pins to outputs, low. Call once before the scheduler starts.
+inline void scopeMarkersBegin() {
+  if (!ENABLE_SCOPE_MARKERS) return;
+  PORTL &= (uint8_t)~SCOPE_PORTL_MASK;
+  DDRL |= SCOPE_PORTL_MASK;
+  PORTG &= (uint8_t)~SCOPE_PORTG_MASK;
+  DDRG |= SCOPE_PORTG_MASK;
+}
+
+class ScopeSpan {
+public:
+  __attribute__((always_inline)) explicit ScopeSpan(ScopeMark m) : _m(m) { scopeToggle(_m); }
+  __attribute__((always_inline)) ~ScopeSpan() { scopeToggle(_m); }
+
+  ScopeSpan(const ScopeSpan&) = delete;
+  ScopeSpan& operator=(const ScopeSpan&) = delete;
+
+private:
+  const ScopeMark _m;
+};
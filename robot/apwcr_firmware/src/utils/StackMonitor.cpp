@@ -0,0 +1,59 @@
+#include "utils/StackMonitor.h"
+
+#include <avr/io.h>   // SP, RAMSTART, RAMEND
+
+/*
+===============================================================================
+  StackMonitor.cpp
+===============================================================================
+
+  __heap_start is the linker script's end of .noinit; nothing above it is
+  static data. The paint runs in .init3 (after .init2 has set SP and
+  cleared r1, before .init4 copies .data and clears .bss), so it writes
+  only into the gap and nothing has used the stack yet.
+===============================================================================
+*/
+
+extern uint8_t __heap_start;
+
+static void paintStack() __attribute__((naked, used, section(".init3")));
+static void paintStack() {
+  uint8_t* p = &__heap_start;
+  while (p < (uint8_t*)(uintptr_t)SP) *p++ = StackMonitor::PAINT;
+}
+
+void StackMonitor::begin() {
+  _low = (uint8_t*)(uintptr_t)SP;
+  _cursor = &__heap_start;
+  while (_cursor < _low && *_cursor == PAINT) _cursor++;
+  _low = _cursor;
+  _cursor = &__heap_start;
+}
+
+void StackMonitor::service() {
+  uint8_t* p = _cursor;
+  for (uint8_t n = 0; n < STACK_SCAN_CHUNK_BYTES; n++, p++) {
+    if (p >= _low || *p != PAINT) {
+      if (p < _low) _low = p;
+      _cursor = &__heap_start;   // pass done, next one from the bottom
+      return;
+    }
+  }
+  _cursor = p;
+}
+
+uint16_t StackMonitor::staticBytes() {
+  return (uint16_t)(&__heap_start - (uint8_t*)(uintptr_t)RAMSTART);
+}
+
+uint16_t StackMonitor::stackPeakBytes() const {
+  return (uint16_t)((uint8_t*)(uintptr_t)RAMEND + 1 - _low);
+}
+
+uint16_t StackMonitor::freeMinBytes() const {
+  return (uint16_t)(_low - &__heap_start);
+}
+
+uint16_t StackMonitor::freeNowBytes() {
+  return (uint16_t)((uint8_t*)(uintptr_t)SP - &__heap_start);
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "Params.h"
+
+/*
+===============================================================================
+  StackMonitor.h
+===============================================================================
+
+  PURPOSE
+  -------
+  SRAM headroom at runtime: how deep the stack has ever grown (ISRs
+  included) and how much of the 8 KB was never touched, so buffers can be
+  sized against a measurement instead of a guess.
+
+  Stack painting:
+    - Before the C runtime initialises .data / .bss (.init3), every byte
+      from __heap_start (end of .noinit) up to the stack pointer is filled
+      with PAINT
+    - The stack grows down into that gap; whatever it writes is, almost
+      always, not PAINT. The first non-PAINT byte above __heap_start is the
+      deepest the stack has reached since reset
+    - The firmware never allocates, so nothing else writes into the gap
+      (a heap would grow up from the same address and read as stack use)
+
+  service() rescans the gap from its bottom STACK_SCAN_CHUNK_BYTES at a
+  time (~5 cycles a byte), so covering 3 KB of headroom is ~50 loops and no
+  single call costs more than ~25 us. The marks only ever move toward less
+  headroom: a reading is the worst case since boot.
+
+  A stack frame whose bottom bytes happen to equal PAINT (or a buffer at the
+  bottom of the deepest frame that was never written) under-reports the
+  peak by those bytes. Keep some margin over free_min.
+
+  USAGE
+  -----
+    setup():     g_stack.begin();   (one full scan)
+    every loop:  g_stack.service();
+    perf frame:  g_stack.staticBytes(), stackPeakBytes(), freeMinBytes(), freeNowBytes()
+===============================================================================
+*/
+
+class StackMonitor {
+public:
+  static constexpr uint8_t PAINT = 0xC5;
+
+  void begin();
+
+  // One scan chunk (every loop)
+  void service();
+
+  // .data + .bss + .noinit
+  static uint16_t staticBytes();
+
+  // Deepest stack since reset, from RAMEND down
+  uint16_t stackPeakBytes() const;
+
+  // Bytes between __heap_start and the deepest stack: never touched
+  uint16_t freeMinBytes() const;
+
+  // Bytes between __heap_start and the stack pointer now
+  static uint16_t freeNowBytes();
+
+private:
+  uint8_t* _low = nullptr;      // lowest byte the stack is known to have written
+  uint8_t* _cursor = nullptr;   // scan position in the current pass
+};
@@ -0,0 +1,122 @@
+#include "utils/Watchdog.h"
+#include "utils/EventLog.h"
+
+/*
+===============================================================================
+  Watchdog.cpp
+===============================================================================
+
+  feed() costs a few compares (recomputing the earliest deadline over at
+  most MAX_CHANNELS entries); check() is one subtract/compare and a wdr
+  until something actually goes stale.
+===============================================================================
+*/
+
+static_assert(Watchdog::MAX_CHANNELS <= 8, "channel masks are 8-bit");
+
+void Watchdog::begin(const Channel* table, uint8_t n, uint8_t reset_flags, uint32_t now_ms) {
+  _table = table;
+  _n = (n < MAX_CHANNELS) ? n : MAX_CHANNELS;
+
+  _armed = 0;
+  _tripped = 0;
+  _hw_mask = 0;
+  _trips = 0;
+
+  for (uint8_t i = 0; i < _n; i++) {
+    Channel row;
+    memcpy_P(&row, &_table[i], sizeof(row));
+    _timeout_ms[i] = row.timeout_ms;
+    if (row.hardware) {
+      _hw_mask |= _BV(i);
+      _deadline_ms[i] = now_ms + row.timeout_ms;
+      _armed |= _BV(i);
+    }
+  }
+  updateNext_();
+
+  _reset_flags = reset_flags;
+  _cause = classify_(reset_flags);
+
+  _kick = ENABLE_WATCHDOG;
+  if (ENABLE_WATCHDOG) wdt_enable(wdtoFor_(WATCHDOG_HW_TIMEOUT_MS));
+}
+
+void Watchdog::feed(uint8_t ch, uint32_t now_ms) {
+  if (ch >= _n) return;
+
+  const uint8_t bit = _BV(ch);
+  _deadline_ms[ch] = now_ms + _timeout_ms[ch];
+  _armed |= bit;
+
+  if (_tripped & bit) {
+    _tripped &= (uint8_t)~bit;
+    logEvent(now_ms, EventId::WATCHDOG_FED, ch);
+    if (ENABLE_WATCHDOG && !(_tripped & _hw_mask)) _kick = true;
+  }
+  updateNext_();
+}
+
+void Watchdog::service_(uint32_t now_ms) {
+  for (uint8_t i = 0; i < _n; i++) {
+    const uint8_t bit = _BV(i);
+    if (!(_armed & bit) || (int32_t)(now_ms - _deadline_ms[i]) < 0) continue;
+
+    _armed &= (uint8_t)~bit;
+    _tripped |= bit;
+    if (_trips < 0xFFFF) _trips++;
+    logEvent(now_ms, EventId::WATCHDOG_STALE, i, (int16_t)_trips);
+
+    Channel row;
+    memcpy_P(&row, &_table[i], sizeof(row));
+    if (row.on_stale) row.on_stale(now_ms);
+  }
+
+  if (_tripped & _hw_mask) _kick = false;
+  updateNext_();
+}
+
+void Watchdog::updateNext_() {
+  bool first = true;
+  for (uint8_t i = 0; i < _n; i++) {
+    if (!(_armed & _BV(i))) continue;
+    if (first || (int32_t)(_deadline_ms[i] - _next_ms) < 0) _next_ms = _deadline_ms[i];
+    first = false;
+  }
+}
+
+Watchdog::ResetCause Watchdog::classify_(uint8_t flags) {
+  // Several flags can be set at once (e.g. power-on also sets brown-out);
+  // the watchdog wins because it is the one worth reporting
+#ifdef JTRF
+  if (flags & _BV(JTRF)) return ResetCause::JTAG;
+#endif
+  if (flags & _BV(WDRF))  return ResetCause::WATCHDOG;
+  if (flags & _BV(PORF))  return ResetCause::POWER_ON;
+  if (flags & _BV(BORF))  return ResetCause::BROWN_OUT;
+  if (flags & _BV(EXTRF)) return ResetCause::EXTERNAL;
+  return ResetCause::UNKNOWN;
+}
+
+const char* Watchdog::causeName(ResetCause cause) {
+  switch (cause) {
+    case ResetCause::POWER_ON:  return "power_on";
+    case ResetCause::EXTERNAL:  return "external";
+    case ResetCause::BROWN_OUT: return "brown_out";
+    case ResetCause::WATCHDOG:  return "watchdog";
+    case ResetCause::JTAG:      return "jtag";
+    default:                    return "unknown";
+  }
+}
+
+// Longest WDTO_* period that is not longer than ms (15 ms minimum)
+uint8_t Watchdog::wdtoFor_(uint16_t ms) {
+  if (ms >= 2000) return WDTO_2S;
+  if (ms >= 1000) return WDTO_1S;
+  if (ms >= 500)  return WDTO_500MS;
+  if (ms >= 250)  return WDTO_250MS;
+  if (ms >= 120)  return WDTO_120MS;
+  if (ms >= 60)   return WDTO_60MS;
+  if (ms >= 30)   return WDTO_30MS;
+  return WDTO_15MS;
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <Arduino.h>
+#include <avr/io.h>    // MCUSR bits, _BV
+#include <avr/wdt.h>
+
+#include "Params.h"
+
+/*
+===============================================================================
+  Watchdog.h
+===============================================================================
+
+  PURPOSE
+  -------
+  Stops the robot safely when something stops happening: the host stops
+  sending commands, or the control loop stops running.
+
+  Liveness channels:
+    - Each channel is one row of a stop table built at compile time (in
+      flash): a timeout and the action to run when the channel goes stale
+    - feed(ch) re-arms a channel; a channel never fed stays disarmed
+    - A stale channel runs its action once and stays tripped until the
+      next feed(), so a lost host stops the drive exactly once
+  Hardware WDT (ENABLE_WATCHDOG):
+    - Armed by begin() at WATCHDOG_HW_TIMEOUT_MS (rounded down to a WDTO_*
+      step) and kicked by check()
+    - A `hardware` channel going stale also stops the kicks, so a stalled
+      control loop resets the MCU after its stop action has run
+    - Hardware channels are armed by begin(): they must be fed from then on
+
+  check() runs every loop. It only compares now against the earliest
+  deadline (kept up to date by feed) and kicks the WDT; the table is only
+  walked when that deadline passes.
+
+  Reset cause: MCUSR has to be read (and cleared, with the WDT turned off)
+  before the C runtime starts, or a WDT reset keeps the 15 ms WDT running
+  into setup(). main.cpp does that in .init3 and hands the flags to begin().
+
+  USAGE
+  -----
+    const Watchdog::Channel TABLE[] PROGMEM = {{250, stopDrive, false}, ...};
+    g_watchdog.begin(TABLE, n, reset_flags, now_ms);
+    on a command:  g_watchdog.feed(CH_DRIVE, now_ms);
+    every loop:    g_watchdog.check(now_ms);
+===============================================================================
+*/
+
+class Watchdog {
+public:
+  static constexpr uint8_t MAX_CHANNELS = WATCHDOG_MAX_CHANNELS;
+
+  using Action = void (*)(uint32_t now_ms);
+
+  // One row of the stop table (PROGMEM)
+  struct Channel {
+    uint16_t timeout_ms;
+    Action on_stale;         // may be nullptr
+    bool hardware;           // stale also stops kicking the hardware WDT
+  };
+
+  enum class ResetCause : uint8_t {
+    UNKNOWN = 0,
+    POWER_ON,
+    EXTERNAL,     // reset pin (including the USB auto-reset)
+    BROWN_OUT,
+    WATCHDOG,
+    JTAG,
+  };
+
+  /*
+    table: n rows in flash (n <= MAX_CHANNELS, extra rows are ignored).
+    reset_flags: MCUSR as captured at boot.
+  */
+  void begin(const Channel* table, uint8_t n, uint8_t reset_flags, uint32_t now_ms);
+
+  void feed(uint8_t ch, uint32_t now_ms);
+
+  // Every loop: cheap unless a deadline has passed
+  void check(uint32_t now_ms) {
+    if (_armed && (int32_t)(now_ms - _next_ms) >= 0) service_(now_ms);
+    if (_kick) wdt_reset();
+  }
+
+  bool stale(uint8_t ch) const { return ch < _n && (_tripped & _BV(ch)); }
+  uint8_t staleMask() const { return _tripped; }
+  uint16_t trips() const { return _trips; }
+
+  uint8_t resetFlags() const { return _reset_flags; }
+  ResetCause resetCause() const { return _cause; }
+  static const char* causeName(ResetCause cause);
+
+private:
+  static ResetCause classify_(uint8_t flags);
+  static uint8_t wdtoFor_(uint16_t ms);
+
+  void service_(uint32_t now_ms);
+  void updateNext_();
+
+  const Channel* _table = nullptr;
+  uint8_t _n = 0;
+
+  uint16_t _timeout_ms[MAX_CHANNELS] = {};
+  uint32_t _deadline_ms[MAX_CHANNELS] = {};
+  uint8_t _armed = 0;          // bit per channel: fed and not yet stale
+  uint8_t _tripped = 0;        // bit per channel: stale, action has run
+  uint8_t _hw_mask = 0;        // bit per hardware channel
+  uint32_t _next_ms = 0;       // earliest deadline among _armed
+  bool _kick = false;
+
+  uint16_t _trips = 0;
+  uint8_t _reset_flags = 0;
+  ResetCause _cause = ResetCause::UNKNOWN;
+};
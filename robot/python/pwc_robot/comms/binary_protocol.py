@@ -0,0 +1,935 @@
+"""
+pwc_robot/comms/binary_protocol.py
+
+Compact binary wire protocol for Arduino <-> Laptop communication.
+
+Design:
+- Packet  = [type u8][payload ...][crc16 u16 little-endian]
+- CRC16   = CRC-16/CCITT-FALSE over type+payload (binascii.crc_hqx, init 0xFFFF)
+- Framing = COBS-encoded packet followed by a single 0x00 delimiter
+- Payloads are fixed-layout little-endian structs
+
+Must mirror:
+  apwcr_firmware/src/comms/BinaryProtocol.h
+The payload layouts themselves come from schema.py, generated from the
+firmware's src/comms/Schema.h (apwcr_firmware/scripts/gen_schema.py).
+
+This module does not do serial I/O. serial_link.py owns the port.
+"""
+
+from __future__ import annotations
+
+import binascii
+import json
+import math
+import struct
+from typing import Iterable, List, Optional, Tuple
+
+from pwc_robot.controller.commands import (
+    DriveCommand,
+    MechanismCommand,
+    MechMotorCommand,
+    MechMotorMode,
+)
+
+from pwc_robot.comms import schema
+from pwc_robot.comms.types import (
+    Telemetry,
+    WheelState,
+    PoseState,
+    MechanismState,
+    UltrasonicState,
+    SonarArray,
+    PerfReport,
+    LoopPerf,
+    MemPerf,
+    ServoPerf,
+    TaskPerf,
+    EncoderBatch,
+    EncoderSample,
+    SequenceStatus,
+    Pong,
+    ParamReply,
+    LinkQuality,
+    RxCaptureRecord,
+    SysIdChunk,
+    Hello,
+    EventRecord,
+    EventLogChunk,
+)
+
+# -----------------------------
+# Packet types
+# -----------------------------
+PKT_CMD = 0x01
+PKT_LINK = 0x02
+PKT_SUBSCRIBE = 0x03
+PKT_SEQUENCE = 0x04
+PKT_PING = 0x05
+PKT_POSE = 0x06
+PKT_PARAM = 0x07
+PKT_TEST = 0x08
+PKT_LOG = 0x09
+PKT_PATH = 0x0A
+PKT_TELEMETRY = 0x81
+PKT_PERF = 0x82
+PKT_WHEEL = 0x83
+PKT_ULTRASONIC = 0x84
+PKT_MECH = 0x85
+PKT_NOTE = 0x86
+PKT_SEQ_STATUS = 0x87
+PKT_PONG = 0x88
+PKT_LINK_STATS = 0x89
+PKT_PARAM_REPLY = 0x8A
+PKT_RX_CAPTURE = 0x8B
+PKT_SYSID = 0x8C
+PKT_HELLO = 0x8D
+PKT_EVENT_LOG = 0x8E
+
+WIRE_MODE_JSON = 0
+WIRE_MODE_BINARY = 1
+
+# -----------------------------
+# Payload layouts (generated from the firmware's Schema.h, see schema.py)
+# -----------------------------
+_CMD_STRUCT = struct.Struct(schema.COMMAND_PACKET.fmt)
+_CMD_CREDIT_STRUCT = struct.Struct(schema.COMMAND_CREDIT_PACKET.fmt)
+_TEL_STRUCT = struct.Struct(schema.TELEMETRY_PACKET.fmt)
+_PERF_HDR_STRUCT = struct.Struct(schema.PERF_HEADER_PACKET.fmt)
+_PERF_TASK_STRUCT = struct.Struct(schema.TASK_PERF_PACKET.fmt)
+_SUBSCRIBE_STRUCT = struct.Struct(schema.SUBSCRIBE_PACKET.fmt)
+_GROUP_HDR_STRUCT = struct.Struct(schema.GROUP_HEADER_PACKET.fmt)
+_WHEEL_STRUCT = struct.Struct(schema.WHEEL_PACKET.fmt)
+_ULTRASONIC_STRUCT = struct.Struct(schema.ULTRASONIC_PACKET.fmt)
+_MECH_STRUCT = struct.Struct(schema.MECH_PACKET.fmt)
+_ENC_BATCH_HDR_STRUCT = struct.Struct(schema.ENCODER_BATCH_HEADER_PACKET.fmt)
+_ENC_STEP_STRUCT = struct.Struct(schema.ENCODER_STEP_PACKET.fmt)
+_SEQ_HDR_STRUCT = struct.Struct(schema.SEQUENCE_PACKET.fmt)
+_SEQ_STEP_STRUCT = struct.Struct(schema.SEQ_STEP_PACKET.fmt)
+_SEQ_STATUS_STRUCT = struct.Struct(schema.SEQ_STATUS_PACKET.fmt)
+_PING_STRUCT = struct.Struct(schema.PING_PACKET.fmt)
+_POSE_RESET_STRUCT = struct.Struct(schema.POSE_RESET_PACKET.fmt)
+_PONG_STRUCT = struct.Struct(schema.PONG_PACKET.fmt)
+_LINK_STATS_STRUCT = struct.Struct(schema.LINK_STATS_PACKET.fmt)
+_PARAM_STRUCT = struct.Struct(schema.PARAM_PACKET.fmt)
+_PARAM_REPLY_STRUCT = struct.Struct(schema.PARAM_REPLY_PACKET.fmt)
+_TEST_STRUCT = struct.Struct(schema.TEST_PACKET.fmt)
+_RX_CAPTURE_STRUCT = struct.Struct(schema.RX_CAPTURE_PACKET.fmt)
+_SYSID_HDR_STRUCT = struct.Struct(schema.SYS_ID_HEADER_PACKET.fmt)
+_HELLO_STRUCT = struct.Struct(schema.HELLO_PACKET.fmt)
+_LOG_STRUCT = struct.Struct(schema.LOG_PACKET.fmt)
+_PATH_HDR_STRUCT = struct.Struct(schema.PATH_PACKET.fmt)
+_PATH_POINT_STRUCT = struct.Struct(schema.PATH_POINT_PACKET.fmt)
+_EVENT_LOG_HDR_STRUCT = struct.Struct(schema.EVENT_LOG_HEADER_PACKET.fmt)
+_EVENT_RECORD_STRUCT = struct.Struct(schema.EVENT_RECORD_PACKET.fmt)
+# SysIdSample is a firmware struct (Messages.h), not a schema layout
+_SYSID_SAMPLE_STRUCT = struct.Struct("<bhh")
+
+TEL_FLAG_ULTRASONIC_VALID = 0x01
+TEL_FLAG_ENCODER_BATCH = 0x02
+TEL_FLAG_HOST_TIME = 0x04
+TEL_FLAG_SONAR_ARRAY = 0x08
+TEL_FLAG_OBSTACLE_STOP = 0x10
+
+_SONAR_NO_TRACK = 0xFFFF
+_POSE_SIGMA_SAT = 0xFFFF
+
+PONG_FLAG_SYNCED = 0x01
+PONG_FLAG_CMD_LATENCY = 0x02
+
+# MechMotorMode wire values (firmware enum order: UNKNOWN, POS_DEG, DUTY)
+_MODE_TO_WIRE = {
+    "POS_DEG": 1,
+    "DUTY": 2,
+}
+
+
+# Parameter store wire values (firmware ParamOp / ParamStatus, PARAM_BY_NAME / PARAM_NO_INDEX)
+_PARAM_OPS = ("get", "set", "save", "load", "defaults")
+_PARAM_STATUSES = ("ok", "unknown", "range", "busy", "no_image")
+_PARAM_BY_NAME = 0xFF
+_PARAM_NO_INDEX = 0xFE
+
+# Firmware TestOp, from 1 (0 is NONE)
+_TEST_OPS = ("drive_step", "abort", "sysid_drive", "sysid_arm")
+_SYSID_TARGETS = ("drive", "arm")
+_HELLO_STAGES = ("link", "ready")   # firmware BootStage
+# Firmware LogOp, from 1 (0 is NONE), and EventId
+_LOG_OPS = ("dump", "clear")
+_EVENT_NAMES = (
+    "none", "boot", "cmd_applied", "watchdog_stale", "watchdog_fed",
+    "servo_detach", "servo_attach", "rx_overflow", "rx_fail", "tx_drop",
+    "link_mode", "obstacle_stop", "obstacle_clear", "seq_start", "seq_end",
+    "test_start", "path_start", "path_end", "drive_isr_stale",
+)
+# Firmware PathAction and PATH_MAX_POINTS
+PATH_ACTION_RUN = 1
+PATH_ACTION_ABORT = 2
+PATH_MAX_POINTS = 16
+_PARAM_NAME_BYTES = 24
+RX_CAPTURE_CHUNK_BYTES = 64
+
+
+# Sequencer wire values (firmware SeqAction / SeqId / SeqState / SeqOp)
+SEQ_ACTION_RUN = 1
+SEQ_ACTION_UPLOAD = 2
+SEQ_ACTION_ABORT = 3
+SEQ_MAX_STEPS = 16
+
+_SEQ_IDS = {"upload": 0, "pickup": 1, "stow": 2}
+_SEQ_ID_NAMES = {v: k for k, v in _SEQ_IDS.items()}
+_SEQ_STATES = ("idle", "running", "done", "aborted")
+
+# op name -> (wire op, host units -> SeqStep.arg scale)
+_SEQ_OPS = {
+    "lid": (1, 10.0),           # deg -> tenths
+    "sweep": (2, 10.0),
+    "wait_servos": (3, 1.0),
+    "wait_ms": (4, 1.0),
+    "drive": (5, 100.0),        # ft/s -> 0.01 ft/s
+    "turn": (6, 1.0),           # deg/s
+    "wait_travel": (7, 100.0),  # ft -> 0.01 ft
+}
+
+
+# -----------------------------
+# Framing primitives
+# -----------------------------
+
+def crc16(data: bytes) -> int:
+    return binascii.crc_hqx(data, 0xFFFF)
+
+
+def cobs_encode(data: bytes) -> bytes:
+    out = bytearray()
+    block = bytearray()
+
+    for b in data:
+        if b == 0:
+            out.append(len(block) + 1)
+            out += block
+            block.clear()
+            continue
+
+        block.append(b)
+        if len(block) == 254:
+            out.append(255)
+            out += block
+            block.clear()
+
+    out.append(len(block) + 1)
+    out += block
+    return bytes(out)
+
+
+def cobs_decode(data: bytes) -> Optional[bytes]:
+    out = bytearray()
+    i = 0
+    n = len(data)
+
+    while i < n:
+        code = data[i]
+        i += 1
+        if code == 0 or i + code - 1 > n:
+            return None
+
+        out += data[i:i + code - 1]
+        i += code - 1
+
+        if code != 255 and i < n:
+            out.append(0)
+
+    return bytes(out)
+
+
+def _frame(pkt_type: int, payload: bytes) -> bytes:
+    pkt = bytes([pkt_type]) + payload
+    pkt += struct.pack("<H", crc16(pkt))
+    return cobs_encode(pkt) + b"\x00"
+
+
+def _unframe(frame: bytes) -> Optional[bytes]:
+    """COBS frame without delimiter -> type+payload, or None on error."""
+    pkt = cobs_decode(frame)
+    if pkt is None or len(pkt) < 3:
+        return None
+
+    (rx_crc,) = struct.unpack("<H", pkt[-2:])
+    if crc16(pkt[:-2]) != rx_crc:
+        return None
+    return pkt[:-2]
+
+
+# -----------------------------
+# Encoding (Laptop -> Arduino)
+# -----------------------------
+
+def encode_link_request_line(binary: bool) -> bytes:
+    """
+    JSON link-control frame asking the firmware to switch wire mode.
+
+    A trailing 0x00 is appended so a firmware that already speaks binary
+    treats the line as one (rejected) frame and stays in sync.
+    """
+    frame = {"type": "link", "mode": "binary" if binary else "json"}
+    s = json.dumps(frame, separators=(",", ":"))
+    return (s + "\n").encode("utf-8") + b"\x00"
+
+
+def encode_link_frame(binary: bool) -> bytes:
+    mode = WIRE_MODE_BINARY if binary else WIRE_MODE_JSON
+    return _frame(PKT_LINK, bytes([mode]))
+
+
+def encode_command_frame(
+    *,
+    seq: int,
+    host_time_ms: int,
+    drive: DriveCommand,
+    mech: MechanismCommand,
+    at_ms: Optional[int] = None,
+    tel_ack: Optional[int] = None,
+) -> bytes:
+    """
+    at_ms and tel_ack as in protocol.encode_command_line (None = apply on
+    arrival / no telemetry credit).
+    """
+    def motor(m: Optional[MechMotorCommand]):
+        if m is None:
+            return 0, 0.0
+        mode = m.mode.value if isinstance(m.mode, MechMotorMode) else str(m.mode)
+        return _MODE_TO_WIRE.get(mode, 0), float(m.value)
+
+    def opt(v: Optional[float]) -> float:
+        return math.nan if v is None else float(v)
+
+    rhs_mode, rhs_val = motor(mech.motor_RHS)
+    lhs_mode, lhs_val = motor(mech.motor_LHS)
+
+    payload = _CMD_STRUCT.pack(
+        int(seq) & 0xFFFFFFFF,
+        int(host_time_ms) & 0xFFFFFFFF,
+        0 if at_ms is None else (int(at_ms) & 0xFFFFFFFF) or 1,   # 0 = now on the wire
+        float(drive.linear),
+        float(drive.angular),
+        rhs_mode, rhs_val,
+        lhs_mode, lhs_val,
+        opt(mech.servo_LID_deg),
+        opt(mech.servo_SWEEP_deg),
+    )
+    if tel_ack is not None:
+        payload += _CMD_CREDIT_STRUCT.pack(int(tel_ack) & 0xFFFF)
+    return _frame(PKT_CMD, payload)
+
+
+def encode_subscribe_frame(
+    *,
+    telemetry: int = 0,
+    wheel: int = 0,
+    ultrasonic: int = 0,
+    mech: int = 0,
+    note: bool = False,
+) -> bytes:
+    """Binary twin of protocol.encode_subscribe_line (rates in Hz, 0 = off)."""
+    def hz(v: int) -> int:
+        return max(0, min(0xFFFF, int(v)))
+
+    payload = _SUBSCRIBE_STRUCT.pack(hz(telemetry), hz(wheel), hz(ultrasonic), hz(mech), 1 if note else 0)
+    return _frame(PKT_SUBSCRIBE, payload)
+
+
+def encode_sequence_frame(
+    *,
+    run: Optional[str] = None,
+    steps: Optional[Iterable[Tuple[str, float, int]]] = None,
+    abort: bool = False,
+) -> bytes:
+    """Binary twin of protocol.encode_sequence_line (same arguments and units)."""
+    if abort:
+        return _frame(PKT_SEQUENCE, _SEQ_HDR_STRUCT.pack(SEQ_ACTION_ABORT, 0, 0))
+
+    if steps is None:
+        if run not in _SEQ_IDS or run == "upload":
+            raise ValueError(f"unknown sequence {run!r}")
+        return _frame(PKT_SEQUENCE, _SEQ_HDR_STRUCT.pack(SEQ_ACTION_RUN, _SEQ_IDS[run], 0))
+
+    body = bytearray()
+    count = 0
+    for op, arg, timeout_ms in steps:
+        if op not in _SEQ_OPS:
+            raise ValueError(f"unknown sequence op {op!r}")
+        wire_op, scale = _SEQ_OPS[op]
+        v = max(-32768, min(32767, int(round(float(arg) * scale))))
+        body += _SEQ_STEP_STRUCT.pack(wire_op, v, max(0, min(0xFFFF, int(timeout_ms))))
+        count += 1
+    if not 0 < count <= SEQ_MAX_STEPS:
+        raise ValueError(f"sequence needs 1..{SEQ_MAX_STEPS} steps, got {count}")
+
+    return _frame(PKT_SEQUENCE, _SEQ_HDR_STRUCT.pack(SEQ_ACTION_UPLOAD, 0, count) + bytes(body))
+
+
+def encode_ping_frame(*, ping_id: int, t1_us: int, prev_id: int = 0, prev_t4_us: int = 0) -> bytes:
+    """Binary twin of protocol.encode_ping_line (same arguments and units)."""
+    payload = _PING_STRUCT.pack(
+        int(ping_id) & 0xFFFF,
+        int(t1_us) & 0xFFFFFFFF,
+        int(prev_id) & 0xFFFF,
+        int(prev_t4_us) & 0xFFFFFFFF,
+    )
+    return _frame(PKT_PING, payload)
+
+
+def encode_pose_frame(*, x_ft: float = 0.0, y_ft: float = 0.0, heading_deg: float = 0.0) -> bytes:
+    """Binary twin of protocol.encode_pose_line (same arguments and units)."""
+    return _frame(PKT_POSE, _POSE_RESET_STRUCT.pack(float(x_ft), float(y_ft), float(heading_deg)))
+
+
+def encode_param_frame(
+    *,
+    op: str,
+    name: Optional[str] = None,
+    index: Optional[int] = None,
+    value: Optional[float] = None,
+) -> bytes:
+    """Binary twin of protocol.encode_param_line (same arguments)."""
+    if op not in _PARAM_OPS:
+        raise ValueError(f"unknown param op {op!r}, expected one of {_PARAM_OPS}")
+    if op in ("get", "set") and name is None and index is None:
+        raise ValueError(f"param {op} needs a name or an index")
+    if op == "set" and value is None:
+        raise ValueError("param set needs a value")
+    raw_name = (name or "").encode("ascii")
+    if len(raw_name) >= _PARAM_NAME_BYTES:
+        raise ValueError(f"param name longer than {_PARAM_NAME_BYTES - 1} characters: {name!r}")
+    if index is not None and not 0 <= int(index) < _PARAM_NO_INDEX:
+        raise ValueError(f"param index out of range: {index}")
+
+    payload = _PARAM_STRUCT.pack(
+        _PARAM_OPS.index(op),
+        _PARAM_BY_NAME if index is None else int(index),
+        math.nan if value is None else float(value),
+        raw_name,
+    )
+    return _frame(PKT_PARAM, payload)
+
+
+def encode_test_frame(*, op: str, value: Optional[float] = None) -> bytes:
+    """Binary twin of protocol.encode_test_line (same arguments)."""
+    if op not in _TEST_OPS:
+        raise ValueError(f"unknown test op {op!r}, expected one of {_TEST_OPS}")
+    payload = _TEST_STRUCT.pack(_TEST_OPS.index(op) + 1, math.nan if value is None else float(value))
+    return _frame(PKT_TEST, payload)
+
+
+def encode_log_frame(*, op: str) -> bytes:
+    """Binary twin of protocol.encode_log_line (same arguments)."""
+    if op not in _LOG_OPS:
+        raise ValueError(f"unknown log op {op!r}, expected one of {_LOG_OPS}")
+    return _frame(PKT_LOG, _LOG_STRUCT.pack(_LOG_OPS.index(op) + 1))
+
+
+def encode_path_frame(
+    *,
+    points: Optional[Iterable[Tuple[float, float]]] = None,
+    speed_ftps: Optional[float] = None,
+    lookahead_ft: Optional[float] = None,
+    abort: bool = False,
+) -> bytes:
+    """Binary twin of protocol.encode_path_line (same arguments and units)."""
+    if abort:
+        return _frame(PKT_PATH, _PATH_HDR_STRUCT.pack(PATH_ACTION_ABORT, 0, math.nan, math.nan))
+
+    body = bytearray()
+    count = 0
+    for x, y in points or ():
+        x, y = float(x), float(y)
+        if not (math.isfinite(x) and math.isfinite(y)):
+            raise ValueError(f"path point is not finite: ({x}, {y})")
+        body += _PATH_POINT_STRUCT.pack(x, y)
+        count += 1
+    if not 0 < count <= PATH_MAX_POINTS:
+        raise ValueError(f"path needs 1..{PATH_MAX_POINTS} points, got {count}")
+
+    header = _PATH_HDR_STRUCT.pack(
+        PATH_ACTION_RUN,
+        count,
+        math.nan if speed_ftps is None else float(speed_ftps),
+        math.nan if lookahead_ft is None else float(lookahead_ft),
+    )
+    return _frame(PKT_PATH, header + bytes(body))
+
+
+def encode_rx_capture_frame(*, t_us: int, seq: int, data: bytes) -> bytes:
+    """
+    One RX capture record, as the firmware's RxRecorder writes it. Not sent
+    to the Arduino: for building synthetic captures (native/captures).
+    """
+    if len(data) > RX_CAPTURE_CHUNK_BYTES:
+        raise ValueError(f"capture record longer than {RX_CAPTURE_CHUNK_BYTES} bytes")
+    return _frame(PKT_RX_CAPTURE, _RX_CAPTURE_STRUCT.pack(int(t_us) & 0xFFFFFFFF, int(seq) & 0xFF) + bytes(data))
+
+
+# -----------------------------
+# Decoding (Arduino -> Laptop)
+# -----------------------------
+
+def decode_frame(frame: bytes):
+    """
+    Decode one COBS frame (0x00 delimiter already stripped).
+
+    Returns a Telemetry (per-group packets set .group), a PerfReport, a
+    SequenceStatus, a Pong, a LinkQuality, a ParamReply, an
+    RxCaptureRecord, a SysIdChunk, a Hello, an EventLogChunk, or None.
+    """
+    pkt = _unframe(frame)
+    if pkt is None:
+        return None
+    if pkt[0] == PKT_TELEMETRY:
+        return _decode_telemetry_payload(pkt[1:])
+    if pkt[0] == PKT_PERF:
+        return _decode_perf_payload(pkt[1:])
+    if pkt[0] in (PKT_WHEEL, PKT_ULTRASONIC, PKT_MECH, PKT_NOTE):
+        return _decode_group_payload(pkt[0], pkt[1:])
+    if pkt[0] == PKT_SEQ_STATUS:
+        return _decode_sequence_payload(pkt[1:])
+    if pkt[0] == PKT_PONG:
+        return _decode_pong_payload(pkt[1:])
+    if pkt[0] == PKT_LINK_STATS:
+        return _decode_link_stats_payload(pkt[1:])
+    if pkt[0] == PKT_PARAM_REPLY:
+        return _decode_param_reply_payload(pkt[1:])
+    if pkt[0] == PKT_RX_CAPTURE:
+        return _decode_rx_capture_payload(pkt[1:])
+    if pkt[0] == PKT_SYSID:
+        return _decode_sysid_payload(pkt[1:])
+    if pkt[0] == PKT_HELLO:
+        return _decode_hello_payload(pkt[1:])
+    if pkt[0] == PKT_EVENT_LOG:
+        return _decode_event_log_payload(pkt[1:])
+    return None
+
+
+def _decode_rx_capture_payload(body: bytes) -> Optional[RxCaptureRecord]:
+    n = len(body) - _RX_CAPTURE_STRUCT.size
+    if n < 0 or n > RX_CAPTURE_CHUNK_BYTES:
+        return None
+    t_us, seq = _RX_CAPTURE_STRUCT.unpack_from(body)
+    return RxCaptureRecord(t_us=t_us, seq=seq, data=bytes(body[_RX_CAPTURE_STRUCT.size:]))
+
+
+def _decode_sysid_payload(body: bytes) -> Optional[SysIdChunk]:
+    n, rem = divmod(len(body) - _SYSID_HDR_STRUCT.size, _SYSID_SAMPLE_STRUCT.size)
+    if n < 0 or rem:
+        return None
+    target, gen, period_ms, units_per_count, first, total = _SYSID_HDR_STRUCT.unpack_from(body)
+    if target >= len(_SYSID_TARGETS):
+        return None
+    samples = [
+        (duty / 127.0, d0, d1)
+        for duty, d0, d1 in _SYSID_SAMPLE_STRUCT.iter_unpack(body[_SYSID_HDR_STRUCT.size:])
+    ]
+    return SysIdChunk(
+        target=_SYSID_TARGETS[target],
+        gen=gen,
+        period_ms=period_ms,
+        units_per_count=units_per_count,
+        first=first,
+        total=total,
+        samples=samples,
+    )
+
+
+def _decode_event_log_payload(body: bytes) -> Optional[EventLogChunk]:
+    n, rem = divmod(len(body) - _EVENT_LOG_HDR_STRUCT.size, _EVENT_RECORD_STRUCT.size)
+    if n < 0 or rem:
+        return None
+    first, end = _EVENT_LOG_HDR_STRUCT.unpack_from(body)
+    records = [
+        EventRecord(
+            number=(first + i) & 0xFFFF,
+            t_ms=t_ms,
+            event=_EVENT_NAMES[eid] if eid < len(_EVENT_NAMES) else f"event_{eid}",
+            count=count,
+            a=a,
+            b=b,
+        )
+        for i, (t_ms, eid, count, a, b) in enumerate(
+            _EVENT_RECORD_STRUCT.iter_unpack(body[_EVENT_LOG_HDR_STRUCT.size:]))
+    ]
+    return EventLogChunk(first=first, end=end, records=records)
+
+
+def _decode_hello_payload(body: bytes) -> Optional[Hello]:
+    if len(body) != _HELLO_STRUCT.size:
+        return None
+    t_ms, stage, fw, proto, features, reset_flags, link_us, setup_us, first_tel_us, build = \
+        _HELLO_STRUCT.unpack(body)
+    return Hello(
+        arduino_time_ms=t_ms,
+        stage=_HELLO_STAGES[stage] if stage < len(_HELLO_STAGES) else "link",
+        fw=fw,
+        build=build.split(b"\x00", 1)[0].decode("ascii", "replace"),
+        proto=proto,
+        features=features,
+        reset_flags=reset_flags,
+        link_us=link_us,
+        setup_us=setup_us,
+        first_tel_us=first_tel_us,
+    )
+
+
+def _decode_param_reply_payload(body: bytes) -> Optional[ParamReply]:
+    if len(body) != _PARAM_REPLY_STRUCT.size:
+        return None
+    op, status, index, count, value, lo, hi, name = _PARAM_REPLY_STRUCT.unpack(body)
+    if op >= len(_PARAM_OPS) or status >= len(_PARAM_STATUSES):
+        return None
+    reply = ParamReply(op=_PARAM_OPS[op], status=_PARAM_STATUSES[status], count=count)
+    if index != _PARAM_NO_INDEX:
+        reply.index = index
+        reply.name = name.split(b"\x00", 1)[0].decode("ascii", "replace")
+        reply.value = float(value)
+        reply.min = float(lo)
+        reply.max = float(hi)
+    return reply
+
+
+def _decode_link_stats_payload(body: bytes) -> Optional[LinkQuality]:
+    if len(body) != _LINK_STATS_STRUCT.size:
+        return None
+    v = _LINK_STATS_STRUCT.unpack(body)
+    return LinkQuality(
+        arduino_time_ms=v[0],
+        window_ms=v[1],
+        frames=v[2],
+        ok=v[3],
+        fail=v[4],
+        ovf=v[5],
+        max_frame=v[6],
+        seq_gaps=v[7],
+        seq_stale=v[8],
+        rx_hwm=v[9],
+        tel_held=v[10],
+        tel_unread_max=v[11],
+        parse_n=v[12],
+        parse_min_us=v[13],
+        parse_max_us=v[14],
+        parse_mean_us=v[15],
+        cmd_n=v[16],
+        cmd_gap_min_us=v[17] * 1000,   # ms on the wire
+        cmd_gap_max_us=v[18] * 1000,
+        cmd_gap_mean_us=v[19] * 1000,
+        jitter_hist=list(v[20:]),
+    )
+
+
+def _decode_pong_payload(body: bytes) -> Optional[Pong]:
+    if len(body) != _PONG_STRUCT.size:
+        return None
+    ping_id, t1, t2, t3, flags, offset, drift, delay, latency = _PONG_STRUCT.unpack(body)
+    return Pong(
+        id=ping_id,
+        t1_us=t1,
+        t2_us=t2,
+        t3_us=t3,
+        synced=bool(flags & PONG_FLAG_SYNCED),
+        offset_us=offset,
+        drift_ppm=float(drift),
+        delay_us=delay,
+        cmd_latency_us=latency if flags & PONG_FLAG_CMD_LATENCY else None,
+    )
+
+
+def _decode_sequence_payload(body: bytes) -> Optional[SequenceStatus]:
+    if len(body) != _SEQ_STATUS_STRUCT.size:
+        return None
+    t_ms, seq_id, state, step, steps, timeouts = _SEQ_STATUS_STRUCT.unpack(body)
+    return SequenceStatus(
+        arduino_time_ms=t_ms,
+        name=_SEQ_ID_NAMES.get(seq_id, "upload"),
+        state=_SEQ_STATES[state] if state < len(_SEQ_STATES) else "idle",
+        step=step,
+        steps=steps,
+        timeouts=timeouts,
+    )
+
+
+def _decode_group_payload(pkt_type: int, body: bytes) -> Optional[Telemetry]:
+    def f(v: float) -> Optional[float]:
+        return None if math.isnan(v) else float(v)
+
+    def host(v: int) -> Optional[int]:
+        return v or None   # 0 = clock sync not converged
+
+    if pkt_type == PKT_WHEEL:
+        if len(body) < _WHEEL_STRUCT.size:
+            return None
+        t_ms, tel_seq, ack, qd, qf, host_us, left, right, *pose = _WHEEL_STRUCT.unpack_from(body)
+        encoders = None
+        if len(body) > _WHEEL_STRUCT.size:
+            encoders, used = _decode_encoder_batch(body, _WHEEL_STRUCT.size)
+            if encoders is None or used != len(body):
+                return None
+        return Telemetry(arduino_time_ms=t_ms, tel_seq=tel_seq, ack_seq=ack, queue_depth=qd, queue_free=qf,
+                         host_time_us=host(host_us), group="wheel",
+                         wheel=WheelState(left_rpm=f(left), right_rpm=f(right)),
+                         pose=_pose(*pose), encoders=encoders)
+
+    if pkt_type == PKT_ULTRASONIC:
+        if len(body) < _ULTRASONIC_STRUCT.size:
+            return None
+        t_ms, tel_seq, ack, qd, qf, host_us, distance_in, closing, conf, flags = _ULTRASONIC_STRUCT.unpack_from(body)
+        sonar = None
+        if len(body) > _ULTRASONIC_STRUCT.size:
+            sonar, used = _decode_sonar_array(body, _ULTRASONIC_STRUCT.size)
+            if sonar is None or used != len(body):
+                return None
+        valid = bool(flags & TEL_FLAG_ULTRASONIC_VALID)
+        return Telemetry(arduino_time_ms=t_ms, tel_seq=tel_seq, ack_seq=ack, queue_depth=qd, queue_free=qf,
+                         host_time_us=host(host_us), group="ultrasonic",
+                         ultrasonic=UltrasonicState(
+                             distance_in=f(distance_in) if valid else None,
+                             valid=valid,
+                             closing_in_s=f(closing) if valid else None,
+                             confidence=conf / 255.0,
+                             obstacle_stop=bool(flags & TEL_FLAG_OBSTACLE_STOP),
+                         ),
+                         sonar=sonar)
+
+    if pkt_type == PKT_MECH:
+        if len(body) != _MECH_STRUCT.size:
+            return None
+        t_ms, tel_seq, ack, qd, qf, host_us, lid, sweep, rhs, lhs = _MECH_STRUCT.unpack(body)
+        return Telemetry(arduino_time_ms=t_ms, tel_seq=tel_seq, ack_seq=ack, queue_depth=qd, queue_free=qf,
+                         host_time_us=host(host_us), group="mech",
+                         mech=MechanismState(
+                             servo_LID_deg=f(lid),
+                             servo_SWEEP_deg=f(sweep),
+                             motor_RHS_deg=f(rhs),
+                             motor_LHS_deg=f(lhs),
+                         ))
+
+    if len(body) < _GROUP_HDR_STRUCT.size:
+        return None
+    t_ms, ack, qd, qf, host_us = _GROUP_HDR_STRUCT.unpack_from(body)
+    note_raw = body[_GROUP_HDR_STRUCT.size:]
+    return Telemetry(arduino_time_ms=t_ms, tel_seq=tel_seq, ack_seq=ack, queue_depth=qd, queue_free=qf,
+                     host_time_us=host(host_us), group="note",
+                     note=note_raw.decode("utf-8", errors="replace") if note_raw else None)
+
+
+def decode_telemetry_frame(frame: bytes) -> Optional[Telemetry]:
+    """Decode one COBS frame (0x00 delimiter already stripped)."""
+    pkt = _unframe(frame)
+    if pkt is None or pkt[0] != PKT_TELEMETRY:
+        return None
+    return _decode_telemetry_payload(pkt[1:])
+
+
+def decode_perf_frame(frame: bytes) -> Optional[PerfReport]:
+    """Decode one perf COBS frame (0x00 delimiter already stripped)."""
+    pkt = _unframe(frame)
+    if pkt is None or pkt[0] != PKT_PERF:
+        return None
+    return _decode_perf_payload(pkt[1:])
+
+
+def _decode_perf_payload(body: bytes) -> Optional[PerfReport]:
+    if len(body) < _PERF_HDR_STRUCT.size:
+        return None
+
+    (
+        arduino_time_ms,
+        window_ms,
+        loop_count,
+        loop_min,
+        loop_max,
+        loop_mean,
+        loop_idle,
+        mem_static,
+        mem_stack_peak,
+        mem_free_min,
+        mem_free_now,
+        servo_attached,
+        servo_active,
+        servo_isr_ppm,
+        servo_detaches,
+        task_count,
+    ) = _PERF_HDR_STRUCT.unpack_from(body)
+
+    if len(body) < _PERF_HDR_STRUCT.size + task_count * _PERF_TASK_STRUCT.size:
+        return None
+
+    tasks = []
+    off = _PERF_HDR_STRUCT.size
+    for _ in range(task_count):
+        name, runs, overruns, tmin, tmax, tmean, p99 = _PERF_TASK_STRUCT.unpack_from(body, off)
+        off += _PERF_TASK_STRUCT.size
+        tasks.append(TaskPerf(
+            name=name.rstrip(b"\x00").decode("ascii", errors="replace"),
+            runs=runs,
+            overruns=overruns,
+            min_us=tmin,
+            max_us=tmax,
+            mean_us=tmean,
+            p99_us=p99,
+        ))
+
+    return PerfReport(
+        arduino_time_ms=arduino_time_ms,
+        window_ms=window_ms,
+        loop=LoopPerf(
+            count=loop_count,
+            min_us=loop_min,
+            max_us=loop_max,
+            mean_us=loop_mean,
+            jitter_us=max(0, loop_max - loop_min),
+            idle_permille=loop_idle,
+        ),
+        tasks=tasks,
+        mem=MemPerf(
+            static_bytes=mem_static,
+            stack_peak=mem_stack_peak,
+            free_min=mem_free_min,
+            free_now=mem_free_now,
+        ),
+        servo=ServoPerf(
+            attached=servo_attached,
+            active_permille=servo_active,
+            isr_ppm=servo_isr_ppm,
+            detaches=servo_detaches,
+        ),
+    )
+
+
+def _decode_encoder_batch(body: bytes, off: int):
+    """EncoderBatch at body[off:] -> (EncoderBatch, end offset), or (None, off)."""
+    if len(body) < off + _ENC_BATCH_HDR_STRUCT.size:
+        return None, off
+
+    count, overflows, t_us, left, right = _ENC_BATCH_HDR_STRUCT.unpack_from(body, off)
+    off += _ENC_BATCH_HDR_STRUCT.size
+    if count == 0 or len(body) < off + (count - 1) * _ENC_STEP_STRUCT.size:
+        return None, off
+
+    samples = [EncoderSample(t_us=t_us, left_count=left, right_count=right)]
+    for _ in range(count - 1):
+        dt_us, dl, dr = _ENC_STEP_STRUCT.unpack_from(body, off)
+        off += _ENC_STEP_STRUCT.size
+        t_us = (t_us + dt_us) & 0xFFFFFFFF
+        left += dl
+        right += dr
+        samples.append(EncoderSample(t_us=t_us, left_count=left, right_count=right))
+
+    return EncoderBatch(samples=samples, overflows=overflows), off
+
+
+def _decode_sonar_array(body: bytes, off: int):
+    """SonarArray block at body[off:] -> (SonarArray, end offset), or (None, off)."""
+    if len(body) < off + 2:
+        return None, off
+    count, valid_mask = body[off], body[off + 1]
+    off += 2
+    if len(body) < off + 5 * count:
+        return None, off
+
+    dist = struct.unpack_from(f"<{count}H", body, off)
+    off += 2 * count
+    closing = struct.unpack_from(f"<{count}h", body, off)
+    off += 2 * count
+    conf = body[off:off + count]
+    off += count
+
+    d: List[Optional[float]] = []
+    c: List[Optional[float]] = []
+    for i in range(count):
+        ok = bool(valid_mask & (1 << i)) and dist[i] != _SONAR_NO_TRACK
+        d.append(dist[i] / 100.0 if ok else None)
+        c.append(closing[i] / 10.0 if ok else None)
+    return SonarArray(distance_in=d, closing_in_s=c, confidence=[q / 255.0 for q in conf]), off
+
+
+def _pose(x: float, y: float, heading: float, sigma_xy_mft: int, sigma_heading_cdeg: int) -> PoseState:
+    def sigma(v: int, scale: float) -> Optional[float]:
+        return None if v == _POSE_SIGMA_SAT else v / scale
+
+    return PoseState(x_ft=float(x), y_ft=float(y), heading_deg=float(heading),
+                     sigma_xy_ft=sigma(sigma_xy_mft, 1000.0),
+                     sigma_heading_deg=sigma(sigma_heading_cdeg, 100.0))
+
+
+def _decode_telemetry_payload(body: bytes) -> Optional[Telemetry]:
+    if len(body) < _TEL_STRUCT.size:
+        return None
+
+    (
+        arduino_time_ms,
+        tel_seq,
+        ack_seq,
+        queue_depth,
+        queue_free,
+        host_time_us,
+        left_rpm,
+        right_rpm,
+        pose_x,
+        pose_y,
+        pose_heading,
+        pose_sigma_xy,
+        pose_sigma_heading,
+        servo_lid,
+        servo_sweep,
+        motor_rhs,
+        motor_lhs,
+        distance_in,
+        closing,
+        confidence,
+        flags,
+    ) = _TEL_STRUCT.unpack_from(body)
+
+    def f(v: float) -> Optional[float]:
+        return None if math.isnan(v) else float(v)
+
+    valid = bool(flags & TEL_FLAG_ULTRASONIC_VALID)
+
+    off = _TEL_STRUCT.size
+    encoders = None
+    if flags & TEL_FLAG_ENCODER_BATCH:
+        encoders, off = _decode_encoder_batch(body, off)
+        if encoders is None:
+            return None
+
+    sonar = None
+    if flags & TEL_FLAG_SONAR_ARRAY:
+        sonar, off = _decode_sonar_array(body, off)
+        if sonar is None:
+            return None
+
+    note_raw = body[off:]
+    note = note_raw.decode("utf-8", errors="replace") if note_raw else None
+
+    return Telemetry(
+        arduino_time_ms=arduino_time_ms,
+        tel_seq=tel_seq,
+        ack_seq=ack_seq,
+        queue_depth=queue_depth,
+        queue_free=queue_free,
+        host_time_us=host_time_us if flags & TEL_FLAG_HOST_TIME else None,
+        wheel=WheelState(left_rpm=f(left_rpm), right_rpm=f(right_rpm)),
+        pose=_pose(pose_x, pose_y, pose_heading, pose_sigma_xy, pose_sigma_heading),
+        mech=MechanismState(
+            servo_LID_deg=f(servo_lid),
+            servo_SWEEP_deg=f(servo_sweep),
+            motor_RHS_deg=f(motor_rhs),
+            motor_LHS_deg=f(motor_lhs),
+        ),
+        ultrasonic=UltrasonicState(
+            distance_in=f(distance_in) if valid else None,
+            valid=valid,
+            closing_in_s=f(closing) if valid else None,
+            confidence=confidence / 255.0,
+            obstacle_stop=bool(flags & TEL_FLAG_OBSTACLE_STOP),
+        ),
+        note=note,
+        encoders=encoders,
+        sonar=sonar,
+    )
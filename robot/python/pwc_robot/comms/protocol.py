@@ -11,12 +11,17 @@ Design:
 - Telemetry frames include ack_seq (last seq applied) as implicit ACK
 
 This module does not do serial I/O. serial_link.py owns the port.
+
+The wheel / mech value keys (JSON and delta) come from schema.py (generated from the
+firmware's Schema.h), so they always match what the Arduino writes.
 """
 
 from __future__ import annotations
 
+import copy
 import json
-from typing import Any, Dict, Optional
+import math
+from typing import Any, Dict, Iterable, Optional, Tuple
 
 from pwc_robot.controller.commands import (
     DriveCommand,
@@ -24,11 +29,24 @@ from pwc_robot.controller.commands import (
     MechMotorCommand,
 )
 
+from pwc_robot.comms import schema
 from pwc_robot.comms.types import (
     Telemetry,
     WheelState,
+    PoseState,
     MechanismState,
     UltrasonicState,
+    SonarArray,
+    PerfReport,
+    LoopPerf,
+    MemPerf,
+    ServoPerf,
+    TaskPerf,
+    SequenceStatus,
+    Pong,
+    ParamReply,
+    LinkQuality,
+    Hello,
 )
 
 # -----------------------------
@@ -36,6 +54,59 @@ from pwc_robot.comms.types import (
 # -----------------------------
 CMD_TYPE = "cmd"
 TEL_TYPE = "telemetry"
+TDELTA_TYPE = "tdelta"
+TLM_TYPE = "tlm"
+PERF_TYPE = "perf"
+SUBSCRIBE_TYPE = "subscribe"
+SEQ_TYPE = "seq"
+PING_TYPE = "ping"
+POSE_TYPE = "pose"
+PONG_TYPE = "pong"
+LINKSTATS_TYPE = "linkstats"
+PARAM_TYPE = "param"
+HELLO_TYPE = "hello"
+
+# Firmware boot hello stages (HelloFrame) and feature bits (FEATURE_*)
+HELLO_STAGES = ("link", "ready")
+FEATURE_NAMES = (
+    "encoder_sampler", "perf_report", "idle_sleep", "aux_link", "rx_capture",
+    "watchdog", "motion_profiles", "binary_at_boot", "delta_at_boot",
+    "scope_markers", "drive_isr_loop",
+)
+
+# Firmware parameter store (utils/ParamStore.h): request ops and reply statuses
+PARAM_OPS = ("get", "set", "save", "load", "defaults")
+PARAM_STATUSES = ("ok", "unknown", "range", "busy", "no_image")
+PARAM_NAME_MAX = 23
+
+# Built-in test modes (firmware TestRequest)
+TEST_TYPE = "test"
+TEST_OPS = ("drive_step", "abort", "sysid_drive", "sysid_arm")
+
+# Firmware event log (utils/EventLog.h): request ops and EventId names
+LOG_TYPE = "log"
+LOG_OPS = ("dump", "clear")
+EVENT_NAMES = (
+    "none", "boot", "cmd_applied", "watchdog_stale", "watchdog_fed",
+    "servo_detach", "servo_attach", "rx_overflow", "rx_fail", "tx_drop",
+    "link_mode", "obstacle_stop", "obstacle_clear", "seq_start", "seq_end",
+    "test_start", "path_start", "path_end", "drive_isr_stale",
+)
+
+# Firmware path follower (control/PathFollower.h): waypoints in the
+# odometry frame (ft), followed from the robot's pose at arrival
+PATH_TYPE = "path"
+PATH_MAX_POINTS = 16
+
+# Firmware sequencer (control/Sequencer.h): built-in names and the step
+# ops an upload may use. Upload args are in host units: lid/sweep deg,
+# drive ft/s, turn deg/s, wait_travel ft, wait_ms ms.
+SEQ_NAMES = ("pickup", "stow")
+SEQ_OPS = ("lid", "sweep", "wait_servos", "wait_ms", "drive", "turn", "wait_travel")
+SEQ_MAX_STEPS = 16
+
+# Per-group telemetry frames (after a subscribe), Telemetry.group values
+GROUP_TYPES = ("wheel", "ultrasonic", "mech", "note")
 
 
 # -----------------------------
@@ -48,15 +119,28 @@ def encode_command_frame(
     host_time_ms: int,
     drive: DriveCommand,
     mech: MechanismCommand,
+    at_ms: Optional[int] = None,
+    tel_ack: Optional[int] = None,
 ) -> bytes:
     """
     Encode a full command frame for Arduino (one JSON line).
 
+    at_ms (Arduino millis(), optional): queue the setpoint and apply it at
+    that time instead of on arrival. Must not go backwards within a burst
+    and may be at most ~2 s ahead; an untimed command drops the queue.
+
+    tel_ack (optional): tel_seq of the newest telemetry read. With it the
+    firmware keeps at most TELEMETRY_CREDIT_FRAMES publications unread and
+    holds the rest, so a host that falls behind reads fresh frames rather
+    than a backlog.
+
     Schema:
       {
         "type": "cmd",
         "seq": <int>,
         "host_time_ms": <int>,
+        "at_ms": <int>,              (optional)
+        "tel_ack": <int>,            (optional)
         "drive": {"linear": <float>, "angular": <float>},
         "mech": {
           "motor_RHS": {"mode": "POS_DEG", "value": 12.3} | null,
@@ -76,6 +160,10 @@ def encode_command_frame(
         },
         "mech": _encode_mech(mech),
     }
+    if at_ms is not None:
+        frame["at_ms"] = int(at_ms) & 0xFFFFFFFF
+    if tel_ack is not None:
+        frame["tel_ack"] = int(tel_ack) & 0xFFFF
 
     s = json.dumps(frame, separators=(",", ":"), ensure_ascii=False)
     return (s + "\n").encode("utf-8")
@@ -95,6 +183,269 @@ def _encode_mech(mech: MechanismCommand) -> Dict[str, Any]:
     }
 
 
+def encode_tlm_control_line(*, delta: Optional[bool] = None, keyframe: bool = False) -> bytes:
+    """
+    Telemetry control frame (JSON wire mode).
+
+    Schema:
+      {"type": "tlm", "delta": 0 | 1, "keyframe": 1}   (both keys optional)
+
+    delta turns "tdelta" frames on/off; keyframe asks for a full frame next.
+    """
+    frame: Dict[str, Any] = {"type": TLM_TYPE}
+    if delta is not None:
+        frame["delta"] = 1 if delta else 0
+    if keyframe:
+        frame["keyframe"] = 1
+    s = json.dumps(frame, separators=(",", ":"))
+    return (s + "\n").encode("utf-8")
+
+
+def encode_subscribe_line(
+    *,
+    telemetry: int = 0,
+    wheel: int = 0,
+    ultrasonic: int = 0,
+    mech: int = 0,
+    note: bool = False,
+) -> bytes:
+    """
+    Per-group telemetry subscription (rates in Hz, 0 = group off).
+
+    Schema:
+      {"type": "subscribe", "telemetry": Hz, "wheel": Hz, "ultrasonic": Hz,
+       "mech": Hz, "note": 0 | 1}
+
+    Replaces the whole subscription. All zero restores the firmware default
+    (full "telemetry" frames at the wire mode's rate). Rates above the
+    firmware's TELEMETRY_GROUP_MAX_HZ are capped.
+    """
+    frame = {
+        "type": SUBSCRIBE_TYPE,
+        "telemetry": int(telemetry),
+        "wheel": int(wheel),
+        "ultrasonic": int(ultrasonic),
+        "mech": int(mech),
+        "note": 1 if note else 0,
+    }
+    s = json.dumps(frame, separators=(",", ":"))
+    return (s + "\n").encode("utf-8")
+
+
+def encode_sequence_line(
+    *,
+    run: Optional[str] = None,
+    steps: Optional[Iterable[Tuple[str, float, int]]] = None,
+    abort: bool = False,
+) -> bytes:
+    """
+    Firmware sequencer control (exactly one of run / steps / abort).
+
+    Schema:
+      {"type": "seq", "run": "pickup" | "stow"}
+      {"type": "seq", "steps": [op, arg, timeout_ms, op, arg, timeout_ms, ...]}
+      {"type": "seq", "abort": 1}
+
+    steps is (op, arg, timeout_ms) tuples, op from SEQ_OPS. timeout_ms only
+    matters for wait_* ops (0 = firmware default); a wait that times out
+    moves on to the next step. An upload runs as soon as it arrives.
+    """
+    frame: Dict[str, Any] = {"type": SEQ_TYPE}
+    if abort:
+        frame["abort"] = 1
+    elif steps is not None:
+        frame["steps"] = _flatten_steps(steps)
+    elif run in SEQ_NAMES:
+        frame["run"] = run
+    else:
+        raise ValueError(f"unknown sequence {run!r}")
+    s = json.dumps(frame, separators=(",", ":"))
+    return (s + "\n").encode("utf-8")
+
+
+def encode_ping_line(*, ping_id: int, t1_us: int, prev_id: int = 0, prev_t4_us: int = 0) -> bytes:
+    """
+    Clock sync ping (firmware comms/TimeSync.h).
+
+    Schema:
+      {"type": "ping", "id": n, "t1_us": ..., "prev_id": n, "prev_t4_us": ...}
+
+    t1_us: host clock (epoch us mod 2^32) now. prev_id / prev_t4_us report
+    when the pong for the previous ping arrived, which completes that
+    exchange on the firmware side. ids are 1..65535 (0 = none).
+    """
+    frame = {
+        "type": PING_TYPE,
+        "id": int(ping_id) & 0xFFFF,
+        "t1_us": int(t1_us) & 0xFFFFFFFF,
+        "prev_id": int(prev_id) & 0xFFFF,
+        "prev_t4_us": int(prev_t4_us) & 0xFFFFFFFF,
+    }
+    s = json.dumps(frame, separators=(",", ":"))
+    return (s + "\n").encode("utf-8")
+
+
+def encode_pose_line(*, x_ft: float = 0.0, y_ft: float = 0.0, heading_deg: float = 0.0) -> bytes:
+    """
+    Reset the firmware's odometry pose (sensors/Odometry.h).
+
+    Schema:
+      {"type": "pose", "x_ft": <float>, "y_ft": <float>, "heading_deg": <float>}
+
+    Omitted fields default to 0 on the firmware too; the sigmas restart at 0.
+    """
+    frame = {
+        "type": POSE_TYPE,
+        "x_ft": float(x_ft),
+        "y_ft": float(y_ft),
+        "heading_deg": float(heading_deg),
+    }
+    s = json.dumps(frame, separators=(",", ":"))
+    return (s + "\n").encode("utf-8")
+
+
+def encode_test_line(*, op: str, value: Optional[float] = None) -> bytes:
+    """
+    Built-in test mode request (firmware control/DriveController step test,
+    control/SysId motor characterization).
+
+    Schema:
+      {"type": "test", "op": "drive_step" | "abort" | "sysid_drive" | "sysid_arm",
+       "value": <duty>}
+
+    drive_step runs the open-loop step test at duty `value` (firmware
+    default DRIVE_STEP_DUTY if omitted); keep sending commands while it
+    runs or the drive watchdog aborts it. The result arrives as one
+    "STEP ..." note.
+
+    sysid_drive / sysid_arm characterize the wheels / arm joints (step
+    duty `value`, default SYSID_*_DUTY): the same watchdog rule, a "SYSID
+    ..." note with the fit (the gains it seeded are staged; "save" keeps
+    them), then the capture as SysIdChunk frames (binary mode only).
+    """
+    if op not in TEST_OPS:
+        raise ValueError(f"unknown test op {op!r}, expected one of {TEST_OPS}")
+
+    frame: dict = {"type": TEST_TYPE, "op": op}
+    if value is not None:
+        frame["value"] = float(value)
+    s = json.dumps(frame, separators=(",", ":"))
+    return (s + "\n").encode("utf-8")
+
+
+def encode_log_line(*, op: str) -> bytes:
+    """
+    Event log request (firmware utils/EventLog).
+
+    Schema:
+      {"type": "log", "op": "dump" | "clear"}
+
+    dump streams the ring as EventLogChunk frames (binary mode only; JSON
+    mode answers with a note); clear empties it.
+    """
+    if op not in LOG_OPS:
+        raise ValueError(f"unknown log op {op!r}, expected one of {LOG_OPS}")
+    s = json.dumps({"type": LOG_TYPE, "op": op}, separators=(",", ":"))
+    return (s + "\n").encode("utf-8")
+
+
+def encode_path_line(
+    *,
+    points: Optional[Iterable[Tuple[float, float]]] = None,
+    speed_ftps: Optional[float] = None,
+    lookahead_ft: Optional[float] = None,
+    abort: bool = False,
+) -> bytes:
+    """
+    Firmware path following (points or abort).
+
+    Schema:
+      {"type": "path", "points": [x0, y0, x1, y1, ...], "speed": ft/s,
+       "lookahead": ft}
+      {"type": "path", "abort": 1}
+
+    points is 1..PATH_MAX_POINTS (x_ft, y_ft) waypoints in the odometry
+    frame (Telemetry.pose); the path starts at the robot. Sample a spline or
+    clothoid into points on this side. speed / lookahead default to the
+    firmware's PATH_DEFAULT_SPEED_FTPS / PATH_LOOKAHEAD_FT.
+    """
+    frame: Dict[str, Any] = {"type": PATH_TYPE}
+    if abort:
+        frame["abort"] = 1
+    else:
+        frame["points"] = _flatten_points(points or ())
+        if speed_ftps is not None:
+            frame["speed"] = float(speed_ftps)
+        if lookahead_ft is not None:
+            frame["lookahead"] = float(lookahead_ft)
+    s = json.dumps(frame, separators=(",", ":"))
+    return (s + "\n").encode("utf-8")
+
+
+def encode_param_line(
+    *,
+    op: str,
+    name: Optional[str] = None,
+    index: Optional[int] = None,
+    value: Optional[float] = None,
+) -> bytes:
+    """
+    Tuning parameter request (firmware utils/ParamStore.h).
+
+    Schema:
+      {"type": "param", "op": "get" | "set" | "save" | "load" | "defaults",
+       "name": "DRIVE_KP" | "index": n, "value": <float>}
+
+    get / set address one parameter by its Params.h name or by index
+    (index wins if both are given); set also needs value. save / load /
+    defaults act on the whole set. The firmware answers every request
+    with one "param" reply (decode_param_line).
+    """
+    if op not in PARAM_OPS:
+        raise ValueError(f"unknown param op {op!r}, expected one of {PARAM_OPS}")
+    if op in ("get", "set") and name is None and index is None:
+        raise ValueError(f"param {op} needs a name or an index")
+    if op == "set" and value is None:
+        raise ValueError("param set needs a value")
+    if name is not None and len(name) > PARAM_NAME_MAX:
+        raise ValueError(f"param name longer than {PARAM_NAME_MAX} characters: {name!r}")
+
+    frame: dict = {"type": PARAM_TYPE, "op": op}
+    if index is not None:
+        frame["index"] = int(index)
+    elif name is not None:
+        frame["name"] = str(name)
+    if value is not None:
+        frame["value"] = float(value)
+    s = json.dumps(frame, separators=(",", ":"))
+    return (s + "\n").encode("utf-8")
+
+
+def _flatten_steps(steps: Iterable[Tuple[str, float, int]]) -> list:
+    flat: list = []
+    for op, arg, timeout_ms in steps:
+        if op not in SEQ_OPS:
+            raise ValueError(f"unknown sequence op {op!r}")
+        flat += [op, float(arg), max(0, min(0xFFFF, int(timeout_ms)))]
+    n = len(flat) // 3
+    if not 0 < n <= SEQ_MAX_STEPS:
+        raise ValueError(f"sequence needs 1..{SEQ_MAX_STEPS} steps, got {n}")
+    return flat
+
+
+def _flatten_points(points: Iterable[Tuple[float, float]]) -> list:
+    flat: list = []
+    for x, y in points:
+        x, y = float(x), float(y)
+        if not (math.isfinite(x) and math.isfinite(y)):
+            raise ValueError(f"path point is not finite: ({x}, {y})")
+        flat += [x, y]
+    n = len(flat) // 2
+    if not 0 < n <= PATH_MAX_POINTS:
+        raise ValueError(f"path needs 1..{PATH_MAX_POINTS} points, got {n}")
+    return flat
+
+
 # -----------------------------
 # Decoding (Arduino -> Laptop)
 # -----------------------------
@@ -107,15 +458,23 @@ def decode_telemetry_line(line: str) -> Optional[Telemetry]:
       {
         "type": "telemetry",
         "arduino_time_ms": <int>,
+        "host_time_us": <int> | null,
+        "tel_seq": <int>,
         "ack_seq": <int>,
+        "queue_depth": <int>, "queue_free": <int>,
         "wheel": {"left_rpm": <float>, "right_rpm": <float>} | null,
+        "pose": {"x_ft": <float>, "y_ft": <float>, "heading_deg": <float>,
+                 "sigma_xy_ft": <float>, "sigma_heading_deg": <float>},
         "mech": {
           "servo_LID_deg": <float> | null,
           "servo_SWEEP_deg": <float> | null,
           "motor_RHS_deg": <float> | null,
           "motor_LHS_deg": <float> | null
         } | null,
-        "ultrasonic": {"distance_in": <float>, "valid": <bool>} | null,
+        "ultrasonic": {"distance_in": <float>, "valid": <bool>,
+                       "closing_inps": <float> | null, "confidence": <float>,
+                       "stop": <bool>} | null,
+        "sonar": {"valid": <mask>, "d": [...], "c": [...], "q": [...]},   (optional)
         "note": <str> | null
       }
     """
@@ -152,16 +511,236 @@ def decode_telemetry_line(line: str) -> Optional[Telemetry]:
     note_val = obj.get("note")
     note = str(note_val) if note_val is not None else None
 
+    frame = obj.get("frame")
+
     return Telemetry(
+        sonar=_decode_sonar(obj.get("sonar")),
         arduino_time_ms=arduino_time_ms,
         ack_seq=ack_seq,
+        tel_seq=_opt_int(obj.get("tel_seq")) or 0,
+        queue_depth=_opt_int(obj.get("queue_depth")) or 0,
+        queue_free=_opt_int(obj.get("queue_free")) or 0,
+        host_time_us=_opt_int(obj.get("host_time_us")),
         wheel=wheel,
+        pose=_decode_pose(obj.get("pose")),
         mech=mech,
         ultrasonic=ultrasonic,  
         note=note,
+        frame=int(frame) if isinstance(frame, int) else None,
     )
 
 
+class TelemetryDeltaDecoder:
+    """
+    Rebuilds full Telemetry from keyframes + "tdelta" frames.
+
+    Firmware side: comms/TelemetryDelta.h. A keyframe is a normal
+    "telemetry" line carrying "frame"; a "tdelta" line carries "frame",
+    "arduino_time_ms" and only the fields that changed.
+
+    A gap in "frame" means a frame was lost, so the rebuilt state can't be
+    trusted: deltas are ignored and need_keyframe stays True until the next
+    keyframe arrives (the caller should send encode_tlm_control_line(keyframe=True)).
+    """
+
+    def __init__(self) -> None:
+        self._state: Optional[Telemetry] = None
+        self._frame: Optional[int] = None
+        self.need_keyframe: bool = False
+        self.gaps: int = 0
+
+    def feed(self, line: str) -> Optional[Telemetry]:
+        """Returns the up-to-date Telemetry for a telemetry/tdelta line, else None."""
+        tel = decode_telemetry_line(line)
+        if tel is not None:
+            if tel.frame is not None:
+                self._state = tel
+                self._frame = tel.frame
+                self.need_keyframe = False
+            return tel
+
+        obj = _load_object(line)
+        if obj is None or obj.get("type") != TDELTA_TYPE:
+            return None
+
+        try:
+            frame = int(obj["frame"])
+            arduino_time_ms = int(obj["arduino_time_ms"])
+        except (KeyError, TypeError, ValueError):
+            return None
+
+        if self._state is None or self._frame is None or frame != ((self._frame + 1) & 0xFFFFFFFF):
+            if not self.need_keyframe:
+                self.gaps += 1
+            self.need_keyframe = True
+            self._frame = frame
+            return None
+
+        self._frame = frame
+        tel = copy.deepcopy(self._state)
+        tel.frame = frame
+        tel.arduino_time_ms = arduino_time_ms
+        tel.host_time_us = _opt_int(obj.get("host_time_us"))   # every delta, once synced
+        tel.tel_seq = _opt_int(obj.get("tel_seq")) or 0        # every delta
+
+        if "ack_seq" in obj:
+            try:
+                tel.ack_seq = int(obj["ack_seq"])
+            except (TypeError, ValueError):
+                pass
+
+        # Sent together whenever either changes
+        if "queue_depth" in obj:
+            tel.queue_depth = _opt_int(obj.get("queue_depth")) or 0
+            tel.queue_free = _opt_int(obj.get("queue_free")) or 0
+
+        if isinstance(obj.get("wheel"), dict):
+            if tel.wheel is None:
+                tel.wheel = WheelState()
+            _apply_fields(obj["wheel"], tel.wheel, schema.WHEEL_KEYS)
+
+        pose_keys = ("x_ft", "y_ft", "heading_deg", "sigma_xy_ft", "sigma_heading_deg")
+        if isinstance(obj.get("pose"), dict):
+            if tel.pose is None:
+                tel.pose = PoseState()
+            _apply_fields(obj["pose"], tel.pose, pose_keys)
+
+        if isinstance(obj.get("mech"), dict):
+            if tel.mech is None:
+                tel.mech = MechanismState()
+            _apply_fields(obj["mech"], tel.mech, schema.MECH_KEYS)
+
+        u = obj.get("ultrasonic")
+        if isinstance(u, dict):
+            if tel.ultrasonic is None:
+                tel.ultrasonic = UltrasonicState()
+            if "valid" in u:
+                tel.ultrasonic.valid = isinstance(u["valid"], bool) and u["valid"]
+            _apply_fields(u, tel.ultrasonic, ("distance_in", "confidence"))
+            if "stop" in u:
+                tel.ultrasonic.obstacle_stop = u["stop"] is True
+            if "closing_inps" in u:
+                c = u["closing_inps"]
+                tel.ultrasonic.closing_in_s = float(c) if isinstance(c, (int, float)) else None
+            if not tel.ultrasonic.valid:
+                tel.ultrasonic.distance_in = None
+                tel.ultrasonic.closing_in_s = None
+
+        if "note" in obj:
+            note_val = obj["note"]
+            tel.note = str(note_val) if note_val is not None else None
+
+        if "sonar" in obj:
+            tel.sonar = _decode_sonar(obj["sonar"])   # always sent whole
+
+        self._state = tel
+        return tel
+
+
+def decode_group_line(line: str) -> Optional[Telemetry]:
+    """
+    Decode one per-group frame ("wheel", "ultrasonic", "mech", "note").
+
+    Schema (group fields sit at the top level):
+      {"type": "wheel", "arduino_time_ms": <int>, "tel_seq": <int>, "ack_seq": <int>,
+       "left_rpm": <float>|null, "right_rpm": <float>|null,
+       "pose": {...}}   (pose as in the full telemetry frame)
+
+    Returns a Telemetry with only that group set and .group naming it.
+    """
+    obj = _load_object(line)
+    if obj is None or obj.get("type") not in GROUP_TYPES:
+        return None
+
+    try:
+        arduino_time_ms = int(obj["arduino_time_ms"])
+        ack_seq = int(obj["ack_seq"])
+    except (KeyError, TypeError, ValueError):
+        return None
+
+    group = obj["type"]
+    tel = Telemetry(arduino_time_ms=arduino_time_ms, ack_seq=ack_seq, group=group,
+                    tel_seq=_opt_int(obj.get("tel_seq")) or 0,
+                    queue_depth=_opt_int(obj.get("queue_depth")) or 0,
+                    queue_free=_opt_int(obj.get("queue_free")) or 0,
+                    host_time_us=_opt_int(obj.get("host_time_us")))
+
+    if group == "wheel":
+        tel.wheel = _decode_wheel(obj)
+        tel.pose = _decode_pose(obj.get("pose"))
+    elif group == "ultrasonic":
+        tel.ultrasonic = _decode_ultrasonic(obj)
+        tel.sonar = _decode_sonar(obj.get("sonar"))
+    elif group == "mech":
+        tel.mech = _decode_mech(obj)
+    else:
+        note_val = obj.get("note")
+        tel.note = str(note_val) if note_val is not None else None
+
+    return tel
+
+
+def merge_telemetry_group(prev: Optional[Telemetry], part: Telemetry) -> Telemetry:
+    """
+    Fold one per-group frame into the latest full view.
+
+    Time and ack come from the newest frame; every other group keeps its
+    last received value. Full frames (group None) replace the view.
+    """
+    if part.group is None:
+        return part
+
+    tel = copy.copy(prev) if prev is not None else Telemetry(
+        arduino_time_ms=part.arduino_time_ms, ack_seq=part.ack_seq)
+    tel.arduino_time_ms = part.arduino_time_ms
+    tel.ack_seq = part.ack_seq
+    tel.tel_seq = part.tel_seq
+    tel.queue_depth = part.queue_depth
+    tel.queue_free = part.queue_free
+    tel.host_time_us = part.host_time_us
+    tel.group = None
+    tel.encoders = part.encoders   # batches are per frame, never carried over
+
+    if part.group == "wheel":
+        tel.wheel = part.wheel
+        tel.pose = part.pose
+    elif part.group == "ultrasonic":
+        tel.ultrasonic = part.ultrasonic
+        tel.sonar = part.sonar
+    elif part.group == "mech":
+        tel.mech = part.mech
+    elif part.group == "note":
+        tel.note = part.note
+
+    return tel
+
+
+def _load_object(line: str) -> Optional[Dict[str, Any]]:
+    line = line.strip()
+    i = line.find("{")
+    if i < 0:
+        return None
+    try:
+        obj = json.loads(line[i:])
+    except json.JSONDecodeError:
+        return None
+    return obj if isinstance(obj, dict) else None
+
+
+def _apply_fields(src: Any, dst: Any, keys) -> None:
+    """Copy the keys present in src onto dst (null -> None)."""
+    if not isinstance(src, dict):
+        return
+    for key in keys:
+        if key not in src:
+            continue
+        val = src[key]
+        try:
+            setattr(dst, key, float(val) if val is not None else None)
+        except (TypeError, ValueError):
+            setattr(dst, key, None)
+
+
 def _decode_wheel(w: Any) -> Optional[WheelState]:
     if w is None:
         return None
@@ -177,10 +756,26 @@ def _decode_wheel(w: Any) -> Optional[WheelState]:
         except (TypeError, ValueError):
             return None
 
-    return WheelState(
-        left_rpm=f("left_rpm"),
-        right_rpm=f("right_rpm"),
-    )
+    return WheelState(**{key: f(key) for key in schema.WHEEL_KEYS})
+
+
+def _decode_pose(p: Any) -> Optional[PoseState]:
+    if not isinstance(p, dict):
+        return None
+    try:
+        x, y, h = float(p["x_ft"]), float(p["y_ft"]), float(p["heading_deg"])
+    except (KeyError, TypeError, ValueError):
+        return None
+
+    def f(key: str) -> Optional[float]:
+        val = p.get(key)
+        try:
+            return float(val) if val is not None else None
+        except (TypeError, ValueError):
+            return None
+
+    return PoseState(x_ft=x, y_ft=y, heading_deg=h,
+                     sigma_xy_ft=f("sigma_xy_ft"), sigma_heading_deg=f("sigma_heading_deg"))
 
 
 def _decode_mech(m: Any) -> Optional[MechanismState]:
@@ -198,12 +793,29 @@ def _decode_mech(m: Any) -> Optional[MechanismState]:
         except (TypeError, ValueError):
             return None
 
-    return MechanismState(
-        servo_LID_deg=f("servo_LID_deg"),
-        servo_SWEEP_deg=f("servo_SWEEP_deg"),
-        motor_RHS_deg=f("motor_RHS_deg"),
-        motor_LHS_deg=f("motor_LHS_deg"),
-    )
+    return MechanismState(**{key: f(key) for key in schema.MECH_KEYS})
+
+
+def _decode_sonar(s: Any) -> Optional[SonarArray]:
+    if not isinstance(s, dict):
+        return None
+
+    def col(key: str) -> list:
+        v = s.get(key)
+        return v if isinstance(v, list) else []
+
+    def num(v: Any) -> Optional[float]:
+        return float(v) if isinstance(v, (int, float)) and not isinstance(v, bool) else None
+
+    d = [num(v) for v in col("d")]
+    c = [num(v) for v in col("c")]
+    q = [num(v) or 0.0 for v in col("q")]
+    n = len(d)
+    c = (c + [None] * n)[:n]
+    q = (q + [0.0] * n)[:n]
+    return SonarArray(distance_in=d,
+                      closing_in_s=[c[i] if d[i] is not None else None for i in range(n)],
+                      confidence=q)
 
 
 def _decode_ultrasonic(u: Any) -> Optional[UltrasonicState]:
@@ -227,8 +839,293 @@ def _decode_ultrasonic(u: Any) -> Optional[UltrasonicState]:
     if not valid:
         distance_in = None
 
-    return UltrasonicState(distance_in=distance_in, valid=valid)
+    closing = u.get("closing_inps")
+    conf = u.get("confidence")
+    return UltrasonicState(
+        distance_in=distance_in,
+        valid=valid,
+        closing_in_s=float(closing) if valid and isinstance(closing, (int, float)) else None,
+        confidence=float(conf) if isinstance(conf, (int, float)) else 0.0,
+        obstacle_stop=u.get("stop") is True,
+    )
+
+
+
+def decode_perf_line(line: str) -> Optional[PerfReport]:
+    """
+    Decode one perf diagnostics JSON line from Arduino.
+
+    Schema:
+      {
+        "type": "perf",
+        "arduino_time_ms": <int>,
+        "window_ms": <int>,
+        "loop": {"n": <int>, "min_us": <int>, "max_us": <int>, "mean_us": <int>, "jitter_us": <int>,
+                 "idle_permille": <int>},
+        "mem": {"static": <int>, "stack_peak": <int>, "free_min": <int>, "free_now": <int>},
+        "servo": {"attached": <int>, "active_permille": <int>, "isr_ppm": <int>, "detaches": <int>},
+        "tasks": [
+          {"name": <str>, "runs": <int>, "overruns": <int>,
+           "min_us": <int>, "max_us": <int>, "mean_us": <int>, "p99_us": <int>},
+          ...
+        ]
+      }
+    """
+    line = line.strip()
+    i = line.find("{")
+    if i < 0:
+        return None
+
+    try:
+        obj = json.loads(line[i:])
+    except json.JSONDecodeError:
+        return None
+
+    if not isinstance(obj, dict) or obj.get("type") != PERF_TYPE:
+        return None
+
+    def n(d: Any, key: str) -> int:
+        try:
+            return int(d.get(key, 0))
+        except (AttributeError, TypeError, ValueError):
+            return 0
+
+    try:
+        arduino_time_ms = int(obj["arduino_time_ms"])
+        window_ms = int(obj["window_ms"])
+    except (KeyError, TypeError, ValueError):
+        return None
+
+    lp = obj.get("loop")
+    loop = LoopPerf()
+    if isinstance(lp, dict):
+        loop = LoopPerf(
+            count=n(lp, "n"),
+            min_us=n(lp, "min_us"),
+            max_us=n(lp, "max_us"),
+            mean_us=n(lp, "mean_us"),
+            jitter_us=n(lp, "jitter_us"),
+            idle_permille=n(lp, "idle_permille"),
+        )
+
+    mp = obj.get("mem")
+    mem = MemPerf()
+    if isinstance(mp, dict):
+        mem = MemPerf(
+            static_bytes=n(mp, "static"),
+            stack_peak=n(mp, "stack_peak"),
+            free_min=n(mp, "free_min"),
+            free_now=n(mp, "free_now"),
+        )
+
+    sp = obj.get("servo")
+    servo = ServoPerf()
+    if isinstance(sp, dict):
+        servo = ServoPerf(
+            attached=n(sp, "attached"),
+            active_permille=n(sp, "active_permille"),
+            isr_ppm=n(sp, "isr_ppm"),
+            detaches=n(sp, "detaches"),
+        )
+
+    tasks = []
+    raw_tasks = obj.get("tasks")
+    if isinstance(raw_tasks, list):
+        for t in raw_tasks:
+            if not isinstance(t, dict):
+                continue
+            tasks.append(TaskPerf(
+                name=str(t.get("name") or ""),
+                runs=n(t, "runs"),
+                overruns=n(t, "overruns"),
+                min_us=n(t, "min_us"),
+                max_us=n(t, "max_us"),
+                mean_us=n(t, "mean_us"),
+                p99_us=n(t, "p99_us"),
+            ))
+
+    return PerfReport(
+        arduino_time_ms=arduino_time_ms,
+        window_ms=window_ms,
+        loop=loop,
+        tasks=tasks,
+        mem=mem,
+        servo=servo,
+    )
+
+
+def decode_sequence_line(line: str) -> Optional[SequenceStatus]:
+    """
+    Decode one sequencer status JSON line from Arduino.
+
+    Schema:
+      {"type": "seq", "arduino_time_ms": <int>, "name": <str>,
+       "state": "idle" | "running" | "done" | "aborted",
+       "step": <int>, "steps": <int>, "timeouts": <int>}
+    """
+    obj = _load_object(line)
+    if obj is None or obj.get("type") != SEQ_TYPE:
+        return None
+
+    try:
+        return SequenceStatus(
+            arduino_time_ms=int(obj["arduino_time_ms"]),
+            name=str(obj.get("name") or "upload"),
+            state=str(obj.get("state") or "idle"),
+            step=int(obj.get("step", 0)),
+            steps=int(obj.get("steps", 0)),
+            timeouts=int(obj.get("timeouts", 0)),
+        )
+    except (KeyError, TypeError, ValueError):
+        return None
+
+
+def decode_link_stats_line(line: str) -> Optional[LinkQuality]:
+    """
+    Decode one link quality JSON line from Arduino.
+
+    Schema:
+      {"type": "linkstats", "arduino_time_ms": <int>, "window_ms": <int>,
+       "frames": <int>, "ok": <int>, "fail": <int>, "ovf": <int>,
+       "max_frame": <int>, "seq_gaps": <int>, "seq_stale": <int>, "rx_hwm": <int>,
+       "tel": {"held": <int>, "unread_max": <int>},
+       "parse": {"n", "min_us", "max_us", "mean_us"},
+       "cmd": {"n", "min_us", "max_us", "mean_us", "jitter_hist": [<int>, ...]}}
+    """
+    obj = _load_object(line)
+    if obj is None or obj.get("type") != LINKSTATS_TYPE:
+        return None
+
+    parse = obj.get("parse") if isinstance(obj.get("parse"), dict) else {}
+    cmd = obj.get("cmd") if isinstance(obj.get("cmd"), dict) else {}
+    tel = obj.get("tel") if isinstance(obj.get("tel"), dict) else {}
+
+    try:
+        return LinkQuality(
+            arduino_time_ms=int(obj["arduino_time_ms"]),
+            window_ms=int(obj.get("window_ms", 0)),
+            frames=int(obj.get("frames", 0)),
+            ok=int(obj.get("ok", 0)),
+            fail=int(obj.get("fail", 0)),
+            ovf=int(obj.get("ovf", 0)),
+            max_frame=int(obj.get("max_frame", 0)),
+            seq_gaps=int(obj.get("seq_gaps", 0)),
+            seq_stale=int(obj.get("seq_stale", 0)),
+            rx_hwm=int(obj.get("rx_hwm", 0)),
+            tel_held=int(tel.get("held", 0)),
+            tel_unread_max=int(tel.get("unread_max", 0)),
+            parse_n=int(parse.get("n", 0)),
+            parse_min_us=int(parse.get("min_us", 0)),
+            parse_max_us=int(parse.get("max_us", 0)),
+            parse_mean_us=int(parse.get("mean_us", 0)),
+            cmd_n=int(cmd.get("n", 0)),
+            cmd_gap_min_us=int(cmd.get("min_us", 0)),
+            cmd_gap_max_us=int(cmd.get("max_us", 0)),
+            cmd_gap_mean_us=int(cmd.get("mean_us", 0)),
+            jitter_hist=[int(v) for v in cmd.get("jitter_hist", [])],
+        )
+    except (KeyError, TypeError, ValueError):
+        return None
+
+
+def decode_pong_line(line: str) -> Optional[Pong]:
+    """
+    Decode one clock sync reply JSON line from Arduino.
+
+    Schema:
+      {"type": "pong", "id": n, "t1_us": ..., "t2_us": ..., "t3_us": ...,
+       "synced": <bool>, "offset_us": ..., "drift_ppm": <float>,
+       "delay_us": ..., "cmd_latency_us": <int> | null}
+    """
+    obj = _load_object(line)
+    if obj is None or obj.get("type") != PONG_TYPE:
+        return None
+
+    try:
+        return Pong(
+            id=int(obj["id"]),
+            t1_us=int(obj["t1_us"]),
+            t2_us=int(obj["t2_us"]),
+            t3_us=int(obj["t3_us"]),
+            synced=bool(obj.get("synced", False)),
+            offset_us=int(obj.get("offset_us", 0)),
+            drift_ppm=float(obj.get("drift_ppm", 0.0)),
+            delay_us=int(obj.get("delay_us", 0)),
+            cmd_latency_us=_opt_int(obj.get("cmd_latency_us")),
+        )
+    except (KeyError, TypeError, ValueError):
+        return None
+
+
+def decode_param_line(line: str) -> Optional[ParamReply]:
+    """
+    Decode one tuning parameter reply JSON line from Arduino.
+
+    Schema:
+      {"type": "param", "op": <str>, "status": <str>, "count": <int>,
+       "index": <int>, "name": <str>, "value": <float>, "min": <float>, "max": <float>}
+
+    index .. max are present only when the reply describes one parameter.
+    """
+    obj = _load_object(line)
+    if obj is None or obj.get("type") != PARAM_TYPE:
+        return None
+
+    try:
+        reply = ParamReply(
+            op=str(obj["op"]),
+            status=str(obj["status"]),
+            count=int(obj.get("count", 0)),
+        )
+        if "index" in obj:
+            reply.index = int(obj["index"])
+            reply.name = str(obj.get("name") or "")
+            reply.value = float(obj["value"])
+            reply.min = float(obj["min"])
+            reply.max = float(obj["max"])
+        return reply
+    except (KeyError, TypeError, ValueError):
+        return None
+
+
+def decode_hello_line(line: str) -> Optional[Hello]:
+    """
+    Decode one boot hello JSON line from Arduino.
+
+    Schema:
+      {"type": "hello", "arduino_time_ms": <int>, "stage": "link" | "ready",
+       "fw": <int>, "build": <str>, "proto": <int>, "features": <int>,
+       "reset_flags": <int>, "link_us": <int>, "setup_us": <int>,
+       "first_tel_us": <int>}
+    """
+    obj = _load_object(line)
+    if obj is None or obj.get("type") != HELLO_TYPE:
+        return None
+
+    try:
+        return Hello(
+            arduino_time_ms=int(obj["arduino_time_ms"]),
+            stage=str(obj.get("stage") or "link"),
+            fw=int(obj.get("fw", 0)),
+            build=str(obj.get("build") or ""),
+            proto=int(obj.get("proto", 0)),
+            features=int(obj.get("features", 0)),
+            reset_flags=int(obj.get("reset_flags", 0)),
+            link_us=int(obj.get("link_us", 0)),
+            setup_us=int(obj.get("setup_us", 0)),
+            first_tel_us=int(obj.get("first_tel_us", 0)),
+        )
+    except (KeyError, TypeError, ValueError):
+        return None
+
+
+def feature_names(features: int) -> list:
+    """Names of the set FEATURE_* bits in a hello's features."""
+    return [name for bit, name in enumerate(FEATURE_NAMES) if features & (1 << bit)]
+
 
+def _opt_int(v: Any) -> Optional[int]:
+    return int(v) if isinstance(v, int) and not isinstance(v, bool) else None
 
 
 # -----------------------------
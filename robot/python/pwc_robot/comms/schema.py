@@ -0,0 +1,470 @@
+"""
+Binary wire layouts, generated from the firmware's src/comms/Schema.h by
+apwcr_firmware/scripts/gen_schema.py (runs before every firmware build).
+Do not edit: change Schema.h and regenerate.
+
+Layout.fmt is a struct format for the whole payload (arrays unpack as
+one value per element, char arrays as bytes); fields are flattened,
+nested layouts as dotted names ("pose.x_ft").
+"""
+
+from typing import NamedTuple, Tuple
+
+
+class Field(NamedTuple):
+    name: str
+    offset: int
+    fmt: str
+
+
+class Layout(NamedTuple):
+    name: str
+    fmt: str
+    size: int
+    fields: Tuple[Field, ...]
+
+
+# Schema.h PROTOCOL_VERSION: the firmware sends its own in the hello
+PROTOCOL_VERSION = 3
+
+# Group value names, in wire order (also their JSON keys)
+WHEEL_KEYS = ("left_rpm", "right_rpm")
+MECH_KEYS = ("servo_LID_deg", "servo_SWEEP_deg", "motor_RHS_deg", "motor_LHS_deg")
+RANGE_KEYS = ("distance_in", "closing_inps")
+
+
+WHEEL_VALUES = Layout(
+    "WheelValues", "<ff", 8, (
+        Field("left_rpm", 0, "f"),
+        Field("right_rpm", 4, "f"),
+    ),
+)
+
+MECH_VALUES = Layout(
+    "MechValues", "<ffff", 16, (
+        Field("servo_LID_deg", 0, "f"),
+        Field("servo_SWEEP_deg", 4, "f"),
+        Field("motor_RHS_deg", 8, "f"),
+        Field("motor_LHS_deg", 12, "f"),
+    ),
+)
+
+RANGE_VALUES = Layout(
+    "RangeValues", "<ff", 8, (
+        Field("distance_in", 0, "f"),
+        Field("closing_inps", 4, "f"),
+    ),
+)
+
+COMMAND_PACKET = Layout(
+    "CommandPacket", "<IIIffBfBfff", 38, (
+        Field("seq", 0, "I"),
+        Field("host_time_ms", 4, "I"),
+        Field("at_ms", 8, "I"),
+        Field("drive_linear_ftps", 12, "f"),
+        Field("drive_angular_dps", 16, "f"),
+        Field("motor_RHS_mode", 20, "B"),
+        Field("motor_RHS_value", 21, "f"),
+        Field("motor_LHS_mode", 25, "B"),
+        Field("motor_LHS_value", 26, "f"),
+        Field("servo_LID_deg", 30, "f"),
+        Field("servo_SWEEP_deg", 34, "f"),
+    ),
+)
+
+COMMAND_CREDIT_PACKET = Layout(
+    "CommandCreditPacket", "<H", 2, (
+        Field("tel_ack", 0, "H"),
+    ),
+)
+
+WIRE_MODE_PACKET = Layout(
+    "WireModePacket", "<B", 1, (
+        Field("mode", 0, "B"),
+    ),
+)
+
+SUBSCRIBE_PACKET = Layout(
+    "SubscribePacket", "<HHHHB", 9, (
+        Field("telemetry_hz", 0, "H"),
+        Field("wheel_hz", 2, "H"),
+        Field("ultrasonic_hz", 4, "H"),
+        Field("mech_hz", 6, "H"),
+        Field("note", 8, "B"),
+    ),
+)
+
+SEQUENCE_PACKET = Layout(
+    "SequencePacket", "<BBB", 3, (
+        Field("action", 0, "B"),
+        Field("id", 1, "B"),
+        Field("step_count", 2, "B"),
+    ),
+)
+
+SEQ_STEP_PACKET = Layout(
+    "SeqStepPacket", "<BhH", 5, (
+        Field("op", 0, "B"),
+        Field("arg", 1, "h"),
+        Field("timeout_ms", 3, "H"),
+    ),
+)
+
+POSE_RESET_PACKET = Layout(
+    "PoseResetPacket", "<fff", 12, (
+        Field("x_ft", 0, "f"),
+        Field("y_ft", 4, "f"),
+        Field("heading_deg", 8, "f"),
+    ),
+)
+
+PARAM_PACKET = Layout(
+    "ParamPacket", "<BBf24s", 30, (
+        Field("op", 0, "B"),
+        Field("index", 1, "B"),
+        Field("value", 2, "f"),
+        Field("name", 6, "24s"),
+    ),
+)
+
+TEST_PACKET = Layout(
+    "TestPacket", "<Bf", 5, (
+        Field("op", 0, "B"),
+        Field("value", 1, "f"),
+    ),
+)
+
+LOG_PACKET = Layout(
+    "LogPacket", "<B", 1, (
+        Field("op", 0, "B"),
+    ),
+)
+
+PATH_PACKET = Layout(
+    "PathPacket", "<BBff", 10, (
+        Field("action", 0, "B"),
+        Field("count", 1, "B"),
+        Field("speed_ftps", 2, "f"),
+        Field("lookahead_ft", 6, "f"),
+    ),
+)
+
+PATH_POINT_PACKET = Layout(
+    "PathPointPacket", "<ff", 8, (
+        Field("x_ft", 0, "f"),
+        Field("y_ft", 4, "f"),
+    ),
+)
+
+PING_PACKET = Layout(
+    "PingPacket", "<HIHI", 12, (
+        Field("id", 0, "H"),
+        Field("t1_us", 2, "I"),
+        Field("prev_id", 6, "H"),
+        Field("prev_t4_us", 8, "I"),
+    ),
+)
+
+POSE_PACKET = Layout(
+    "PosePacket", "<fffHH", 16, (
+        Field("x_ft", 0, "f"),
+        Field("y_ft", 4, "f"),
+        Field("heading_deg", 8, "f"),
+        Field("sigma_xy_mft", 12, "H"),
+        Field("sigma_heading_cdeg", 14, "H"),
+    ),
+)
+
+TELEMETRY_PACKET = Layout(
+    "TelemetryPacket", "<IHIBBIfffffHHffffffBB", 66, (
+        Field("arduino_time_ms", 0, "I"),
+        Field("tel_seq", 4, "H"),
+        Field("ack_seq", 6, "I"),
+        Field("queue_depth", 10, "B"),
+        Field("queue_free", 11, "B"),
+        Field("host_time_us", 12, "I"),
+        Field("wheel.left_rpm", 16, "f"),
+        Field("wheel.right_rpm", 20, "f"),
+        Field("pose.x_ft", 24, "f"),
+        Field("pose.y_ft", 28, "f"),
+        Field("pose.heading_deg", 32, "f"),
+        Field("pose.sigma_xy_mft", 36, "H"),
+        Field("pose.sigma_heading_cdeg", 38, "H"),
+        Field("mech.servo_LID_deg", 40, "f"),
+        Field("mech.servo_SWEEP_deg", 44, "f"),
+        Field("mech.motor_RHS_deg", 48, "f"),
+        Field("mech.motor_LHS_deg", 52, "f"),
+        Field("ultrasonic.distance_in", 56, "f"),
+        Field("ultrasonic.closing_inps", 60, "f"),
+        Field("ultrasonic_confidence", 64, "B"),
+        Field("flags", 65, "B"),
+    ),
+)
+
+GROUP_HEADER_PACKET = Layout(
+    "GroupHeaderPacket", "<IHIBBI", 16, (
+        Field("arduino_time_ms", 0, "I"),
+        Field("tel_seq", 4, "H"),
+        Field("ack_seq", 6, "I"),
+        Field("queue_depth", 10, "B"),
+        Field("queue_free", 11, "B"),
+        Field("host_time_us", 12, "I"),
+    ),
+)
+
+WHEEL_PACKET = Layout(
+    "WheelPacket", "<IHIBBIfffffHH", 40, (
+        Field("h.arduino_time_ms", 0, "I"),
+        Field("h.tel_seq", 4, "H"),
+        Field("h.ack_seq", 6, "I"),
+        Field("h.queue_depth", 10, "B"),
+        Field("h.queue_free", 11, "B"),
+        Field("h.host_time_us", 12, "I"),
+        Field("wheel.left_rpm", 16, "f"),
+        Field("wheel.right_rpm", 20, "f"),
+        Field("pose.x_ft", 24, "f"),
+        Field("pose.y_ft", 28, "f"),
+        Field("pose.heading_deg", 32, "f"),
+        Field("pose.sigma_xy_mft", 36, "H"),
+        Field("pose.sigma_heading_cdeg", 38, "H"),
+    ),
+)
+
+ENCODER_BATCH_HEADER_PACKET = Layout(
+    "EncoderBatchHeaderPacket", "<BHI2i", 15, (
+        Field("count", 0, "B"),
+        Field("overflows", 1, "H"),
+        Field("t0_us", 3, "I"),
+        Field("count0", 7, "2i"),
+    ),
+)
+
+ENCODER_STEP_PACKET = Layout(
+    "EncoderStepPacket", "<H2h", 6, (
+        Field("dt_us", 0, "H"),
+        Field("dcount", 2, "2h"),
+    ),
+)
+
+SONAR_HEADER_PACKET = Layout(
+    "SonarHeaderPacket", "<BB", 2, (
+        Field("count", 0, "B"),
+        Field("valid_mask", 1, "B"),
+    ),
+)
+
+ULTRASONIC_PACKET = Layout(
+    "UltrasonicPacket", "<IHIBBIffBB", 26, (
+        Field("h.arduino_time_ms", 0, "I"),
+        Field("h.tel_seq", 4, "H"),
+        Field("h.ack_seq", 6, "I"),
+        Field("h.queue_depth", 10, "B"),
+        Field("h.queue_free", 11, "B"),
+        Field("h.host_time_us", 12, "I"),
+        Field("range.distance_in", 16, "f"),
+        Field("range.closing_inps", 20, "f"),
+        Field("confidence", 24, "B"),
+        Field("flags", 25, "B"),
+    ),
+)
+
+MECH_PACKET = Layout(
+    "MechPacket", "<IHIBBIffff", 32, (
+        Field("h.arduino_time_ms", 0, "I"),
+        Field("h.tel_seq", 4, "H"),
+        Field("h.ack_seq", 6, "I"),
+        Field("h.queue_depth", 10, "B"),
+        Field("h.queue_free", 11, "B"),
+        Field("h.host_time_us", 12, "I"),
+        Field("mech.servo_LID_deg", 16, "f"),
+        Field("mech.servo_SWEEP_deg", 20, "f"),
+        Field("mech.motor_RHS_deg", 24, "f"),
+        Field("mech.motor_LHS_deg", 28, "f"),
+    ),
+)
+
+PERF_HEADER_PACKET = Layout(
+    "PerfHeaderPacket", "<IHHHHHHHHHHBHHHB", 32, (
+        Field("arduino_time_ms", 0, "I"),
+        Field("window_ms", 4, "H"),
+        Field("loop_count", 6, "H"),
+        Field("loop_min_us", 8, "H"),
+        Field("loop_max_us", 10, "H"),
+        Field("loop_mean_us", 12, "H"),
+        Field("loop_idle_permille", 14, "H"),
+        Field("mem_static", 16, "H"),
+        Field("mem_stack_peak", 18, "H"),
+        Field("mem_free_min", 20, "H"),
+        Field("mem_free_now", 22, "H"),
+        Field("servo_attached", 24, "B"),
+        Field("servo_active_permille", 25, "H"),
+        Field("servo_isr_ppm", 27, "H"),
+        Field("servo_detaches", 29, "H"),
+        Field("task_count", 31, "B"),
+    ),
+)
+
+TASK_PERF_PACKET = Layout(
+    "TaskPerfPacket", "<6sHHHHHH", 18, (
+        Field("name", 0, "6s"),
+        Field("runs", 6, "H"),
+        Field("overruns", 8, "H"),
+        Field("min_us", 10, "H"),
+        Field("max_us", 12, "H"),
+        Field("mean_us", 14, "H"),
+        Field("p99_us", 16, "H"),
+    ),
+)
+
+LINK_STATS_PACKET = Layout(
+    "LinkStatsPacket", "<IHIIIIHIIHIHHHHHHHHH8H", 72, (
+        Field("arduino_time_ms", 0, "I"),
+        Field("window_ms", 4, "H"),
+        Field("frames", 6, "I"),
+        Field("ok", 10, "I"),
+        Field("fail", 14, "I"),
+        Field("overflow", 18, "I"),
+        Field("max_frame_bytes", 22, "H"),
+        Field("seq_gaps", 24, "I"),
+        Field("seq_stale", 28, "I"),
+        Field("rx_high_water", 32, "H"),
+        Field("tel_held", 34, "I"),
+        Field("tel_unread_max", 38, "H"),
+        Field("parse_count", 40, "H"),
+        Field("parse_min_us", 42, "H"),
+        Field("parse_max_us", 44, "H"),
+        Field("parse_mean_us", 46, "H"),
+        Field("cmd_count", 48, "H"),
+        Field("gap_min_ms", 50, "H"),
+        Field("gap_max_ms", 52, "H"),
+        Field("gap_mean_ms", 54, "H"),
+        Field("jitter_hist", 56, "8H"),
+    ),
+)
+
+SEQ_STATUS_PACKET = Layout(
+    "SeqStatusPacket", "<IBBBBB", 9, (
+        Field("arduino_time_ms", 0, "I"),
+        Field("id", 4, "B"),
+        Field("state", 5, "B"),
+        Field("step", 6, "B"),
+        Field("steps", 7, "B"),
+        Field("timeouts", 8, "B"),
+    ),
+)
+
+PONG_PACKET = Layout(
+    "PongPacket", "<HIIIBIfIi", 31, (
+        Field("id", 0, "H"),
+        Field("t1_us", 2, "I"),
+        Field("t2_us", 6, "I"),
+        Field("t3_us", 10, "I"),
+        Field("flags", 14, "B"),
+        Field("offset_us", 15, "I"),
+        Field("drift_ppm", 19, "f"),
+        Field("delay_us", 23, "I"),
+        Field("cmd_latency_us", 27, "i"),
+    ),
+)
+
+PARAM_REPLY_PACKET = Layout(
+    "ParamReplyPacket", "<BBBBfff24s", 40, (
+        Field("op", 0, "B"),
+        Field("status", 1, "B"),
+        Field("index", 2, "B"),
+        Field("count", 3, "B"),
+        Field("value", 4, "f"),
+        Field("min", 8, "f"),
+        Field("max", 12, "f"),
+        Field("name", 16, "24s"),
+    ),
+)
+
+RX_CAPTURE_PACKET = Layout(
+    "RxCapturePacket", "<IB", 5, (
+        Field("t_us", 0, "I"),
+        Field("seq", 4, "B"),
+    ),
+)
+
+SYS_ID_HEADER_PACKET = Layout(
+    "SysIdHeaderPacket", "<BBBfHH", 11, (
+        Field("target", 0, "B"),
+        Field("gen", 1, "B"),
+        Field("period_ms", 2, "B"),
+        Field("units_per_count", 3, "f"),
+        Field("first", 7, "H"),
+        Field("total", 9, "H"),
+    ),
+)
+
+HELLO_PACKET = Layout(
+    "HelloPacket", "<IBHBHBIII20s", 43, (
+        Field("arduino_time_ms", 0, "I"),
+        Field("stage", 4, "B"),
+        Field("fw_version", 5, "H"),
+        Field("proto", 7, "B"),
+        Field("features", 8, "H"),
+        Field("reset_flags", 10, "B"),
+        Field("link_us", 11, "I"),
+        Field("setup_us", 15, "I"),
+        Field("first_tel_us", 19, "I"),
+        Field("build", 23, "20s"),
+    ),
+)
+
+EVENT_LOG_HEADER_PACKET = Layout(
+    "EventLogHeaderPacket", "<HH", 4, (
+        Field("first", 0, "H"),
+        Field("end", 2, "H"),
+    ),
+)
+
+EVENT_RECORD_PACKET = Layout(
+    "EventRecordPacket", "<IBBhh", 10, (
+        Field("t_ms", 0, "I"),
+        Field("id", 4, "B"),
+        Field("count", 5, "B"),
+        Field("a", 6, "h"),
+        Field("b", 8, "h"),
+    ),
+)
+
+LAYOUTS = {l.name: l for l in (
+    WHEEL_VALUES,
+    MECH_VALUES,
+    RANGE_VALUES,
+    COMMAND_PACKET,
+    COMMAND_CREDIT_PACKET,
+    WIRE_MODE_PACKET,
+    SUBSCRIBE_PACKET,
+    SEQUENCE_PACKET,
+    SEQ_STEP_PACKET,
+    POSE_RESET_PACKET,
+    PARAM_PACKET,
+    TEST_PACKET,
+    LOG_PACKET,
+    PATH_PACKET,
+    PATH_POINT_PACKET,
+    PING_PACKET,
+    POSE_PACKET,
+    TELEMETRY_PACKET,
+    GROUP_HEADER_PACKET,
+    WHEEL_PACKET,
+    ENCODER_BATCH_HEADER_PACKET,
+    ENCODER_STEP_PACKET,
+    SONAR_HEADER_PACKET,
+    ULTRASONIC_PACKET,
+    MECH_PACKET,
+    PERF_HEADER_PACKET,
+    TASK_PERF_PACKET,
+    LINK_STATS_PACKET,
+    SEQ_STATUS_PACKET,
+    PONG_PACKET,
+    PARAM_REPLY_PACKET,
+    RX_CAPTURE_PACKET,
+    SYS_ID_HEADER_PACKET,
+    HELLO_PACKET,
+    EVENT_LOG_HEADER_PACKET,
+    EVENT_RECORD_PACKET,
+)}
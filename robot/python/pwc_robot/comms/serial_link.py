@@ -7,6 +7,7 @@ Responsibilities:
 - Open/close/reconnect the serial port
 - Drain telemetry reads (Arduino -> Laptop)
 - Send command frames (Laptop -> Arduino)
+- Send clock sync pings (firmware estimates the host clock from them)
 - Maintain latest_telemetry and link_stats/state
 
 This module does NOT define the wire format. protocol.py does.
@@ -20,18 +21,52 @@ Recommended usage pattern in main:
 from __future__ import annotations
 
 import time
-from typing import Optional
+from collections import deque
+from typing import Deque, Iterable, List, Optional, Tuple
 
 import serial  # pyserial
 
 from pwc_robot.controller.commands import DriveCommand, MechanismCommand
 from pwc_robot.comms.ports import find_arduino_port
 from pwc_robot.comms.protocol import (
+    TelemetryDeltaDecoder,
     encode_command_frame,
-    decode_telemetry_line,
+    encode_tlm_control_line,
+    encode_subscribe_line,
+    decode_group_line,
+    decode_perf_line,
+    decode_sequence_line,
+    decode_pong_line,
+    decode_param_line,
+    decode_link_stats_line,
+    decode_hello_line,
+    encode_ping_line,
+    encode_pose_line,
+    encode_param_line,
+    encode_test_line,
+    encode_log_line,
+    encode_path_line,
+    encode_sequence_line,
+    merge_telemetry_group,
     safe_decode_line,
 )
-from pwc_robot.comms.types import LinkState, LinkStats, Telemetry
+from pwc_robot.comms import binary_protocol, schema
+from pwc_robot.comms.types import (
+    EncoderSample,
+    EventLogChunk,
+    EventRecord,
+    Hello,
+    LinkQuality,
+    LinkState,
+    LinkStats,
+    PerfReport,
+    ParamReply,
+    Pong,
+    RxCaptureRecord,
+    SequenceStatus,
+    SysIdChunk,
+    Telemetry,
+)
 
 
 class SerialLink:
@@ -43,12 +78,92 @@ class SerialLink:
         self.write_timeout_s: float = float(comms_cfg.get("write_timeout_s", 0.05))
         self.auto_detect: bool = bool(comms_cfg.get("auto_detect", True))
 
+        # "json" (debug-friendly) or "binary" (COBS + CRC16 framed structs)
+        self.wire_mode: str = str(comms_cfg.get("wire_mode", "json")).lower()
+        self._binary: bool = self.wire_mode == "binary"
+
+        # JSON mode only: firmware sends changed fields between keyframes
+        self.telemetry_delta: bool = bool(comms_cfg.get("telemetry_delta", False))
+        self._tlm_decoder = TelemetryDeltaDecoder()
+        self._keyframe_retry_s: float = 0.2
+        self._last_keyframe_req_s: float = 0.0
+
+        # Per-group telemetry rates (Hz), e.g. {"wheel": 100, "ultrasonic": 15,
+        # "mech": 5, "note": True}. Empty = firmware default full frames.
+        sub = comms_cfg.get("telemetry_subscribe") or {}
+        self.telemetry_subscribe: dict = {
+            "telemetry": int(sub.get("telemetry", 0)),
+            "wheel": int(sub.get("wheel", 0)),
+            "ultrasonic": int(sub.get("ultrasonic", 0)),
+            "mech": int(sub.get("mech", 0)),
+            "note": bool(sub.get("note", False)),
+        }
+        self._subscribe: bool = any(self.telemetry_subscribe.values())
+
+        # Second port on the firmware's aux link (Pi GPIO UART): telemetry
+        # only. The firmware refuses commands there; pings are the keepalive
+        # that moves encoder batches and perf frames onto it, so they go out
+        # from the start and never stop.
+        self.telemetry_only: bool = bool(comms_cfg.get("telemetry_only", False))
+
         self.rx_stale_s: float = float(comms_cfg.get("rx_stale_s", 0.5))
         self.reconnect_s: float = float(comms_cfg.get("reconnect_s", 1.0))
 
+        # Opening the port resets the board. Nothing is sent until the
+        # firmware's boot hello (its link is up, so the bootloader is done:
+        # bytes sent into the bootloader can hold the board there), or for
+        # boot_timeout_s on a board that didn't reset (or older firmware).
+        # Frames before the hello are read as usual; they may be from the
+        # session before the reset.
+        self.boot_timeout_s: float = float(comms_cfg.get("boot_timeout_s", 2.0))
+        self._configured: bool = False
+        self._opened_s: Optional[float] = None
+        self.latest_hello: Optional[Hello] = None
+        self.hello_wait_s: Optional[float] = None   # port open -> "link" hello
+        self.ready_wait_s: Optional[float] = None   # port open -> "ready" hello
+
+        # Full-rate drive encoder samples (binary telemetry only), oldest first
+        self._encoder_samples: Deque[EncoderSample] = deque(
+            maxlen=int(comms_cfg.get("encoder_sample_buffer", 2000)))
+        self.encoder_overflows: int = 0
+
+        # Clock sync pings (0 = off). Once the firmware has converged,
+        # telemetry carries host_time_us and pongs carry command latency.
+        self.ping_hz: float = float(comms_cfg.get("ping_hz", 2.0))
+        if self.telemetry_only:
+            self.ping_hz = max(self.ping_hz, 1.0)
+        self._ping_id: int = 0
+        self._last_ping_s: Optional[float] = None
+        self._prev_pong_id: int = 0
+        self._prev_pong_t4_us: int = 0
+
+        # Telemetry credit: every command echoes the newest tel_seq read, so
+        # the firmware holds telemetry while this host falls behind (see
+        # protocol.encode_command_frame tel_ack). None until the first frame.
+        self.telemetry_credit: bool = bool(comms_cfg.get("telemetry_credit", True))
+        self._tel_ack: Optional[int] = None
+
         self._ser: Optional[serial.Serial] = None
 
         self.latest_telemetry: Optional[Telemetry] = None
+        self.latest_perf: Optional[PerfReport] = None
+        self.latest_sequence: Optional[SequenceStatus] = None
+        self.latest_pong: Optional[Pong] = None
+        self.latest_param: Optional[ParamReply] = None
+        self.latest_link_quality: Optional[LinkQuality] = None
+        # Capture of the latest SysId run, samples in order as they stream in.
+        # Missed: samples overwritten on the robot before they were sent,
+        # held in the capture as (nan, 0, 0) so the index stays the time.
+        self.sysid_capture: List[Tuple[float, int, int]] = []
+        self.sysid_missed: int = 0
+        self.latest_sysid: Optional[SysIdChunk] = None
+        # Records of the latest event log dump (oldest first); done once
+        # the chunk reaching the dump's end has arrived. Missed: records
+        # skipped between chunks (overwritten on the robot mid-dump).
+        self.event_log: List[EventRecord] = []
+        self.event_log_done: bool = False
+        self.event_log_missed: int = 0
+        self._event_log_next: Optional[int] = None
         self.link_stats: LinkStats = LinkStats(
             state=LinkState.DISCONNECTED,
             port=self.port,
@@ -74,6 +189,12 @@ class SerialLink:
         self._last_reconnect_attempt_s: float = 0.0
         self._tx_seq: int = 0
 
+        # Timed setpoints queued on the firmware (send_trajectory): until the
+        # last one is due, tx_tick resends that frame's seq as the keepalive
+        # (an untimed command would drop the queue)
+        self._traj_last: Optional[dict] = None
+        self._traj_end_s: Optional[float] = None
+
     # -----------------------------
     # Public API
     # -----------------------------
@@ -85,6 +206,7 @@ class SerialLink:
             except Exception:
                 pass
         self._ser = None
+        self._configured = False
         self.link_stats.state = LinkState.DISCONNECTED
 
         # Reset measured rates so UI does not show stale values
@@ -122,6 +244,8 @@ class SerialLink:
             self._maybe_reconnect(now_s)
 
         self._drain_reads(now_s)
+        if self._ser is not None and not self._configured and now_s - self._opened_s >= self.boot_timeout_s:
+            self._configure_link(now_s)   # no hello: no reset, or firmware from before it
         self._update_link_state(now_s)
 
     def tx_tick(
@@ -135,7 +259,7 @@ class SerialLink:
 
         Behavior:
         - If connected enough to have received at least one telemetry frame,
-          send one command frame per call.
+          send one command frame per call (telemetry_only: pings only).
         - Update link state after write attempt.
         """
         now_s = time.perf_counter()
@@ -152,6 +276,12 @@ class SerialLink:
         if self._ser is None or not self._ser.is_open:
             self._maybe_reconnect(now_s)
 
+        # Telemetry-only port: pings (the keepalive), never commands
+        if self.telemetry_only:
+            self._maybe_ping(now_s)
+            self._update_link_state(now_s)
+            return
+
         # Gate TX until we know RX works at least once
         if self.link_stats.last_rx_time_s is None:
             self._update_link_state(now_s)
@@ -161,7 +291,13 @@ class SerialLink:
             self._update_link_state(now_s)
             return
 
-        self._write_command(now_s, drive_cmd, mech_cmd)
+        if self._traj_end_s is not None and now_s < self._traj_end_s and self._traj_last is not None:
+            self._write_command(now_s, **self._traj_last)
+        else:
+            self._traj_end_s = None
+            self._traj_last = None
+            self._write_command(now_s, drive_cmd, mech_cmd)
+        self._maybe_ping(now_s)
         self._update_link_state(now_s)
 
     def tick(
@@ -182,6 +318,166 @@ class SerialLink:
     def get_latest_telemetry(self) -> Optional[Telemetry]:
         return self.latest_telemetry
 
+    def drain_encoder_samples(self) -> List[EncoderSample]:
+        """
+        Every encoder sample received since the last call (oldest first).
+
+        Binary wire mode only: the firmware samples the drive encoders at
+        ENCODER_SAMPLE_HZ and batches them into telemetry frames. Samples
+        beyond encoder_sample_buffer are discarded oldest first.
+        """
+        out = list(self._encoder_samples)
+        self._encoder_samples.clear()
+        return out
+
+    def get_latest_perf(self) -> Optional[PerfReport]:
+        """Most recent firmware task/loop timing report (low rate), if any."""
+        return self.latest_perf
+
+    def run_sequence(self, name: str) -> None:
+        """
+        Start a built-in firmware sequence ("pickup", "stow"). Progress comes
+        back as SequenceStatus frames (get_latest_sequence()). While it runs
+        the firmware ignores drive/servo targets in command frames, but keep
+        sending them: the command timeout still aborts the sequence.
+        """
+        self._send_sequence(run=name)
+
+    def upload_sequence(self, steps: Iterable[Tuple[str, float, int]]) -> None:
+        """Run a custom step list: (op, arg, timeout_ms) tuples, see protocol.SEQ_OPS."""
+        self._send_sequence(steps=list(steps))
+
+    def abort_sequence(self) -> None:
+        self._send_sequence(abort=True)
+
+    def follow_path(
+        self,
+        points: Iterable[Tuple[float, float]],
+        speed_ftps: Optional[float] = None,
+        lookahead_ft: Optional[float] = None,
+    ) -> None:
+        """
+        Drive through (x_ft, y_ft) waypoints in the odometry frame
+        (Telemetry.pose), starting from where the robot is; the firmware
+        tracks them every drive tick and posts a "PATH done" note at the
+        end. Sample curves into points first (protocol.PATH_MAX_POINTS at
+        most). As with sequences, command frames keep the watchdog fed but
+        don't steer while it runs.
+        """
+        encode = binary_protocol.encode_path_frame if self._binary else encode_path_line
+        self._send_raw(encode(points=list(points), speed_ftps=speed_ftps, lookahead_ft=lookahead_ft))
+
+    def abort_path(self) -> None:
+        encode = binary_protocol.encode_path_frame if self._binary else encode_path_line
+        self._send_raw(encode(abort=True))
+
+    def reset_pose(self, x_ft: float = 0.0, y_ft: float = 0.0, heading_deg: float = 0.0) -> None:
+        """Re-origin the firmware's odometry (Telemetry.pose); the sigmas restart at 0."""
+        encode = binary_protocol.encode_pose_frame if self._binary else encode_pose_line
+        self._send_raw(encode(x_ft=x_ft, y_ft=y_ft, heading_deg=heading_deg))
+
+    def get_param(self, name: Optional[str] = None, index: Optional[int] = None) -> None:
+        """Ask for one tuning parameter (by Params.h name or index); see get_latest_param."""
+        self._send_param(op="get", name=name, index=index)
+
+    def set_param(self, name: str, value: float) -> None:
+        """Stage a parameter; it goes live on the next drive tick (not saved)."""
+        self._send_param(op="set", name=name, value=value)
+
+    def save_params(self) -> None:
+        """Write the staged parameters to EEPROM (background, a note reports completion)."""
+        self._send_param(op="save")
+
+    def load_params(self) -> None:
+        """Revert the staged parameters to the EEPROM image."""
+        self._send_param(op="load")
+
+    def default_params(self) -> None:
+        """Revert the staged parameters to the Params.h defaults (EEPROM untouched)."""
+        self._send_param(op="defaults")
+
+    def run_test(self, op: str, value: Optional[float] = None) -> None:
+        """Start a firmware test (protocol.TEST_OPS: step test, SysId run) or abort one."""
+        encode = binary_protocol.encode_test_frame if self._binary else encode_test_line
+        self._send_raw(encode(op=op, value=value))
+
+    def dump_log(self) -> None:
+        """
+        Read the firmware event log (binary mode only): the records arrive
+        in event_log, event_log_done once the whole ring is in.
+        event_log_missed counts records that went between two chunks.
+        """
+        self.event_log = []
+        self.event_log_done = False
+        self.event_log_missed = 0
+        self._event_log_next = None
+        encode = binary_protocol.encode_log_frame if self._binary else encode_log_line
+        self._send_raw(encode(op="dump"))
+
+    def clear_log(self) -> None:
+        """Empty the firmware event log."""
+        encode = binary_protocol.encode_log_frame if self._binary else encode_log_line
+        self._send_raw(encode(op="clear"))
+
+    def get_event_log(self) -> Tuple[bool, List[EventRecord]]:
+        """(dump complete, records so far) of the latest dump_log()."""
+        return self.event_log_done, self.event_log
+
+    def send_trajectory(
+        self,
+        points: Iterable[Tuple[int, DriveCommand, MechanismCommand]],
+        lead_ms: int = 50,
+    ) -> int:
+        """
+        Queue timed setpoints on the firmware: (offset_ms, drive, mech) with
+        offsets (non-decreasing, from now + lead_ms) played back on the
+        Arduino clock. Sends at most queue_free points (from the latest
+        telemetry) and returns how many went out. tx_tick's own commands
+        are held back until the last point is due.
+        """
+        tel = self.latest_telemetry
+        if tel is None or self._ser is None or not self._ser.is_open or self.link_stats.last_rx_time_s is None:
+            return 0
+
+        now_s = time.perf_counter()
+        # Arduino millis() now, from the latest telemetry stamp
+        base_ms = tel.arduino_time_ms + int((now_s - self.link_stats.last_rx_time_s) * 1000.0) + int(lead_ms)
+
+        sent = 0
+        last_offset_ms = 0
+        for offset_ms, drive, mech in points:
+            if sent >= tel.queue_free:
+                break
+            frame = {"drive": drive, "mech": mech, "at_ms": (base_ms + int(offset_ms)) & 0xFFFFFFFF}
+            self._write_command(now_s, **frame)
+            self._traj_last = dict(frame, seq=self._tx_seq)
+            last_offset_ms = int(offset_ms)
+            sent += 1
+
+        if sent:
+            self._traj_end_s = now_s + (lead_ms + last_offset_ms) / 1000.0
+        return sent
+
+    def get_latest_sequence(self) -> Optional[SequenceStatus]:
+        """Most recent firmware sequencer status, if any."""
+        return self.latest_sequence
+
+    def get_latest_link_quality(self) -> Optional[LinkQuality]:
+        """Most recent firmware-side link statistics (low rate), if any."""
+        return self.latest_link_quality
+
+    def get_latest_pong(self) -> Optional[Pong]:
+        """Most recent clock sync reply (offset, drift, command latency), if any."""
+        return self.latest_pong
+
+    def get_latest_param(self) -> Optional[ParamReply]:
+        """Most recent tuning parameter reply, if any."""
+        return self.latest_param
+
+    def get_sysid_capture(self) -> Tuple[Optional[SysIdChunk], List[Tuple[float, int, int]]]:
+        """Latest SysId chunk (run, period, units) and the samples received so far (see sysid_missed)."""
+        return self.latest_sysid, self.sysid_capture
+
     def get_status(self) -> dict:
         last_rx_age_s = None
         if self.link_stats.last_rx_time_s is not None:
@@ -200,6 +496,51 @@ class SerialLink:
             "rx_stale_s": self.rx_stale_s,
             "bytes_rx": self.link_stats.bytes_rx,
             "bytes_tx": self.link_stats.bytes_tx,
+            "wire_mode": self.wire_mode,
+            "boot": None if self.latest_hello is None else {
+                "stage": self.latest_hello.stage,
+                "fw": self.latest_hello.fw,
+                "build": self.latest_hello.build,
+                "proto": self.latest_hello.proto,
+                "features": self.latest_hello.features,
+                "reset_flags": self.latest_hello.reset_flags,
+                "setup_us": self.latest_hello.setup_us,
+                "first_tel_us": self.latest_hello.first_tel_us,
+                "hello_wait_s": self.hello_wait_s,
+                "ready_wait_s": self.ready_wait_s,
+            },
+            "telemetry_delta": self.telemetry_delta,
+            "delta_gaps": self._tlm_decoder.gaps,
+            "telemetry_subscribe": self.telemetry_subscribe if self._subscribe else None,
+            "encoder_overflows": self.encoder_overflows,
+            "command_queue": None if self.latest_telemetry is None else {
+                "depth": self.latest_telemetry.queue_depth,
+                "free": self.latest_telemetry.queue_free,
+                "trajectory_active": self._traj_end_s is not None,
+            },
+            "sequence": None if self.latest_sequence is None else {
+                "name": self.latest_sequence.name,
+                "state": self.latest_sequence.state,
+                "step": self.latest_sequence.step,
+                "steps": self.latest_sequence.steps,
+                "timeouts": self.latest_sequence.timeouts,
+            },
+            "firmware_link": None if self.latest_link_quality is None else {
+                "seq_gaps": self.latest_link_quality.seq_gaps,
+                "fail": self.latest_link_quality.fail,
+                "ovf": self.latest_link_quality.ovf,
+                "rx_hwm": self.latest_link_quality.rx_hwm,
+                "parse_max_us": self.latest_link_quality.parse_max_us,
+                "cmd_gap_max_us": self.latest_link_quality.cmd_gap_max_us,
+                "jitter_hist": self.latest_link_quality.jitter_hist,
+            },
+            "clock_sync": None if self.latest_pong is None else {
+                "synced": self.latest_pong.synced,
+                "offset_us": self.latest_pong.offset_us,
+                "drift_ppm": self.latest_pong.drift_ppm,
+                "delay_us": self.latest_pong.delay_us,
+                "cmd_latency_us": self.latest_pong.cmd_latency_us,
+            },
         }
 
     # -----------------------------
@@ -214,7 +555,7 @@ class SerialLink:
         - Rate-limited reconnect attempts (reconnect_s)
         - Auto-detect port if enabled and no explicit port given
         - Flush input/output buffers on successful open
-        - Discard first partial line (Arduino may reset on connect)
+        - Nothing is sent until the firmware is up (see _configure_link)
         """
         if (now_s - self._last_reconnect_attempt_s) < self.reconnect_s:
             return
@@ -241,15 +582,17 @@ class SerialLink:
                 write_timeout=self.write_timeout_s,
             )
 
-            # Arduino commonly resets on connect.
-            # Clear boot noise and partial fragments.
+            # Arduino commonly resets on connect: drop what the old session
+            # left, then wait for the hello (_drain_reads) before sending
             try:
-                time.sleep(1.5)
                 self._ser.reset_input_buffer()
                 self._ser.reset_output_buffer()
-                _ = self._ser.readline()
             except Exception:
                 pass
+            self._configured = False
+            self._opened_s = now_s
+            self.hello_wait_s = None
+            self.ready_wait_s = None
 
             self.link_stats.last_error = None
             self.link_stats.state = LinkState.CONNECTING
@@ -259,23 +602,66 @@ class SerialLink:
             self.link_stats.last_error = f"{type(e).__name__}: {e}"
             self.link_stats.state = LinkState.ERROR
 
+    def _configure_link(self, now_s: float) -> None:
+        """
+        First writes after an open, once the firmware is up: the wire mode
+        (it boots in JSON unless built otherwise), delta telemetry and the
+        subscription. Sent while the firmware may still be in setup(); its
+        RX ring holds them.
+        """
+        self._configured = True
+        if self._binary:
+            self._send_raw(binary_protocol.encode_link_request_line(True))
+        elif self.telemetry_delta:
+            self._tlm_decoder = TelemetryDeltaDecoder()
+            self._send_raw(encode_tlm_control_line(delta=True, keyframe=True))
+
+        if self._subscribe:
+            encode_sub = binary_protocol.encode_subscribe_frame if self._binary else encode_subscribe_line
+            self._send_raw(encode_sub(**self.telemetry_subscribe))
+
+    def _on_hello(self, hello: Hello, now_s: float) -> None:
+        hello.host_rx_time_s = now_s
+        self.latest_hello = hello
+        if self._opened_s is not None:
+            wait = now_s - self._opened_s
+            if hello.stage == "ready":
+                self.ready_wait_s = wait
+            elif self.hello_wait_s is None:
+                self.hello_wait_s = wait
+        if hello.proto != schema.PROTOCOL_VERSION:
+            self.link_stats.last_error = (
+                f"firmware protocol {hello.proto}, host {schema.PROTOCOL_VERSION}: regenerate schema.py")
+
     # -----------------------------
     # TX / RX internals
     # -----------------------------
 
-    def _write_command(self, now_s: float, drive: DriveCommand, mech: MechanismCommand) -> None:
-        if self._ser is None or not self._ser.is_open:
+    def _write_command(
+        self,
+        now_s: float,
+        drive: DriveCommand,
+        mech: MechanismCommand,
+        at_ms: Optional[int] = None,
+        seq: Optional[int] = None,
+    ) -> None:
+        """seq given = resend of an earlier frame (keepalive, not applied twice)."""
+        if self._ser is None or not self._ser.is_open or not self._configured:
             return
 
-        self._tx_seq += 1
-        seq = self._tx_seq
+        if seq is None:
+            self._tx_seq += 1
+            seq = self._tx_seq
         host_time_ms = int(time.time() * 1000.0)
 
-        payload = encode_command_frame(
+        encode = binary_protocol.encode_command_frame if self._binary else encode_command_frame
+        payload = encode(
             seq=seq,
             host_time_ms=host_time_ms,
             drive=drive,
             mech=mech,
+            at_ms=at_ms,
+            tel_ack=self._tel_ack if self.telemetry_credit else None,
         )
 
         try:
@@ -310,6 +696,51 @@ class SerialLink:
             self._handle_serial_error()
 
 
+    def _send_raw(self, data: bytes) -> None:
+        """Best-effort write of a control frame (link errors surface on the next command)."""
+        if self._ser is None or not self._ser.is_open or not self._configured:
+            return
+        try:
+            self._ser.write(data)
+            self.link_stats.bytes_tx += len(data)
+        except Exception:
+            pass
+
+    def _send_sequence(self, **kwargs) -> None:
+        encode = binary_protocol.encode_sequence_frame if self._binary else encode_sequence_line
+        self._send_raw(encode(**kwargs))
+
+    def _send_param(self, **kwargs) -> None:
+        encode = binary_protocol.encode_param_frame if self._binary else encode_param_line
+        self._send_raw(encode(**kwargs))
+
+    @staticmethod
+    def _host_us() -> int:
+        """Host clock for sync stamps: epoch us mod 2^32 (same clock as host_time_ms)."""
+        return int(time.time() * 1e6) & 0xFFFFFFFF
+
+    def _maybe_ping(self, now_s: float) -> None:
+        if self.ping_hz <= 0.0:
+            return
+        if self._last_ping_s is not None and (now_s - self._last_ping_s) < 1.0 / self.ping_hz:
+            return
+        self._last_ping_s = now_s
+
+        self._ping_id = (self._ping_id % 0xFFFF) + 1   # 1..65535, 0 = none
+        encode = binary_protocol.encode_ping_frame if self._binary else encode_ping_line
+        self._send_raw(encode(
+            ping_id=self._ping_id,
+            t1_us=self._host_us(),
+            prev_id=self._prev_pong_id,
+            prev_t4_us=self._prev_pong_t4_us,
+        ))
+
+    def _request_keyframe(self, now_s: float) -> None:
+        if (now_s - self._last_keyframe_req_s) < self._keyframe_retry_s:
+            return
+        self._last_keyframe_req_s = now_s
+        self._send_raw(encode_tlm_control_line(keyframe=True))
+
     def _drain_reads(self, now_s: float) -> None:
         if self._ser is None or not self._ser.is_open:
             return
@@ -320,16 +751,89 @@ class SerialLink:
                 if not waiting or waiting <= 0:
                     break
 
-                raw = self._ser.readline()
+                # Still booting: the firmware talks JSON until configured
+                binary = self._binary and self._configured
+                if binary:
+                    raw = self._ser.read_until(b"\x00")
+                else:
+                    raw = self._ser.readline()
                 if not raw:
                     break
 
                 self.link_stats.bytes_rx += len(raw)
 
-                line = safe_decode_line(raw)
-                tel = decode_telemetry_line(line)
-                if tel is None:
+                if binary:
+                    tel = binary_protocol.decode_frame(raw.rstrip(b"\x00"))
+                else:
+                    line = safe_decode_line(raw)
+                    tel = self._tlm_decoder.feed(line)
+                    if tel is None:
+                        tel = decode_group_line(line)
+                    if tel is None:
+                        tel = decode_perf_line(line)
+                    if tel is None:
+                        tel = decode_sequence_line(line)
+                    if tel is None:
+                        tel = decode_pong_line(line)
+                    if tel is None:
+                        tel = decode_link_stats_line(line)
+                    if tel is None:
+                        tel = decode_param_line(line)
+                    if tel is None:
+                        tel = decode_hello_line(line)
+                    if self._tlm_decoder.need_keyframe:
+                        self._request_keyframe(now_s)
+
+                if isinstance(tel, Hello):
+                    self._on_hello(tel, now_s)
+                    if not self._configured:
+                        self._configure_link(now_s)
+                    continue
+                if isinstance(tel, PerfReport):
+                    tel.host_rx_time_s = now_s
+                    self.latest_perf = tel
                     continue
+                if isinstance(tel, LinkQuality):
+                    tel.host_rx_time_s = now_s
+                    self.latest_link_quality = tel
+                    continue
+                if isinstance(tel, Pong):
+                    tel.t4_us = self._host_us()
+                    tel.host_rx_time_s = now_s
+                    self.latest_pong = tel
+                    self._prev_pong_id = tel.id
+                    self._prev_pong_t4_us = tel.t4_us
+                    continue
+                if isinstance(tel, ParamReply):
+                    tel.host_rx_time_s = now_s
+                    self.latest_param = tel
+                    continue
+                if isinstance(tel, SequenceStatus):
+                    tel.host_rx_time_s = now_s
+                    self.latest_sequence = tel
+                    continue
+                if isinstance(tel, SysIdChunk):
+                    prev = self.latest_sysid
+                    if tel.first == 0 or prev is None or prev.gen != tel.gen:
+                        self.sysid_capture = []
+                        self.sysid_missed = 0
+                    gap = tel.first - len(self.sysid_capture)
+                    if gap > 0:
+                        self.sysid_missed += gap
+                        self.sysid_capture.extend([(float("nan"), 0, 0)] * gap)
+                    if gap >= 0:
+                        self.sysid_capture.extend(tel.samples)
+                    self.latest_sysid = tel
+                    continue
+                if isinstance(tel, EventLogChunk):
+                    if self._event_log_next is not None:
+                        self.event_log_missed += (tel.first - self._event_log_next) & 0xFFFF
+                    self._event_log_next = (tel.first + len(tel.records)) & 0xFFFF
+                    self.event_log.extend(tel.records)
+                    self.event_log_done = self._event_log_next == tel.end
+                    continue
+                if tel is None or isinstance(tel, RxCaptureRecord):
+                    continue  # capture records are for scripts/record_rx_capture.py
 
                 self.link_stats.last_rx_time_s = now_s
 
@@ -338,6 +842,13 @@ class SerialLink:
                     self._rx_hz_ema = self._ema_update(self._rx_hz_ema, inst)
                 self._last_rx_event_time_s = now_s
 
+                self._tel_ack = tel.tel_seq
+
+                if tel.encoders is not None:
+                    self._encoder_samples.extend(tel.encoders.samples)
+                    self.encoder_overflows = tel.encoders.overflows
+
+                tel = merge_telemetry_group(self.latest_telemetry, tel)
                 tel.host_rx_time_s = now_s
                 self.latest_telemetry = tel
                 self.link_stats.last_ack_seq = tel.ack_seq
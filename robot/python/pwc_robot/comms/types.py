@@ -17,9 +17,9 @@ Wire format note:
 
 from __future__ import annotations
 
-from dataclasses import dataclass
+from dataclasses import dataclass, field
 from enum import Enum
-from typing import Optional
+from typing import List, Optional, Tuple
 
 
 class LinkState(str, Enum):
@@ -67,9 +67,15 @@ class UltrasonicState:
     Ultrasonic distance feedback from Arduino.
 
     Conventions:
-    - distance_in is the computed range in inches.
-    - valid indicates whether the reading is trustworthy (no timeout/out-of-range).
-    - distance_cm may be None if valid is False.
+    - distance_in is the range in inches, already median/Kalman filtered
+      with outlier rejection on the Arduino (sensors/RangeFilter), so it
+      needs no further smoothing here.
+    - valid indicates whether the filter has a trustworthy track.
+    - closing_in_s: in/s, positive when the obstacle is getting closer.
+    - confidence: 0..1, share of the last few pings the filter accepted.
+    - obstacle_stop: the firmware's obstacle guard is holding forward speed
+      at 0 (reverse and turning still work).
+    - distance_in / closing_in_s are None if valid is False.
 
     Notes:
     - Keeping this as its own dataclass makes it easy to add more fields later
@@ -77,6 +83,65 @@ class UltrasonicState:
     """
     distance_in: Optional[float] = None
     valid: bool = False
+    closing_in_s: Optional[float] = None
+    confidence: float = 0.0
+    obstacle_stop: bool = False
+
+@dataclass
+class SonarArray:
+    """
+    Every HC-SR04 of the firmware's DistanceSensorArray (front first), as
+    filtered on board. Only sent when more than one sensor is fitted.
+    Lists are per sensor; distance_in / closing_in_s are None for a sensor
+    without a track.
+    """
+    distance_in: List[Optional[float]] = field(default_factory=list)
+    closing_in_s: List[Optional[float]] = field(default_factory=list)
+    confidence: List[float] = field(default_factory=list)
+
+    @property
+    def valid(self) -> List[bool]:
+        return [d is not None for d in self.distance_in]
+
+
+@dataclass
+class EncoderSample:
+    """One drive encoder sample from the firmware's Timer1 sampler."""
+    t_us: int          # Arduino micros() (wraps at 2^32)
+    left_count: int    # signed accumulated counts
+    right_count: int
+
+
+@dataclass
+class EncoderBatch:
+    """
+    Encoder samples carried by one binary telemetry/wheel frame (oldest first).
+
+    overflows counts samples the firmware lost to a full ring since boot
+    (saturates at 65535); a jump means the host fell behind.
+    """
+    samples: List[EncoderSample] = field(default_factory=list)
+    overflows: int = 0
+
+
+@dataclass
+class PoseState:
+    """
+    Wheel-odometry pose integrated on the Arduino (sensors/Odometry).
+
+    Conventions:
+    - x_ft forward at heading 0, y_ft to the left, heading_deg CCW in
+      (-180, 180], all relative to the last pose reset (boot = origin).
+    - sigma_xy_ft / sigma_heading_deg: 1-sigma uncertainty grown from the
+      distance and angle travelled since that reset; None once the binary
+      field saturates.
+    """
+    x_ft: float = 0.0
+    y_ft: float = 0.0
+    heading_deg: float = 0.0
+    sigma_xy_ft: Optional[float] = None
+    sigma_heading_deg: Optional[float] = None
+
 
 @dataclass
 class Telemetry:
@@ -86,9 +151,14 @@ class Telemetry:
     Required fields:
     - arduino_time_ms: Arduino millis() timestamp
     - ack_seq: last command sequence number Arduino has applied (acts as ACK)
+    - tel_seq: the firmware link's publication counter (mod 2^16; frames
+      staged together share it); echoed as tel_ack for telemetry credit
+    - queue_depth / queue_free: timed commands waiting in the firmware's
+      command queue, and room left (see encode_command_frame at_ms)
 
     Optional fields:
     - wheel: wheel speed feedback
+    - pose: on-board odometry pose (sent with the wheel group)
     - mech: mechanism angles
     - note: optional debug string if you ever want it
 
@@ -99,17 +169,334 @@ class Telemetry:
     # From Arduino
     arduino_time_ms: int
     ack_seq: int
+    queue_depth: int = 0
+    queue_free: int = 0
+    tel_seq: int = 0
+
+    # Sample time on the host clock (epoch us mod 2^32), None until the
+    # firmware's clock sync has converged (see Pong)
+    host_time_us: Optional[int] = None
 
     wheel: Optional[WheelState] = None
+    pose: Optional[PoseState] = None
     mech: Optional[MechanismState] = None
     ultrasonic: Optional[UltrasonicState] = None
     note: Optional[str] = None
 
+    # Delta-mode frame counter (None when the firmware sends full frames only)
+    frame: Optional[int] = None
+
+    # Per-group frame ("wheel", "ultrasonic", "mech", "note"): only that part
+    # is set. None for full frames. serial_link.py merges groups into
+    # latest_telemetry, so consumers normally never see a partial frame.
+    group: Optional[str] = None
+
+    # Full-rate encoder samples since the previous frame (binary wire mode)
+    encoders: Optional[EncoderBatch] = None
+
+    # All ultrasonic sensors (None with a single sensor fitted)
+    sonar: Optional[SonarArray] = None
+
     # Filled in by Python on receipt
     host_rx_time_s: float = 0.0
     rx_age_s: Optional[float] = None
 
 
+@dataclass
+class TaskPerf:
+    """
+    Execution time of one firmware scheduler task over one perf window.
+
+    Units: microseconds. p99_us is an upper-edge estimate from a log2
+    histogram. overruns counts missed releases since boot.
+    """
+    name: str
+    runs: int = 0
+    overruns: int = 0
+    min_us: int = 0
+    max_us: int = 0
+    mean_us: int = 0
+    p99_us: int = 0
+
+
+@dataclass
+class LoopPerf:
+    """Firmware main loop period over one perf window (microseconds)."""
+    count: int = 0
+    min_us: int = 0
+    max_us: int = 0       # worst-case loop latency
+    mean_us: int = 0
+    jitter_us: int = 0    # max - min
+    idle_permille: int = 0  # share of the window asleep (firmware idle sleep)
+
+
+@dataclass
+class MemPerf:
+    """
+    Firmware SRAM use in bytes (utils/StackMonitor). stack_peak and
+    free_min are worst cases since reset (painted-stack high-water mark);
+    free_min near 0 means the stack has reached the static data.
+    """
+    static_bytes: int = 0   # .data + .bss + .noinit
+    stack_peak: int = 0     # deepest stack, ISRs included
+    free_min: int = 0       # never-touched gap between statics and stack
+    free_now: int = 0       # gap at the stack pointer when the frame was built
+
+
+@dataclass
+class ServoPerf:
+    """
+    Firmware servo hold policy over the window (actuators/ServoPair). A
+    servo the policy detached draws no holding current; with none attached
+    the Servo library's timer (Timer5) stops. isr_ppm is an estimate from a
+    fixed cost per compare interrupt.
+    """
+    attached: int = 0         # servos attached now
+    active_permille: int = 0  # share of the window the Servo timer ran
+    isr_ppm: int = 0          # estimated share spent in its ISR
+    detaches: int = 0         # by the hold policy, since boot
+
+
+@dataclass
+class PerfReport:
+    """
+    Low-rate diagnostics frame (Arduino -> Laptop), type "perf".
+    Sent alongside telemetry, never instead of it.
+    """
+    arduino_time_ms: int
+    window_ms: int
+    loop: LoopPerf = field(default_factory=LoopPerf)
+    tasks: List[TaskPerf] = field(default_factory=list)
+    mem: MemPerf = field(default_factory=MemPerf)
+    servo: ServoPerf = field(default_factory=ServoPerf)
+
+    # Filled in by Python on receipt
+    host_rx_time_s: float = 0.0
+
+
+@dataclass
+class LinkQuality:
+    """
+    Firmware-side link statistics (Arduino -> Laptop), type "linkstats".
+    Sent after each perf frame.
+
+    Counters (frames/ok/fail/ovf, seq_gaps, seq_stale) are since boot;
+    seq_gaps counts commands that never arrived. The rest covers window_ms:
+    rx_hwm is the largest RX backlog (bytes) one firmware tick saw, parse_*
+    is RX processing time per frame (us), cmd_gap_* the time between
+    commands (us; binary frames carry ms resolution).
+
+    jitter_hist[b] counts commands whose gap was off the running mean by
+    [2^(b-1), 2^b) ms (bin 0: < 1 ms, last bin: >= 64 ms).
+
+    Telemetry credit (commands carrying tel_ack): tel_held counts
+    publications the firmware held back since boot, tel_unread_max the most
+    it had sent but the host hadn't read in this window.
+    """
+    arduino_time_ms: int
+    window_ms: int = 0
+    frames: int = 0
+    ok: int = 0
+    fail: int = 0
+    ovf: int = 0
+    max_frame: int = 0
+    seq_gaps: int = 0
+    seq_stale: int = 0
+    rx_hwm: int = 0
+    tel_held: int = 0
+    tel_unread_max: int = 0
+    parse_n: int = 0
+    parse_min_us: int = 0
+    parse_max_us: int = 0
+    parse_mean_us: int = 0
+    cmd_n: int = 0
+    cmd_gap_min_us: int = 0
+    cmd_gap_max_us: int = 0
+    cmd_gap_mean_us: int = 0
+    jitter_hist: List[int] = field(default_factory=list)
+
+    # Filled in by Python on receipt
+    host_rx_time_s: float = 0.0
+
+
+@dataclass
+class SequenceStatus:
+    """
+    Firmware sequencer progress (Arduino -> Laptop), type "seq".
+    Sent once each time it changes, not periodically.
+
+    name: "pickup", "stow" or "upload" (a host-uploaded step list)
+    state: "idle", "running", "done" or "aborted"
+    step: index of the step in progress (== steps once done)
+    timeouts: waits that ran out (and moved on) in this run
+    """
+    arduino_time_ms: int
+    name: str = "upload"
+    state: str = "idle"
+    step: int = 0
+    steps: int = 0
+    timeouts: int = 0
+
+    # Filled in by Python on receipt
+    host_rx_time_s: float = 0.0
+
+
+@dataclass
+class Pong:
+    """
+    Clock sync reply (Arduino -> Laptop), type "pong", one per ping.
+
+    t1_us is the host's ping stamp echoed back; t2_us / t3_us are the
+    Arduino's micros() when it parsed the ping and staged this reply.
+    Host stamps are epoch us mod 2^32 (host_time_ms * 1000).
+
+    synced: the firmware's estimate has converged; offset_us (host - Arduino,
+    mod 2^32), drift_ppm and delay_us (round trip) describe it.
+    cmd_latency_us: host send -> firmware parse of the latest command
+    (None until synced).
+    """
+    id: int
+    t1_us: int
+    t2_us: int
+    t3_us: int
+    synced: bool = False
+    offset_us: int = 0
+    drift_ppm: float = 0.0
+    delay_us: int = 0
+    cmd_latency_us: Optional[int] = None
+
+    # Filled in by Python on receipt: host clock (t4) in the same units as t1_us
+    t4_us: int = 0
+    host_rx_time_s: float = 0.0
+
+
+@dataclass
+class ParamReply:
+    """
+    Tuning parameter reply (Arduino -> Laptop), type "param", one per request
+    (firmware utils/ParamStore.h).
+
+    op: "get" | "set" | "save" | "load" | "defaults" (echoes the request)
+    status: "ok" | "unknown" | "range" | "busy" | "no_image"
+    count: registry size (valid indices are 0 .. count-1)
+
+    get / set (of a known parameter) also describe it: index, name (the
+    Params.h constant), the staged value and its [min, max]. A set that
+    was out of range leaves value unchanged. Staged values go live on the
+    next drive tick; save writes them to EEPROM in the background.
+    """
+    op: str
+    status: str
+    count: int = 0
+    index: Optional[int] = None
+    name: Optional[str] = None
+    value: Optional[float] = None
+    min: Optional[float] = None
+    max: Optional[float] = None
+
+    # Filled in by Python on receipt
+    host_rx_time_s: float = 0.0
+
+
+@dataclass
+class RxCaptureRecord:
+    """
+    One record of a field RX capture (type 0x8B, firmware comms/RxRecorder.h):
+    bytes the USB link consumed in one tick, streamed on the aux UART when
+    the firmware is built with ENABLE_RX_CAPTURE.
+
+    t_us: Arduino micros() of the consuming tick (wraps every ~71 min)
+    seq: record counter mod 256 (a gap means records were lost)
+    data: the raw bytes, at most RX_CAPTURE_CHUNK_BYTES
+    """
+    t_us: int
+    seq: int
+    data: bytes = b""
+
+
+@dataclass
+class SysIdChunk:
+    """
+    Part of a motor characterization capture (type 0x8C, firmware
+    control/SysId.h), streamed during a "sysid_drive" / "sysid_arm" test.
+
+    target: "drive" or "arm"; gen: the run (mod 256)
+    period_ms: time between samples; units_per_count: ft (drive) or deg
+    (arm) per encoder count, so speed = delta * units_per_count / period
+    first / total: index of the first sample, samples taken so far in the
+    run (a first past the previous chunk's end: samples lost in between)
+    samples: (duty, delta_left, delta_right) per sample, duty in -1..1
+    """
+    target: str
+    gen: int
+    period_ms: int
+    units_per_count: float
+    first: int
+    total: int
+    samples: List[Tuple[float, int, int]] = field(default_factory=list)
+
+
+@dataclass
+class EventRecord:
+    """
+    One firmware event log record (utils/EventLog.h).
+
+    number: record number since boot (mod 2^16); t_ms: Arduino millis() of
+    the first occurrence; event: protocol.EVENT_NAMES name ("event_<id>" if
+    unknown); count: consecutive occurrences folded into it; a, b: the
+    latest one's args (meaning per event, see firmware EventId)
+    """
+    number: int
+    t_ms: int
+    event: str
+    count: int = 1
+    a: int = 0
+    b: int = 0
+
+
+@dataclass
+class EventLogChunk:
+    """
+    Part of an event log dump (type 0x8E), streamed after a "log" dump
+    request. first: number of records[0]; end: one past the dump's last
+    record, the dump is over with the chunk that reaches it (an empty
+    chunk if records ran out early)
+    """
+    first: int
+    end: int
+    records: List[EventRecord] = field(default_factory=list)
+
+
+@dataclass
+class Hello:
+    """
+    Firmware boot report (type "hello" / 0x8D). Sent once the link is up,
+    before the actuators (stage "link"), and again with the boot timing
+    when the first telemetry frame has gone out (stage "ready").
+
+    fw: FIRMWARE_VERSION (major * 100 + minor); build: compile stamp
+    proto: the firmware's Schema.h PROTOCOL_VERSION (schema.PROTOCOL_VERSION
+    is this host's)
+    features: firmware FEATURE_* bits; reset_flags: MCUSR at reset
+    link_us / setup_us / first_tel_us: micros() when the hello was staged,
+    setup() duration, micros() at the first telemetry frame (0 in the "link"
+    hello); boot time only, the bootloader before it is not counted
+    """
+    arduino_time_ms: int
+    stage: str = "link"
+    fw: int = 0
+    build: str = ""
+    proto: int = 0
+    features: int = 0
+    reset_flags: int = 0
+    link_us: int = 0
+    setup_us: int = 0
+    first_tel_us: int = 0
+
+    # Filled in by Python on receipt
+    host_rx_time_s: float = 0.0
+
+
 @dataclass
 class LinkStats:
     """
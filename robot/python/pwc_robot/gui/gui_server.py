@@ -1,6 +1,7 @@
 from __future__ import annotations
 
 import time
+from dataclasses import asdict
 from typing import Any, Dict, Optional
 
 import cv2
@@ -184,11 +185,13 @@ def create_app(
 
             status = serial_link.get_status()
             tel = serial_link.get_latest_telemetry()
+            perf_report = getattr(serial_link, "get_latest_perf", lambda: None)()
 
             # Unpack wheel/mech/ultrasonic into plain JSON dictionaries
             wheel = None
             mech = None
             ultrasonic = None
+            pose = None
 
             if tel is not None:
                 if tel.wheel is not None:
@@ -203,11 +206,16 @@ def create_app(
                         "motor_RHS_deg": (None if tel.mech.motor_RHS_deg is None else float(tel.mech.motor_RHS_deg)),
                         "motor_LHS_deg": (None if tel.mech.motor_LHS_deg is None else float(tel.mech.motor_LHS_deg)),
                     }
+                if getattr(tel, "pose", None) is not None:
+                    pose = asdict(tel.pose)
                 u = getattr(tel, "ultrasonic", None)
                 if u is not None:  # (safe even if older Telemetry)
                     ultrasonic = {
                         "distance_in": (None if tel.ultrasonic.distance_in is None else float(tel.ultrasonic.distance_in)),
                         "valid": bool(tel.ultrasonic.valid),
+                        "closing_in_s": getattr(tel.ultrasonic, "closing_in_s", None),
+                        "confidence": float(getattr(tel.ultrasonic, "confidence", 0.0)),
+                        "obstacle_stop": bool(getattr(tel.ultrasonic, "obstacle_stop", False)),
                     }
 
             return jsonify(
@@ -225,11 +233,13 @@ def create_app(
                         "last_error": status.get("last_error", None),
                     },
                     "wheel": wheel,
+                    "pose": pose,
                     "mech": mech,
                     "ultrasonic": ultrasonic,
                     "note": (tel.note if tel is not None else None),
                     "ack_seq": (None if tel is None else int(tel.ack_seq)),
                     "arduino_time_ms": (None if tel is None else int(tel.arduino_time_ms)),
+                    "perf": (None if perf_report is None else asdict(perf_report)),
   
                 }
             )
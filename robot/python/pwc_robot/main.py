@@ -103,7 +103,8 @@ def main(config_name: str = "robot_default.yaml") -> None:
             "timeout_s",
             "write_timeout_s",
             "rx_stale_s",
-            "reconnect_s"
+            "reconnect_s",
+            "boot_timeout_s",
         ]
     })
     
@@ -254,6 +255,15 @@ def main(config_name: str = "robot_default.yaml") -> None:
         comms_hz = float(comms_cfg["comms_hz"])
     else:
         print("Comms Link Bypassed ...")
+
+    # Optional aux link (Pi GPIO UART, e.g. port /dev/ttyAMA0, baud 1000000):
+    # encoder batches and perf frames, no commands. Needs firmware built with
+    # ENABLE_AUX_LINK (off by default; the hello's features show it)
+    aux_comms = None
+    aux_cfg = comms_cfg.get("aux")
+    if comms_enabled and aux_cfg:
+        print("Establishing Arduino Aux Link ...")
+        aux_comms = SerialLink({**aux_cfg, "telemetry_only": True, "auto_detect": False})
     
     
     # --- GUI Thread (Flask Streaming Server) ---
@@ -342,6 +352,8 @@ def main(config_name: str = "robot_default.yaml") -> None:
             # RX every loop (fast, low latency)
             if comms_enabled:
                 comms.rx_tick()
+            if aux_comms is not None:
+                aux_comms.rx_tick()
 
             # Controller tick uses latest telemetry
             t2 = time.perf_counter()
@@ -353,6 +365,8 @@ def main(config_name: str = "robot_default.yaml") -> None:
             t3 = time.perf_counter()
             if comms_enabled and comms_rate.ready(t3):
                 comms.tx_tick(drive_cmd, mech_cmd)
+                if aux_comms is not None:
+                    aux_comms.tx_tick(None, None)
 
 
                 
@@ -377,6 +391,8 @@ def main(config_name: str = "robot_default.yaml") -> None:
     finally:
         if comms_enabled:
             comms.close()
+        if aux_comms is not None:
+            aux_comms.close()
         cv.stop()
 
 
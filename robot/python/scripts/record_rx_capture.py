@@ -0,0 +1,64 @@
+"""
+Dumps the Arduino's RX capture stream (firmware built with ENABLE_RX_CAPTURE)
+from the aux UART to a file for the native replay harness:
+
+    python scripts/record_rx_capture.py /dev/ttyAMA0 field.rxcap
+    .pio/build/native/program --replay field.rxcap timeline.csv
+
+The file is the raw byte stream; records are only counted here.
+"""
+
+import sys
+import time
+
+import serial
+
+from pwc_robot.comms import binary_protocol
+from pwc_robot.comms.types import RxCaptureRecord
+
+BAUD = 1000000   # AUX_SERIAL_BAUD
+
+
+def main() -> None:
+    if len(sys.argv) != 3:
+        print(__doc__)
+        sys.exit(2)
+    port, path = sys.argv[1], sys.argv[2]
+
+    ser = serial.Serial(port, BAUD, timeout=0.2)
+    print("Opened", ser.port, "baud", ser.baudrate, "->", path, "(Ctrl-C to stop)")
+
+    records = gaps = bad = 0
+    last_seq = None
+    pending = b""
+    t0 = time.time()
+    with open(path, "wb") as f:
+        try:
+            while True:
+                raw = ser.read(4096)
+                if not raw:
+                    continue
+                f.write(raw)
+
+                pending += raw
+                *frames, pending = pending.split(b"\x00")
+                for frame in frames:
+                    if not frame:
+                        continue
+                    rec = binary_protocol.decode_frame(frame)
+                    if not isinstance(rec, RxCaptureRecord):
+                        bad += 1
+                        continue
+                    if last_seq is not None and rec.seq != (last_seq + 1) & 0xFF:
+                        gaps += 1
+                    last_seq = rec.seq
+                    records += 1
+        except KeyboardInterrupt:
+            pass
+
+    ser.close()
+    print(f"{records} records in {time.time() - t0:.1f} s, {gaps} seq gaps, {bad} bad frames")
+
+
+if __name__ == "__main__":
+    main()